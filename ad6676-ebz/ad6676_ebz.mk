@@ -17,6 +17,7 @@ NR_OF_CHAN := 2
 
 M_INC_DIRS := $(NOOS-DIR)/common_drivers/platform_drivers
 M_INC_DIRS += $(NOOS-DIR)/common_drivers/adc_core
+M_INC_DIRS += $(NOOS-DIR)/common_drivers/adc_check
 M_INC_DIRS += $(NOOS-DIR)/common_drivers/dmac_core
 M_INC_DIRS += $(NOOS-DIR)/common_drivers/xcvr_core
 M_INC_DIRS += $(NOOS-DIR)/common_drivers/xcvr_core/xcvr_modules
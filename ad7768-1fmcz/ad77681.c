@@ -107,35 +107,28 @@ int32_t ad77681_spi_reg_read(ad77681_dev *dev,
 		 	 	 	 	 	 uint8_t reg_addr,
 							 uint8_t *reg_data)
 {
-	spi_msg 	*msg;
+	spi_msg 	msg;
 	int32_t 	ret = 0;
 	uint8_t 	i;
 	uint8_t 	buf_len = (dev->crc_sel == AD77681_NO_CRC) ? 2 : 3;
 	uint32_t 	spi_msg_cmds[5] = {CS_DEASSERT, CS_ASSERT, CS_DEASSERT, TRANSFER_R_W(buf_len), CS_ASSERT};
 
-	msg = (spi_msg *)malloc(sizeof(*msg));
-	if (!msg)
-		return -1;
-	msg->spi_msg_cmds = malloc(sizeof(spi_msg_cmds));
-
-	msg->spi_msg_cmds = spi_msg_cmds;
-	msg->msg_cmd_len = sizeof(spi_msg_cmds) / sizeof(uint32_t);
-	msg->tx_buf[0] = AD77681_REG_READ(reg_addr);
-	msg->tx_buf[1] = 0x00;
+	msg.spi_msg_cmds = spi_msg_cmds;
+	msg.msg_cmd_len = sizeof(spi_msg_cmds) / sizeof(uint32_t);
+	msg.tx_buf[0] = AD77681_REG_READ(reg_addr);
+	msg.tx_buf[1] = 0x00;
 
 	// Init the rx buffer with 0s
-	for (i = 0; i < sizeof(msg->rx_buf) / sizeof(uint8_t); i++)
-		msg->rx_buf[i] = 0;
+	for (i = 0; i < sizeof(msg.rx_buf) / sizeof(uint8_t); i++)
+		msg.rx_buf[i] = 0;
 
-	ret |= spi_eng_transfer_message(dev->spi_eng_dev, msg);
+	ret |= spi_eng_transfer_message(dev->spi_eng_dev, &msg);
 
 	mdelay(1000);
 
-	reg_data[0] = msg->rx_buf[0];
-	reg_data[1] = msg->rx_buf[1]; // reg_data
-	reg_data[2] = msg->rx_buf[2]; // crc
-
-	free(msg);
+	reg_data[0] = msg.rx_buf[0];
+	reg_data[1] = msg.rx_buf[1]; // reg_data
+	reg_data[2] = msg.rx_buf[2]; // crc
 
 	return ret;
 }
@@ -151,22 +144,17 @@ int32_t ad77681_spi_reg_write(ad77681_dev *dev,
 		 	 	 	 	 	  uint8_t reg_addr,
 							  uint8_t reg_data)
 {
-	spi_msg		*msg;
+	spi_msg		msg;
 	int32_t 	ret = 0;
 	uint32_t 	spi_msg_cmds[5] = {CS_DEASSERT, CS_ASSERT, CS_DEASSERT, TRANSFER_W(2), CS_ASSERT};
 
-	msg = (spi_msg *)malloc(sizeof(*msg));
-	if (!msg)
-		return -1;
-	msg->spi_msg_cmds = malloc(sizeof(spi_msg_cmds));
-	msg->spi_msg_cmds = spi_msg_cmds;
-	msg->msg_cmd_len = sizeof(spi_msg_cmds) / sizeof(uint32_t);
-	msg->tx_buf[0] = AD77681_REG_WRITE(reg_addr);
-	msg->tx_buf[1] = reg_data;
+	msg.spi_msg_cmds = spi_msg_cmds;
+	msg.msg_cmd_len = sizeof(spi_msg_cmds) / sizeof(uint32_t);
+	msg.tx_buf[0] = AD77681_REG_WRITE(reg_addr);
+	msg.tx_buf[1] = reg_data;
 
-	ret |= spi_eng_transfer_message(dev->spi_eng_dev, msg);
+	ret |= spi_eng_transfer_message(dev->spi_eng_dev, &msg);
 
-	free(msg);
 	return ret;
 }
 
@@ -247,37 +235,33 @@ uint8_t ad77681_get_rx_buf_len(ad77681_dev *dev)
 int32_t ad77681_spi_read_adc_data(ad77681_dev *dev,
 								  uint8_t *adc_data)
 {
-	spi_msg 	*msg;
+	spi_msg 	msg;
 	int32_t 	ret = 0;
 	uint8_t 	crc_calc_buf[4], crc, i;
 	uint8_t 	rx_tx_buf_len = ad77681_get_rx_buf_len(dev) + 1;
 	uint32_t 	spi_msg_cmds[5] = {CS_DEASSERT, CS_ASSERT, CS_DEASSERT, TRANSFER_R_W(rx_tx_buf_len), CS_ASSERT};
 
-	msg = (spi_msg *)malloc(sizeof(*msg));
-	if (!msg)
-		return -1;
-	msg->spi_msg_cmds = malloc(sizeof(spi_msg_cmds));
-	msg->spi_msg_cmds = spi_msg_cmds;
-	msg->msg_cmd_len = sizeof(spi_msg_cmds) / sizeof(uint32_t);
-	msg->tx_buf[0] = AD77681_REG_READ(AD77681_REG_ADC_DATA);
-	msg->tx_buf[1] = 0x00;
+	msg.spi_msg_cmds = spi_msg_cmds;
+	msg.msg_cmd_len = sizeof(spi_msg_cmds) / sizeof(uint32_t);
+	msg.tx_buf[0] = AD77681_REG_READ(AD77681_REG_ADC_DATA);
+	msg.tx_buf[1] = 0x00;
 
 	// Init the rx buffer with 0s
-	for (i = 0; i < sizeof(msg->rx_buf) / sizeof(uint8_t); i++) {
-		msg->rx_buf[i] = 0;
+	for (i = 0; i < sizeof(msg.rx_buf) / sizeof(uint8_t); i++) {
+		msg.rx_buf[i] = 0;
 		adc_data[i] = 0;
 	}
 
-	ret |= spi_eng_transfer_message(dev->spi_eng_dev, msg);
+	ret |= spi_eng_transfer_message(dev->spi_eng_dev, &msg);
 
 	if (dev->crc_sel == AD77681_CRC) {
-		crc_calc_buf[0] = msg->tx_buf[0];
-		crc_calc_buf[1] = msg->rx_buf[1]; // ignore the first byte which is always 0
-		crc_calc_buf[2] = msg->rx_buf[2];
-		crc_calc_buf[3] = msg->rx_buf[3];
+		crc_calc_buf[0] = msg.tx_buf[0];
+		crc_calc_buf[1] = msg.rx_buf[1]; // ignore the first byte which is always 0
+		crc_calc_buf[2] = msg.rx_buf[2];
+		crc_calc_buf[3] = msg.rx_buf[3];
 
 		crc = ad77681_compute_crc8(crc_calc_buf, 4);
-		if (crc !=  msg->rx_buf[4]) {
+		if (crc !=  msg.rx_buf[4]) {
 			printf("%s: CRC Error.\n", __func__);
 			ret = -1;
 		}
@@ -285,14 +269,48 @@ int32_t ad77681_spi_read_adc_data(ad77681_dev *dev,
 
 	// Fill the adc_data buffer
 	for (i = 0; i < rx_tx_buf_len; i++) {
-		adc_data[i] = msg->rx_buf[i];
+		adc_data[i] = msg.rx_buf[i];
 	}
 
-	free(msg);
-
 	return ret;
 }
 
+/**
+ * Start streaming conversion results through the SPI Engine offload.
+ * Each conversion appends get_rx_buf_len() + 1 bytes to the DMA ring, so
+ * init->block_size must be a multiple of that. init->callback is called
+ * from the DMAC interrupt for every filled block.
+ * @param dev - The device structure.
+ * @param init - The ring buffer and consumer description.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad77681_stream_start(ad77681_dev *dev,
+							 spi_eng_stream_init *init)
+{
+	spi_msg 	msg;
+	uint8_t 	rx_tx_buf_len = ad77681_get_rx_buf_len(dev) + 1;
+	uint32_t 	spi_msg_cmds[5] = {CS_DEASSERT, CS_ASSERT, CS_DEASSERT, TRANSFER_R_W(rx_tx_buf_len), CS_ASSERT};
+
+	msg.spi_msg_cmds = spi_msg_cmds;
+	msg.msg_cmd_len = sizeof(spi_msg_cmds) / sizeof(uint32_t);
+	msg.rx_buf_addr = init->buf_addr;
+	msg.tx_buf_addr = 0;
+	msg.tx_buf[0] = AD77681_REG_READ(AD77681_REG_ADC_DATA);
+	msg.tx_buf[1] = 0x00;
+
+	return spi_eng_stream_start(dev->spi_eng_dev, &msg, init);
+}
+
+/**
+ * Stop streaming conversion results.
+ * @param dev - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad77681_stream_stop(ad77681_dev *dev)
+{
+	return spi_eng_stream_stop(dev->spi_eng_dev);
+}
+
 /**
  * Set the power consumption mode of the ADC core.
  * @param dev - The device structure.
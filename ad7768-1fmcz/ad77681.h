@@ -367,8 +367,12 @@ int32_t ad77681_set_power_mode(ad77681_dev *dev,
 							   ad77681_power_mode mode);
 int32_t ad77681_set_mclk_div(ad77681_dev *dev,
 							 ad77681_mclk_div clk_div);
+uint8_t ad77681_get_rx_buf_len(ad77681_dev *dev);
 int32_t ad77681_spi_read_adc_data(ad77681_dev *dev,
 								  uint8_t *adc_data);
+int32_t ad77681_stream_start(ad77681_dev *dev,
+							 spi_eng_stream_init *init);
+int32_t ad77681_stream_stop(ad77681_dev *dev);
 int32_t ad77681_set_conv_mode(ad77681_dev *dev,
 							  ad77681_conv_mode conv_mode,
 							  ad77681_conv_diag_mux diag_mux_sel,
@@ -61,6 +61,11 @@
 #define AD77681_SPI2_ENGINE_BASEADDR		XPAR_SPI_ADC2_AXI_2_BASEADDR
 #define AD77681_SPI_CS						0
 
+#define AD77681_DMA_2_INT_ID				86
+#define AD77681_STREAM_BUF_ADDR				0x800000
+#define AD77681_STREAM_BLOCK_SIZE			(4 * 1024)
+#define AD77681_STREAM_NUM_BLOCKS			8
+
 #define GPIO_DEVICE_ID						XPAR_PS7_GPIO_0_DEVICE_ID
 #define GPIO_OFFSET							32
 
@@ -80,8 +85,6 @@
 #define GPIO_1_SYNC_OUT						GPIO_OFFSET + 17 // 49
 #define GPIO_1_RESET						GPIO_OFFSET + 16 // 48
 
-uint32_t spi_msg_cmds[6] = {CS_DEASSERT, CS_ASSERT, CS_DEASSERT, TRANSFER_W(2), TRANSFER_R(4), CS_ASSERT};
-
 spi_init_param spi1_default_init_param = {
 		AD77681_SPI1_ENGINE_BASEADDR, 	 // adc_baseaddr
 		AD77681_SPI_CS,					 // chip_select
@@ -139,11 +142,46 @@ ad77681_init_param ADC2_default_init_param = {
 
 #define SPI_ENGINE_OFFLOAD_EXAMPLE	0
 
+volatile uint32_t stream_blocks = 0;
+
+/***************************************************************************//**
+* @brief stream_lcm
+*******************************************************************************/
+uint32_t stream_lcm(uint32_t a, uint32_t b)
+{
+	uint32_t x = a;
+	uint32_t y = b;
+	uint32_t t;
+
+	while (y) {
+		t = x % y;
+		x = y;
+		y = t;
+	}
+
+	return (a / x) * b;
+}
+
+/***************************************************************************//**
+* @brief stream_block_ready
+*******************************************************************************/
+void stream_block_ready(void *ref, uint8_t *block, uint32_t block_size)
+{
+	(void)ref;
+	(void)block;
+	(void)block_size;
+
+	// Runs in the DMAC interrupt; the block is rewritten num_blocks - 1
+	// blocks from now, so only hand it off here.
+	stream_blocks++;
+}
+
 int main()
 {
 	ad77681_dev		*adc1_dev;
 	ad77681_dev		*adc2_dev;
-	spi_msg 		*msg;
+	spi_eng_stream_init	stream_init;
+	uint32_t			block_align;
 	uint8_t			adc1_data[5];
 	uint8_t			adc2_data[5];
 	uint8_t 		*data;
@@ -174,30 +212,28 @@ int main()
 			mdelay(1000);
 		}
 	} else { // offload example
-		msg = (spi_msg *)malloc(sizeof(*msg));
-		if (!msg)
+		stream_init.buf_addr = AD77681_STREAM_BUF_ADDR;
+		// whole conversions in cache line aligned blocks: a multiple of
+		// lcm(rx length, SPI_ENGINE_STREAM_ALIGN)
+		block_align = stream_lcm(ad77681_get_rx_buf_len(adc2_dev) + 1,
+								 SPI_ENGINE_STREAM_ALIGN);
+		stream_init.block_size = AD77681_STREAM_BLOCK_SIZE -
+			(AD77681_STREAM_BLOCK_SIZE % block_align);
+		stream_init.num_blocks = AD77681_STREAM_NUM_BLOCKS;
+		stream_init.dma_int_id = AD77681_DMA_2_INT_ID;
+		stream_init.callback = stream_block_ready;
+		stream_init.callback_ref = adc2_dev;
+
+		if (ad77681_stream_start(adc2_dev, &stream_init))
 			return -1;
 
-		msg->spi_msg_cmds = malloc(sizeof(spi_msg_cmds));
-		msg->spi_msg_cmds = spi_msg_cmds;
-		msg->rx_buf_addr = 0x800000;
-		msg->tx_buf_addr = 0xA000000;
-		msg->msg_cmd_len = sizeof(spi_msg_cmds) / sizeof(uint32_t);
-		msg->tx_buf[0] = AD77681_REG_READ(AD77681_REG_ADC_DATA);
-		msg->tx_buf[1] = 0x00;
-
-		spi_eng_offload_load_msg(adc2_dev->spi_eng_dev, msg);
-		spi_eng_transfer_multiple_msgs(adc2_dev->spi_eng_dev, 8);
-
-		data = (uint8_t*)adc2_dev->spi_eng_dev->rx_dma_startaddr;
+		while (stream_blocks < 4 * AD77681_STREAM_NUM_BLOCKS);
 
-		mdelay(10000);
+		ad77681_stream_stop(adc2_dev);
 
-        for(i = 0; i < adc2_dev->spi_eng_dev->rx_length; i++) {
-    		printf("%x\r\n", *data);
-    		data += sizeof(uint8_t);
-        }
-        free(msg);
+		data = (uint8_t*)AD77681_STREAM_BUF_ADDR;
+		for(i = 0; i < stream_init.block_size; i++)
+			printf("%x\r\n", data[i]);
 	}
 
 	printf("Bye\n");
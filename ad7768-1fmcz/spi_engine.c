@@ -45,12 +45,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sleep.h>
+#include <xil_cache.h>
 #include <xil_io.h>
 #include <xscugic.h>
 #include <xparameters.h>
 #include "platform_drivers.h"
 #include "spi_engine.h"
 
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+static XScuGic spi_eng_gic;
+
 /******************************************************************************/
 /************************** Functions Implementation **************************/
 /******************************************************************************/
@@ -103,12 +109,43 @@ int32_t spi_eng_dma_read(spi_dev *dev,
 	return 0;
 }
 
+/***************************************************************************//**
+* @brief spi_eng_rx_dma_write
+*******************************************************************************/
+static int32_t spi_eng_rx_dma_write(spi_dev *dev,
+									uint32_t reg_addr,
+									uint32_t reg_data)
+{
+	Xil_Out32((dev->spi_offload_rx_dma_baseaddr + reg_addr), reg_data);
+
+	return 0;
+}
+
+/***************************************************************************//**
+* @brief spi_eng_dma_wait_queued
+*******************************************************************************/
+static int32_t spi_eng_dma_wait_queued(uint32_t dma_baseaddr)
+{
+	uint32_t timeout = 1000;
+
+	while (Xil_In32(dma_baseaddr + DMAC_REG_START_TRANSFER) & 0x1) {
+		if (!timeout--)
+			return -1;
+		usleep(1);
+	}
+
+	return 0;
+}
+
 /***************************************************************************//**
 * @brief spi_eng_program_add_cmd
 *******************************************************************************/
 void spi_eng_program_add_cmd(spi_transfer_fifo *xfer,
 						 	 uint16_t cmd)
 {
+	if (xfer->cmd_fifo_len >= SPI_ENGINE_MAX_PROG_LEN)
+		return;
+
 	xfer->cmd_fifo[xfer->cmd_fifo_len] = cmd;
 	xfer->cmd_fifo_len++;
 }
@@ -277,58 +314,148 @@ void spi_eng_add_user_cmd(spi_dev *dev,
 }
 
 /***************************************************************************//**
-* @brief spi_eng_compile_message
+* @brief spi_eng_compile_cmds
 *******************************************************************************/
-int32_t spi_eng_compile_message(spi_dev *dev,
-								spi_msg *msg,
-								spi_transfer_fifo *xfer)
+static int32_t spi_eng_compile_cmds(spi_dev *dev,
+									uint32_t *cmds,
+									uint8_t cmd_len,
+									spi_eng_msg_handle *handle)
 {
-	uint32_t i, n = 0;
+	uint32_t i;
 
-	n = msg->msg_cmd_len;
+	handle->valid = 0;
+	if (cmd_len > SPI_ENGINE_MAX_MSG_CMDS) {
+		printf("%s: Too many commands (%d).\n", __func__, cmd_len);
+		return -1;
+	}
 
-	// configure prescale
-	spi_eng_program_add_cmd(xfer,
-			SPI_ENGINE_CMD_WRITE(SPI_ENGINE_CMD_REG_CLK_DIV,
-								  dev->clk_div));
-	// SPI configuration (3W/CPOL/CPHA)
-	spi_eng_program_add_cmd(xfer,
-			SPI_ENGINE_CMD_WRITE(SPI_ENGINE_CMD_REG_CONFIG,
-								dev->spi_config));
+	// The lengths are only set by the transfer commands of this message
+	dev->rx_length = 0;
+	dev->tx_length = 0;
 
-	for (i = 0; i < n; i++) {
-		spi_eng_add_user_cmd(dev, xfer, msg->spi_msg_cmds[i]);
+	handle->xfer.cmd_fifo_len = 0;
+	for (i = 0; i < cmd_len; i++) {
+		handle->msg_cmds[i] = cmds[i];
+		spi_eng_add_user_cmd(dev, &handle->xfer, cmds[i]);
 	}
 
 	// SYNC
-	spi_eng_program_add_cmd(xfer,
+	spi_eng_program_add_cmd(&handle->xfer,
 			SPI_ENGINE_CMD_SYNC(0));
 
+	handle->msg_cmd_len = cmd_len;
+	handle->rx_length = dev->rx_length;
+	handle->tx_length = dev->tx_length;
+	handle->clk_div = dev->clk_div;
+	handle->offload = dev->offload_configured;
+	handle->valid = 1;
+
 	return 0;
 }
 
 /***************************************************************************//**
-* @brief spi_eng_transfer_message
+* @brief spi_eng_compile_handle
+*
+* Compiles the command list of a message once into a reusable handle. The
+* handle holds only the user commands and the SYNC; CLK_DIV and CONFIG are
+* written by spi_eng_transfer_handle() when they differ from what the
+* engine was last programmed with.
 *******************************************************************************/
-int32_t spi_eng_transfer_message(spi_dev *dev, spi_msg *msg)
+int32_t spi_eng_compile_handle(spi_dev *dev,
+							   spi_msg *msg,
+							   spi_eng_msg_handle *handle)
+{
+	return spi_eng_compile_cmds(dev, msg->spi_msg_cmds,
+								msg->msg_cmd_len, handle);
+}
+
+/***************************************************************************//**
+* @brief spi_eng_get_handle
+*
+* Returns the cached program of a message, compiling it into the next cache
+* slot on a miss. Messages are matched by their command words, so callers
+* that build the command list on the stack still hit the cache.
+*******************************************************************************/
+static spi_eng_msg_handle *spi_eng_get_handle(spi_dev *dev, spi_msg *msg)
+{
+	spi_eng_msg_handle *handle;
+	uint8_t i, j;
+
+	for (i = 0; i < SPI_ENGINE_MSG_CACHE_SIZE; i++) {
+		handle = &dev->msg_cache[i];
+		if (!handle->valid ||
+			(handle->msg_cmd_len != msg->msg_cmd_len) ||
+			(handle->clk_div != dev->clk_div) ||
+			(handle->offload != dev->offload_configured))
+			continue;
+		for (j = 0; j < handle->msg_cmd_len; j++)
+			if (handle->msg_cmds[j] != msg->spi_msg_cmds[j])
+				break;
+		if (j == handle->msg_cmd_len)
+			return handle;
+	}
+
+	handle = &dev->msg_cache[dev->msg_cache_next];
+	dev->msg_cache_next = (dev->msg_cache_next + 1) % SPI_ENGINE_MSG_CACHE_SIZE;
+
+	if (spi_eng_compile_handle(dev, msg, handle))
+		return NULL;
+
+	return handle;
+}
+
+/***************************************************************************//**
+* @brief spi_eng_write_config
+*******************************************************************************/
+static void spi_eng_write_config(spi_dev *dev)
+{
+	if (dev->cfg_valid &&
+		(dev->cfg_clk_div == dev->clk_div) &&
+		(dev->cfg_spi_config == dev->spi_config))
+		return;
+
+	// configure prescale
+	spi_eng_write(dev, SPI_ENGINE_REG_CMD_FIFO,
+			SPI_ENGINE_CMD_WRITE(SPI_ENGINE_CMD_REG_CLK_DIV,
+								  dev->clk_div));
+	// SPI configuration (3W/CPOL/CPHA)
+	spi_eng_write(dev, SPI_ENGINE_REG_CMD_FIFO,
+			SPI_ENGINE_CMD_WRITE(SPI_ENGINE_CMD_REG_CONFIG,
+								dev->spi_config));
+
+	dev->cfg_clk_div = dev->clk_div;
+	dev->cfg_spi_config = dev->spi_config;
+	dev->cfg_valid = 1;
+}
+
+/***************************************************************************//**
+* @brief spi_eng_transfer_handle
+*******************************************************************************/
+int32_t spi_eng_transfer_handle(spi_dev *dev,
+								spi_eng_msg_handle *handle,
+								spi_msg *msg)
 {
-	uint32_t		  i, size;
-	spi_transfer_fifo *xfer;
+	uint32_t i;
 	uint8_t words_number;
 	uint32_t data;
 
-	size = sizeof(*xfer->cmd_fifo) * (msg->msg_cmd_len + 3);
-
-	xfer = (spi_transfer_fifo *)malloc(sizeof(*xfer) + size);
-	if (!xfer)
+	if (!handle->valid)
 		return -1;
 
-	xfer->cmd_fifo_len = 0;
-	spi_eng_compile_message(dev, msg, xfer);
+	if ((handle->clk_div != dev->clk_div) ||
+		(handle->offload != dev->offload_configured))
+		if (spi_eng_compile_cmds(dev, handle->msg_cmds,
+								 handle->msg_cmd_len, handle))
+			return -1;
+
+	dev->rx_length = handle->rx_length;
+	dev->tx_length = handle->tx_length;
+
+	spi_eng_write_config(dev);
 
 	// CMD FIFO
-	for (i = 0; i < xfer->cmd_fifo_len; i++)
-		spi_eng_write(dev, SPI_ENGINE_REG_CMD_FIFO, xfer->cmd_fifo[i]);
+	for (i = 0; i < handle->xfer.cmd_fifo_len; i++)
+		spi_eng_write(dev, SPI_ENGINE_REG_CMD_FIFO, handle->xfer.cmd_fifo[i]);
 
 	// TX FIFO
 	words_number = spi_get_words_number(dev, dev->tx_length);
@@ -342,18 +469,30 @@ int32_t spi_eng_transfer_message(spi_dev *dev, spi_msg *msg)
 		msg->rx_buf[i] = data;
 	}
 
-	free(xfer);
-
 	return 0;
 }
 
+/***************************************************************************//**
+* @brief spi_eng_transfer_message
+*******************************************************************************/
+int32_t spi_eng_transfer_message(spi_dev *dev, spi_msg *msg)
+{
+	spi_eng_msg_handle *handle;
+
+	handle = spi_eng_get_handle(dev, msg);
+	if (!handle)
+		return -1;
+
+	return spi_eng_transfer_handle(dev, handle, msg);
+}
+
 /***************************************************************************//**
 * @brief spi_eng_offload_load_msg
 *******************************************************************************/
 int32_t spi_eng_offload_load_msg(spi_dev *dev, spi_msg *msg)
 {
-	uint32_t i, size;
-	spi_transfer_fifo *xfer;
+	uint32_t i;
+	spi_eng_msg_handle *handle;
 	uint8_t words_number;
 
 	dev->rx_dma_startaddr = msg->rx_buf_addr;
@@ -362,27 +501,31 @@ int32_t spi_eng_offload_load_msg(spi_dev *dev, spi_msg *msg)
 	if(dev->spi_offload_rx_support_en || dev->spi_offload_tx_support_en)
 		dev->offload_configured = 1;
 
-	size = sizeof(*xfer->cmd_fifo) * (msg->msg_cmd_len + 3);
-
-	xfer = (spi_transfer_fifo *)malloc(sizeof(*xfer) + size);
-	if (!xfer)
+	handle = spi_eng_get_handle(dev, msg);
+	if (!handle)
 		return -1;
 
-	xfer->cmd_fifo_len = 0;
-
-	spi_eng_compile_message(dev, msg, xfer);
+	dev->rx_length = handle->rx_length;
+	dev->tx_length = handle->tx_length;
 
 	// CMD OFFLOAD
-	for (i = 0; i < xfer->cmd_fifo_len; i++)
-		spi_eng_write(dev, SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0), xfer->cmd_fifo[i]);
+	// The offload program is replayed on every trigger, independently of
+	// the CMD FIFO, so it always carries its own CLK_DIV/CONFIG.
+	spi_eng_write(dev, SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+			SPI_ENGINE_CMD_WRITE(SPI_ENGINE_CMD_REG_CLK_DIV,
+								  dev->clk_div));
+	spi_eng_write(dev, SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+			SPI_ENGINE_CMD_WRITE(SPI_ENGINE_CMD_REG_CONFIG,
+								dev->spi_config));
+	for (i = 0; i < handle->xfer.cmd_fifo_len; i++)
+		spi_eng_write(dev, SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+					  handle->xfer.cmd_fifo[i]);
 
 	// TX OFFLOAD
 	words_number = spi_get_words_number(dev, dev->tx_length);
 	for(i = 0; i < words_number; i++)
 		spi_eng_write(dev, SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0), msg->tx_buf[i]);
 
-    free(xfer);
-
 	return 0;
 }
 
@@ -397,18 +540,20 @@ int32_t spi_eng_transfer_multiple_msgs(spi_dev *dev, uint8_t no_of_messages)
 	if(dev->rx_length) {
 		dev->rx_length *= no_of_messages;
 
-		spi_eng_dma_write(dev, DMAC_REG_CTRL, 0x0);
-		spi_eng_dma_write(dev, DMAC_REG_CTRL, DMAC_CTRL_ENABLE);
-		spi_eng_dma_write(dev, DMAC_REG_IRQ_MASK, 0x0);
+		spi_eng_rx_dma_write(dev, DMAC_REG_CTRL, 0x0);
+		spi_eng_rx_dma_write(dev, DMAC_REG_CTRL, DMAC_CTRL_ENABLE);
+		spi_eng_rx_dma_write(dev, DMAC_REG_IRQ_MASK, 0x0);
 
-		spi_eng_dma_write(dev, DMAC_REG_IRQ_PENDING, 0xff);
+		spi_eng_rx_dma_write(dev, DMAC_REG_IRQ_PENDING, 0xff);
 
-		spi_eng_dma_write(dev, DMAC_REG_DEST_ADDRESS, dev->rx_dma_startaddr);
-		spi_eng_dma_write(dev, DMAC_REG_DEST_STRIDE, 0x0);
-		spi_eng_dma_write(dev, DMAC_REG_X_LENGTH, dev->rx_length - 1);
-		spi_eng_dma_write(dev, DMAC_REG_Y_LENGTH, 0x0);
+		spi_eng_rx_dma_write(dev, DMAC_REG_DEST_ADDRESS, dev->rx_dma_startaddr);
+		spi_eng_rx_dma_write(dev, DMAC_REG_DEST_STRIDE, 0x0);
+		spi_eng_rx_dma_write(dev, DMAC_REG_X_LENGTH, dev->rx_length - 1);
+		spi_eng_rx_dma_write(dev, DMAC_REG_Y_LENGTH, 0x0);
 
-		spi_eng_dma_write(dev, DMAC_REG_START_TRANSFER, 0x1);
+		spi_eng_rx_dma_write(dev, DMAC_REG_START_TRANSFER, 0x1);
+		if (spi_eng_dma_wait_queued(dev->spi_offload_rx_dma_baseaddr))
+			return -1;
 	}
 
 	if(dev->tx_length) {
@@ -422,19 +567,214 @@ int32_t spi_eng_transfer_multiple_msgs(spi_dev *dev, uint8_t no_of_messages)
 
 		spi_eng_dma_write(dev, DMAC_REG_SRC_ADDRESS, dev->tx_dma_startaddr);
 		spi_eng_dma_write(dev, DMAC_REG_SRC_STRIDE, 0x0);
-		spi_eng_dma_write(dev, DMAC_REG_X_LENGTH, dev->rx_length - 1);
+		spi_eng_dma_write(dev, DMAC_REG_X_LENGTH, dev->tx_length - 1);
 		spi_eng_dma_write(dev, DMAC_REG_Y_LENGTH, 0x0);
 		spi_eng_dma_write(dev, DMAC_REG_FLAGS, 0x1);
 
 		spi_eng_dma_write(dev, DMAC_REG_START_TRANSFER, 0x1);
+		if (spi_eng_dma_wait_queued(dev->spi_offload_tx_dma_baseaddr))
+			return -1;
 	}
 
-	mdelay(100);
-    spi_eng_write(dev, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0x0001);  // Enable SPI engine
+	// The DMACs have accepted their transfers, start the offload
+	spi_eng_write(dev, SPI_ENGINE_REG_OFFLOAD_CTRL(0), SPI_ENGINE_OFFLOAD_CTRL_ENABLE);
 
 	dev->offload_configured = 0;
 
-    return 0;
+	return 0;
+}
+
+/***************************************************************************//**
+* @brief spi_eng_stream_queue_blocks
+*
+* Hands the next blocks of the ring to the DMAC for as long as it accepts
+* them, keeping the ID of every queued block.
+*******************************************************************************/
+static void spi_eng_stream_queue_blocks(spi_dev *dev)
+{
+	spi_eng_stream	*stream = &dev->stream;
+	uint32_t		reg_val;
+
+	while (stream->running &&
+		   (stream->hw_count < SPI_ENGINE_STREAM_HW_DEPTH) &&
+		   (stream->hw_count < stream->num_blocks)) {
+		spi_eng_dma_read(dev, DMAC_REG_START_TRANSFER, &reg_val);
+		if (reg_val & 0x1)
+			break;
+
+		spi_eng_dma_read(dev, DMAC_REG_TRANSFER_ID, &reg_val);
+		stream->hw_id[(stream->hw_head + stream->hw_count) %
+				SPI_ENGINE_STREAM_HW_DEPTH] = reg_val;
+		stream->hw_count++;
+
+		spi_eng_rx_dma_write(dev, DMAC_REG_DEST_ADDRESS, stream->buf_addr +
+				stream->queue_idx * stream->block_size);
+		spi_eng_rx_dma_write(dev, DMAC_REG_DEST_STRIDE, 0x0);
+		spi_eng_rx_dma_write(dev, DMAC_REG_X_LENGTH, stream->block_size - 1);
+		spi_eng_rx_dma_write(dev, DMAC_REG_Y_LENGTH, 0x0);
+		spi_eng_rx_dma_write(dev, DMAC_REG_FLAGS, 0x0);
+		spi_eng_rx_dma_write(dev, DMAC_REG_START_TRANSFER, 0x1);
+
+		stream->queue_idx = (stream->queue_idx + 1) % stream->num_blocks;
+	}
+}
+
+/***************************************************************************//**
+* @brief spi_eng_stream_isr
+*
+* Several blocks can complete before the interrupt is serviced, so every
+* queued block whose transfer ID is done is handed to the consumer, oldest
+* first. The freed DMAC queue slots are then refilled with the next blocks
+* of the ring.
+*******************************************************************************/
+static void spi_eng_stream_isr(void *instance)
+{
+	spi_dev			*dev = instance;
+	spi_eng_stream	*stream = &dev->stream;
+	uint32_t		reg_val;
+	uint32_t		done;
+	uint32_t		block;
+
+	spi_eng_dma_read(dev, DMAC_REG_IRQ_PENDING, &reg_val);
+	spi_eng_rx_dma_write(dev, DMAC_REG_IRQ_PENDING, reg_val);
+
+	spi_eng_dma_read(dev, DMAC_REG_TRANSFER_DONE, &done);
+	while (stream->hw_count &&
+		   (done & (1 << stream->hw_id[stream->hw_head]))) {
+		stream->hw_head = (stream->hw_head + 1) % SPI_ENGINE_STREAM_HW_DEPTH;
+		stream->hw_count--;
+
+		block = stream->buf_addr + stream->done_idx * stream->block_size;
+		stream->done_idx = (stream->done_idx + 1) % stream->num_blocks;
+		stream->blocks_done++;
+
+		Xil_DCacheInvalidateRange(block, stream->block_size);
+		if (stream->callback)
+			stream->callback(stream->callback_ref, (uint8_t *)block,
+							 stream->block_size);
+	}
+
+	spi_eng_stream_queue_blocks(dev);
+}
+
+/***************************************************************************//**
+* @brief spi_eng_stream_start
+*
+* Loads msg into the offload and streams its results into a ring of
+* num_blocks DMA blocks. Every offload trigger (one conversion) appends one
+* message worth of data; each filled block is passed to the callback.
+*******************************************************************************/
+int32_t spi_eng_stream_start(spi_dev *dev,
+							 spi_msg *msg,
+							 spi_eng_stream_init *init)
+{
+	spi_eng_stream	*stream = &dev->stream;
+	XScuGic_Config	*gic_config;
+	int32_t			status;
+
+	if (!dev->spi_offload_rx_support_en ||
+		(init->num_blocks < SPI_ENGINE_STREAM_MIN_BLOCKS)) {
+		printf("%s: Invalid stream configuration.\n", __func__);
+		return -1;
+	}
+
+	// Drop whatever program a previous load left in the offload memory
+	spi_eng_write(dev, SPI_ENGINE_REG_OFFLOAD_RESET(0), 0x1);
+	spi_eng_write(dev, SPI_ENGINE_REG_OFFLOAD_RESET(0), 0x0);
+
+	if (spi_eng_offload_load_msg(dev, msg))
+		return -1;
+
+	if (!dev->rx_length || (init->block_size % dev->rx_length)) {
+		printf("%s: Block size must be a multiple of %d bytes.\n",
+			   __func__, (int)dev->rx_length);
+		dev->offload_configured = 0;
+		return -1;
+	}
+
+	// The DMAC can only write whole bus words and a block is invalidated
+	// on its own, so it may not share a cache line with the next one
+	if ((init->buf_addr % SPI_ENGINE_STREAM_ALIGN) ||
+		(init->block_size % SPI_ENGINE_STREAM_ALIGN)) {
+		printf("%s: Blocks must be aligned to %d bytes.\n",
+			   __func__, SPI_ENGINE_STREAM_ALIGN);
+		dev->offload_configured = 0;
+		return -1;
+	}
+
+	stream->buf_addr = init->buf_addr;
+	stream->block_size = init->block_size;
+	stream->num_blocks = init->num_blocks;
+	stream->dma_int_id = init->dma_int_id;
+	stream->callback = init->callback;
+	stream->callback_ref = init->callback_ref;
+	stream->queue_idx = 0;
+	stream->done_idx = 0;
+	stream->hw_head = 0;
+	stream->hw_count = 0;
+	stream->blocks_done = 0;
+
+	gic_config = XScuGic_LookupConfig(XPAR_PS7_SCUGIC_0_DEVICE_ID);
+	if (gic_config == NULL)
+		return -1;
+
+	status = XScuGic_CfgInitialize(&spi_eng_gic, gic_config,
+			gic_config->CpuBaseAddress);
+	if (status)
+		return -1;
+
+	XScuGic_SetPriorityTriggerType(&spi_eng_gic, stream->dma_int_id, 0x0, 0x3);
+	status = XScuGic_Connect(&spi_eng_gic, stream->dma_int_id,
+			(Xil_ExceptionHandler)spi_eng_stream_isr, dev);
+	if (status)
+		return -1;
+
+	XScuGic_Enable(&spi_eng_gic, stream->dma_int_id);
+
+	Xil_ExceptionInit();
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+			(Xil_ExceptionHandler)XScuGic_InterruptHandler, (void *)&spi_eng_gic);
+	Xil_ExceptionEnable();
+
+	spi_eng_rx_dma_write(dev, DMAC_REG_CTRL, 0x0);
+	spi_eng_rx_dma_write(dev, DMAC_REG_CTRL, DMAC_CTRL_ENABLE);
+	spi_eng_rx_dma_write(dev, DMAC_REG_IRQ_PENDING, 0xff);
+	spi_eng_rx_dma_write(dev, DMAC_REG_IRQ_MASK, 0x0);
+
+	// The rest of the ring is queued from the DMAC interrupts
+	stream->running = 1;
+	spi_eng_stream_queue_blocks(dev);
+	if (spi_eng_dma_wait_queued(dev->spi_offload_rx_dma_baseaddr)) {
+		spi_eng_stream_stop(dev);
+		return -1;
+	}
+
+	spi_eng_write(dev, SPI_ENGINE_REG_OFFLOAD_CTRL(0), SPI_ENGINE_OFFLOAD_CTRL_ENABLE);
+
+	return 0;
+}
+
+/***************************************************************************//**
+* @brief spi_eng_stream_stop
+*******************************************************************************/
+int32_t spi_eng_stream_stop(spi_dev *dev)
+{
+	spi_eng_stream *stream = &dev->stream;
+
+	stream->running = 0;
+
+	spi_eng_write(dev, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0x0);
+
+	spi_eng_rx_dma_write(dev, DMAC_REG_IRQ_MASK, DMAC_IRQ_SOT | DMAC_IRQ_EOT);
+	spi_eng_rx_dma_write(dev, DMAC_REG_CTRL, 0x0);
+	spi_eng_rx_dma_write(dev, DMAC_REG_IRQ_PENDING, 0xff);
+
+	XScuGic_Disable(&spi_eng_gic, stream->dma_int_id);
+	XScuGic_Disconnect(&spi_eng_gic, stream->dma_int_id);
+
+	dev->offload_configured = 0;
+
+	return 0;
 }
 
 /***************************************************************************//**
@@ -444,6 +784,7 @@ int32_t spi_eng_setup(spi_dev **device,
 				  	  spi_init_param init_param)
 {
 	spi_dev		*dev;
+	uint8_t		i;
 
 	dev = (spi_dev *)malloc(sizeof(*dev));
 	if (!dev)
@@ -457,9 +798,17 @@ int32_t spi_eng_setup(spi_dev **device,
 	dev->data_width	= 8; // 1 bytes
 	dev->rx_length = 0;
 	dev->tx_length = 0;
+	dev->offload_configured = 0;
 
 	dev->clk_div = dev->ref_clk_hz / (2 * dev->spi_clk_hz) - 1;
 
+	// Nothing compiled yet; CLK_DIV/CONFIG are written on the first transfer
+	for (i = 0; i < SPI_ENGINE_MSG_CACHE_SIZE; i++)
+		dev->msg_cache[i].valid = 0;
+	dev->msg_cache_next = 0;
+	dev->cfg_valid = 0;
+	dev->stream.running = 0;
+
 	dev->spi_offload_rx_support_en = init_param.spi_offload_rx_support_en;
 	dev->spi_offload_tx_support_en = init_param.spi_offload_tx_support_en;
 	dev->spi_offload_tx_dma_baseaddr = init_param.spi_offload_tx_dma_baseaddr;
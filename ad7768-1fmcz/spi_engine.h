@@ -143,6 +143,14 @@
 #define DMAC_IRQ_SOT				(1 << 0)
 #define DMAC_IRQ_EOT				(1 << 1)
 
+/* The DMAC holds one active and one queued transfer */
+#define SPI_ENGINE_STREAM_MIN_BLOCKS	2
+// Transfer IDs are 2 bits wide, so at most 4 transfers can be told apart
+#define SPI_ENGINE_STREAM_HW_DEPTH	4
+// Ring blocks must start and end on a cache line, which also covers the
+// DMAC destination bus width
+#define SPI_ENGINE_STREAM_ALIGN		32
+
 
 #define CS_DEASSERT				0 << 28
 
@@ -160,29 +168,17 @@
 #define	TRANSFER_R_W_CMD		5 << 28
 #define	TRANSFER_R_W(x)			(TRANSFER_R_W_CMD | (x & 0xF))
 
+/* Longest user command list a message may carry */
+#define SPI_ENGINE_MAX_MSG_CMDS		16
+/* CLK_DIV + CONFIG + user commands + SYNC */
+#define SPI_ENGINE_MAX_PROG_LEN		(SPI_ENGINE_MAX_MSG_CMDS + 3)
+/* Compiled programs kept per device by spi_eng_transfer_message() */
+#define SPI_ENGINE_MSG_CACHE_SIZE	4
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
-typedef struct {
-	uint32_t	spi_baseaddr;
-	uint8_t		chip_select;
-	uint8_t		spi_config;
-	uint32_t 	spi_clk_hz;
-	uint32_t	ref_clk_hz;
-	uint32_t	clk_div;
-	uint32_t	rx_length;
-	uint32_t	tx_length;
-	uint8_t 	spi_offload_rx_support_en;
-	uint32_t	spi_offload_rx_dma_baseaddr;
-	uint32_t	rx_dma_startaddr;
-	uint8_t		spi_offload_tx_support_en;
-	uint32_t	spi_offload_tx_dma_baseaddr;
-	uint32_t	tx_dma_startaddr;
-	uint8_t		offload_configured;
-	uint8_t		data_width;
-} spi_dev;
-
 typedef struct {
 	uint32_t 	spi_baseaddr;
 	uint8_t		chip_select;
@@ -207,9 +203,76 @@ typedef struct {
 
 typedef struct {
 	uint32_t		cmd_fifo_len;
-	uint16_t		cmd_fifo[];
+	uint16_t		cmd_fifo[SPI_ENGINE_MAX_PROG_LEN];
 } spi_transfer_fifo;
 
+typedef struct {
+	spi_transfer_fifo	xfer;		// compiled user commands + SYNC
+	uint32_t		msg_cmds[SPI_ENGINE_MAX_MSG_CMDS];
+	uint8_t			msg_cmd_len;
+	uint32_t		rx_length;
+	uint32_t		tx_length;
+	uint32_t		clk_div;	// SLEEP commands depend on it
+	uint8_t			offload;	// compiled for the offload path
+	uint8_t			valid;
+} spi_eng_msg_handle;
+
+typedef void (*spi_eng_stream_callback)(void *ref,
+										uint8_t *block,
+										uint32_t block_size);
+
+typedef struct {
+	uint32_t		buf_addr;		// ring base, block_size * num_blocks bytes
+	uint32_t		block_size;		// multiple of the rx length and of
+						// SPI_ENGINE_STREAM_ALIGN
+	uint8_t			num_blocks;
+	uint32_t		dma_int_id;		// GIC interrupt of the Rx DMAC
+	spi_eng_stream_callback	callback;	// called from the DMAC interrupt
+	void			*callback_ref;
+} spi_eng_stream_init;
+
+typedef struct {
+	uint32_t		buf_addr;
+	uint32_t		block_size;
+	uint8_t			num_blocks;
+	uint32_t		dma_int_id;
+	spi_eng_stream_callback	callback;
+	void			*callback_ref;
+	volatile uint8_t	queue_idx;	// next block handed to the DMAC
+	volatile uint8_t	done_idx;	// next block the DMAC completes
+	uint32_t		hw_id[SPI_ENGINE_STREAM_HW_DEPTH];	// of the
+						// queued blocks, oldest first
+	volatile uint8_t	hw_head;
+	volatile uint8_t	hw_count;
+	volatile uint32_t	blocks_done;
+	volatile uint8_t	running;
+} spi_eng_stream;
+
+typedef struct {
+	uint32_t	spi_baseaddr;
+	uint8_t		chip_select;
+	uint8_t		spi_config;
+	uint32_t 	spi_clk_hz;
+	uint32_t	ref_clk_hz;
+	uint32_t	clk_div;
+	uint32_t	rx_length;
+	uint32_t	tx_length;
+	uint8_t 	spi_offload_rx_support_en;
+	uint32_t	spi_offload_rx_dma_baseaddr;
+	uint32_t	rx_dma_startaddr;
+	uint8_t		spi_offload_tx_support_en;
+	uint32_t	spi_offload_tx_dma_baseaddr;
+	uint32_t	tx_dma_startaddr;
+	uint8_t		offload_configured;
+	uint8_t		data_width;
+	uint32_t	cfg_clk_div;	// last CLK_DIV written to the engine
+	uint8_t		cfg_spi_config;	// last CONFIG written to the engine
+	uint8_t		cfg_valid;
+	spi_eng_msg_handle	msg_cache[SPI_ENGINE_MSG_CACHE_SIZE];
+	uint8_t		msg_cache_next;
+	spi_eng_stream	stream;
+} spi_dev;
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -238,6 +301,20 @@ int32_t spi_eng_offload_load_msg(spi_dev *dev, spi_msg *msg);
 
 int32_t spi_eng_transfer_message(spi_dev *dev, spi_msg *msg);
 
+int32_t spi_eng_compile_handle(spi_dev *dev,
+							   spi_msg *msg,
+							   spi_eng_msg_handle *handle);
+
+int32_t spi_eng_transfer_handle(spi_dev *dev,
+								spi_eng_msg_handle *handle,
+								spi_msg *msg);
+
 int32_t spi_eng_transfer_multiple_msgs(spi_dev *dev, uint8_t no_of_messages);
 
+int32_t spi_eng_stream_start(spi_dev *dev,
+							 spi_msg *msg,
+							 spi_eng_stream_init *init);
+
+int32_t spi_eng_stream_stop(spi_dev *dev);
+
 #endif // SPI_H_
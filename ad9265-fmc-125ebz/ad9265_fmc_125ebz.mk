@@ -13,6 +13,7 @@
 
 M_INC_DIRS := $(NOOS-DIR)/common_drivers/platform_drivers
 M_INC_DIRS += $(NOOS-DIR)/common_drivers/adc_core
+M_INC_DIRS += $(NOOS-DIR)/common_drivers/adc_check
 M_INC_DIRS += $(NOOS-DIR)/common_drivers/dmac_core
 M_INC_DIRS += $(NOOS-DIR)/drivers/ad9265
 
@@ -41,6 +41,7 @@
 /******************************************************************************/
 #include <malloc.h>
 #include <limits.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -555,6 +556,259 @@ const char *ad9361_ensm_states[] = {
 	"rx", "rx_flush", "fdd", "fdd_flush"
 };
 
+/*
+ * Registers the part updates on its own (status, readback, calibration
+ * results and self-clearing controls). These always go to the bus.
+ */
+static const uint16_t ad9361_volatile_regs[][2] = {
+	{REG_SPI_CONF, REG_SPI_CONF},
+	{REG_START_TEMP_READING, REG_TEMPERATURE},
+	{REG_CALIBRATION_CTRL, REG_STATE},
+	{REG_AUXADC_WORD_MSB, REG_AUXADC_LSB},
+	{REG_CH_1_OVERFLOW, REG_CH_2_OVERFLOW},
+	{REG_TX_FILTER_COEF_READ_DATA_1, REG_TX_FILTER_COEF_READ_DATA_2},
+	{REG_TX_RSSI1, REG_TX_RSSI_LSB},
+	{REG_TX1_OUT_1_PHASE_CORR, REG_TX2_OUT_2_OFFSET_Q},
+	{REG_QUAD_CAL_STATUS_TX1, REG_QUAD_CAL_COUNT},
+	{REG_TX_BBF_R1, REG_TX_BBF_R2B},
+	{REG_RX_FILTER_COEF_READ_DATA_1, REG_RX_FILTER_COEF_READ_DATA_2},
+	{REG_LMT_OVERLOAD_COUNTERS, REG_DIGITAL_SAT_COUNTER},
+	{REG_GAIN_TABLE_READ_DATA1, REG_GAIN_TABLE_READ_DATA3},
+	{REG_GM_SUB_TABLE_GAIN_READ, REG_GM_SUB_TABLE_CTRL_READ},
+	{REG_GAIN_ERROR_READ, REG_LNA_GAIN_DIFF_READ_BACK},
+	{REG_CAL_TEMP_SENSOR_WORD, REG_CAL_TEMP_SENSOR_WORD},
+	{REG_RX1_BB_DC_WORD_I_MSB, REG_PREAMBLE_LSB},
+	{REG_RX1_BBF_R1A, REG_RX_BBF_R5_TUNE},
+	{REG_RX_FORCE_ALC, REG_RX_ALC_VARACTOR},
+	{REG_RX_CAL_STATUS, REG_RX_CAL_STATUS},
+	{REG_RX_CP_OVERRANGE_VCO_LOCK, REG_RX_CP_OVERRANGE_VCO_LOCK},
+	{REG_RX_FAST_LOCK_PROGRAM_READ, REG_RX_FAST_LOCK_PROGRAM_READ},
+	{REG_TX_FORCE_ALC, REG_TX_FORCE_ALC + 3},
+	{REG_TX_CAL_STATUS, REG_TX_CAL_STATUS},
+	{REG_TX_CP_OVERRANGE_VCO_LOCK, REG_TX_CP_OVERRANGE_VCO_LOCK},
+	{REG_TX_FAST_LOCK_PROGRAM_READ, REG_TX_FAST_LOCK_PROGRAM_READ},
+	{REG_GAIN_RX1, REG_GAIN_RX2},
+};
+
+/**
+ * Check if a register must bypass the register shadow.
+ * @param reg The register address.
+ * @return true if the register is volatile.
+ */
+static bool ad9361_reg_is_volatile(uint32_t reg)
+{
+	uint32_t i;
+
+	for (i = 0; i < ARRAY_SIZE(ad9361_volatile_regs); i++)
+		if ((reg >= ad9361_volatile_regs[i][0]) &&
+		    (reg <= ad9361_volatile_regs[i][1]))
+			return true;
+
+	return false;
+}
+
+/**
+ * Update the register shadow with the data of a (multi-byte) write.
+ * @param spi
+ * @param reg The register address.
+ * @param tbuf The data buffer.
+ * @param num The number of bytes written.
+ */
+static void ad9361_reg_shadow_update(struct spi_device *spi,
+	uint32_t reg, const uint8_t *tbuf, uint32_t num)
+{
+	struct ad9361_reg_shadow *shadow = spi->shadow;
+	uint32_t i;
+
+	for (i = 0; i < num; i++, reg--) {
+		reg = AD_ADDR(reg);
+		if (ad9361_reg_is_volatile(reg)) {
+			if (reg == REG_SPI_CONF)
+				memset(shadow->valid, 0, sizeof(shadow->valid));
+			continue;
+		}
+		shadow->val[reg] = tbuf[i];
+		shadow->valid[reg / 8] |= (1 << (reg % 8));
+	}
+}
+
+/**
+ * Enable/disable the register shadow. With the shadow enabled the single
+ * register reads of the non-volatile registers already written by the driver
+ * are served from RAM, which saves the read half of read-modify-write field
+ * updates. In verify mode every shadow hit is also read back from the part
+ * and compared.
+ * @param phy The AD9361 state structure.
+ * @param enable Enable/disable option.
+ * @param verify Enable/disable the verify mode.
+ */
+void ad9361_reg_shadow_enable(struct ad9361_rf_phy *phy, bool enable,
+	bool verify)
+{
+	ad9361_reg_shadow_invalidate(phy);
+	phy->reg_shadow.verify = verify;
+	phy->spi->shadow = enable ? &phy->reg_shadow : NULL;
+}
+
+/**
+ * Drop the content of the register shadow.
+ * @param phy The AD9361 state structure.
+ */
+void ad9361_reg_shadow_invalidate(struct ad9361_rf_phy *phy)
+{
+	memset(phy->reg_shadow.valid, 0, sizeof(phy->reg_shadow.valid));
+	phy->reg_shadow.hits = 0;
+	phy->reg_shadow.mismatches = 0;
+}
+
+/**
+ * Compare every valid entry of the register shadow with the part. The
+ * mismatching entries are dropped.
+ * @param phy The AD9361 state structure.
+ * @return The number of mismatches or negative error code in case of failure.
+ */
+int32_t ad9361_reg_shadow_verify(struct ad9361_rf_phy *phy)
+{
+	struct ad9361_reg_shadow *shadow = &phy->reg_shadow;
+	struct spi_device *spi = phy->spi;
+	struct ad9361_reg_shadow *save = spi->shadow;
+	int32_t ret, cnt = 0;
+	uint32_t reg;
+	uint8_t val;
+
+	spi->shadow = NULL;
+	for (reg = 0; reg < AD9361_NUM_REGS; reg++) {
+		if (!(shadow->valid[reg / 8] & (1 << (reg % 8))))
+			continue;
+		ret = ad9361_spi_readm(spi, reg, &val, 1);
+		if (ret < 0) {
+			spi->shadow = save;
+			return ret;
+		}
+		if (val != shadow->val[reg]) {
+			dev_err(&spi->dev, "%s: reg 0x%"PRIX32" shadow 0x%X hw 0x%X",
+				__func__, reg, shadow->val[reg], val);
+			shadow->valid[reg / 8] &= ~(1 << (reg % 8));
+			cnt++;
+		}
+	}
+	spi->shadow = save;
+	shadow->mismatches += cnt;
+
+	return cnt;
+}
+
+/**
+ * Send the writes queued in the SPI batch of the device.
+ * @param spi
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_spi_batch_flush(struct spi_device *spi)
+{
+	struct spi_batch *batch = spi->batch;
+	int32_t ret;
+
+	if (!batch || !batch->num_xfers)
+		return 0;
+
+	ret = spi_write_batch(spi, batch->buf, batch->xfer_len,
+			      batch->num_xfers);
+	batch->len = 0;
+	batch->num_xfers = 0;
+	if (ret < 0) {
+		dev_err(&spi->dev, "Batch Write Error %"PRId32, ret);
+		return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * Queue a write into the SPI batch of the device. The device decrements the
+ * register address in multi-byte mode, so a single byte write to the register
+ * right below the last queued one extends the previous transfer.
+ * @param spi
+ * @param reg The register address.
+ * @param tbuf The data buffer.
+ * @param num The number of bytes to write.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_spi_batch_add(struct spi_device *spi,
+	uint32_t reg, const uint8_t *tbuf, uint32_t num)
+{
+	struct spi_batch *batch = spi->batch;
+	uint8_t *xfer;
+	uint32_t cnt, i;
+	uint16_t cmd;
+	int32_t ret;
+
+	if (batch->num_xfers && (num == 1)) {
+		cnt = batch->xfer_len[batch->num_xfers - 1] - 2;
+		xfer = &batch->buf[batch->len - cnt - 2];
+		cmd = (xfer[0] << 8) | xfer[1];
+		if ((cnt < MAX_MBYTE_SPI) && (reg + cnt == AD_ADDR(cmd))) {
+			cmd = AD_WRITE | AD_CNT(cnt + 1) | AD_ADDR(cmd);
+			xfer[0] = cmd >> 8;
+			xfer[1] = cmd & 0xFF;
+			batch->buf[batch->len++] = tbuf[0];
+			batch->xfer_len[batch->num_xfers - 1]++;
+			return 0;
+		}
+	}
+
+	if (batch->num_xfers == SPI_BATCH_MAX_XFERS) {
+		ret = ad9361_spi_batch_flush(spi);
+		if (ret < 0)
+			return ret;
+	}
+
+	cmd = AD_WRITE | AD_CNT(num) | AD_ADDR(reg);
+	batch->buf[batch->len++] = cmd >> 8;
+	batch->buf[batch->len++] = cmd & 0xFF;
+	for (i = 0; i < num; i++)
+		batch->buf[batch->len++] = tbuf[i];
+	batch->xfer_len[batch->num_xfers++] = num + 2;
+
+	return 0;
+}
+
+/**
+ * Start queueing the register writes instead of sending them one by one.
+ * Calls can be nested; the queue is sent when it is full, before any register
+ * read and by the outermost ad9361_spi_batch_end(). Code that relies on a
+ * delay between two writes must not run inside a batch.
+ * @param spi
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_spi_batch_begin(struct spi_device *spi)
+{
+	if (!spi->batch) {
+		spi->batch = (struct spi_batch *)zmalloc(sizeof(*spi->batch));
+		if (!spi->batch)
+			return -ENOMEM;
+	}
+
+	spi->batch->depth++;
+
+	return 0;
+}
+
+/**
+ * Stop queueing the register writes and send the queued ones.
+ * @param spi
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_spi_batch_end(struct spi_device *spi)
+{
+	if (!spi->batch || !spi->batch->depth)
+		return -EINVAL;
+
+	if (--spi->batch->depth)
+		return 0;
+
+	return ad9361_spi_batch_flush(spi);
+}
+
 /**
  * SPI multiple bytes register read.
  * @param spi
@@ -566,6 +820,7 @@ const char *ad9361_ensm_states[] = {
 int32_t ad9361_spi_readm(struct spi_device *spi, uint32_t reg,
 	uint8_t *rbuf, uint32_t num)
 {
+	struct ad9361_reg_shadow *shadow;
 	uint8_t buf[2];
 	int32_t ret;
 	uint16_t cmd;
@@ -573,6 +828,22 @@ int32_t ad9361_spi_readm(struct spi_device *spi, uint32_t reg,
 	if (num > MAX_MBYTE_SPI)
 		return -EINVAL;
 
+	shadow = spi->shadow;
+	if (shadow && (num == 1) &&
+	    (shadow->valid[AD_ADDR(reg) / 8] & (1 << (reg % 8)))) {
+		shadow->hits++;
+		if (!shadow->verify) {
+			rbuf[0] = shadow->val[AD_ADDR(reg)];
+			return 0;
+		}
+	} else {
+		shadow = NULL;
+	}
+
+	ret = ad9361_spi_batch_flush(spi);
+	if (ret < 0)
+		return ret;
+
 	cmd = AD_READ | AD_CNT(num) | AD_ADDR(reg);
 	buf[0] = cmd >> 8;
 	buf[1] = cmd & 0xFF;
@@ -582,6 +853,13 @@ int32_t ad9361_spi_readm(struct spi_device *spi, uint32_t reg,
 		dev_err(&spi->dev, "Read Error %"PRId32, ret);
 		return ret;
 	}
+
+	if (shadow && (rbuf[0] != shadow->val[AD_ADDR(reg)])) {
+		dev_err(&spi->dev, "%s: reg 0x%"PRIX32" shadow 0x%X hw 0x%X",
+			__func__, reg, shadow->val[AD_ADDR(reg)], rbuf[0]);
+		shadow->mismatches++;
+		shadow->val[AD_ADDR(reg)] = rbuf[0];
+	}
 #ifdef _DEBUG
 	{
 		int32_t i;
@@ -668,6 +946,12 @@ int32_t ad9361_spi_write(struct spi_device *spi,
 	buf[1] = cmd & 0xFF;
 	buf[2] = val;
 
+	if (spi->shadow)
+		ad9361_reg_shadow_update(spi, reg, &buf[2], 1);
+
+	if (spi->batch && spi->batch->depth)
+		return ad9361_spi_batch_add(spi, reg, &buf[2], 1);
+
 	ret = spi_write_then_read(spi, buf, 3, NULL, 0);
 	if (ret < 0) {
 		dev_err(&spi->dev, "Write Error %"PRId32, ret);
@@ -738,6 +1022,12 @@ static int32_t ad9361_spi_writem(struct spi_device *spi,
 	if (num > MAX_MBYTE_SPI)
 		return -EINVAL;
 
+	if (spi->shadow)
+		ad9361_reg_shadow_update(spi, reg, tbuf, num);
+
+	if (spi->batch && spi->batch->depth)
+		return ad9361_spi_batch_add(spi, reg, tbuf, num);
+
 	cmd = AD_WRITE | AD_CNT(num) | AD_ADDR(reg);
 	buf[0] = cmd >> 8;
 	buf[1] = cmd & 0xFF;
@@ -871,6 +1161,8 @@ int32_t ad9361_1rx1tx_channel_map(struct ad9361_rf_phy *phy, bool tx, int32_t ch
  */
 int32_t ad9361_reset(struct ad9361_rf_phy *phy)
 {
+	ad9361_reg_shadow_invalidate(phy);
+
 	if (gpio_is_valid(phy->pdata->gpio_resetb)) {
 		gpio_set_value(phy->pdata->gpio_resetb, 0);
 		mdelay(1);
@@ -1222,6 +1514,7 @@ static int32_t ad9361_load_gt(struct ad9361_rf_phy *phy, uint64_t freq, uint32_t
 	const uint8_t(*tab)[3];
 	enum rx_gain_table_name band;
 	uint32_t index_max, i, lna;
+	int32_t ret;
 
 	dev_dbg(&phy->spi->dev, "%s: frequency %"PRIu64, __func__, freq);
 
@@ -1249,14 +1542,19 @@ static int32_t ad9361_load_gt(struct ad9361_rf_phy *phy, uint64_t freq, uint32_t
 	lna = phy->pdata->elna_ctrl.elna_in_gaintable_all_index_en ?
 			EXT_LNA_CTRL : 0;
 
+	ret = ad9361_spi_batch_begin(spi);
+	if (ret < 0)
+		return ret;
+
 	ad9361_spi_write(spi, REG_GAIN_TABLE_CONFIG, START_GAIN_TABLE_CLOCK |
 		RECEIVER_SELECT(dest)); /* Start Gain Table Clock */
 
 	for (i = 0; i < index_max; i++) {
-		ad9361_spi_write(spi, REG_GAIN_TABLE_ADDRESS, i); /* Gain Table Index */
-		ad9361_spi_write(spi, REG_GAIN_TABLE_WRITE_DATA1, tab[i][0] | lna); /* Ext LNA, Int LNA, & Mixer Gain Word */
-		ad9361_spi_write(spi, REG_GAIN_TABLE_WRITE_DATA2, tab[i][1]); /* TIA & LPF Word */
+		/* Descending register order, merged into one SPI burst */
 		ad9361_spi_write(spi, REG_GAIN_TABLE_WRITE_DATA3, tab[i][2]); /* DC Cal bit & Dig Gain Word */
+		ad9361_spi_write(spi, REG_GAIN_TABLE_WRITE_DATA2, tab[i][1]); /* TIA & LPF Word */
+		ad9361_spi_write(spi, REG_GAIN_TABLE_WRITE_DATA1, tab[i][0] | lna); /* Ext LNA, Int LNA, & Mixer Gain Word */
+		ad9361_spi_write(spi, REG_GAIN_TABLE_ADDRESS, i); /* Gain Table Index */
 		ad9361_spi_write(spi, REG_GAIN_TABLE_CONFIG,
 			START_GAIN_TABLE_CLOCK |
 			WRITE_GAIN_TABLE |
@@ -1271,6 +1569,10 @@ static int32_t ad9361_load_gt(struct ad9361_rf_phy *phy, uint64_t freq, uint32_t
 	ad9361_spi_write(spi, REG_GAIN_TABLE_READ_DATA1, 0); /* Dummy Write to delay ~1u */
 	ad9361_spi_write(spi, REG_GAIN_TABLE_CONFIG, 0); /* Stop Gain Table Clock */
 
+	ret = ad9361_spi_batch_end(spi);
+	if (ret < 0)
+		return ret;
+
 	phy->current_table = band;
 
 	return 0;
@@ -1322,17 +1624,22 @@ enum ad9361_clkout mode)
  */
 static int32_t ad9361_load_mixer_gm_subtable(struct ad9361_rf_phy *phy)
 {
-	int32_t i, addr;
+	int32_t i, addr, ret;
 	dev_dbg(&phy->spi->dev, "%s", __func__);
 
+	ret = ad9361_spi_batch_begin(phy->spi);
+	if (ret < 0)
+		return ret;
+
 	ad9361_spi_write(phy->spi, REG_GM_SUB_TABLE_CONFIG,
 		START_GM_SUB_TABLE_CLOCK); /* Start Clock */
 
 	for (i = 0, addr = ARRAY_SIZE(gm_st_ctrl); i < (int64_t)ARRAY_SIZE(gm_st_ctrl); i++) {
-		ad9361_spi_write(phy->spi, REG_GM_SUB_TABLE_ADDRESS, --addr); /* Gain Table Index */
+		/* Descending register order, merged into one SPI burst */
+		ad9361_spi_write(phy->spi, REG_GM_SUB_TABLE_CTRL_WRITE, gm_st_ctrl[i]); /* Control */
 		ad9361_spi_write(phy->spi, REG_GM_SUB_TABLE_BIAS_WRITE, 0); /* Bias */
 		ad9361_spi_write(phy->spi, REG_GM_SUB_TABLE_GAIN_WRITE, gm_st_gain[i]); /* Gain */
-		ad9361_spi_write(phy->spi, REG_GM_SUB_TABLE_CTRL_WRITE, gm_st_ctrl[i]); /* Control */
+		ad9361_spi_write(phy->spi, REG_GM_SUB_TABLE_ADDRESS, --addr); /* Gain Table Index */
 		ad9361_spi_write(phy->spi, REG_GM_SUB_TABLE_CONFIG,
 			WRITE_GM_SUB_TABLE | START_GM_SUB_TABLE_CLOCK); /* Write Words */
 		ad9361_spi_write(phy->spi, REG_GM_SUB_TABLE_GAIN_READ, 0); /* Dummy Delay */
@@ -1344,7 +1651,7 @@ static int32_t ad9361_load_mixer_gm_subtable(struct ad9361_rf_phy *phy)
 	ad9361_spi_write(phy->spi, REG_GM_SUB_TABLE_GAIN_READ, 0); /* Dummy Delay */
 	ad9361_spi_write(phy->spi, REG_GM_SUB_TABLE_CONFIG, 0); /* Stop Clock */
 
-	return 0;
+	return ad9361_spi_batch_end(phy->spi);
 }
 
 /**
@@ -2426,6 +2733,208 @@ static int32_t ad9361_rx_adc_setup(struct ad9361_rf_phy *phy, uint32_t bbpll_fre
 	return 0;
 }
 
+/**
+ * Compute the checksum of a calibration cache blob.
+ * @param cache The calibration cache.
+ * @return The checksum.
+ */
+static uint32_t ad9361_cal_cache_checksum(struct ad9361_cal_cache *cache)
+{
+	const uint8_t *p = (const uint8_t *)cache;
+	uint32_t i, a = 1, b = 0;
+
+	for (i = 0; i < offsetof(struct ad9361_cal_cache, checksum); i++) {
+		a = (a + p[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+
+	return (b << 16) | a;
+}
+
+/**
+ * Transfer a register range of a calibration cache section.
+ * @param phy The AD9361 state structure.
+ * @param section The calibration cache section.
+ * @param write Write the cached values (true) or read them (false).
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_cal_cache_xfer(struct ad9361_rf_phy *phy,
+	uint32_t section, bool write)
+{
+	struct ad9361_cal_cache *cache = phy->cal_cache;
+	uint32_t i, reg, num;
+	uint8_t *buf;
+	int32_t ret = 0;
+
+	switch (section) {
+	case AD9361_CAL_RX_BBF:
+		reg = REG_RX1_BBF_R1A;
+		buf = cache->rx_bbf;
+		num = sizeof(cache->rx_bbf);
+		break;
+	case AD9361_CAL_TX_BBF:
+		reg = REG_TX_BBF_R1;
+		buf = cache->tx_bbf;
+		num = sizeof(cache->tx_bbf);
+		break;
+	case AD9361_CAL_TX_QUAD:
+		reg = REG_TX1_OUT_1_PHASE_CORR;
+		buf = cache->tx_quad;
+		num = sizeof(cache->tx_quad);
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	for (i = 0; i < num; i++) {
+		if (write) {
+			ret = ad9361_spi_write(phy->spi, reg + i, buf[i]);
+		} else {
+			ret = ad9361_spi_read(phy->spi, reg + i);
+			buf[i] = ret;
+		}
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * Restore the results of a calibration from the calibration cache instead
+ * of running it.
+ * @param phy The AD9361 state structure.
+ * @param section The calibration cache section.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_cal_cache_restore(struct ad9361_rf_phy *phy,
+	uint32_t section)
+{
+	int32_t ret;
+
+	dev_dbg(&phy->spi->dev, "%s: section 0x%"PRIX32, __func__, section);
+
+	phy->cal_reuse &= ~section;
+
+	ret = ad9361_spi_batch_begin(phy->spi);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9361_cal_cache_xfer(phy, section, true);
+	if (ret < 0) {
+		ad9361_spi_batch_end(phy->spi);
+		return ret;
+	}
+
+	if (section == AD9361_CAL_TX_QUAD)
+		phy->last_tx_quad_cal_phase = phy->cal_cache->tx_quad_phase;
+
+	return ad9361_spi_batch_end(phy->spi);
+}
+
+/**
+ * Find the calibrations whose results can be taken from the calibration
+ * cache. A calibration is rerun when the bandwidth, the BBPLL rate or the
+ * LO band it depends on changed, or when the temperature drifted.
+ * @param phy The AD9361 state structure.
+ * @param rf_rx_bw The RF RX bandwidth [Hz].
+ * @param rf_tx_bw The RF TX bandwidth [Hz].
+ * @param bbpll_freq The BBPLL frequency [Hz].
+ * @return The mask of the reusable calibration cache sections.
+ */
+static uint32_t ad9361_cal_cache_check(struct ad9361_rf_phy *phy,
+	uint32_t rf_rx_bw, uint32_t rf_tx_bw, uint32_t bbpll_freq)
+{
+	struct ad9361_cal_cache *cache = phy->cal_cache;
+	uint64_t tx_lo_freq, delta;
+	uint32_t reuse = 0;
+	int32_t temp;
+
+	if (!cache)
+		return 0;
+
+	if ((cache->magic != AD9361_CAL_CACHE_MAGIC) ||
+		(cache->version != AD9361_CAL_CACHE_VERSION) ||
+		(cache->size != sizeof(*cache)) ||
+		(cache->checksum != ad9361_cal_cache_checksum(cache))) {
+		dev_err(&phy->spi->dev, "%s: Invalid calibration cache",
+			__func__);
+		return 0;
+	}
+
+	temp = ad9361_get_temp(phy);
+	if ((temp > cache->temp + AD9361_CAL_CACHE_TEMP_DELTA) ||
+		(temp < cache->temp - AD9361_CAL_CACHE_TEMP_DELTA) ||
+		(bbpll_freq != cache->bbpll_freq))
+		return 0;
+
+	if (rf_rx_bw == cache->rf_rx_bw)
+		reuse |= AD9361_CAL_RX_BBF;
+	if (rf_tx_bw == cache->rf_tx_bw)
+		reuse |= AD9361_CAL_TX_BBF;
+
+	tx_lo_freq = ad9361_from_clk(clk_get_rate(phy,
+		phy->ref_clk_scale[TX_RFPLL]));
+	delta = (tx_lo_freq > cache->tx_lo_freq) ?
+		tx_lo_freq - cache->tx_lo_freq : cache->tx_lo_freq - tx_lo_freq;
+	if ((reuse == (AD9361_CAL_RX_BBF | AD9361_CAL_TX_BBF)) &&
+		(delta <= AD9361_CAL_CACHE_LO_DELTA))
+		reuse |= AD9361_CAL_TX_QUAD;
+
+	reuse &= cache->valid;
+
+	dev_dbg(&phy->spi->dev, "%s: reuse 0x%"PRIX32, __func__, reuse);
+
+	return reuse;
+}
+
+/**
+ * Save the calibration results and the conditions they were taken at.
+ * The blob can be handed back to ad9361_init() (AD9361_InitParam.cal_cache)
+ * to skip the calibrations whose conditions did not change.
+ * @param phy The AD9361 state structure.
+ * @param cache The calibration cache.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_cal_cache_save(struct ad9361_rf_phy *phy,
+	struct ad9361_cal_cache *cache)
+{
+	struct ad9361_cal_cache *save = phy->cal_cache;
+	int32_t ret;
+
+	memset(cache, 0, sizeof(*cache));
+	cache->magic = AD9361_CAL_CACHE_MAGIC;
+	cache->version = AD9361_CAL_CACHE_VERSION;
+	cache->size = sizeof(*cache);
+
+	cache->tx_lo_freq = ad9361_from_clk(clk_get_rate(phy,
+		phy->ref_clk_scale[TX_RFPLL]));
+	cache->rf_rx_bw = phy->current_rx_bw_Hz;
+	cache->rf_tx_bw = phy->current_tx_bw_Hz;
+	cache->bbpll_freq = clk_get_rate(phy, phy->ref_clk_scale[BBPLL_CLK]);
+	cache->temp = ad9361_get_temp(phy);
+
+	phy->cal_cache = cache;
+	ret = ad9361_cal_cache_xfer(phy, AD9361_CAL_RX_BBF, false);
+	if (ret == 0)
+		ret = ad9361_cal_cache_xfer(phy, AD9361_CAL_TX_BBF, false);
+	if (ret == 0)
+		ret = ad9361_cal_cache_xfer(phy, AD9361_CAL_TX_QUAD, false);
+	phy->cal_cache = save;
+	if (ret < 0)
+		return ret;
+
+	cache->valid = AD9361_CAL_RX_BBF | AD9361_CAL_TX_BBF;
+	if (phy->last_tx_quad_cal_phase < 32) {
+		cache->tx_quad_phase = phy->last_tx_quad_cal_phase;
+		cache->valid |= AD9361_CAL_TX_QUAD;
+	}
+
+	cache->checksum = ad9361_cal_cache_checksum(cache);
+
+	return 0;
+}
+
 /**
  * Perform a RX TIA calibration.
  * @param phy The AD9361 state structure.
@@ -2527,7 +3036,10 @@ static int32_t ad9361_rx_bb_analog_filter_calib(struct ad9361_rf_phy *phy,
 
 	/* Start the RX Baseband Filter calibration in register 0x016[7] */
 	/* Calibration is complete when register 0x016[7] self clears */
-	ret = ad9361_run_calibration(phy, RX_BB_TUNE_CAL);
+	if (phy->cal_reuse & AD9361_CAL_RX_BBF)
+		ret = ad9361_cal_cache_restore(phy, AD9361_CAL_RX_BBF);
+	else
+		ret = ad9361_run_calibration(phy, RX_BB_TUNE_CAL);
 
 	/* Disable the RX baseband filter tune circuit, write 0x1E2=3, 0x1E3=3 */
 	ad9361_spi_write(phy->spi, REG_RX1_TUNE_CTRL,
@@ -2571,7 +3083,10 @@ static int32_t ad9361_tx_bb_analog_filter_calib(struct ad9361_rf_phy *phy,
 
 	/* Start the TX Baseband Filter calibration in register 0x016[6] */
 	/* Calibration is complete when register 0x016[] self clears */
-	ret = ad9361_run_calibration(phy, TX_BB_TUNE_CAL);
+	if (phy->cal_reuse & AD9361_CAL_TX_BBF)
+		ret = ad9361_cal_cache_restore(phy, AD9361_CAL_TX_BBF);
+	else
+		ret = ad9361_run_calibration(phy, TX_BB_TUNE_CAL);
 
 	/* Disable the TX baseband filter tune circuit by writing 0x0CA=0x26. */
 	ad9361_spi_write(phy->spi, REG_TX_TUNE_CTRL,
@@ -4291,6 +4806,29 @@ static int32_t ad9361_validate_trx_clock_chain(struct ad9361_rf_phy *phy,
 	return -EINVAL;
 }
 
+/**
+ * Get the BBPLL rate the BBPLL will actually lock to for a requested rate.
+ * @param phy The AD9361 state structure.
+ * @param rate The requested BBPLL rate.
+ * @return The BBPLL rate.
+ */
+static uint32_t ad9361_bbpll_plan_rate(struct ad9361_rf_phy *phy,
+	uint32_t rate)
+{
+	uint32_t i, ref_rate;
+
+	ref_rate = phy->clks[phy->ref_clk_scale[BBPLL_CLK]->parent_source]->rate;
+
+	for (i = 0; i < AD9361_CLK_PLAN_CACHE_SIZE; i++)
+		if (phy->clk_plan[i].valid &&
+		    (phy->clk_plan[i].rx_path_clks[BBPLL_FREQ] == rate) &&
+		    (phy->clk_plan[i].ref_rate == ref_rate))
+			return phy->clk_plan[i].bbpll_rate;
+
+	return ad9361_bbpll_round_rate(phy->ref_clk_scale[BBPLL_CLK], rate,
+		&ref_rate);
+}
+
 /**
  * Set the RX and TX path rates.
  * @param phy The AD9361 state structure.
@@ -4303,6 +4841,7 @@ int32_t ad9361_set_trx_clock_chain(struct ad9361_rf_phy *phy,
 	uint32_t *tx_path_clks)
 {
 	int32_t ret, i, j, n;
+	bool changed = false;
 
 	dev_dbg(&phy->spi->dev, "%s", __func__);
 
@@ -4323,12 +4862,22 @@ int32_t ad9361_set_trx_clock_chain(struct ad9361_rf_phy *phy,
 	if (ret < 0)
 		return ret;
 
-	ret = clk_set_rate(phy, phy->ref_clk_scale[BBPLL_CLK], rx_path_clks[BBPLL_FREQ]);
-	if (ret < 0)
-		return ret;
+	/* Skip the BBPLL calibration if it already runs at the rate */
+	if (!phy->bbpll_initialized ||
+		(ad9361_bbpll_plan_rate(phy, rx_path_clks[BBPLL_FREQ]) !=
+		phy->clks[BBPLL_CLK]->rate)) {
+		ret = clk_set_rate(phy, phy->ref_clk_scale[BBPLL_CLK],
+			rx_path_clks[BBPLL_FREQ]);
+		if (ret < 0)
+			return ret;
+		changed = true;
+	}
 
 	for (i = ADC_CLK, j = DAC_CLK, n = ADC_FREQ;
 		i <= RX_SAMPL_CLK; i++, j++, n++) {
+		if ((phy->clks[i]->rate != rx_path_clks[n]) ||
+			(phy->clks[j]->rate != tx_path_clks[n]))
+			changed = true;
 		ret = clk_set_rate(phy, phy->ref_clk_scale[i], rx_path_clks[n]);
 		if (ret < 0) {
 			dev_err(dev, "Failed to set BB ref clock rate (%"PRId32")",
@@ -4349,15 +4898,28 @@ int32_t ad9361_set_trx_clock_chain(struct ad9361_rf_phy *phy,
 	 */
 
 	if (phy->rx_fir_dec == 1 || phy->bypass_rx_fir) {
-		ad9361_spi_writef(phy->spi, REG_RX_ENABLE_FILTER_CTRL,
-			RX_FIR_ENABLE_DECIMATION(~0), !phy->bypass_rx_fir);
+		if (ad9361_spi_readf(phy->spi, REG_RX_ENABLE_FILTER_CTRL,
+			RX_FIR_ENABLE_DECIMATION(~0)) != !phy->bypass_rx_fir) {
+			ad9361_spi_writef(phy->spi, REG_RX_ENABLE_FILTER_CTRL,
+				RX_FIR_ENABLE_DECIMATION(~0), !phy->bypass_rx_fir);
+			changed = true;
+		}
 	}
 
 	if (phy->tx_fir_int == 1 || phy->bypass_tx_fir) {
-		ad9361_spi_writef(phy->spi, REG_TX_ENABLE_FILTER_CTRL,
-			TX_FIR_ENABLE_INTERPOLATION(~0), !phy->bypass_tx_fir);
+		if (ad9361_spi_readf(phy->spi, REG_TX_ENABLE_FILTER_CTRL,
+			TX_FIR_ENABLE_INTERPOLATION(~0)) != !phy->bypass_tx_fir) {
+			ad9361_spi_writef(phy->spi, REG_TX_ENABLE_FILTER_CTRL,
+				TX_FIR_ENABLE_INTERPOLATION(~0), !phy->bypass_tx_fir);
+			changed = true;
+		}
 	}
 
+	/* Nothing changed, the interface timing and the baseband
+	 * dependent setup are still valid */
+	if (!changed)
+		return 0;
+
 	/* The FIR filter once enabled causes the interface timing to change.
 	 * It's typically not a problem if the timing margin is big enough.
 	 * However at 61.44 MSPS it causes problems on some systems.
@@ -4408,7 +4970,7 @@ int32_t ad9361_get_trx_clock_chain(struct ad9361_rf_phy *phy, uint32_t *rx_path_
 }
 
 /**
- * Calculate the RX and TX path rates to obtain the desired sample rate.
+ * Solve the RX and TX path rates to obtain the desired sample rate.
  * @param phy The AD9361 state structure.
  * @param tx_sample_rate The desired sample rate.
  * @param rate_gov The rate governor option.
@@ -4416,7 +4978,7 @@ int32_t ad9361_get_trx_clock_chain(struct ad9361_rf_phy *phy, uint32_t *rx_path_
  * @param tx_path_clks TX path rates buffer.
  * @return 0 in case of success, negative error code otherwise.
  */
-int32_t ad9361_calculate_rf_clock_chain(struct ad9361_rf_phy *phy,
+static int32_t ad9361_solve_rf_clock_chain(struct ad9361_rf_phy *phy,
 	uint32_t tx_sample_rate,
 	uint32_t rate_gov,
 	uint32_t *rx_path_clks,
@@ -4495,7 +5057,7 @@ int32_t ad9361_calculate_rf_clock_chain(struct ad9361_rf_phy *phy,
 	}
 
 	if ((index_tx < 0 || index_tx > 6 || index_rx < 0 || index_rx > 6) && rate_gov < 7 && recursion) {
-		return ad9361_calculate_rf_clock_chain(phy, tx_sample_rate,
+		return ad9361_solve_rf_clock_chain(phy, tx_sample_rate,
 			++rate_gov, rx_path_clks, tx_path_clks);
 	}
 	else if ((index_tx < 0 || index_tx > 6 || index_rx < 0 || index_rx > 6)) {
@@ -4531,6 +5093,74 @@ int32_t ad9361_calculate_rf_clock_chain(struct ad9361_rf_phy *phy,
 	return 0;
 }
 
+/**
+ * Calculate the RX and TX path rates to obtain the desired sample rate.
+ * The solved clock chains are kept in a small cache keyed by every input of
+ * the solver: the sample rate, the rate governor, the FIR interpolation/
+ * decimation, the RX/TX rate ratio and the reference clock rate, so an entry
+ * never goes stale.
+ * @param phy The AD9361 state structure.
+ * @param tx_sample_rate The desired sample rate.
+ * @param rate_gov The rate governor option.
+ * @param rx_path_clks RX path rates buffer.
+ * @param tx_path_clks TX path rates buffer.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_calculate_rf_clock_chain(struct ad9361_rf_phy *phy,
+	uint32_t tx_sample_rate,
+	uint32_t rate_gov,
+	uint32_t *rx_path_clks,
+	uint32_t *tx_path_clks)
+{
+	struct ad9361_clk_plan *plan;
+	uint32_t i, rx_intdec, tx_intdec, ref_rate;
+	int32_t ret;
+
+	rx_intdec = phy->bypass_rx_fir ? 1 : phy->rx_fir_dec;
+	tx_intdec = phy->bypass_tx_fir ? 1 : phy->tx_fir_int;
+	ref_rate = phy->clks[phy->ref_clk_scale[BBPLL_CLK]->parent_source]->rate;
+
+	for (i = 0; i < AD9361_CLK_PLAN_CACHE_SIZE; i++) {
+		plan = &phy->clk_plan[i];
+		if (plan->valid && (plan->rate == tx_sample_rate) &&
+		    (plan->rate_gov == rate_gov) &&
+		    (plan->rx_intdec == rx_intdec) &&
+		    (plan->tx_intdec == tx_intdec) &&
+		    (plan->rx_eq_2tx == phy->rx_eq_2tx) &&
+		    (plan->ref_rate == ref_rate)) {
+			memcpy(rx_path_clks, plan->rx_path_clks,
+				sizeof(plan->rx_path_clks));
+			memcpy(tx_path_clks, plan->tx_path_clks,
+				sizeof(plan->tx_path_clks));
+
+			return 0;
+		}
+	}
+
+	ret = ad9361_solve_rf_clock_chain(phy, tx_sample_rate, rate_gov,
+		rx_path_clks, tx_path_clks);
+	if (ret < 0)
+		return ret;
+
+	plan = &phy->clk_plan[phy->clk_plan_next];
+	phy->clk_plan_next = (phy->clk_plan_next + 1) %
+		AD9361_CLK_PLAN_CACHE_SIZE;
+
+	plan->rate = tx_sample_rate;
+	plan->rate_gov = rate_gov;
+	plan->rx_intdec = rx_intdec;
+	plan->tx_intdec = tx_intdec;
+	plan->rx_eq_2tx = phy->rx_eq_2tx;
+	plan->ref_rate = ref_rate;
+	memcpy(plan->rx_path_clks, rx_path_clks, sizeof(plan->rx_path_clks));
+	memcpy(plan->tx_path_clks, tx_path_clks, sizeof(plan->tx_path_clks));
+	plan->bbpll_rate = ad9361_bbpll_round_rate(phy->ref_clk_scale[BBPLL_CLK],
+		rx_path_clks[BBPLL_FREQ], &ref_rate);
+	plan->valid = true;
+
+	return 0;
+}
+
 /**
  * Set the desired sample rate.
  * @param phy The AD9361 state structure.
@@ -4683,21 +5313,17 @@ int32_t ad9361_fastlock_load(struct ad9361_rf_phy *phy, bool tx,
 }
 
 /**
- * Fastlock store.
+ * Build the fastlock profile words from the current synthesizer setup.
  * @param phy The AD9361 state structure.
  * @param tx
- * @param profile
- * @return 0 in case of success, negative error code otherwise.
+ * @param val The profile words (RX_FAST_LOCK_CONFIG_WORD_NUM bytes).
  */
-int32_t ad9361_fastlock_store(struct ad9361_rf_phy *phy, bool tx, uint32_t profile)
+static void ad9361_fastlock_readback(struct ad9361_rf_phy *phy, bool tx,
+	uint8_t *val)
 {
 	struct spi_device *spi = phy->spi;
-	uint8_t val[16];
 	uint32_t offs = 0, x, y;
 
-	dev_dbg(&phy->spi->dev, "%s: %s Profile %"PRIu32":",
-		__func__, tx ? "TX" : "RX", profile);
-
 	if (tx)
 		offs = REG_TX_FAST_LOCK_SETUP - REG_RX_FAST_LOCK_SETUP;
 
@@ -4747,6 +5373,23 @@ int32_t ad9361_fastlock_store(struct ad9361_rf_phy *phy, bool tx, uint32_t profi
 	x = ad9361_spi_readf(spi, REG_RX_FORCE_ALC + offs, FORCE_ALC_WORD(~0));
 	y = ad9361_spi_readf(spi, REG_RX_FORCE_VCO_TUNE_1 + offs, FORCE_VCO_TUNE);
 	val[15] = (x << 1) | y;
+}
+
+/**
+ * Fastlock store.
+ * @param phy The AD9361 state structure.
+ * @param tx
+ * @param profile
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_fastlock_store(struct ad9361_rf_phy *phy, bool tx, uint32_t profile)
+{
+	uint8_t val[RX_FAST_LOCK_CONFIG_WORD_NUM];
+
+	dev_dbg(&phy->spi->dev, "%s: %s Profile %"PRIu32":",
+		__func__, tx ? "TX" : "RX", profile);
+
+	ad9361_fastlock_readback(phy, tx, val);
 
 	return ad9361_fastlock_load(phy, tx, profile, val);
 }
@@ -4888,6 +5531,304 @@ int32_t ad9361_fastlock_save(struct ad9361_rf_phy *phy, bool tx,
 	return 0;
 }
 
+/**
+ * Get the fastlock profile slot holding an entry of a hop table.
+ * @param table The hop table.
+ * @param index The hop table entry.
+ * @return The profile slot or -1 if the entry is not loaded.
+ */
+int32_t ad9361_hop_table_slot(struct ad9361_hop_table *table, uint32_t index)
+{
+	uint32_t slot;
+
+	for (slot = 0; slot < AD9361_HOP_SLOTS; slot++) {
+		if (table->slot_entry[slot] == (int32_t)index)
+			return slot;
+	}
+
+	return -1;
+}
+
+/**
+ * Load the entry of a hop table into a free fastlock profile slot.
+ * The slot in use and the slots holding the entries that follow
+ * the current one are kept.
+ * @param phy The AD9361 state structure.
+ * @param table The hop table.
+ * @param index The hop table entry.
+ * @return The profile slot or negative error code in case of failure.
+ */
+static int32_t ad9361_hop_table_fill(struct ad9361_rf_phy *phy,
+	struct ad9361_hop_table *table, uint32_t index)
+{
+	uint32_t slot, dist, max_dist = 0, victim = 0;
+	int32_t ret;
+
+	ret = ad9361_hop_table_slot(table, index);
+	if (ret >= 0)
+		return ret;
+
+	/* Evict the slot whose entry is used last in the table order */
+	for (slot = 0; slot < AD9361_HOP_SLOTS; slot++) {
+		if (table->slot_entry[slot] < 0) {
+			victim = slot;
+			break;
+		}
+		if (slot == table->current_slot)
+			continue;
+		dist = (table->slot_entry[slot] + table->num_entries -
+			table->current) % table->num_entries;
+		if (dist >= max_dist) {
+			max_dist = dist;
+			victim = slot;
+		}
+	}
+
+	ret = ad9361_fastlock_load(phy, table->tx, victim, table->words[index]);
+	if (ret < 0)
+		return ret;
+
+	table->slot_entry[victim] = index;
+	table->loads++;
+
+	return victim;
+}
+
+/**
+ * Fill the fastlock profile slots with the hop table entries that follow
+ * the current one.
+ * @param phy The AD9361 state structure.
+ * @param table The hop table.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_hop_table_prefetch(struct ad9361_rf_phy *phy,
+	struct ad9361_hop_table *table)
+{
+	uint32_t i, num;
+	int32_t ret;
+
+	num = min_t(uint32_t, table->num_entries, AD9361_HOP_SLOTS);
+	for (i = 1; i < num; i++) {
+		ret = ad9361_hop_table_fill(phy, table,
+			(table->current + i) % table->num_entries);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * Poll the synthesizer lock after a hop. Each poll is one SPI read followed
+ * by a 1 us delay, so the poll count is a lower bound of the lock time.
+ * @param phy The AD9361 state structure.
+ * @param table The hop table.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_hop_table_wait_lock(struct ad9361_rf_phy *phy,
+	struct ad9361_hop_table *table)
+{
+	uint32_t reg = table->tx ? REG_TX_CP_OVERRANGE_VCO_LOCK :
+		REG_RX_CP_OVERRANGE_VCO_LOCK;
+	uint32_t polls = 0;
+	int32_t ret;
+
+	while (1) {
+		ret = ad9361_spi_readf(phy->spi, reg, VCO_LOCK);
+		if (ret < 0)
+			return ret;
+		if (ret)
+			break;
+		if (polls >= table->lock_timeout_polls) {
+			dev_err(&phy->spi->dev, "%s: %s entry %"PRIu32" lock TIMEOUT",
+				__func__, table->tx ? "TX" : "RX", table->current);
+			return -ETIMEDOUT;
+		}
+		udelay(1);
+		polls++;
+	}
+
+	table->last_lock_polls = polls;
+	if (polls > table->max_lock_polls)
+		table->max_lock_polls = polls;
+	table->total_lock_polls += polls;
+	table->hops++;
+
+	return 0;
+}
+
+/**
+ * Create a hop table. The synthesizer is tuned (and the VCO calibrated)
+ * once for each frequency and the resulting fastlock profile words are kept
+ * in RAM, so any number of frequencies can be hopped through the 8
+ * hardware profiles.
+ * @param phy The AD9361 state structure.
+ * @param tx Use the TX synthesizer instead of the RX one.
+ * @param freq The LO frequencies [Hz].
+ * @param num_entries The number of frequencies.
+ * @param table_out The hop table.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_hop_table_init(struct ad9361_rf_phy *phy, bool tx,
+	uint64_t *freq, uint32_t num_entries,
+	struct ad9361_hop_table **table_out)
+{
+	struct ad9361_hop_table *table;
+	uint32_t i, pll = tx ? TX_RFPLL : RX_RFPLL;
+	int32_t ret;
+
+	if (!num_entries || !freq)
+		return -EINVAL;
+
+	table = (struct ad9361_hop_table *)zmalloc(sizeof(*table));
+	if (!table)
+		return -ENOMEM;
+
+	table->freq = (uint64_t *)malloc(num_entries * sizeof(*table->freq));
+	table->words = (uint8_t (*)[RX_FAST_LOCK_CONFIG_WORD_NUM])malloc(
+		num_entries * sizeof(*table->words));
+	if (!table->freq || !table->words) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	table->tx = tx;
+	table->num_entries = num_entries;
+	table->lock_timeout_polls = AD9361_HOP_LOCK_TIMEOUT_POLLS;
+	for (i = 0; i < AD9361_HOP_SLOTS; i++)
+		table->slot_entry[i] = -1;
+
+	for (i = 0; i < num_entries; i++) {
+		ret = clk_set_rate(phy, phy->ref_clk_scale[pll],
+			ad9361_to_clk(freq[i]));
+		if (ret < 0)
+			goto out;
+		table->freq[i] = freq[i];
+		ad9361_fastlock_readback(phy, tx, table->words[i]);
+	}
+
+	/* The synthesizer stays on the last entry */
+	table->current = num_entries - 1;
+	ret = ad9361_hop_table_fill(phy, table, table->current);
+	if (ret < 0)
+		goto out;
+	table->current_slot = ret;
+
+	ret = ad9361_fastlock_recall(phy, tx, table->current_slot);
+	if (ret < 0)
+		goto out;
+
+	ret = ad9361_hop_table_prefetch(phy, table);
+	if (ret < 0)
+		goto out;
+
+	*table_out = table;
+
+	return 0;
+
+out:
+	ad9361_hop_table_remove(table);
+
+	return ret;
+}
+
+/**
+ * Hop to an entry of the hop table and wait for the synthesizer lock.
+ * The profile slots are refilled with the next entries after the lock, so
+ * hops in table order never wait for profile loads.
+ * @param phy The AD9361 state structure.
+ * @param table The hop table.
+ * @param index The hop table entry.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_hop_table_hop(struct ad9361_rf_phy *phy,
+	struct ad9361_hop_table *table, uint32_t index)
+{
+	int32_t slot, ret;
+
+	if (index >= table->num_entries)
+		return -EINVAL;
+
+	if (ad9361_hop_table_slot(table, index) < 0)
+		table->misses++;
+
+	slot = ad9361_hop_table_fill(phy, table, index);
+	if (slot < 0)
+		return slot;
+
+	table->current = index;
+	table->current_slot = slot;
+	ret = ad9361_fastlock_recall(phy, table->tx, slot);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9361_hop_table_wait_lock(phy, table);
+	if (ret < 0)
+		return ret;
+
+	return ad9361_hop_table_prefetch(phy, table);
+}
+
+/**
+ * Enable/disable the pin control of the hop table. With the pin control
+ * enabled the profile slot is selected by the CTRL_IN pins; the slot of an
+ * entry is given by ad9361_hop_table_slot().
+ * @param phy The AD9361 state structure.
+ * @param table The hop table.
+ * @param enable Enable/disable option.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_hop_table_pin_control(struct ad9361_rf_phy *phy,
+	struct ad9361_hop_table *table, bool enable)
+{
+	phy->pdata->trx_fastlock_pinctrl_en[table->tx] = enable;
+
+	return ad9361_fastlock_recall(phy, table->tx, table->current_slot);
+}
+
+/**
+ * Account for a hop triggered by the CTRL_IN pins: wait for the synthesizer
+ * lock and refill the profile slots. To be called right after the pins
+ * were changed.
+ * @param phy The AD9361 state structure.
+ * @param table The hop table.
+ * @param index The hop table entry selected by the pins.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_hop_table_pin_hop(struct ad9361_rf_phy *phy,
+	struct ad9361_hop_table *table, uint32_t index)
+{
+	int32_t slot, ret;
+
+	slot = ad9361_hop_table_slot(table, index);
+	if (slot < 0)
+		return -EINVAL;
+
+	table->current = index;
+	table->current_slot = slot;
+	phy->fastlock.current_profile[table->tx] = slot + 1;
+
+	ret = ad9361_hop_table_wait_lock(phy, table);
+	if (ret < 0)
+		return ret;
+
+	return ad9361_hop_table_prefetch(phy, table);
+}
+
+/**
+ * Free the resources allocated by ad9361_hop_table_init().
+ * @param table The hop table.
+ */
+void ad9361_hop_table_remove(struct ad9361_hop_table *table)
+{
+	if (!table)
+		return;
+
+	free(table->freq);
+	free(table->words);
+	free(table);
+}
+
 /**
  * Multi Chip Sync (MCS) config.
  * @param phy The AD9361 state structure.
@@ -5084,6 +6025,10 @@ int32_t ad9361_setup(struct ad9361_rf_phy *phy)
 		return ret;
 	}
 
+	ret = ad9361_spi_batch_begin(spi);
+	if (ret < 0)
+		return ret;
+
 	if (!pd->rx2tx2) {
 		pd->rx1tx1_mode_use_tx_num =
 			clamp_t(uint32_t, pd->rx1tx1_mode_use_tx_num, TX_1, TX_2);
@@ -5100,34 +6045,38 @@ int32_t ad9361_setup(struct ad9361_rf_phy *phy)
 	ret = ad9361_rf_port_setup(phy, true, pd->rf_rx_input_sel,
 				   pd->rf_tx_output_sel);
 	if (ret < 0)
-		return ret;
+		goto out_batch;
 
 	ret = ad9361_pp_port_setup(phy, false);
 	if (ret < 0)
-		return ret;
+		goto out_batch;
 
 	ret = ad9361_auxdac_setup(phy, &pd->auxdac_ctrl);
 	if (ret < 0)
-		return ret;
+		goto out_batch;
 
 	bbpll_freq = clk_get_rate(phy, phy->ref_clk_scale[BBPLL_CLK]);
 	ret = ad9361_auxadc_setup(phy, &pd->auxadc_ctrl, bbpll_freq);
 	if (ret < 0)
-		return ret;
+		goto out_batch;
 
 	ret = ad9361_ctrl_outs_setup(phy, &pd->ctrl_outs_ctrl);
 	if (ret < 0)
-		return ret;
+		goto out_batch;
 
 	ret = ad9361_gpo_setup(phy, &pd->gpo_ctrl);
 	if (ret < 0)
-		return ret;
+		goto out_batch;
 
 	ret = ad9361_set_ref_clk_cycles(phy, refin_Hz);
 	if (ret < 0)
-		return ret;
+		goto out_batch;
 
 	ret = ad9361_setup_ext_lna(phy, &pd->elna_ctrl);
+	if (ret < 0)
+		goto out_batch;
+
+	ret = ad9361_spi_batch_end(spi);
 	if (ret < 0)
 		return ret;
 
@@ -5210,14 +6159,26 @@ int32_t ad9361_setup(struct ad9361_rf_phy *phy)
 	ad9361_clk_mux_set_parent(phy->ref_clk_scale[TX_RFPLL],
 		pd->use_ext_tx_lo);
 
-	ret = ad9361_load_mixer_gm_subtable(phy);
+	ret = ad9361_spi_batch_begin(spi);
 	if (ret < 0)
 		return ret;
 
+	ret = ad9361_load_mixer_gm_subtable(phy);
+	if (ret < 0)
+		goto out_batch;
+
 	ret = ad9361_gc_setup(phy, &pd->gain_ctrl);
+	if (ret < 0)
+		goto out_batch;
+
+	ret = ad9361_spi_batch_end(spi);
 	if (ret < 0)
 		return ret;
 
+	/* Warm restart: reuse the results still valid in the calibration cache */
+	phy->cal_reuse = ad9361_cal_cache_check(phy, pd->rf_rx_bandwidth_Hz,
+		pd->rf_tx_bandwidth_Hz, bbpll_freq);
+
 	ret = ad9361_rx_bb_analog_filter_calib(phy,
 		real_rx_bandwidth,
 		bbpll_freq);
@@ -5256,7 +6217,12 @@ int32_t ad9361_setup(struct ad9361_rf_phy *phy)
 	phy->current_rx_bw_Hz = pd->rf_rx_bandwidth_Hz;
 	phy->current_tx_bw_Hz = pd->rf_tx_bandwidth_Hz;
 	phy->last_tx_quad_cal_phase = ~0;
-	ret = ad9361_tx_quad_calib(phy, real_rx_bandwidth, real_tx_bandwidth, -1);
+	if (phy->cal_reuse & AD9361_CAL_TX_QUAD)
+		ret = ad9361_cal_cache_restore(phy, AD9361_CAL_TX_QUAD);
+	else
+		ret = ad9361_tx_quad_calib(phy, real_rx_bandwidth,
+			real_tx_bandwidth, -1);
+	phy->cal_reuse = 0;
 	if (ret < 0)
 		return ret;
 
@@ -5291,16 +6257,24 @@ int32_t ad9361_setup(struct ad9361_rf_phy *phy)
 			return ret;
 	}
 
-	ret = ad9361_rssi_setup(phy, &pd->rssi_ctrl, false);
+	ret = ad9361_spi_batch_begin(spi);
 	if (ret < 0)
 		return ret;
 
+	ret = ad9361_rssi_setup(phy, &pd->rssi_ctrl, false);
+	if (ret < 0)
+		goto out_batch;
+
 	ret = ad9361_clkout_control(phy, pd->ad9361_clkout_mode);
 	if (ret < 0)
-		return ret;
+		goto out_batch;
 
 
 	ret = ad9361_txmon_setup(phy, &pd->txmon_ctrl);
+	if (ret < 0)
+		goto out_batch;
+
+	ret = ad9361_spi_batch_end(spi);
 	if (ret < 0)
 		return ret;
 
@@ -5313,6 +6287,10 @@ int32_t ad9361_setup(struct ad9361_rf_phy *phy)
 
 	return 0;
 
+out_batch:
+	ad9361_spi_batch_end(spi);
+
+	return ret;
 }
 
 /**
@@ -5477,6 +6455,7 @@ int32_t ad9361_load_fir_filter_coef(struct ad9361_rf_phy *phy,
 {
 	struct spi_device *spi = phy->spi;
 	uint32_t val, offs = 0, fir_conf = 0, fir_enable = 0;
+	int32_t ret;
 
 	dev_dbg(&phy->spi->dev, "%s: TAPS %"PRIu32", gain %"PRId32", dest %d",
 		__func__, ntaps, gain_dB, dest);
@@ -5517,14 +6496,19 @@ int32_t ad9361_load_fir_filter_coef(struct ad9361_rf_phy *phy,
 
 	fir_conf |= FIR_NUM_TAPS(val) | FIR_SELECT(dest) | FIR_START_CLK;
 
+	ret = ad9361_spi_batch_begin(spi);
+	if (ret < 0)
+		goto out_restore;
+
 	ad9361_spi_write(spi, REG_TX_FILTER_CONF + offs, fir_conf);
 
 	for (val = 0; val < ntaps; val++) {
-		ad9361_spi_write(spi, REG_TX_FILTER_COEF_ADDR + offs, val);
-		ad9361_spi_write(spi, REG_TX_FILTER_COEF_WRITE_DATA_1 + offs,
-			coef[val] & 0xFF);
+		/* Descending register order, merged into one SPI burst */
 		ad9361_spi_write(spi, REG_TX_FILTER_COEF_WRITE_DATA_2 + offs,
 			coef[val] >> 8);
+		ad9361_spi_write(spi, REG_TX_FILTER_COEF_WRITE_DATA_1 + offs,
+			coef[val] & 0xFF);
+		ad9361_spi_write(spi, REG_TX_FILTER_COEF_ADDR + offs, val);
 		ad9361_spi_write(spi, REG_TX_FILTER_CONF + offs,
 			fir_conf | FIR_WRITE);
 		ad9361_spi_write(spi, REG_TX_FILTER_COEF_READ_DATA_2 + offs, 0);
@@ -5535,6 +6519,9 @@ int32_t ad9361_load_fir_filter_coef(struct ad9361_rf_phy *phy,
 	fir_conf &= ~FIR_START_CLK;
 	ad9361_spi_write(spi, REG_TX_FILTER_CONF + offs, fir_conf);
 
+	ret = ad9361_spi_batch_end(spi);
+
+out_restore:
 	if (dest & FIR_IS_RX)
 		ad9361_spi_writef(phy->spi, REG_RX_ENABLE_FILTER_CTRL,
 			RX_FIR_ENABLE_DECIMATION(~0), fir_enable);
@@ -5544,6 +6531,9 @@ int32_t ad9361_load_fir_filter_coef(struct ad9361_rf_phy *phy,
 
 	ad9361_ensm_restore_prev_state(phy);
 
+	if (ret < 0)
+		return ret;
+
 	return ad9361_verify_fir_filter_coef(phy, dest, ntaps, coef);
 }
 
@@ -2837,6 +2837,10 @@
 
 #define MAX_MBYTE_SPI			8
 
+#define SPI_BATCH_MAX_XFERS		64
+
+#define AD9361_NUM_REGS			0x400
+
 #define RFPLL_MODULUS			8388593UL
 #define BBPLL_MODULUS			2088960UL
 
@@ -3286,6 +3290,73 @@ struct ad9361_fastlock {
 	struct ad9361_fastlock_entry entry[2][8];
 };
 
+#define AD9361_CAL_CACHE_MAGIC		0x41443943 /* "AD9C" */
+#define AD9361_CAL_CACHE_VERSION	2
+#define AD9361_CAL_CACHE_TEMP_DELTA	10000 /* m C */
+#define AD9361_CAL_CACHE_LO_DELTA	100000000ULL /* 100 MHz */
+
+enum ad9361_cal_cache_sections {
+	AD9361_CAL_RX_BBF = (1 << 0),
+	AD9361_CAL_TX_BBF = (1 << 1),
+	AD9361_CAL_TX_QUAD = (1 << 2),
+};
+
+struct ad9361_cal_cache {
+	uint32_t		magic;
+	uint16_t		version;
+	uint16_t		size;
+	uint32_t		valid;
+	/* Conditions the results were taken at */
+	uint64_t		tx_lo_freq;
+	uint32_t		rf_rx_bw;
+	uint32_t		rf_tx_bw;
+	uint32_t		bbpll_freq;
+	int32_t			temp;
+	/* Calibration results */
+	uint8_t			rx_bbf[REG_RX_BBF_C3_LSB - REG_RX1_BBF_R1A + 1];
+	uint8_t			tx_bbf[REG_TX_BBF_R2B - REG_TX_BBF_R1 + 1];
+	uint8_t			tx_quad[REG_TX2_OUT_2_OFFSET_Q -
+					REG_TX1_OUT_1_PHASE_CORR + 1];
+	uint8_t			tx_quad_phase;
+	uint32_t		checksum;
+};
+
+#define AD9361_CLK_PLAN_CACHE_SIZE	8
+
+struct ad9361_clk_plan {
+	bool			valid;
+	uint32_t		rate;
+	uint32_t		rate_gov;
+	uint32_t		rx_intdec;
+	uint32_t		tx_intdec;
+	bool			rx_eq_2tx;
+	uint32_t		ref_rate;
+	uint32_t		rx_path_clks[6];
+	uint32_t		tx_path_clks[6];
+	uint32_t		bbpll_rate;
+};
+
+#define AD9361_HOP_SLOTS		8
+#define AD9361_HOP_LOCK_TIMEOUT_POLLS	1000
+
+struct ad9361_hop_table {
+	bool			tx;
+	uint32_t		num_entries;
+	uint64_t		*freq;
+	uint8_t			(*words)[RX_FAST_LOCK_CONFIG_WORD_NUM];
+	int32_t			slot_entry[AD9361_HOP_SLOTS];
+	uint32_t		current;
+	uint32_t		current_slot;
+	uint32_t		lock_timeout_polls;
+	/* Statistics, the lock times are in VCO lock polls */
+	uint32_t		hops;
+	uint32_t		loads;
+	uint32_t		misses;
+	uint32_t		last_lock_polls;
+	uint32_t		max_lock_polls;
+	uint64_t		total_lock_polls;
+};
+
 enum dig_tune_flags {
 	BE_VERBOSE = 1,
 	BE_MOREVERBOSE = 2,
@@ -3307,10 +3378,27 @@ enum dev_id {
 	ID_AD9363A
 };
 
+struct ad9361_reg_shadow {
+	uint8_t			val[AD9361_NUM_REGS];
+	uint8_t			valid[AD9361_NUM_REGS / 8];
+	bool			verify;
+	uint32_t		hits;
+	uint32_t		mismatches;
+};
+
+struct spi_batch {
+	uint8_t			buf[SPI_BATCH_MAX_XFERS * (MAX_MBYTE_SPI + 2)];
+	uint8_t			xfer_len[SPI_BATCH_MAX_XFERS];
+	uint32_t		len;
+	uint32_t		num_xfers;
+	uint32_t		depth;
+};
+
 struct ad9361_rf_phy {
 	enum dev_id		dev_sel;
 	uint8_t 		id_no;
 	struct spi_device 	*spi;
+	struct ad9361_reg_shadow	reg_shadow;
 	struct clk 		*clk_refin;
 	struct clk 		*clks[NUM_AD9361_CLKS];
 	struct refclk_scale *ref_clk_scale[NUM_AD9361_CLKS];
@@ -3340,6 +3428,10 @@ struct ad9361_rf_phy {
 	uint32_t			current_tx_bw_Hz;
 	uint32_t			rxbbf_div;
 	uint32_t			rate_governor;
+	struct ad9361_cal_cache	*cal_cache;
+	uint32_t			cal_reuse;
+	struct ad9361_clk_plan	clk_plan[AD9361_CLK_PLAN_CACHE_SIZE];
+	uint32_t			clk_plan_next;
 	bool			bypass_rx_fir;
 	bool			bypass_tx_fir;
 	bool			rx_eq_2tx;
@@ -3402,6 +3494,13 @@ int32_t ad9361_spi_readm(struct spi_device *spi, uint32_t reg,
 int32_t ad9361_spi_read(struct spi_device *spi, uint32_t reg);
 int32_t ad9361_spi_write(struct spi_device *spi,
 	uint32_t reg, uint32_t val);
+int32_t ad9361_spi_batch_begin(struct spi_device *spi);
+int32_t ad9361_spi_batch_flush(struct spi_device *spi);
+int32_t ad9361_spi_batch_end(struct spi_device *spi);
+void ad9361_reg_shadow_enable(struct ad9361_rf_phy *phy, bool enable,
+	bool verify);
+void ad9361_reg_shadow_invalidate(struct ad9361_rf_phy *phy);
+int32_t ad9361_reg_shadow_verify(struct ad9361_rf_phy *phy);
 int32_t ad9361_reset(struct ad9361_rf_phy *phy);
 int32_t register_clocks(struct ad9361_rf_phy *phy);
 int32_t ad9361_init_gain_tables(struct ad9361_rf_phy *phy);
@@ -3421,6 +3520,8 @@ int32_t ad9361_calculate_rf_clock_chain(struct ad9361_rf_phy *phy,
 	uint32_t rate_gov,
 	uint32_t *rx_path_clks,
 	uint32_t *tx_path_clks);
+int32_t ad9361_cal_cache_save(struct ad9361_rf_phy *phy,
+	struct ad9361_cal_cache *cache);
 int32_t ad9361_set_trx_clock_chain(struct ad9361_rf_phy *phy,
 	uint32_t *rx_path_clks,
 	uint32_t *tx_path_clks);
@@ -3484,6 +3585,17 @@ int32_t ad9361_fastlock_load(struct ad9361_rf_phy *phy, bool tx,
 	uint32_t profile, uint8_t *values);
 int32_t ad9361_fastlock_save(struct ad9361_rf_phy *phy, bool tx,
 	uint32_t profile, uint8_t *values);
+int32_t ad9361_hop_table_init(struct ad9361_rf_phy *phy, bool tx,
+	uint64_t *freq, uint32_t num_entries,
+	struct ad9361_hop_table **table_out);
+int32_t ad9361_hop_table_slot(struct ad9361_hop_table *table, uint32_t index);
+int32_t ad9361_hop_table_hop(struct ad9361_rf_phy *phy,
+	struct ad9361_hop_table *table, uint32_t index);
+int32_t ad9361_hop_table_pin_control(struct ad9361_rf_phy *phy,
+	struct ad9361_hop_table *table, bool enable);
+int32_t ad9361_hop_table_pin_hop(struct ad9361_rf_phy *phy,
+	struct ad9361_hop_table *table, uint32_t index);
+void ad9361_hop_table_remove(struct ad9361_hop_table *table);
 void ad9361_ensm_force_state(struct ad9361_rf_phy *phy, uint8_t ensm_state);
 uint8_t ad9361_ensm_get_state(struct ad9361_rf_phy *phy);
 void ad9361_ensm_restore_state(struct ad9361_rf_phy *phy, uint8_t ensm_state);
@@ -46,6 +46,9 @@
 #include "util.h"
 #include "config.h"
 #include <string.h>
+#ifdef LINUX_PLATFORM
+#include <pthread.h>
+#endif
 
 #ifndef AXI_ADC_NOT_PRESENT
 /******************************************************************************/
@@ -427,6 +430,8 @@ int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy, AD9361_InitParam *init_p
 	phy->ad9361_rfpll_ext_round_rate = init_param->ad9361_rfpll_ext_round_rate;
 	phy->ad9361_rfpll_ext_set_rate = init_param->ad9361_rfpll_ext_set_rate;
 
+	phy->cal_cache = init_param->cal_cache;
+
 	ret = register_clocks(phy);
 	if (ret < 0)
 		goto out;
@@ -456,6 +461,7 @@ int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy, AD9361_InitParam *init_p
 	return 0;
 
 out:
+	free(phy->spi->batch);
 	free(phy->spi);
 #ifndef AXI_ADC_NOT_PRESENT
 	free(phy->adc_conv);
@@ -469,6 +475,94 @@ out:
 	return -ENODEV;
 }
 
+#ifdef LINUX_PLATFORM
+struct ad9361_init_job {
+	struct ad9361_rf_phy	**phy;
+	AD9361_InitParam	*init_param;
+	int32_t			ret;
+};
+
+/**
+ * Initialization thread of ad9361_init_multi().
+ * @param arg The initialization job.
+ * @return NULL.
+ */
+static void *ad9361_init_thread(void *arg)
+{
+	struct ad9361_init_job *job = arg;
+
+	job->ret = ad9361_init(job->phy, job->init_param);
+
+	return NULL;
+}
+#endif
+
+/**
+ * Initialize several AD9361 devices. On Linux each device is brought up
+ * (reset, setup and calibrations) in its own thread, so the devices on
+ * separate SPI buses are initialized concurrently. On the other platforms
+ * the devices are initialized one after the other.
+ * @param ad9361_phy The AD9361 state structures (num entries).
+ * @param init_param The initialization parameters (num entries).
+ * @param num The number of devices.
+ * @return 0 in case of success, negative error code otherwise.
+ *
+ * Note: The devices are not synchronized; call ad9361_do_mcs_multi()
+ *       after this function returns.
+ */
+int32_t ad9361_init_multi(struct ad9361_rf_phy **ad9361_phy,
+		AD9361_InitParam *init_param, uint32_t num)
+{
+	int32_t ret = 0;
+	uint32_t i;
+#ifdef LINUX_PLATFORM
+	struct ad9361_init_job *job;
+	pthread_t *thread;
+	bool *started;
+
+	job = (struct ad9361_init_job *)zmalloc(num * sizeof(*job));
+	thread = (pthread_t *)zmalloc(num * sizeof(*thread));
+	started = (bool *)zmalloc(num * sizeof(*started));
+	if (!job || !thread || !started) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i < num; i++) {
+		ad9361_phy[i] = NULL;
+		job[i].phy = &ad9361_phy[i];
+		job[i].init_param = &init_param[i];
+		started[i] = !pthread_create(&thread[i], NULL,
+			ad9361_init_thread, &job[i]);
+		if (!started[i])
+			ad9361_init_thread(&job[i]);
+	}
+
+	for (i = 0; i < num; i++) {
+		if (started[i])
+			pthread_join(thread[i], NULL);
+		if ((job[i].ret < 0) && (ret == 0))
+			ret = job[i].ret;
+	}
+
+out:
+	free(started);
+	free(thread);
+	free(job);
+#else
+	for (i = 0; i < num; i++) {
+		ad9361_phy[i] = NULL;
+		ret = ad9361_init(&ad9361_phy[i], &init_param[i]);
+		if (ret < 0)
+			break;
+	}
+#endif
+	if (ret < 0)
+		printf("%s : AD936x multi-device initialization error\n", __func__);
+
+	return ret;
+}
+
 /**
  * Set the Enable State Machine (ENSM) mode.
  * @param phy The AD9361 current state structure.
@@ -1787,36 +1881,56 @@ int32_t ad9361_set_no_ch_mode(struct ad9361_rf_phy *phy, uint8_t no_ch_mode)
  * Note: This function will/may affect the data path.
  */
 int32_t ad9361_do_mcs(struct ad9361_rf_phy *phy_master, struct ad9361_rf_phy *phy_slave)
+{
+	struct ad9361_rf_phy *phy[2] = {phy_master, phy_slave};
+
+	return ad9361_do_mcs_multi(phy, 2);
+}
+
+/**
+ * Do multi chip synchronization of several devices.
+ * @param phy The AD9361 state structures; phy[0] is the master.
+ * @param num The number of devices.
+ * @return 0 in case of success, negative error code otherwise.
+ *
+ * Note: This function will/may affect the data path.
+ */
+int32_t ad9361_do_mcs_multi(struct ad9361_rf_phy **phy, uint32_t num)
 {
 	uint32_t ensm_mode;
 	int32_t step;
-	int32_t reg;
-
-	if ((phy_master->dev_sel == ID_AD9363A) ||
-			(phy_slave->dev_sel == ID_AD9363A)) {
-		printf("%s : MCS is not supported by AD9363!\n", __func__);
-		return -1;
+	int32_t rx_delay, tx_delay;
+	uint32_t i;
+
+	for (i = 0; i < num; i++) {
+		if (phy[i]->dev_sel == ID_AD9363A) {
+			printf("%s : MCS is not supported by AD9363!\n", __func__);
+			return -1;
+		}
 	}
 
-	reg = ad9361_spi_read(phy_master->spi, REG_RX_CLOCK_DATA_DELAY);
-	ad9361_spi_write(phy_slave->spi, REG_RX_CLOCK_DATA_DELAY, reg);
-	reg = ad9361_spi_read(phy_master->spi, REG_TX_CLOCK_DATA_DELAY);
-	ad9361_spi_write(phy_slave->spi, REG_TX_CLOCK_DATA_DELAY, reg);
+	rx_delay = ad9361_spi_read(phy[0]->spi, REG_RX_CLOCK_DATA_DELAY);
+	tx_delay = ad9361_spi_read(phy[0]->spi, REG_TX_CLOCK_DATA_DELAY);
+	for (i = 1; i < num; i++) {
+		ad9361_spi_write(phy[i]->spi, REG_RX_CLOCK_DATA_DELAY, rx_delay);
+		ad9361_spi_write(phy[i]->spi, REG_TX_CLOCK_DATA_DELAY, tx_delay);
+	}
 
-	ad9361_get_en_state_machine_mode(phy_master, &ensm_mode);
+	ad9361_get_en_state_machine_mode(phy[0], &ensm_mode);
 
-	ad9361_set_en_state_machine_mode(phy_master, ENSM_MODE_ALERT);
-	ad9361_set_en_state_machine_mode(phy_slave, ENSM_MODE_ALERT);
+	for (i = 0; i < num; i++)
+		ad9361_set_en_state_machine_mode(phy[i], ENSM_MODE_ALERT);
 
 	for (step = 0; step <= 5; step++)
 	{
-		ad9361_mcs(phy_slave, step);
-		ad9361_mcs(phy_master, step);
+		for (i = 1; i < num; i++)
+			ad9361_mcs(phy[i], step);
+		ad9361_mcs(phy[0], step);
 		mdelay(100);
 	}
 
-	ad9361_set_en_state_machine_mode(phy_master, ensm_mode);
-	ad9361_set_en_state_machine_mode(phy_slave, ensm_mode);
+	for (i = 0; i < num; i++)
+		ad9361_set_en_state_machine_mode(phy[i], ensm_mode);
 
 	return 0;
 }
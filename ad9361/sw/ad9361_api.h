@@ -282,6 +282,8 @@ typedef struct
 	uint32_t	(*ad9361_rfpll_ext_recalc_rate)(struct refclk_scale *clk_priv);
 	int32_t		(*ad9361_rfpll_ext_round_rate)(struct refclk_scale *clk_priv, uint32_t rate);
 	int32_t		(*ad9361_rfpll_ext_set_rate)(struct refclk_scale *clk_priv, uint32_t rate);
+	/* Warm restart */
+	struct ad9361_cal_cache	*cal_cache;
 }AD9361_InitParam;
 
 typedef struct
@@ -356,6 +358,9 @@ enum ad9361_ensm_mode {
 /******************************************************************************/
 /* Initialize the AD9361 part. */
 int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy, AD9361_InitParam *init_param);
+/* Initialize several AD9361 devices, concurrently where the platform allows it. */
+int32_t ad9361_init_multi(struct ad9361_rf_phy **ad9361_phy,
+		AD9361_InitParam *init_param, uint32_t num);
 /* Set the Enable State Machine (ENSM) mode. */
 int32_t ad9361_set_en_state_machine_mode (struct ad9361_rf_phy *phy, uint32_t mode);
 /* Get the Enable State Machine (ENSM) mode. */
@@ -468,6 +473,8 @@ int32_t ad9361_get_trx_path_clks(struct ad9361_rf_phy *phy, uint32_t *rx_path_cl
 int32_t ad9361_set_no_ch_mode(struct ad9361_rf_phy *phy, uint8_t no_ch_mode);
 /* Do multi chip synchronization. */
 int32_t ad9361_do_mcs(struct ad9361_rf_phy *phy_master, struct ad9361_rf_phy *phy_slave);
+/* Do multi chip synchronization of several devices. */
+int32_t ad9361_do_mcs_multi(struct ad9361_rf_phy **phy, uint32_t num);
 /* Enable/disable the TRX FIR filters. */
 int32_t ad9361_set_trx_fir_en_dis (struct ad9361_rf_phy *phy, uint8_t en_dis);
 /* Set the OSR rate governor. */
@@ -44,6 +44,8 @@
 #include "console.h"
 #include "../ad9361_api.h"
 #include "dac_core.h"
+#include <stdlib.h>
+#include <string.h>
 
 /******************************************************************************/
 /************************ Constants Definitions *******************************/
@@ -103,6 +105,9 @@ command cmd_list[] = {
 	{"dds_tx2_tone1_scale=", "Sets the DDS TX2 Tone 1 scale.", "", set_dds_tx2_tone1_scale},
 	{"dds_tx2_tone2_scale?", "Gets current DDS TX2 Tone 2 scale.", "", dds_tx2_tone2_scale},
 	{"dds_tx2_tone2_scale=", "Sets the DDS TX2 Tone 2 scale.", "", set_dds_tx2_tone2_scale},
+	{"batch!", "Starts a batch script; the next commands are queued.", "", start_batch},
+	{"commit!", "Applies the queued batch script as a single transaction.", "", commit_batch},
+	{"abort!", "Drops the queued batch script.", "", abort_batch},
 };
 const char cmd_no = (sizeof(cmd_list) / sizeof(command));
 
@@ -111,6 +116,10 @@ const char cmd_no = (sizeof(cmd_list) / sizeof(command));
 /******************************************************************************/
 extern struct dds_state dds_st;
 extern struct ad9361_rf_phy *ad9361_phy;
+unsigned char cmd_hash_table[CMD_HASH_SIZE];
+char batch_script[CMD_BATCH_SIZE];
+unsigned short batch_len = 0;
+char batch_active = 0;
 
 /**************************************************************************//***
  * @brief Show the invalid parameter message.
@@ -1007,3 +1016,311 @@ void set_dds_tx2_tone2_scale(double* param, char param_no)	// dds_tx2_tone2_scal
 	else
 		show_invalid_param_message(1);
 }
+
+/**************************************************************************//***
+ * @brief Computes the hash of a command name (FNV-1a).
+ *
+ * @param name - Command name, including the '!', '?' or '=' terminator.
+ * @param len  - Length of the command name.
+ *
+ * @return The hash value.
+*******************************************************************************/
+static unsigned long command_hash(const char* name, unsigned char len)
+{
+	unsigned long hash = 2166136261UL;
+	unsigned char index;
+
+	for(index = 0; index < len; index++)
+	{
+		hash ^= (unsigned char)name[index];
+		hash *= 16777619UL;
+	}
+
+	return hash & 0xFFFFFFFFUL;
+}
+
+/**************************************************************************//***
+ * @brief Gets the length of the command name of a command line.
+ *
+ * @param line - Command line.
+ *
+ * @return The length of the name including the terminator, 0 if the line
+ *         holds no valid command name.
+*******************************************************************************/
+static unsigned char command_name_len(const char* line)
+{
+	unsigned char len = 0;
+
+	while((line[len] != '!') && (line[len] != '?') && (line[len] != '='))
+	{
+		if((line[len] == '\0') || (line[len] == '\n') ||
+		   (line[len] == '\r') || (line[len] == ';') ||
+		   (len == 0xFE))
+		{
+			return 0;
+		}
+		len++;
+	}
+
+	return len + 1;
+}
+
+/**************************************************************************//***
+ * @brief Builds the command hash table. Must be called once before
+ *        command_process_line().
+ *
+ * @return None.
+*******************************************************************************/
+void command_init(void)
+{
+	unsigned char index;
+	unsigned long slot;
+
+	memset(cmd_hash_table, 0, sizeof(cmd_hash_table));
+	for(index = 0; index < cmd_no; index++)
+	{
+		slot = command_hash(cmd_list[index].name,
+							strlen(cmd_list[index].name)) & (CMD_HASH_SIZE - 1);
+		while(cmd_hash_table[slot])
+		{
+			slot = (slot + 1) & (CMD_HASH_SIZE - 1);
+		}
+		cmd_hash_table[slot] = index + 1;
+	}
+}
+
+/**************************************************************************//***
+ * @brief Finds the command of a command line.
+ *
+ * @param line - Command line.
+ * @param len  - Length of the command name (see command_name_len()).
+ *
+ * @return The index of the command in cmd_list or -1 if not found.
+*******************************************************************************/
+static int command_lookup(const char* line, unsigned char len)
+{
+	unsigned long slot;
+	unsigned char index;
+
+	slot = command_hash(line, len) & (CMD_HASH_SIZE - 1);
+	while(cmd_hash_table[slot])
+	{
+		index = cmd_hash_table[slot] - 1;
+		if((strncmp(cmd_list[index].name, line, len) == 0) &&
+		   (cmd_list[index].name[len] == '\0'))
+		{
+			return index;
+		}
+		slot = (slot + 1) & (CMD_HASH_SIZE - 1);
+	}
+
+	return -1;
+}
+
+/**************************************************************************//***
+ * @brief Parses the space separated parameters of a command. Hexadecimal
+ *        values are accepted with the "0x" prefix.
+ *
+ * @param str   - Parameters string.
+ * @param param - Parameters' buffer (CMD_MAX_PARAMS entries).
+ *
+ * @return The number of parameters.
+*******************************************************************************/
+static char command_parse_params(const char* str, double* param)
+{
+	unsigned char count = 0;
+	char* end;
+
+	while(count < CMD_MAX_PARAMS)
+	{
+		while(*str == ' ')
+		{
+			str++;
+		}
+		if((*str == '\0') || (*str == '\n') || (*str == '\r') || (*str == ';'))
+		{
+			break;
+		}
+		if((str[0] == '0') && ((str[1] == 'x') || (str[1] == 'X')))
+		{
+			param[count] = strtoul(str, &end, 16);
+		}
+		else
+		{
+			param[count] = strtod(str, &end);
+		}
+		if(end == str)
+		{
+			break;
+		}
+		count++;
+		str = end;
+	}
+
+	return (char)count;
+}
+
+/**************************************************************************//***
+ * @brief Executes one command line.
+ *
+ * @param line - Command line.
+ *
+ * @return The command index or UNKNOWN_CMD if the command is not valid.
+*******************************************************************************/
+int command_execute(const char* line)
+{
+	double param[CMD_MAX_PARAMS] = {0, 0, 0, 0, 0};
+	unsigned char len;
+	char param_no;
+	int cmd;
+
+	len = command_name_len(line);
+	cmd = len ? command_lookup(line, len) : -1;
+	if(cmd < 0)
+	{
+		console_print("Invalid command!\n");
+		return UNKNOWN_CMD;
+	}
+	param_no = command_parse_params(&line[len], param);
+	cmd_list[cmd].function(param, param_no);
+
+	return cmd;
+}
+
+/**************************************************************************//***
+ * @brief Runs a script of commands separated by new lines or ';' as a single
+ *        transaction: the ENSM is moved to the ALERT state once for the whole
+ *        script instead of once per command.
+ *
+ * @param script - Command script.
+ *
+ * @return The number of invalid commands.
+*******************************************************************************/
+int command_run_script(const char* script)
+{
+	uint32_t ensm_mode;
+	int errors = 0;
+
+	ad9361_get_en_state_machine_mode(ad9361_phy, &ensm_mode);
+	if(ensm_mode != ENSM_MODE_ALERT)
+	{
+		ad9361_set_en_state_machine_mode(ad9361_phy, ENSM_MODE_ALERT);
+	}
+
+	while(*script)
+	{
+		while((*script == '\n') || (*script == '\r') ||
+			  (*script == ';') || (*script == ' '))
+		{
+			script++;
+		}
+		if(*script == '\0')
+		{
+			break;
+		}
+		if(command_execute(script) == UNKNOWN_CMD)
+		{
+			errors++;
+		}
+		while((*script != '\0') && (*script != '\n') &&
+			  (*script != '\r') && (*script != ';'))
+		{
+			script++;
+		}
+	}
+
+	if(ensm_mode != ENSM_MODE_ALERT)
+	{
+		ad9361_set_en_state_machine_mode(ad9361_phy, ensm_mode);
+	}
+
+	return errors;
+}
+
+/**************************************************************************//***
+ * @brief Processes one line received from the console. While a batch script
+ *        is open the commands are queued, otherwise they are executed. A line
+ *        holding several commands separated by ';' is run as a script.
+ *
+ * @param line - Command line.
+ *
+ * @return None.
+*******************************************************************************/
+void command_process_line(const char* line)
+{
+	unsigned short len = 0;
+
+	while((line[len] != '\0') && (line[len] != '\n') && (line[len] != '\r'))
+	{
+		len++;
+	}
+
+	if(batch_active &&
+	   (strncmp(line, "commit!", 7) != 0) && (strncmp(line, "abort!", 6) != 0))
+	{
+		if(batch_len + len + 2 > CMD_BATCH_SIZE)
+		{
+			console_print("Batch script too long!\n");
+			return;
+		}
+		memcpy(&batch_script[batch_len], line, len);
+		batch_len += len;
+		batch_script[batch_len++] = '\n';
+		batch_script[batch_len] = '\0';
+		return;
+	}
+
+	if(memchr(line, ';', len))
+	{
+		command_run_script(line);
+	}
+	else
+	{
+		command_execute(line);
+	}
+}
+
+/**************************************************************************//***
+ * @brief Starts a batch script.
+ *
+ * @return None.
+*******************************************************************************/
+void start_batch(double* param, char param_no) // "batch!" command
+{
+	batch_active = 1;
+	batch_len = 0;
+	batch_script[0] = '\0';
+	console_print("batch started\n");
+}
+
+/**************************************************************************//***
+ * @brief Applies the queued batch script.
+ *
+ * @return None.
+*******************************************************************************/
+void commit_batch(double* param, char param_no) // "commit!" command
+{
+	int errors;
+
+	if(!batch_active)
+	{
+		console_print("No batch started!\n");
+		return;
+	}
+	batch_active = 0;
+	errors = command_run_script(batch_script);
+	batch_len = 0;
+	console_print("batch committed, %d errors\n", errors);
+}
+
+/**************************************************************************//***
+ * @brief Drops the queued batch script.
+ *
+ * @return None.
+*******************************************************************************/
+void abort_batch(double* param, char param_no) // "abort!" command
+{
+	batch_active = 0;
+	batch_len = 0;
+	console_print("batch aborted\n");
+}
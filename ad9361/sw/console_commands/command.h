@@ -46,6 +46,10 @@
 #define SUCCESS		0
 #define ERROR		-1
 
+#define CMD_HASH_SIZE		128	/* Power of 2, at least twice the commands */
+#define CMD_MAX_PARAMS		5
+#define CMD_BATCH_SIZE		1024
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -224,4 +228,25 @@ void dds_tx2_tone2_scale(double* param, char param_no);
 /* Sets the DDS TX2 Tone 2 scale. */
 void set_dds_tx2_tone2_scale(double* param, char param_no);
 
+/* Starts a batch script. */
+void start_batch(double* param, char param_no);
+
+/* Applies the queued batch script. */
+void commit_batch(double* param, char param_no);
+
+/* Drops the queued batch script. */
+void abort_batch(double* param, char param_no);
+
+/* Builds the command hash table. */
+void command_init(void);
+
+/* Executes one command line. */
+int command_execute(const char* line);
+
+/* Runs a script of commands as a single transaction. */
+int command_run_script(const char* script);
+
+/* Processes one line received from the console. */
+void command_process_line(const char* line);
+
 #endif  // __COMMAND_H__
@@ -283,22 +283,28 @@ char console_init(unsigned long baud_rate)
 }
 
 /***************************************************************************//**
- * @brief Reads one command from console.
+ * @brief Reads one command from console. At most size - 1 characters are
+ *        stored, the rest of a longer line is dropped.
  *
  * @param command - Read command.
+ * @param size    - Size of the command buffer.
  *
  * @return None.
 *******************************************************************************/
-void console_get_command(char* command)
+void console_get_command(char* command, unsigned short size)
 {
-	char		  received_char	= 0;
-	unsigned char char_number	= 0;
+	char		   received_char = 0;
+	unsigned short char_number	 = 0;
 
 	while((received_char != '\n') && (received_char != '\r'))
 	{
 		uart_read_char(&received_char);
-		command[char_number++] = received_char;
+		if(char_number < size - 1)
+		{
+			command[char_number++] = received_char;
+		}
 	}
+	command[char_number] = '\0';
 }
 
 /***************************************************************************//**
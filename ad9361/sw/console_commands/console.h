@@ -57,7 +57,7 @@ char console_init(unsigned long baud_rate);
 void console_print(char* str, ...);
 
 /* Reads one command from console. */
-void console_get_command(char* command);
+void console_get_command(char* command, unsigned short size);
 
 /* Compares two commands and returns the type of the command. */
 int console_check_commands(char*	   received_cmd,
@@ -60,17 +60,7 @@
 /************************ Variables Definitions *******************************/
 /******************************************************************************/
 #ifdef CONSOLE_COMMANDS
-extern command	  	cmd_list[];
-extern char			cmd_no;
-extern cmd_function	cmd_functions[11];
-unsigned char		cmd				 =  0;
-double				param[5]		 = {0, 0, 0, 0, 0};
-char				param_no		 =  0;
-int					cmd_type		 = -1;
-char				invalid_cmd		 =  0;
-char				received_cmd[30] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-										0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-										0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+char				received_cmd[CMD_BATCH_SIZE];
 #endif
 
 AD9361_InitParam default_init_param = {
@@ -310,7 +300,9 @@ AD9361_InitParam default_init_param = {
 	/* External LO clocks */
 	NULL,	//(*ad9361_rfpll_ext_recalc_rate)()
 	NULL,	//(*ad9361_rfpll_ext_round_rate)()
-	NULL	//(*ad9361_rfpll_ext_set_rate)()
+	NULL,	//(*ad9361_rfpll_ext_set_rate)()
+	/* Warm restart */
+	NULL	//cal_cache
 };
 
 AD9361_RXFIRConfig rx_fir_config = {	// BPF PASSBAND 3/20 fs to 1/4 fs
@@ -365,6 +357,8 @@ AD9361_TXFIRConfig tx_fir_config = {	// BPF PASSBAND 3/20 fs to 1/4 fs
 struct ad9361_rf_phy *ad9361_phy;
 #ifdef FMCOMMS5
 struct ad9361_rf_phy *ad9361_phy_b;
+struct ad9361_rf_phy *fmcomms5_phy[2];
+AD9361_InitParam fmcomms5_init_param[2];
 #endif
 
 /***************************************************************************//**
@@ -424,33 +418,45 @@ int main(void)
 	default_init_param.digital_interface_tune_fir_disable = 1;
 #endif
 
-	ad9361_init(&ad9361_phy, &default_init_param);
-
-	ad9361_set_tx_fir_config(ad9361_phy, tx_fir_config);
-	ad9361_set_rx_fir_config(ad9361_phy, rx_fir_config);
-
 #ifdef FMCOMMS5
 #ifdef LINUX_PLATFORM
 	gpio_init(default_init_param.gpio_sync);
 #endif
 	gpio_direction(default_init_param.gpio_sync, 1);
-	default_init_param.id_no = 1;
-	default_init_param.gpio_resetb = GPIO_RESET_PIN_2;
+	fmcomms5_init_param[0] = default_init_param;
+	fmcomms5_init_param[1] = default_init_param;
+	fmcomms5_init_param[1].id_no = 1;
+	fmcomms5_init_param[1].gpio_resetb = GPIO_RESET_PIN_2;
 #ifdef LINUX_PLATFORM
-	gpio_init(default_init_param.gpio_resetb);
+	gpio_init(fmcomms5_init_param[1].gpio_resetb);
 #endif
-	default_init_param.gpio_sync = -1;
-	default_init_param.gpio_cal_sw1 = -1;
-	default_init_param.gpio_cal_sw2 = -1;
-	default_init_param.rx_synthesizer_frequency_hz = 2300000000UL;
-	default_init_param.tx_synthesizer_frequency_hz = 2300000000UL;
-	gpio_direction(default_init_param.gpio_resetb, 1);
-	ad9361_init(&ad9361_phy_b, &default_init_param);
+	fmcomms5_init_param[1].gpio_sync = -1;
+	fmcomms5_init_param[1].gpio_cal_sw1 = -1;
+	fmcomms5_init_param[1].gpio_cal_sw2 = -1;
+	fmcomms5_init_param[1].rx_synthesizer_frequency_hz = 2300000000UL;
+	fmcomms5_init_param[1].tx_synthesizer_frequency_hz = 2300000000UL;
+	gpio_direction(fmcomms5_init_param[1].gpio_resetb, 1);
+
+	/* Bring up both devices at once, each on its own SPI bus */
+	if (ad9361_init_multi(fmcomms5_phy, fmcomms5_init_param, 2) < 0) {
+		printf("AD9361 Init Error!\n");
+		return -1;
+	}
+	ad9361_phy = fmcomms5_phy[0];
+	ad9361_phy_b = fmcomms5_phy[1];
 
 	ad9361_set_tx_fir_config(ad9361_phy_b, tx_fir_config);
 	ad9361_set_rx_fir_config(ad9361_phy_b, rx_fir_config);
+#else
+	if (ad9361_init(&ad9361_phy, &default_init_param) < 0) {
+		printf("AD9361 Init Error!\n");
+		return -1;
+	}
 #endif
 
+	ad9361_set_tx_fir_config(ad9361_phy, tx_fir_config);
+	ad9361_set_rx_fir_config(ad9361_phy, rx_fir_config);
+
 #ifndef AXI_ADC_NOT_PRESENT
 #if defined XILINX_PLATFORM || defined LINUX_PLATFORM || defined ALTERA_PLATFORM
 #ifdef DAC_DMA
@@ -486,30 +492,13 @@ int main(void)
 #endif
 
 #ifdef CONSOLE_COMMANDS
+	command_init();
 	get_help(NULL, 0);
 
 	while(1)
 	{
-		console_get_command(received_cmd);
-		invalid_cmd = 0;
-		for(cmd = 0; cmd < cmd_no; cmd++)
-		{
-			param_no = 0;
-			cmd_type = console_check_commands(received_cmd, cmd_list[cmd].name,
-											  param, &param_no);
-			if(cmd_type == UNKNOWN_CMD)
-			{
-				invalid_cmd++;
-			}
-			else
-			{
-				cmd_list[cmd].function(param, param_no);
-			}
-		}
-		if(invalid_cmd == cmd_no)
-		{
-			console_print("Invalid command!\n");
-		}
+		console_get_command(received_cmd, sizeof(received_cmd));
+		command_process_line(received_cmd);
 	}
 #endif
 
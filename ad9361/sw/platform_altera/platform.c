@@ -204,6 +204,27 @@ int spi_write_then_read(struct spi_device *spi,
 	return SUCCESS;
 }
 
+/***************************************************************************//**
+ * @brief spi_write_batch
+*******************************************************************************/
+int spi_write_batch(struct spi_device *spi,
+		const unsigned char *txbuf, const unsigned char *xfer_len,
+		unsigned n_xfers)
+{
+	unsigned i;
+	int ret;
+
+	for(i = 0; i < n_xfers; i++)
+	{
+		ret = spi_write_then_read(spi, txbuf, xfer_len[i], NULL, 0);
+		if(ret < 0)
+			return ret;
+		txbuf += xfer_len[i];
+	}
+
+	return 0;
+}
+
 /***************************************************************************//**
  * @brief alt_avl_gpio_read
 *******************************************************************************/
@@ -144,6 +144,9 @@ int32_t spi_read(uint8_t *data,
 int spi_write_then_read(struct spi_device *spi,
 		const unsigned char *txbuf, unsigned n_tx,
 		unsigned char *rxbuf, unsigned n_rx);
+int spi_write_batch(struct spi_device *spi,
+		const unsigned char *txbuf, const unsigned char *xfer_len,
+		unsigned n_xfers);
 void gpio_init(uint32_t device_id);
 void gpio_direction(uint8_t pin, uint8_t direction);
 bool gpio_is_valid(int number);
@@ -0,0 +1,292 @@
+/***************************************************************************//**
+ *   @file   adc_convert.c
+ *   @brief  Implementation of the capture buffer conversion.
+********************************************************************************
+ * Copyright 2016(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "adc_convert.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ADC_CONVERT_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ADC_CONVERT_SSE2
+#endif
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+struct adc_convert_job
+{
+	const struct adc_convert *conv;
+	uint32_t first_frame;
+	uint32_t no_of_frames;
+	char *buff;
+	size_t length;
+	pthread_t thread;
+	uint8_t threaded;
+};
+
+/***************************************************************************//**
+ * @brief adc_convert_swap_iq
+ *
+ * Swaps the halves of every word, so that I comes first in memory.
+*******************************************************************************/
+static void adc_convert_swap_iq(const uint32_t *src, uint32_t *dst,
+				uint32_t count)
+{
+	uint32_t index = 0;
+
+#if defined(ADC_CONVERT_NEON)
+	for(; index + 4 <= count; index += 4)
+		vst1q_u16((uint16_t *)(dst + index),
+			  vrev32q_u16(vld1q_u16((const uint16_t *)(src + index))));
+#elif defined(ADC_CONVERT_SSE2)
+	__m128i data;
+
+	for(; index + 4 <= count; index += 4)
+	{
+		data = _mm_loadu_si128((const __m128i *)(src + index));
+		data = _mm_or_si128(_mm_slli_epi32(data, 16),
+				    _mm_srli_epi32(data, 16));
+		_mm_storeu_si128((__m128i *)(dst + index), data);
+	}
+#endif
+	for(; index < count; index++)
+		dst[index] = (src[index] << 16) | (src[index] >> 16);
+}
+
+/***************************************************************************//**
+ * @brief adc_convert_itoa
+*******************************************************************************/
+static char *adc_convert_itoa(char *p, int16_t val)
+{
+	char digits[5];
+	uint32_t data;
+	uint8_t n = 0;
+
+	if(val < 0)
+	{
+		*p++ = '-';
+		data = -(int32_t)val;
+	}
+	else
+	{
+		data = val;
+	}
+
+	do {
+		digits[n++] = '0' + (data % 10);
+		data /= 10;
+	} while(data);
+
+	while(n)
+		*p++ = digits[--n];
+
+	return p;
+}
+
+/***************************************************************************//**
+ * @brief adc_convert_frame_bytes - worst case output size of a frame.
+*******************************************************************************/
+static size_t adc_convert_frame_bytes(const struct adc_convert *conv)
+{
+	if(conv->format == ADC_CONVERT_CSV)
+		return conv->no_of_channels * 2 * sizeof("-32768,");
+
+	return conv->no_of_channels * sizeof(uint32_t);
+}
+
+/***************************************************************************//**
+ * @brief adc_convert_chunk
+*******************************************************************************/
+static void *adc_convert_chunk(void *arg)
+{
+	struct adc_convert_job *job = arg;
+	const struct adc_convert *conv = job->conv;
+	const uint32_t *src = conv->data +
+			      (size_t)job->first_frame * conv->words_per_frame;
+	uint32_t *dst = (uint32_t *)job->buff;
+	char *p = job->buff;
+	uint32_t frame, ch;
+	uint32_t data;
+
+	switch(conv->format)
+	{
+	case ADC_CONVERT_BIN:
+		if(conv->no_of_channels == conv->words_per_frame)
+		{
+			memcpy(dst, src, (size_t)job->no_of_frames *
+			       conv->no_of_channels * sizeof(uint32_t));
+		}
+		else
+		{
+			for(frame = 0; frame < job->no_of_frames; frame++)
+			{
+				for(ch = 0; ch < conv->no_of_channels; ch++)
+					*dst++ = src[ch];
+				src += conv->words_per_frame;
+			}
+		}
+		job->length = (size_t)job->no_of_frames *
+			      conv->no_of_channels * sizeof(uint32_t);
+		break;
+	case ADC_CONVERT_SIGMF:
+		if(conv->no_of_channels == conv->words_per_frame)
+		{
+			adc_convert_swap_iq(src, dst, job->no_of_frames *
+					    conv->no_of_channels);
+		}
+		else
+		{
+			for(frame = 0; frame < job->no_of_frames; frame++)
+			{
+				adc_convert_swap_iq(src, dst, conv->no_of_channels);
+				dst += conv->no_of_channels;
+				src += conv->words_per_frame;
+			}
+		}
+		job->length = (size_t)job->no_of_frames *
+			      conv->no_of_channels * sizeof(uint32_t);
+		break;
+	case ADC_CONVERT_CSV:
+		for(frame = 0; frame < job->no_of_frames; frame++)
+		{
+			for(ch = 0; ch < conv->no_of_channels; ch++)
+			{
+				data = src[ch];
+				p = adc_convert_itoa(p, (int16_t)(data & 0xFFFF));
+				*p++ = ',';
+				p = adc_convert_itoa(p, (int16_t)(data >> 16));
+				*p++ = ((ch + 1) == conv->no_of_channels) ? '\n' : ',';
+			}
+			src += conv->words_per_frame;
+		}
+		job->length = p - job->buff;
+		break;
+	default:
+		job->length = 0;
+		break;
+	}
+
+	return NULL;
+}
+
+/***************************************************************************//**
+ * @brief adc_convert_write
+ *
+ * Converts the capture in chunks of ADC_CONVERT_CHUNK_FRAMES frames, one chunk
+ * per online CPU at a time, and writes the converted chunks in order with a
+ * single fwrite each.
+*******************************************************************************/
+int32_t adc_convert_write(const struct adc_convert *conv, FILE *f)
+{
+	struct adc_convert_job job[ADC_CONVERT_MAX_THREADS];
+	uint32_t no_of_jobs, active;
+	uint32_t frame = 0;
+	uint32_t index;
+	size_t chunk_bytes;
+	long cpus;
+	int32_t ret = 0;
+
+	if(!conv->no_of_channels ||
+	   (conv->no_of_channels > conv->words_per_frame) ||
+	   (conv->format > ADC_CONVERT_SIGMF))
+		return -1;
+
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	no_of_jobs = (cpus < 1) ? 1 : (cpus > ADC_CONVERT_MAX_THREADS) ?
+		     ADC_CONVERT_MAX_THREADS : cpus;
+	if(no_of_jobs > (conv->no_of_frames / ADC_CONVERT_CHUNK_FRAMES) + 1)
+		no_of_jobs = (conv->no_of_frames / ADC_CONVERT_CHUNK_FRAMES) + 1;
+
+	chunk_bytes = ADC_CONVERT_CHUNK_FRAMES * adc_convert_frame_bytes(conv);
+	for(index = 0; index < no_of_jobs; index++)
+	{
+		job[index].conv = conv;
+		job[index].buff = malloc(chunk_bytes);
+		if(!job[index].buff)
+		{
+			no_of_jobs = index;
+			ret = -1;
+			goto out;
+		}
+	}
+
+	while(frame < conv->no_of_frames)
+	{
+		for(active = 0; (active < no_of_jobs) &&
+		    (frame < conv->no_of_frames); active++)
+		{
+			job[active].first_frame = frame;
+			job[active].no_of_frames = conv->no_of_frames - frame;
+			if(job[active].no_of_frames > ADC_CONVERT_CHUNK_FRAMES)
+				job[active].no_of_frames = ADC_CONVERT_CHUNK_FRAMES;
+			frame += job[active].no_of_frames;
+			/* the first chunk is converted by the calling thread */
+			job[active].threaded = active &&
+				(pthread_create(&job[active].thread, NULL,
+						adc_convert_chunk,
+						&job[active]) == 0);
+		}
+
+		for(index = 0; index < active; index++)
+		{
+			if(job[index].threaded)
+				pthread_join(job[index].thread, NULL);
+			else
+				adc_convert_chunk(&job[index]);
+			if(!ret && (fwrite(job[index].buff, 1, job[index].length,
+					   f) != job[index].length))
+				ret = -1;
+		}
+		if(ret)
+			break;
+	}
+
+out:
+	for(index = 0; index < no_of_jobs; index++)
+		free(job[index].buff);
+
+	return ret;
+}
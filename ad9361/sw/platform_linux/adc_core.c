@@ -43,6 +43,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "adc_core.h"
+#include "adc_convert.h"
 #include "parameters.h"
 #include "../util.h"
 
@@ -51,6 +52,7 @@
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <poll.h>
 #include <stdio.h>
 
 /******************************************************************************/
@@ -64,6 +66,7 @@ int rx_dma_uio_fd;
 void *rx_dma_uio_addr;
 uint32_t rx_buff_mem_size;
 uint32_t rx_buff_mem_addr;
+struct adc_capture_session adc_default_session;
 #endif
 #ifdef FMCOMMS5
 int ad9361_b_uio_fd;
@@ -200,6 +203,9 @@ void adc_init(struct ad9361_rf_phy *phy)
 			      MAP_SHARED,
 			      rx_dma_uio_fd,
 			      0);
+
+	get_file_info(RX_BUFF_MEM_SIZE, &rx_buff_mem_size);
+	get_file_info(RX_BUFF_MEM_ADDR, &rx_buff_mem_addr);
 #endif
 	adc_write(phy, ADC_REG_RSTN, 0);
 	adc_write(phy, ADC_REG_RSTN, ADC_RSTN);
@@ -218,6 +224,63 @@ void adc_init(struct ad9361_rf_phy *phy)
 	}
 }
 
+#ifdef DMA_UIO
+/***************************************************************************//**
+ * @brief adc_dma_wait_done
+ *
+ * Blocks on the UIO file descriptor of the RX DMA until the transfer is done.
+ * The EOT interrupt is the only one left unmasked. If the UIO device has no
+ * interrupt attached, the function falls back to polling TRANSFER_DONE every
+ * millisecond. Both paths give up after ADC_DMA_TIMEOUT_MS.
+*******************************************************************************/
+static int32_t adc_dma_wait_done(uint32_t transfer_id)
+{
+	struct pollfd pfd;
+	uint32_t irq_count;
+	uint32_t irq_on = 1;
+	uint32_t reg_val;
+	uint32_t timeout = ADC_DMA_TIMEOUT_MS;
+	uint8_t use_irq;
+
+	adc_dma_write(AXI_DMAC_REG_IRQ_MASK, AXI_DMAC_IRQ_SOT);
+
+	while(1) {
+		/* Re-arm the interrupt before checking the status, so an EOT that
+		 * fires in between is not missed. */
+		use_irq = (write(rx_dma_uio_fd, &irq_on, sizeof(irq_on)) ==
+				sizeof(irq_on));
+
+		adc_dma_read(AXI_DMAC_REG_TRANSFER_DONE, &reg_val);
+		if(reg_val & (1 << transfer_id))
+			break;
+
+		if(!use_irq) {
+			if(timeout-- == 0) {
+				printf("%s: Timeout waiting for the RX DMA.\n", __func__);
+				return -1;
+			}
+			usleep(1000);
+			continue;
+		}
+
+		pfd.fd = rx_dma_uio_fd;
+		pfd.events = POLLIN;
+		if(poll(&pfd, 1, ADC_DMA_TIMEOUT_MS) <= 0) {
+			printf("%s: Timeout waiting for the RX DMA.\n", __func__);
+			return -1;
+		}
+		if(read(rx_dma_uio_fd, &irq_count, sizeof(irq_count)) !=
+				sizeof(irq_count))
+			return -1;
+
+		adc_dma_read(AXI_DMAC_REG_IRQ_PENDING, &reg_val);
+		adc_dma_write(AXI_DMAC_REG_IRQ_PENDING, reg_val);
+	}
+
+	return 0;
+}
+#endif
+
 /***************************************************************************//**
  * @brief adc_capture
 *******************************************************************************/
@@ -228,8 +291,6 @@ int32_t adc_capture(uint32_t size, uint32_t start_address)
 	uint32_t transfer_id;
 	uint32_t length;
 
-	get_file_info(RX_BUFF_MEM_SIZE, &rx_buff_mem_size);
-	get_file_info(RX_BUFF_MEM_ADDR, &rx_buff_mem_addr);
 	start_address = rx_buff_mem_addr;
 
 	if(adc_st.rx2tx2)
@@ -253,7 +314,7 @@ int32_t adc_capture(uint32_t size, uint32_t start_address)
 	adc_dma_write(AXI_DMAC_REG_CTRL, 0x0);
 	adc_dma_write(AXI_DMAC_REG_CTRL, AXI_DMAC_CTRL_ENABLE);
 
-	adc_dma_write(AXI_DMAC_REG_IRQ_MASK, 0x0);
+	adc_dma_write(AXI_DMAC_REG_IRQ_MASK, AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
 
 	adc_dma_read(AXI_DMAC_REG_TRANSFER_ID, &transfer_id);
 	adc_dma_read(AXI_DMAC_REG_IRQ_PENDING, &reg_val);
@@ -265,76 +326,147 @@ int32_t adc_capture(uint32_t size, uint32_t start_address)
 	adc_dma_write(AXI_DMAC_REG_Y_LENGTH, 0x0);
 
 	adc_dma_write(AXI_DMAC_REG_START_TRANSFER, 0x1);
-	/* Wait until the new transfer is queued. */
-	do {
-		adc_dma_read(AXI_DMAC_REG_START_TRANSFER, &reg_val);
-	}
-	while(reg_val == 1);
 
-	/* Wait until the current transfer is completed. */
-	do {
-		adc_dma_read(AXI_DMAC_REG_IRQ_PENDING, &reg_val);
+	return adc_dma_wait_done(transfer_id);
+#else
+	return 0;
+#endif
+}
+
+/***************************************************************************//**
+ * @brief adc_capture_session_open
+ *
+ * Maps the whole RX buffer once, so the captures done through the session
+ * need no further open/mmap/munmap calls.
+*******************************************************************************/
+int32_t adc_capture_session_open(struct adc_capture_session *session)
+{
+#ifdef DMA_UIO
+	uint32_t page_mask, page_size;
+
+	if(session->mapping_addr)
+		return 0;
+
+	session->dev_mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
+	if(session->dev_mem_fd == -1)
+	{
+		printf("%s: Can't open /dev/mem device\n\r", __func__);
+		return -1;
 	}
-	while(reg_val != (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT));
-	adc_dma_write(AXI_DMAC_REG_IRQ_PENDING, reg_val);
 
-	/* Wait until the transfer with the ID transfer_id is completed. */
-	do {
-		adc_dma_read(AXI_DMAC_REG_TRANSFER_DONE, &reg_val);
+	page_size = sysconf(_SC_PAGESIZE);
+	page_mask = (page_size - 1);
+	session->mapping_length = (((rx_buff_mem_addr & page_mask) +
+				    rx_buff_mem_size + page_mask) & ~page_mask);
+	session->mapping_addr = mmap(NULL,
+				     session->mapping_length,
+				     PROT_READ | PROT_WRITE,
+				     MAP_SHARED,
+				     session->dev_mem_fd,
+				     (rx_buff_mem_addr & ~page_mask));
+	if(session->mapping_addr == MAP_FAILED)
+	{
+		printf("%s: mmap error\n\r", __func__);
+		session->mapping_addr = NULL;
+		close(session->dev_mem_fd);
+		return -1;
 	}
-	while((reg_val & (1 << transfer_id)) != (uint32_t)(1 << transfer_id));
+
+	session->buff = session->mapping_addr + (rx_buff_mem_addr & page_mask);
+	session->buff_size = rx_buff_mem_size;
+	session->length = 0;
+
+	return 0;
+#else
+	return -1;
 #endif
+}
+
+/***************************************************************************//**
+ * @brief adc_capture_session_run
+ *
+ * Captures size samples per channel and returns a view of the data in the
+ * mapped buffer. The view is valid until the next capture on the session.
+*******************************************************************************/
+int32_t adc_capture_session_run(struct adc_capture_session *session,
+				uint32_t size, void **data, uint32_t *length)
+{
+	int32_t ret;
+
+	if(!session->mapping_addr)
+		return -1;
+
+	ret = adc_capture(size, 0);
+	if(ret < 0)
+		return ret;
+
+	session->length = size * 4;
+	if(adc_st.rx2tx2)
+		session->length *= 2;
+#ifdef FMCOMMS5
+	session->length = size * 16;
+#endif
+
+	*data = session->buff;
+	*length = session->length;
 
 	return 0;
 }
 
+/***************************************************************************//**
+ * @brief adc_capture_session_close
+*******************************************************************************/
+void adc_capture_session_close(struct adc_capture_session *session)
+{
+	if(!session->mapping_addr)
+		return;
+
+	munmap(session->mapping_addr, session->mapping_length);
+	close(session->dev_mem_fd);
+	session->mapping_addr = NULL;
+	session->buff = NULL;
+}
+
 /***************************************************************************//**
  * @brief adc_save_file
+ *
+ * bin_file selects the format of the file, an adc_convert_format: Q,I text
+ * lines, the raw capture words or SigMF ci16_le data. The first ch_no
+ * channels are saved.
 *******************************************************************************/
 int32_t adc_capture_save_file(uint32_t size, uint32_t start_address,
 			  const char * filename, uint8_t bin_file,
 			  uint8_t ch_no)
 {
+	/* The capture always lands in the reserved RX buffer. */
+	(void)start_address;
 #ifdef DMA_UIO
-	int dev_mem_fd;
-	uint32_t mapping_length, page_mask, page_size;
-	void *mapping_addr, *rx_buff_virt_addr;
-	uint32_t index;
-	uint32_t data, data_i1, data_q1, data_i2, data_q2;
-	FILE *f;
-	uint32_t ch1, ch2;
+	struct adc_convert conv;
+	void *rx_buff_virt_addr;
 	uint32_t length;
+	FILE *f;
+	int32_t ret;
+
+	conv.words_per_frame = adc_st.rx2tx2 ? 2 : 1;
 #ifdef FMCOMMS5
-	uint32_t data_i3, data_q3, data_i4, data_q4;
-	uint32_t ch3, ch4;
+	conv.words_per_frame = 4;
 #endif
-
-	adc_capture(size, start_address);
-	start_address = rx_buff_mem_addr;
-
-	dev_mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
-	if(dev_mem_fd == -1)
+	if((ch_no == 0) || (ch_no > conv.words_per_frame))
 	{
-		printf("%s: Can't open /dev/mem device\n\r", __func__);
+		printf("%s: Invalid number of channels (%d).\n", __func__, ch_no);
 		return -1;
 	}
-
-	page_size = sysconf(_SC_PAGESIZE);
-	mapping_length = ((((size * 8) / page_size) + 1) * page_size);
-	page_mask = (page_size - 1);
-	mapping_addr = mmap(NULL,
-			   mapping_length,
-			   PROT_READ | PROT_WRITE,
-			   MAP_SHARED,
-			   dev_mem_fd,
-			   (start_address & ~page_mask));
-	if(mapping_addr == MAP_FAILED)
+	if(bin_file > ADC_CONVERT_SIGMF)
 	{
-		printf("%s: mmap error\n\r", __func__);
+		printf("%s: Invalid file format (%d).\n", __func__, bin_file);
 		return -1;
 	}
 
-	rx_buff_virt_addr = (mapping_addr + (start_address & page_mask));
+	if(adc_capture_session_open(&adc_default_session) < 0)
+		return -1;
+	if(adc_capture_session_run(&adc_default_session, size,
+				   &rx_buff_virt_addr, &length) < 0)
+		return -1;
 
 	if(bin_file)
 	{
@@ -346,119 +478,22 @@ int32_t adc_capture_save_file(uint32_t size, uint32_t start_address,
 	}
 	if(f == NULL)
 	{
-		munmap(mapping_addr, mapping_length);
-		close(dev_mem_fd);
 		return -1;
 	}
 
-	if(adc_st.rx2tx2)
-	{
-		length = (size * 2);
-	}
-	else
-	{
-		length = (size * 1);
-	}
+	conv.data = rx_buff_virt_addr;
+	conv.no_of_frames = length / (conv.words_per_frame * 4);
+	conv.no_of_channels = ch_no;
+	conv.format = bin_file;
 
-#ifdef FMCOMMS5
-	length = (size * 4);
-#endif
-
-#ifdef FMCOMMS5
-	for(index = 0; index < length; index += 4)
-	{
-		data = *((unsigned *) (rx_buff_virt_addr + (index * 4)));
-		data_q1 = (data & 0xFFFF);
-		data_i1 = (data >> 16) & 0xFFFF;
-		data = *((unsigned *) (rx_buff_virt_addr + ((index + 1) * 4)));
-		data_q2 = (data & 0xFFFF);
-		data_i2 = (data >> 16) & 0xFFFF;
-
-		data = *((unsigned *) (rx_buff_virt_addr + ((index + 2) * 4)));
-		data_q3 = (data & 0xFFFF);
-		data_i3 = (data >> 16) & 0xFFFF;
-		data = *((unsigned *) (rx_buff_virt_addr + ((index + 3) * 4)));
-		data_q4 = (data & 0xFFFF);
-		data_i4 = (data >> 16) & 0xFFFF;
-
-		if(bin_file)
-		{
-			ch1 = (data_i1 << 16) | data_q1;
-			fwrite(&ch1,1,4,f);
-			if(ch_no == 2)
-			{
-				ch2 = (data_i2 << 16) | data_q2;
-				fwrite(&ch2,1,4,f);
-			}
-			if(ch_no == 4)
-			{
-				ch2 = (data_i2 << 16) | data_q2;
-				fwrite(&ch2,1,4,f);
-				ch3 = (data_i3 << 16) | data_q3;
-				fwrite(&ch3,1,4,f);
-				ch4 = (data_i4 << 16) | data_q4;
-				fwrite(&ch4,1,4,f);
-			}
-		}
-		else
-		{
-			if(ch_no == 4)
-			{
-				fprintf(f, "%d,%d,%d,%d,%d,%d,%d,%d\n", data_q1, data_i1,
-					data_q2, data_i2, data_q3, data_i3, data_q4, data_i4);
-			}
-			else
-			{
-				if(ch_no == 2)
-				{
-					fprintf(f, "%d,%d,%d,%d\n", data_q1, data_i1, data_q2, data_i2);
-				}
-				else
-				{
-					fprintf(f, "%d,%d\n", data_q1, data_i1);
-				}
-			}
-		}
-	}
-#else
-	for(index = 0; index < length; index += 2)
-	{
-		data = *((unsigned *) (rx_buff_virt_addr + (index * 4)));
-		data_q1 = (data & 0xFFFF);
-		data_i1 = (data >> 16) & 0xFFFF;
-		data = *((unsigned *) (rx_buff_virt_addr + ((index + 1) * 4)));
-		data_q2 = (data & 0xFFFF);
-		data_i2 = (data >> 16) & 0xFFFF;
-		if(bin_file)
-		{
-			ch1 = (data_i1 << 16) | data_q1;
-			fwrite(&ch1,1,4,f);
-			if(ch_no == 2)
-			{
-				ch2 = (data_i2 << 16) | data_q2;
-				fwrite(&ch2,1,4,f);
-			}
-		}
-		else
-		{
-			if(ch_no == 2)
-			{
-				fprintf(f, "%d,%d,%d,%d\n", data_q1, data_i1, data_q2, data_i2);
-			}
-			else
-			{
-				fprintf(f, "%d,%d\n", data_q1, data_i1);
-			}
-		}
-	}
-#endif
+	ret = adc_convert_write(&conv, f);
 
 	fclose(f);
-	munmap(mapping_addr, mapping_length);
-	close(dev_mem_fd);
-#endif
 
+	return ret;
+#else
 	return 0;
+#endif
 }
 
 /***************************************************************************//**
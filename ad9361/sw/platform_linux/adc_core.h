@@ -143,11 +143,23 @@
 #define AXI_DMAC_IRQ_SOT				(1 << 0)
 #define AXI_DMAC_IRQ_EOT				(1 << 1)
 
+#define ADC_DMA_TIMEOUT_MS				10000
+
 struct adc_state
 {
 	bool rx2tx2;
 };
 
+struct adc_capture_session
+{
+	int dev_mem_fd;
+	void *mapping_addr;
+	uint32_t mapping_length;
+	void *buff;
+	uint32_t buff_size;
+	uint32_t length;
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -158,6 +170,10 @@ void adc_write(struct ad9361_rf_phy *phy, uint32_t regAddr, uint32_t data);
 int32_t adc_capture_save_file(uint32_t size, uint32_t start_address,
 			  const char * filename, uint8_t bin_file,
 			  uint8_t ch_no);
+int32_t adc_capture_session_open(struct adc_capture_session *session);
+int32_t adc_capture_session_run(struct adc_capture_session *session,
+				uint32_t size, void **data, uint32_t *length);
+void adc_capture_session_close(struct adc_capture_session *session);
 int32_t get_file_info(const char *filename, uint32_t *info);
 int32_t adc_set_calib_scale(struct ad9361_rf_phy *phy,
 							uint32_t chan,
@@ -51,7 +51,9 @@
 #include <errno.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <string.h>
 #include <sys/mman.h>
+#include <pthread.h>
 #include <linux/types.h>
 #include <linux/spi/spidev.h>
 
@@ -62,6 +64,7 @@ int spidev_fd;
 #ifdef FMCOMMS5
 int spidev_b_fd;
 #endif
+pthread_mutex_t axiadc_init_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /***************************************************************************//**
  * @brief spi_init
@@ -181,6 +184,49 @@ int spi_write_then_read(struct spi_device *spi,
 	return ret;
 }
 
+/***************************************************************************//**
+ * @brief spi_write_batch
+ *
+ * Sends n_xfers write-only transfers with a single SPI_IOC_MESSAGE ioctl.
+ * The chip select is released between the transfers.
+*******************************************************************************/
+int spi_write_batch(struct spi_device *spi,
+		const unsigned char *txbuf, const unsigned char *xfer_len,
+		unsigned n_xfers)
+{
+	struct spi_ioc_transfer tr[SPI_BATCH_MAX_XFERS];
+	unsigned i;
+	int fd = spidev_fd;
+	int ret;
+
+	if (n_xfers > SPI_BATCH_MAX_XFERS)
+		return -EINVAL;
+
+	memset(tr, 0, sizeof(tr));
+	for (i = 0; i < n_xfers; i++) {
+		tr[i].tx_buf = (unsigned long)txbuf;
+		tr[i].len = xfer_len[i];
+		tr[i].cs_change = (i != (n_xfers - 1));
+		txbuf += xfer_len[i];
+	}
+
+#ifdef FMCOMMS5
+	if (spi->id_no)
+		fd = spidev_b_fd;
+#else
+	if (spi->id_no)
+		return -ENODEV;
+#endif
+
+	ret = ioctl(fd, SPI_IOC_MESSAGE(n_xfers), tr);
+	if (ret < 0) {
+		printf("%s: Can't send spi message\n\r", __func__);
+		return -EIO;
+	}
+
+	return 0;
+}
+
 /***************************************************************************//**
  * @brief gpio_init
 *******************************************************************************/
@@ -310,8 +356,11 @@ unsigned long msleep_interruptible(unsigned int msecs)
 *******************************************************************************/
 void axiadc_init(struct ad9361_rf_phy *phy)
 {
+	/* The UIO mappings are shared by the devices initialized in parallel */
+	pthread_mutex_lock(&axiadc_init_lock);
 	adc_init(phy);
 	dac_init(phy, DATA_SEL_DDS, 0);
+	pthread_mutex_unlock(&axiadc_init_lock);
 }
 
 /***************************************************************************//**
@@ -90,6 +90,8 @@ struct device {
 struct spi_device {
 	struct device	dev;
 	uint8_t 		id_no;
+	struct spi_batch	*batch;
+	struct ad9361_reg_shadow	*shadow;
 };
 
 struct axiadc_state {
@@ -0,0 +1,159 @@
+/***************************************************************************//**
+ *   @file   fw_compress.c
+ *   @brief  Host tool generating the compressed ARM firmware header.
+ *
+ *   gcc -O2 -o fw_compress fw_compress.c
+ *   ./fw_compress Mykonos_M3.bin > ../sw/Mykonos_M3_lz.h
+********************************************************************************
+ * Copyright 2017(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* must match ad9371/sw/arm_fw.h */
+#define WINDOW_SIZE		4096
+#define MIN_MATCH		3
+#define EXT_MATCH		18
+#define MAX_MATCH		(EXT_MATCH + 255)
+
+/***************************************************************************//**
+ * @brief longest match for in[pos] within the window
+*******************************************************************************/
+static uint32_t find_match(const uint8_t *in, uint32_t len, uint32_t pos,
+						   uint32_t *offset)
+{
+	uint32_t best = 0;
+	uint32_t off;
+	uint32_t n;
+
+	for (off = 1; (off <= WINDOW_SIZE) && (off <= pos); off++) {
+		for (n = 0; (n < MAX_MATCH) && (pos + n < len) &&
+				(in[pos + n] == in[pos + n - off]); n++);
+		if (n > best) {
+			best = n;
+			*offset = off;
+			if (n == MAX_MATCH)
+				break;
+		}
+	}
+
+	return best;
+}
+
+/***************************************************************************//**
+ * @brief main
+*******************************************************************************/
+int main(int argc, char **argv)
+{
+	FILE *f;
+	uint8_t *in;
+	uint8_t *out;
+	uint32_t in_len;
+	uint32_t out_len = 0;
+	uint32_t flag_pos = 0;
+	uint32_t items = 8;
+	uint32_t pos = 0;
+	uint32_t match;
+	uint32_t offset = 0;
+	uint32_t i;
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s Mykonos_M3.bin\n", argv[0]);
+		return 1;
+	}
+
+	f = fopen(argv[1], "rb");
+	if (f == NULL) {
+		perror(argv[1]);
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	in_len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	in = malloc(in_len);
+	out = malloc(in_len + in_len / 8 + 1);
+	if ((in == NULL) || (out == NULL) ||
+			(fread(in, 1, in_len, f) != in_len)) {
+		fprintf(stderr, "%s: read failed\n", argv[1]);
+		return 1;
+	}
+	fclose(f);
+
+	while (pos < in_len) {
+		if (items == 8) {
+			flag_pos = out_len++;
+			out[flag_pos] = 0;
+			items = 0;
+		}
+		match = find_match(in, in_len, pos, &offset);
+		if (match >= MIN_MATCH) {
+			out[out_len++] = (offset - 1) & 0xFF;
+			if (match >= EXT_MATCH) {
+				out[out_len++] = (((offset - 1) >> 4) & 0xF0) | 0x0F;
+				out[out_len++] = match - EXT_MATCH;
+			} else {
+				out[out_len++] = (((offset - 1) >> 4) & 0xF0) |
+								 (match - MIN_MATCH);
+			}
+			pos += match;
+		} else {
+			out[flag_pos] |= 1 << items;
+			out[out_len++] = in[pos++];
+		}
+		items++;
+	}
+
+	printf("// Generated by scripts/fw_compress.c from %s, do not edit\n\n",
+		   argv[1]);
+	printf("const unsigned char firmware_Mykonos_M3_lz[] = {");
+	for (i = 0; i < out_len; i++)
+		printf("%s0x%02x%s", (i % 12) ? " " : "\n  ", out[i],
+			   (i + 1 < out_len) ? "," : "");
+	printf("\n};\n");
+	printf("const unsigned int firmware_Mykonos_M3_lz_len = %u;\n", out_len);
+	printf("const unsigned int firmware_Mykonos_M3_bin_len = %u;\n", in_len);
+
+	free(in);
+	free(out);
+
+	return 0;
+}
@@ -0,0 +1,7325 @@
+// Generated by scripts/fw_compress.c from Mykonos_M3.bin, do not edit
+
+const unsigned char firmware_Mykonos_M3_lz[] = {
+  0xff, 0x88, 0xbc, 0x00, 0x20, 0x95, 0x6a, 0x01, 0x01, 0xab, 0x51, 0x66,
+  0x03, 0x0f, 0x00, 0x00, 0x00, 0x0c, 0x55, 0x27, 0x00, 0x57, 0x7c, 0x03,
+  0x00, 0x0b, 0x01, 0x73, 0x7a, 0x00, 0x01, 0x09, 0x03, 0x00, 0xfd, 0x59,
+  0x0f, 0x00, 0xb3, 0x8b, 0x00, 0x01, 0x87, 0xeb, 0x7f, 0x00, 0x01, 0x71,
+  0x52, 0x00, 0x01, 0x5b, 0x0f, 0x00, 0x5f, 0x69, 0x69, 0x00, 0x01, 0x79,
+  0x03, 0x00, 0x89, 0x03, 0x00, 0xfd, 0xb5, 0x03, 0x00, 0xdf, 0xfc, 0x00,
+  0x01, 0xe3, 0x8c, 0xff, 0x00, 0x01, 0x1f, 0x8e, 0x00, 0x01, 0x9f, 0x8d,
+  0xf7, 0x00, 0x01, 0xc7, 0x07, 0x00, 0xff, 0x32, 0x00, 0x01, 0xdf, 0xd1,
+  0xf0, 0x00, 0x01, 0xaf, 0x17, 0x00, 0x1b, 0xf2, 0xf7, 0x00, 0x01, 0x5d,
+  0x37, 0x00, 0x4b, 0x5f, 0x00, 0x01, 0x55, 0x5f, 0x07, 0x00, 0x61, 0x03,
+  0x00, 0x63, 0x03, 0x00, 0x65, 0x03, 0x00, 0x7d, 0x67, 0x03, 0x00, 0xf1,
+  0xf3, 0x00, 0x01, 0x69, 0x07, 0x00, 0x7d, 0x6b, 0x03, 0x00, 0x33, 0xfd,
+  0x00, 0x01, 0x2f, 0x43, 0x00, 0xfd, 0x5b, 0x43, 0x00, 0x41, 0x8f, 0x00,
+  0x01, 0x99, 0x9d, 0x37, 0x00, 0x01, 0xb1, 0x3f, 0x00, 0xcd, 0xf1, 0x53,
+  0x00, 0x03, 0x00, 0x55, 0x6d, 0x23, 0x00, 0x6f, 0x03, 0x00, 0x71, 0x03,
+  0x00, 0x73, 0x03, 0x00, 0x55, 0x75, 0x03, 0x00, 0x77, 0x03, 0x00, 0x79,
+  0x03, 0x00, 0x7b, 0x03, 0x00, 0xd5, 0x7d, 0x03, 0x00, 0x7f, 0x03, 0x00,
+  0x81, 0x03, 0x00, 0xd3, 0x82, 0x57, 0x00, 0x01, 0x83, 0x07, 0x00, 0xb7,
+  0x07, 0x00, 0x85, 0x07, 0x00, 0x55, 0x87, 0x03, 0x00, 0x89, 0x03, 0x00,
+  0x8b, 0x03, 0x00, 0x8d, 0x03, 0x00, 0xd5, 0x8f, 0x03, 0x00, 0x91, 0x03,
+  0x00, 0x93, 0x03, 0x00, 0xb5, 0xc3, 0xf7, 0x00, 0x00, 0x10, 0xf7, 0x00,
+  0xf7, 0x14, 0x00, 0x00, 0x9f, 0x74, 0x72, 0x75, 0x6e, 0x6b, 0x1c, 0x1d,
+  0x00, 0x04, 0xe8, 0xff, 0xb7, 0x00, 0x20, 0xb8, 0x82, 0x00, 0x20, 0xf8,
+  0xef, 0xf1, 0x00, 0x20, 0x08, 0x03, 0x00, 0x74, 0x29, 0x00, 0x9f, 0x20,
+  0xa0, 0x2b, 0x00, 0x20, 0x1b, 0x01, 0x50, 0x15, 0x8c, 0xff, 0x09, 0x00,
+  0x20, 0xe8, 0xb2, 0x00, 0x20, 0x90, 0xfd, 0xb4, 0x17, 0x01, 0x70, 0x47,
+  0x44, 0xbd, 0x00, 0x20, 0xed, 0x30, 0x0f, 0x00, 0xd8, 0xb3, 0x3b, 0x00,
+  0x00, 0xff, 0xff, 0xff, 0xef, 0xf3, 0x11, 0x80, 0x60, 0x21, 0x81, 0xf3,
+  0xff, 0x11, 0x88, 0x70, 0x47, 0x38, 0xb5, 0x14, 0x46, 0xff, 0x00, 0x22,
+  0x82, 0x70, 0x00, 0xf1, 0x4c, 0x05, 0xff, 0xdf, 0xf8, 0x14, 0x29, 0x82,
+  0x61, 0x00, 0x22, 0xff, 0xc2, 0x61, 0x02, 0x62, 0x02, 0x80, 0x82, 0x81,
+  0xff, 0x01, 0x22, 0xc2, 0x81, 0x02, 0x82, 0x42, 0x82, 0xff, 0x00, 0x22,
+  0xa0, 0xf8, 0x18, 0x22, 0x40, 0x22, 0xff, 0xea, 0x83, 0x2a, 0x84, 0x00,
+  0x22, 0x6a, 0x85, 0xff, 0x2a, 0x80, 0xaa, 0x61, 0x41, 0xb1, 0x4f, 0xf0,
+  0xff, 0x00, 0x41, 0x41, 0x61, 0x4f, 0xf0, 0xff, 0x31, 0xff, 0x01, 0x81,
+  0x41, 0x81, 0x81, 0x80, 0xc1, 0x80, 0xff, 0x01, 0xf0, 0x82, 0xf8, 0xdf,
+  0xf8, 0xd4, 0x08, 0xff, 0x34, 0xb9, 0x41, 0x78, 0x02, 0x78, 0x42, 0xea,
+  0xff, 0x01, 0x21, 0xc2, 0x78, 0x80, 0x78, 0x05, 0xe0, 0xef, 0x41, 0x79,
+  0x02, 0x79, 0x0d, 0x02, 0x79, 0x80, 0x79, 0xff, 0x09, 0xb2, 0x40, 0xea,
+  0x02, 0x20, 0xb1, 0xf5, 0xff, 0x00, 0x5f, 0xa8, 0xbf, 0xa1, 0xf5, 0x80,
+  0x41, 0xf7, 0x00, 0xb2, 0xb0, 0x0b, 0x02, 0xa0, 0xf5, 0x80, 0x40, 0xff,
+  0x69, 0x84, 0xa8, 0x84, 0x01, 0xf0, 0x96, 0xfd, 0xff, 0xdf, 0xf8, 0x94,
+  0x08, 0x34, 0x21, 0x01, 0xfb, 0xff, 0x04, 0x04, 0x20, 0x46, 0x02, 0xf0,
+  0xb0, 0xfe, 0xff, 0x64, 0x20, 0x60, 0x60, 0xbd, 0xe8, 0x31, 0x40, 0xff,
+  0x01, 0xf0, 0x9d, 0xbd, 0x2d, 0xe9, 0xf0, 0x41, 0xff, 0x04, 0x46, 0x0e,
+  0x46, 0x15, 0x46, 0xff, 0xf7, 0xff, 0x9b, 0xff, 0x00, 0x27, 0x80, 0x46,
+  0xe1, 0x5f, 0xff, 0x70, 0x1e, 0x81, 0x42, 0xbc, 0xbf, 0x72, 0x42, 0xff,
+  0x8a, 0x42, 0x05, 0xda, 0xb4, 0xf9, 0x02, 0x10, 0xff, 0x81, 0x42, 0xb8,
+  0xbf, 0x8a, 0x42, 0x02, 0xdb, 0xff, 0x27, 0x80, 0x67, 0x80, 0x01, 0x27,
+  0xb4, 0xf9, 0xfe, 0x12, 0x10, 0x12, 0x00, 0xf0, 0x3f, 0x01, 0xa5, 0xb9,
+  0xff, 0x40, 0xf6, 0x15, 0x20, 0x02, 0xf0, 0xc5, 0xfe, 0x7f, 0x20, 0x88,
+  0xc1, 0xb2, 0x40, 0xf6, 0x14, 0x0b, 0x00, 0xff, 0xbf, 0xfe, 0x00, 0xf0,
+  0x2b, 0xf8, 0x40, 0xf6, 0xdd, 0x17, 0x0b, 0x00, 0xb9, 0xfe, 0x60, 0x17,
+  0x02, 0x16, 0x20, 0x5f, 0x13, 0xe0, 0x40, 0xf6, 0x19, 0x11, 0x00, 0xb0,
+  0x29, 0x04, 0x55, 0x18, 0x0b, 0x00, 0xaa, 0x29, 0x00, 0x16, 0x29, 0x00,
+  0x1b, 0x0b, 0x00, 0xf5, 0xa4, 0x29, 0x04, 0x1a, 0x0b, 0x00, 0x9e, 0xfe,
+  0x01, 0x20, 0xeb, 0xa8, 0x40, 0x0d, 0x01, 0x1c, 0x0d, 0x00, 0x97, 0xfe,
+  0x88, 0x7e, 0x57, 0x10, 0x38, 0x46, 0xbd, 0xe8, 0xf0, 0x81, 0x8b, 0x00,
+  0xfe, 0x79, 0x04, 0x70, 0x47, 0x2d, 0xe9, 0xf8, 0x4f, 0x80, 0xff, 0x46,
+  0xdf, 0xf8, 0x0c, 0x0e, 0x4f, 0xf4, 0x08, 0xff, 0x71, 0x01, 0xfb, 0x08,
+  0x0a, 0xff, 0xf7, 0x3b, 0xff, 0xff, 0x83, 0x46, 0x40, 0x46, 0x0a, 0xf1,
+  0x6a, 0xff, 0x05, 0x02, 0xf0, 0xe3, 0xff, 0x2a, 0x88, 0xdf, 0xff, 0xf8,
+  0xf0, 0x1d, 0x40, 0x56, 0x56, 0x56, 0x00, 0xff, 0x24, 0x81, 0x1b, 0x04,
+  0xd4, 0xb1, 0x46, 0x06, 0xff, 0x46, 0x04, 0xd0, 0x01, 0x21, 0x02, 0xe0,
+  0x81, 0xfd, 0x46, 0x65, 0x11, 0x40, 0x2a, 0x1f, 0xd0, 0x01, 0x24, 0xff,
+  0x00, 0x29, 0x4c, 0xbf, 0x1f, 0xfa, 0x89, 0xf7, 0xff, 0xb7, 0xb2, 0xda,
+  0xe9, 0x82, 0x01, 0x3a, 0x46, 0xff, 0x03, 0xf0, 0x64, 0xf8, 0xc0, 0x07,
+  0x18, 0xd5, 0xff, 0x0a, 0xeb, 0xc7, 0x00, 0xb1, 0x45, 0xc1, 0x6f, 0xff,
+  0x04, 0xd0, 0x80, 0x6f, 0x40, 0x11, 0xa8, 0x80, 0xdf, 0x48, 0x11, 0xe8,
+  0x80, 0x42, 0x6f, 0x00, 0xd8, 0x0d, 0xff, 0xb0, 0xf9, 0x24, 0x10, 0x0a,
+  0xf1, 0x6e, 0x00, 0x7f, 0xff, 0xf7, 0x61, 0xff, 0xac, 0x81, 0x8b, 0x9d,
+  0x00, 0xff, 0x00, 0x20, 0xbd, 0xe8, 0xf2, 0x8f, 0x00, 0x24, 0xff, 0xf7,
+  0xe7, 0xf8, 0xb5, 0x04, 0x46, 0x0d, 0x46, 0xff, 0x26, 0x68, 0x60, 0x68,
+  0xb6, 0xf9, 0x34, 0xc0, 0xff, 0x03, 0xeb, 0x02, 0x17, 0x81, 0x1c, 0x67,
+  0x44, 0xff, 0x3f, 0x11, 0xcf, 0x80, 0xb7, 0x8e, 0x4a, 0x80, 0xff, 0xff,
+  0x18, 0xb1, 0xf9, 0x0a, 0x20, 0x8b, 0x80, 0xff, 0x07, 0xf0, 0x0f, 0x07,
+  0x0f, 0x81, 0x00, 0x2a, 0xff, 0x14, 0xbf, 0x02, 0x22, 0x01, 0x22, 0xb1,
+  0xf9, 0xff, 0x0c, 0x70, 0x13, 0x46, 0x1f, 0xb1, 0x37, 0x69, 0xff, 0xe7,
+  0x61, 0x01, 0x27, 0x08, 0xe0, 0x02, 0x2b, 0xf7, 0x03, 0xd1, 0x77, 0x0b,
+  0x00, 0x37, 0x8c, 0x02, 0xe0, 0xfd, 0xb7, 0x07, 0x00, 0x77, 0x8c, 0x27,
+  0x84, 0xb1, 0xf9, 0xff, 0x0e, 0x70, 0x00, 0x2f, 0x01, 0xbf, 0xb1, 0xf9,
+  0xfd, 0x10, 0x07, 0x00, 0x0f, 0x78, 0xba, 0x42, 0x24, 0xd0, 0xff, 0x00,
+  0xf1, 0x18, 0x07, 0xdf, 0xf8, 0xb4, 0xc6, 0xef, 0xc7, 0xf8, 0x00, 0xc0,
+  0x3b, 0x20, 0x0c, 0xc7, 0xf8, 0xff, 0x04, 0xc0, 0xc7, 0xf8, 0x08, 0xc0,
+  0xb4, 0xf8, 0x5f, 0x12, 0xc0, 0xa4, 0xf8, 0x16, 0x13, 0x02, 0xa0, 0x1b,
+  0x00, 0xff, 0xa1, 0xf8, 0x0e, 0xc0, 0x0a, 0x70, 0xc7, 0xf8, 0xff, 0x4c,
+  0xc0, 0x32, 0x69, 0xe2, 0x61, 0x01, 0x22, 0xfd, 0x22, 0x4d, 0x00, 0x0c,
+  0x20, 0x00, 0x2a, 0x1a, 0xbf, 0xff, 0x01, 0x2b, 0x08, 0x22, 0x20, 0x22,
+  0xba, 0x86, 0xfe, 0x55, 0x00, 0x10, 0x21, 0xb1, 0x00, 0xf0, 0x4b, 0xff,
+  0xff, 0x61, 0x68, 0x00, 0x20, 0x48, 0x82, 0x25, 0x81, 0xfd, 0xf1, 0x17,
+  0x20, 0xf9, 0x4f, 0x97, 0xb0, 0x00, 0x20, 0xff, 0x0c, 0x46, 0x01, 0x90,
+  0xe0, 0x8a, 0x17, 0x99, 0xff, 0x40, 0x08, 0x02, 0x90, 0x01, 0x20, 0x88,
+  0x40, 0xff, 0x11, 0x90, 0x00, 0x21, 0x00, 0x20, 0x03, 0xf0, 0xff, 0x20,
+  0xf8, 0x11, 0x98, 0x02, 0xf0, 0x32, 0xfe, 0xff, 0x00, 0x25, 0x30, 0xb9,
+  0x04, 0xf0, 0x99, 0xf8, 0xff, 0x18, 0xb9, 0x03, 0xf0, 0x73, 0xf8, 0x02,
+  0x20, 0xff, 0x0c, 0xe3, 0x00, 0xf0, 0x26, 0xfb, 0x02, 0xf0, 0xfd, 0xec,
+  0x75, 0x20, 0x34, 0x0e, 0x00, 0x68, 0x60, 0x62, 0x7f, 0x04, 0xf1, 0x28,
+  0x00, 0x04, 0xf0, 0xb6, 0xed, 0x10, 0xff, 0x81, 0xff, 0x00, 0x28, 0x04,
+  0xf1, 0x2c, 0x00, 0xff, 0x02, 0xd0, 0x04, 0xf0, 0xe6, 0xff, 0x01, 0xe0,
+  0xff, 0x05, 0xf0, 0x53, 0xfa, 0x17, 0x99, 0x20, 0x46, 0xfe, 0x07, 0x20,
+  0xff, 0x06, 0x46, 0x60, 0x68, 0xb0, 0xf9, 0xff, 0x0c, 0x10, 0x00, 0x29,
+  0x17, 0x99, 0x14, 0xbf, 0xff, 0xb0, 0xf9, 0x08, 0x00, 0xb0, 0xf9, 0x04,
+  0x00, 0xcf, 0x00, 0x29, 0x14, 0xbf, 0xc5, 0x11, 0x03, 0x01, 0x09, 0x68,
+  0xff, 0xc9, 0x07, 0x05, 0xd5, 0x01, 0x21, 0xc0, 0x1d, 0xff, 0x80, 0x28,
+  0x02, 0xd3, 0x7f, 0x20, 0x00, 0xe0, 0xef, 0x00, 0x21, 0x17, 0x9a, 0x91,
+  0x10, 0x3d, 0x00, 0x04, 0xff, 0x00, 0xf4, 0xfe, 0x00, 0x40, 0xea, 0x82,
+  0x70, 0xff, 0x40, 0xea, 0xc1, 0x32, 0x1a, 0x43, 0x16, 0x92, 0xdf, 0x00,
+  0x27, 0x22, 0x8b, 0xd2, 0x05, 0x20, 0x7e, 0x52, 0xfb, 0x10, 0x43, 0x13,
+  0x00, 0x30, 0xdf, 0xf8, 0xb8, 0x1d, 0xff, 0x08, 0x43, 0x10, 0x90, 0x10,
+  0x98, 0x05, 0xf0, 0xff, 0x2b, 0xfb, 0x20, 0x68, 0xc0, 0x8e, 0x41, 0x42,
+  0xff, 0x09, 0xb2, 0x00, 0xb2, 0x05, 0xf0, 0x91, 0xfd, 0xfe, 0x77, 0x01,
+  0x0e, 0x10, 0x39, 0xb1, 0xdf, 0xf8, 0x84, 0xff, 0x2d, 0x4f, 0xf4, 0x88,
+  0x71, 0xd1, 0x61, 0x11, 0xff, 0x62, 0x4f, 0xf4, 0x84, 0x77, 0x61, 0x6a,
+  0xdf, 0xff, 0xf8, 0x70, 0x2d, 0x39, 0x43, 0x41, 0xf0, 0x02, 0xff, 0x01,
+  0x11, 0x60, 0xd0, 0xf8, 0x6e, 0x00, 0x03, 0xff, 0x90, 0x17, 0x98, 0x06,
+  0xf0, 0x4e, 0xf8, 0x04, 0xfd, 0xe0, 0x31, 0x20, 0xf8, 0x01, 0x98, 0x40,
+  0x1c, 0x01, 0xff, 0x90, 0x02, 0x98, 0x01, 0x99, 0x88, 0x42, 0xc0, 0xff,
+  0xf2, 0x66, 0x82, 0x00, 0x2d, 0x08, 0xbf, 0x00, 0xff, 0x2e, 0x40, 0xf0,
+  0x61, 0x82, 0x08, 0x46, 0x02, 0xfe, 0x13, 0x00, 0x08, 0xbf, 0x4f, 0xf0,
+  0x01, 0x0a, 0x1c, 0xdf, 0xd0, 0x00, 0xf0, 0x05, 0xff, 0x8b, 0x10, 0x0a,
+  0x20, 0xe7, 0xb9, 0x17, 0x98, 0xbd, 0x00, 0x73, 0x00, 0xf8, 0xf9, 0x20,
+  0xff, 0x68, 0x80, 0x8f, 0x06, 0xf0, 0x5b, 0xf9, 0x05, 0xff, 0xf0, 0x9a,
+  0xfa, 0x01, 0x98, 0x17, 0x9a, 0x64, 0xff, 0x21, 0x48, 0x43, 0x02, 0x99,
+  0x90, 0xfb, 0xf1, 0xff, 0xf0, 0xdf, 0xf8, 0xe8, 0x14, 0x34, 0x23, 0x03,
+  0xff, 0xfb, 0x02, 0x11, 0x48, 0x60, 0x01, 0x98, 0x01, 0xff, 0x28, 0x2d,
+  0xdb, 0xdd, 0xe9, 0x08, 0x01, 0x06, 0xff, 0xf0, 0xe5, 0xf9, 0x0f, 0x90,
+  0xdd, 0xe9, 0x06, 0xfe, 0x09, 0x00, 0xe0, 0xf9, 0xb8, 0xf1, 0x00, 0x0f,
+  0x0e, 0xff, 0x90, 0x20, 0xd1, 0x60, 0x68, 0xdd, 0xe9, 0x14, 0xff, 0x23,
+  0xd0, 0xe9, 0x0a, 0x71, 0xba, 0x18, 0x4b, 0xef, 0x41, 0xc0, 0xe9, 0x0a,
+  0x0b, 0x00, 0x0c, 0x71, 0xdd, 0x57, 0xe9, 0x12, 0x23, 0x0f, 0x03, 0x0c,
+  0x0f, 0x00, 0x0e, 0x0f, 0x00, 0x55, 0x08, 0x0f, 0x04, 0x0e, 0x0f, 0x00,
+  0x10, 0x0f, 0x00, 0x06, 0x0f, 0x04, 0xf7, 0x10, 0x23, 0x17, 0xc3, 0x10,
+  0x4e, 0xfe, 0xdf, 0xf8, 0xff, 0xc8, 0x2a, 0xdf, 0xf8, 0x48, 0x1d, 0x80,
+  0x56, 0xff, 0x31, 0xf8, 0x10, 0x00, 0x06, 0xf0, 0xeb, 0xf9, 0xff, 0xdf,
+  0xf8, 0x40, 0x1d, 0x06, 0xf0, 0xf7, 0xf9, 0xdf, 0x00, 0xf0, 0x6d, 0xfd,
+  0xba, 0x6d, 0x00, 0x0d, 0x90, 0xff, 0x39, 0xd1, 0x05, 0xf0, 0x5e, 0xfa,
+  0x02, 0x28, 0xff, 0x0c, 0xbf, 0x06, 0x26, 0x01, 0x28, 0x00, 0xd1, 0xff,
+  0x01, 0x25, 0xdf, 0xf8, 0x20, 0x2d, 0xd2, 0xe9, 0x7e, 0xc9, 0x50, 0xe9,
+  0x14, 0x01, 0xd2, 0xe9, 0x02, 0x07, 0x00, 0x55, 0x12, 0x07, 0x00, 0x04,
+  0x07, 0x00, 0x08, 0x07, 0x00, 0x06, 0x07, 0x00, 0x5b, 0x06, 0x01, 0xd3,
+  0x12, 0x00, 0xb0, 0xf9, 0x00, 0x00, 0xf9, 0x02, 0xfb, 0x7b, 0xf9, 0xcd,
+  0x01, 0x40, 0x42, 0x61, 0xeb, 0x41, 0xd8, 0x27, 0x02, 0xd1, 0x01, 0x0d,
+  0x05, 0x06, 0x01, 0x15, 0x13, 0xd0, 0xf8, 0x77, 0x00, 0x2d, 0x04, 0x49,
+  0x10, 0x05, 0xf0, 0x0c, 0x1b, 0x10, 0xff, 0x02, 0x28, 0xc0, 0xf2, 0xcc,
+  0x80, 0x0f, 0x98, 0xff, 0x00, 0x99, 0x06, 0xf0, 0x2d, 0xfa, 0x0c, 0x90,
+  0xf7, 0x59, 0x46, 0x0e, 0x83, 0x10, 0x28, 0xfa, 0x0b, 0x90, 0xff, 0xbd,
+  0xf9, 0x14, 0x10, 0xbd, 0xf9, 0x10, 0x00, 0xff, 0x40, 0x1a, 0x06, 0xf0,
+  0x88, 0xf9, 0x07, 0x46, 0xff, 0xbd, 0xf9, 0x12, 0x00, 0xbd, 0xf9, 0x16,
+  0x10, 0xfa, 0x0f, 0x01, 0x80, 0xb9, 0x00, 0x1c, 0xfd, 0x83, 0x46, 0x48,
+  0xfe, 0x5b, 0x20, 0xfc, 0xfc, 0x59, 0x46, 0x06, 0xf0, 0x83, 0xff, 0xfa,
+  0x06, 0xf0, 0xc3, 0xfa, 0x00, 0x21, 0x06, 0xff, 0xf0, 0xfa, 0xfa, 0x83,
+  0x46, 0x1d, 0xd0, 0x20, 0xff, 0x68, 0x30, 0xf8, 0x42, 0x1f, 0x81, 0xb1,
+  0x61, 0xff, 0x68, 0x4c, 0x31, 0x00, 0x91, 0x40, 0x88, 0x06, 0xff, 0xf0,
+  0x70, 0xf9, 0x01, 0x46, 0x00, 0x98, 0x80, 0xfd, 0x69, 0xf7, 0x00, 0xfa,
+  0x04, 0xd3, 0x00, 0x98, 0x00, 0xdb, 0x88, 0x08, 0x7b, 0x00, 0x90, 0x80,
+  0xe7, 0x21, 0xbe, 0xfc, 0x5f, 0x00, 0x28, 0x03, 0xd0, 0x04, 0x8f, 0x40,
+  0xab, 0x09, 0x00, 0xff, 0x00, 0xf0, 0x85, 0x80, 0x0c, 0x98, 0x00, 0xf0,
+  0x7f, 0xd6, 0xfc, 0x00, 0x90, 0x49, 0x46, 0x0b, 0x8f, 0x00, 0xdb, 0xf0,
+  0xfa, 0x9f, 0x01, 0x51, 0xfa, 0x69, 0x01, 0x5c, 0xf9, 0xf7, 0x00, 0x90,
+  0x39, 0x15, 0x02, 0xe5, 0xfa, 0x07, 0x46, 0xbe, 0x27, 0x01, 0xbb, 0xfc,
+  0x01, 0x46, 0x38, 0x19, 0x00, 0xcd, 0xfd, 0xf9, 0x1f, 0x01, 0x4c, 0xf9,
+  0x0a, 0x90, 0x4f, 0xf0, 0xd7, 0x7e, 0x50, 0x18, 0x31, 0x00, 0xc4, 0xcb,
+  0x12, 0x81, 0x46, 0xff, 0x5c, 0xd1, 0x67, 0x68, 0x00, 0xf0, 0xa6, 0xfc,
+  0xdd, 0x0d, 0x13, 0x00, 0xca, 0xfa, 0xb9, 0x83, 0x00, 0x2b, 0xfa, 0xf7,
+  0xb8, 0x61, 0x49, 0x8f, 0x00, 0x06, 0xf0, 0xc2, 0xfa, 0x5d, 0xf9, 0x0f,
+  0x00, 0x23, 0xfa, 0xf8, 0x0f, 0x00, 0x0a, 0x0f, 0x00, 0xff, 0xba, 0xfa,
+  0x39, 0x6a, 0x06, 0xf0, 0x1b, 0xfa, 0xfb, 0x38, 0x62, 0x45, 0x00, 0x51,
+  0x38, 0x6d, 0x06, 0xf0, 0x7f, 0x15, 0xfa, 0x38, 0x65, 0x59, 0x46, 0x0d,
+  0x1b, 0x00, 0xd7, 0xac, 0xfa, 0x81, 0x33, 0x00, 0x49, 0x65, 0x00, 0x19,
+  0xf9, 0x97, 0x79, 0x6d, 0x83, 0x07, 0x00, 0x93, 0x8d, 0x01, 0x23, 0x00,
+  0x11, 0xfe, 0x0f, 0x00, 0x06, 0xf0, 0x00, 0xfa, 0x01, 0x46, 0x79, 0xdf,
+  0x65, 0x00, 0xf0, 0x76, 0xfc, 0xaf, 0x01, 0x95, 0xfa, 0xbd, 0xf9, 0x13,
+  0x00, 0xf6, 0xf9, 0xf8, 0x65, 0x59, 0x03, 0xff, 0xef, 0xf8, 0xb9, 0x6d,
+  0x81, 0x33, 0x00, 0x79, 0xf9, 0x39, 0xba, 0x3b, 0x02, 0xf7, 0x0f, 0x00,
+  0x06, 0xf0, 0xe6, 0x17, 0x10, 0xb9, 0xeb, 0x65, 0x48, 0x0f, 0x00, 0x6d,
+  0xbf, 0x02, 0x7a, 0xfa, 0x39, 0xff, 0x6e, 0x06, 0xf0, 0xdb, 0xf9, 0x38,
+  0x66, 0x01, 0xff, 0xe0, 0x01, 0x28, 0x03, 0xdb, 0x0f, 0x98, 0xdd, 0xdf,
+  0xf8, 0x38, 0xb0, 0x00, 0x90, 0x27, 0x21, 0x04, 0x98, 0xff, 0x05, 0x90,
+  0x03, 0x98, 0x04, 0x90, 0x7f, 0xf4, 0xff, 0x70, 0xae, 0x60, 0x68, 0xdf,
+  0xf8, 0x74, 0x2d, 0xff, 0x50, 0xf8, 0x14, 0x7f, 0xdf, 0xf8, 0x6c, 0x3d,
+  0xfb, 0x07, 0xf0, 0xa3, 0x80, 0x43, 0x81, 0xea, 0x57, 0x01, 0xbc, 0x0f,
+  0x30, 0x9d, 0x10, 0x03, 0xf9, 0x01, 0x60, 0x13, 0x00, 0x02, 0xdd, 0x07,
+  0x5d, 0x30, 0x49, 0x1e, 0x7b, 0xd9, 0x30, 0xfb, 0x43, 0xff, 0x03, 0xf0,
+  0x01, 0x03, 0x4b, 0x43, 0x51, 0x43, 0xff, 0x01, 0xe0, 0x52, 0x00, 0x53,
+  0x1e, 0x07, 0x8f, 0xff, 0x79, 0x43, 0x07, 0xfb, 0x03, 0xf2, 0xb0, 0xf9,
+  0xbf, 0x5a, 0x70, 0x13, 0xb2, 0x3b, 0x44, 0xeb, 0x10, 0x70, 0xff, 0xbb,
+  0x42, 0x07, 0xd1, 0xb0, 0xf9, 0x5c, 0x70, 0xf5, 0x0b, 0x0f, 0x02, 0x12,
+  0x0f, 0x00, 0x04, 0xd0, 0x02, 0x9f, 0xff, 0x01, 0x9b, 0x7f, 0x1e, 0xbb,
+  0x42, 0x01, 0xdb, 0xff, 0x00, 0x22, 0x00, 0x21, 0x83, 0x8e, 0xd3, 0x18,
+  0xff, 0x83, 0x86, 0xc3, 0x8e, 0xcb, 0x18, 0xc3, 0x86, 0xff, 0xb0, 0xf8,
+  0x5a, 0x30, 0xd2, 0x18, 0xad, 0xf8, 0x7f, 0x0c, 0x20, 0xb0, 0xf8, 0x5c,
+  0x00, 0x08, 0x09, 0x00, 0x6b, 0x0e, 0x00, 0xa5, 0x33, 0x07, 0xcd, 0x20,
+  0xf7, 0xf8, 0xcd, 0x2b, 0xeb, 0x50, 0xca, 0x4d, 0x31, 0xdc, 0xd1, 0x20,
+  0x10, 0x18, 0x59, 0x49, 0x41, 0xd5, 0x21, 0x49, 0x31, 0xdc, 0xd9, 0x20,
+  0x0f, 0x03, 0x12, 0x0f, 0x00, 0x45, 0x08, 0x0f, 0x00, 0x04, 0x0f, 0x04,
+  0xbd, 0x22, 0x0f, 0x00, 0x06, 0x0f, 0x04, 0xff, 0x06, 0x01, 0x4f, 0xea,
+  0x68, 0x09, 0x20, 0x68, 0xff, 0x24, 0x30, 0xc1, 0x8b, 0x00, 0x29, 0x47,
+  0xd0, 0xbf, 0x16, 0x98, 0x4f, 0xf0, 0x8a, 0x41, 0x6f, 0x00, 0x60, 0xff,
+  0x48, 0xd1, 0x00, 0x2e, 0x7f, 0xf4, 0xe5, 0xad, 0xdf, 0x05, 0xf0, 0xa3,
+  0xf8, 0x20, 0x11, 0x30, 0x24, 0x10, 0xff, 0x17, 0x9a, 0x03, 0xa8, 0xff,
+  0xf7, 0x41, 0xfc, 0x7f, 0x00, 0xf0, 0x96, 0xf8, 0x05, 0xf0, 0xb2, 0x89,
+  0x0a, 0xdd, 0x10, 0x37, 0x02, 0x08, 0x60, 0x67, 0x3f, 0x10, 0xec, 0x1d,
+  0x75, 0x78, 0x6b, 0x10, 0xc1, 0x8f, 0x30, 0x90, 0x1d, 0x84, 0x7d, 0x60,
+  0xff, 0xac, 0x09, 0xc7, 0xf8, 0x64, 0xc0, 0xd1, 0xe9, 0xb7, 0x00, 0x23,
+  0x00, 0x2f, 0x20, 0x68, 0xf8, 0xcb, 0x00, 0x28, 0xf3, 0x0b, 0xd0, 0xa7,
+  0x40, 0x21, 0x50, 0x90, 0x09, 0x80, 0x68, 0xdd, 0xd1, 0xb1, 0x00, 0x00,
+  0xf0, 0x5c, 0x17, 0x02, 0x0d, 0xd1, 0xfa, 0x1f, 0x21, 0x60, 0xb1, 0x10,
+  0x05, 0xf9, 0x78, 0x66, 0x06, 0x57, 0xe0, 0x41, 0x5e, 0x75, 0x03, 0x06,
+  0x75, 0x00, 0x5b, 0x63, 0x30, 0xff, 0x3f, 0xf4, 0x9c, 0xad, 0x02, 0x98,
+  0x80, 0x1c, 0x5d, 0x08, 0x99, 0x10, 0x40, 0x1a, 0x09, 0x05, 0x02, 0x02,
+  0x99, 0x20, 0xef, 0x03, 0x08, 0x91, 0xe5, 0xa5, 0x03, 0x60, 0x68, 0x17,
+  0xff, 0x9a, 0x6e, 0x30, 0xff, 0xf7, 0xed, 0xfb, 0x00, 0xff, 0xf0, 0x42,
+  0xf8, 0x00, 0xf0, 0x3a, 0xf8, 0x02, 0xef, 0xf0, 0xed, 0xfa, 0x60, 0x17,
+  0x50, 0x58, 0x18, 0x08, 0xff, 0x60, 0x00, 0xf0, 0x99, 0xfc, 0x28, 0xb1,
+  0x00, 0xfd, 0x21, 0xd1, 0x51, 0x04, 0xf0, 0x10, 0xfd, 0x03, 0xe0, 0x76,
+  0x09, 0x03, 0x76, 0xff, 0xf1, 0x53, 0xc4, 0xfb, 0x00, 0x2f, 0x30, 0xff,
+  0x69, 0xfd, 0x15, 0xb1, 0x00, 0x2e, 0x3f, 0xf4, 0xbf, 0xe4, 0xac, 0x30,
+  0x46, 0x19, 0xb0, 0xc5, 0x70, 0x8f, 0xff, 0x00, 0x00, 0xff, 0xe6, 0xdb,
+  0x2e, 0x14, 0x0a, 0x77, 0x00, 0x46, 0x90, 0x6f, 0x90, 0x01, 0x60, 0x01,
+  0x05, 0x20, 0xdf, 0x5a, 0x43, 0x82, 0xea, 0x51, 0xd5, 0x70, 0xdb, 0x01,
+  0xff, 0x43, 0xea, 0x52, 0x63, 0x40, 0x43, 0xd2, 0x01, 0x7f, 0xc1, 0x17,
+  0x10, 0x1a, 0x73, 0xeb, 0x01, 0x13, 0x00, 0xff, 0x02, 0x22, 0x04, 0xf1,
+  0x22, 0x01, 0x0f, 0xf6, 0xff, 0x68, 0x50, 0x70, 0x47, 0x22, 0x99, 0x09,
+  0x68, 0xbf, 0x08, 0x43, 0x22, 0x99, 0x08, 0x60, 0x01, 0x81, 0xf0, 0xff,
+  0x4f, 0x8d, 0xb0, 0x53, 0x78, 0x12, 0x78, 0x04, 0x7b, 0x46, 0x88, 0xbd,
+  0x80, 0x41, 0xfc, 0x20, 0x8b, 0x63, 0x41, 0xff, 0x46, 0xf8, 0x4f, 0xea,
+  0x40, 0x0b, 0xe0, 0x69, 0xef, 0x05, 0xf0, 0x87, 0xff, 0xd9, 0x40, 0x1c,
+  0x05, 0xf0, 0xff, 0x93, 0xff, 0x05, 0x90, 0x26, 0x68, 0xf0, 0x8d, 0xd7,
+  0x05, 0xf0, 0x7e, 0x11, 0x00, 0xb8, 0x11, 0x00, 0x8a, 0xff, 0xf5, 0x01,
+  0x17, 0x10, 0x15, 0x35, 0x40, 0xe0, 0x8a, 0x05, 0xf0, 0xf7, 0x73, 0xff,
+  0x00, 0xc1, 0x30, 0x07, 0x46, 0x05, 0x99, 0x6e, 0x97, 0x31, 0x05, 0xf0,
+  0xf9, 0xaf, 0x50, 0x80, 0x41, 0x37, 0x11, 0x74, 0xb7, 0x31, 0x1f, 0x01,
+  0x82, 0x31, 0x80, 0x7a, 0x50, 0x51, 0x33, 0x00, 0xff, 0xfb, 0xf8, 0x07,
+  0x90, 0x00, 0x20, 0x63, 0x68, 0xff, 0x03, 0xf1, 0x28, 0x02, 0xc2, 0xe9,
+  0x00, 0x00, 0xd7, 0xc2, 0xe9, 0x02, 0x03, 0x00, 0x04, 0x03, 0x00, 0x06,
+  0x00, 0xff, 0x10, 0x84, 0x50, 0x84, 0x90, 0x62, 0x50, 0x63, 0xff, 0xd0,
+  0x62, 0x90, 0x63, 0x10, 0x63, 0xa3, 0xf8, 0xff, 0x68, 0x00, 0x04, 0x90,
+  0x71, 0x8d, 0x90, 0x8c, 0xff, 0x88, 0x42, 0x26, 0xbf, 0xb1, 0x8d, 0x81,
+  0x42, 0xff, 0x91, 0x84, 0x04, 0xa8, 0x00, 0x90, 0x5a, 0x46, 0x77, 0x05,
+  0x9b, 0x21, 0xa7, 0x80, 0xff, 0xf7, 0x4d, 0x4b, 0x40, 0xdf, 0x40, 0xf0,
+  0xa0, 0x82, 0x40, 0x95, 0x90, 0x82, 0xfb, 0xfd, 0x06, 0x13, 0x00, 0x02,
+  0xf0, 0x87, 0xfb, 0x07, 0x46, 0xff, 0x40, 0xf2, 0x47, 0x30, 0x86, 0x42,
+  0x0d, 0xda, 0xff, 0x0f, 0xf6, 0xdc, 0x40, 0x30, 0x5c, 0x00, 0xf2, 0xd7,
+  0x01, 0x10, 0x80, 0xd7, 0x00, 0x20, 0x95, 0x00, 0x72, 0x51, 0xfe, 0xff,
+  0x30, 0xf8, 0x06, 0x46, 0x01, 0xe0, 0x4f, 0xf0, 0xfd, 0x82, 0x0f, 0x20,
+  0x10, 0x15, 0x0f, 0xf6, 0x54, 0x40, 0xff, 0x79, 0x56, 0x30, 0xf8, 0x11,
+  0x00, 0x05, 0xf0, 0x7d, 0x0f, 0xdd, 0x00, 0x88, 0x17, 0x05, 0xf0, 0x1b,
+  0xcf, 0x00, 0xfd, 0x91, 0x21, 0x50, 0xe0, 0x8a, 0x40, 0x08, 0x05, 0xf0,
+  0xb7, 0x04, 0xff, 0x07, 0x5b, 0x70, 0x0a, 0x90, 0x2f, 0x80, 0x05, 0x55,
+  0xd5, 0xbd, 0x20, 0x05, 0xa3, 0x92, 0x7e, 0x29, 0x40, 0xd5, 0xb3, 0x20,
+  0xf7, 0x05, 0xf0, 0xb8, 0x0d, 0x00, 0x77, 0xfa, 0x06, 0x90, 0xdd, 0xd5,
+  0xd1, 0x20, 0x05, 0xf0, 0xb1, 0x0d, 0x00, 0x70, 0xfa, 0xe5, 0x09, 0x0d,
+  0x00, 0x0a, 0x0d, 0x00, 0xa3, 0x91, 0x69, 0xfa, 0x08, 0xff, 0x90, 0x2f,
+  0x68, 0x69, 0x6c, 0xa8, 0x6c, 0x05, 0xff, 0xf0, 0xe0, 0xff, 0x01, 0x90,
+  0x00, 0xf0, 0x6b, 0xcf, 0xfa, 0x00, 0x90, 0xa9, 0x7f, 0x21, 0xf5, 0x40,
+  0x05, 0xf0, 0xb3, 0xd6, 0xff, 0xef, 0x41, 0xdf, 0x41, 0x6d, 0xf8, 0x41,
+  0x51, 0x05, 0xff, 0xf0, 0xdb, 0xfe, 0x07, 0x46, 0xa9, 0x6b, 0xdf, 0xbf,
+  0xf8, 0x54, 0x0b, 0x05, 0xf0, 0xc7, 0x8b, 0x00, 0x42, 0xfa, 0x75, 0x40,
+  0x01, 0x17, 0x00, 0xcf, 0xfe, 0x01, 0x46, 0x50, 0xfe, 0x27, 0x00, 0x47,
+  0xf8, 0x02, 0xd2, 0xa8, 0x8e, 0x40, 0xbf, 0x1c, 0xa8, 0x86, 0x08, 0x46,
+  0x07, 0x87, 0x40, 0x3f, 0xff, 0xf8, 0x04, 0xd2, 0xa9, 0x8e, 0xa1, 0xeb,
+  0x11, 0xff, 0x10, 0x40, 0x1e, 0xa8, 0x86, 0x20, 0x68, 0x00, 0xff, 0xf1,
+  0x26, 0x07, 0xb8, 0x8b, 0x02, 0x28, 0x0b, 0x6f, 0xd1, 0xf8, 0x8b, 0x05,
+  0x1b, 0xa0, 0xe9, 0x6c, 0xfb, 0x50, 0xfe, 0x23, 0x00, 0xa8, 0x8e, 0x08,
+  0x28, 0xbc, 0xbf, 0x08, 0xe7, 0x20, 0xa8, 0x86, 0xd7, 0x50, 0xc9, 0x50,
+  0x23, 0xf8, 0xca, 0xff, 0x46, 0x38, 0xbf, 0x8a, 0xf0, 0x00, 0x4a, 0x06,
+  0xfe, 0xbd, 0x40, 0x1c, 0xf8, 0x38, 0xbf, 0x80, 0xf0, 0x00, 0xef, 0x40,
+  0x00, 0x90, 0x58, 0xb3, 0x10, 0x7f, 0xfe, 0x07, 0xeb, 0x90, 0x51, 0x8d,
+  0x02, 0x86, 0xbd, 0x10, 0xdf, 0xf8, 0xcc, 0xbf, 0x0a, 0x00, 0xf0, 0xf3,
+  0xf9, 0x07, 0xaf, 0x00, 0x8c, 0xd5, 0xfe, 0xc7, 0x11, 0x17, 0x59, 0xb0,
+  0xbc, 0x29, 0x60, 0x13, 0xf8, 0xff, 0x06, 0xf0, 0x7d, 0xf8, 0xad, 0xf8,
+  0x04, 0x00, 0xff, 0xbd, 0xf8, 0x04, 0x10, 0xa8, 0x8e, 0x88, 0x42, 0xff,
+  0x38, 0xbf, 0x08, 0x46, 0xa8, 0x86, 0xf9, 0x88, 0xf7, 0xa8, 0x8e, 0x81,
+  0xb7, 0x10, 0xb9, 0x88, 0x88, 0x42, 0xff, 0xa9, 0x86, 0x00, 0xf0, 0xf1,
+  0xf9, 0xa9, 0x68, 0xdd, 0x82, 0x4d, 0x60, 0xee, 0xf9, 0x51, 0x5d, 0x00,
+  0x5c, 0xff, 0xfd, 0x0b, 0x49, 0x00, 0xf5, 0xff, 0x29, 0x68, 0x05, 0xf0,
+  0x3b, 0x64, 0xfe, 0x67, 0x31, 0x05, 0xf0, 0xdc, 0x67, 0x00, 0x8d, 0x00,
+  0xaf, 0x46, 0x09, 0x99, 0x68, 0x15, 0x00, 0xe7, 0x8b, 0xa0, 0x08, 0xbb,
+  0x99, 0xa8, 0x09, 0x00, 0xe2, 0xff, 0x59, 0x31, 0x00, 0x43, 0xa6, 0x07,
+  0x10, 0xc1, 0xf9, 0x13, 0x01, 0x1d, 0x01, 0xd8, 0x33, 0x10, 0x09, 0x22,
+  0x1d, 0x02, 0xd3, 0x89, 0x20, 0xa5, 0x01, 0x93, 0x11, 0xb1, 0xab, 0x50,
+  0xb3, 0x13, 0x7f, 0x2a, 0xfe, 0x82, 0x46, 0xb5, 0xf9, 0x30, 0xd3, 0x10,
+  0xd5, 0x1b, 0x17, 0x00, 0xa5, 0x2f, 0x50, 0x9c, 0x3b, 0x00, 0xb5, 0xf9,
+  0x95, 0x32, 0x11, 0x00, 0x12, 0x11, 0x00, 0x9c, 0xab, 0x62, 0x1b, 0x11,
+  0x05, 0xff, 0x46, 0xb8, 0x89, 0x90, 0xb1, 0x07, 0x99, 0x30, 0xae, 0x63,
+  0x00, 0x1f, 0xfe, 0x06, 0xf1, 0x62, 0x7f, 0x2f, 0x00, 0x84, 0xaa, 0x2f,
+  0x00, 0x06, 0x7b, 0x60, 0x79, 0x29, 0x00, 0x28, 0x1b, 0x00, 0x8f, 0xaa,
+  0x29, 0x00, 0x58, 0xf7, 0x00, 0x29, 0xef, 0x00, 0x05, 0xef, 0x00, 0x0c,
+  0x6b, 0x00, 0x28, 0x0d, 0x00, 0x22, 0x7d, 0x40, 0xfe, 0xff, 0x17, 0x51,
+  0xff, 0x78, 0x88, 0x05, 0xf0, 0xef, 0xfd, 0x06, 0x46, 0xdc, 0x05, 0x10,
+  0x63, 0x00, 0xea, 0xfd, 0x01, 0x33, 0x10, 0x9c, 0x09, 0x34, 0xfb, 0x20,
+  0x6d, 0x00, 0x57, 0x7f, 0x40, 0x94, 0x19, 0x1f, 0x01, 0x65, 0x40, 0xae,
+  0x07, 0x00, 0x67, 0xff, 0x81, 0xe9, 0x00, 0x89, 0x69, 0x00, 0x4d, 0xe9,
+  0xf9, 0x53, 0x60, 0x43, 0x00, 0xdc, 0x43, 0x00, 0x08, 0x00, 0x49, 0xbe,
+  0x69, 0x02, 0x6a, 0xff, 0x05, 0xf0, 0xf6, 0x03, 0x00, 0xd2, 0xfe, 0x13,
+  0x00, 0x0a, 0x00, 0x0a, 0x98, 0xb0, 0xf8, 0x76, 0xbf, 0x00, 0x28, 0xb3,
+  0xbd, 0xf9, 0x0a, 0x9d, 0x70, 0x08, 0xdf, 0x10, 0x23, 0x8c, 0x00, 0xfb,
+  0xd1, 0x20, 0xfb, 0x01, 0xff, 0x22, 0x9a, 0x42, 0x1a, 0xda, 0x3a, 0x88,
+  0x8a, 0x76, 0x69, 0xc0, 0x12, 0xb2, 0x3d, 0x00, 0x20, 0x39, 0x88, 0x67,
+  0xc1, 0x6e, 0x33, 0x00, 0x10, 0x38, 0x88, 0x29, 0x01, 0x40, 0x42, 0x0f,
+  0x03, 0xab, 0x08, 0x00, 0x0f, 0x01, 0x0a, 0x0f, 0x06, 0x0a, 0x79, 0xb0,
+  0x46, 0xf5, 0xf9, 0x2f, 0xa1, 0xbd, 0xd9, 0x51, 0xf9, 0x6e, 0x10, 0xbd,
+  0xdf, 0xf8, 0x0e, 0x30, 0x8a, 0x1a, 0xe7, 0x53, 0x70, 0x20, 0x5d, 0xd2,
+  0x09, 0x00, 0x0e, 0x20, 0xbd, 0x51, 0x00, 0x89, 0x09, 0x00, 0x0f, 0x08,
+  0x10, 0x42, 0x46, 0x15, 0x00, 0xdd, 0x10, 0x41, 0x00, 0x0f, 0x00, 0xeb,
+  0x0a, 0x00, 0xdb, 0x43, 0x02, 0x09, 0x50, 0x81, 0xf9, 0x04, 0xff, 0x99,
+  0x08, 0x43, 0x04, 0x90, 0x61, 0x68, 0x02, 0xeb, 0x98, 0xc1, 0xdf, 0x90,
+  0x86, 0xcb, 0xb0, 0x34, 0x21, 0xdf, 0xf7, 0xf8, 0x4c, 0x04, 0x4f, 0xc0,
+  0x06, 0x23, 0x46, 0x30, 0xff, 0x69, 0x40, 0x1c, 0x30, 0x61, 0xf0, 0x68,
+  0x40, 0xff, 0x1c, 0xf0, 0x60, 0x04, 0x9a, 0x02, 0x99, 0x03, 0xff, 0x98,
+  0xcd, 0xf8, 0x00, 0x80, 0x00, 0xf0, 0xf4, 0xf4, 0xc5, 0x50, 0x3d, 0x81,
+  0x69, 0x3d, 0x80, 0x40, 0x88, 0x01, 0xf1, 0x5f, 0x4c, 0x07, 0x05, 0xf0,
+  0x51, 0x31, 0x10, 0xb8, 0x73, 0x40, 0xdf, 0xd9, 0xfe, 0x02, 0xd3, 0x38,
+  0x39, 0x80, 0x14, 0xdb, 0xff, 0xff, 0xf7, 0xf3, 0xf8, 0x67, 0x68, 0xb9,
+  0x69, 0xf7, 0x80, 0x46, 0x05, 0xa9, 0x10, 0xdf, 0xfe, 0xb8, 0x61, 0xfb,
+  0xf9, 0x69, 0x09, 0x01, 0xda, 0xfe, 0xf8, 0x61, 0x39, 0xbd, 0x6a, 0x09,
+  0x01, 0xd5, 0xfe, 0x38, 0x62, 0xdd, 0xc1, 0x00, 0xff, 0xf0, 0xc4, 0xfe,
+  0x64, 0x68, 0x04, 0xf1, 0x18, 0xfb, 0x08, 0xd8, 0x83, 0x20, 0xd8, 0xf8,
+  0x08, 0x70, 0x00, 0xec, 0xe5, 0x30, 0x37, 0x80, 0xf8, 0x49, 0x4f, 0x10,
+  0x26, 0xfe, 0x05, 0xeb, 0xf0, 0x66, 0x39, 0x30, 0x0b, 0x31, 0x00, 0xbc,
+  0xfe, 0xd8, 0x77, 0xf8, 0x00, 0x10, 0x1f, 0x20, 0xfd, 0xb0, 0x61, 0x27,
+  0x00, 0xf1, 0x00, 0x2f, 0x01, 0xf3, 0x21, 0x7f, 0x00, 0xff, 0xf0, 0x61,
+  0xb8, 0xff, 0xf8, 0x34, 0x00, 0x30, 0x86, 0x34, 0xf9, 0x0e, 0x7f, 0x0f,
+  0x00, 0x28, 0x6a, 0xd1, 0x58, 0x46, 0x77, 0x21, 0xdd, 0xa3, 0x8b, 0x30,
+  0x28, 0x46, 0x29, 0x09, 0x00, 0x9e, 0xfe, 0x7d, 0x39, 0x05, 0x00, 0xff,
+  0xfd, 0x05, 0xf0, 0x3f, 0x0b, 0x20, 0xfb, 0xb1, 0x6a, 0xeb, 0x43, 0xf7,
+  0xfd, 0xb0, 0x62, 0x28, 0x77, 0x46, 0x31, 0x6a, 0x1b, 0x50, 0xfd, 0xb1,
+  0x6a, 0x03, 0x50, 0xd4, 0x2f, 0x90, 0x0d, 0x01, 0xeb, 0xcf, 0x00, 0x31,
+  0x19, 0x00, 0x05, 0xf0, 0x7f, 0x72, 0xfd, 0x00, 0xf0, 0x61, 0xf8, 0x71,
+  0x13, 0x00, 0x6f, 0xe1, 0xfd, 0x70, 0x62, 0x01, 0x20, 0x17, 0xb0, 0x0b,
+  0x00, 0xaf, 0x7f, 0xff, 0x39, 0xd8, 0x23, 0x21, 0x70, 0x83, 0xc0, 0x48,
+  0xa9, 0x57, 0xc7, 0x20, 0x2f, 0x00, 0x70, 0x17, 0x00, 0xdd, 0xeb, 0x80,
+  0xf1, 0xaa, 0x25, 0x00, 0x70, 0x13, 0x10, 0xc9, 0x45, 0x22, 0x68, 0x09,
+  0x00, 0xd2, 0xef, 0xfc, 0x05, 0xf0, 0xec, 0xc7, 0x00, 0xc8, 0xfe, 0xb0,
+  0xff, 0x60, 0x65, 0x28, 0x24, 0xbf, 0x64, 0x20, 0xb0, 0x57, 0x60, 0xb0,
+  0x6a, 0x95, 0x01, 0x53, 0x7d, 0xa0, 0x2c, 0xb3, 0x40, 0xab, 0xb3, 0xfd,
+  0x61, 0x01, 0x4c, 0xad, 0x00, 0xb1, 0x5f, 0x60, 0x18, 0xf2, 0x33, 0x00,
+  0xaa, 0x3d, 0x00, 0x7d, 0x51, 0xb4, 0xfc, 0x70, 0x62, 0xfb, 0x29, 0x46,
+  0x73, 0x01, 0x3d, 0xfe, 0xb0, 0x62, 0x04, 0xff, 0x98, 0x20, 0xb1, 0x01,
+  0x20, 0x60, 0x80, 0x70, 0xfe, 0x9b, 0x10, 0x70, 0x61, 0x00, 0xf0, 0x3c,
+  0xfe, 0x00, 0xfb, 0x20, 0x0d, 0x57, 0x64, 0x40, 0xad, 0x00, 0x20, 0x20,
+  0x7a, 0xbb, 0xf0, 0x31, 0x35, 0x00, 0x27, 0xbe, 0x58, 0x46, 0x3d, 0x11,
+  0xa7, 0x23, 0xbe, 0x01, 0xf7, 0x20, 0x1b, 0x50, 0xbd, 0xfd, 0x01, 0x1c,
+  0x6d, 0xbe, 0xbd, 0x31, 0x8b, 0xbc, 0x0b, 0x01, 0x88, 0xbc, 0x9d, 0x01,
+  0xfb, 0xd0, 0x06, 0x3d, 0xa0, 0xb8, 0x00, 0x00, 0xd8, 0x2a, 0xdf, 0x00,
+  0x20, 0x69, 0x68, 0x08, 0x17, 0x00, 0x0a, 0xbe, 0xfa, 0xdd, 0x20, 0x46,
+  0x21, 0x01, 0x05, 0xbe, 0x2d, 0xe9, 0xfa, 0xff, 0x4f, 0x83, 0xb0, 0x1e,
+  0x68, 0xd3, 0xf8, 0x04, 0xbf, 0x80, 0x22, 0xb1, 0x40, 0x46, 0x05, 0x69,
+  0x01, 0x4f, 0xf7, 0xb6, 0xe0, 0x0e, 0x13, 0xa0, 0xb2, 0xf8, 0x08, 0xf1,
+  0xdf, 0x68, 0x05, 0x83, 0x46, 0xa9, 0x67, 0xe0, 0x8c, 0x06, 0xdf, 0x09,
+  0x56, 0x02, 0x91, 0x1b, 0x19, 0xf0, 0x40, 0x1a, 0xff, 0x7d, 0xd0, 0x28,
+  0x88, 0x00, 0x28, 0x7a, 0xd1, 0xfd, 0xb8, 0xf9, 0xa0, 0xe8, 0xb1, 0x04,
+  0x98, 0x40, 0x68, 0x7f, 0x02, 0x9a, 0x00, 0xf5, 0x02, 0x74, 0xd4, 0x49,
+  0x80, 0xff, 0x02, 0xf0, 0x35, 0xf9, 0xc0, 0x07, 0x12, 0xd4, 0x7a, 0x0b,
+  0x01, 0xcd, 0x69, 0x80, 0x02, 0x9a, 0x01, 0x20, 0xc9, 0x41, 0xf7, 0x4a,
+  0xf8, 0xdd, 0xd3, 0x70, 0x10, 0x43, 0x19, 0x43, 0xed, 0xc4, 0x19, 0x00,
+  0x00, 0x26, 0x9b, 0x10, 0x5a, 0x0d, 0xe0, 0xfd, 0xf0, 0x4f, 0x20, 0x25,
+  0xfc, 0xdf, 0xf8, 0x04, 0x16, 0xdf, 0x05, 0xf0, 0x31, 0xfc, 0x06, 0x83,
+  0x60, 0x7e, 0x50, 0xf6, 0xdb, 0x01, 0xa9, 0xfc, 0x1d, 0x41, 0x0a, 0x00,
+  0x44, 0x01, 0xf9, 0xb5, 0x63, 0x00, 0xed, 0x60, 0x19, 0x02, 0x98, 0x08,
+  0xeb, 0x7f, 0xc0, 0x07, 0x04, 0x98, 0x42, 0x68, 0xd2, 0xc5, 0xe0, 0xdf,
+  0x02, 0x9a, 0x02, 0xf0, 0x01, 0x67, 0x00, 0x2b, 0xd5, 0xcd, 0x20, 0x2d,
+  0x00, 0xfa, 0xfb, 0x75, 0x51, 0xff, 0x10, 0xfd, 0x04, 0x3f, 0x46, 0xb8,
+  0x6f, 0x05, 0xf0, 0xf2, 0x0f, 0x00, 0x2d, 0x41, 0xa9, 0x96, 0x5f, 0x10,
+  0x1f, 0x01, 0xf6, 0x9b, 0x10, 0xfc, 0x1b, 0x00, 0x48, 0xfa, 0x0b, 0x00,
+  0xe4, 0x2b, 0x04, 0x88, 0xfd, 0x82, 0x46, 0xf8, 0x4a, 0x2b, 0x00, 0xdc,
+  0x2b, 0x04, 0x80, 0x2b, 0x00, 0x17, 0x01, 0xe0, 0x2b, 0x00, 0xff, 0xe6,
+  0xfd, 0x81, 0x46, 0xfe, 0xf7, 0x85, 0xff, 0x7f, 0xbc, 0x67, 0x06, 0x46,
+  0xc7, 0xf8, 0x7c, 0x01, 0xd0, 0xd7, 0x81, 0xb2, 0x04, 0x0d, 0xb1, 0xfa,
+  0x3f, 0x31, 0x28, 0x88, 0xdf, 0x48, 0xb9, 0xfe, 0xf7, 0x76, 0xcf, 0xd0,
+  0x03, 0x98, 0xff, 0xc8, 0xf8, 0x72, 0x00, 0xa5, 0xf8, 0x04, 0xb0, 0xfe,
+  0x17, 0x01, 0x01, 0x20, 0xe8, 0x81, 0x58, 0xe1, 0x38, 0xdb, 0xb5, 0x14,
+  0x73, 0x10, 0x64, 0x15, 0xb3, 0xf0, 0x72, 0x02, 0xff, 0xfb, 0x00, 0x15,
+  0xff, 0xf7, 0x1b, 0xf8, 0x05, 0xff, 0xf1, 0x68, 0x00, 0x01, 0x21, 0x44,
+  0x80, 0x01, 0xef, 0x80, 0x31, 0xbd, 0x00, 0xca, 0xd0, 0x00, 0x51, 0x00,
+  0xf7, 0x00, 0x50, 0x59, 0x49, 0x10, 0x59, 0x06, 0x40, 0x80, 0xf7, 0x83,
+  0x07, 0x40, 0x71, 0x30, 0xf5, 0x02, 0x70, 0x00, 0xf7, 0x22, 0xc0, 0xe9,
+  0x03, 0x01, 0x02, 0x22, 0x70, 0x47, 0xfd, 0x70, 0x65, 0xf2, 0x00, 0xf0,
+  0x59, 0xf8, 0x40, 0xf2, 0xff, 0x42, 0x66, 0x88, 0xb3, 0xdf, 0xf8, 0x14,
+  0x05, 0xdf, 0xb0, 0xf8, 0x54, 0x10, 0x28, 0xbd, 0xf0, 0xa6, 0xfb, 0xbf,
+  0x08, 0xb1, 0x07, 0x20, 0x70, 0xbd, 0x35, 0x10, 0x05, 0xff, 0x01, 0x78,
+  0x03, 0x22, 0x11, 0x42, 0x06, 0xd0, 0xfb, 0x00, 0x7e, 0x6f, 0xa0, 0x00,
+  0x02, 0x28, 0x01, 0xd1, 0xfd, 0x06, 0x19, 0x00, 0xe8, 0xb2, 0x02, 0xf0,
+  0xea, 0xfb, 0x7f, 0x00, 0x28, 0xe0, 0x60, 0x01, 0xd5, 0x08, 0x0f, 0x00,
+  0xff, 0x00, 0x22, 0x10, 0x21, 0x30, 0x46, 0x01, 0xf0, 0xdf, 0x6c, 0xfe,
+  0x08, 0x20, 0x04, 0x97, 0xa0, 0x08, 0xb1, 0xfd, 0x09, 0x15, 0x00, 0xe0,
+  0x68, 0x04, 0xf0, 0xbc, 0xf8, 0xf7, 0x04, 0xf0, 0xdb, 0x87, 0x30, 0x1f,
+  0xf8, 0x13, 0xe0, 0xff, 0xe5, 0x60, 0x01, 0x21, 0xe8, 0xb2, 0x04, 0xf0,
+  0xff, 0xfb, 0xf9, 0x04, 0xf0, 0x36, 0xfa, 0x00, 0xf0, 0xff, 0x15, 0xf8,
+  0x00, 0x22, 0x18, 0x21, 0x40, 0xf2, 0x7d, 0x7a, 0xbf, 0x80, 0x4f, 0xfe,
+  0x00, 0x22, 0x20, 0x43, 0x02, 0xfd, 0x4a, 0x8d, 0x20, 0x70, 0xbd, 0x68,
+  0x18, 0x00, 0x01, 0xff, 0x00, 0x00, 0xc8, 0xc3, 0xc0, 0x01, 0x00, 0x45,
+  0xfe, 0xe3, 0x81, 0xe0, 0x68, 0x80, 0x1c, 0x28, 0x21, 0x80, 0x1f, 0xb2,
+  0x03, 0xf0, 0x46, 0xbf, 0x11, 0xd3, 0xbd, 0x83, 0x09, 0x10, 0xdf, 0x04,
+  0x85, 0xb0, 0x80, 0x7a, 0x9d, 0x01, 0x04, 0x90, 0xbd, 0x0c, 0x19, 0x10,
+  0x58, 0x04, 0x20, 0x60, 0x0f, 0xf1, 0x8c, 0xff, 0xf9, 0x05, 0x00, 0x40,
+  0xf0, 0xc0, 0x80, 0x00, 0xff, 0x26, 0x0f, 0xf2, 0x74, 0x4a, 0x04, 0x98,
+  0xf0, 0xff, 0x40, 0xc0, 0x07, 0x40, 0xf1, 0xb4, 0x80, 0x34, 0xdf, 0x20,
+  0x00, 0xfb, 0x06, 0xfb, 0x59, 0xf0, 0x04, 0xdf, 0xff, 0xf8, 0x30, 0x14,
+  0x0b, 0xeb, 0x00, 0x09, 0x00, 0x3f, 0x20, 0x4b, 0xf8, 0x01, 0x00, 0xc9,
+  0xb5, 0x50, 0x53, 0x10, 0xef, 0x71, 0xdf, 0xf8, 0x08, 0xbb, 0x40, 0x06,
+  0x00, 0x60, 0xff, 0x60, 0x00, 0x21, 0x81, 0x81, 0x01, 0x21, 0xc1, 0xff,
+  0x81, 0x01, 0x82, 0x41, 0x82, 0xff, 0xf7, 0x5e, 0xff, 0xff, 0x60, 0x68,
+  0x00, 0x21, 0x20, 0xf8, 0x6e, 0xff, 0x1f, 0x41, 0x80, 0x32, 0x46, 0x21,
+  0x68, 0xb1, 0xde, 0x01, 0x50, 0xfe, 0xf7, 0x01, 0xff, 0xb3, 0x01, 0x4e,
+  0xff, 0x7d, 0x80, 0x4b, 0x50, 0xa0, 0xf8, 0x6a, 0x80, 0x69, 0xeb, 0x12,
+  0xe3, 0x16, 0xff, 0x8b, 0x20, 0x9d, 0x20, 0xad, 0x20, 0xaa, 0x00, 0x20,
+  0xf5, 0x8d, 0x31, 0x50, 0x01, 0xdb, 0x00, 0x05, 0xf0, 0x41, 0xff, 0xff,
+  0x20, 0x68, 0x90, 0xf8, 0x3a, 0x00, 0x3a, 0xf8, 0xfb, 0x10, 0x10, 0x57,
+  0x60, 0xf8, 0x60, 0x8a, 0xe0, 0x82, 0xff, 0x31, 0x46, 0x01, 0x20, 0x20,
+  0x82, 0x00, 0xf0, 0xdf, 0xca, 0xf8, 0x05, 0x46, 0x02, 0x09, 0x00, 0x31,
+  0x46, 0xdf, 0x60, 0x8a, 0x00, 0x09, 0xe0, 0x11, 0x00, 0xc1, 0xf8, 0xef,
+  0x05, 0xb9, 0x05, 0x46, 0x31, 0x03, 0x47, 0x1c, 0x09, 0x6f, 0xe0, 0x3a,
+  0xf8, 0x17, 0x35, 0x00, 0x5e, 0xf8, 0xef, 0x20, 0xdb, 0xf0, 0xb1, 0x1b,
+  0x02, 0x7f, 0x1c, 0x1d, 0x01, 0x3b, 0x00, 0xff, 0xbf, 0xb2, 0xb8, 0x42,
+  0xef, 0xd2, 0x07, 0x46, 0xfb, 0x12, 0xe0, 0x0f, 0x03, 0x02, 0xeb, 0xc0,
+  0x00, 0x00, 0x7f, 0xf1, 0x70, 0x0c, 0x02, 0xeb, 0xc7, 0x02, 0x8d, 0xb1,
+  0xdb, 0x78, 0x32, 0x67, 0x90, 0x01, 0x39, 0xab, 0x20, 0x00, 0xf0, 0xff,
+  0xa4, 0xf9, 0x7f, 0x1c, 0xbf, 0xb2, 0x62, 0x68, 0x7f, 0x32, 0x2f, 0xe8,
+  0xdb, 0xa2, 0xf8, 0x6c, 0xb1, 0x04, 0x5d, 0xdd, 0xa3, 0x60, 0x2e, 0xf8,
+  0x03, 0x59, 0x00, 0x84, 0x59, 0x02, 0xff, 0x1d, 0xb9, 0x61, 0x68, 0x01,
+  0x20, 0xa1, 0xf8, 0xff, 0x18, 0x02, 0x00, 0xf0, 0x28, 0xf8, 0x30, 0xf8,
+  0x5f, 0x02, 0x1c, 0x00, 0xf0, 0x21, 0xc7, 0x10, 0x1c, 0x03, 0x00, 0xd5,
+  0x20, 0x0f, 0x00, 0x04, 0x0f, 0x00, 0x19, 0x0b, 0x00, 0x14, 0xf8, 0x7a,
+  0x3f, 0x03, 0xbd, 0x3f, 0x00, 0x0e, 0xf8, 0x64, 0x20, 0x45, 0x11, 0xff,
+  0xb6, 0x48, 0x4b, 0xf8, 0x00, 0x50, 0x76, 0x1c, 0x3f, 0x02, 0x2e, 0xff,
+  0xf4, 0x43, 0xaf, 0xff, 0x40, 0x5b, 0x42, 0x6d, 0x30, 0xf1, 0x20, 0xc6,
+  0xbe, 0x2b, 0x01, 0x0b, 0xbf, 0xa5, 0x03, 0xf7, 0x0a, 0xeb, 0x40, 0xc5,
+  0x13, 0x47, 0x0c, 0x46, 0xa8, 0xff, 0x48, 0xa7, 0x49, 0x20, 0x60, 0x49,
+  0x89, 0xc0, 0xd7, 0x8f, 0x08, 0x40, 0xcb, 0x10, 0x08, 0xa9, 0x01, 0xab,
+  0xf8, 0xbf, 0x05, 0x00, 0x37, 0xd1, 0x00, 0x26, 0x91, 0x90, 0xa2, 0xfd,
+  0x28, 0x7b, 0xe0, 0xc0, 0x07, 0x2d, 0xd5, 0x00, 0xf0, 0xfb, 0xd0, 0xfb,
+  0xc1, 0x12, 0xf9, 0x09, 0xeb, 0x0a, 0x07, 0xdf, 0x00, 0x20, 0x78, 0x60,
+  0x49, 0x5d, 0x10, 0x00, 0xf0, 0x4f, 0xda, 0xfb, 0x94, 0x48, 0xbd, 0x11,
+  0xb9, 0x13, 0x01, 0xb9, 0x10, 0xa7, 0xc1, 0x81, 0x21, 0x4b, 0x12, 0x49,
+  0x11, 0x1c, 0x5b, 0x10, 0xa0, 0xf0, 0x6b, 0x12, 0x61, 0x11, 0xb5, 0x01,
+  0xe3, 0x01, 0x00, 0xf0, 0xaa, 0xfb, 0x7d, 0x64, 0x41, 0x03, 0x50, 0x00,
+  0xf0, 0xb9, 0xfb, 0xb1, 0x01, 0xef, 0xca, 0xd3, 0x28, 0x46, 0xad, 0x00,
+  0x87, 0x49, 0x03, 0xfb, 0x00, 0x80, 0x8b, 0x11, 0x20, 0x46, 0xad, 0xe0,
+  0x2d, 0xef, 0xe9, 0xf8, 0x43, 0x80, 0x2d, 0x30, 0x7f, 0x48, 0x80, 0xb7,
+  0x4f, 0x28, 0x60, 0x65, 0x01, 0x79, 0x48, 0xdd, 0x60, 0x00, 0xf5, 0x68,
+  0xbf, 0xb0, 0x89, 0x8d, 0x02, 0x08, 0xf6, 0xf4, 0x19, 0xff, 0x00, 0x20,
+  0x60, 0x60, 0xf0, 0x51, 0x00, 0xf0, 0xf7, 0x95, 0xfb, 0x28, 0xd5, 0x71,
+  0xf8, 0x5f, 0xea, 0x00, 0xff, 0x09, 0x2b, 0xd1, 0x68, 0x68, 0xb0, 0xf8,
+  0x18, 0xff, 0x12, 0x11, 0xb9, 0x4f, 0xf0, 0x04, 0x09, 0x24, 0xff, 0xe0,
+  0x30, 0xf9, 0x0c, 0x1f, 0x00, 0x29, 0x02, 0xff, 0xbf, 0x29, 0x68, 0xb1,
+  0xf8, 0x40, 0x10, 0x00, 0xff, 0x29, 0x10, 0xd1, 0x01, 0x21, 0x01, 0x80,
+  0x03, 0x7f, 0x21, 0x29, 0x82, 0x00, 0x21, 0x41, 0x80, 0xd7, 0x11, 0xf7,
+  0x1e, 0xf8, 0x81, 0xa3, 0x00, 0x00, 0xf0, 0x1a, 0xf8, 0x7d, 0xb9, 0x0b,
+  0xe0, 0x0b, 0xd1, 0x09, 0xe0, 0x01, 0x1d, 0x04, 0xbf, 0x41, 0x46, 0xa8,
+  0x8a, 0xe8, 0x82, 0x5b, 0x01, 0x65, 0xee, 0x23, 0x00, 0x00, 0xf0, 0x4c,
+  0xbb, 0x00, 0x60, 0x60, 0x46, 0xde, 0x4b, 0xb1, 0xf0, 0x5b, 0xfb, 0x48,
+  0xb5, 0x00, 0xf2, 0x83, 0xf7, 0x28, 0x82, 0x41, 0xa9, 0x60, 0x54, 0xe0,
+  0x80, 0xb5, 0xff, 0x53, 0x49, 0x56, 0x4a, 0x09, 0x6c, 0xa0, 0xfb, 0xef,
+  0x01, 0x01, 0x00, 0x23, 0x1d, 0xd0, 0xfe, 0x04, 0xf0, 0xff, 0x66, 0xfa,
+  0xbd, 0xe8, 0x02, 0x40, 0x04, 0xf0, 0xd3, 0x58, 0xba, 0xfb, 0x31, 0x57,
+  0xc1, 0x7b, 0xab, 0x80, 0x20, 0x68, 0xdf, 0x01, 0x88, 0x0a, 0x25, 0x8e,
+  0x15, 0x80, 0x0e, 0x46, 0xdf, 0x03, 0xdb, 0x40, 0x88, 0xb0, 0x09, 0x00,
+  0x06, 0x46, 0xff, 0x10, 0x2e, 0x18, 0xdb, 0x40, 0xf2, 0xee, 0x20, 0xff,
+  0xff, 0xf7, 0xda, 0xff, 0x05, 0x46, 0xa6, 0xf1, 0xf5, 0x0f, 0x2f, 0x80,
+  0xd5, 0x8f, 0x40, 0x04, 0xf0, 0x43, 0xfa, 0xff, 0x20, 0x83, 0x20, 0x68,
+  0x41, 0x68, 0x69, 0x43, 0xff, 0xb1, 0xfb, 0xf6, 0xf1, 0x61, 0x82, 0x80,
+  0x68, 0xdf, 0x68, 0x43, 0xb0, 0xfb, 0xf6, 0x81, 0xb0, 0x00, 0x25, 0xff,
+  0x28, 0x46, 0x70, 0xbd, 0x70, 0xb5, 0x00, 0x24, 0xef, 0x38, 0x4d, 0x31,
+  0x4e, 0x25, 0x10, 0x70, 0x22, 0x46, 0xff, 0x01, 0x21, 0x00, 0xfb, 0x04,
+  0x60, 0xfe, 0xf7, 0xff, 0x16, 0xfd, 0x2b, 0x46, 0x00, 0x22, 0xe1, 0xb2,
+  0xfe, 0xab, 0xc0, 0xf0, 0x7c, 0xfd, 0x64, 0x1c, 0x02, 0x2c, 0xe3, 0xee,
+  0xd3, 0x35, 0x40, 0xdb, 0x30, 0x87, 0x44, 0x20, 0x05, 0xf0, 0xdf, 0x49,
+  0xff, 0x90, 0xb1, 0x29, 0x09, 0x04, 0x06, 0x46, 0xf5, 0x32, 0x6f, 0x70,
+  0x20, 0xdf, 0xb0, 0xae, 0xf9, 0x21, 0x8a, 0xff, 0x49, 0x1e, 0x21, 0x82,
+  0x09, 0xb2, 0x01, 0x29, 0xff, 0x03, 0xdb, 0x00, 0x28, 0xf2, 0xd0, 0x70,
+  0xbd, 0xfd, 0x03, 0x1f, 0x40, 0x18, 0x49, 0xc2, 0x07, 0x44, 0xbf, 0x9f,
+  0x01, 0x22, 0x0a, 0x82, 0x80, 0x07, 0x01, 0xa9, 0x20, 0x30, 0xff, 0x02,
+  0x70, 0x47, 0x00, 0x00, 0xa4, 0x70, 0x7d, 0xab, 0x3f, 0x11, 0x1b, 0x04,
+  0x4a, 0x1b, 0x06, 0x32, 0x1b, 0x02, 0x00, 0xff, 0x24, 0x74, 0x49, 0x00,
+  0x00, 0x7a, 0x44, 0x00, 0xff, 0x00, 0x80, 0xbf, 0x02, 0x56, 0xfd, 0x37,
+  0x00, 0xff, 0x00, 0x34, 0x44, 0x00, 0xa0, 0x8c, 0x47, 0xcd, 0x7f, 0xcc,
+  0x4c, 0x3d, 0x01, 0x00, 0x80, 0x3f, 0x53, 0xd1, 0x3e, 0x73, 0x40, 0x42,
+  0x00, 0x00, 0x20, 0x41, 0x03, 0x71, 0x0b, 0x71, 0xff, 0x4c, 0x1f, 0x00,
+  0x20, 0x48, 0x04, 0x00, 0x46, 0xcf, 0x74, 0x29, 0x00, 0x20, 0xdf, 0x61,
+  0x8b, 0x41, 0x80, 0x8d, 0xff, 0x5b, 0x00, 0xbf, 0x12, 0x00, 0x01, 0xd0,
+  0xb5, 0xff, 0x44, 0x68, 0x0a, 0x46, 0xd4, 0xe9, 0x82, 0x67, 0xfe, 0x81,
+  0x61, 0x05, 0xf0, 0x09, 0xfd, 0x30, 0x43, 0x39, 0xfe, 0x7d, 0x60, 0x82,
+  0x01, 0xd0, 0xbd, 0x42, 0x06, 0x7a, 0xff, 0x06, 0x00, 0x00, 0x06, 0x00,
+  0x0c, 0x00, 0x0f, 0xff, 0x00, 0x15, 0x00, 0x1b, 0x00, 0x1e, 0x00, 0x24,
+  0xff, 0x00, 0x28, 0x00, 0x2f, 0x00, 0x32, 0x00, 0x37, 0xff, 0x00, 0x3e,
+  0x00, 0x41, 0x00, 0x46, 0x00, 0x4b, 0xff, 0x00, 0x52, 0x00, 0x56, 0x00,
+  0x5b, 0x00, 0x60, 0xff, 0x00, 0x65, 0x00, 0x69, 0x00, 0x6e, 0x00, 0x73,
+  0xfb, 0x00, 0x79, 0x64, 0x50, 0x84, 0x00, 0x91, 0x00, 0x96, 0xff, 0x00,
+  0x9d, 0x00, 0xab, 0x00, 0xba, 0x00, 0xc3, 0xff, 0x00, 0xd3, 0x00, 0xdd,
+  0x00, 0xe7, 0x00, 0xf1, 0xff, 0x00, 0x09, 0x01, 0x15, 0x01, 0x23, 0x01,
+  0x32, 0xff, 0x01, 0x55, 0x01, 0x6b, 0x01, 0x83, 0x01, 0x9d, 0xff, 0x01,
+  0xbe, 0x01, 0xe2, 0x01, 0x14, 0x02, 0x5a, 0xff, 0x02, 0xd3, 0x02, 0xff,
+  0xfc, 0xf9, 0xf6, 0xf4, 0xff, 0xf1, 0xfe, 0xfb, 0xf8, 0xf5, 0xf2, 0xef,
+  0xfd, 0x3b, 0xfa, 0xf7, 0x02, 0x00, 0xf4, 0xf1, 0xee, 0x05, 0x06, 0x17,
+  0x03, 0x3d, 0xff, 0x09, 0x06, 0xec, 0xfd, 0xfb, 0xf8, 0x31, 0x02, 0x0d,
+  0x00, 0x4f, 0xf3, 0xf0, 0xed, 0xea, 0x18, 0x00, 0x1c, 0x01, 0xf4, 0x30,
+  0x02, 0x36, 0x34, 0x02, 0xec, 0xe9, 0x29, 0x01, 0xff, 0xfc, 0x0c, 0x00,
+  0x32, 0x02, 0x04, 0x19, 0x02, 0x31, 0x00, 0xf3, 0x36, 0x01, 0x04, 0x04,
+  0x13, 0x02, 0x1d, 0x02, 0x0f, 0x02, 0x7c, 0x0a, 0x02, 0x4d, 0x01, 0xe7,
+  0xe4, 0xe2, 0xdf, 0xdc, 0x16, 0x01, 0xe5, 0xf0, 0x17, 0x03, 0xee, 0x74,
+  0x04, 0x18, 0x00, 0xe1, 0xde, 0xdc, 0xd9, 0xd9, 0x7b, 0x00, 0x0d, 0x01,
+  0xe9, 0xe6, 0x0d, 0x00, 0xdb, 0xd9, 0xf1, 0xd6, 0x1c, 0x06, 0x31, 0x02,
+  0x3d, 0x01, 0xe1, 0xdf, 0xdc, 0xd9, 0xf7, 0xd6, 0xd4, 0xd1, 0xd2, 0x03,
+  0xee, 0xeb, 0xe8, 0xe5, 0xa3, 0xfd, 0xfa, 0x31, 0x05, 0x72, 0x01, 0x09,
+  0x02, 0xe3, 0x5a, 0x02, 0xf0, 0xfd, 0xed, 0x1d, 0x00, 0xe2, 0xdf, 0xdd,
+  0xda, 0xd7, 0xd4, 0xff, 0xd2, 0xcf, 0xcc, 0xca, 0xc7, 0xc4, 0xc2, 0xbf,
+  0x73, 0xfc, 0xf9, 0xbe, 0x01, 0x16, 0x00, 0xe3, 0xe0, 0xdd, 0x23, 0x03,
+  0x5e, 0x0c, 0x01, 0xe2, 0xe0, 0xdd, 0xda, 0x31, 0x04, 0xea, 0x31, 0x04,
+  0xfe, 0x1c, 0x0b, 0xd7, 0xd5, 0xd2, 0xcf, 0xcd, 0xca, 0xc7, 0xff, 0xc5,
+  0xc2, 0xc0, 0xbd, 0xba, 0xb8, 0xb5, 0xb3, 0xbf, 0xb0, 0xae, 0xab, 0xa9,
+  0xa6, 0xa4, 0x31, 0x09, 0xdc, 0xf8, 0x63, 0x06, 0xf5, 0x01, 0x82, 0x02,
+  0xe0, 0xde, 0xdb, 0xd8, 0xd6, 0xff, 0xd3, 0xd0, 0xcd, 0xcb, 0xc8, 0xc6,
+  0xc3, 0xc0, 0xf3, 0xbe, 0xbb, 0xa3, 0x03, 0xe3, 0x03, 0xd6, 0xd3, 0xd1,
+  0xce, 0xff, 0xcb, 0xc9, 0xc6, 0xc3, 0xc1, 0xbe, 0xbc, 0xb9, 0xd3, 0xb7,
+  0xb4, 0x51, 0x14, 0x31, 0x03, 0xd5, 0x31, 0x07, 0xb9, 0xb6, 0x7f, 0xb4,
+  0xb1, 0xaf, 0xac, 0xaa, 0xa7, 0xa5, 0x88, 0x0f, 0x02, 0xbd, 0xbf, 0x88,
+  0x08, 0xa2, 0x9f, 0x9d, 0x9a, 0x5d, 0x1a, 0xd9, 0xff, 0xd7, 0xd4, 0xd1,
+  0xcf, 0xcc, 0xc9, 0xc7, 0xc4, 0xff, 0xc1, 0xbf, 0xbc, 0xba, 0xb7, 0xb5,
+  0xb2, 0xb0, 0xff, 0xad, 0xab, 0xa8, 0xa6, 0xa3, 0xa1, 0x9f, 0x9c, 0xff,
+  0x9a, 0x97, 0x95, 0x93, 0x90, 0x8e, 0x8c, 0x8a, 0xef, 0x87, 0x85, 0x83,
+  0x81, 0x31, 0x0f, 0x20, 0x7e, 0x7c, 0x7a, 0xff, 0x78, 0x76, 0x73, 0x71,
+  0x6f, 0x6d, 0x6b, 0x69, 0xff, 0x67, 0x65, 0x63, 0x61, 0x5f, 0x5d, 0x5b,
+  0x59, 0xf1, 0x57, 0x03, 0x22, 0x51, 0x11, 0xbe, 0x00, 0xdd, 0xda, 0xd8,
+  0xd5, 0xff, 0xd2, 0xd0, 0xcd, 0xca, 0xc8, 0xc5, 0xc3, 0xc0, 0xff, 0xbd,
+  0xbb, 0xb8, 0xb6, 0xb3, 0xb1, 0xae, 0xac, 0xff, 0xa9, 0xa7, 0xa4, 0xa2,
+  0xa0, 0x9d, 0x9b, 0x98, 0xff, 0x96, 0x94, 0x91, 0x8f, 0x8d, 0x8b, 0x88,
+  0x86, 0xff, 0x84, 0x82, 0x7f, 0x7d, 0x7b, 0x79, 0x77, 0x74, 0xff, 0x72,
+  0x70, 0x6e, 0x6c, 0x6a, 0x68, 0x66, 0x64, 0xff, 0x62, 0x60, 0x5e, 0x5c,
+  0x5a, 0x58, 0x56, 0x54, 0xff, 0x52, 0x50, 0x4e, 0x4c, 0x4a, 0x48, 0x46,
+  0x44, 0xff, 0x42, 0x41, 0x3f, 0x3d, 0x3b, 0x39, 0x37, 0x36, 0xff, 0x34,
+  0x32, 0x30, 0x2f, 0x2d, 0x2b, 0x29, 0x28, 0xff, 0x26, 0x24, 0x23, 0x21,
+  0x1f, 0x1e, 0x1c, 0x1a, 0xff, 0x19, 0x17, 0x15, 0x14, 0x12, 0x11, 0x0f,
+  0x0e, 0xff, 0x0c, 0x0b, 0x09, 0x07, 0x06, 0x04, 0x03, 0x01, 0xe9, 0x00,
+  0x35, 0x2b, 0x51, 0x14, 0xc4, 0x51, 0x13, 0xb2, 0xaf, 0xad, 0xff, 0xaa,
+  0xa8, 0xa5, 0xa3, 0xa1, 0x9e, 0x9c, 0x99, 0xff, 0x97, 0x95, 0x92, 0x90,
+  0x8e, 0x8b, 0x89, 0x87, 0x37, 0x85, 0x82, 0x80, 0xbe, 0x00, 0x77, 0x75,
+  0xbe, 0x04, 0x77, 0x08, 0xff, 0x4f, 0x4d, 0x4b, 0x49, 0x47, 0x45, 0x43,
+  0x41, 0xff, 0x3f, 0x3e, 0x3c, 0x3a, 0x38, 0x36, 0x35, 0x33, 0xff, 0x31,
+  0x2f, 0x2e, 0x2c, 0x2a, 0x28, 0x27, 0x25, 0xff, 0x23, 0x22, 0x20, 0x1e,
+  0x1d, 0x1b, 0x19, 0x18, 0xff, 0x16, 0x15, 0x13, 0x11, 0x10, 0x0e, 0x0d,
+  0x0b, 0xff, 0x0a, 0x08, 0x07, 0x00, 0x70, 0xb5, 0x86, 0xb0, 0xb7, 0x05,
+  0xf0, 0x9a, 0x49, 0xb0, 0x14, 0x19, 0x03, 0x00, 0x49, 0xff, 0x00, 0x20,
+  0x08, 0x60, 0x20, 0x70, 0x60, 0x70, 0xff, 0xa0, 0x71, 0x60, 0x71, 0x20,
+  0x61, 0xe0, 0x61, 0xff, 0x20, 0x72, 0x20, 0x71, 0x00, 0x21, 0x04, 0xf1,
+  0xff, 0x0c, 0x00, 0xa1, 0x70, 0x01, 0x60, 0xe1, 0x70, 0xff, 0xa1, 0x62,
+  0x21, 0x62, 0x04, 0xf5, 0x45, 0x75, 0xef, 0x4f, 0xf4, 0xfc, 0x61, 0x93,
+  0x51, 0x78, 0xf9, 0x64, 0xfa, 0x1d, 0x00, 0x30, 0x89, 0x60, 0x73, 0xf9,
+  0x00, 0x20, 0xad, 0xf7, 0xa1, 0x54, 0x22, 0x9b, 0x90, 0x43, 0x03, 0xf5,
+  0x45, 0xff, 0x76, 0x40, 0x1c, 0x03, 0xf5, 0x5a, 0x73, 0x17, 0x7f, 0x28,
+  0x73, 0x61, 0xf1, 0x64, 0xf4, 0xd3, 0x15, 0x00, 0xef, 0x40, 0x00, 0xf5,
+  0x45, 0x8b, 0x90, 0x42, 0x61, 0xc1, 0xff, 0x64, 0x65, 0x62, 0xe2, 0x62,
+  0x04, 0xf1, 0x94, 0x5f, 0x05, 0x4f, 0xf4, 0xa0, 0x71, 0x45, 0x01, 0x55,
+  0x3b, 0x00, 0xff, 0x00, 0x23, 0x04, 0xeb, 0x00, 0x11, 0x01, 0xf1, 0xff,
+  0x94, 0x02, 0x40, 0x1c, 0xa4, 0x31, 0x13, 0x28, 0xbf, 0x13, 0x70, 0x51,
+  0x60, 0xf5, 0xd3, 0x13, 0x00, 0x10, 0x7f, 0x00, 0xf8, 0x94, 0x3f, 0x43,
+  0x60, 0x65, 0xb1, 0xb0, 0xfe, 0x7b, 0x90, 0xf0, 0x5c, 0xfd, 0x03, 0x21,
+  0x04, 0x91, 0xff, 0x00, 0x21, 0x03, 0x91, 0x80, 0x21, 0x02, 0x91, 0xf7,
+  0x4f, 0xf6, 0xff, 0xb9, 0x80, 0x64, 0x08, 0x01, 0x90, 0xfe, 0x40, 0x40,
+  0xf5, 0xfe, 0x72, 0x18, 0x23, 0x00, 0x21, 0xff, 0x0f, 0xf2, 0xc1, 0x30,
+  0x00, 0xf0, 0x0d, 0xfe, 0x7f, 0x05, 0xaa, 0x0f, 0xf2, 0x14, 0x01, 0x18,
+  0x55, 0x60, 0xff, 0xbe, 0xfe, 0x01, 0xf0, 0x74, 0xf8, 0xc0, 0x46, 0xff,
+  0xc0, 0x46, 0x06, 0xb0, 0x70, 0xbd, 0x75, 0x43, 0xff, 0x2f, 0x4f, 0x53,
+  0x2d, 0x49, 0x49, 0x20, 0x49, 0xf7, 0x64, 0x6c, 0x65, 0x1e, 0x50, 0x38,
+  0xb5, 0x00, 0xf0, 0xcf, 0x31, 0xf8, 0x1e, 0xd1, 0xbb, 0xa0, 0xdd, 0xc0,
+  0x20, 0x78, 0xff, 0x08, 0xb1, 0x40, 0x1e, 0x20, 0x70, 0x20, 0x78, 0xff,
+  0x61, 0x78, 0x08, 0x43, 0x11, 0xd1, 0x00, 0xf0, 0xff, 0x2c, 0xf9, 0xe0,
+  0x78, 0xa2, 0x78, 0x04, 0xeb, 0xff, 0x80, 0x01, 0x90, 0x42, 0x09, 0x6b,
+  0xa1, 0x62, 0xff, 0x07, 0xd0, 0x88, 0x6b, 0x40, 0x1c, 0x88, 0x63, 0xed,
+  0x20, 0x47, 0xc0, 0x20, 0x61, 0x35, 0x01, 0x28, 0x46, 0x15, 0xef, 0xe1,
+  0x31, 0xbd, 0x10, 0x47, 0x00, 0x0d, 0xf8, 0x0a, 0xfe, 0x47, 0x00, 0x64,
+  0xfe, 0x21, 0x78, 0x21, 0xb9, 0x61, 0xff, 0x78, 0xff, 0x29, 0x1c, 0xbf,
+  0x49, 0x1c, 0x61, 0xee, 0x93, 0xd0, 0xe3, 0xbe, 0x10, 0x57, 0xa0, 0xb4,
+  0x47, 0x60, 0xff, 0x79, 0x01, 0x28, 0x70, 0x47, 0x10, 0xb5, 0xff, 0xaf,
+  0xf7, 0xf8, 0xff, 0x10, 0x29, 0x00, 0x4f, 0x29, 0x00, 0x51, 0xfe, 0x29,
+  0x00, 0x41, 0xb1, 0x49, 0x1e, 0x61, 0x70, 0xc9, 0xef, 0xb2, 0x21, 0xb9,
+  0x80, 0xf1, 0xa0, 0xbd, 0xe8, 0x10, 0xbf, 0x40, 0xcf, 0xe0, 0x00, 0xf0,
+  0xc8, 0x35, 0x00, 0x10, 0xef, 0xb5, 0xdf, 0xf8, 0x7c, 0x37, 0x00, 0x60,
+  0xb9, 0x00, 0x7f, 0xf0, 0xe7, 0xf8, 0xe0, 0x78, 0xa0, 0x70, 0x89, 0x00,
+  0x7f, 0x00, 0x00, 0x6b, 0xa0, 0x62, 0x20, 0x62, 0x27, 0x01, 0xf7, 0x05,
+  0xf0, 0x36, 0x25, 0x00, 0x70, 0xb5, 0x05, 0xf0, 0xb5, 0x02, 0x25, 0xd0,
+  0x27, 0xc9, 0x10, 0x4c, 0x17, 0x03, 0x00, 0x47, 0x3f, 0x0a, 0x68, 0x52,
+  0x1c, 0x0a, 0x60, 0x4d, 0x01, 0x73, 0x01, 0xbf, 0x35, 0xd1, 0xe0, 0x79,
+  0x38, 0xb1, 0xc7, 0xa0, 0xd0, 0xaf, 0x30, 0xd3, 0x01, 0xe0, 0xb7, 0x50,
+  0xe0, 0x5b, 0xa0, 0x71, 0xff, 0xe6, 0x6a, 0x12, 0xe0, 0x69, 0x77, 0x29,
+  0x7f, 0xff, 0x09, 0x07, 0x0b, 0xd4, 0x06, 0xf1, 0x34, 0x01, 0xff, 0x22,
+  0x79, 0x8b, 0x78, 0x1a, 0x43, 0x22, 0x71, 0xff, 0x0a, 0x78, 0x49, 0x78,
+  0x12, 0x19, 0x13, 0x7b, 0xbf, 0x19, 0x43, 0x11, 0x73, 0x2e, 0x68, 0x43,
+  0x01, 0x06, 0xff, 0xf1, 0x14, 0x05, 0xa8, 0x7f, 0x18, 0x28, 0x11, 0xff,
+  0xd0, 0x05, 0xf0, 0xf5, 0xfd, 0xa9, 0x69, 0x00, 0xff, 0x29, 0xf2, 0xd0,
+  0x49, 0x1e, 0xa9, 0x61, 0xef, 0xef, 0xd1, 0x29, 0x7f, 0x37, 0x29, 0xb0,
+  0x1d, 0xbf, 0x01, 0xdf, 0xf0, 0xc8, 0x01, 0x29, 0x77, 0xf9, 0x60, 0x21,
+  0xd5, 0xff, 0xe7, 0x70, 0xbd, 0xf8, 0xb5, 0x85, 0x7a, 0x0f, 0xff, 0xf2,
+  0x38, 0x14, 0xdf, 0xf8, 0xc0, 0x76, 0x2e, 0xff, 0x5d, 0x35, 0x18, 0x4f,
+  0xf0, 0x00, 0x0e, 0xed, 0xff, 0x7a, 0x2c, 0x5d, 0x04, 0xeb, 0xc6, 0x05,
+  0xed, 0xff, 0xb2, 0x07, 0xeb, 0x85, 0x04, 0x24, 0x6b, 0x04, 0xef, 0xf1,
+  0x20, 0x0c, 0xcc, 0x93, 0xe0, 0xcc, 0xf8, 0x0c, 0xbf, 0xe0, 0x8c, 0xf8,
+  0x11, 0x30, 0x9c, 0x1d, 0xa0, 0x91, 0xf3, 0x43, 0x8c, 0x05, 0x00, 0x09,
+  0x01, 0x09, 0x07, 0x0a, 0xd4, 0xff, 0x39, 0x79, 0x9c, 0xf8, 0x16, 0x20,
+  0x11, 0x43, 0xff, 0x39, 0x71, 0xf1, 0x19, 0x9c, 0xf8, 0x15, 0x30, 0xbf,
+  0x0a, 0x7b, 0x1a, 0x43, 0x0a, 0x73, 0x7b, 0xc1, 0x00, 0xbf, 0xf0, 0x26,
+  0xf8, 0x28, 0x46, 0xf2, 0x1d, 0x12, 0x60, 0xff, 0x16, 0x0a, 0x6a, 0x42,
+  0xf8, 0x1c, 0x0f, 0x13, 0xff, 0x7e, 0x52, 0x7e, 0x1b, 0x18, 0xdc, 0x7a,
+  0x22, 0xff, 0x43, 0xda, 0x72, 0x0b, 0x6a, 0x82, 0x7a, 0x93, 0xff, 0xf8,
+  0x36, 0x30, 0x1a, 0x43, 0x82, 0x72, 0x08, 0xff, 0x6a, 0x10, 0xf8, 0x34,
+  0x2f, 0x44, 0x78, 0x52, 0xff, 0x18, 0x13, 0x7b, 0xa3, 0x43, 0x13, 0x73,
+  0x04, 0xff, 0xd1, 0x0a, 0x79, 0x80, 0x78, 0x22, 0xea, 0x00, 0xaf, 0x00,
+  0x08, 0x71, 0x10, 0x37, 0xc0, 0x3f, 0x03, 0x20, 0x10, 0xfd, 0xb5, 0x23,
+  0x05, 0xd3, 0x7a, 0xa3, 0x43, 0xd3, 0x72, 0x6f, 0x04, 0xd1, 0x8a, 0x7a,
+  0x23, 0x03, 0x88, 0x72, 0x23, 0x00, 0xff, 0x21, 0x81, 0x72, 0x0b, 0x30,
+  0x04, 0x21, 0x01, 0xbf, 0xf0, 0x2f, 0xb8, 0x00, 0x29, 0x18, 0xeb, 0x00,
+  0x2b, 0xef, 0xb8, 0x70, 0x47, 0x38, 0x73, 0x10, 0x6f, 0xfd, 0xdf, 0xff,
+  0xf8, 0xe0, 0x55, 0x69, 0x78, 0x04, 0x46, 0x28, 0xfe, 0x2d, 0x24, 0x15,
+  0xf8, 0xe8, 0x78, 0xaa, 0x78, 0x05, 0xaa, 0x2d, 0x24, 0xa9, 0x2d, 0x26,
+  0x28, 0x2d, 0x20, 0x28, 0x2d, 0x20, 0x6d, 0xab, 0xfd, 0x20, 0xb3, 0x80,
+  0x32, 0xb7, 0x10, 0x57, 0x11, 0x20, 0xa4, 0xfd, 0x05, 0xa3, 0x21, 0x02,
+  0x79, 0x52, 0x5c, 0x13, 0x18, 0xff, 0x1b, 0x7b, 0x59, 0x5c, 0x01, 0xeb,
+  0xc2, 0x01, 0xbb, 0xc1, 0x70, 0xb5, 0x71, 0x01, 0x00, 0x02, 0x03, 0x00,
+  0x03, 0xaa, 0x07, 0x04, 0x04, 0x0f, 0x0c, 0x05, 0x1f, 0x0f, 0x0d, 0x06,
+  0x3f, 0x0f, 0x2d, 0x07, 0xea, 0x7f, 0x0f, 0x6d, 0x80, 0x5b, 0x10, 0xc1,
+  0xbf, 0xe0, 0x84, 0x14, 0xca, 0xdf, 0x69, 0x52, 0x1c, 0xca, 0x61, 0x83,
+  0x21, 0x05, 0xf0, 0xef, 0x4e, 0xfc, 0xf3, 0xe7, 0x95, 0xa1, 0x04, 0x46,
+  0x0f, 0xaf, 0x46, 0x91, 0x46, 0x98, 0x53, 0xb0, 0xaf, 0x23, 0x00, 0x60,
+  0xff, 0x54, 0x6e, 0x6a, 0x00, 0x2e, 0x58, 0xd0, 0x71, 0xf7, 0x69, 0x69,
+  0x62, 0x27, 0x01, 0x37, 0x60, 0x00, 0x20, 0xff, 0x06, 0xf1, 0x30, 0x07,
+  0xbc, 0x70, 0x38, 0x70, 0xff, 0x78, 0x70, 0xf0, 0x62, 0x01, 0x22, 0x09,
+  0x98, 0xff, 0x70, 0x60, 0x04, 0xf0, 0x07, 0x01, 0x08, 0x98, 0xff, 0xf0,
+  0x60, 0xc6, 0xf8, 0x08, 0x90, 0x0a, 0x98, 0xff, 0x30, 0x82, 0xa6, 0xf8,
+  0x12, 0x80, 0x00, 0x20, 0xff, 0xf8, 0x71, 0xf9, 0x70, 0xe0, 0x08, 0x38,
+  0x71, 0xf5, 0x02, 0x97, 0xd0, 0xb8, 0x05, 0x00, 0x01, 0xf0, 0x78, 0x71,
+  0xff, 0x00, 0x20, 0xf0, 0x61, 0x70, 0x62, 0x30, 0x62, 0xff, 0xb8, 0x60,
+  0x38, 0x61, 0xf8, 0x60, 0x78, 0x61, 0xff, 0xb8, 0x61, 0x4d, 0xa0, 0xf8,
+  0x61, 0x00, 0x20, 0xeb, 0x38, 0x62, 0xc5, 0xb1, 0x4d, 0xc7, 0xe0, 0x74,
+  0xfc, 0x05, 0x9f, 0xeb, 0x84, 0x01, 0x0e, 0x63, 0x6d, 0x01, 0x13, 0x01,
+  0xfe, 0xff, 0xfb, 0x05, 0xf0, 0x6a, 0xfc, 0xe9, 0x6a, 0x71, 0xff, 0x61,
+  0x00, 0x21, 0xb1, 0x61, 0xe9, 0x6a, 0x01, 0xff, 0xb1, 0x8e, 0x61, 0xee,
+  0x62, 0x29, 0x79, 0xba, 0xff, 0x79, 0x11, 0x43, 0x29, 0x71, 0x39, 0x79,
+  0x7b, 0xf7, 0x79, 0x49, 0x19, 0xbb, 0x23, 0xa9, 0x79, 0x49, 0x1c, 0xd3,
+  0xa9, 0x71, 0x37, 0x01, 0x89, 0xa0, 0xe0, 0x07, 0x01, 0x42, 0x20, 0xf4,
+  0xc1, 0xa1, 0x82, 0x20, 0x00, 0x11, 0xc0, 0x41, 0x05, 0x46, 0x88, 0xfe,
+  0x49, 0x20, 0x05, 0x28, 0x17, 0x46, 0x1c, 0x46, 0x02, 0xff, 0xd0, 0x00,
+  0xf0, 0x7c, 0xfa, 0x36, 0xe0, 0x38, 0xff, 0x06, 0x46, 0xbf, 0x07, 0xf0,
+  0x7f, 0x07, 0x01, 0xff, 0x26, 0x00, 0x26, 0x00, 0x20, 0x20, 0x70, 0x05,
+  0xff, 0xf0, 0x34, 0xfc, 0x03, 0x2f, 0x24, 0xd8, 0xdf, 0xff, 0xe8, 0x07,
+  0xf0, 0x15, 0x1b, 0x02, 0x0c, 0x29, 0xff, 0x89, 0x08, 0xea, 0x01, 0x07,
+  0x47, 0x45, 0x08, 0xdf, 0xd0, 0x70, 0x21, 0x21, 0x70, 0x53, 0x01, 0x1b,
+  0xe0, 0xf7, 0x29, 0x89, 0x18, 0x13, 0x00, 0xf6, 0xd0, 0x00, 0x2e, 0xff,
+  0xf6, 0xd0, 0xb9, 0x43, 0x29, 0x81, 0xf3, 0xe7, 0x77, 0x29, 0x89, 0x28,
+  0x25, 0x02, 0xec, 0xd1, 0x03, 0x1d, 0x00, 0xf5, 0x38, 0x0b, 0x00, 0xe7,
+  0x1d, 0x00, 0xe7, 0xd0, 0x39, 0x43, 0xfb, 0xef, 0xe7, 0x33, 0x01, 0x6f,
+  0x20, 0x00, 0x27, 0x20, 0xdb, 0x70, 0x38, 0x05, 0xc1, 0x81, 0xf8, 0x55,
+  0x30, 0x08, 0x73, 0xff, 0x06, 0x46, 0x38, 0x78, 0x0c, 0x46, 0x10, 0xb1,
+  0xfd, 0x10, 0x41, 0x50, 0xb2, 0xbd, 0x05, 0xf0, 0xf9, 0xfb, 0xff, 0xb9,
+  0x69, 0x0d, 0x00, 0x0c, 0xd0, 0x49, 0x68, 0xff, 0xb9, 0x61, 0x05, 0x21,
+  0x29, 0x70, 0x2e, 0x81, 0x7f, 0x00, 0x21, 0x69, 0x60, 0x06, 0xa1, 0xe9,
+  0x65, 0x42, 0x7e, 0xcf, 0x05, 0x72, 0x20, 0xff, 0xe7, 0x20, 0x70, 0x9b,
+  0x31, 0xfc, 0x57, 0x31, 0xad, 0x10, 0x4f, 0x86, 0xb0, 0xdf, 0xf8, 0x3c,
+  0xff, 0x65, 0x10, 0x9d, 0x04, 0x46, 0x30, 0x78, 0x8a, 0xff, 0x46, 0x93,
+  0x46, 0x08, 0xb1, 0x02, 0x20, 0x7a, 0xfb, 0xe0, 0x70, 0x67, 0x50, 0x0d,
+  0x20, 0x76, 0xe0, 0x20, 0xfc, 0xed, 0x00, 0x51, 0x30, 0x20, 0x71, 0xd1,
+  0x5f, 0xea, 0x0b, 0xff, 0x60, 0x46, 0xbf, 0x0b, 0xf0, 0x7f, 0x0b, 0x4f,
+  0xf7, 0xf0, 0x01, 0x08, 0x31, 0x40, 0x08, 0x05, 0xf0, 0xbf, 0xff, 0xfb,
+  0xbb, 0xf1, 0x03, 0x0f, 0x81, 0x46, 0x5f, 0xfe, 0xed, 0x00, 0x0b, 0xf0,
+  0x33, 0x39, 0x02, 0x2a, 0x20, 0xff, 0x89, 0x0a, 0xea, 0x00, 0x07, 0x57,
+  0x45, 0x26, 0xff, 0xd0, 0x06, 0x98, 0x00, 0x90, 0x5b, 0x46, 0x52, 0xd7,
+  0x46, 0x01, 0xa9, 0x0f, 0x41, 0xae, 0x95, 0xd0, 0x30, 0xf9, 0xf7, 0xff,
+  0xf7, 0x34, 0x05, 0x50, 0xa4, 0xfb, 0x81, 0x46, 0xff, 0x30, 0x6a, 0x28,
+  0x30, 0x47, 0x7a, 0x57, 0xb3, 0xfe, 0x43, 0xc0, 0x72, 0x01, 0xa8, 0x00,
+  0xf0, 0x0b, 0xf9, 0xbf, 0x31, 0x6a, 0x00, 0x20, 0x81, 0xf8, 0xab, 0x61,
+  0x1c, 0xff, 0xf9, 0x02, 0x2f, 0x14, 0xbf, 0x0a, 0x20, 0x0e, 0xbf, 0x20,
+  0x36, 0xe0, 0x20, 0x89, 0x1a, 0x4f, 0x00, 0xd8, 0xfb, 0xd0, 0xb8, 0x77,
+  0xc0, 0x10, 0xd0, 0xb8, 0x43, 0x0d, 0xea, 0x11, 0x00, 0x2a, 0x61, 0x02,
+  0xce, 0x29, 0x10, 0x20, 0x89, 0x3a, 0xfa, 0x0b, 0x00, 0xc9, 0x1d, 0x02,
+  0x01, 0xd0, 0x38, 0x43, 0x20, 0xff, 0x81, 0x30, 0x6a, 0x07, 0x85, 0x0d,
+  0xe0, 0x07, 0xfd, 0x88, 0x11, 0x01, 0x09, 0xd0, 0xbb, 0xf1, 0x01, 0x0f,
+  0xef, 0x0e, 0xd9, 0xab, 0xf1, 0xb3, 0x20, 0x28, 0x0d, 0xd8, 0xf7, 0x20,
+  0x89, 0xb8, 0x21, 0x00, 0x00, 0xf0, 0xec, 0xf8, 0xd7, 0x00, 0x20, 0x28,
+  0x4b, 0x10, 0x07, 0x01, 0xe2, 0x20, 0x89, 0xff, 0x38, 0x43, 0xf3, 0xe7,
+  0x00, 0xf0, 0xe1, 0xf8, 0x0d, 0x6f, 0x15, 0x00, 0x00, 0x20, 0x0b, 0x00,
+  0xeb, 0x12, 0xc5, 0x21, 0xfd, 0x01, 0xaf, 0x16, 0x46, 0x1d, 0x46, 0x01,
+  0x11, 0x3a, 0x0f, 0x60, 0x47, 0xff, 0xfb, 0x80, 0x46, 0x16, 0xb1, 0x01,
+  0x2e, 0x06, 0xf3, 0xd0, 0x08, 0x7b, 0x00, 0x4d, 0x02, 0x27, 0x66, 0x68,
+  0x13, 0xee, 0x0b, 0x00, 0x38, 0x43, 0xf8, 0xa7, 0x12, 0x71, 0x20, 0x26,
+  0xff, 0xe0, 0x30, 0x8a, 0x21, 0x89, 0x01, 0x40, 0x81, 0xbf, 0x42, 0x06,
+  0xd1, 0x00, 0x22, 0x30, 0xfb, 0x00, 0x7f, 0xff, 0xf8, 0x01, 0x28, 0x08,
+  0xbf, 0x01, 0x27, 0x36, 0xff, 0x68, 0xde, 0xb1, 0xb0, 0x7c, 0x03, 0x28,
+  0x12, 0xfe, 0x2d, 0x10, 0x00, 0xf0, 0x08, 0x0d, 0x02, 0x03, 0xe9, 0xff,
+  0xe7, 0x20, 0x89, 0x31, 0x8a, 0x01, 0x40, 0xf1, 0xf7, 0xd0, 0xe9, 0xe7,
+  0x35, 0x01, 0x20, 0xea, 0x01, 0x01, 0xdd, 0xe2, 0x13, 0x02, 0x81, 0x43,
+  0xf4, 0x93, 0x00, 0x4e, 0xfa, 0xfa, 0x93, 0x03, 0x0c, 0x6d, 0x60, 0x48,
+  0xfa, 0x0f, 0xb1, 0xff, 0xff, 0xf7, 0x94, 0xfd, 0x05, 0xf0, 0x04, 0xfb,
+  0x24, 0xed, 0x89, 0xd3, 0x13, 0x28, 0x70, 0xad, 0x41, 0xf0, 0x81, 0x70,
+  0xfe, 0x11, 0x20, 0x78, 0x43, 0x25, 0x6a, 0x95, 0xf8, 0x30, 0xbf, 0x60,
+  0x46, 0xf0, 0x20, 0x06, 0x85, 0x07, 0x00, 0x00, 0xff, 0x25, 0x26, 0x6a,
+  0x86, 0xf8, 0x31, 0x50, 0x25, 0xff, 0x6a, 0x04, 0x9e, 0xee, 0x62, 0x69,
+  0x62, 0x0a, 0xff, 0x82, 0x8b, 0x74, 0x22, 0x6a, 0x8a, 0x60, 0x43, 0xff,
+  0x68, 0x0b, 0x60, 0xc8, 0x60, 0x00, 0x23, 0x4b, 0xfe, 0x09, 0x00, 0x03,
+  0xb1, 0x59, 0x60, 0x41, 0x60, 0x02, 0xbb, 0xf1, 0x34, 0x8c, 0xf0, 0x43,
+  0x78, 0x09, 0x05, 0x30, 0x9a, 0xae, 0x05, 0x30, 0x04, 0xd1, 0x21, 0x81,
+  0x50, 0x21, 0x5d, 0x50, 0x20, 0x7d, 0x71, 0x3b, 0xd1, 0x27, 0x4c, 0x04,
+  0xf5, 0xea, 0x53, 0x80, 0xfe, 0x0d, 0x81, 0xff, 0xf7, 0x4e, 0xfd, 0x00,
+  0x20, 0x23, 0xf7, 0xa1, 0x00, 0x26, 0xfb, 0x70, 0x12, 0x02, 0xf5, 0xea,
+  0xff, 0x73, 0x40, 0x1c, 0x02, 0xf5, 0xf2, 0x72, 0x13, 0xff, 0x28, 0x1e,
+  0x70, 0x5a, 0x60, 0xd9, 0x60, 0xf3, 0xfe, 0x13, 0x83, 0xf5, 0xea, 0x70,
+  0x06, 0x70, 0x46, 0x60, 0xdf, 0xc1, 0x60, 0xa5, 0x61, 0x70, 0x05, 0x60,
+  0x83, 0x68, 0xff, 0x28, 0x33, 0x00, 0x24, 0x19, 0x80, 0x5c, 0x60, 0xff,
+  0x5a, 0x72, 0x19, 0x7a, 0x01, 0xf0, 0xdf, 0x01, 0xed, 0x19, 0x07, 0x00,
+  0x61, 0xb9, 0x7f, 0x60, 0x12, 0x9c, 0x7b, 0xff, 0x0a, 0x79, 0x22, 0x43,
+  0x0a, 0x71, 0x01, 0x24, 0xbf, 0x1a, 0x7b, 0x5b, 0x7b, 0x51, 0x18, 0x89,
+  0x33, 0x00, 0xff, 0xf0, 0x02, 0xf8, 0x20, 0x46, 0x10, 0xbd, 0x41, 0xff,
+  0x68, 0x02, 0x68, 0x21, 0xb9, 0xc1, 0x68, 0x4a, 0xff, 0x60, 0x22, 0xb1,
+  0x00, 0x21, 0x01, 0xe0, 0x0a, 0x7f, 0x60, 0x02, 0xb1, 0x51, 0x60, 0x80,
+  0x68, 0x37, 0x20, 0xff, 0x62, 0x70, 0x47, 0x84, 0xf3, 0x00, 0x20, 0x18,
+  0x37, 0xbd, 0x00, 0x20, 0xcb, 0x21, 0x68, 0x7a, 0x13, 0xd0, 0xed, 0x30,
+  0x7b, 0x7b, 0xba, 0xbd, 0x11, 0xdf, 0xf8, 0x68, 0x62, 0xd1, 0x21, 0xfd,
+  0x88, 0xcf, 0x20, 0x00, 0x20, 0x2e, 0xe0, 0x05, 0xf0, 0xbf, 0x69, 0xfa,
+  0x71, 0x69, 0x0f, 0x00, 0xf1, 0x70, 0x68, 0xfd, 0x71, 0xe7, 0x50, 0x68,
+  0xfa, 0x1f, 0xb3, 0x05, 0xf0, 0xfb, 0x5f, 0xfa, 0xf5, 0x70, 0x15, 0x0a,
+  0x68, 0x15, 0x00, 0xef, 0x16, 0xd0, 0x12, 0x68, 0x8f, 0x73, 0x6c, 0x60,
+  0x04, 0xff, 0xeb, 0x88, 0x00, 0xa8, 0x60, 0xec, 0x60, 0x2c, 0xef, 0x61,
+  0xa5, 0xf8, 0x14, 0x85, 0x40, 0xe8, 0x82, 0x02, 0xfb, 0x20, 0x38, 0x85,
+  0x10, 0x38, 0x81, 0x7d, 0x60, 0x38, 0xfe, 0x01, 0x10, 0xc7, 0xfc, 0x05,
+  0xe0, 0x71, 0x69, 0x79, 0x5b, 0x60, 0x77, 0xf7, 0x42, 0x00, 0x27, 0x95,
+  0x33, 0x10, 0x33, 0xe0, 0xfe, 0xed, 0x70, 0xfa, 0x61, 0x68, 0x4a, 0x68,
+  0xca, 0x60, 0xff, 0x4a, 0x68, 0x0a, 0x61, 0x00, 0x22, 0xca, 0x82, 0x76,
+  0xa7, 0x13, 0x10, 0xbd, 0x93, 0x01, 0x07, 0x46, 0x0e, 0xb3, 0x30, 0xf7,
+  0x02, 0x28, 0x14, 0x4f, 0x22, 0x07, 0xd1, 0x71, 0x4d, 0x7c, 0x95, 0x60,
+  0x6d, 0x30, 0x02, 0xe0, 0x68, 0x78, 0x18, 0x6d, 0x30, 0xf5, 0x20, 0x63,
+  0x00, 0x50, 0xa9, 0x00, 0x14, 0xfa, 0x80, 0x46, 0xff, 0x78, 0x68, 0xc1,
+  0x8a, 0x89, 0xb1, 0x02, 0x69, 0xff, 0x12, 0x1d, 0x02, 0x61, 0x49, 0x1e,
+  0x52, 0xf8, 0xff, 0x04, 0x7d, 0x82, 0x68, 0xc1, 0x82, 0x01, 0x69, 0x7f,
+  0x91, 0x42, 0x04, 0xbf, 0x41, 0x68, 0x01, 0x6d, 0x90, 0xfd, 0x40, 0x95,
+  0x90, 0x20, 0x70, 0x37, 0xe0, 0x28, 0x6a, 0xff, 0x90, 0xf8, 0x30, 0x10,
+  0x41, 0xf0, 0x04, 0x01, 0xfd, 0x80, 0x07, 0x00, 0x00, 0x20, 0x29, 0x6a,
+  0x81, 0xf8, 0xbf, 0x31, 0x00, 0x28, 0x6a, 0xc6, 0x62, 0xab, 0x01, 0x3e,
+  0xaf, 0xfc, 0x00, 0xf0, 0x2b, 0x77, 0x30, 0x78, 0x17, 0x50, 0xe8, 0xff,
+  0xf9, 0x06, 0x46, 0x28, 0x6a, 0x00, 0xf1, 0x20, 0xff, 0x01, 0x4a, 0x7c,
+  0x12, 0xb1, 0x02, 0x2a, 0x03, 0xff, 0xd0, 0x05, 0xe0, 0x0f, 0x68, 0x00,
+  0x20, 0x07, 0xff, 0xe0, 0x00, 0x27, 0x0e, 0x20, 0x04, 0xe0, 0x39, 0x3e,
+  0x2f, 0x00, 0x4a, 0xfc, 0x00, 0x27, 0x0a, 0x89, 0x02, 0x47, 0x01, 0xfb,
+  0x30, 0x00, 0x4d, 0x03, 0x00, 0x21, 0x28, 0x6a, 0xc1, 0x7f, 0x61, 0x01,
+  0x62, 0x00, 0xf0, 0x69, 0xf8, 0xed, 0x03, 0xfd, 0x01, 0x23, 0x02, 0x70,
+  0x47, 0x70, 0xb5, 0x06, 0x46, 0xe9, 0x0c, 0x67, 0x10, 0xbb, 0x81, 0x01,
+  0x01, 0xf0, 0x05, 0xf0, 0xb5, 0xff, 0xf9, 0x05, 0x46, 0xb0, 0x7a, 0x30,
+  0xb1, 0x00, 0xfb, 0xf0, 0x46, 0xf3, 0x30, 0x4e, 0xf8, 0xff, 0xf7, 0x3a,
+  0xef, 0xfc, 0x14, 0xe0, 0x70, 0xcf, 0x00, 0x82, 0x8a, 0x91, 0xff, 0x42,
+  0x00, 0xd3, 0x40, 0xe0, 0xc2, 0x68, 0x12, 0xff, 0x1d, 0xc2, 0x60, 0x49,
+  0x1c, 0x42, 0xf8, 0x04, 0xd7, 0x4d, 0xc1, 0x82, 0xd7, 0x00, 0x68, 0xd5,
+  0x03, 0xc1, 0x60, 0x47, 0x00, 0xf0, 0x36, 0x9b, 0x30, 0x73, 0x21, 0x55,
+  0x0d, 0x8a, 0x55, 0x06, 0x75, 0x1b, 0x55, 0x00, 0x23, 0x55, 0x00, 0x0f,
+  0xfc, 0x13, 0x55, 0x08, 0x7f, 0x15, 0xe0, 0x02, 0x69, 0x43, 0x68, 0x9a,
+  0x47, 0x00, 0xef, 0x82, 0x68, 0x02, 0x61, 0x37, 0x10, 0x1f, 0x02, 0x61,
+  0x7d, 0x14, 0x63, 0x00, 0xc1, 0x82, 0x00, 0xf0, 0x0c, 0x53, 0x02, 0xde,
+  0xc1, 0xa0, 0x22, 0x21, 0x46, 0x30, 0xe3, 0x00, 0x80, 0xbb, 0x6c, 0x5d,
+  0x21, 0x44, 0xa0, 0xbd, 0x28, 0xb1, 0x10, 0x63, 0xb9, 0x23, 0x61, 0xfb,
+  0x60, 0xb9, 0xab, 0x82, 0x46, 0x4f, 0xf4, 0x90, 0x71, 0xf6, 0xe1, 0xf1,
+  0xdb, 0xfb, 0x59, 0x20, 0x21, 0x01, 0xfb, 0x00, 0xff, 0xf2, 0x13, 0x19,
+  0x18, 0x33, 0x40, 0x1c, 0x13, 0xdf, 0x51, 0x0b, 0x28, 0xf7, 0xd3, 0x0f,
+  0x00, 0x40, 0x00, 0x77, 0x22, 0x02, 0x60, 0xf3, 0x90, 0x03, 0x04, 0x60,
+  0x9d, 0x81, 0x6b, 0x00, 0x00, 0x7f, 0x21, 0x70, 0x5b, 0xa0, 0x17, 0xf8,
+  0x69, 0x21, 0xbe, 0xab, 0x01, 0x34, 0xf9, 0x69, 0x69, 0x0e, 0x69, 0x22,
+  0x69, 0xfe, 0x69, 0x20, 0x33, 0xf9, 0x3e, 0xb1, 0x03, 0x20, 0x30, 0xd7,
+  0x70, 0x34, 0x81, 0x1d, 0x00, 0x60, 0x7f, 0x01, 0xa7, 0xfb, 0xb7, 0x30,
+  0x46, 0x70, 0x5d, 0x80, 0x20, 0x57, 0x97, 0x81, 0x70, 0xed, 0x47, 0x47,
+  0x70, 0x77, 0x38, 0x07, 0x00, 0x01, 0x22, 0x00, 0xed, 0x21, 0x7b, 0x01,
+  0x30, 0xbb, 0x2d, 0x21, 0x00, 0xf0, 0x52, 0xfd, 0xf8, 0x27, 0x21, 0x12,
+  0xd1, 0xff, 0xf7, 0xee, 0xff, 0xae, 0x27, 0x21, 0x0d, 0xe0, 0x78, 0x95,
+  0x52, 0x09, 0x23, 0x20, 0x02, 0xbf, 0xf9, 0x80, 0x46, 0x28, 0x89, 0x30,
+  0x0b, 0xb0, 0x28, 0xfa, 0xd1, 0x40, 0x3a, 0xe1, 0x00, 0x20, 0x70, 0x34,
+  0xe0, 0x38, 0x2a, 0x0b, 0x24, 0x01, 0x0b, 0x24, 0x39, 0xbd, 0x12, 0x38,
+  0x0b, 0x20, 0xb9, 0x31, 0xd5, 0x38, 0x9f, 0xb0, 0x25, 0x39, 0x10, 0x72,
+  0x0f, 0x70, 0xe2, 0xf8, 0xfc, 0x3f, 0x60, 0x2d, 0x00, 0x31, 0x10, 0x11,
+  0xb1, 0x02, 0x29, 0xf7, 0x02, 0xd0, 0x03, 0x71, 0xa0, 0x05, 0xe0, 0x0e,
+  0x20, 0xcc, 0x7d, 0x60, 0x29, 0x00, 0x47, 0xfb, 0x03, 0x23, 0x3f, 0x01,
+  0x30, 0x00, 0xbe, 0x45, 0x03, 0x39, 0x6a, 0xc8, 0x61, 0x30, 0xfb, 0x11,
+  0x41, 0xaf, 0x05, 0xf0, 0xc9, 0xb8, 0x03, 0x21, 0x40, 0x37, 0x10, 0xc4,
+  0x3b, 0xb8, 0x05, 0xd5, 0x20, 0x28, 0x78, 0x03, 0xd5, 0x20, 0x73, 0x91,
+  0xd5, 0x04, 0x33, 0x50, 0x03, 0xb5, 0x12, 0x32, 0x09, 0x10, 0xaf, 0xf8,
+  0xff, 0x05, 0x46, 0xa0, 0x7a, 0x38, 0xb1, 0x00, 0x23, 0xcf, 0xff, 0xf7,
+  0x90, 0xff, 0x57, 0x00, 0x03, 0x00, 0x33, 0xfb, 0xbc, 0x3b, 0x51, 0x19,
+  0xc1, 0x88, 0x42, 0x05, 0xd0, 0xa3, 0xb0, 0x81, 0xdf, 0xff, 0xf7, 0x3b,
+  0xff, 0x00, 0x2f, 0x00, 0xff, 0xf7, 0xf7, 0x37, 0xff, 0x33, 0x07, 0x00,
+  0x2d, 0xe9, 0xf1, 0x4f, 0x7f, 0x84, 0xb0, 0x8b, 0x46, 0x90, 0x46, 0x99,
+  0x61, 0x00, 0xfb, 0x8d, 0xf8, 0x41, 0xc0, 0x56, 0x29, 0x78, 0x19, 0xb1,
+  0xfe, 0x4b, 0x31, 0x3c, 0x20, 0x33, 0xe0, 0x05, 0xeb, 0x89, 0xff, 0x06,
+  0x31, 0x6b, 0x61, 0xbb, 0x01, 0x21, 0x31, 0xfe, 0xe3, 0x72, 0xdd, 0xf8,
+  0x3c, 0xa0, 0x10, 0x9f, 0x12, 0xbf, 0x9c, 0x22, 0x46, 0x39, 0x46, 0x50,
+  0x6f, 0x50, 0xc6, 0xff, 0xf8, 0x04, 0x98, 0x23, 0x46, 0x42, 0x46, 0x59,
+  0xfe, 0x3d, 0x00, 0x08, 0xf8, 0x01, 0x46, 0x11, 0x98, 0x02, 0xfd, 0x94,
+  0x81, 0xc0, 0x97, 0x52, 0x46, 0x0e, 0x9b, 0x48, 0xfe, 0xdd, 0x00, 0xad,
+  0xfb, 0x04, 0x00, 0x05, 0xd1, 0x68, 0xba, 0x77, 0xb0, 0x08, 0x5b, 0x10,
+  0xeb, 0xfa, 0x05, 0x4f, 0x10, 0x5a, 0xdb, 0xf8, 0x00, 0x4d, 0x04, 0x20,
+  0x46, 0x29, 0x73, 0x28, 0x20, 0xb9, 0x05, 0x1f, 0x62, 0x4d, 0x43, 0x74,
+  0x45, 0x06, 0x7b, 0xc3, 0x20, 0xff, 0x64, 0xe0, 0x18, 0x2e, 0x08, 0xbf,
+  0x3e, 0x20, 0xfd, 0x60, 0x6b, 0xb0, 0x3f, 0xf8, 0x80, 0x46, 0xff, 0x2e,
+  0xd7, 0x04, 0xbf, 0x20, 0x49, 0x10, 0x32, 0x37, 0x40, 0x86, 0x05, 0x6f,
+  0x2e, 0x6b, 0x1e, 0xb9, 0x61, 0x10, 0xff, 0x43, 0xc9, 0x30, 0xf7, 0x01,
+  0x2e, 0x03, 0x5f, 0x00, 0x6c, 0xff, 0x3d, 0x20, 0xfb, 0x4a, 0xe0, 0xf1,
+  0x81, 0x38, 0x79, 0x7a, 0x79, 0x00, 0xff, 0x19, 0x01, 0x7b, 0x91, 0x43,
+  0x01, 0x73, 0x38, 0xfe, 0x09, 0x00, 0x00, 0x7b, 0x18, 0xb9, 0x20, 0x79,
+  0xb9, 0xff, 0x79, 0x88, 0x43, 0x20, 0x71, 0xf1, 0x69, 0x11, 0x7d, 0xb1,
+  0x1b, 0x21, 0x8a, 0xfa, 0x70, 0x6a, 0x08, 0xe7, 0x50, 0xed, 0x83, 0x65,
+  0x50, 0xf0, 0x62, 0x21, 0x91, 0x60, 0x78, 0xff, 0xff, 0x28, 0x1c, 0xbf,
+  0x40, 0x1c, 0x60, 0x70, 0xff, 0xbf, 0xf7, 0x46, 0xff, 0x05, 0xf0, 0x05,
+  0x73, 0x00, 0x60, 0xfe, 0x05, 0xd2, 0x60, 0x70, 0x30, 0x46, 0x04, 0xf0,
+  0x91, 0xbf, 0xff, 0xa0, 0x79, 0x40, 0x1e, 0xa0, 0x17, 0x90, 0x28, 0xff,
+  0x63, 0xb1, 0x69, 0x70, 0x69, 0x19, 0xb9, 0x81, 0xff, 0x61, 0x70, 0x69,
+  0xe0, 0x62, 0x03, 0xe0, 0x48, 0xff, 0x61, 0x71, 0x69, 0xb0, 0x69, 0x88,
+  0x61, 0x60, 0xbf, 0x6a, 0x70, 0x61, 0x66, 0x62, 0x1c, 0x25, 0x90, 0xff,
+  0xf7, 0xf7, 0x25, 0xff, 0x6f, 0xc1, 0x08, 0xbf, 0xff, 0xf7, 0xe7, 0x6f,
+  0xfa, 0x00, 0xdb, 0x80, 0x4d, 0x83, 0x04, 0x75, 0x05, 0xee, 0x99, 0x40,
+  0x0e, 0x46, 0x14, 0x2d, 0x50, 0x12, 0x20, 0x15, 0xff, 0xe0, 0x04, 0xf0,
+  0xd2, 0xff, 0xff, 0x2d, 0x04, 0x7f, 0xbf, 0x39, 0x6a, 0x91, 0xf8, 0x32,
+  0x50, 0x0f, 0xc0, 0xf7, 0x01, 0x09, 0x6b, 0x59, 0xb2, 0x29, 0x03, 0xd1,
+  0x04, 0x7b, 0xf0, 0xca, 0xdd, 0x00, 0x03, 0xe0, 0xce, 0x64, 0xdb, 0x43,
+  0xdf, 0x20, 0x70, 0xf1, 0xbd, 0x80, 0x43, 0x00, 0xc0, 0x04, 0xff, 0x00,
+  0x6a, 0x04, 0xf0, 0x4e, 0xff, 0xbd, 0xe8, 0x9f, 0x02, 0x40, 0xff, 0x20,
+  0x63, 0x45, 0x70, 0xbb, 0xb3, 0x02, 0xff, 0xf0, 0x03, 0x02, 0x03, 0x2a,
+  0x04, 0xd1, 0x00, 0x7e, 0x6d, 0xd0, 0x89, 0x00, 0x04, 0xf0, 0xf7, 0xbf,
+  0x35, 0x41, 0xff, 0xff, 0xf7, 0x7f, 0xfe, 0x00, 0x28, 0x04, 0xbf, 0xff,
+  0x68, 0x78, 0x00, 0x28, 0x16, 0xd1, 0xac, 0xb1, 0xff, 0x04, 0xf0, 0x99,
+  0xff, 0x29, 0x6a, 0x2c, 0x31, 0x5f, 0x0a, 0x7a, 0x4e, 0x7a, 0x52, 0xdb,
+  0xc0, 0xb3, 0x09, 0xc0, 0xff, 0x03, 0xd1, 0x2a, 0x79, 0x8b, 0x7a, 0x9a,
+  0x43, 0xf7, 0x2a, 0x71, 0x0c, 0x99, 0x52, 0xbd, 0xe8, 0x70, 0x40, 0x7f,
+  0xff, 0xf7, 0x13, 0xba, 0x70, 0xbd, 0x80, 0xf7, 0x50, 0xfe, 0x6f, 0x50,
+  0xf0, 0x7f, 0xff, 0xdf, 0xf8, 0x50, 0x14, 0xf1, 0x0c, 0x03, 0xd2, 0x2d,
+  0x61, 0x71, 0xd1, 0x04, 0xf0, 0x7a, 0xbf, 0xf6, 0x85, 0xa1, 0x06, 0x46,
+  0x93, 0x00, 0x03, 0x0a, 0x9c, 0x00, 0xfb, 0x78, 0x0f, 0x49, 0x22, 0x08,
+  0xb1, 0x8b, 0x20, 0x08, 0xef, 0xe0, 0xff, 0xf7, 0xfb, 0x4f, 0x20, 0x20,
+  0x04, 0x05, 0xbb, 0x69, 0x2d, 0xa7, 0x10, 0x0a, 0xf9, 0x86, 0xe7, 0x22,
+  0x20, 0xfb, 0xe0, 0xe9, 0x53, 0x51, 0x21, 0xe9, 0x60, 0x29, 0x61, 0xff,
+  0x41, 0x88, 0x49, 0x1c, 0x41, 0x80, 0x01, 0x88, 0xff, 0x49, 0x1e, 0x01,
+  0x80, 0x05, 0xf1, 0x24, 0x00, 0xff, 0x01, 0x21, 0x41, 0x70, 0x29, 0x1d,
+  0x4e, 0x61, 0xff, 0x8f, 0x61, 0x80, 0xf8, 0x00, 0x80, 0xc1, 0xf8, 0xff,
+  0x00, 0x90, 0x08, 0x98, 0x48, 0x60, 0x09, 0x98, 0x5f, 0x00, 0xb9, 0x8b,
+  0xa0, 0xc8, 0x51, 0x10, 0xe8, 0x7b, 0x32, 0xd1, 0x28, 0x19, 0x30, 0x27,
+  0xa3, 0xaf, 0xe1, 0x74, 0xb9, 0x30, 0x89, 0x20, 0x75, 0x1c, 0x6f, 0xc0,
+  0x6c, 0x15, 0x40, 0x8b, 0x20, 0x17, 0x77, 0x00, 0xff, 0xbf, 0xf8, 0x95,
+  0xf8, 0x25, 0x00, 0x03, 0x28, 0xbd, 0x0e, 0xfd, 0x72, 0x09, 0x05, 0x05,
+  0x02, 0x5b, 0xf1, 0x6c, 0xdd, 0xf9, 0x05, 0x01, 0xd9, 0xf8, 0x84, 0x21,
+  0x00, 0xc3, 0xf8, 0x29, 0x87, 0x0b, 0x60, 0x29, 0x01, 0x8d, 0x95, 0x02,
+  0x32, 0x07, 0x50, 0x41, 0x51, 0xaa, 0x4b, 0x01, 0x2c, 0x4b, 0x00, 0x46,
+  0x4b, 0x02, 0x27, 0x21, 0x00, 0x99, 0x7d, 0xf8, 0x99, 0x01, 0x41, 0x78,
+  0x03, 0x29, 0x1d, 0x4d, 0x00, 0x7f, 0x01, 0xf0, 0x18, 0x07, 0x13, 0x02,
+  0xd2, 0x6e, 0x40, 0xff, 0x49, 0x68, 0x46, 0x1a, 0x05, 0xe0, 0x00, 0x78,
+  0xf7, 0xae, 0x69, 0x02, 0x5b, 0x10, 0x00, 0x2e, 0xee, 0x69, 0xe7, 0xff,
+  0xf7, 0x98, 0x9f, 0x02, 0x71, 0x41, 0xff, 0xf7, 0x92, 0xd4, 0x0b, 0x02,
+  0x09, 0x01, 0x8d, 0x6b, 0x04, 0x89, 0x6b, 0x04, 0x70, 0xbd, 0xaa, 0xb7,
+  0x01, 0x18, 0x6b, 0x02, 0x03, 0x6b, 0x00, 0x10, 0x6b, 0x02, 0xbb, 0xef,
+  0xe7, 0xff, 0xf7, 0x63, 0xb7, 0x01, 0x50, 0x03, 0x2d, 0x8f, 0x94, 0xbf,
+  0x00, 0x20, 0x2b, 0x01, 0x39, 0x20, 0xdb, 0xd0, 0x32, 0xaf, 0xbd, 0xb3,
+  0x48, 0x00, 0xb3, 0x40, 0x05, 0xa7, 0x50, 0x28, 0x4b, 0x78, 0x64, 0x35,
+  0xf0, 0x38, 0x35, 0xf2, 0x3f, 0x01, 0x1d, 0xf5, 0x20, 0x5d, 0xf0, 0xb1,
+  0x40, 0x8b, 0x20, 0x18, 0x61, 0x00, 0x43, 0xf7, 0x04, 0x95, 0x0f, 0xf7,
+  0x02, 0x0a, 0xf7, 0x04, 0xf0, 0x6f, 0x30, 0x07, 0x01, 0xca, 0xab, 0xf8,
+  0x07, 0x23, 0x00, 0x46, 0x8d, 0x04, 0x42, 0x8d, 0x00, 0x81, 0xf2, 0x73,
+  0x00, 0x3e, 0xa7, 0x02, 0x43, 0x41, 0x00, 0x00, 0xf8, 0xb5, 0x49, 0x05,
+  0x89, 0x90, 0x63, 0x01, 0x16, 0x75, 0xb0, 0x5f, 0x01, 0x3a, 0x5f, 0x00,
+  0x55, 0xc0, 0x5f, 0x02, 0x35, 0x33, 0x00, 0x13, 0x5f, 0x04, 0x2c, 0x5f,
+  0x02, 0xd7, 0x27, 0x21, 0x21, 0x5f, 0x02, 0xc0, 0x41, 0x02, 0xaf, 0xb1,
+  0xff, 0x03, 0x2f, 0x02, 0xd0, 0x04, 0x2f, 0x06, 0xd0, 0xff, 0x0e, 0xe0,
+  0x6a, 0x68, 0x10, 0x00, 0x18, 0xbf, 0xdf, 0xa9, 0x68, 0x04, 0xd1, 0x06,
+  0x0b, 0x02, 0x03, 0xd0, 0xff, 0x31, 0x46, 0x28, 0x46, 0x90, 0x47, 0x03,
+  0xe0, 0xf5, 0x8f, 0x6f, 0xf0, 0x84, 0xd9, 0x02, 0x02, 0xf8, 0x03, 0xe0,
+  0xdf, 0xfe, 0xf7, 0xff, 0xff, 0x8e, 0x7d, 0x02, 0xf2, 0xbd, 0xef, 0xfe,
+  0xf7, 0xf9, 0xff, 0x99, 0x01, 0xfe, 0xf7, 0xf5, 0xfd, 0xff, 0x27, 0x13,
+  0xf2, 0xbd, 0x78, 0x48, 0xc0, 0x68, 0xfe, 0xa7, 0x30, 0xbd, 0x00, 0xf1,
+  0x24, 0x01, 0x00, 0x22, 0xff, 0x4a, 0x70, 0x0a, 0x70, 0x09, 0xa1, 0x01,
+  0x62, 0xff, 0xc2, 0x61, 0x42, 0x61, 0x42, 0x60, 0x82, 0x60, 0xff, 0x02,
+  0x61, 0x70, 0x49, 0x0a, 0x69, 0xc2, 0x60, 0xff, 0x08, 0x61, 0x48, 0x88,
+  0x40, 0x1e, 0x48, 0x80, 0x3f, 0x08, 0x88, 0x40, 0x1c, 0x08, 0x80, 0x31,
+  0xe1, 0x0b, 0x31, 0xfb, 0x6c, 0xec, 0x2b, 0x61, 0x68, 0x4c, 0x86, 0xb0,
+  0x4f, 0xff, 0xf4, 0x70, 0x71, 0x04, 0xf1, 0x54, 0x00, 0xff, 0xff, 0xf7,
+  0xa6, 0xf8, 0x40, 0x21, 0x04, 0xf1, 0x14, 0xfa, 0x09, 0x00, 0xa1, 0xb3,
+  0x00, 0x5f, 0xa1, 0x28, 0x22, 0x02, 0xff, 0xfb, 0x00, 0x43, 0x03, 0xf1,
+  0x54, 0x05, 0x64, 0xff, 0x26, 0x2e, 0x70, 0x40, 0x1c, 0x00, 0x26, 0x7c,
+  0xff, 0x33, 0x17, 0x28, 0x85, 0xf8, 0x25, 0x60, 0xeb, 0xdf, 0x60, 0x29,
+  0x62, 0xf0, 0xd3, 0x1d, 0x00, 0x40, 0x64, 0xbf, 0x22, 0x00, 0xf8, 0x54,
+  0x2f, 0x80, 0x13, 0x00, 0xc6, 0xff, 0x60, 0x01, 0x62, 0x18, 0x20, 0x20,
+  0x80, 0x66, 0xfd, 0x60, 0x4d, 0x01, 0x20, 0x61, 0x66, 0x80, 0x01, 0x20,
+  0xdf, 0xff, 0xf7, 0xb7, 0xfc, 0xa0, 0x65, 0xd0, 0xff, 0xf7, 0xff, 0xb3,
+  0xfc, 0x03, 0x21, 0x04, 0x91, 0xe0, 0x60, 0xff, 0x80, 0x21, 0x02, 0x91,
+  0x4f, 0xf6, 0xfd, 0x71, 0xfb, 0x4a, 0x48, 0x07, 0x50, 0x91, 0x00, 0xf5,
+  0xfe, 0x72, 0xff, 0x03, 0x96, 0x02, 0x23, 0x00, 0x21, 0x0f, 0xf2, 0xbd,
+  0xa1, 0x77, 0x00, 0x47, 0xfd, 0x05, 0xaa, 0xe7, 0xe0, 0x11, 0xbd, 0x02,
+  0x31, 0x00, 0xf8, 0xfd, 0x06, 0xb0, 0xb1, 0x91, 0x03, 0xfd, 0x22, 0x5d,
+  0x00, 0x20, 0x01, 0x29, 0x3d, 0x4a, 0x53, 0xff, 0x68, 0x1a, 0xbf, 0x81,
+  0x69, 0x00, 0x29, 0xc1, 0xff, 0x69, 0x59, 0x18, 0x41, 0x61, 0x01, 0x7d,
+  0x01, 0xfe, 0xa9, 0xd0, 0x02, 0xeb, 0xc1, 0x01, 0x14, 0x31, 0x8a, 0xff,
+  0x88, 0x0b, 0x68, 0x1b, 0xb9, 0x00, 0x22, 0xc2, 0xff, 0x60, 0x01, 0x22,
+  0x02, 0xe0, 0xc3, 0x60, 0x18, 0x7f, 0x61, 0x52, 0x1c, 0x8a, 0x80, 0x08,
+  0x60, 0xa7, 0x90, 0xfb, 0x61, 0x10, 0x43, 0x00, 0x00, 0xf1, 0x0c, 0x01,
+  0x2d, 0xff, 0x4a, 0x0b, 0x7a, 0x03, 0xf0, 0x07, 0x03, 0x02, 0xff, 0xeb,
+  0xc3, 0x02, 0x52, 0xf8, 0x14, 0x4f, 0x0b, 0xff, 0x68, 0x84, 0x42, 0x05,
+  0xd1, 0x18, 0x00, 0x10, 0x7f, 0x60, 0x06, 0xd0, 0x00, 0x23, 0x03, 0x61,
+  0xa5, 0x40, 0xff, 0x68, 0xc3, 0x60, 0x03, 0xb1, 0x18, 0x61, 0x01, 0xff,
+  0x20, 0x48, 0x76, 0x00, 0x20, 0x08, 0x60, 0x48, 0x9b, 0x60, 0x90, 0x39,
+  0x10, 0x90, 0x80, 0x5d, 0x71, 0x5b, 0x71, 0xf8, 0xef, 0xb5, 0x1c, 0x4c,
+  0x01, 0x81, 0x10, 0x34, 0xff, 0xe0, 0xff, 0x68, 0x6a, 0x46, 0x00, 0x21,
+  0xff, 0xf7, 0x70, 0x7f, 0xfc, 0xfe, 0xf7, 0x18, 0xff, 0x60, 0x68, 0x13,
+  0x50, 0xfe, 0x31, 0x80, 0x07, 0x00, 0x04, 0xeb, 0xc0, 0x00, 0x45, 0xbf,
+  0x69, 0x00, 0x2d, 0x08, 0xe0, 0x02, 0xab, 0x30, 0x32, 0xde, 0xdb, 0x10,
+  0x02, 0xd0, 0x71, 0x68, 0xdb, 0x11, 0x3d, 0x00, 0xff, 0xe2, 0xd0, 0x2e,
+  0x1d, 0x60, 0x68, 0x31, 0x69, 0xbf, 0xb7, 0x68, 0x88, 0x42, 0xf7, 0xd1,
+  0x05, 0x71, 0xb3, 0xfd, 0xff, 0xd5, 0x32, 0x78, 0x02, 0x29, 0xe7, 0xd1,
+  0x01, 0x3e, 0x83, 0x20, 0xff, 0xf7, 0x88, 0xff, 0xe4, 0xad, 0x40, 0x47,
+  0xa5, 0xde, 0x53, 0xa1, 0x60, 0xdb, 0x00, 0x20, 0x99, 0x40, 0x20, 0x75,
+  0xff, 0x43, 0x2f, 0x4f, 0x53, 0x2d, 0x49, 0x49, 0x20, 0xf7, 0x54, 0x6d,
+  0x72, 0xdb, 0x31, 0x00, 0x22, 0x04, 0xf0, 0xff, 0x9f, 0xbd, 0xf0, 0xb4,
+  0x01, 0x68, 0x44, 0x68, 0xff, 0x83, 0x68, 0x09, 0x18, 0x01, 0xeb, 0x54,
+  0x02, 0xff, 0xe4, 0x07, 0x48, 0xbf, 0x4b, 0x44, 0x0c, 0x30, 0xff, 0x91,
+  0x42, 0x2b, 0xd0, 0x11, 0xf8, 0x01, 0x4b, 0xbf, 0x14, 0xf0, 0x03, 0x05,
+  0x04, 0xbf, 0x09, 0x00, 0x5b, 0xff, 0xed, 0x1c, 0x26, 0x09, 0x0f, 0x2e,
+  0x07, 0xd1, 0xbe, 0x0b, 0x00, 0x6b, 0x0f, 0x36, 0x03, 0xe0, 0x07, 0x00,
+  0x7b, 0xfd, 0x03, 0x03, 0x00, 0x6d, 0x1e, 0xf9, 0xd1, 0x00, 0x2e, 0xef,
+  0xe6, 0xd0, 0xa4, 0x08, 0x25, 0x01, 0x04, 0xf0, 0x03, 0xef, 0x04, 0x03,
+  0x2c, 0x08, 0x31, 0x01, 0x4b, 0x05, 0xeb, 0xff, 0x04, 0x24, 0x1c, 0x1b,
+  0xb5, 0x1c, 0xd8, 0xd0, 0xe9, 0x14, 0x33, 0x00, 0x2b, 0x00, 0x6b, 0x2b,
+  0x01, 0xd1, 0xe7, 0xf0, 0xff, 0xbc, 0x70, 0x47, 0x10, 0xb5, 0xef, 0xf3,
+  0x10, 0xff, 0x82, 0x72, 0xb6, 0x66, 0x4b, 0x4f, 0xf6, 0xfe, 0xff, 0x64,
+  0x00, 0xf1, 0x8c, 0x40, 0x44, 0xe0, 0x30, 0xf6, 0x63, 0x10, 0x8c, 0x40,
+  0x17, 0x00, 0x83, 0x72, 0xb6, 0x60, 0xfd, 0x4c, 0x17, 0x00, 0x65, 0x25,
+  0x60, 0x05, 0x78, 0x8d, 0xbf, 0x43, 0x11, 0x40, 0x29, 0x43, 0x01, 0xd7,
+  0x41, 0x60, 0x7f, 0x83, 0xf3, 0x10, 0x88, 0x30, 0xbd, 0xf0, 0xdb, 0x30,
+  0xbf, 0x23, 0xf8, 0x0b, 0xe0, 0x72, 0xb6, 0x23, 0x00, 0x66, 0xff, 0x2e,
+  0x60, 0x30, 0xf8, 0x14, 0x70, 0x66, 0x5c, 0xbf, 0x07, 0xf1, 0x8c, 0x47,
+  0x3e, 0x70, 0xeb, 0x31, 0x94, 0xef, 0x42, 0xf1, 0xd3, 0xf0, 0xb1, 0x11,
+  0x23, 0x06, 0xe0, 0xff, 0x30, 0xf8, 0x13, 0x40, 0x04, 0xf1, 0x8c, 0x44,
+  0xff, 0x24, 0x78, 0x5c, 0x54, 0x5b, 0x1c, 0x93, 0x42, 0xdb, 0xf6, 0xd3,
+  0x89, 0x10, 0x26, 0x2e, 0x49, 0x02, 0x64, 0x1c, 0x7b, 0x70, 0x47, 0x6d,
+  0x01, 0x00, 0x24, 0x45, 0x4d, 0x91, 0x01, 0xfe, 0xcf, 0x30, 0xf8, 0x1c,
+  0x60, 0x01, 0x60, 0x01, 0xe0, 0xdc, 0x05, 0x00, 0x6f, 0x00, 0x18, 0x60,
+  0x82, 0x25, 0x00, 0x10, 0xbd, 0xfe, 0xa9, 0x03, 0x3c, 0x4b, 0x3c, 0x4c,
+  0x70, 0x47, 0x3c, 0xf7, 0x49, 0x09, 0x78, 0x33, 0x20, 0x02, 0x06, 0x2a,
+  0x02, 0x5f, 0xbf, 0xc1, 0xf3, 0xc2, 0x01, 0x19, 0xd1, 0x0c, 0xd7, 0x80,
+  0xfa, 0x3d, 0xa1, 0x35, 0x1b, 0x06, 0x03, 0xbf, 0x00, 0xea, 0x91, 0xf7,
+  0x11, 0x81, 0x42, 0x17, 0x03, 0x1c, 0xb5, 0x0f, 0xf2, 0xff, 0xcc, 0x02,
+  0x18, 0xca, 0x69, 0x46, 0x03, 0x28, 0xff, 0x18, 0xc1, 0x01, 0xd3, 0x00,
+  0x20, 0x16, 0xbd, 0xff, 0x00, 0xf0, 0x03, 0x00, 0x3d, 0xf8, 0x10, 0x00,
+  0xfe, 0xf1, 0x00, 0x41, 0x00, 0x22, 0x08, 0x78, 0x01, 0xe0, 0xff, 0x00,
+  0x22, 0x18, 0x46, 0x0b, 0x78, 0x83, 0x42, 0xff, 0xfa, 0xd1, 0x52, 0x1c,
+  0x05, 0x2a, 0xf9, 0xd3, 0xed, 0x16, 0xc3, 0x40, 0x04, 0x46, 0xa3, 0x10,
+  0x21, 0x40, 0xf2, 0xfb, 0x16, 0x50, 0x27, 0x20, 0xff, 0x1e, 0x4d, 0x0c,
+  0xb9, 0xff, 0x28, 0x78, 0x32, 0xbd, 0x01, 0x2c, 0x01, 0xd1, 0xff, 0x28,
+  0x79, 0x32, 0xbd, 0xa0, 0x1e, 0xc2, 0x00, 0xd7, 0xd2, 0xb2, 0x18, 0x1f,
+  0x00, 0x17, 0x1f, 0x00, 0x60, 0xff, 0xf7, 0x28, 0x7a, 0x32, 0xbb, 0x60,
+  0xff, 0xf7, 0xe3, 0xff, 0x7f, 0x0f, 0xf2, 0x64, 0x01, 0x40, 0x56, 0x02,
+  0x41, 0x00, 0xeb, 0x02, 0x00, 0x55, 0xf0, 0x4d, 0x41, 0x01, 0x07, 0xd1,
+  0x0c, 0xfb, 0x22, 0x1c, 0x6f, 0x20, 0x4c, 0xff, 0x00, 0xf0, 0x1a, 0xff,
+  0xf8, 0x28, 0x78, 0x0a, 0xe0, 0x01, 0x2a, 0x07, 0xeb, 0xd1, 0x14, 0x13,
+  0x02, 0x42, 0x13, 0x00, 0x10, 0xf8, 0x28, 0x3b, 0x79, 0x00, 0x37, 0x90,
+  0x0f, 0xf2, 0x28, 0x3b, 0x00, 0xab, 0x41, 0xff, 0x48, 0x00, 0x00, 0x50,
+  0x00, 0x00, 0xab, 0xab, 0xff, 0xb3, 0x01, 0x00, 0x46, 0x0b, 0x05, 0x00,
+  0x46, 0xfd, 0x21, 0x4f, 0xa0, 0xa0, 0x60, 0x21, 0xe7, 0xb0, 0x04, 0x6f,
+  0xb3, 0x04, 0xb6, 0x04, 0x41, 0x22, 0x00, 0xff, 0x00, 0x03, 0x55, 0xfe,
+  0x00, 0x02, 0xfd, 0x00, 0x01, 0xfc, 0x00, 0x00, 0xfb, 0x00, 0x01, 0xef,
+  0xfa, 0xfa, 0xfa, 0xf9, 0x00, 0x00, 0xf8, 0xf8, 0xf7, 0xff, 0xf7, 0xf7,
+  0xf6, 0xf6, 0xf5, 0xf5, 0xf4, 0xf4, 0xff, 0xf3, 0xf3, 0xf2, 0xf1, 0xf1,
+  0xf0, 0xef, 0xee, 0xff, 0xed, 0xeb, 0xea, 0xe8, 0xe5, 0xe2, 0xdc, 0x10,
+  0xff, 0xb5, 0x01, 0x20, 0x04, 0xf0, 0x01, 0xfe, 0x79, 0xdb, 0x4c, 0x18,
+  0x33, 0x44, 0xb6, 0xfe, 0x7b, 0x30, 0x21, 0x20, 0x7f, 0x1d, 0x04, 0xf0,
+  0x4f, 0xfc, 0xa0, 0x1c, 0x79, 0x30, 0xfd, 0x80, 0xc9, 0xb0, 0xf0, 0x44,
+  0xfe, 0x00, 0x22, 0x80, 0xff, 0x21, 0x40, 0xf6, 0x6e, 0x10, 0xff, 0xf7,
+  0xed, 0xff, 0xfe, 0x6f, 0x48, 0x4f, 0xf0, 0x40, 0x71, 0xc1, 0xff, 0x62,
+  0x01, 0x60, 0x0e, 0x20, 0x06, 0x21, 0x04, 0xb7, 0xf0, 0x41, 0xfe, 0x23,
+  0x01, 0x23, 0xfe, 0x2d, 0x71, 0x19, 0xff, 0xe0, 0x03, 0x28, 0x00, 0xdb,
+  0x70, 0x47, 0x30, 0xff, 0xb5, 0x02, 0x29, 0x0b, 0xda, 0x63, 0x4c, 0x01,
+  0xff, 0xeb, 0x41, 0x05, 0x2d, 0x19, 0x45, 0x19, 0x2a, 0xfb, 0x72, 0x0c,
+  0x87, 0x40, 0x01, 0x41, 0x01, 0xeb, 0x80, 0xef, 0x00, 0x43, 0x61, 0x30,
+  0x3d, 0xb0, 0x00, 0x22, 0xe9, 0xbd, 0xe7, 0x37, 0x01, 0x16, 0xbe, 0x00,
+  0xbf, 0x07, 0x01, 0x09, 0xfb, 0xbe, 0x70, 0x6d, 0x10, 0x57, 0x4d, 0x66,
+  0x19, 0xb0, 0xbf, 0x78, 0x70, 0xb9, 0x01, 0x20, 0xa0, 0x9b, 0x70, 0x17,
+  0xbf, 0xff, 0x48, 0xb1, 0x05, 0xeb, 0x44, 0xa3, 0x10, 0x10, 0xef, 0x01,
+  0x32, 0x46, 0x20, 0x9d, 0x80, 0x72, 0xf8, 0x01, 0xf3, 0x20, 0xb0, 0x71,
+  0x60, 0x1d, 0xd1, 0xff, 0xf7, 0xe6, 0xff, 0x97, 0x4b, 0x48, 0x00, 0x1f,
+  0x01, 0x8a, 0x1f, 0x41, 0x11, 0x01, 0xdd, 0xdf, 0xff, 0x46, 0x48, 0x20,
+  0x5c, 0x1f, 0xd1, 0xf8, 0x4f, 0xff, 0x00, 0x20, 0x00, 0x90, 0x00, 0x27,
+  0x42, 0x4c, 0xff, 0xe8, 0x46, 0x0d, 0xf1, 0x02, 0x06, 0x00, 0xe0, 0xd7,
+  0x0f, 0xb9, 0x1b, 0x99, 0x50, 0x1c, 0x6b, 0x00, 0x4c, 0xfe, 0xff, 0x0f,
+  0xf2, 0x04, 0x10, 0x3e, 0x49, 0x50, 0xf8, 0x7f, 0x27, 0x00, 0x08, 0x60,
+  0x01, 0x20, 0xb8, 0x6b, 0x00, 0xff, 0xe1, 0xfe, 0x10, 0xb3, 0x04, 0xeb,
+  0x47, 0x0a, 0xff, 0x17, 0xf8, 0x04, 0x90, 0xba, 0xf8, 0x10, 0xb0, 0x5f,
+  0x3d, 0x19, 0x2a, 0x46, 0x0a, 0x77, 0x00, 0x38, 0x75, 0x00, 0xdf, 0x37,
+  0xf8, 0xa8, 0x78, 0x10, 0x93, 0x00, 0xb8, 0x55, 0x7b, 0x09, 0xe0, 0x1b,
+  0x00, 0x00, 0x58, 0x45, 0x14, 0x71, 0x22, 0x3f, 0xb8, 0x55, 0x38, 0x5d,
+  0x48, 0x45, 0x9d, 0xa1, 0xb7, 0x11, 0xff, 0x07, 0xf8, 0x08, 0x00, 0x01,
+  0x20, 0xa8, 0x70, 0xbf, 0x7f, 0x1c, 0x02, 0x2f, 0xc8, 0xd3, 0xc7, 0xd0,
+  0x19, 0xbf, 0x00, 0x79, 0x00, 0xb3, 0x00, 0x25, 0xc9, 0xb0, 0x00, 0xff,
+  0x48, 0xb9, 0xb8, 0x5d, 0xb8, 0xb1, 0x04, 0xf1, 0xff, 0x08, 0x00, 0x07,
+  0xeb, 0x47, 0x01, 0x08, 0x18, 0xbf, 0x28, 0x5c, 0x01, 0x28, 0x0f, 0xd1,
+  0x73, 0x11, 0x0c, 0xfe, 0x15, 0xc0, 0x07, 0x00, 0x50, 0xf8, 0x25, 0x30,
+  0x18, 0xff, 0x00, 0x06, 0xd0, 0x04, 0xf1, 0x10, 0x00, 0x30, 0xff, 0xf8,
+  0x17, 0x10, 0x3a, 0x5d, 0xf8, 0xb2, 0x98, 0x7f, 0x47, 0x6d, 0x1c, 0x03,
+  0x2d, 0xdf, 0xd3, 0x4f, 0x01, 0xff, 0xd8, 0xd3, 0xbd, 0xe8, 0xf1, 0x8f,
+  0x12, 0x48, 0xff, 0x4f, 0xf4, 0x40, 0x51, 0x01, 0x60, 0xc1, 0x68, 0xed,
+  0x41, 0x07, 0x00, 0xc1, 0x60, 0x07, 0x60, 0x28, 0x0c, 0xbf, 0xff, 0x4f,
+  0xf4, 0x00, 0x50, 0x4f, 0xf4, 0x80, 0x50, 0xff, 0x0b, 0x4a, 0x01, 0x29,
+  0x0c, 0xbf, 0x11, 0x68, 0x6f, 0x51, 0x68, 0x08, 0x40, 0x19, 0x01, 0x07,
+  0x49, 0x1b, 0x07, 0xfd, 0x08, 0x2b, 0x01, 0x00, 0x34, 0xee, 0x00, 0x20,
+  0x14, 0xaa, 0x53, 0x20, 0x40, 0x03, 0x03, 0x58, 0x3e, 0x20, 0x01, 0x52,
+  0x91, 0xd2, 0xff, 0xb2, 0x20, 0x3a, 0x22, 0xbf, 0x21, 0xfa, 0x02, 0xff,
+  0xf0, 0x00, 0x21, 0x70, 0x47, 0x20, 0x32, 0xd1, 0xff, 0x41, 0xd0, 0x40,
+  0x48, 0x40, 0x91, 0x40, 0xd1, 0xe4, 0x05, 0x00, 0x5d, 0x90, 0x47, 0x43,
+  0x31, 0x5f, 0x11, 0x18, 0x22, 0x63, 0xfe, 0xe1, 0x00, 0x00, 0x21, 0x9a,
+  0x40, 0x03, 0xf0, 0x05, 0xff, 0xff, 0x02, 0x46, 0x04, 0xf1, 0x18, 0x00,
+  0x0b, 0xfb, 0x46, 0x40, 0x85, 0x90, 0x40, 0xfe, 0xc0, 0xb2, 0x10, 0xfe,
+  0xed, 0x20, 0xdf, 0xf8, 0x00, 0x4d, 0x25, 0x68, 0x00, 0xef, 0xf0, 0x6b,
+  0xfb, 0x05, 0x31, 0x80, 0x28, 0x0c, 0x60, 0xff, 0xf3, 0x82, 0x05, 0x00,
+  0xf0, 0x78, 0xfb, 0x06, 0x7c, 0x9b, 0x91, 0x0d, 0x00, 0xc3, 0x05, 0x65,
+  0x60, 0x31, 0x57, 0x32, 0xfb, 0x0d, 0x00, 0x43, 0x13, 0x04, 0xf0, 0xc1,
+  0xfc, 0x68, 0xfa, 0x31, 0x00, 0xc5, 0x3b, 0xf0, 0x30, 0x0d, 0x00, 0xeb,
+  0x84, 0x7f, 0x00, 0x45, 0x60, 0xfe, 0xf7, 0x50, 0xfc, 0x4b, 0x51, 0xff,
+  0x00, 0xf0, 0x38, 0xfe, 0x88, 0xe1, 0xf0, 0xb5, 0xff, 0x83, 0xb0, 0x0c,
+  0x46, 0xef, 0xf3, 0x05, 0x80, 0xfe, 0x11, 0xd0, 0xf0, 0xbb, 0xfe, 0x00,
+  0xf0, 0xaf, 0xfe, 0xdd, 0x06, 0x1b, 0x00, 0x64, 0xfa, 0x05, 0x43, 0x06,
+  0x9f, 0xfc, 0xff, 0x05, 0xf1, 0x1c, 0x07, 0x30, 0x02, 0x40, 0xf0, 0xdf,
+  0x02, 0x00, 0x38, 0x60, 0x07, 0x11, 0x00, 0x5a, 0xfd, 0xff, 0x68, 0x68,
+  0xdf, 0xf8, 0xdc, 0x6c, 0x01, 0xab, 0xff, 0x00, 0x22, 0x17, 0x21, 0xfe,
+  0xf7, 0x3d, 0xff, 0xfb, 0x30, 0x68, 0x91, 0xe1, 0xce, 0xf8, 0x8d, 0xf8,
+  0x04, 0xff, 0x00, 0x40, 0x1e, 0x00, 0xf0, 0x45, 0xfc, 0x0d, 0xff, 0xf1,
+  0x05, 0x00, 0x00, 0x90, 0x23, 0x46, 0x68, 0xfb, 0x68, 0x82, 0xf5, 0x20,
+  0xfe, 0xf7, 0x9f, 0xfe, 0x9d, 0xff, 0xf8, 0x05, 0x10, 0x00, 0xf0, 0x37,
+  0xfc, 0x02, 0xfe, 0x41, 0x00, 0x42, 0xfe, 0xef, 0xf3, 0x11, 0x84, 0x60,
+  0xbd, 0x20, 0x0d, 0xa1, 0xdf, 0xf8, 0xa8, 0x7c, 0x03, 0x00, 0x1c, 0xff,
+  0x3d, 0x68, 0x4f, 0xf0, 0x00, 0x40, 0x08, 0x60, 0xdf, 0x04, 0xf0, 0xc7,
+  0xfe, 0x03, 0xd3, 0x00, 0x96, 0xf8, 0xff, 0x54, 0x03, 0x03, 0x28, 0x03,
+  0xd1, 0xdf, 0xf8, 0x7f, 0xbc, 0x1c, 0x01, 0x20, 0x08, 0x70, 0x05, 0x1d,
+  0x00, 0x97, 0x38, 0x60, 0x84, 0xc9, 0xa2, 0xfe, 0xe7, 0x00, 0xb5, 0x05,
+  0x60, 0xea, 0xb5, 0x00, 0x54, 0x03, 0x00, 0x09, 0xb3, 0x08, 0x45, 0xfc,
+  0x20, 0xfe, 0xaf, 0x00, 0x03, 0x00, 0x45, 0xf8, 0x1c, 0x0f, 0x00, 0xfb,
+  0x21, 0x08, 0x11, 0x00, 0x10, 0xfd, 0xdf, 0xf8, 0x2c, 0xb7, 0x0c, 0x00,
+  0x68, 0x33, 0xd1, 0x7a, 0xf8, 0xa3, 0x01, 0xf3, 0xe8, 0x37, 0xe0, 0xb7,
+  0x91, 0xff, 0x07, 0x3b, 0x45, 0x00, 0x2f, 0xfe, 0x05, 0xee, 0xff, 0x00,
+  0xe4, 0xf9, 0x06, 0x4b, 0x06, 0x1f, 0xfc, 0x06, 0xbf, 0xf1, 0x1c, 0x01,
+  0x44, 0xea, 0x05, 0xf1, 0x60, 0xdf, 0xaf, 0xf8, 0xe8, 0x0b, 0x00, 0x53,
+  0x80, 0x59, 0x41, 0x02, 0xd2, 0x74, 0x41, 0x00, 0x2f, 0x33, 0x03, 0x27,
+  0x00, 0xcf, 0xfc, 0x20, 0x59, 0xa0, 0xee, 0xd5, 0xa0, 0x21, 0xd4, 0xe7,
+  0x13, 0x01, 0x20, 0x68, 0xc0, 0xfd, 0xb2, 0x3f, 0x55, 0x04, 0xf0, 0xfc,
+  0xfb, 0xdf, 0xf8, 0x55, 0xac, 0x3b, 0x00, 0x21, 0x7f, 0x00, 0x65, 0x3d,
+  0x02, 0xb3, 0x3d, 0x00, 0xfd, 0x10, 0x5b, 0xe0, 0x94, 0x1b, 0x91, 0xf8,
+  0x60, 0x23, 0xe9, 0x0a, 0x91, 0xe1, 0x57, 0xe0, 0x81, 0x0b, 0x00, 0x00,
+  0x21, 0xde, 0xaf, 0xe7, 0x01, 0x21, 0xdc, 0x45, 0x02, 0x17, 0x3b, 0x00,
+  0xa2, 0xde, 0x59, 0x04, 0x08, 0x21, 0xd2, 0xe7, 0xc9, 0x31, 0x0d, 0x46,
+  0x5f, 0x82, 0xb0, 0x21, 0x46, 0x09, 0x19, 0x00, 0xb4, 0xcb, 0x10, 0xfe,
+  0xdd, 0x01, 0xa1, 0xfc, 0xe0, 0xb2, 0x00, 0xf0, 0xcb, 0xfb, 0xfd, 0x06,
+  0x89, 0x00, 0x30, 0x76, 0x0c, 0xb1, 0xc5, 0xff, 0xf3, 0x02, 0x10, 0xdf,
+  0xf8, 0x3c, 0x5b, 0x85, 0xfc, 0x43, 0x10, 0x6f, 0x11, 0x6c, 0xfd, 0x70,
+  0x68, 0x6b, 0x46, 0xfe, 0x7f, 0x41, 0xfe, 0xf7, 0x66, 0xfe, 0x05, 0xf1,
+  0x4c, 0xfe, 0x2b, 0xb0, 0x81, 0x72, 0x04, 0x80, 0x00, 0x21, 0xc1, 0x5d,
+  0x72, 0x51, 0x21, 0x00, 0x20, 0x76, 0x09, 0x10, 0x04, 0x87, 0xb0, 0xdf,
+  0x08, 0x5b, 0x60, 0x88, 0x1c, 0x4d, 0xf1, 0x50, 0x00, 0x5f, 0x2c, 0x90,
+  0xf8, 0x40, 0x61, 0x05, 0x15, 0x9c, 0x23, 0x00, 0xff, 0x20, 0x63, 0x00,
+  0x2e, 0x0c, 0xbf, 0x05, 0xf5, 0xff, 0x4b, 0x70, 0x05, 0xf5, 0x4c, 0x70,
+  0x01, 0x68, 0xff, 0x11, 0xb9, 0x04, 0x60, 0x70, 0xbd, 0x01, 0x46, 0xff,
+  0x08, 0x6b, 0x00, 0x28, 0xfb, 0xd1, 0x0c, 0x63, 0xee, 0x0b, 0x13, 0xfe,
+  0xf7, 0x1f, 0xeb, 0x00, 0xc0, 0x0a, 0x00, 0xff, 0xf5, 0x4b, 0x71, 0x00,
+  0x2c, 0x0c, 0xbf, 0x09, 0xff, 0x68, 0x49, 0x68, 0x71, 0xb1, 0x89, 0x78,
+  0x1c, 0xfe, 0xa5, 0x41, 0x04, 0x94, 0xf8, 0x30, 0x01, 0x03, 0x28, 0xe7,
+  0x06, 0xd1, 0x84, 0x07, 0x00, 0x29, 0x01, 0x04, 0xf5, 0x98, 0x9f, 0x70,
+  0x10, 0xbd, 0xc9, 0xe0, 0x7d, 0x00, 0x71, 0x11, 0x26, 0xeb, 0x00, 0x26,
+  0x29, 0xd1, 0x65, 0x77, 0xf0, 0x04, 0xf0, 0x62, 0xdb, 0xfb, 0x61, 0x1d,
+  0x20, 0x74, 0x0a, 0x39, 0x02, 0x01, 0x91, 0xcf, 0xf8, 0x40, 0x11, 0x00,
+  0x85, 0x30, 0x57, 0x00, 0x70, 0x00, 0xfe, 0x7f, 0x02, 0xa1, 0x42, 0x06,
+  0xd1, 0x09, 0x6b, 0x01, 0xda, 0x3f, 0x90, 0x20, 0x7b, 0x00, 0x0d, 0x46,
+  0xf9, 0xc3, 0xa1, 0x42, 0xff, 0xf9, 0xd1, 0xa1, 0x42, 0x03, 0xd1, 0x08,
+  0x6b, 0x63, 0x28, 0x63, 0xa5, 0x80, 0x19, 0x00, 0x3b, 0x31, 0x30, 0x1a,
+  0x45, 0x01, 0xff, 0x00, 0x11, 0x01, 0xf5, 0x98, 0x74, 0x00, 0xf0, 0xfd,
+  0xf4, 0xed, 0xe0, 0xfe, 0xf7, 0xcb, 0xfa, 0x20, 0x78, 0x7d, 0x01, 0xb1,
+  0xd0, 0x03, 0x28, 0x02, 0x28, 0x02, 0x71, 0x82, 0xfd, 0xbc, 0x13, 0xd0,
+  0x31, 0x40, 0xfe, 0xf7, 0xd3, 0xba, 0xef, 0x10, 0xb5, 0x82, 0xb0, 0xcb,
+  0x01, 0xb9, 0xfa, 0x00, 0xff, 0xf0, 0xa4, 0xf8, 0x0c, 0xbf, 0x4c, 0x68,
+  0x8c, 0xff, 0x68, 0xac, 0xb1, 0xa2, 0x78, 0x1c, 0x23, 0x03, 0xf7, 0xfb,
+  0x02, 0x00, 0xbb, 0xf0, 0x21, 0x03, 0x2a, 0x00, 0xff, 0xd0, 0x8c, 0xe0,
+  0x4f, 0xf0, 0xff, 0x32, 0x0a, 0xb7, 0x60, 0x04, 0x21, 0xc5, 0xf0, 0x11,
+  0x20, 0x41, 0x00, 0x9b, 0xfe, 0x6d, 0x60, 0x86, 0xf8, 0x00, 0xf0, 0xc1,
+  0xfa, 0xfe, 0xeb, 0xf7, 0xb0, 0xb7, 0xd0, 0x16, 0x2f, 0x50, 0xf0, 0x43,
+  0x83, 0xf3, 0xb0, 0x88, 0xb1, 0xd0, 0x67, 0x25, 0x07, 0xfd, 0xfe, 0xf7,
+  0x7d, 0x8d, 0x57, 0x00, 0xf9, 0xfc, 0xc7, 0xb2, 0x38, 0x6d, 0x20, 0xf7,
+  0xef, 0xfc, 0x05, 0x79, 0x10, 0x8c, 0x99, 0x1c, 0x20, 0xff, 0x00, 0xfb,
+  0x07, 0x90, 0x00, 0xf5, 0x98, 0x76, 0x7f, 0x01, 0x20, 0x30, 0x70, 0x39,
+  0x46, 0x0a, 0x77, 0x10, 0xbb, 0xc3, 0xfb, 0x97, 0x01, 0x31, 0xff, 0x38,
+  0xcf, 0x20, 0x07, 0xff, 0x00, 0x70, 0x61, 0x06, 0xf1, 0x14, 0x01, 0xdf,
+  0x7b, 0xf8, 0x98, 0xc9, 0x20, 0xfe, 0xf7, 0x16, 0xff, 0x47, 0x21, 0xfd,
+  0x8f, 0x69, 0x00, 0x7b, 0xfa, 0x01, 0xa8, 0x00, 0x90, 0xdd, 0x43, 0x6d,
+  0x30, 0x83, 0x22, 0x10, 0xe3, 0x10, 0xe8, 0xfc, 0xb7, 0x9d, 0xf8, 0x04,
+  0x6d, 0x30, 0x80, 0xfa, 0x99, 0x21, 0x8b, 0xbf, 0xfc, 0x09, 0xf6, 0x6c,
+  0x40, 0x20, 0x27, 0x10, 0xbd, 0xa7, 0xe8, 0xfe, 0x83, 0x9d, 0x81, 0x87,
+  0x03, 0xc3, 0x9d, 0x90, 0x49, 0xbe, 0x87, 0x00, 0xb5, 0xfc, 0x00, 0xf0,
+  0x6a, 0x6b, 0xd0, 0x0c, 0xf7, 0x19, 0xe4, 0xb2, 0x25, 0x11, 0x04, 0x11,
+  0x00, 0x20, 0x45, 0x81, 0x9f, 0x12, 0x4f, 0xc1, 0x00, 0xff, 0x51, 0x0b,
+  0x13, 0x33, 0x2b, 0x00, 0xb5, 0x1e, 0x0b, 0x14, 0x7c, 0x0b, 0x10, 0x0a,
+  0x60, 0x0d, 0x13, 0x02, 0xd4, 0xfd, 0x02, 0x69, 0x01, 0x38, 0x49, 0x00,
+  0x07, 0xfd, 0x00, 0x42, 0xfa, 0x7f, 0x7f, 0xe7, 0xfe, 0xf7, 0x30, 0xfa,
+  0x01, 0xff, 0x00, 0xe9, 0x60, 0x79, 0x22, 0x95, 0x01, 0x29, 0xed, 0x20,
+  0xa8, 0x08, 0x00, 0xfb, 0xf5, 0x4a, 0x17, 0x20, 0x70, 0x47, 0x2d, 0xe9,
+  0xfc, 0xbf, 0x41, 0x04, 0x46, 0x88, 0x46, 0x16, 0x17, 0x16, 0x7b, 0xea,
+  0x8f, 0x00, 0x01, 0x63, 0x00, 0x6d, 0x0f, 0x10, 0x00, 0xf0, 0x22, 0x7b,
+  0xf8, 0x07, 0x15, 0x10, 0x78, 0x08, 0xed, 0xb2, 0x8f, 0x21, 0x7b, 0x05,
+  0x01, 0xb9, 0x10, 0x71, 0x03, 0x22, 0x00, 0xc9, 0x00, 0xff, 0x0a, 0x70,
+  0x48, 0x60, 0xce, 0x60, 0x0c, 0x74, 0xaa, 0xff, 0xb0, 0xf9, 0xf7, 0x03,
+  0x78, 0xf7, 0x04, 0x6c, 0xf7, 0x04, 0x04, 0xbe, 0x31, 0xf2, 0xf6, 0x81,
+  0x04, 0x46, 0xc0, 0x17, 0x30, 0x3f, 0xfb, 0xbc, 0x30, 0x01, 0x20, 0x2c,
+  0x48, 0x87, 0xb0, 0x14, 0x6f, 0x21, 0x04, 0xf2, 0x84, 0xdf, 0x10, 0xc3,
+  0xfd, 0x0d, 0x10, 0xf7, 0xf0, 0x39, 0xf8, 0x73, 0xb1, 0x00, 0x21, 0x03,
+  0x91, 0x7e, 0x75, 0xb1, 0x03, 0x21, 0xdf, 0xf8, 0x68, 0x0c, 0x75, 0xb6,
+  0xce, 0x73, 0xb1, 0xf6, 0xa9, 0x10, 0xa9, 0x10, 0x65, 0x12, 0xdc, 0xf9,
+  0xee, 0x79, 0xb1, 0x38, 0x01, 0x03, 0x79, 0xb0, 0x3b, 0xf8, 0x04, 0xfc,
+  0x41, 0x30, 0xc1, 0x70, 0x81, 0x04, 0xf5, 0x51, 0x75, 0x4f, 0xdf, 0xf6,
+  0xff, 0x71, 0x01, 0x80, 0x07, 0x20, 0x31, 0x29, 0xf3, 0x60, 0x69, 0x51,
+  0xb0, 0x57, 0x30, 0xf5, 0x59, 0x70, 0xe8, 0xfa, 0x5f, 0x00, 0x44, 0x25,
+  0xc0, 0x28, 0x72, 0x28, 0x77, 0x07, 0xff, 0xb0, 0x30, 0xbd, 0x43, 0x74,
+  0x72, 0x6c, 0x54, 0xdf, 0x73, 0x6b, 0x00, 0x00, 0xb1, 0x17, 0x81, 0xf5,
+  0xb9, 0xdf, 0xf8, 0xb5, 0x00, 0x25, 0x00, 0x71, 0x00, 0x98, 0x67, 0xff,
+  0x20, 0xfa, 0x01, 0xf2, 0xd2, 0x07, 0x03, 0xd5, 0xff, 0x06, 0xeb, 0x81,
+  0x02, 0xd4, 0x6f, 0x34, 0xb9, 0xff, 0x49, 0x1c, 0x07, 0x29, 0xf4, 0xd3,
+  0x28, 0x46, 0xff, 0xf2, 0xbd, 0x00, 0x25, 0x14, 0x46, 0xe2, 0x6a, 0xff,
+  0x00, 0x2a, 0xf5, 0xd0, 0x63, 0x7b, 0xa5, 0x7b, 0x7f, 0x2b, 0x42, 0xf6,
+  0xd0, 0x01, 0x21, 0x20, 0x19, 0x10, 0xff, 0x7d, 0xfb, 0x20, 0x7b, 0x01,
+  0x25, 0x07, 0x46, 0xf7, 0x07, 0x28, 0xb4, 0x9d, 0x34, 0xcd, 0xf9, 0x00,
+  0x20, 0xff, 0xe0, 0x62, 0x06, 0xeb, 0x87, 0x00, 0xc1, 0x6f, 0xff, 0xc4,
+  0x67, 0x00, 0x29, 0xdf, 0xd0, 0xe1, 0x62, 0x7f, 0xdd, 0xe7, 0xdf, 0xf8,
+  0x38, 0x07, 0x90, 0x01, 0x40, 0xff, 0x70, 0x47, 0xdf, 0xf8, 0xfc, 0x0b,
+  0x40, 0x89, 0xbe, 0x97, 0x90, 0x01, 0xc0, 0xf3, 0x01, 0x10, 0x5d, 0x50,
+  0xd1, 0xff, 0x03, 0x29, 0x0c, 0xd1, 0x01, 0x20, 0x02, 0x21, 0xff, 0x1f,
+  0xe0, 0x01, 0x28, 0x18, 0xbf, 0x02, 0x28, 0xfd, 0x0d, 0x11, 0x00, 0x09,
+  0xd1, 0x01, 0x28, 0x13, 0xd1, 0xdf, 0x03, 0x20, 0x14, 0xe0, 0x01, 0x47,
+  0x30, 0x02, 0x29, 0xdf, 0x0f, 0xd1, 0x08, 0x46, 0x0f, 0x1f, 0x00, 0x01,
+  0xd0, 0x53, 0x02, 0x28, 0x1b, 0x00, 0x13, 0x02, 0x05, 0x23, 0x00, 0x01,
+  0x17, 0x00, 0xf1, 0x02, 0x95, 0x70, 0xd7, 0x90, 0xb1, 0x60, 0x40, 0xea,
+  0x81, 0x00, 0x7f, 0xdf, 0xf8, 0xd0, 0x16, 0x81, 0xf8, 0xb8, 0x69, 0x02,
+  0xff, 0xc4, 0x26, 0x92, 0xf8, 0xb8, 0x23, 0x01, 0x23, 0xfd, 0x03, 0xc9,
+  0x10, 0x00, 0x21, 0x00, 0xea, 0x02, 0x03, 0xff, 0x13, 0xf0, 0x03, 0x0f,
+  0x18, 0xbf, 0x01, 0x21, 0x7f, 0x05, 0xd1, 0x00, 0xea, 0x92, 0x00, 0x10,
+  0x0d, 0x02, 0xf9, 0x02, 0x6d, 0x11, 0x93, 0x00, 0x01, 0xea, 0x10, 0x10,
+  0x40, 0xf7, 0x1e, 0x40, 0xb2, 0x39, 0x01, 0x8c, 0x06, 0xd0, 0xf8, 0xff,
+  0x64, 0x13, 0xca, 0x03, 0x05, 0xd5, 0x90, 0xf8, 0x7f, 0xba, 0x23, 0x05,
+  0x2a, 0x01, 0xd1, 0x05, 0x13, 0x50, 0xf9, 0x49, 0x1b, 0x10, 0x0f, 0x00,
+  0x03, 0x01, 0x28, 0x00, 0xd0, 0x5d, 0xff, 0x0f, 0x00, 0xdf, 0xf8, 0x64,
+  0x27, 0x02, 0x8a, 0x27, 0x02, 0x57, 0xbb, 0x23, 0x06, 0x27, 0x00, 0x06,
+  0x17, 0x00, 0x09, 0x27, 0x02, 0xe7, 0xbb, 0x03, 0x02, 0x27, 0x04, 0x8b,
+  0x41, 0x00, 0xf0, 0x47, 0x73, 0xfb, 0x84, 0x83, 0x54, 0xb9, 0x81, 0xf1,
+  0x4f, 0x0c, 0x53, 0x20, 0xff, 0x24, 0x86, 0xdf, 0xf8, 0xf0, 0xaa, 0x15,
+  0x46, 0xff, 0x01, 0x26, 0x04, 0xf0, 0x04, 0x0b, 0x08, 0xf2, 0xff, 0xb9,
+  0x39, 0x00, 0x98, 0xf0, 0x40, 0xc0, 0x07, 0xff, 0x6d, 0xd5, 0x08, 0xeb,
+  0x86, 0x00, 0xc7, 0x6f, 0xdf, 0x23, 0xe0, 0x38, 0x78, 0x05, 0xf1, 0x00,
+  0xff, 0xf7, 0xff, 0xb5, 0xff, 0x85, 0x42, 0x66, 0xd0, 0x03, 0x2d, 0xff,
+  0x03, 0xd1, 0x99, 0xf8, 0x03, 0x00, 0x00, 0x28, 0x5f, 0x60, 0xd1, 0x38,
+  0x78, 0x06, 0x19, 0x02, 0xbc, 0x19, 0x00, 0xe5, 0x59, 0x19, 0x08, 0x53,
+  0x19, 0x00, 0x19, 0x11, 0xe1, 0x07, 0x4e, 0xfb, 0xd4, 0x02, 0x07, 0x00,
+  0xa0, 0x07, 0x4a, 0xd4, 0xff, 0xff, 0x6a, 0x00, 0x2f, 0x43, 0xd0, 0x78,
+  0x7b, 0x00, 0xff, 0x28, 0xf9, 0xd0, 0x79, 0x88, 0xd8, 0xf8, 0x48, 0xbf,
+  0x03, 0x11, 0xf8, 0x0a, 0x10, 0xc8, 0x69, 0x00, 0xf1, 0xf7, 0xd5, 0x38,
+  0x7b, 0x77, 0x11, 0x04, 0x28, 0x25, 0xd0, 0xf7, 0x05, 0x28, 0xc7, 0x5f,
+  0x10, 0x1f, 0xd1, 0x39, 0x78, 0xef, 0x99, 0xf8, 0x00, 0x00, 0x97, 0x11,
+  0xbb, 0xf1, 0x00, 0xfb, 0x0f, 0xe0, 0x5b, 0x00, 0x29, 0xd0, 0x01, 0x2d,
+  0x02, 0xff, 0xd1, 0xc0, 0x07, 0xda, 0xd5, 0x24, 0xe0, 0x02, 0xff, 0x2d,
+  0xd7, 0xd1, 0x0b, 0xe0, 0x04, 0x29, 0xd4, 0xff, 0xd1, 0x21, 0x07, 0xd2,
+  0xd5, 0x03, 0x2d, 0x1b, 0xff, 0xd0, 0x02, 0x2d, 0x01, 0xd1, 0x00, 0x07,
+  0xf0, 0xff, 0xe7, 0x01, 0x2d, 0xca, 0xd1, 0x80, 0x07, 0xec, 0xef, 0xe7,
+  0x03, 0x28, 0xc6, 0x43, 0x00, 0x03, 0x29, 0x03, 0xfe, 0x3f, 0x02, 0x04,
+  0xd1, 0xbf, 0xe7, 0x04, 0x29, 0xbd, 0xef, 0xd1, 0x20, 0x07, 0xbb, 0x2d,
+  0x00, 0xb9, 0xd1, 0x03, 0x7f, 0xe0, 0x76, 0x1c, 0x07, 0x2e, 0x8a, 0xdb,
+  0x3b, 0x90, 0xf6, 0x4b, 0x60, 0xf2, 0x8f, 0x95, 0x40, 0x41, 0xdf, 0xf8,
+  0xec, 0xff, 0x59, 0x80, 0x46, 0x95, 0xf8, 0x4c, 0x00, 0xc0, 0xff, 0x07,
+  0x0e, 0x46, 0x04, 0xd5, 0x28, 0x7a, 0x01, 0xff, 0x28, 0x08, 0xbf, 0x00,
+  0x20, 0x2d, 0xd0, 0x2c, 0x7f, 0x6d, 0xc6, 0xf3, 0x02, 0x17, 0x4c, 0xb1,
+  0xd1, 0x41, 0x7f, 0xaa, 0xfe, 0x28, 0xb1, 0x3a, 0x46, 0x31, 0x23, 0xa0,
+  0xbf, 0xff, 0xf7, 0x5e, 0xff, 0x20, 0xb9, 0x0b, 0x01, 0x7f, 0xfe, 0x05,
+  0x30, 0x58, 0xff, 0x00, 0x28, 0xa9, 0x7a, 0x14, 0xff, 0xbf, 0x07, 0x7b,
+  0x00, 0x27, 0x79, 0xb1, 0x2e, 0xbb, 0x88, 0xf0, 0x69, 0x30, 0x8a, 0xfa,
+  0xb8, 0x7b, 0x01, 0xbf, 0xff, 0x00, 0x7b, 0xb8, 0x42, 0x0c, 0xd0, 0xe8,
+  0x7a, 0xfb, 0x50, 0xb9, 0x15, 0x01, 0x07, 0xf9, 0x06, 0xe0, 0x00, 0xff,
+  0x2e, 0x04, 0xd4, 0x18, 0xb1, 0x40, 0x88, 0x31, 0x36, 0x45, 0x00, 0x9d,
+  0xfc, 0x9d, 0x31, 0xf0, 0x81, 0xf3, 0x54, 0xc1, 0x22, 0xff, 0x6c, 0xf8,
+  0x20, 0x68, 0x0f, 0x28, 0x00, 0xf0, 0xf7, 0x28, 0xf8, 0x25, 0x5b, 0x80,
+  0x80, 0x24, 0xd2, 0xf8, 0xbf, 0xbc, 0x60, 0x28, 0x46, 0x41, 0x08, 0xbf,
+  0xe1, 0x01, 0xff, 0xf1, 0xc0, 0x03, 0xf8, 0x31, 0xc6, 0x40, 0xf6, 0xff,
+  0x07, 0x04, 0xd5, 0xbd, 0xe8, 0x70, 0x40, 0x01, 0xfe, 0x19, 0xb0, 0x95,
+  0xb9, 0x1d, 0x60, 0x01, 0x25, 0x64, 0xcf, 0x68, 0x5c, 0x60, 0x05, 0x67,
+  0x20, 0x2d, 0x00, 0x40, 0x20, 0xff, 0x43, 0xc2, 0xf8, 0xbc, 0x00, 0x0d,
+  0x60, 0x4b, 0xfb, 0x60, 0x08, 0xe1, 0x00, 0x70, 0x40, 0x5d, 0xe4, 0x9d,
+  0xff, 0xf8, 0x00, 0x10, 0x48, 0x1e, 0x80, 0x41, 0xc0, 0xff, 0x0f, 0x04,
+  0xf0, 0x3c, 0xb8, 0xf8, 0xb5, 0x06, 0xff, 0x46, 0x37, 0x68, 0x0e, 0x2f,
+  0x20, 0xd2, 0x00, 0xfb, 0x21, 0x38, 0x05, 0x20, 0x1c, 0x44, 0x04, 0xf0,
+  0x5c, 0xfd, 0xf9, 0x8b, 0xf0, 0x05, 0xf8, 0xb2, 0x29, 0x78, 0x05, 0xff,
+  0xf0, 0x44, 0xfb, 0x00, 0x28, 0x40, 0xf0, 0xa6, 0xff, 0x80, 0x6f, 0xb1,
+  0x02, 0x2f, 0x10, 0xd0, 0x04, 0xff, 0x2f, 0x19, 0xd0, 0x06, 0x2f, 0x5f,
+  0xd0, 0x08, 0xff, 0x2f, 0x4f, 0xd0, 0x0a, 0x2f, 0x69, 0xd0, 0x0c, 0xbd,
+  0x2f, 0x4d, 0x50, 0x80, 0x93, 0xe0, 0x70, 0x4f, 0x90, 0x8f, 0x5e, 0x0b,
+  0x70, 0xf2, 0xbd, 0x74, 0x68, 0x5b, 0xb1, 0xd4, 0x35, 0xb0, 0xf7, 0x28,
+  0x70, 0x00, 0x97, 0x30, 0x05, 0xf0, 0xab, 0xfb, 0xf7, 0xf2, 0xe7, 0x10,
+  0x13, 0x00, 0xca, 0xf8, 0x04, 0xf0, 0xe7, 0xfa, 0xfd, 0x01, 0x73, 0xa1,
+  0x0d, 0x00, 0x40, 0xf9, 0x04, 0xbb, 0x20, 0x00, 0xcb, 0x60, 0xe4, 0xe7,
+  0x04, 0x29, 0x00, 0x1c, 0xff, 0x21, 0x00, 0x20, 0xa8, 0x64, 0x04, 0xf1,
+  0xa0, 0xef, 0x00, 0x03, 0xf0, 0x47, 0x6f, 0x80, 0xfd, 0xfb, 0x48, 0xff,
+  0xb1, 0x4f, 0xf0, 0x7f, 0x42, 0x40, 0xf6, 0xff, 0xbd, 0x73, 0x4d, 0x30,
+  0xf0, 0x0d, 0xf9, 0x68, 0x49, 0x00, 0x6b, 0x7f, 0xfb, 0xff, 0xf7, 0x06,
+  0xfb, 0x07, 0x22, 0x77, 0xf0, 0xfa, 0x13, 0x00, 0x03, 0x41, 0x02, 0x41,
+  0xfb, 0x00, 0x25, 0x6c, 0xfe, 0x21, 0x60, 0x05, 0x40, 0x00, 0xf2, 0x14,
+  0x50, 0x05, 0xff, 0xf0, 0x20, 0xfc, 0x6d, 0x1c, 0x12, 0x2d, 0xf5, 0xbf,
+  0xd3, 0xb8, 0xe7, 0x74, 0x68, 0x12, 0x67, 0x00, 0x8f, 0xff, 0xf8, 0x21,
+  0x46, 0x00, 0x20, 0x05, 0xf0, 0x18, 0xf9, 0xfc, 0x91, 0x70, 0x0f, 0x00,
+  0x04, 0xf9, 0x08, 0x20, 0xc2, 0xaa, 0x1b, 0x00, 0x11, 0x0b, 0x00, 0x81,
+  0x1b, 0x00, 0x01, 0x1b, 0x00, 0x0a, 0xfa, 0x1b, 0x00, 0x06, 0x0f, 0x00,
+  0xf6, 0xf8, 0x06, 0x20, 0xb4, 0xfa, 0x1b, 0x00, 0x14, 0x0b, 0x00, 0x73,
+  0xf8, 0x29, 0x78, 0xe0, 0xff, 0xb2, 0x05, 0xf0, 0xb4, 0xfa, 0x48, 0xb9,
+  0xc4, 0xf3, 0xf3, 0x42, 0x1d, 0x42, 0x67, 0x43, 0xf9, 0xfb, 0x00, 0xe0,
+  0xf7, 0x04, 0x20, 0x01, 0x87, 0x62, 0xdd, 0xf8, 0x0a, 0x20, 0x7d, 0x9b,
+  0x31, 0x00, 0x20, 0x06, 0x45, 0x0f, 0x13, 0x0f, 0x00, 0xef, 0x58, 0xf8,
+  0x03, 0x2d, 0xc5, 0x30, 0x2d, 0x11, 0xbf, 0x7c, 0x9b, 0x00, 0x2d, 0x02,
+  0xe2, 0xfb, 0x01, 0x46, 0x0c, 0x19, 0x00, 0xff, 0xc8, 0xf8, 0x0c, 0x20,
+  0x86, 0xe7, 0x03, 0xf0, 0x9f, 0x83, 0xff, 0x6b, 0xe7, 0x80, 0xbf, 0x90,
+  0xe1, 0x61, 0xe3, 0xdf, 0xfa, 0x65, 0xe7, 0x01, 0x46, 0xef, 0xb1, 0xb9,
+  0xf8, 0xfd, 0xf6, 0xd7, 0x80, 0x82, 0xb0, 0x00, 0xf0, 0x74, 0xf9, 0xf6,
+  0x23, 0x90, 0x7e, 0x05, 0x7f, 0x70, 0x04, 0x20, 0x20, 0x76, 0xd6, 0xa5,
+  0x81, 0x19, 0xf9, 0x2b, 0x63, 0x01, 0xc9, 0x50, 0x13, 0xfa, 0xff, 0xff,
+  0xf7, 0x1f, 0xff, 0xdf, 0xf8, 0x70, 0x1b, 0xad, 0x01, 0x8b, 0x60, 0x57,
+  0x00, 0xb5, 0x01, 0x1e, 0x4f, 0x50, 0x16, 0xea, 0xa7, 0x82, 0x0d, 0x45,
+  0x20, 0x12, 0xed, 0x80, 0xb0, 0x7b, 0x28, 0x5d, 0xb1, 0xf9, 0x81, 0xb2,
+  0xf8, 0x05, 0x1f, 0x00, 0x0e, 0x1f, 0x00, 0x7f, 0x70, 0x73, 0xb0, 0x73,
+  0x01, 0x21, 0x30, 0x73, 0x00, 0xeb, 0xea, 0xf8, 0xd5, 0x01, 0x45, 0x8b,
+  0x80, 0x2c, 0x1b, 0x01, 0xff, 0xeb, 0x84, 0x01, 0x00, 0x20, 0x48, 0x60,
+  0x30, 0xff, 0x69, 0xff, 0xf7, 0x3e, 0xfd, 0x70, 0x6a, 0x33, 0x3f, 0x69,
+  0x00, 0x22, 0x29, 0x46, 0x98, 0x7d, 0xb1, 0x71, 0xf0, 0x97, 0x83, 0xb0,
+  0x07, 0x2f, 0x00, 0x2c, 0x8f, 0x00, 0x85, 0x01, 0xf4, 0xff, 0xf8, 0x20,
+  0x7e, 0xdf, 0xf8, 0xf8, 0x5a, 0x05, 0xad, 0x28, 0x27, 0x90, 0x06, 0x11,
+  0x0b, 0x10, 0x38, 0x6d, 0x00, 0xc4, 0xbf, 0xff, 0x30, 0x7a, 0x05, 0x28,
+  0x0a, 0x1d, 0x50, 0x30, 0x29, 0x72, 0xd7, 0xd0, 0xe7, 0x60, 0x35, 0xe5,
+  0x10, 0x0c, 0x77, 0x50, 0xc9, 0x00, 0xce, 0x6d, 0x60, 0x60, 0x73, 0x02,
+  0xc5, 0x00, 0x0b, 0x60, 0x70, 0x30, 0x7d, 0x80, 0x55, 0x00, 0x81, 0x00,
+  0x2f, 0x04, 0xbf, 0x31, 0x03, 0x79, 0x08, 0x2b, 0xd0, 0x1d, 0x60, 0x30,
+  0x01, 0x90, 0x68, 0x65, 0x00, 0xfd, 0x20, 0xa3, 0x00, 0x00, 0xf0, 0x5b,
+  0xfa, 0x20, 0x7b, 0xff, 0x05, 0xeb, 0x80, 0x01, 0x01, 0x22, 0xc9, 0x6f,
+  0xbf, 0x04, 0xe0, 0x4b, 0x7b, 0x01, 0x2b, 0x77, 0x30, 0x22, 0xff, 0xc9,
+  0x6a, 0x00, 0x29, 0xf8, 0xd1, 0x32, 0xb1, 0x73, 0xf1, 0x6c, 0xa9, 0x90,
+  0xd5, 0x20, 0x21, 0xea, 0x00, 0x8a, 0xb0, 0x74, 0xed, 0xa1, 0x09, 0x21,
+  0x02, 0x67, 0x10, 0x04, 0xf0, 0x27, 0xc7, 0x22, 0xfa, 0x43, 0x01, 0xd4,
+  0xb1, 0x70, 0x50, 0x5a, 0xd5, 0xf8, 0xc8, 0xff, 0x70, 0x05, 0xf1, 0x54,
+  0x04, 0xa0, 0x6e, 0x80, 0xef, 0x08, 0x00, 0xf0, 0x01, 0x55, 0x20, 0xc7,
+  0xfe, 0x02, 0xfd, 0x2f, 0xf1, 0x43, 0x03, 0xf0, 0xc1, 0xfe, 0x71, 0x68,
+  0xbd, 0xc9, 0x63, 0x80, 0x03, 0xf0, 0xfd, 0xff, 0x87, 0x11, 0x1f, 0xff,
+  0xfa, 0x70, 0x68, 0x70, 0xb9, 0x05, 0xf0, 0x81, 0xff, 0xfc, 0x48, 0xb1,
+  0x03, 0x20, 0x20, 0x70, 0x01, 0xff, 0x20, 0x85, 0xf8, 0x4c, 0x03, 0x04,
+  0xf0, 0x99, 0xfe, 0x6f, 0x20, 0xcd, 0xff, 0x08, 0xe0, 0x02, 0x20, 0x05,
+  0xfd, 0xe0, 0x0f, 0x40, 0x03, 0x00, 0x28, 0x14, 0xbf, 0x03, 0xed, 0x20,
+  0xd1, 0x00, 0x70, 0x01, 0xaf, 0x20, 0xff, 0xf7, 0x45, 0xbd, 0xff, 0xf1,
+  0x21, 0x80, 0xb5, 0x00, 0xf0, 0xa3, 0x40, 0x21, 0xff, 0x81, 0x73, 0x02,
+  0x7b, 0xdf, 0xf8, 0xd4, 0x19, 0xff, 0x01, 0xeb, 0x82, 0x02, 0xd2, 0xf8,
+  0xa0, 0x30, 0x37, 0x5b, 0x1e, 0xc2, 0x05, 0x00, 0x00, 0x7b, 0x81, 0xe0,
+  0x0f, 0x01, 0x7f, 0x20, 0x42, 0xb9, 0xd1, 0xf8, 0x9c, 0x20, 0x01, 0x63,
+  0xfd, 0x22, 0xc3, 0x00, 0xc1, 0xf8, 0x9c, 0x00, 0x00, 0x20, 0xdd, 0x02,
+  0xb9, 0x14, 0x20, 0x7b, 0x06, 0xb9, 0x66, 0x03, 0xf0, 0xfb, 0x70, 0xfe,
+  0xb9, 0x61, 0x00, 0x2d, 0x23, 0x48, 0x0c, 0xff, 0xbf, 0x60, 0x30, 0x7c,
+  0x30, 0x50, 0xf8, 0x26, 0xff, 0x10, 0x19, 0xb9, 0x40, 0xf8, 0x26, 0x40,
+  0x04, 0xdf, 0xe0, 0x01, 0x46, 0xc8, 0x6a, 0x59, 0xa1, 0xcc, 0x62, 0x7e,
+  0xa7, 0x11, 0x00, 0x00, 0xfc, 0x07, 0x00, 0x20, 0xfd, 0x01, 0xdf, 0x0f,
+  0x46, 0x30, 0x7b, 0x04, 0x43, 0x08, 0x4e, 0xfe, 0xdf, 0xdf, 0xf8, 0x48,
+  0x19, 0x00, 0xf5, 0x01, 0xf1, 0x60, 0xff, 0x02, 0x01, 0xf1, 0x7c, 0x02,
+  0x52, 0xf8, 0x24, 0xff, 0x00, 0xb0, 0x42, 0x11, 0xd1, 0xc3, 0x6a, 0x42,
+  0xff, 0xf8, 0x24, 0x30, 0x3b, 0xb9, 0x04, 0x7b, 0xd1, 0xfb, 0xf8, 0x98,
+  0x91, 0x00, 0xa3, 0x40, 0x9a, 0x43, 0xc1, 0xf8, 0x09, 0x00, 0xf7, 0xa0,
+  0x53, 0x00, 0xf2, 0xbd, 0x05, 0x46, 0xc0, 0xee, 0x61, 0x00, 0x18, 0xbf,
+  0xb0, 0x33, 0xa0, 0xb0, 0x42, 0x02, 0x9f, 0xd1, 0xc1, 0x6a, 0xe9, 0x62,
+  0x51, 0x50, 0x19, 0x00, 0xb8, 0xd7, 0x04, 0x00, 0x20, 0x25, 0x60, 0x18,
+  0xcf, 0x60, 0x24, 0xd1, 0xff, 0xf8, 0x50, 0x13, 0x80, 0x5c, 0x1d, 0xe0,
+  0x00, 0xcf, 0xe1, 0x00, 0xe0, 0x80, 0x03, 0x00, 0x59, 0x61, 0x04, 0x2c,
+  0xda, 0x7d, 0x05, 0x0f, 0x7d, 0x00, 0xc8, 0x08, 0x5d, 0xd1, 0xd0, 0xf8,
+  0xfb, 0xa8, 0x43, 0x03, 0x90, 0xf8, 0xa0, 0x42, 0x34, 0xbf, 0x7b, 0x20,
+  0x1a, 0x71, 0x61, 0x00, 0x00, 0x61, 0x2c, 0x47, 0x01, 0xfb, 0xa8, 0x18,
+  0x9d, 0xf1, 0x40, 0x68, 0x70, 0x47, 0x80, 0xfa, 0x7d, 0x96, 0x04, 0xbf,
+  0x10, 0x94, 0x08, 0x00, 0x68, 0x02, 0x75, 0xbd, 0x45, 0x01, 0xec, 0x5d,
+  0x10, 0xff, 0xf7, 0xf0, 0xf1, 0x20, 0x9f, 0x54, 0x14, 0x40, 0x5c, 0x02,
+  0x73, 0x90, 0xfb, 0x80, 0x48, 0xbf, 0x20, 0x68, 0x10, 0xf1, 0x01, 0x0f,
+  0x23, 0x53, 0x03, 0xc7, 0xf0, 0xda, 0xfd, 0x3b, 0x03, 0x9d, 0xf1, 0x5d,
+  0xc1, 0xff, 0xf7, 0xeb, 0xd2, 0xff, 0x41, 0x55, 0x03, 0xfd, 0xb0, 0x60,
+  0x68, 0x10, 0x7d, 0xbd, 0x57, 0x80, 0xf0, 0x56, 0xf8, 0x0e, 0x46, 0x15,
+  0x05, 0xdd, 0xc0, 0x33, 0x06, 0xcc, 0xff, 0x67, 0x61, 0xe2, 0x07, 0xf1,
+  0x3f, 0x18, 0x02, 0x02, 0xf0, 0xd3, 0xff, 0x8b, 0x11, 0x0f, 0x03, 0xfd,
+  0x19, 0x0f, 0x00, 0xcb, 0xff, 0x03, 0x2e, 0x14, 0xd8, 0xff, 0xdf, 0xe8,
+  0x06, 0xf0, 0x02, 0x07, 0x0a, 0x0d, 0xf7, 0x22, 0x46, 0x2b, 0xef, 0x50,
+  0x29, 0x46, 0x09, 0xe0, 0xfe, 0x09, 0x01, 0x04, 0xe0, 0x02, 0x46, 0x0b,
+  0x46, 0x03, 0x5c, 0x05, 0x02, 0xf1, 0x71, 0x03, 0xf0, 0xe4, 0xb5, 0x10,
+  0xf2, 0x17, 0xa2, 0xaf, 0xff, 0xf7, 0x96, 0xff, 0x89, 0x01, 0x8d, 0xf7,
+  0xa0, 0x1a, 0xb5, 0xf8, 0x75, 0x05, 0x85, 0x75, 0x06, 0x91, 0xff, 0xd3,
+  0x31, 0x00, 0xfb, 0x22, 0x08, 0xff, 0x91, 0xf8, 0xff, 0xf7, 0x35, 0xfd,
+  0xf7, 0xa0, 0x6a, 0x69, 0x4b, 0xa0, 0xbd, 0xfc, 0xff, 0xf7, 0x73, 0x2f,
+  0xfd, 0xcf, 0x31, 0x75, 0xc1, 0x8c, 0x07, 0x00, 0xe9, 0x02, 0x3c, 0x0f,
+  0xf0, 0xf7, 0x00, 0x80, 0x07, 0x83, 0xb0, 0x0f, 0x03, 0x4f, 0x05, 0xfd,
+  0x5d, 0x4f, 0x06, 0x69, 0xff, 0xff, 0xf7, 0x71, 0xff, 0xdb, 0x01, 0xa9,
+  0xa5, 0x90, 0x23, 0x82, 0x55, 0x00, 0xfd, 0xf7, 0xd5, 0x72, 0x9b, 0x20,
+  0x0e, 0x65, 0xb1, 0x47, 0xa5, 0xa0, 0xf0, 0x96, 0xf6, 0x55, 0x10, 0x44,
+  0x07, 0xf9, 0x80, 0x47, 0x03, 0xf0, 0x49, 0xe5, 0xfe, 0xdd, 0x51, 0x02,
+  0x75, 0x50, 0x57, 0xc0, 0x20, 0xc0, 0x46, 0xfa, 0x45, 0x31, 0x01, 0xcd,
+  0x20, 0x5b, 0xfe, 0x03, 0xf0, 0x8b, 0xbf, 0xff, 0x20, 0x65, 0x09, 0xe0,
+  0x40, 0xd9, 0x30, 0x57, 0xef, 0xfe, 0x21, 0x6d, 0x48, 0x07, 0x00, 0x76,
+  0xfc, 0x01, 0xfe, 0x69, 0x00, 0xf5, 0xfe, 0x20, 0x68, 0x6a, 0x46, 0x00,
+  0xee, 0xad, 0x00, 0xfb, 0xf8, 0x80, 0x1f, 0x10, 0xd8, 0xf8, 0x00, 0xff,
+  0xa0, 0x03, 0xf0, 0xcc, 0xfe, 0x5f, 0xfa, 0x8a, 0x7f, 0xf0, 0x0a, 0x28,
+  0x4f, 0xea, 0x1a, 0x27, 0xa5, 0xe0, 0xfb, 0x09, 0xe5, 0x29, 0x10, 0x00,
+  0xf0, 0x08, 0x13, 0x37, 0xff, 0x46, 0x4a, 0x06, 0x06, 0x06, 0x07, 0x56,
+  0x69, 0xff, 0x00, 0xdc, 0xe7, 0xd8, 0xe7, 0x84, 0xf8, 0x60, 0xff, 0x93,
+  0x03, 0xf0, 0x5e, 0xff, 0x01, 0x46, 0x21, 0xfb, 0x65, 0x02, 0x4b, 0x00,
+  0xe5, 0xfd, 0xb1, 0x46, 0xd0, 0xff, 0xe7, 0xb4, 0xf8, 0xc0, 0x03, 0xd8,
+  0xf8, 0x04, 0xff, 0x30, 0x04, 0xeb, 0xc0, 0x00, 0x00, 0xf5, 0x71, 0x3f,
+  0x72, 0xd3, 0xe9, 0x00, 0x01, 0xc2, 0x03, 0x00, 0x13, 0x00, 0x9f, 0x00,
+  0xff, 0xf7, 0xb4, 0xfc, 0x1f, 0x01, 0x09, 0x20, 0x16, 0xf7, 0x09, 0x68,
+  0x04, 0x23, 0x20, 0xc0, 0xf8, 0x44, 0x14, 0xee, 0x11, 0x01, 0x40, 0x1c,
+  0xa4, 0x05, 0x00, 0x80, 0xb2, 0x10, 0xf7, 0x28, 0xaf, 0xdb, 0x09, 0x00,
+  0x93, 0xac, 0xe7, 0x28, 0xee, 0x93, 0x80, 0xa9, 0xd0, 0xf8, 0x6b, 0x10,
+  0xd7, 0xfe, 0x02, 0xff, 0x7b, 0x69, 0x6c, 0x06, 0xfa, 0x02, 0xf2, 0x11,
+  0xff, 0x43, 0x69, 0x64, 0x06, 0x76, 0x46, 0x73, 0x9d, 0xdd, 0xe7, 0x17,
+  0x01, 0x9a, 0xfd, 0x99, 0x07, 0x02, 0xc7, 0xfe, 0xaf, 0x07, 0x46, 0x01,
+  0x21, 0x2b, 0x10, 0xfe, 0xbb, 0x43, 0x43, 0xab, 0xfe, 0x8d, 0x17, 0x02,
+  0xbb, 0x37, 0x00, 0xa9, 0x37, 0x04, 0xa9, 0xff, 0x64, 0x01, 0x7b, 0x04,
+  0xeb, 0x81, 0x01, 0xd1, 0xee, 0xaf, 0x30, 0x52, 0x1c, 0xc1, 0x05, 0x00,
+  0x86, 0x73, 0x7a, 0x6e, 0x25, 0x02, 0x0c, 0xfe, 0x76, 0x39, 0xa0, 0x08,
+  0x06, 0x03, 0x50, 0xff, 0x25, 0x00, 0x68, 0x41, 0x68, 0x11, 0x60, 0x90,
+  0xd7, 0xf8, 0x32, 0x10, 0x1b, 0x11, 0x7d, 0xdf, 0xd2, 0x72, 0xb6, 0xf7,
+  0x03, 0xf0, 0xaf, 0x4d, 0xf0, 0xd4, 0x05, 0xd0, 0xf8, 0xff, 0xbc, 0x10,
+  0x01, 0x22, 0xa2, 0x40, 0x91, 0x43, 0x6d, 0xc0, 0x09, 0x00, 0x62, 0xb6,
+  0xef, 0x21, 0x80, 0xf2, 0xaf, 0x40, 0xfb, 0xb5, 0x0f, 0xf3, 0x20, 0xb4,
+  0x55, 0x03, 0xf0, 0x45, 0xed, 0xfd, 0x43, 0x50, 0x04, 0x20, 0x57, 0x80,
+  0x10, 0xd1, 0xa0, 0x7f, 0x7a, 0x28, 0xb1, 0x05, 0x20, 0x20, 0x72, 0x4f,
+  0x41, 0x7f, 0xfe, 0xfc, 0x3f, 0xe0, 0x08, 0x20, 0x01, 0x17, 0x52, 0xff,
+  0x02, 0x90, 0x01, 0xa8, 0xff, 0xf7, 0x94, 0xfd, 0xdb, 0x33, 0xe0, 0xf9,
+  0x61, 0x13, 0xfb, 0x05, 0x01, 0xe3, 0xfa, 0xdc, 0x29, 0x01, 0x9f, 0x91,
+  0x42, 0xf9, 0x05, 0x93, 0x90, 0x47, 0x68, 0xff, 0x8f, 0xb1, 0x78, 0x88,
+  0x22, 0x88, 0xc1, 0xb2, 0xff, 0x91, 0x42, 0x08, 0xd1, 0x39, 0x7e, 0x05,
+  0x29, 0xfb, 0x05, 0xd0, 0x75, 0x21, 0xda, 0xfc, 0x05, 0x20, 0x38, 0xdf,
+  0x76, 0x03, 0xe0, 0x01, 0x21, 0x0d, 0x01, 0xf2, 0xfc, 0xff, 0x76, 0x1c,
+  0x12, 0x2e, 0xe6, 0xdb, 0x20, 0x88, 0xfe, 0x93, 0xb1, 0x88, 0x42, 0x0d,
+  0xd1, 0x05, 0xf0, 0x0c, 0xb3, 0xfa, 0x50, 0xe9, 0x41, 0xb3, 0x50, 0x27,
+  0xf9, 0xf9, 0x10, 0xfd, 0x47, 0x03, 0xf0, 0x32, 0xbb, 0x20, 0x2b, 0x10,
+  0x35, 0x20, 0xfe, 0xc1, 0x22, 0xbe, 0x59, 0x25, 0x3c, 0xfe, 0xff, 0xf7,
+  0x30, 0x03, 0x00, 0x42, 0x7d, 0xfe, 0x53, 0x37, 0x21, 0xfc, 0x6b, 0x46,
+  0x02, 0x8f, 0x60, 0xbf, 0x20, 0x46, 0xfd, 0xf7, 0xd4, 0xfd, 0x5f, 0x51,
+  0x16, 0xfe, 0x33, 0x00, 0x00, 0x24, 0xc0, 0xf3, 0x47, 0x12, 0x00, 0xf5,
+  0x2a, 0xd3, 0xa0, 0x2a, 0x53, 0x50, 0x00, 0x14, 0xd1, 0x02, 0xff, 0x29,
+  0x10, 0xd2, 0x0c, 0x23, 0x58, 0x43, 0x00, 0xd7, 0x2a, 0x0c, 0xbf, 0x0b,
+  0xb0, 0x24, 0x03, 0x01, 0x80, 0x18, 0xdf, 0x82, 0x68, 0x50, 0xf8, 0x21,
+  0x87, 0xf0, 0xc8, 0x04, 0xff, 0x05, 0xf0, 0x0b, 0xfb, 0x02, 0xe0, 0x05,
+  0x24, 0x6e, 0x4f, 0x70, 0x24, 0x20, 0x46, 0x27, 0x11, 0x68, 0x76, 0xcb,
+  0x41, 0xff, 0xdf, 0xf8, 0x90, 0x04, 0xd0, 0xf8, 0x50, 0x03, 0xff, 0x05,
+  0x68, 0x16, 0x48, 0x44, 0x89, 0x04, 0xf0, 0xff, 0x03, 0x00, 0xc4, 0xf3,
+  0x83, 0x01, 0x41, 0xea, 0xdf, 0x00, 0x11, 0x41, 0xea, 0x80, 0x03, 0x00,
+  0x00, 0x21, 0xfc, 0x07, 0x00, 0x03, 0x00, 0x00, 0x30, 0x00, 0xea, 0x05,
+  0x06, 0xbf, 0xff, 0xf7, 0x6d, 0xfa, 0x05, 0x28, 0xe5, 0x40, 0x27, 0x97,
+  0x00, 0x27, 0xff, 0xf3, 0xd0, 0x06, 0x0b, 0x01, 0xa7, 0x00, 0x47, 0xff,
+  0xea, 0x40, 0x00, 0x15, 0xea, 0x00, 0x40, 0x07, 0xff, 0xd0, 0x00, 0x90,
+  0x00, 0x98, 0x80, 0x0b, 0x00, 0xfb, 0xea, 0x94, 0x38, 0x60, 0x0c, 0x00,
+  0x06, 0x43, 0x30, 0xfe, 0x45, 0xc1, 0x00, 0x74, 0x29, 0x00, 0x20, 0xf4,
+  0x1e, 0xba, 0x65, 0x90, 0x05, 0x8b, 0x41, 0x1c, 0x14, 0xd1, 0x3d, 0xb0,
+  0xc1, 0xf3, 0x40, 0x01, 0xcd, 0x00, 0x25, 0xb3, 0xff, 0xf7, 0xba, 0xff,
+  0xf3, 0xe0, 0x40, 0xdd, 0x01, 0x23, 0xb1, 0xf0, 0x43, 0x00, 0x24, 0xff,
+  0x85, 0xb0, 0x03, 0x46, 0xde, 0xb2, 0x0f, 0x46, 0xff, 0x18, 0x0a, 0x40,
+  0x2e, 0x4f, 0xea, 0x13, 0x4c, 0xb7, 0x00, 0xf0, 0x0f, 0x75, 0xe0, 0xe4,
+  0x83, 0x47, 0xc0, 0x53, 0xff, 0x18, 0xbf, 0x41, 0x2e, 0x0c, 0xf0, 0x01,
+  0x0e, 0xfe, 0x97, 0x80, 0x00, 0xc3, 0xf3, 0x07, 0x22, 0x08, 0xf5, 0xff,
+  0x51, 0x79, 0x2b, 0xd0, 0x42, 0x2e, 0x2e, 0xd0, 0xff, 0x43, 0x2e, 0x32,
+  0xd0, 0x44, 0x2e, 0x25, 0xd0, 0xff, 0x60, 0x2e, 0x35, 0xd0, 0x61, 0x2e,
+  0x00, 0xf0, 0x7f, 0x73, 0x81, 0x62, 0x2e, 0x68, 0xd0, 0x63, 0x09, 0x00,
+  0x77, 0x4d, 0x81, 0x64, 0x05, 0x00, 0x7b, 0x81, 0x65, 0x05, 0x00, 0x77,
+  0x80, 0x80, 0x66, 0x05, 0x00, 0x9c, 0x80, 0x67, 0x05, 0x00, 0x77, 0x1f,
+  0x81, 0x69, 0x05, 0x00, 0x39, 0x81, 0x6a, 0x05, 0x00, 0xf7, 0x7a, 0x81,
+  0x6b, 0x05, 0x00, 0x7f, 0x81, 0x6c, 0x2e, 0xf7, 0x03, 0xd0, 0x6d, 0x09,
+  0x00, 0x3e, 0x81, 0x7d, 0xe1, 0xfd, 0x00, 0x75, 0x90, 0x7a, 0x81, 0x05,
+  0xf0, 0x05, 0xfb, 0xdb, 0x77, 0xe1, 0x6b, 0x00, 0x41, 0x10, 0xab, 0x00,
+  0x3f, 0xff, 0xff, 0x3f, 0xe1, 0x14, 0x22, 0xdf, 0xf8, 0x74, 0x13, 0xfd,
+  0x28, 0x29, 0x20, 0x5f, 0xfa, 0x6a, 0xe1, 0x16, 0x46, 0xd7, 0xe0, 0x46,
+  0x30, 0x0b, 0x00, 0x03, 0xc1, 0x90, 0x00, 0xf0, 0xff, 0xfb, 0x80, 0x00,
+  0x2f, 0x30, 0x46, 0x11, 0xd0, 0xff, 0x05, 0xf0, 0x59, 0xfb, 0x18, 0xb9,
+  0x08, 0xf0, 0xff, 0x1f, 0x01, 0x00, 0x22, 0x06, 0xe0, 0x4f, 0xea, 0x9f,
+  0x08, 0x62, 0x10, 0x0f, 0x08, 0xc7, 0x00, 0xe7, 0x00, 0x02, 0xfe, 0x2d,
+  0x01, 0x25, 0xfb, 0x4d, 0xe1, 0x05, 0xf0, 0x0e, 0xbb, 0xfb, 0x07, 0x3b,
+  0x02, 0x39, 0xfb, 0x80, 0x07, 0x02, 0x3f, 0xf7, 0xfb, 0x3f, 0x02, 0x35,
+  0x02, 0x00, 0x38, 0x43, 0x36, 0xff, 0xe1, 0xb8, 0xf1, 0x13, 0x0f, 0x08,
+  0xbf, 0x2f, 0xe7, 0x60, 0xe9, 0xd0, 0x39, 0x00, 0x11, 0x00, 0x40, 0xf0,
+  0x10, 0x7b, 0x00, 0x2b, 0x95, 0x00, 0x40, 0xf0, 0x2f, 0x81, 0x3f, 0x20,
+  0x73, 0xf7, 0x69, 0x83, 0x80, 0x07, 0x01, 0x6e, 0xfd, 0x46, 0x7f, 0x10,
+  0x97, 0x04, 0x90, 0x01, 0x0b, 0x00, 0x5f, 0x13, 0x00, 0x07, 0x01, 0x64,
+  0x7e, 0x13, 0x02, 0x03, 0x90, 0x04, 0x22, 0x04, 0xa9, 0xa9, 0x01, 0xff,
+  0x0a, 0xfa, 0x04, 0x22, 0x03, 0xa9, 0x28, 0x1d, 0xf7, 0x02, 0xe1, 0xd9,
+  0xe7, 0xb0, 0x00, 0x2f, 0xda, 0xd0, 0xdd, 0x0f, 0xab, 0xb0, 0x28, 0x68,
+  0xc9, 0x0d, 0x00, 0x11, 0xe0, 0xff, 0xc3, 0xf3, 0x00, 0x32, 0x02, 0xeb,
+  0x41, 0x01, 0xbf, 0x14, 0x29, 0x28, 0xbf, 0x04, 0x24, 0xff, 0x71, 0x01,
+  0xff, 0xf1, 0x9a, 0x04, 0x4c, 0xbf, 0x08, 0x43, 0x88, 0xf7, 0x43, 0x00,
+  0x2c, 0x23, 0x01, 0x01, 0xd1, 0xfe, 0xf7, 0xff, 0xfc, 0xfd, 0xf3, 0xe0,
+  0x56, 0x1e, 0x07, 0x2e, 0xdf, 0xc3, 0xf3, 0x01, 0x41, 0xbc, 0xad, 0x52,
+  0x04, 0x20, 0xff, 0x57, 0x62, 0x4c, 0x4c, 0x6c, 0x12, 0x00, 0x2f, 0x7f,
+  0x67, 0xd0, 0x5f, 0xfa, 0x8c, 0xf1, 0x01, 0x95, 0x10, 0xff, 0x49, 0x07,
+  0x02, 0xd5, 0xfc, 0xf7, 0x9c, 0xff, 0xff, 0xdd, 0xe0, 0xfc, 0xf7, 0x8b,
+  0xff, 0xda, 0xe0, 0x7f, 0x00, 0x2f, 0x76, 0x46, 0x58, 0xd0, 0x29, 0xdf,
+  0x00, 0xdd, 0x03, 0x55, 0xf0, 0x00, 0x28, 0x52, 0x0b, 0x02, 0x02, 0xf0,
+  0xf7, 0xd2, 0xff, 0xcc, 0x77, 0x00, 0x83, 0x46, 0x00, 0x2f, 0xff, 0x18,
+  0xbf, 0x00, 0x2e, 0x0d, 0x46, 0x46, 0xd0, 0xff, 0x00, 0x27, 0x25, 0xfa,
+  0x07, 0xf0, 0xc0, 0x07, 0xff, 0x1b, 0xd5, 0x00, 0x2f, 0x14, 0xbf, 0x09,
+  0x20, 0xff, 0x08, 0x20, 0x98, 0xf8, 0x54, 0x10, 0x03, 0x29, 0xff, 0x04,
+  0xd0, 0xd9, 0xf8, 0x20, 0x10, 0xc1, 0x40, 0xdf, 0xc8, 0x07, 0x04, 0xd4,
+  0x31, 0xc7, 0x90, 0x05, 0xf0, 0xef, 0xd3, 0xfd, 0x09, 0xe0, 0x07, 0x01,
+  0xb2, 0xfd, 0x08, 0xdf, 0xb1, 0x01, 0x24, 0xa8, 0xe0, 0x15, 0x03, 0xb5,
+  0xfd, 0x7f, 0x7f, 0x1c, 0x02, 0x2f, 0xdc, 0xd3, 0xa0, 0x73, 0x00, 0x67,
+  0x1f, 0xd0, 0x05, 0x0d, 0x30, 0x25, 0xe0, 0x20, 0x0f, 0x97, 0x00, 0xdf,
+  0x06, 0xf0, 0x3d, 0xfb, 0x95, 0x15, 0x00, 0x14, 0xd0, 0xff, 0x0d, 0x46,
+  0x28, 0x46, 0x07, 0xf0, 0x3f, 0xff, 0x5d, 0x29, 0xad, 0xa2, 0x44, 0xfd,
+  0x8a, 0x15, 0x00, 0x09, 0x15, 0x00, 0x76, 0x9f, 0xa1, 0x3d, 0xfd, 0x1b,
+  0x01, 0x43, 0xff, 0x80, 0x13, 0x00, 0xef, 0x0c, 0x46, 0x7c, 0xd0, 0x7d,
+  0x00, 0x00, 0x03, 0x28, 0x7f, 0x78, 0xd1, 0x00, 0x25, 0x24, 0xfa, 0x05,
+  0x97, 0x00, 0xfb, 0x44, 0xbf, 0x49, 0x11, 0x8a, 0xfd, 0x6d, 0x1c, 0x02,
+  0xfe, 0xf9, 0xa0, 0x6c, 0xe0, 0x0e, 0xeb, 0x41, 0x00, 0xc0, 0xff, 0xb2,
+  0x06, 0x46, 0x13, 0x2e, 0x01, 0xdb, 0x05, 0xff, 0x24, 0x65, 0xe0, 0x7f,
+  0xb1, 0xfe, 0xf7, 0x58, 0x7d, 0xfd, 0xa7, 0xd1, 0x56, 0x48, 0x30, 0x5c,
+  0x08, 0x4f, 0x50, 0xff, 0x02, 0xab, 0x40, 0x68, 0x40, 0x68, 0x01, 0x22,
+  0xfd, 0x28, 0x29, 0x60, 0xe9, 0xfc, 0x54, 0xe0, 0xfe, 0xf7, 0xdf, 0x48,
+  0xfd, 0x28, 0x70, 0x50, 0x5f, 0x00, 0x4d, 0xd0, 0xfe, 0xeb, 0x30, 0xfc,
+  0x4b, 0xe0, 0x27, 0xb1, 0xd5, 0xe9, 0xff, 0x00, 0x23, 0x04, 0xf0, 0x90,
+  0xfc, 0x13, 0xe0, 0x5f, 0x07, 0xf0, 0x9d, 0xff, 0xc5, 0x9b, 0x50, 0x40,
+  0x2f, 0x20, 0xbf, 0x8c, 0x56, 0x18, 0x0b, 0xb6, 0x0d, 0xe5, 0x21, 0x4f,
+  0xff, 0xb1, 0x02, 0x28, 0xa8, 0xbf, 0x07, 0x24, 0x35, 0xfb, 0xda, 0x0a,
+  0xfb, 0xc0, 0x08, 0xf0, 0x28, 0xfc, 0x04, 0xbf, 0x46, 0x2f, 0xe0, 0xea,
+  0x1c, 0x29, 0x0b, 0x00, 0x4a, 0xff, 0xfc, 0x2a, 0xe0, 0x7f, 0xb9, 0x03,
+  0xf0, 0x6d, 0xff, 0xfc, 0x06, 0x46, 0x04, 0x2e, 0x05, 0xd1, 0x04, 0xd7,
+  0xf0, 0x2b, 0xfc, 0xf7, 0x10, 0x10, 0x89, 0x30, 0xe0, 0x00, 0xef, 0x96,
+  0x04, 0x22, 0x69, 0x43, 0x70, 0x0f, 0xb1, 0x02, 0xbf, 0x24, 0x17, 0xe0,
+  0x03, 0xf0, 0x51, 0x35, 0xa0, 0x0f, 0xeb, 0x00, 0x01, 0x11, 0x20, 0x01,
+  0x11, 0x22, 0x01, 0xf9, 0x0c, 0xf7, 0xe0, 0x17, 0xb1, 0xb7, 0xa0, 0xfc,
+  0x08, 0xe0, 0x04, 0x3f, 0xf0, 0x0f, 0xfc, 0x28, 0x60, 0x04, 0x0f, 0x00,
+  0x69, 0x20, 0x5f, 0xff, 0x00, 0xe0, 0x03, 0x24, 0xbd, 0xa0, 0xb0, 0x25,
+  0xd0, 0xbb, 0x83, 0x38, 0xa1, 0x30, 0x1a, 0x48, 0x90, 0x5d, 0xf0, 0x0d,
+  0xfe, 0xc1, 0x90, 0x03, 0x01, 0x03, 0x29, 0xc0, 0xf3, 0x81, 0xfe, 0x0d,
+  0x20, 0xb0, 0xb9, 0x03, 0xe0, 0x00, 0x29, 0x08, 0xbf, 0xbf, 0x03, 0x28,
+  0x11, 0xd1, 0x0b, 0x3b, 0x10, 0xd8, 0xfb, 0xf9, 0x13, 0x77, 0xe0, 0x01,
+  0x20, 0x32, 0xbd, 0x1c, 0xbd, 0xb9, 0x0f, 0x01, 0x8a, 0xf9, 0x02, 0xe0,
+  0x07, 0x01, 0x7d, 0xbf, 0xf9, 0x28, 0x46, 0x01, 0xf0, 0xe7, 0xf5, 0x40,
+  0x32, 0xa7, 0xbd, 0x08, 0x48, 0xa3, 0x80, 0xa5, 0xf0, 0x06, 0x07, 0x00,
+  0xb4, 0xaa, 0x07, 0x00, 0x04, 0x07, 0x00, 0xac, 0x07, 0x00, 0x02, 0x5f,
+  0x00, 0x54, 0xf6, 0x0d, 0x40, 0x00, 0x00, 0xf7, 0x81, 0x50, 0xf3, 0x00,
+  0x20, 0xff, 0x49, 0x3d, 0x00, 0x01, 0x08, 0x00, 0x00, 0x49, 0xfd, 0x40,
+  0x9d, 0x80, 0xf8, 0x67, 0x01, 0x01, 0x08, 0x6f, 0x5b, 0x01, 0x01, 0xb5,
+  0x20, 0x20, 0xe0, 0xdf, 0x50, 0xc8, 0x73, 0x40, 0xf7, 0xdf, 0xf8, 0x84,
+  0xb3, 0x70, 0x70, 0x47, 0x28, 0x21, 0xdf, 0x42, 0xf6, 0x2c, 0x40, 0xf8,
+  0xd9, 0x92, 0x00, 0x22, 0xff, 0x00, 0xf0, 0x44, 0xf8, 0x40, 0xf2, 0xc9,
+  0x66, 0xd5, 0x80, 0x81, 0xb0, 0xfe, 0xa1, 0x40, 0x00, 0x07, 0x02, 0x77,
+  0xfa, 0x77, 0xdf, 0xf8, 0x5c, 0x93, 0x70, 0x5c, 0x17, 0x40, 0x0a, 0x80,
+  0xfe, 0x9b, 0xb0, 0x27, 0x01, 0xe0, 0x40, 0x08, 0x7f, 0x1c, 0xbf, 0x88,
+  0x42, 0xfb, 0xd2, 0x06, 0x2f, 0x47, 0x95, 0x6b, 0xff, 0xf9, 0x7a, 0x01,
+  0xd2, 0xb2, 0xe0, 0x21, 0x00, 0xfb, 0xf0, 0x23, 0xc3, 0x70, 0x28, 0x07,
+  0xfe, 0x40, 0x06, 0xab, 0x60, 0x04, 0x51, 0x00, 0x1b, 0x0d, 0x00, 0x24,
+  0x3d, 0x00, 0x24, 0xfd, 0x17, 0x03, 0x00, 0x27, 0x04, 0x80, 0x45, 0x80,
+  0x30, 0xf7, 0x20, 0x08, 0x80, 0xc7, 0x40, 0x17, 0x08, 0x80, 0x0f, 0xff,
+  0x21, 0xdf, 0xf8, 0x18, 0x07, 0x01, 0x80, 0x30, 0xff, 0x21, 0x11, 0x80,
+  0x01, 0x80, 0x70, 0x21, 0x01, 0xeb, 0x80, 0xb0, 0x03, 0x00, 0xf0, 0x03,
+  0x00, 0xf1, 0xbd, 0x04, 0xff, 0x21, 0x4f, 0xf4, 0x8c, 0x70, 0xfe, 0xf7,
+  0x42, 0xff, 0xba, 0x2d, 0xe9, 0xf8, 0x4f, 0xdf, 0xf8, 0xf4, 0xf5, 0x66,
+  0x03, 0x00, 0x16, 0x99, 0x50, 0x26, 0x18, 0xb9, 0xd2, 0xff, 0xe9, 0x06,
+  0x5b, 0xc8, 0x6a, 0x03, 0xe0, 0xd2, 0xff, 0xe9, 0x08, 0x5b, 0x08, 0x6c,
+  0x50, 0x36, 0x30, 0xbf, 0x21, 0xb0, 0xfb, 0xf1, 0xf9, 0x50, 0xad, 0x00,
+  0x02, 0xff, 0xf0, 0x7c, 0xff, 0x01, 0x27, 0x09, 0xfb, 0x07, 0xff, 0xf0,
+  0x00, 0x21, 0x15, 0xeb, 0x00, 0x08, 0x4b, 0x7f, 0xeb, 0x01, 0x0a, 0x28,
+  0x1a, 0x6b, 0xeb, 0x01, 0x10, 0xf7, 0xf0, 0x53, 0xff, 0x0d, 0xb0, 0x28,
+  0x01, 0xfa, 0x07, 0xff, 0xf4, 0x03, 0xd5, 0xb0, 0x6c, 0x20, 0x43, 0xb0,
+  0xef, 0x64, 0x04, 0xe0, 0x06, 0x63, 0x20, 0x41, 0x6a, 0x21, 0xbf, 0x43,
+  0x41, 0x62, 0x40, 0x46, 0x51, 0x0f, 0x20, 0x41, 0xae, 0x15, 0xf0, 0x03,
+  0xd5, 0xf0, 0x1d, 0x00, 0xf0, 0x1d, 0x00, 0x56, 0xee, 0x35, 0x30, 0x21,
+  0x43, 0x46, 0x05, 0x00, 0x7f, 0x1c, 0x18, 0xbf, 0x2f, 0xd3, 0xd3, 0xbd,
+  0xe8, 0xf1, 0x79, 0xf0, 0xf8, 0xaf, 0x4f, 0x89, 0x46, 0x17, 0xf5, 0x80,
+  0x48, 0x8d, 0x00, 0x64, 0xff, 0x26, 0x15, 0x68, 0x00, 0x28, 0x07, 0xbf,
+  0xd0, 0xff, 0x6a, 0xd1, 0xe9, 0x00, 0x48, 0x10, 0x6c, 0xd1, 0xff, 0xe9,
+  0x02, 0x48, 0x01, 0x09, 0x00, 0x07, 0x2a, 0xbd, 0x46, 0xf1, 0xb0, 0xf0,
+  0xf6, 0xfb, 0x30, 0xf9, 0xb1, 0xf0, 0xff, 0xf2, 0xfb, 0x06, 0x46, 0x8a,
+  0x46, 0xdf, 0xb1, 0xfe, 0xbb, 0x90, 0x00, 0x31, 0x28, 0x17, 0xd2, 0xfa,
+  0x17, 0xff, 0xa6, 0xfb, 0x07, 0x01, 0x06, 0xfb, 0x02, 0x11, 0xff, 0x0a,
+  0xfb, 0x07, 0x11, 0x27, 0x1a, 0x28, 0x46, 0xff, 0x68, 0xeb, 0x01, 0x0b,
+  0xa0, 0xfb, 0x07, 0x23, 0xff, 0x00, 0xfb, 0x0b, 0x33, 0x12, 0x0f, 0x42,
+  0xea, 0xf7, 0x03, 0x10, 0x19, 0xed, 0x40, 0xfa, 0xfe, 0x05, 0x46, 0xff,
+  0x00, 0x2d, 0x01, 0xd5, 0x00, 0x20, 0x20, 0xe0, 0xdf, 0x3a, 0x46, 0x5b,
+  0x46, 0x48, 0xa1, 0x00, 0x48, 0xfe, 0x75, 0x2a, 0xdb, 0x90, 0x41, 0x09,
+  0x00, 0x08, 0xfe, 0x04, 0x4b, 0xb0, 0xb9, 0x2a, 0x0b, 0x40, 0xb9, 0x01,
+  0x01, 0xfe, 0x06, 0x93, 0x00, 0xd8, 0xff, 0x25, 0x24, 0x09, 0x00, 0x0f,
+  0x44, 0xea, 0x07, 0xff, 0x74, 0x40, 0xea, 0x01, 0x10, 0x14, 0x60, 0x40,
+  0xff, 0xf4, 0x00, 0x40, 0x10, 0x81, 0x30, 0x01, 0x50, 0xfb, 0x60, 0x01,
+  0xb3, 0xf0, 0xf2, 0x8f, 0xdf, 0xf8, 0xb8, 0xff, 0x15, 0x08, 0x80, 0x70,
+  0x47, 0x4f, 0xf0, 0x82, 0xff, 0x41, 0x02, 0x68, 0x0a, 0x60, 0x42, 0x68,
+  0x4a, 0xff, 0x60, 0x02, 0x89, 0x0a, 0x81, 0x42, 0x89, 0x4a, 0xff, 0x81,
+  0x82, 0x89, 0x8a, 0x81, 0xc2, 0x89, 0xca, 0xff, 0x87, 0xdf, 0xf8, 0x98,
+  0x15, 0x02, 0x8a, 0x0a, 0xbf, 0x80, 0x40, 0x8a, 0x48, 0x80, 0x00, 0xa1,
+  0x10, 0x90, 0xff, 0x05, 0x41, 0x80, 0x81, 0x82, 0xc1, 0x82, 0x1f, 0xec,
+  0x97, 0x10, 0x3d, 0xc0, 0x80, 0xc1, 0x3f, 0x00, 0x38, 0xb5, 0x0c, 0xfa,
+  0x95, 0x20, 0x78, 0x3b, 0xb0, 0x74, 0x15, 0x02, 0xf0, 0x12, 0xab, 0xf8,
+  0x05, 0x93, 0x00, 0x01, 0x0d, 0xc0, 0x29, 0x81, 0x10, 0x0b, 0xfe, 0xf1,
+  0x10, 0x64, 0x15, 0x01, 0xf0, 0x79, 0xfe, 0x08, 0xfa, 0xb7, 0x20, 0x04,
+  0xb5, 0x40, 0x99, 0xf8, 0x20, 0x28, 0x28, 0xff, 0xbf, 0x1f, 0x20, 0x01,
+  0x21, 0x01, 0xfa, 0x00, 0xff, 0xf2, 0x43, 0x1e, 0xa2, 0x1a, 0x99, 0x40,
+  0x8a, 0xff, 0x42, 0x28, 0xbf, 0x40, 0xf0, 0x20, 0x00, 0x80, 0xe7, 0xb2,
+  0x32, 0xbd, 0x49, 0x60, 0x4b, 0xd0, 0x8a, 0x40, 0xc0, 0xff, 0xf3, 0x40,
+  0x10, 0x49, 0x1e, 0x88, 0x40, 0x80, 0xd7, 0x18, 0x70, 0x47, 0x2d, 0x20,
+  0x25, 0x07, 0x80, 0x73, 0x13, 0xef, 0x81, 0x01, 0xb1, 0x04, 0x55, 0x20,
+  0x03, 0x00, 0x08, 0xff, 0x18, 0x00, 0x02, 0x40, 0xf4, 0x10, 0x40, 0x10,
+  0xfe, 0x7f, 0x00, 0xdf, 0xf8, 0x04, 0x05, 0x01, 0x88, 0x01, 0x9f, 0xf4,
+  0x73, 0x61, 0x41, 0xf0, 0x87, 0xd0, 0x11, 0x00, 0xf0, 0x78, 0xc3, 0x22,
+  0x79, 0xa0, 0xd5, 0xd0, 0xdf, 0xf8, 0xec, 0x64, 0x03, 0x00, 0xff, 0x74,
+  0xff, 0xf7, 0x3b, 0xfa, 0x30, 0x60, 0x06, 0xdb, 0x21, 0x03, 0x9f, 0x20,
+  0x7b, 0xf8, 0xdd, 0xd1, 0xb8, 0x80, 0xbf, 0x4f, 0xf6, 0xf5, 0x30, 0xb8,
+  0x81, 0x11, 0x01, 0x57, 0xfd, 0xf8, 0x05, 0x01, 0x5a, 0xf8, 0x30, 0x68,
+  0x00, 0xf0, 0xdf, 0xed, 0xf8, 0x29, 0x46, 0xe0, 0x83, 0x80, 0xc4, 0xff,
+  0xff, 0x01, 0xa8, 0x00, 0x90, 0x41, 0xf2, 0x88, 0x33, 0xdf, 0x30, 0x68,
+  0x03, 0x22, 0x05, 0x75, 0x40, 0x22, 0xfa, 0x7f, 0x39, 0x88, 0xc0, 0x07,
+  0x04, 0xd5, 0x2f, 0x2b, 0x00, 0xff, 0xbd, 0xf8, 0x01, 0x24, 0x0d, 0xe0,
+  0x40, 0xf2, 0x5f, 0x0a, 0x40, 0x08, 0x40, 0x02, 0x67, 0xf0, 0x30, 0x13,
+  0x00, 0x7f, 0xb3, 0xf8, 0x00, 0x24, 0x03, 0xe0, 0x31, 0x09, 0x00, 0x7f,
+  0xae, 0xf8, 0x03, 0x24, 0x00, 0xf0, 0x68, 0x55, 0x02, 0xf5, 0x38, 0x67,
+  0xd0, 0x00, 0x4b, 0xf0, 0x20, 0x46, 0xfe, 0xbd, 0xff, 0x00, 0x28, 0x08,
+  0xd5, 0xdf, 0xf8, 0x60, 0x34, 0xff, 0x40, 0x42, 0x53, 0xf8, 0x20, 0x30,
+  0x13, 0x60, 0xbf, 0xdf, 0xf8, 0x58, 0x24, 0x06, 0xe0, 0x05, 0x00, 0x34,
+  0xfe, 0x0f, 0x05, 0x50, 0x24, 0x52, 0xf8, 0x20, 0x00, 0x08, 0xed, 0x60,
+  0xd7, 0x01, 0x48, 0x14, 0x03, 0x00, 0x34, 0x08, 0x22, 0xff, 0x0a, 0x80,
+  0x00, 0x22, 0x4a, 0x83, 0x8a, 0x83, 0xfe, 0x81, 0x11, 0x3c, 0x24, 0x11,
+  0x80, 0x30, 0xf8, 0x11, 0xfb, 0x20, 0x23, 0x03, 0x00, 0x49, 0x1c, 0x18,
+  0x29, 0xf8, 0xfd, 0xd3, 0x15, 0xf0, 0x14, 0x42, 0x8e, 0x0a, 0x80, 0xc2,
+  0xff, 0x8e, 0x4a, 0x82, 0x02, 0x8f, 0x8a, 0x82, 0x42, 0xff, 0x8f, 0xca,
+  0x82, 0x82, 0x8f, 0x0a, 0x83, 0xc2, 0xff, 0x8f, 0x4a, 0x83, 0xb0, 0xf8,
+  0x40, 0x00, 0x88, 0x6d, 0x83, 0x2f, 0xf0, 0x80, 0x88, 0x17, 0x10, 0x10,
+  0xb5, 0x3f, 0x17, 0xfe, 0x3d, 0x30, 0x13, 0xdf, 0xf8, 0xc0, 0x33, 0x00,
+  0x02, 0xff, 0x08, 0x80, 0x40, 0xf4, 0x30, 0x40, 0x94, 0x8e, 0xbf, 0x5c,
+  0x82, 0x40, 0xf0, 0x40, 0x00, 0x19, 0x10, 0x74, 0xff, 0x0c, 0x81, 0x9c,
+  0x8a, 0x44, 0xf4, 0x7f, 0x44, 0xff, 0x9c, 0x82, 0x1c, 0x8b, 0x44, 0xf4,
+  0x00, 0x44, 0xff, 0x1c, 0x83, 0x12, 0x8e, 0x1a, 0x80, 0x08, 0x80, 0xeb,
+  0x10, 0xbd, 0x0f, 0x20, 0x03, 0x6b, 0x14, 0xf4, 0x03, 0x51, 0x5e, 0x6b,
+  0x11, 0x2d, 0xe9, 0xfc, 0x41, 0xc7, 0xd1, 0x90, 0xd1, 0x40, 0xed, 0x55,
+  0xed, 0x10, 0x7c, 0x43, 0x03, 0x00, 0x53, 0xff, 0xf7, 0xf7, 0x84, 0xf9,
+  0x20, 0x6d, 0x12, 0x02, 0xf0, 0xc4, 0xff, 0xba, 0x6d, 0x11, 0xa8, 0x6d,
+  0x10, 0x35, 0x30, 0xa8, 0x6d, 0x10, 0x02, 0xf7, 0xf0, 0xa0, 0xff, 0x05,
+  0x01, 0xa3, 0xff, 0x42, 0x46, 0x5d, 0x39, 0xb1, 0x20, 0xff, 0xf7, 0xb3,
+  0x69, 0x16, 0x20, 0x69, 0x14, 0x7f, 0x6d, 0xf9, 0x02, 0x46, 0x28, 0x88,
+  0xd2, 0x6b, 0x14, 0xff, 0x07, 0xf8, 0x01, 0x25, 0x13, 0xe0, 0x4f, 0xf4,
+  0x7f, 0x99, 0x62, 0x10, 0x42, 0x04, 0xd0, 0x31, 0x3b, 0x00, 0x7f, 0xfe,
+  0xff, 0x02, 0x25, 0x0a, 0xe0, 0x80, 0x1f, 0x00, 0x3d, 0x30, 0x0d, 0x00,
+  0xf7, 0xff, 0x00, 0x25, 0x77, 0x11, 0x5d, 0x30, 0xbf, 0xff, 0x03, 0x25,
+  0xff, 0xf7, 0xac, 0x5f, 0x02, 0x7c, 0xee, 0x59, 0xd0, 0x00, 0xf0, 0x06,
+  0x7d, 0x12, 0x09, 0xf8, 0x28, 0xff, 0x46, 0xbd, 0xe8, 0xf6, 0x81, 0x01,
+  0xab, 0x00, 0xfb, 0x22, 0x04, 0x5f, 0x00, 0xc9, 0xb9, 0x01, 0x21, 0x2d,
+  0xfe, 0x23, 0x00, 0xea, 0xbf, 0x00, 0xf5, 0x4a, 0x70, 0x00, 0xff, 0x23,
+  0x03, 0x60, 0x01, 0x71, 0x42, 0x71, 0x70, 0xfb, 0x47, 0x30, 0x11, 0xa0,
+  0x00, 0x23, 0x50, 0xf8, 0x24, 0x7f, 0x20, 0x01, 0xeb, 0xc4, 0x05, 0x64,
+  0x1c, 0x41, 0x60, 0x7f, 0x23, 0x18, 0x2c, 0xf6, 0xd3, 0x30, 0xbd, 0x19,
+  0x01, 0xf6, 0x17, 0x05, 0xd3, 0x17, 0x17, 0x01, 0x64, 0x1c, 0x18, 0x2c,
+  0xed, 0xf5, 0x19, 0x00, 0x70, 0xb5, 0x4d, 0xd2, 0x26, 0x03, 0xeb, 0xff,
+  0xc6, 0x00, 0x00, 0x21, 0xd0, 0xe9, 0x00, 0x45, 0xf7, 0x52, 0xf8, 0x26,
+  0xb5, 0x90, 0x11, 0xf8, 0xf5, 0xd3, 0xf9, 0x70, 0x1d, 0x0a, 0x1b, 0x05,
+  0xc1, 0x17, 0x00, 0xf0, 0x02, 0xf6, 0x1d, 0x02, 0x20, 0x18, 0x17, 0x00,
+  0x04, 0x69, 0x41, 0xc4, 0xde, 0xa9, 0x60, 0x76, 0x1c, 0x18, 0x2e, 0x4f,
+  0x11, 0xf0, 0x47, 0x7e, 0x93, 0xe0, 0xf5, 0x16, 0x75, 0xd4, 0xf8, 0x28,
+  0xa1, 0x10, 0xab, 0x3c, 0x82, 0x03, 0x00, 0x92, 0xe3, 0x10, 0xa2, 0x03,
+  0x00, 0x02, 0xff, 0x00, 0x29, 0x04, 0xf5, 0xc8, 0x76, 0x04, 0xf1, 0xf7,
+  0xc8, 0x07, 0x21, 0x17, 0x90, 0xff, 0xf7, 0xc1, 0xff, 0x77, 0x39, 0x46,
+  0x50, 0x41, 0x10, 0xbd, 0xff, 0x31, 0x11, 0x40, 0x67, 0xff, 0xf7, 0xc8,
+  0x8b, 0x70, 0x09, 0xd1, 0xc4, 0xff, 0x3d, 0x00, 0xbe, 0x79, 0xc0, 0x0e,
+  0xe0, 0xff, 0xf7, 0x95, 0x23, 0x04, 0x91, 0xfa, 0x23, 0x04, 0x9a, 0x23,
+  0x04, 0x96, 0xff, 0x01, 0x20, 0xc4, 0xfc, 0x25, 0x00, 0x99, 0x60, 0x87,
+  0xc1, 0xb2, 0x01, 0xeb, 0x10, 0xfd, 0x20, 0x39, 0x31, 0x4b, 0x6e, 0x03,
+  0x66, 0x01, 0x22, 0xfe, 0x05, 0x10, 0x25, 0x00, 0x23, 0x17, 0x26, 0x02,
+  0x27, 0xff, 0x0a, 0xe0, 0x01, 0xeb, 0x83, 0x0c, 0xdc, 0xf8, 0xff, 0x04,
+  0xc0, 0xa4, 0x45, 0xd8, 0xbf, 0x64, 0x46, 0xff, 0x65, 0x45, 0xb8, 0xbf,
+  0x65, 0x46, 0x5b, 0x1c, 0xff, 0x9e, 0x42, 0xf2, 0xd2, 0x19, 0x23, 0x2f,
+  0x26, 0xff, 0x7f, 0x1e, 0xf9, 0xd1, 0x23, 0x46, 0x2c, 0x46, 0xff, 0x6f,
+  0xf3, 0x0b, 0x04, 0xb4, 0xf1, 0x00, 0x6f, 0xde, 0x07, 0x00, 0x03, 0x04,
+  0xdc, 0x13, 0x09, 0x00, 0x04, 0xdb, 0xfd, 0x00, 0x2b, 0x70, 0xb4, 0xf1,
+  0x80, 0x5f, 0x05, 0xda, 0x9d, 0x13, 0x05, 0x01, 0xdb, 0x01, 0x24, 0xc7,
+  0x11, 0x25, 0x00, 0x5f, 0x99, 0x04, 0x11, 0x00, 0x05, 0x00, 0xdb, 0x02,
+  0xfd, 0x20, 0x21, 0x00, 0x4f, 0xfe, 0x21, 0x02, 0x4f, 0x02, 0xdb, 0x03,
+  0x24, 0x25, 0x46, 0x4d, 0x02, 0x31, 0x70, 0x03, 0x25, 0x81, 0x60, 0x7f,
+  0x02, 0x08, 0x7f, 0x06, 0xff, 0x4c, 0xfa, 0x05, 0xfc, 0x40, 0xf8, 0x23,
+  0xc0, 0xfa, 0x7b, 0x01, 0xf4, 0x7b, 0x06, 0x44, 0xf0, 0x30, 0x03, 0x20,
+  0xff, 0xf8, 0xc0, 0x3f, 0x09, 0x68, 0x41, 0x60, 0x10, 0xff, 0x46, 0xf0,
+  0xbd, 0x3e, 0xb5, 0x0f, 0xf2, 0x34, 0xff, 0x12, 0x38, 0xca, 0x69, 0x46,
+  0x03, 0x28, 0x38, 0xef, 0xc1, 0x34, 0xbf, 0x5d, 0x4d, 0x30, 0x00, 0x20,
+  0x3e, 0xfe, 0x87, 0x10, 0x0f, 0xf2, 0x10, 0x13, 0x84, 0xb0, 0x70, 0x7b,
+  0xcb, 0x6a, 0x19, 0x00, 0x70, 0xc2, 0x11, 0xd2, 0x19, 0x01, 0xfe, 0x83,
+  0x41, 0x03, 0x23, 0x03, 0xfa, 0x00, 0xf0, 0x19, 0xff, 0x42, 0x40, 0xf0,
+  0xc0, 0x00, 0x06, 0xd0, 0x81, 0xff, 0xb2, 0x92, 0xb2, 0x24, 0x48, 0x00,
+  0xf0, 0xaf, 0xd5, 0xf8, 0xcb, 0x60, 0xe0, 0x69, 0xb0, 0xb0, 0xa5, 0x10,
+  0x49, 0x09, 0xaf, 0x88, 0x01, 0x80, 0x32, 0x05, 0x00, 0x41, 0x45, 0x32,
+  0x04, 0xff, 0x46, 0x1b, 0x48, 0x21, 0x88, 0x00, 0xf0, 0xfa, 0xff, 0xf8,
+  0x61, 0x88, 0x2d, 0x48, 0xbd, 0xe8, 0x10, 0xf6, 0x71, 0xb0, 0xf4, 0xb8,
+  0x4d, 0xc0, 0x03, 0x0c, 0x46, 0x00, 0xff, 0xf4, 0x40, 0x52, 0x4f, 0xf4,
+  0x40, 0x51, 0x13, 0x7e, 0x43, 0x00, 0xfa, 0xf8, 0x04, 0xf0, 0x3c, 0x01,
+  0x1f, 0x01, 0xf7, 0xff, 0xe7, 0x23, 0x0f, 0x00, 0xe2, 0xb8, 0x80, 0xb5,
+  0xfb, 0x22, 0x49, 0x0d, 0x31, 0x08, 0x80, 0x6b, 0x46, 0x14, 0x73, 0x48,
+  0x00, 0xcd, 0x80, 0x8d, 0x21, 0x82, 0xf8, 0x01, 0xdb, 0xb0, 0xed, 0x70,
+  0xab, 0x70, 0xf8, 0xf1, 0x65, 0x90, 0xd0, 0x12, 0x13, 0xbf, 0xfc, 0x01,
+  0x00, 0x41, 0xc0, 0x02, 0x03, 0x00, 0x06, 0xfe, 0x03, 0x00, 0x04, 0x00,
+  0x41, 0x02, 0x08, 0x00, 0x41, 0xef, 0x00, 0xef, 0x00, 0x20, 0xff, 0xb1,
+  0x40, 0x00, 0x00, 0xab, 0x41, 0x0c, 0x03, 0x00, 0x58, 0x03, 0x00, 0xb0,
+  0x03, 0x00, 0xbd, 0xff, 0x37, 0x86, 0x35, 0x00, 0x00, 0x40, 0x42, 0x00,
+  0xea, 0x23, 0x00, 0x6c, 0x43, 0x00, 0x08, 0x2b, 0x01, 0x16, 0x00, 0x41,
+  0x4d, 0x80, 0x03, 0x00, 0x00, 0x17, 0x07, 0x00, 0x03, 0x00, 0x3e, 0x27,
+  0x00, 0x55, 0x80, 0x03, 0x00, 0x04, 0x1b, 0x00, 0xb2, 0x07, 0x00, 0xfe,
+  0x5f, 0x00, 0xa9, 0x14, 0x27, 0x01, 0x00, 0x00, 0x02, 0x03, 0x00, 0x04,
+  0x08, 0x03, 0x41, 0xf6, 0x08, 0x00, 0x41, 0x00, 0x73, 0x00, 0xdf, 0xf8,
+  0x0c, 0x14, 0xff, 0x28, 0x22, 0x02, 0xfb, 0x00, 0x10, 0x81, 0x7f, 0x77,
+  0xc2, 0x7f, 0x90, 0x29, 0x10, 0x41, 0xea, 0x02, 0xbd, 0xc1, 0xed, 0x40,
+  0x97, 0x41, 0xf0, 0x13, 0x1b, 0x03, 0x10, 0xf8, 0x21, 0xbf, 0x1f, 0x40,
+  0x78, 0x00, 0xf0, 0x07, 0x1d, 0x00, 0x00, 0xfe, 0x3d, 0x20, 0xef, 0xf3,
+  0x11, 0x80, 0x60, 0x21, 0x81, 0xf7, 0xf3, 0x11, 0x88, 0x5d, 0x43, 0xd0,
+  0x33, 0x09, 0x68, 0x76, 0x63, 0xf0, 0x42, 0x1a, 0xcd, 0x42, 0xc0, 0x33,
+  0x01, 0x0b, 0x02, 0xfd, 0x80, 0x1f, 0x00, 0x70, 0x47, 0x70, 0xb5, 0x00,
+  0xf0, 0xff, 0x56, 0xf8, 0x00, 0xf0, 0x79, 0xf8, 0xbd, 0xe8, 0x4f, 0x70,
+  0x40, 0xef, 0xe7, 0xf7, 0x20, 0x47, 0x40, 0x88, 0x97, 0x20, 0xff, 0xdc,
+  0xff, 0x00, 0xf0, 0x36, 0xf8, 0x20, 0xb1, 0xfd, 0x41, 0x1b, 0x40, 0xfd,
+  0xf7, 0x3e, 0xfe, 0x01, 0x27, 0x77, 0x20, 0x46, 0x29, 0x17, 0x00, 0xde,
+  0xff, 0x38, 0xc3, 0x30, 0xeb, 0xf0, 0x81, 0xa1, 0x83, 0x16, 0x65, 0xa0,
+  0x00, 0x27, 0x00, 0xff, 0xe0, 0x7f, 0x1c, 0xb7, 0x42, 0x06, 0xd2, 0x79,
+  0xcf, 0x5d, 0x34, 0xf8, 0x17, 0x83, 0xf0, 0x3b, 0x00, 0x28, 0xf5, 0xfb,
+  0xd1, 0xf2, 0xfb, 0xc0, 0xf8, 0x43, 0x06, 0x46, 0x89, 0xf8, 0x95, 0x40,
+  0x97, 0xf0, 0x4f, 0x00, 0x0e, 0xf8, 0x28, 0xb1, 0x42, 0xab, 0x46, 0x49,
+  0x51, 0x02, 0x1f, 0x51, 0x06, 0xb5, 0x51, 0x02, 0xf2, 0xfb, 0x83, 0x04,
+  0x2d, 0x70, 0x28, 0x03, 0x00, 0x78, 0x00, 0xe7, 0x27, 0x0d, 0x46, 0x99,
+  0x03, 0x35, 0x40, 0xf0, 0x17, 0xf8, 0xff, 0x0a, 0xb1, 0x25, 0x70, 0x01,
+  0x26, 0x0e, 0xe0, 0xf6, 0x6f, 0x01, 0x90, 0xe7, 0x75, 0x03, 0x8c, 0xe7,
+  0x70, 0xb5, 0xd7, 0xff, 0xf7, 0xf6, 0x53, 0x00, 0x07, 0x1f, 0x01, 0x80,
+  0x01, 0xfd, 0x26, 0x59, 0x31, 0x30, 0x46, 0x70, 0xbd, 0xb9, 0x4a, 0x7f,
+  0x12, 0x78, 0x00, 0x26, 0x70, 0x47, 0xf8, 0x1f, 0x00, 0xbd, 0xe9, 0x1f,
+  0x00, 0x08, 0xf8, 0x12, 0xb1, 0x79, 0x41, 0x01, 0xba, 0xe1, 0xd0, 0x80,
+  0x69, 0x00, 0xf2, 0xbd, 0xb1, 0x21, 0x01, 0x27, 0xff, 0x70, 0x47, 0x22,
+  0x88, 0xaa, 0x43, 0x05, 0xea, 0x9f, 0x06, 0x03, 0x1a, 0x43, 0x22, 0x4f,
+  0x20, 0x4f, 0x01, 0xce, 0xdf, 0xff, 0xff, 0xf7, 0xdf, 0xff, 0x4f, 0x00,
+  0x60, 0x01, 0xf7, 0x26, 0xd6, 0xe7, 0x61, 0x21, 0x04, 0x22, 0x21, 0x46,
+  0xff, 0x0f, 0xf2, 0xb0, 0x20, 0xfd, 0xf7, 0xee, 0xfd, 0x7f, 0x01, 0x22,
+  0x21, 0x1d, 0x0f, 0xf2, 0xac, 0x0b, 0x00, 0xf7, 0xe8, 0xfd, 0xa1, 0x35,
+  0x20, 0xa0, 0x60, 0x10, 0xbd, 0xea, 0x4b, 0xa1, 0x0d, 0x25, 0x04, 0x88,
+  0x05, 0xf0, 0x74, 0xff, 0x55, 0xff, 0xb9, 0xa0, 0x68, 0x99, 0x49, 0x08,
+  0x60, 0x21, 0xff, 0x1d, 0xbd, 0xe8, 0x38, 0x40, 0x01, 0x22, 0x0f, 0xbb,
+  0xf2, 0x78, 0x31, 0x00, 0xbc, 0xbd, 0x31, 0x2b, 0x00, 0x20, 0xff, 0xb9,
+  0x01, 0x24, 0x40, 0xf6, 0x12, 0x05, 0x80, 0xef, 0x21, 0x03, 0xe0, 0x02,
+  0x09, 0x00, 0x13, 0x05, 0x40, 0xbf, 0x21, 0x00, 0x22, 0x40, 0xf6, 0x14,
+  0x33, 0x10, 0x69, 0xbf, 0xff, 0x00, 0x22, 0xc0, 0x21, 0x28, 0x0f, 0x10,
+  0x64, 0xff, 0xff, 0x21, 0x46, 0x4f, 0xf4, 0x82, 0x70, 0xff, 0x77, 0xf7,
+  0x38, 0xff, 0x43, 0x01, 0x00, 0x22, 0x33, 0x79, 0x90, 0xff, 0xa9, 0x60,
+  0x57, 0xe7, 0x80, 0xb5, 0x84, 0x48, 0xff, 0x01, 0x6d, 0x03, 0x20, 0x01,
+  0xf0, 0xfc, 0xf9, 0xfe, 0x05, 0x01, 0x11, 0xfa, 0x18, 0xb9, 0xff, 0xf7,
+  0x45, 0x7e, 0x81, 0xc0, 0xf7, 0xd0, 0xbd, 0xe8, 0x02, 0x40, 0x13, 0x01,
+  0xf7, 0x7f, 0xb9, 0x76, 0x7b, 0xa0, 0x43, 0x20, 0x04, 0xe0, 0xed, 0x74,
+  0x07, 0x00, 0x6b, 0x00, 0xd1, 0x70, 0x02, 0x3f, 0x21, 0xdf, 0x40, 0xf6,
+  0x15, 0x00, 0x37, 0xdd, 0x10, 0xf1, 0x4f, 0x7f, 0x84, 0xb0, 0x07, 0xf0,
+  0xdc, 0xfc, 0x01, 0xab, 0x00, 0xf9, 0xde, 0x09, 0x80, 0x07, 0x01, 0xcc,
+  0xfe, 0x82, 0x46, 0x03, 0xd2, 0x07, 0x00, 0xd6, 0xdb, 0x80, 0x07, 0x01,
+  0xc4, 0xb7, 0x80, 0x6b, 0x48, 0xff, 0x6b, 0x4a, 0x41, 0x78, 0x00, 0x78,
+  0x13, 0x78, 0xfe, 0xb5, 0x80, 0x20, 0x40, 0x05, 0x40, 0x0d, 0x01, 0x21,
+  0xbf, 0x03, 0xf0, 0x03, 0x07, 0x02, 0x2f, 0x49, 0x20, 0x0b, 0xff, 0x08,
+  0xbf, 0x02, 0x21, 0x02, 0xd0, 0x03, 0x2f, 0xff, 0x08, 0xbf, 0x04, 0x21,
+  0xdf, 0x06, 0x48, 0xbf, 0xf7, 0x49, 0x00, 0x9b, 0x05, 0x02, 0x52, 0x78,
+  0x52, 0x07, 0xff, 0x4c, 0xbf, 0x01, 0xeb, 0x81, 0x01, 0x89, 0x00, 0xff,
+  0x00, 0x91, 0x02, 0x27, 0x53, 0x49, 0x91, 0xf8, 0xff, 0x89, 0x20, 0x91,
+  0xf8, 0x39, 0x10, 0x8b, 0x1a, 0x5f, 0x01, 0x2b, 0x03, 0xdb, 0x07, 0x83,
+  0xd0, 0x01, 0x4b, 0x40, 0xff, 0x00, 0x2b, 0x03, 0xd5, 0x59, 0x42, 0x8c,
+  0x40, 0xfb, 0x0a, 0xfa, 0xfb, 0x90, 0xfa, 0x02, 0xf1, 0x00, 0x27, 0xff,
+  0x05, 0xfa, 0x07, 0xf2, 0xa2, 0x1a, 0x4f, 0x4b, 0xff, 0x03, 0xfb, 0x02,
+  0xa2, 0x01, 0x92, 0x48, 0x43, 0x7f, 0x01, 0x9b, 0x00, 0x9a, 0xc1, 0x17,
+  0x06, 0x19, 0xa0, 0xff, 0xcd, 0xe9, 0x02, 0x01, 0x1b, 0x1b, 0x83, 0xfb,
+  0xff, 0x02, 0x89, 0x00, 0x25, 0x07, 0xe0, 0xae, 0x19, 0xef, 0x01, 0x99,
+  0x00, 0x98, 0x17, 0x00, 0xf2, 0x89, 0x1a, 0xff, 0x81, 0xfb, 0x00, 0x89,
+  0xdd, 0xe9, 0x02, 0x23, 0xd1, 0x40, 0x51, 0x20, 0x8f, 0xb1, 0x0b, 0x01,
+  0x04, 0xd5, 0x90, 0xa2, 0xfb, 0xff, 0x04, 0x01, 0x02, 0xfb, 0x0a, 0x11,
+  0x03, 0xfb, 0x7f, 0x04, 0x11, 0xb8, 0xeb, 0x00, 0x00, 0x79, 0x6b, 0xa1,
+  0xfd, 0xbf, 0xf3, 0x70, 0xd0, 0x00, 0x2d, 0xde, 0xd1, 0x37, 0xff, 0x48,
+  0x86, 0x42, 0xac, 0xbf, 0x4f, 0xf0, 0xff, 0xff, 0x35, 0x01, 0x25, 0xd7,
+  0xe7, 0xb5, 0xb1, 0x30, 0xff, 0x02, 0x01, 0x0e, 0x40, 0xf2, 0x45, 0x30,
+  0xff, 0xff, 0xf7, 0x81, 0xfe, 0x30, 0x04, 0x01, 0x0e, 0x4f, 0xfb, 0xf4,
+  0x51, 0x79, 0x10, 0x7b, 0xfe, 0xf1, 0xb2, 0x40, 0xdb, 0xf2, 0x43, 0x15,
+  0x00, 0x76, 0xfe, 0x03, 0x50, 0x21, 0x40, 0xfb, 0xf2, 0x41, 0x0b, 0x00,
+  0x97, 0xfe, 0x60, 0x42, 0x00, 0xdf, 0x02, 0x22, 0x4e, 0x00, 0x0a, 0xa3,
+  0x70, 0x70, 0x30, 0xff, 0x60, 0x20, 0x22, 0x4f, 0xf4, 0x80, 0x50, 0x70,
+  0xbb, 0x60, 0x20, 0x5f, 0x12, 0xff, 0xf7, 0x87, 0x2b, 0x00, 0x01, 0xfe,
+  0xab, 0x10, 0x60, 0x70, 0xfd, 0xf7, 0xaf, 0xfc, 0x04, 0xff, 0x98, 0x01,
+  0x28, 0x21, 0xdb, 0x30, 0x68, 0x04, 0xff, 0x99, 0x20, 0xf0, 0xf0, 0x40,
+  0x40, 0xea, 0xc1, 0xff, 0x60, 0x40, 0xf0, 0x80, 0x60, 0x30, 0x60, 0x4f,
+  0xf7, 0xf4, 0x7a, 0x71, 0xa9, 0x11, 0x1a, 0xf9, 0x30, 0x68, 0xef, 0x40,
+  0x01, 0x07, 0xd5, 0x0b, 0x01, 0x2c, 0xf9, 0x18, 0x6f, 0xb9, 0xfe, 0xf7,
+  0x60, 0x37, 0x30, 0xf4, 0xd0, 0x0f, 0x01, 0xff, 0x24, 0xf9, 0x08, 0xb1,
+  0x4f, 0xf0, 0x01, 0x0b, 0xde, 0x0b, 0x01, 0x96, 0xf8, 0x58, 0x46, 0xb9,
+  0xc2, 0x8f, 0x60, 0xff, 0xee, 0x00, 0x20, 0x00, 0xe1, 0x00, 0xe0, 0x80,
+  0xfe, 0x03, 0x00, 0x61, 0x2c, 0x00, 0x20, 0x10, 0x00, 0x00, 0xff, 0x45,
+  0x4c, 0x1f, 0x00, 0x20, 0x41, 0x01, 0x00, 0xfd, 0x46, 0x4d, 0xc0, 0x46,
+  0x00, 0xf8, 0x7f, 0x00, 0x01, 0xff, 0xfc, 0x3f, 0x00, 0x48, 0x05, 0x12,
+  0x08, 0x13, 0x7f, 0x08, 0x14, 0x08, 0x80, 0x03, 0x00, 0x00, 0x0f, 0x50,
+  0xff, 0x24, 0x00, 0x21, 0xe0, 0xb2, 0x00, 0xf0, 0xad, 0xfb, 0xf8, 0x01,
+  0x07, 0x02, 0xe1, 0xf8, 0x64, 0x1c, 0x02, 0xcf, 0x2c, 0xf4, 0xd3, 0x10,
+  0x8d, 0x50, 0xbd, 0x21, 0xff, 0xf7, 0xff, 0xe6, 0xfe, 0x00, 0x2c, 0x0c,
+  0xbf, 0x01, 0x21, 0xfd, 0x10, 0xe7, 0x00, 0x49, 0x50, 0xfd, 0xf7, 0x47,
+  0xfc, 0xff, 0x2e, 0x00, 0x18, 0xbf, 0x01, 0x2d, 0x04, 0xd1, 0x35, 0x7e,
+  0x11, 0x00, 0x0b, 0xbf, 0x20, 0x3e, 0xfc, 0x21, 0x01, 0x87, 0x50, 0xf6,
+  0xff, 0xc0, 0x03, 0x01, 0xaf, 0x52, 0x21, 0x81, 0x40, 0xd2, 0xf7, 0xb2,
+  0xc9, 0xb2, 0x99, 0x21, 0xff, 0xf7, 0x0a, 0xfe, 0xff, 0x01, 0x2d, 0x18,
+  0xbf, 0x02, 0x2d, 0x10, 0xd1, 0xff, 0x00, 0x2c, 0x07, 0xbf, 0x08, 0x24,
+  0x40, 0xf2, 0xb7, 0x42, 0x50, 0x10, 0x05, 0x00, 0x43, 0x50, 0xd5, 0x21,
+  0xff, 0xf7, 0xf7, 0xfa, 0xfd, 0xd3, 0x25, 0xce, 0xfd, 0x01, 0x20, 0xff,
+  0x70, 0xbd, 0xff, 0xf7, 0x99, 0xbe, 0x00, 0xb1, 0xff, 0x04, 0x20, 0x41,
+  0x49, 0x09, 0x78, 0xc1, 0x40, 0xfc, 0x63, 0xf1, 0xd1, 0x51, 0x02, 0x46,
+  0x00, 0x21, 0x53, 0x68, 0xfd, 0x18, 0xcd, 0x10, 0xba, 0xfb, 0x08, 0xd2,
+  0x10, 0x68, 0xd7, 0x3a, 0x4c, 0x19, 0x0b, 0x00, 0x1e, 0xc3, 0x80, 0x00,
+  0x20, 0xef, 0xc4, 0xe9, 0x02, 0x00, 0x6f, 0x31, 0x36, 0x4a, 0x35, 0xed,
+  0x4d, 0x65, 0xc0, 0x01, 0xd5, 0xed, 0x10, 0x99, 0x42, 0x08, 0xbf, 0xbf,
+  0x90, 0x42, 0x3f, 0xd0, 0xc5, 0x23, 0x20, 0x31, 0xff, 0x4a, 0x00, 0x23,
+  0x01, 0xf0, 0x06, 0xfe, 0x00, 0xff, 0x24, 0x80, 0xb2, 0xb0, 0xf5, 0x95,
+  0x7f, 0xb8, 0xff, 0xbf, 0xff, 0x24, 0x1a, 0xdb, 0xb0, 0xf5, 0xd5, 0xff,
+  0x6f, 0x17, 0xdc, 0x40, 0xf2, 0x29, 0x11, 0x40, 0xff, 0x1a, 0x00, 0xb2,
+  0x41, 0x11, 0x00, 0xeb, 0x91, 0xff, 0x61, 0x89, 0x02, 0x09, 0x0c, 0x0f,
+  0xf2, 0x74, 0xff, 0x12, 0x8b, 0x5c, 0xa0, 0xeb, 0x81, 0x10, 0x89, 0xff,
+  0x18, 0x00, 0xb2, 0x49, 0x78, 0x59, 0x1a, 0x48, 0xfd, 0x43, 0x1d, 0x02,
+  0x60, 0xa3, 0xeb, 0xa0, 0x14, 0xe0, 0xff, 0xb2, 0x01, 0xf0, 0xd3, 0xf8,
+  0x29, 0x68, 0x01, 0xff, 0xf0, 0x6e, 0xfa, 0x01, 0xf0, 0xd8, 0xfa, 0x84,
+  0xaf, 0xb2, 0xff, 0x2c, 0xc8, 0x4f, 0x00, 0xe1, 0x13, 0x20, 0x44, 0xfe,
+  0x1f, 0x10, 0xb7, 0xfb, 0xe1, 0xb2, 0xbd, 0xe8, 0x34, 0xb9, 0x40, 0x37,
+  0x20, 0x0d, 0x00, 0xb0, 0xbb, 0x31, 0x51, 0xa0, 0x0c, 0xff, 0xbf, 0x40,
+  0xf2, 0x46, 0x50, 0x40, 0xf2, 0x47, 0x6d, 0x50, 0xcd, 0x00, 0x02, 0x03,
+  0x4f, 0x60, 0xae, 0xbb, 0x5f, 0x13, 0xff, 0x08, 0xf0, 0x3f, 0xf9, 0x2f,
+  0x26, 0x03, 0x28, 0xff, 0x08, 0xd1, 0x00, 0x21, 0x8d, 0x42, 0x08, 0x48,
+  0xff, 0x03, 0xd8, 0x84, 0x42, 0x38, 0xbf, 0x2d, 0x26, 0x2f, 0x00, 0xd3,
+  0x2e, 0x26, 0xb1, 0x41, 0x00, 0xaf, 0x10, 0xbb, 0x10, 0xfe, 0x77, 0x64,
+  0x40, 0x42, 0x0f, 0x00, 0x00, 0x28, 0x6b, 0xf5, 0xee, 0x51, 0x03, 0x5e,
+  0x63, 0x00, 0x5f, 0x40, 0xfd, 0xf7, 0x5b, 0x7e, 0xbb, 0xe9, 0xe0, 0x02,
+  0x0f, 0x5b, 0x20, 0xc1, 0x5b, 0x20, 0xfb, 0x81, 0xbb, 0x6f, 0x09, 0x89,
+  0x00, 0x01, 0xf0, 0x0c, 0xeb, 0x02, 0x0c, 0x71, 0x00, 0x75, 0x17, 0x02,
+  0x4f, 0xf4, 0xa8, 0xad, 0x60, 0xaf, 0x20, 0x50, 0x8a, 0xfd, 0xd0, 0xc0,
+  0x15, 0x00, 0x6a, 0xee, 0x15, 0x0a, 0x01, 0xf0, 0x3f, 0x0f, 0x40, 0xfd,
+  0xf7, 0x5f, 0xb1, 0xbb, 0x19, 0x20, 0x5d, 0x50, 0x4d, 0x00, 0xfb, 0x21,
+  0x7f, 0x50, 0x10, 0xfb, 0x40, 0x05, 0xab, 0x40, 0x48, 0x00, 0xfd, 0xf7,
+  0x79, 0x3e, 0x19, 0x02, 0x0a, 0xf8, 0xff, 0xf7, 0x0d, 0xb5, 0x10, 0x19,
+  0x05, 0x6d, 0x30, 0x19, 0x00, 0x59, 0xbb, 0x3b, 0xc0, 0x22, 0x61, 0x05,
+  0x50, 0xb9, 0x2c, 0xdb, 0xe1, 0xbf, 0x10, 0x01, 0xf0, 0x01, 0x0d, 0x22,
+  0x01, 0x7e, 0x0d, 0x26, 0xaa, 0x60, 0xfd, 0xf7, 0x31, 0xbb, 0x09, 0x70,
+  0xff, 0x05, 0x41, 0x05, 0x50, 0x05, 0x49, 0x05, 0x0b, 0xfe, 0xd8, 0x60,
+  0x48, 0x05, 0x42, 0x05, 0x43, 0x05, 0x00, 0xff, 0x00, 0xff, 0xc1, 0x97,
+  0x7a, 0x65, 0x57, 0x4b, 0xff, 0x42, 0x3a, 0x33, 0x2d, 0x27, 0x22, 0x1d,
+  0x1a, 0x3f, 0x16, 0x13, 0x10, 0x0d, 0x0a, 0x06, 0xa3, 0x20, 0x27, 0x11,
+  0xff, 0x00, 0x25, 0x0f, 0xf2, 0x40, 0x66, 0x36, 0xf9, 0xdf, 0x15, 0x20,
+  0xe9, 0xb2, 0x20, 0xc5, 0xa0, 0x29, 0xf8, 0xdf, 0x6d, 0x1c, 0x04, 0x2d,
+  0xf6, 0x9d, 0x90, 0x10, 0xb5, 0xf7, 0x08, 0x22, 0x08, 0x7b, 0xe2, 0xfd,
+  0xf7, 0x04, 0xfb, 0x57, 0x00, 0x24, 0x20, 0xb1, 0x21, 0xff, 0xc3, 0x21,
+  0xf9, 0x75, 0xb0, 0xfb, 0x88, 0x05, 0x83, 0x30, 0x71, 0x81, 0x61, 0x42,
+  0x6a, 0xff, 0x42, 0xf4, 0x80, 0x72, 0x42, 0x62, 0x01, 0x60, 0xff, 0x13,
+  0x20, 0x06, 0x21, 0x02, 0xf0, 0x4c, 0xfa, 0xcd, 0x13, 0x59, 0xa0, 0x2e,
+  0xfa, 0xbf, 0x01, 0x09, 0x01, 0x2f, 0xba, 0xfb, 0x00, 0x00, 0x8f, 0x61,
+  0x14, 0x46, 0x05, 0x46, 0x27, 0xff, 0x12, 0x01, 0x20, 0x03, 0x29, 0x00,
+  0xfa, 0x05, 0xff, 0xf6, 0x40, 0xf6, 0x1c, 0x28, 0x3b, 0xd8, 0xdf, 0x7f,
+  0xe8, 0x01, 0xf0, 0x02, 0x1a, 0x21, 0x27, 0xdd, 0x50, 0xff, 0x56, 0xa0,
+  0x05, 0x01, 0x0e, 0x36, 0xf8, 0x25, 0xfe, 0xed, 0x00, 0xc4, 0xfa, 0x06,
+  0xeb, 0x85, 0x00, 0x04, 0xbf, 0xf0, 0x03, 0x04, 0x45, 0x88, 0x44, 0xd3,
+  0xc0, 0x28, 0xde, 0xb5, 0x60, 0xba, 0xfa, 0x00, 0xbf, 0x01, 0x01, 0x21,
+  0x46, 0xff, 0x28, 0x46, 0x1b, 0xe0, 0x0f, 0xf2, 0x84, 0x59, 0xff, 0x00,
+  0xf0, 0x1e, 0xf8, 0x07, 0xf0, 0x3f, 0x01, 0xfd, 0x0a, 0x0d, 0x00, 0x88,
+  0x50, 0x30, 0xf8, 0x15, 0x00, 0xd7, 0xe1, 0xb2, 0x0e, 0x0b, 0x00, 0x80,
+  0x19, 0x00, 0x11, 0xf8, 0xf7, 0xf9, 0xb2, 0x09, 0x43, 0x00, 0x40, 0x88,
+  0xfd, 0xf7, 0xf1, 0x9d, 0x39, 0x04, 0x57, 0x40, 0x53, 0x10, 0xf4, 0x43,
+  0xfd, 0xf7, 0xdb, 0x94, 0xba, 0xbd, 0xe0, 0x83, 0x39, 0x6b, 0x00, 0xe1,
+  0xb2, 0xff, 0xfd, 0xf7, 0x8d, 0xba, 0x10, 0xb5, 0x82, 0xb0, 0xff, 0xdf,
+  0xf8, 0xbc, 0x44, 0xfe, 0xf7, 0xa9, 0xfb, 0xdf, 0x20, 0x60, 0x01, 0x21,
+  0x2e, 0xb5, 0x00, 0x5d, 0xfa, 0xf3, 0x20, 0x68, 0xe2, 0xf0, 0x9f, 0x80,
+  0xfc, 0xf7, 0x32, 0xfc, 0xff, 0xdf, 0xf8, 0xa0, 0x04, 0x01, 0x68, 0x01,
+  0xf4, 0xbf, 0xa0, 0x71, 0x41, 0xf0, 0x11, 0x01, 0xe9, 0x00, 0xbd, 0xff,
+  0x1c, 0xb5, 0xfe, 0xf7, 0x92, 0xfb, 0xdf, 0xf8, 0xff, 0x84, 0x14, 0x08,
+  0x60, 0x01, 0xa9, 0x00, 0x91, 0xbc, 0xbd, 0xb1, 0xbb, 0xb1, 0xfc, 0xf7,
+  0x8f, 0xfb, 0x23, 0xd3, 0x02, 0xf7, 0xf0, 0x2b, 0xfa, 0x23, 0xd1, 0xdf,
+  0xf8, 0x68, 0x04, 0xb3, 0x00, 0x68, 0x13, 0x01, 0xab, 0xb1, 0x21, 0xfa,
+  0x23, 0xd3, 0x02, 0xcf, 0xf0, 0x1c, 0xfa, 0x02, 0x1f, 0x40, 0x6b, 0x01,
+  0x27, 0xfa, 0xd7, 0x20, 0x46, 0x16, 0x5b, 0xc0, 0x3c, 0x63, 0x00, 0x41,
+  0xf0, 0xd9, 0x02, 0x5f, 0x00, 0x95, 0xe1, 0x8a, 0x41, 0x05, 0xd1, 0x02,
+  0x68, 0xff, 0x22, 0xf0, 0x7e, 0x52, 0x42, 0xea, 0xc1, 0x51, 0xbc, 0x15,
+  0x01, 0xb5, 0xf0, 0xf0, 0x1f, 0x02, 0x91, 0x1d, 0xe0, 0x41, 0xad, 0x10,
+  0xab, 0x50, 0xeb, 0x90, 0xbd, 0x32, 0x04, 0x69, 0xe0, 0x6d, 0xfd, 0xf9,
+  0x09, 0x21, 0x62, 0x1a, 0x89, 0x08, 0xb2, 0xfb, 0xff, 0xf1, 0xf1, 0x40,
+  0xea, 0x41, 0x10, 0xc0, 0xb2, 0x6e, 0xaf, 0xc1, 0xf0, 0x13, 0x0a, 0x41,
+  0x00, 0xf2, 0x02, 0xc5, 0x20, 0xff, 0x00, 0x42, 0xea, 0x00, 0x10, 0x40,
+  0xf0, 0x04, 0xfe, 0x5d, 0xd4, 0xd8, 0x03, 0x01, 0x68, 0x21, 0xf0, 0x04,
+  0xfb, 0x01, 0xc5, 0x6f, 0x70, 0xd3, 0x07, 0x12, 0xd5, 0x0f, 0xff, 0xf2,
+  0x28, 0x43, 0x33, 0xf8, 0x20, 0x40, 0x04, 0xff, 0xf1, 0x8c, 0x44, 0x03,
+  0xeb, 0x80, 0x03, 0x24, 0xff, 0x78, 0xa4, 0x00, 0x0c, 0x80, 0x5b, 0x88,
+  0x03, 0xdf, 0xf1, 0x8c, 0x43, 0x1b, 0x78, 0x83, 0x60, 0x03, 0x23, 0xbf,
+  0x43, 0x0b, 0x80, 0x92, 0x07, 0x17, 0x29, 0x00, 0x08, 0xf3, 0x42, 0x32,
+  0xaf, 0xd0, 0x19, 0x01, 0x02, 0xeb, 0x80, 0x00, 0xff, 0x1b, 0x78, 0x4b,
+  0x80, 0x40, 0x88, 0x00, 0xf1, 0x7b, 0x8c, 0x40, 0x43, 0x80, 0xf0, 0x3f,
+  0x00, 0x43, 0x0d, 0x90, 0xff, 0x82, 0x04, 0x48, 0x80, 0x02, 0xd5, 0xdd,
+  0x4a, 0xf7, 0x10, 0x43, 0x48, 0x37, 0xd0, 0x00, 0x21, 0xdc, 0x4a, 0xdf,
+  0x52, 0xf8, 0x21, 0x20, 0x40, 0x03, 0x00, 0x49, 0x1c, 0xef, 0x38, 0x29,
+  0xf7, 0xd3, 0xe9, 0xb3, 0x0d, 0x46, 0xd7, 0x3f, 0x49, 0x49, 0x69, 0x92,
+  0x46, 0xd6, 0x19, 0x80, 0x13, 0x71, 0xff, 0x13, 0x07, 0x48, 0xbf, 0x04,
+  0x20, 0x02, 0xd4, 0xfd, 0x52, 0x07, 0x00, 0x02, 0x20, 0x48, 0x43, 0xd1,
+  0x49, 0xff, 0x88, 0x42, 0x2c, 0xbf, 0x0f, 0xf2, 0xc0, 0x38, 0xfa, 0x0b,
+  0x80, 0x38, 0xad, 0x60, 0xeb, 0xc7, 0x00, 0x00, 0xf1, 0xf7, 0x60, 0x06,
+  0xd6, 0x2f, 0xc0, 0x00, 0xf0, 0x82, 0xfe, 0xdf, 0x00, 0xf0, 0xdf, 0xf8,
+  0xe1, 0xe5, 0xc0, 0xbb, 0xff, 0x5f, 0xe0, 0x60, 0xd6, 0xe9, 0x06, 0x13,
+  0x00, 0x78, 0x13, 0x00, 0xff, 0xd5, 0xf8, 0x21, 0x69, 0x00, 0xf0, 0xb1,
+  0xff, 0x5f, 0x20, 0x61, 0xd6, 0xe9, 0x0c, 0x13, 0x00, 0x6e, 0x13, 0x00,
+  0x77, 0xcb, 0xf8, 0x61, 0x13, 0x00, 0xa7, 0xff, 0x60, 0x13, 0x00, 0x75,
+  0x12, 0x13, 0x00, 0x64, 0x13, 0x00, 0xc1, 0xf8, 0xa1, 0x13, 0x00, 0xff,
+  0x9d, 0xff, 0x7f, 0x1c, 0x03, 0x2f, 0xa0, 0x61, 0xdb, 0xd0, 0xd3, 0x4f,
+  0x90, 0xf0, 0xbb, 0xf9, 0x80, 0xb2, 0xf8, 0xd5, 0x21, 0x53, 0x00, 0x91,
+  0xc3, 0x80, 0xbd, 0x0d, 0x00, 0xab, 0xf8, 0x7d, 0x61, 0x0d, 0x00, 0x8a,
+  0xff, 0x60, 0x60, 0xd9, 0x61, 0x02, 0xdd, 0x47, 0x39, 0x00, 0xa1, 0xf8,
+  0xa1, 0x13, 0x00, 0x80, 0xff, 0x7f, 0x02, 0x2f, 0xa0, 0x60, 0xe4, 0xd3,
+  0x01, 0x37, 0x00, 0x55, 0x9f, 0x29, 0x00, 0x96, 0x37, 0x02, 0x75, 0x37,
+  0x00, 0xa1, 0x0d, 0x00, 0xa5, 0x8f, 0x37, 0x02, 0x6e, 0x37, 0x02, 0x85,
+  0x01, 0x2b, 0x37, 0x00, 0x85, 0xba, 0x37, 0x02, 0x64, 0x37, 0x04, 0xc0,
+  0x35, 0xd5, 0xc7, 0x02, 0x1e, 0x7b, 0xfe, 0xe1, 0x87, 0x00, 0x59, 0xff,
+  0xe0, 0x61, 0x5b, 0x50, 0xfe, 0x0f, 0x00, 0x16, 0xfe, 0x21, 0x6a, 0x00,
+  0xf0, 0x51, 0xbf, 0xff, 0x20, 0x62, 0xd5, 0xe9, 0x04, 0x0f, 0x00, 0x0e,
+  0x3b, 0xfe, 0x61, 0x0f, 0x00, 0x49, 0xff, 0x60, 0x0f, 0x00, 0x81, 0x01,
+  0xf7, 0x06, 0xfe, 0xa1, 0x0f, 0x00, 0x41, 0xff, 0xa0, 0x62, 0xdd, 0x50,
+  0xaf, 0x30, 0x3b, 0xfe, 0xe1, 0x0d, 0x00, 0x3a, 0xff, 0x7f, 0xe1, 0x69,
+  0x05, 0x46, 0xe5, 0x62, 0x08, 0x11, 0x00, 0xb9, 0xd0, 0xe1, 0xc0, 0x87,
+  0x10, 0xfe, 0x01, 0x46, 0x01, 0xe1, 0xb9, 0xbf, 0xfe, 0x60, 0x63, 0x25,
+  0x6a, 0x28, 0xf1, 0x90, 0x00, 0xfb, 0xf0, 0xc3, 0x9b, 0x00, 0x3c, 0xf8,
+  0x01, 0x46, 0x60, 0x9e, 0x17, 0x00, 0xad, 0xfe, 0xa0, 0x63, 0xe9, 0xf0,
+  0x79, 0x00, 0xb8, 0xea, 0x15, 0x00, 0x31, 0x15, 0x00, 0xa0, 0x15, 0x00,
+  0xa2, 0xfe, 0xe0, 0xab, 0x63, 0x66, 0x4f, 0x00, 0x2c, 0xc1, 0x00, 0x27,
+  0x13, 0x00, 0xe0, 0xbe, 0x13, 0x00, 0x98, 0xfe, 0x20, 0x64, 0x29, 0x3b,
+  0xa0, 0x00, 0xce, 0xb3, 0xe0, 0x00, 0xf0, 0x1c, 0x3f, 0x01, 0x35, 0x00,
+  0x8d, 0xfe, 0x57, 0xa0, 0x64, 0xa6, 0x29, 0x00, 0x17, 0x29, 0x00, 0x12,
+  0x13, 0x00, 0x5d, 0x20, 0x13, 0x00, 0x83, 0xfe, 0x60, 0x29, 0x04, 0x8e,
+  0x21, 0xa2, 0x3c, 0x53, 0x00, 0x15, 0x00, 0x78, 0xfe, 0xe0, 0x64, 0x65,
+  0xd1, 0xa7, 0x01, 0xdf, 0xf4, 0xbd, 0xe0, 0x69, 0x31, 0x1f, 0x00, 0x7e,
+  0xbf, 0xfd, 0x71, 0x59, 0x00, 0x7b, 0xbf, 0x58, 0xf8, 0x27, 0x10, 0xbf,
+  0x00, 0xf0, 0x77, 0xbf, 0x78, 0x42, 0xdb, 0x10, 0x09, 0xdf, 0x08, 0xeb,
+  0x80, 0x06, 0xd9, 0x13, 0x12, 0x94, 0xbd, 0x5f, 0x20, 0x60, 0x7f, 0x1c,
+  0xd9, 0xab, 0x12, 0x8e, 0x7d, 0xe0, 0xeb, 0xb9, 0xb0, 0xd1, 0x51, 0x68,
+  0x81, 0x40, 0xd9, 0xfe, 0x2a, 0xf7, 0x46, 0x69, 0x46, 0x8b, 0x41, 0xde,
+  0xfe, 0x39, 0xb0, 0x39, 0x30, 0xeb, 0xa2, 0x2f, 0xa0, 0xf1, 0xc0, 0x07,
+  0x4d, 0x20, 0x3f, 0x10, 0xce, 0x89, 0xf1, 0x75, 0xfd, 0x06, 0x0b, 0x00,
+  0x47, 0x01, 0x70, 0xfd, 0xfd, 0x07, 0xed, 0xd0, 0x00, 0xf0, 0xa8, 0xfd,
+  0x80, 0x46, 0x7d, 0xd4, 0x11, 0x02, 0x67, 0xfd, 0x81, 0x46, 0x38, 0x79,
+  0xf0, 0x76, 0x09, 0x10, 0xff, 0x41, 0x05, 0x00, 0xab, 0xfd, 0x01, 0x17,
+  0xe0, 0x9f, 0x00, 0xf0, 0x25, 0xfe, 0x07, 0x21, 0x00, 0x6f, 0x01, 0x56,
+  0x2b, 0xfd, 0x04, 0x97, 0xf2, 0xab, 0x1f, 0x02, 0x9b, 0x1f, 0x00, 0x17,
+  0x51, 0xdb, 0x15, 0xfe, 0x33, 0x01, 0x86, 0xfe, 0x13, 0x01, 0x91, 0xfd,
+  0xbd, 0x29, 0x1f, 0x70, 0x24, 0xf8, 0x94, 0xbf, 0x85, 0xb0, 0x20, 0xde,
+  0x43, 0xb1, 0x80, 0xb5, 0x27, 0x49, 0x0f, 0x50, 0x70, 0x08, 0xef, 0x60,
+  0x6b, 0x46, 0x1c, 0xd9, 0xc4, 0xfc, 0xf7, 0x15, 0xf3, 0xfa, 0x01, 0xa9,
+  0xa4, 0x5f, 0xa1, 0x03, 0xfd, 0x05, 0xf1, 0xf5, 0x08, 0xad, 0x80, 0x57,
+  0xab, 0x30, 0xe0, 0xb2, 0xff, 0xf7, 0xef, 0xfc, 0xfb, 0x1b, 0x4a, 0x51,
+  0x71, 0xff, 0xf7, 0xa7, 0xb9, 0xfc, 0x69, 0x10, 0x11, 0x00, 0xc1, 0xfc,
+  0x00, 0x07, 0xa0, 0xc6, 0xbb, 0xfc, 0x03, 0x1f, 0x02, 0xd5, 0xfc, 0x3f,
+  0x07, 0x02, 0xdc, 0xaf, 0xfc, 0xff, 0xf7, 0x3f, 0x03, 0x00, 0x21, 0x0b,
+  0x82, 0x02, 0xbb, 0x20, 0x03, 0x71, 0x00, 0x34, 0x40, 0x28, 0xdd, 0x70,
+  0x45, 0x3d, 0xb9, 0xb2, 0x60, 0x00, 0x00, 0x50, 0x7c, 0xc3, 0x60, 0xc3,
+  0xc0, 0xf3, 0x45, 0x08, 0x03, 0x00, 0x07, 0x00, 0x51, 0x00, 0xc0, 0xff,
+  0xb5, 0xff, 0xeb, 0x00, 0x45, 0x2f, 0xd1, 0x10, 0x09, 0xa3, 0x80, 0x1c,
+  0xcb, 0x4e, 0x0e, 0x37, 0xd0, 0x50, 0xe7, 0x61, 0x8f, 0x03, 0x07, 0xf0,
+  0x7f, 0x35, 0xfe, 0x28, 0x60, 0x29, 0x1d, 0x20, 0x13, 0x50, 0x67, 0x34,
+  0x40, 0xac, 0x73, 0xb3, 0x9d, 0x02, 0x0f, 0xf9, 0x13, 0x01, 0xee, 0xb3,
+  0xd0, 0xf7, 0xb8, 0xbc, 0xbb, 0x04, 0x1d, 0xff, 0xf7, 0xef, 0xef, 0xff,
+  0x29, 0x68, 0x2b, 0x03, 0x07, 0xf0, 0x20, 0xff, 0xbe, 0x00, 0x07, 0x01,
+  0x07, 0x02, 0x07, 0x03, 0xff, 0x07, 0x12, 0x0a, 0x13, 0x0a, 0x1f, 0x0a,
+  0x20, 0xf3, 0x0a, 0xee, 0x44, 0xd1, 0x00, 0x00, 0xaa, 0x09, 0xab, 0x09,
+  0xff, 0x10, 0x0a, 0x11, 0x0a, 0x1d, 0x0a, 0x1e, 0x0a, 0xf6, 0x11, 0x03,
+  0x80, 0x3f, 0x05, 0x01, 0xb3, 0x7b, 0x72, 0x3e, 0xef, 0x99, 0xbb, 0x06,
+  0x3f, 0x07, 0x01, 0x0f, 0x4a, 0x80, 0xbf, 0x04, 0x80, 0x0c, 0x10, 0x60,
+  0x88, 0x05, 0x00, 0x50, 0xbe, 0x89, 0x40, 0x0c, 0x4a, 0x10, 0x60, 0x51,
+  0xf1, 0x42, 0xa2, 0xbd, 0x41, 0xab, 0x41, 0x80, 0x42, 0x42, 0xea, 0x47,
+  0x11, 0x48, 0xbf, 0x68, 0x40, 0xf0, 0x08, 0x00, 0x48, 0x19, 0x00, 0x05,
+  0xb5, 0x48, 0xa9, 0x41, 0x08, 0x17, 0x52, 0x00, 0x00, 0xfb, 0xd0, 0x51,
+  0xfa, 0xd3, 0xe0, 0x51, 0xe7, 0x01, 0x38, 0xb5, 0xdf, 0xf8, 0x90, 0xef,
+  0x46, 0xa8, 0x21, 0x20, 0x8d, 0x10, 0x05, 0xfd, 0x00, 0xff, 0x25, 0xfc,
+  0xf7, 0x2e, 0xfd, 0x54, 0x21, 0x01, 0xff, 0xfb, 0x05, 0x41, 0x6d, 0x1c,
+  0x02, 0x2d, 0x08, 0xff, 0x64, 0xf6, 0xd3, 0x0f, 0xf2, 0xd8, 0x61, 0xdf,
+  0xff, 0xf8, 0x70, 0x06, 0x1c, 0xc9, 0x1c, 0xc0, 0x31, 0xfa, 0x2b, 0x20,
+  0xf0, 0xf9, 0x40, 0x64, 0x06, 0x84, 0xb0, 0x80, 0xfd, 0x7a, 0xab, 0xe0,
+  0xf0, 0x03, 0x09, 0xff, 0xf7, 0xdd, 0xfd, 0xff, 0xf7, 0x30, 0x26, 0x0d,
+  0xf1, 0x04, 0x0a, 0x29, 0xff, 0xfa, 0x06, 0xf0, 0xc0, 0x07, 0x4f, 0xd5,
+  0xdf, 0xff, 0xf8, 0x40, 0x06, 0x26, 0x60, 0x00, 0xf1, 0x40, 0xff, 0x01,
+  0x61, 0x60, 0x54, 0x22, 0x00, 0xf1, 0x0c, 0xff, 0x01, 0xa1, 0x60, 0x01,
+  0x25, 0xdf, 0xf8, 0x24, 0xbf, 0x16, 0x02, 0xfb, 0x06, 0x18, 0x06, 0x5f,
+  0x00, 0x06, 0xff, 0x00, 0x6c, 0x30, 0xe0, 0x61, 0xc4, 0xf8, 0x0c, 0xdd,
+  0x80, 0x19, 0x21, 0x18, 0xfb, 0x29, 0x21, 0x22, 0x8c, 0xfa, 0xff, 0x07,
+  0x00, 0x19, 0xd1, 0xe1, 0x69, 0x60, 0x68, 0x7f, 0x01, 0xeb, 0x45, 0x01,
+  0x00, 0x91, 0x14, 0x89, 0x01, 0xff, 0x01, 0x0b, 0x1d, 0xb0, 0xf9, 0x02,
+  0x20, 0x01, 0xfb, 0x88, 0x20, 0xd5, 0x80, 0x5a, 0xfb, 0x00, 0xb1, 0x05,
+  0xfb, 0x20, 0x4a, 0x79, 0x60, 0x20, 0xb9, 0xe0, 0x69, 0x10, 0x7e, 0xb3,
+  0x60, 0x5a, 0x28, 0x00, 0xda, 0x05, 0x27, 0x3f, 0x03, 0xff, 0xa6, 0xfa,
+  0xc7, 0xb9, 0xe1, 0x69, 0x11, 0xf8, 0xb7, 0x15, 0x20, 0x08, 0xbb, 0x60,
+  0x48, 0x30, 0x45, 0x01, 0x42, 0xff, 0x80, 0x6d, 0x1e, 0x49, 0x78, 0x01,
+  0x80, 0xcd, 0xff, 0xd5, 0xe0, 0x68, 0x50, 0x30, 0x01, 0x21, 0x41, 0xff,
+  0x80, 0x01, 0x80, 0x76, 0x1c, 0x02, 0x2e, 0xa8, 0xaf, 0xd3, 0x38, 0x46,
+  0x04, 0x9b, 0xa1, 0x87, 0x17, 0x01, 0x00, 0xf6, 0x17, 0x02, 0xf5, 0xe7,
+  0x55, 0x52, 0x4f, 0x0c, 0x46, 0x8b, 0xf6, 0xcf, 0x60, 0x7c, 0x15, 0xcb,
+  0x60, 0xf1, 0x40, 0x02, 0x62, 0xff, 0x60, 0x54, 0x23, 0x01, 0xf1, 0x0c,
+  0x02, 0xa2, 0xfe, 0xff, 0xa0, 0x84, 0x5a, 0xdf, 0xf8, 0x60, 0x25, 0x03,
+  0x3f, 0xfb, 0x00, 0x22, 0xe2, 0x60, 0x06, 0xc3, 0xe2, 0xc7, 0x01, 0xff,
+  0xfb, 0xf7, 0xab, 0xfd, 0xe0, 0x68, 0x01, 0x6c, 0xdf, 0x41, 0x64, 0xfc,
+  0xf7, 0x8e, 0x89, 0x21, 0x68, 0x01, 0xff, 0x64, 0x52, 0x46, 0xc1, 0x6b,
+  0x49, 0x1c, 0xc1, 0xff, 0x63, 0x08, 0x21, 0x07, 0xf0, 0x54, 0xfe, 0xe0,
+  0xff, 0x68, 0xe1, 0x69, 0xb0, 0xf8, 0x4a, 0x00, 0x08, 0xdd, 0x70, 0x09,
+  0x03, 0x48, 0x00, 0x48, 0x09, 0x04, 0x4e, 0x00, 0xfd, 0x88, 0x09, 0x04,
+  0x4c, 0x00, 0xc8, 0x70, 0xfb, 0xf7, 0xfb, 0x9b, 0xfd, 0xc9, 0x01, 0x8f,
+  0xfa, 0xe0, 0x68, 0xb0, 0xff, 0xf8, 0x50, 0x00, 0x10, 0xb9, 0x4f, 0xf0,
+  0x05, 0xff, 0x09, 0x65, 0xe0, 0x01, 0x26, 0x49, 0xf2, 0xb2, 0xf3, 0x27,
+  0x32, 0xb7, 0x32, 0x81, 0x30, 0xf8, 0x5f, 0xea, 0x00, 0xff, 0x09, 0x5a,
+  0xd1, 0x01, 0x2e, 0x05, 0xd1, 0xe0, 0xfb, 0x68, 0x3a, 0x7b, 0xa0, 0x07,
+  0xf0, 0x22, 0xfe, 0xba, 0xff, 0x46, 0x76, 0x1e, 0xed, 0xd5, 0xfb, 0xf7,
+  0x65, 0x7f, 0xfd, 0x00, 0x26, 0xdf, 0xf8, 0xc4, 0xa4, 0x03, 0x00, 0xf7,
+  0x84, 0x68, 0x46, 0x43, 0x11, 0x06, 0x05, 0x01, 0x21, 0xff, 0x28, 0x68,
+  0x07, 0xf0, 0x50, 0xfe, 0xe7, 0x68, 0x75, 0x0c, 0x0f, 0x01, 0x7b, 0x83,
+  0x31, 0x5d, 0xfd, 0x51, 0x05, 0x00, 0xff, 0x5a, 0xfd, 0x00, 0xf0, 0xc4,
+  0xfd, 0xcb, 0xf8, 0x5f, 0x14, 0x00, 0x51, 0x46, 0x68, 0x51, 0x40, 0x52,
+  0x0f, 0x00, 0x55, 0xbc, 0x0f, 0x00, 0x18, 0x0f, 0x00, 0xa8, 0x0f, 0x00,
+  0x4a, 0x0f, 0x00, 0x7d, 0xb4, 0x0f, 0x00, 0x1c, 0x00, 0x01, 0x21, 0xe8,
+  0x43, 0x00, 0xe9, 0x2e, 0x15, 0x50, 0x0f, 0x41, 0x3e, 0x3d, 0x02, 0x3b,
+  0xfd, 0x07, 0x77, 0xeb, 0xc6, 0x07, 0xd7, 0x40, 0xfd, 0xf8, 0x62, 0x63,
+  0x00, 0x53, 0x69, 0x07, 0x8b, 0x50, 0x5b, 0x01, 0x2f, 0x1d, 0x02, 0x2c,
+  0x3b, 0x00, 0xfb, 0x96, 0xfd, 0x6d, 0x11, 0x38, 0x63, 0xb9, 0xdb, 0xfb,
+  0xff, 0xf7, 0x2d, 0xfd, 0x49, 0xf6, 0xe4, 0x2a, 0xe0, 0xfb, 0x68, 0x52,
+  0xf7, 0xc0, 0x07, 0xf0, 0xc9, 0xfd, 0x48, 0xfb, 0x46, 0x0b, 0x1d, 0xc2,
+  0x2d, 0xe9, 0xf7, 0x4f, 0x92, 0xff, 0xb0, 0x00, 0x24, 0x12, 0x98, 0x03,
+  0x94, 0x02, 0xff, 0x94, 0xa0, 0x46, 0x00, 0x68, 0x14, 0x99, 0x01, 0xf7,
+  0x90, 0x12, 0x98, 0x0f, 0x50, 0xf9, 0x00, 0x90, 0x10, 0xfe, 0x05, 0xf0,
+  0xe7, 0xf8, 0xd7, 0xe0, 0x12, 0x98, 0xc0, 0xff, 0x69, 0x14, 0x99, 0x10,
+  0xf8, 0x11, 0x10, 0x01, 0xff, 0x98, 0x03, 0xf0, 0x91, 0xfe, 0xa3, 0x46,
+  0x77, 0xff, 0xe0, 0x00, 0x26, 0x04, 0xaa, 0x04, 0xa8, 0x32, 0xff, 0xf9,
+  0x26, 0x20, 0x00, 0xeb, 0x86, 0x0a, 0xd3, 0xff, 0x17, 0xa2, 0xfb, 0x02,
+  0x57, 0xba, 0xf9, 0x02, 0xdf, 0x00, 0x02, 0xfb, 0x03, 0x77, 0x91, 0xd0,
+  0x77, 0xc1, 0xff, 0x17, 0xa0, 0xfb, 0x00, 0x23, 0x00, 0xfb, 0x01, 0xff,
+  0x33, 0x01, 0xfb, 0x00, 0x33, 0x39, 0x46, 0xa8, 0x77, 0x18, 0x59, 0x41,
+  0xff, 0x50, 0xfb, 0x03, 0x99, 0xff, 0x50, 0xdf, 0xfc, 0x03, 0x90, 0x0b,
+  0xa8, 0x37, 0x00, 0x09, 0x30, 0xf7, 0xf9, 0x26, 0x00, 0x29, 0x03, 0xb9,
+  0xf9, 0x02, 0x50, 0xee, 0x2d, 0x05, 0xef, 0x17, 0xa5, 0x7d, 0x20, 0x05,
+  0xfb, 0x07, 0xbf, 0x11, 0x07, 0xfb, 0x05, 0x11, 0x10, 0x39, 0x02, 0xe9,
+  0xfb, 0xfa, 0x21, 0xd7, 0x00, 0x24, 0xfc, 0x04, 0x46, 0x0b, 0xe9, 0xa8,
+  0x2b, 0x01, 0x39, 0x00, 0x90, 0x6f, 0x00, 0x20, 0x04, 0xa8, 0xdb, 0xef,
+  0x17, 0x0b, 0x00, 0xc0, 0xa2, 0x31, 0x00, 0xd3, 0x17, 0x75, 0x02, 0x33,
+  0x00, 0x03, 0x33, 0x00, 0xcc, 0xfb, 0x09, 0x0d, 0x50, 0xf7, 0xcf, 0xfa,
+  0x02, 0x6d, 0x00, 0x0a, 0xfc, 0x02, 0x90, 0xbf, 0x2a, 0x46, 0x04, 0xa8,
+  0x3b, 0x46, 0x6d, 0x01, 0xa0, 0xee, 0xa7, 0x00, 0xc1, 0x17, 0x00, 0xa5,
+  0x00, 0x0b, 0xa8, 0x01, 0xe8, 0xa7, 0x00, 0x13, 0x01, 0x47, 0x00, 0x10,
+  0x19, 0xe0, 0x01, 0x28, 0x1a, 0xbd, 0x67, 0xf7, 0xd0, 0x00, 0xf0, 0xb3,
+  0xfa, 0x49, 0x11, 0xee, 0xff, 0xfb, 0x76, 0x1c, 0x07, 0x2e, 0x80, 0x46,
+  0x8a, 0xff, 0xd3, 0x0b, 0xf1, 0x01, 0x0b, 0x00, 0xf0, 0x5b, 0xff, 0xf8,
+  0x83, 0x45, 0x19, 0xd2, 0x01, 0x98, 0x07, 0xff, 0x23, 0x04, 0xaa, 0x0b,
+  0xa9, 0x03, 0xf0, 0x4e, 0xf7, 0xfe, 0xfe, 0xf7, 0x2d, 0x70, 0x28, 0x3f,
+  0xf4, 0x79, 0xff, 0xaf, 0x12, 0x99, 0xc9, 0x68, 0x06, 0x20, 0x08, 0x7b,
+  0x60, 0xab, 0x29, 0x02, 0x4d, 0xf8, 0x14, 0x99, 0x43, 0x11, 0xfd, 0xe1,
+  0x1d, 0x00, 0x00, 0x90, 0xdf, 0xd0, 0x00, 0xf0, 0xff, 0x44, 0xf8, 0x00,
+  0x98, 0x00, 0x28, 0x32, 0xd1, 0xdf, 0x13, 0x98, 0x14, 0x99, 0x14, 0xbd,
+  0x20, 0x01, 0x06, 0xff, 0x00, 0xf0, 0x33, 0xf8, 0xc0, 0xeb, 0xc0, 0x00,
+  0x9f, 0x00, 0xf0, 0xae, 0xfa, 0x05, 0x5b, 0x20, 0xe3, 0x62, 0xfa, 0xff,
+  0x00, 0xf0, 0xf5, 0xfb, 0x00, 0xf0, 0x23, 0xf8, 0x9f, 0xf0, 0x60, 0x29,
+  0x46, 0x03, 0x41, 0x00, 0x3b, 0xa0, 0xf0, 0x7d, 0xec, 0x11, 0x00, 0x1a,
+  0xf8, 0x30, 0x61, 0xf1, 0x13, 0x20, 0xff, 0xb2, 0xfa, 0x30, 0x60, 0x21,
+  0x46, 0x9a, 0x48, 0xaa, 0xff, 0x10, 0xfc, 0x17, 0x90, 0xf8, 0x3f, 0x90,
+  0x98, 0x17, 0x11, 0xa6, 0xf3, 0xfa, 0x70, 0x17, 0x00, 0x1d, 0x21, 0xa1,
+  0xfa, 0xb0, 0x60, 0xf7, 0x00, 0x98, 0x15, 0xdd, 0x12, 0x90, 0x49, 0x00,
+  0xf0, 0xff, 0x99, 0xba, 0x12, 0x98, 0x01, 0x99, 0x80, 0x68, 0xff, 0x00,
+  0xeb, 0x41, 0x00, 0x80, 0x8a, 0x70, 0x47, 0xf6, 0x99, 0x01, 0xce, 0xe0,
+  0x33, 0x51, 0x21, 0x46, 0x08, 0x29, 0xfd, 0xb1, 0xe3, 0xb0, 0x30, 0x60,
+  0x40, 0xf6, 0x01, 0x30, 0xef, 0x08, 0x39, 0x89, 0xb2, 0x07, 0x90, 0x42,
+  0x01, 0x23, 0xf7, 0x12, 0x78, 0x03, 0x73, 0xf0, 0x8a, 0x43, 0x11, 0x43,
+  0xff, 0xc9, 0xb2, 0xfc, 0xf7, 0x5b, 0xfd, 0x04, 0x2c, 0xff, 0x40, 0xf6,
+  0x06, 0x30, 0x7e, 0x49, 0x05, 0xda, 0x7f, 0x09, 0x78, 0x01, 0xf0, 0xf0,
+  0x01, 0x41, 0xcd, 0xd0, 0xaf, 0x0e, 0xe0, 0x08, 0x2c, 0x0f, 0x03, 0x0f,
+  0x0f, 0x00, 0x30, 0xef, 0x01, 0x06, 0xe0, 0x48, 0x3f, 0x90, 0xf0, 0x00,
+  0x40, 0xde, 0x1b, 0x00, 0x40, 0xf6, 0x07, 0x30, 0x85, 0x51, 0xfc, 0xf7,
+  0xfd, 0x3d, 0x87, 0xb1, 0x28, 0xb2, 0xbf, 0x40, 0xf6, 0x02, 0xff, 0x32,
+  0x40, 0xf6, 0x03, 0x32, 0x08, 0x38, 0x02, 0xfe, 0x77, 0x90, 0x01, 0x24,
+  0x1b, 0x78, 0x84, 0x40, 0x23, 0x7f, 0xea, 0x04, 0x00, 0x01, 0xb1, 0x20,
+  0x43, 0x29, 0x01, 0x7f, 0xc1, 0xb2, 0x10, 0x46, 0xfc, 0xf7, 0x26, 0x6f,
+  0x62, 0xf7, 0xa0, 0x68, 0x22, 0xab, 0x00, 0x42, 0x00, 0x01, 0x29, 0xff,
+  0x02, 0x89, 0x80, 0x88, 0x02, 0xd1, 0x52, 0x1e, 0xdf, 0x92, 0x41, 0xd2,
+  0x0f, 0x11, 0x3d, 0x71, 0xff, 0x5e, 0xff, 0x48, 0x58, 0x4d, 0x00, 0x68,
+  0x21, 0x68, 0x05, 0xff, 0xeb, 0x81, 0x01, 0x08, 0x63, 0xfc, 0xf7, 0x95,
+  0x7d, 0xfa, 0x0b, 0x03, 0x88, 0x63, 0x00, 0x21, 0x20, 0x09, 0x00, 0xfb,
+  0x80, 0x00, 0xe5, 0x51, 0x00, 0x1d, 0xfe, 0xf7, 0x32, 0xfb, 0xbf, 0xf8,
+  0x4b, 0x00, 0x53, 0x4d, 0x4c, 0x4e, 0x51, 0xff, 0x48, 0x07, 0x68, 0xfc,
+  0xf7, 0x80, 0xfa, 0x06, 0xff, 0xf1, 0x38, 0x02, 0x06, 0xf1, 0x30, 0x01,
+  0x52, 0xff, 0xf8, 0x24, 0x20, 0x51, 0xf8, 0x24, 0x10, 0x80, 0xdf, 0x1a,
+  0x2a, 0x6c, 0xc9, 0x1b, 0x47, 0x41, 0x06, 0xeb, 0xff, 0x84, 0x01, 0x49,
+  0x68, 0x49, 0xb9, 0x06, 0xf1, 0xfb, 0x28, 0x01, 0x19, 0x01, 0x88, 0x42,
+  0x03, 0xd2, 0xfd, 0xbb, 0xf7, 0xb4, 0x57, 0xf0, 0xe0, 0xd0, 0xf1, 0xef,
+  0xe4, 0x00, 0xff, 0x21, 0x00, 0x20, 0xfc, 0xf7, 0x2a, 0xff, 0x01, 0xef,
+  0x2d, 0x03, 0xd1, 0x01, 0xb3, 0x50, 0xff, 0xf7, 0xa9, 0xff, 0xff, 0x20,
+  0x68, 0x04, 0xf1, 0x10, 0x01, 0x03, 0x7f, 0xf0, 0xf5, 0xfd, 0x06, 0x00,
+  0x09, 0xd1, 0x8d, 0x80, 0x7e, 0xf3, 0x40, 0x20, 0x68, 0x03, 0xf0, 0x48,
+  0xfe, 0x05, 0x01, 0xff, 0x2a, 0xfe, 0x06, 0x46, 0x01, 0x2e, 0x0b, 0xd0,
+  0x55, 0x02, 0x03, 0x00, 0x0c, 0x03, 0x00, 0x11, 0x03, 0x00, 0x13, 0x03,
+  0x00, 0xff, 0x14, 0x2e, 0x08, 0xbf, 0x0a, 0x26, 0x08, 0xe0, 0xf7, 0x02,
+  0x26, 0x06, 0x5b, 0x40, 0x04, 0xe0, 0x0b, 0x26, 0xff, 0x02, 0xe0, 0x03,
+  0x26, 0x00, 0xe0, 0x09, 0x26, 0x3f, 0x20, 0x68, 0xff, 0xf7, 0xa4, 0xff,
+  0xdd, 0xd1, 0xbb, 0x63, 0xff, 0xfd, 0xf7, 0xe1, 0xf9, 0x03, 0x28, 0x06,
+  0xd1, 0xbf, 0x07, 0xf0, 0xb7, 0xfe, 0x00, 0x21, 0x6b, 0x00, 0x00, 0x97,
+  0xfe, 0xf7, 0xe1, 0x33, 0xf0, 0x03, 0x13, 0xe0, 0x81, 0x01, 0x68, 0xdf,
+  0xff, 0xbd, 0xe8, 0x32, 0x40, 0x97, 0x01, 0x3b, 0xbf, 0xff, 0x70, 0xb5,
+  0x11, 0x4b, 0x03, 0xeb, 0x40, 0x01, 0xff, 0x00, 0x22, 0x0d, 0x7c, 0x8c,
+  0x8a, 0x08, 0x2d, 0xff, 0x02, 0xdb, 0x08, 0x3d, 0xed, 0xb2, 0x01, 0x22,
+  0xff, 0x01, 0x26, 0x06, 0xfa, 0x05, 0xf5, 0xd6, 0x5c, 0xff, 0xae, 0x43,
+  0xd6, 0x54, 0x04, 0xb9, 0x00, 0x25, 0xfb, 0xd2, 0x18, 0x1f, 0xb0, 0x00,
+  0x94, 0x78, 0x2c, 0x43, 0xff, 0x94, 0x70, 0x01, 0x22, 0x42, 0x60, 0x0b,
+  0x4a, 0xff, 0x09, 0x8b, 0xd2, 0x6b, 0x51, 0x43, 0x81, 0x62, 0xfe, 0x53,
+  0xe1, 0x8c, 0xed, 0x00, 0x20, 0xe8, 0x2b, 0x00, 0xfd, 0x20, 0x7b, 0x71,
+  0x00, 0x00, 0xc8, 0x42, 0x00, 0x00, 0xff, 0xa0, 0x41, 0xf4, 0xfd, 0xb4,
+  0x47, 0x06, 0x0b, 0x3f, 0x00, 0x46, 0x18, 0xe0, 0x00, 0xe0, 0x83, 0x71,
+  0x39, 0x21, 0x7f, 0xe0, 0x69, 0x80, 0x88, 0xd0, 0xb9, 0xa0, 0x89, 0x10,
+  0x7e, 0x55, 0x21, 0x00, 0x8a, 0x20, 0x28, 0x09, 0xda, 0xf3, 0x70, 0xfd,
+  0xfe, 0xbb, 0x16, 0x21, 0x00, 0x8a, 0xff, 0xf7, 0x01, 0xcd, 0xff, 0x21,
+  0x05, 0x80, 0x88, 0x19, 0x80, 0x29, 0xa0, 0x01, 0x20, 0xc5, 0x88, 0x51,
+  0xb1, 0x00, 0xe1, 0x70, 0xe2, 0x70, 0x03, 0x03, 0x38, 0xb5, 0xff, 0x75,
+  0x4d, 0x04, 0x46, 0x15, 0xf8, 0x34, 0x10, 0xff, 0x48, 0x1e, 0x80, 0x41,
+  0xc0, 0x0f, 0x01, 0xf0, 0xff, 0x29, 0xfb, 0x01, 0x20, 0x3f, 0xe0, 0xf8,
+  0xb5, 0x9f, 0x06, 0x46, 0x6e, 0x4d, 0x34, 0x19, 0x01, 0x98, 0x30, 0x0f,
+  0xef, 0x46, 0x18, 0xbf, 0x00, 0x39, 0xe0, 0x1b, 0xfb, 0x6a, 0xff, 0x48,
+  0x87, 0x42, 0x28, 0xbf, 0x6a, 0x4f, 0x28, 0xb7, 0x6b, 0x47, 0x43, 0xad,
+  0x91, 0x4f, 0xf8, 0x05, 0x01, 0x53, 0xff, 0xf8, 0x05, 0xeb, 0xc4, 0x00,
+  0x02, 0x21, 0x40, 0xff, 0x68, 0x07, 0x60, 0xc1, 0x60, 0x00, 0x21, 0x81,
+  0xbb, 0x60, 0xf0, 0x03, 0x00, 0x02, 0x20, 0x05, 0x3d, 0x00, 0xf1, 0xfe,
+  0x85, 0x20, 0x5c, 0x4a, 0x02, 0xeb, 0xc0, 0x01, 0x4b, 0xff, 0x68, 0x59,
+  0x68, 0x14, 0x6b, 0xb1, 0xfb, 0xf4, 0xff, 0xf1, 0x00, 0x24, 0x9c, 0x60,
+  0x01, 0x23, 0x02, 0xbf, 0xf8, 0x30, 0x30, 0x08, 0x46, 0x10, 0x6f, 0x10,
+  0x54, 0xfe, 0x83, 0x04, 0x01, 0x29, 0x18, 0xbf, 0xff, 0xf7, 0xe7, 0xfb,
+  0xff, 0x00, 0x39, 0x02, 0x31, 0xbd, 0x51, 0x49, 0x0a, 0xff, 0x68, 0x90,
+  0x42, 0x09, 0xd3, 0x49, 0x68, 0x80, 0xff, 0x1a, 0xb0, 0xfb, 0xf1, 0xf0,
+  0x00, 0x21, 0x01, 0xff, 0xe0, 0x00, 0xbf, 0x49, 0x1c, 0x81, 0x42, 0xfb,
+  0x7e, 0x07, 0xc0, 0x10, 0xb4, 0x46, 0x4b, 0x1b, 0x6b, 0x93, 0x60, 0xff,
+  0xf3, 0x06, 0x24, 0xb3, 0xfb, 0xf4, 0xf3, 0x19, 0xff, 0x00, 0x00, 0x23,
+  0x1a, 0x00, 0x8a, 0x42, 0x02, 0xff, 0xd2, 0x00, 0xbf, 0x52, 0x1c, 0xfa,
+  0xe7, 0x10, 0xbf, 0xbc, 0x70, 0x47, 0x3d, 0x49, 0x01, 0xe5, 0x30, 0x90,
+  0xab, 0xf9, 0x01, 0x71, 0xf0, 0x01, 0x25, 0xf0, 0x39, 0x0f, 0x05, 0x40,
+  0xf2, 0xf9, 0x71, 0xf8, 0x3f, 0xd0, 0x01, 0x31, 0x01, 0xf0, 0xf9, 0xba,
+  0xfd, 0x33, 0x29, 0x08, 0xfb, 0xba, 0x80, 0xb5, 0x06, 0x21, 0xd9, 0x05,
+  0xf1, 0x00, 0xb7, 0x70, 0x21, 0x06, 0x07, 0x00, 0xfe, 0xfa, 0x57, 0x06,
+  0x21, 0x07, 0x07, 0x00, 0xfa, 0x07, 0x00, 0x08, 0x07, 0x00, 0x55, 0xf6,
+  0x07, 0x00, 0x2f, 0x07, 0x00, 0xf2, 0x07, 0x00, 0x30, 0x07, 0x00, 0x55,
+  0xee, 0x07, 0x00, 0x31, 0x07, 0x00, 0xea, 0x07, 0x00, 0x32, 0x07, 0x00,
+  0xff, 0xe6, 0xfa, 0x23, 0x48, 0x1e, 0x49, 0xc0, 0x6b, 0xfb, 0x08, 0x63,
+  0xc7, 0x95, 0xff, 0xf7, 0x49, 0xff, 0x1b, 0xff, 0x48, 0x85, 0x42, 0x19,
+  0x48, 0x28, 0xbf, 0x1a, 0xef, 0x4d, 0x01, 0x6b, 0x00, 0x31, 0x10, 0x69,
+  0x43, 0x40, 0xdf, 0x68, 0x01, 0x60, 0x02, 0x21, 0x33, 0x11, 0xc1, 0x60,
+  0xee, 0x35, 0x13, 0x31, 0xbd, 0x10, 0x89, 0x02, 0x40, 0x68, 0x40, 0x5f,
+  0x69, 0x70, 0x47, 0x80, 0xb5, 0xd7, 0x91, 0xb1, 0x13, 0xb0, 0xff, 0x12,
+  0xf8, 0x08, 0x70, 0x01, 0xbd, 0x80, 0xb5, 0xf5, 0x01, 0x0f, 0x00, 0xa9,
+  0x0f, 0x00, 0x0a, 0xf8, 0x08, 0x72, 0xea, 0x0f, 0x01, 0x02, 0x0f, 0x00,
+  0xa1, 0x0f, 0x00, 0x02, 0xf8, 0x08, 0x7f, 0x74, 0x01, 0xbd, 0x01, 0x49,
+  0x01, 0x20, 0xeb, 0x81, 0xff, 0x74, 0x2a, 0x00, 0x20, 0xc1, 0xe1, 0xe4,
+  0x00, 0xe5, 0xc0, 0x03, 0x00, 0xa8, 0x0b, 0x00, 0x3b, 0x21, 0x80, 0xb5,
+  0x03, 0xfe, 0x2b, 0x00, 0x8b, 0xff, 0xff, 0xf7, 0xec, 0xff, 0x08, 0xff,
+  0x76, 0x01, 0xbd, 0x00, 0x29, 0x40, 0xf1, 0x0b, 0xff, 0x80, 0xf4, 0x46,
+  0x49, 0x42, 0x40, 0x42, 0x71, 0x5d, 0xf1, 0xe1, 0xa1, 0x0a, 0xf8, 0x50,
+  0x44, 0x40, 0x60, 0x3f, 0x00, 0xf7, 0x50, 0xea, 0x01, 0xf9, 0xd0, 0x0e,
+  0x80, 0x09, 0x42, 0xff, 0x00, 0xbf, 0x0b, 0xd1, 0xb0, 0xfa, 0x80, 0xf1,
+  0xff, 0x88, 0x40, 0xc1, 0xf1, 0x9d, 0x01, 0xc9, 0x05, 0xff, 0x02, 0x06,
+  0x72, 0xf1, 0x00, 0x42, 0x41, 0xeb, 0xfd, 0x10, 0x67, 0x00, 0xb1, 0xfa,
+  0x81, 0xf2, 0x41, 0x40, 0xff, 0x90, 0x40, 0xc2, 0xf1, 0x20, 0x02, 0x61,
+  0xfa, 0xff, 0x02, 0xf1, 0x81, 0xea, 0x00, 0x00, 0x18, 0xbf, 0xdf, 0x40,
+  0xf0, 0x01, 0x00, 0x02, 0x2b, 0x00, 0xe8, 0xe7, 0xde, 0x60, 0x20, 0x28,
+  0x40, 0xf1, 0x09, 0x63, 0x00, 0x40, 0x42, 0xf7, 0x00, 0xf0, 0x05, 0x5d,
+  0x05, 0x28, 0x00, 0xbf, 0x0a, 0xf5, 0xd0, 0x53, 0x03, 0xd1, 0x53, 0x0e,
+  0x00, 0x00, 0x10, 0xb5, 0xff, 0xff, 0x23, 0x13, 0xea, 0xd0, 0x54, 0x1d,
+  0xbf, 0xff, 0x13, 0xea, 0xd1, 0x52, 0x9c, 0x42, 0x9a, 0x42, 0xff, 0x39,
+  0xe0, 0xa4, 0x1a, 0xda, 0x07, 0x80, 0xea, 0xff, 0x01, 0x03, 0x13, 0x40,
+  0x42, 0xea, 0x01, 0x21, 0xfe, 0x8f, 0xe0, 0x20, 0x42, 0x1a, 0x3c, 0xbf,
+  0x64, 0x1e, 0xbf, 0x01, 0xeb, 0x42, 0x02, 0x09, 0x0a, 0xb9, 0xe0, 0xfe,
+  0xbf, 0x01, 0xfb, 0x1e, 0x22, 0x12, 0x02, 0x09, 0x00, 0xf0, 0xff, 0x01,
+  0xfb, 0x10, 0x22, 0x6e, 0xf3, 0x0f, 0x20, 0xf6, 0x0d, 0x02, 0xfe, 0x4e,
+  0x2b, 0x00, 0x7f, 0x34, 0x06, 0xdd, 0xff, 0xfe, 0x2c, 0x24, 0xda, 0x53,
+  0xea, 0x50, 0x00, 0xff, 0x50, 0xeb, 0xc4, 0x50, 0x10, 0xbd, 0xd4, 0xf1,
+  0xfb, 0x02, 0x04, 0x31, 0x01, 0x40, 0xf0, 0x80, 0x71, 0x19, 0xff, 0x2c,
+  0x1d, 0xdc, 0x21, 0xfa, 0x04, 0xf0, 0xc4, 0x7f, 0xf1, 0x20, 0x04, 0xa1,
+  0x40, 0x11, 0x43, 0x0b, 0x10, 0xff, 0x42, 0x58, 0x41, 0x10, 0xbd, 0x9c,
+  0x42, 0x1a, 0x7b, 0xbf, 0x03, 0x81, 0x00, 0x9a, 0x42, 0x0f, 0xe0, 0x7b,
+  0x00, 0xff, 0x0e, 0x0e, 0xf0, 0x00, 0x43, 0x40, 0x00, 0x04, 0xff, 0xd0,
+  0x49, 0x00, 0x16, 0xd1, 0x43, 0xf0, 0xff, 0xff, 0x40, 0x10, 0xbd, 0x49,
+  0x00, 0x08, 0xbf, 0xd3, 0xf7, 0x43, 0x18, 0x00, 0x2b, 0x01, 0x05, 0xd1,
+  0xd2, 0x1a, 0x7f, 0xf7, 0xd0, 0x01, 0xf0, 0x00, 0x41, 0x48, 0x19, 0x00,
+  0xff, 0x4a, 0x02, 0x12, 0xbf, 0x08, 0x46, 0x48, 0x40, 0xb9, 0x00, 0xf1,
+  0x00, 0x0d, 0x00, 0xb9, 0x09, 0x02, 0x2b, 0x11, 0x91, 0xff, 0x40, 0x44,
+  0xb1, 0xa4, 0x18, 0xc0, 0x01, 0x40, 0xee, 0x15, 0x00, 0x9e, 0xe7, 0xc9,
+  0xbb, 0x50, 0x00, 0x41, 0x52, 0xf7, 0x42, 0x00, 0x02, 0x0b, 0x10, 0xf4,
+  0xa0, 0x40, 0x14, 0xff, 0x1b, 0x94, 0xe7, 0x90, 0xea, 0x01, 0x0f, 0x44,
+  0xf3, 0xbf, 0x81, 0x17, 0x00, 0x8b, 0xc0, 0xb8, 0x00, 0xbf, 0x43, 0xff,
+  0x1a, 0x4f, 0xf0, 0x00, 0x42, 0x3e, 0xbf, 0x53, 0xff, 0x40, 0xc0, 0x1a,
+  0xc9, 0x18, 0x00, 0xbf, 0xd3, 0xff, 0x09, 0x5f, 0xea, 0xd0, 0x5c, 0x13,
+  0xeb, 0x40, 0xff, 0x0f, 0x34, 0xbf, 0xb3, 0xeb, 0x41, 0x0f, 0x40, 0x7f,
+  0xe0, 0x7c, 0xeb, 0xd1, 0x53, 0x0c, 0xd3, 0x15, 0x11, 0xff, 0x22, 0xd8,
+  0xd1, 0xeb, 0x40, 0x20, 0x09, 0xd3, 0xff, 0x40, 0x0a, 0x28, 0xbf, 0x5f,
+  0xea, 0x50, 0x01, 0xff, 0x40, 0xeb, 0xcc, 0x50, 0x70, 0x47, 0x40, 0x1a,
+  0xf7, 0x15, 0xd0, 0x40, 0x61, 0x01, 0xf2, 0x52, 0x1c, 0x90, 0xff, 0x40,
+  0x40, 0x0a, 0x4f, 0xea, 0x3c, 0x23, 0xb3, 0xff, 0xeb, 0x02, 0x63, 0x84,
+  0xbf, 0x00, 0xeb, 0x73, 0xff, 0x00, 0x07, 0xe0, 0x40, 0xf4, 0x00, 0x00,
+  0x1a, 0xff, 0x16, 0xdb, 0x07, 0xc2, 0xf1, 0x01, 0x02, 0xd0, 0xff, 0x40,
+  0x18, 0x43, 0x70, 0x47, 0x18, 0x2b, 0xfc, 0xff, 0xdc, 0x31, 0xfa, 0x03,
+  0xf2, 0x02, 0xfa, 0x03, 0xff, 0xf3, 0x59, 0x1a, 0x38, 0xbf, 0x42, 0xf0,
+  0x01, 0xfb, 0x02, 0xd2, 0x59, 0x00, 0x3c, 0xbf, 0x40, 0x00, 0xac, 0xff,
+  0xf1, 0x01, 0x0c, 0x5f, 0xea, 0xcc, 0x5c, 0xc2, 0x3d, 0x05, 0xb1, 0x10,
+  0x41, 0x4c, 0xeb, 0x50, 0xb1, 0x10, 0x8d, 0x01, 0x7f, 0x0f, 0xd2, 0x4b,
+  0x00, 0x09, 0xd0, 0xac, 0x8b, 0x00, 0xff, 0x02, 0x2b, 0x03, 0xdb, 0x49,
+  0x02, 0x17, 0x2b, 0xff, 0xdd, 0xdd, 0x70, 0x47, 0x91, 0x43, 0x40, 0x1a,
+  0xdf, 0x43, 0x00, 0xd5, 0xd1, 0x00, 0x25, 0x02, 0x41, 0x0f, 0x3f, 0xd0,
+  0xd3, 0x6f, 0xf0, 0x00, 0x00, 0xe3, 0x11, 0xe7, 0x07, 0xbf, 0xff, 0xf7,
+  0x8d, 0xbf, 0x00, 0xbf, 0xcd, 0x11, 0x80, 0xf7, 0x1a, 0x89, 0x18, 0xed,
+  0x00, 0x4c, 0xc0, 0xf3, 0xc7, 0xff, 0x52, 0xff, 0x2a, 0x24, 0xd0, 0xc1,
+  0xf3, 0xc7, 0xff, 0x53, 0x13, 0xb3, 0xd2, 0x1a, 0xd2, 0xf1, 0x19, 0xaf,
+  0x03, 0x27, 0xdd, 0x4c, 0xe1, 0x00, 0x4c, 0x91, 0x00, 0x21, 0xff, 0xea,
+  0x03, 0x03, 0xd1, 0x40, 0xc2, 0x0d, 0x4c, 0xfe, 0xd7, 0x10, 0x40, 0x18,
+  0x34, 0xbf, 0x20, 0xea, 0x0c, 0xfb, 0x00, 0x4c, 0xd7, 0x10, 0xd2, 0x05,
+  0x53, 0xea, 0x00, 0xbf, 0x63, 0x73, 0xeb, 0x0c, 0x0c, 0x52, 0x47, 0x20,
+  0x42, 0xff, 0x00, 0x12, 0xf1, 0x80, 0x7f, 0x38, 0xbf, 0x70, 0xff, 0x47,
+  0xc0, 0x0d, 0xc0, 0x05, 0x70, 0x47, 0x49, 0xfe, 0x8f, 0x10, 0x9a, 0x42,
+  0x00, 0xeb, 0x51, 0x20, 0xf8, 0x7f, 0xe7, 0xd2, 0xf1, 0x17, 0x03, 0xd9,
+  0xd5, 0x37, 0xc0, 0xbf, 0xf4, 0x00, 0x02, 0xc1, 0x0d, 0x23, 0xf4, 0xe0,
+  0x29, 0xff, 0xd2, 0x30, 0xea, 0xc1, 0x50, 0x10, 0x43, 0x7d, 0xff, 0x31,
+  0x49, 0x08, 0x28, 0xbf, 0x00, 0x18, 0x80, 0xff, 0x00, 0x4f, 0xf0, 0xc0,
+  0x73, 0xb0, 0xf1, 0x90, 0xff, 0x60, 0x06, 0xd4, 0x52, 0x08, 0x0e, 0xd2,
+  0xc0, 0xf7, 0x1a, 0x9b, 0x18, 0x01, 0x10, 0x00, 0xf8, 0xd5, 0x52, 0x7f,
+  0x08, 0x06, 0xd2, 0xc0, 0x18, 0x9b, 0x1a, 0x0d, 0x01, 0xfd, 0xf1, 0x0d,
+  0x00, 0xf8, 0xd3, 0x5b, 0x1e, 0x58, 0x08, 0xe7, 0x50, 0xeb, 0xc1, 0x69,
+  0x10, 0xd1, 0x21, 0x08, 0x39, 0x88, 0xff, 0x40, 0xf9, 0xd0, 0xd1, 0xf1,
+  0x01, 0x01, 0xd8, 0xff, 0xe7, 0xff, 0x29, 0xf4, 0xd0, 0xd0, 0x42, 0xf2,
+  0xfd, 0xd8, 0x04, 0x20, 0xd0, 0xc8, 0x43, 0x07, 0xf0, 0xb3, 0xdf, 0xbf,
+  0x00, 0x00, 0x40, 0xea, 0x3f, 0x11, 0x4c, 0x0c, 0xf7, 0x07, 0xd0, 0x88,
+  0x31, 0x20, 0x4f, 0xea, 0x40, 0x0c, 0xbd, 0x1c, 0xa7, 0x00, 0x98, 0xbf,
+  0x80, 0x42, 0xc7, 0xc1, 0x80, 0xbb, 0x7c, 0x1c, 0x4b, 0x10, 0x94, 0xbf,
+  0x1c, 0x2b, 0x10, 0x05, 0xdd, 0xe0, 0x2b, 0x05, 0x01, 0xd2, 0x88, 0x1d,
+  0x00, 0x18, 0xbf, 0xdd, 0x81, 0x05, 0x00, 0xff, 0x22, 0x12, 0xff, 0x10,
+  0x1d, 0xbf, 0xff, 0x12, 0xea, 0xd1, 0x53, 0x94, 0x45, 0x93, 0x42, 0xdf,
+  0x2b, 0xe0, 0x9c, 0x44, 0xd3, 0x19, 0x31, 0x02, 0x1a, 0xeb, 0x40, 0x43,
+  0x11, 0x10, 0x43, 0x25, 0x10, 0xa1, 0xfb, 0x00, 0xef, 0x30, 0x41, 0x00,
+  0x38, 0xad, 0x10, 0x7c, 0xf1, 0x7f, 0xff, 0x01, 0x0b, 0xdb, 0xfe, 0x29,
+  0x4a, 0xda, 0x5b, 0xdf, 0x08, 0x42, 0xea, 0xc1, 0x51, 0x21, 0x12, 0xf1,
+  0x00, 0xfb, 0x4c, 0x51, 0x69, 0x32, 0xd1, 0xf1, 0x08, 0x0c, 0xdc, 0xff,
+  0xf1, 0x20, 0x01, 0x2f, 0xdb, 0x5b, 0x08, 0x10, 0xf6, 0x73, 0x80, 0x0b,
+  0x43, 0x1b, 0x00, 0x41, 0x20, 0xfa, 0x0c, 0xff, 0xf0, 0x50, 0x41, 0x70,
+  0x47, 0x94, 0x45, 0x1c, 0x5b, 0xbf, 0x02, 0x65, 0x00, 0x93, 0x42, 0x5d,
+  0x01, 0x02, 0x85, 0x20, 0xdf, 0x1d, 0xd0, 0x40, 0x00, 0x19, 0xfd, 0x20,
+  0x17, 0xd0, 0xbf, 0x5b, 0xb9, 0x63, 0x45, 0x14, 0xd0, 0xd3, 0x22, 0xf3,
+  0xbf, 0x99, 0x40, 0xbc, 0xeb, 0x03, 0x0c, 0xd3, 0x23, 0xc1, 0x2d, 0xe7,
+  0xcb, 0x22, 0xfc, 0x10, 0x43, 0x00, 0xb3, 0x89, 0x10, 0xe1, 0x23, 0x77,
+  0xb6, 0xe7, 0x10, 0xf3, 0x10, 0x40, 0x00, 0x0a, 0x3b, 0x00, 0x77, 0x08,
+  0xd0, 0x10, 0xef, 0x00, 0x94, 0xbf, 0x11, 0x05, 0x00, 0x77, 0x02, 0xe0,
+  0x42, 0x45, 0x30, 0x70, 0x47, 0xd0, 0x73, 0x20, 0xff, 0x41, 0x00, 0x09,
+  0x0e, 0x7f, 0x39, 0x15, 0xd4, 0xff, 0xd1, 0xf1, 0x1f, 0x01, 0x14, 0xd4,
+  0x40, 0x00, 0x7b, 0x07, 0xd2, 0x51, 0x03, 0xc8, 0x40, 0x48, 0xbf, 0x33,
+  0x20, 0x6c, 0x25, 0x00, 0x0f, 0x05, 0x4c, 0xbf, 0x23, 0x20, 0x40, 0x40,
+  0x0b, 0x10, 0x76, 0x55, 0x21, 0x00, 0x42, 0x0d, 0x01, 0x58, 0xbf, 0xc0,
+  0x43, 0x00, 0xfe, 0x37, 0x21, 0x7e, 0x3a, 0x09, 0xdd, 0x18, 0x2a, 0x0c,
+  0xff, 0xda, 0x6f, 0xf0, 0x7f, 0x41, 0xd1, 0x40, 0x20, 0x3f, 0xea, 0x51,
+  0x00, 0x40, 0x18, 0x88, 0x1b, 0x00, 0x87, 0x31, 0xf5, 0x08, 0x99, 0x40,
+  0x7e, 0xa7, 0x10, 0x38, 0xb5, 0x0b, 0x46, 0xff, 0xc3, 0xf3, 0xc7, 0x51,
+  0xff, 0x29, 0x02, 0x46, 0xff, 0x09, 0xd0, 0x11, 0xb1, 0x4f, 0xf0, 0xff,
+  0x34, 0xff, 0x09, 0xe0, 0x58, 0x02, 0x0c, 0xbf, 0x00, 0x24, 0xdf, 0x6f,
+  0xf0, 0x01, 0x04, 0x03, 0x0b, 0x00, 0x14, 0xbf, 0x5f, 0x02, 0x24, 0x01,
+  0x24, 0xc2, 0x25, 0x02, 0x08, 0x23, 0x03, 0x7f, 0x31, 0x08, 0xe0, 0x50,
+  0x02, 0x06, 0xd0, 0x21, 0x00, 0xf3, 0x01, 0x03, 0x09, 0x00, 0x21, 0x00,
+  0x21, 0x01, 0x21, 0x01, 0xff, 0x2c, 0xb8, 0xbf, 0x01, 0x29, 0x1c, 0xda,
+  0x00, 0xef, 0x2a, 0x46, 0xbf, 0x82, 0x23, 0x10, 0x08, 0x25, 0x00, 0xbf,
+  0x25, 0x00, 0x2b, 0x44, 0xbf, 0x83, 0x2b, 0x40, 0x85, 0xdf, 0xf0, 0x06,
+  0x05, 0x18, 0x46, 0x3b, 0x91, 0x12, 0xff, 0xff, 0x02, 0xd2, 0xff, 0xf7,
+  0x93, 0xfd, 0x1f, 0xe0, 0x7f, 0x00, 0x2c, 0x04, 0xd5, 0x10, 0x46, 0x19,
+  0x13, 0x00, 0xff, 0x8c, 0xfd, 0x1a, 0xe0, 0x00, 0x20, 0x18, 0xe0, 0xff,
+  0x02, 0x29, 0x01, 0xd1, 0x10, 0x46, 0x32, 0xbd, 0xdf, 0x02, 0x2c, 0x01,
+  0xd1, 0x18, 0x07, 0x00, 0x8c, 0x42, 0xed, 0x0c, 0xe1, 0x00, 0x7e, 0x50,
+  0x03, 0x80, 0x2a, 0x4c, 0xbf, 0xd6, 0x4f, 0x03, 0x48, 0xbf, 0x4b, 0x01,
+  0x01, 0x29, 0x00, 0x85, 0xf0, 0x77, 0x02, 0x05, 0x29, 0x4d, 0xf4, 0x91,
+  0xbe, 0x00, 0xa7, 0x20, 0xec, 0x33, 0x2f, 0x06, 0x2d, 0x21, 0x18, 0xbf,
+  0x39, 0x21, 0x2d, 0xe9, 0xf1, 0x6f, 0x4d, 0x83, 0xb0, 0x0c, 0xd1, 0xa0,
+  0x01, 0x94, 0x23, 0x10, 0x7f, 0x50, 0xff, 0x28, 0x15, 0x46, 0x08, 0xd1,
+  0xdf, 0xa0, 0xfb, 0x27, 0x40, 0xf3, 0x00, 0x4f, 0xf0, 0x01, 0x08, 0x4f,
+  0xff, 0xf0, 0x02, 0x08, 0x13, 0xe0, 0x01, 0x28, 0x07, 0xff, 0xda, 0x03,
+  0xa8, 0x07, 0xf0, 0xdf, 0xfe, 0x01, 0xff, 0x28, 0x02, 0xdb, 0x00, 0x27,
+  0xb8, 0x46, 0x09, 0xff, 0xe0, 0x03, 0x99, 0x21, 0xf0, 0xff, 0x41, 0x41,
+  0xff, 0xf0, 0x7c, 0x51, 0x03, 0x91, 0xa0, 0xf1, 0x7e, 0xe5, 0x07, 0x07,
+  0x10, 0x38, 0x85, 0x70, 0x25, 0x02, 0x06, 0x46, 0x0d, 0x7f, 0xb1, 0x00,
+  0x20, 0x28, 0x80, 0x26, 0xb9, 0x9b, 0xd0, 0xff, 0x21, 0xff, 0xf7, 0x91,
+  0xfe, 0x12, 0xd0, 0xb8, 0xff, 0xf1, 0x00, 0x0f, 0x12, 0xd5, 0x3f, 0xb2,
+  0x01, 0xeb, 0x2f, 0x14, 0x61, 0x00, 0x4f, 0x37, 0x00, 0xff, 0xf7, 0x85,
+  0xff, 0xfe, 0x06, 0xd0, 0x01, 0x2e, 0x0c, 0xd1, 0x4f, 0xbb, 0xf0, 0x3f,
+  0xed, 0x30, 0x7e, 0xfe, 0x2e, 0x09, 0x00, 0x7e, 0xff, 0x50, 0x0d, 0xe1,
+  0xb8, 0xf1, 0x02, 0x0f, 0x03, 0xfe, 0x25, 0x00, 0x08, 0xe1, 0x01, 0x2e,
+  0x53, 0xdb, 0x02, 0xfc, 0x99, 0x90, 0xe3, 0xd1, 0x02, 0x81, 0xb8, 0xf1,
+  0x01, 0x0f, 0xfd, 0x1a, 0x9f, 0x01, 0x28, 0x02, 0xd4, 0x00, 0x2c, 0x43,
+  0xfb, 0xd5, 0x2f, 0x35, 0x10, 0x09, 0xd4, 0x00, 0x2e, 0x3e, 0xf6, 0x37,
+  0x00, 0xff, 0x31, 0x7b, 0x01, 0xa1, 0xfe, 0x00, 0x28, 0xbf, 0x37, 0xd5,
+  0x34, 0xe0, 0x16, 0xbb, 0x11, 0x05, 0x98, 0xfe, 0x11, 0x00, 0x1b, 0xd5,
+  0x17, 0xe0, 0x01, 0x2e, 0x08, 0xff, 0xd1, 0x00, 0x2c, 0x3f, 0xb2, 0x02,
+  0xd4, 0x01, 0xff, 0x2f, 0x26, 0xda, 0x12, 0xe0, 0x01, 0x2f, 0x10, 0x3b,
+  0xda, 0x22, 0x3f, 0x00, 0x0f, 0xd4, 0x66, 0x51, 0xe0, 0x2b, 0x03, 0xad,
+  0x82, 0x2b, 0x00, 0x44, 0xbf, 0x5f, 0x02, 0xd5, 0x3d, 0x21, 0xc8, 0xfe,
+  0x87, 0x10, 0xc6, 0xe0, 0x07, 0xf0, 0x9d, 0xfe, 0x22, 0xaf, 0x21, 0x01,
+  0x60, 0x5e, 0x27, 0x06, 0x6e, 0x27, 0x06, 0x01, 0xdf, 0xd5, 0x4f, 0x48,
+  0xb5, 0xe0, 0x17, 0x00, 0x40, 0xb2, 0xfd, 0xe0, 0x0f, 0x01, 0x48, 0xbf,
+  0x00, 0x2e, 0x06, 0xd5, 0x9f, 0x07, 0xf0, 0x84, 0xfe, 0x21, 0x31, 0x00,
+  0x9f, 0x21, 0xa6, 0xfd, 0xe0, 0x01, 0x11, 0x38, 0xff, 0x38, 0xbf, 0x00,
+  0x26, 0xb7, 0x08, 0xd3, 0x80, 0x11, 0x00, 0x03, 0x90, 0x47, 0x05, 0x4a,
+  0xfe, 0x29, 0x10, 0x03, 0x98, 0x40, 0x49, 0xff, 0xf7, 0x0e, 0xdf, 0xfe,
+  0x06, 0xd2, 0x01, 0x46, 0xb3, 0x10, 0x40, 0xff, 0xff, 0xf7, 0x1a, 0xfe,
+  0x03, 0x90, 0x7f, 0x1e, 0x03, 0xff, 0x99, 0x3b, 0x48, 0xff, 0xf7, 0x78,
+  0xfd, 0x83, 0xf7, 0x46, 0x03, 0x99, 0x15, 0x11, 0xff, 0xf7, 0x72, 0xfd,
+  0xf7, 0x01, 0x46, 0x58, 0x1f, 0x20, 0x7c, 0xfc, 0x80, 0x46, 0xfd, 0x41,
+  0x07, 0x00, 0x06, 0xfe, 0x82, 0x46, 0xcd, 0xf8, 0x7f, 0x0c, 0xb0, 0x06,
+  0xf0, 0xad, 0xff, 0x51, 0x0f, 0x00, 0xff, 0xfe, 0xfd, 0x03, 0x99, 0xff,
+  0xf7, 0xeb, 0xfc, 0xfa, 0x1b, 0x01, 0xf8, 0x2b, 0x00, 0x03, 0x98, 0xff,
+  0xf7, 0x58, 0xff, 0xfd, 0x80, 0x46, 0x38, 0xb2, 0xff, 0xf7, 0x48, 0xeb,
+  0xfc, 0x07, 0x85, 0xc0, 0x27, 0x69, 0x00, 0x5d, 0xfc, 0x39, 0xbe, 0x1f,
+  0x00, 0x4c, 0xfd, 0x01, 0x90, 0x21, 0x07, 0x00, 0xe4, 0xeb, 0xfd, 0x00,
+  0x8d, 0x00, 0x47, 0x7d, 0x10, 0xcd, 0xfd, 0x43, 0x7b, 0xd3, 0x20, 0x1f,
+  0x00, 0xe3, 0xfe, 0x41, 0xd9, 0xb1, 0x01, 0x35, 0xc5, 0x41, 0x00, 0x34,
+  0x03, 0x20, 0x3f, 0x40, 0xab, 0x10, 0x7d, 0x00, 0x5f, 0x33, 0xfd, 0xff,
+  0xf7, 0x39, 0x71, 0x00, 0x38, 0x9f, 0xc0, 0x7f, 0xff, 0xf7, 0xc8, 0xfd,
+  0x07, 0x46, 0x50, 0x07, 0x00, 0x75, 0x1c, 0xdb, 0xf0, 0x38, 0x07, 0x00,
+  0xb0, 0xfc, 0x10, 0x3b, 0x00, 0xb5, 0xbd, 0x15, 0x00, 0x40, 0x1f, 0x02,
+  0xb8, 0xfd, 0x65, 0x01, 0x19, 0x7e, 0x5d, 0x00, 0x1d, 0xb1, 0xa5, 0xf8,
+  0x00, 0xa0, 0x4d, 0x10, 0xbb, 0x0a, 0x52, 0xdf, 0x00, 0x7e, 0x51, 0x68,
+  0xe7, 0xe0, 0xfb, 0xff, 0xfd, 0x68, 0xb1, 0x01, 0x28, 0x0d, 0xd0, 0x13,
+  0xfe, 0xb3, 0x90, 0x00, 0x00, 0x80, 0xff, 0xf3, 0x04, 0x35, 0x7d, 0x3f,
+  0x07, 0x00, 0xbf, 0x18, 0x72, 0x31, 0x3f, 0x7b, 0xa0, 0x5a, 0xbf, 0x30,
+  0x01, 0x53, 0x12, 0x00, 0x90, 0x4d, 0x20, 0xfd, 0x7b, 0x11, 0xbf, 0x00,
+  0x2e, 0x00, 0x98, 0x18, 0xbf, 0x3d, 0x11, 0x04, 0xfe, 0x41, 0xd1, 0x8d,
+  0x00, 0x22, 0xa0, 0xe6, 0x00, 0x00, 0x7f, 0xd2, 0xb2, 0x20, 0x3a, 0x22,
+  0xbf, 0x00, 0x5f, 0x80, 0xbe, 0xf1, 0x31, 0x52, 0x42, 0xd0, 0x41, 0xd2,
+  0x6f, 0x80, 0x91, 0x2f, 0x40, 0x41, 0x40, 0xd0, 0x7b, 0x80, 0x41, 0x1b,
+  0x40, 0xc7, 0xa1, 0xff, 0x05, 0x46, 0x0d, 0x48, 0x0c, 0x46, 0x41, 0x78,
+  0xff, 0x21, 0x70, 0x6a, 0x46, 0x00, 0x78, 0x60, 0x70, 0xf7, 0xa1, 0x1d,
+  0x28, 0x4d, 0x20, 0x89, 0xf8, 0x0f, 0xf2, 0xff, 0x50, 0x10, 0x30, 0xf8,
+  0x25, 0x10, 0x01, 0xf1, 0xff, 0x8c, 0x41, 0x00, 0xeb, 0x85, 0x00, 0x09,
+  0x78, 0xef, 0xe1, 0x70, 0x40, 0x88, 0x6b, 0xd0, 0x40, 0x00, 0x78, 0xf7,
+  0x20, 0x71, 0x31, 0x0f, 0xb0, 0x6d, 0x09, 0x00, 0x46, 0xff, 0x38, 0xb5,
+  0x0d, 0x46, 0x2a, 0x79, 0xe9, 0x78, 0xbd, 0x04, 0x33, 0x00, 0x47, 0xf8,
+  0xe9, 0x88, 0x89, 0x21, 0x59, 0xff, 0xf8, 0x29, 0x78, 0x40, 0xf6, 0x6e,
+  0x10, 0xfb, 0xdf, 0xf7, 0x98, 0xfe, 0x69, 0x78, 0x73, 0x31, 0x40, 0xf6,
+  0xfd, 0x6d, 0x0d, 0x00, 0x91, 0xbe, 0x70, 0xb5, 0x55, 0x1c, 0xff, 0x0e,
+  0x46, 0x03, 0x2e, 0x04, 0x46, 0x1d, 0xd0, 0xfd, 0x10, 0x79, 0xd0, 0x9f,
+  0x00, 0x10, 0x70, 0x02, 0x2e, 0xfd, 0x28, 0x09, 0x00, 0xe0, 0x00, 0x28,
+  0x70, 0x08, 0xd1, 0xff, 0x90, 0x78, 0x13, 0x78, 0x43, 0xea, 0x40, 0x13,
+  0xf7, 0x13, 0x70, 0x2b, 0x07, 0x01, 0x10, 0x28, 0x70, 0x00, 0xff, 0x2c,
+  0x10, 0x78, 0x07, 0xbf, 0x00, 0xf0, 0xfc, 0xbf, 0x00, 0x08, 0x43, 0x00,
+  0xf0, 0xf3, 0x07, 0x60, 0x81, 0xfc, 0x33, 0x00, 0x5d, 0x01, 0x11, 0x78,
+  0xfb, 0xf7, 0x68, 0xfe, 0xfc, 0x69, 0x01, 0x5b, 0x01, 0x63, 0xfe, 0x02,
+  0x2e, 0x05, 0xd1, 0xde, 0x95, 0xa1, 0x70, 0x40, 0x00, 0x22, 0xf7, 0xc0,
+  0xe0, 0x70, 0xfe, 0x03, 0xd0, 0x39, 0x2a, 0x0f, 0xf2, 0x88, 0x06, 0x04,
+  0xfb, 0x46, 0xac, 0x8b, 0x70, 0x40, 0x05, 0x02, 0xf0, 0xbf, 0xff, 0x05,
+  0x36, 0xf8, 0x24, 0x00, 0xfb, 0xf7, 0x4c, 0xe7, 0xfe, 0x29, 0x46, 0x3f,
+  0xd0, 0x77, 0xd0, 0x70, 0x40, 0x40, 0xef, 0x88, 0xfb, 0xf7, 0x44, 0x99,
+  0x00, 0x04, 0x46, 0x0f, 0xf7, 0xf2, 0x64, 0x06, 0x15, 0x01, 0x0d, 0x46,
+  0x40, 0x88, 0x67, 0x29, 0x0a, 0xfb, 0xcf, 0x10, 0x2d, 0x01, 0xe9, 0xb2,
+  0x25, 0x01, 0xff, 0xfb, 0xf7, 0x32, 0xbe, 0x2d, 0xe9, 0xf0, 0x41, 0xfd,
+  0x06, 0x25, 0x00, 0x48, 0x08, 0x08, 0xeb, 0x86, 0x00, 0xdf, 0x0c, 0x46,
+  0x47, 0x88, 0x15, 0xbf, 0x30, 0x38, 0x46, 0xdf, 0xfb, 0xf7, 0x24, 0xfe,
+  0x07, 0x17, 0x12, 0x38, 0xf8, 0xdd, 0x26, 0x2f, 0x12, 0x09, 0x78, 0x41,
+  0x53, 0x60, 0x81, 0x0a, 0xff, 0x80, 0x05, 0x29, 0x70, 0x80, 0x0d, 0x20,
+  0x80, 0xfe, 0x93, 0x10, 0x81, 0x00, 0x00, 0x67, 0x09, 0x68, 0x09, 0xff,
+  0x6a, 0x09, 0x6b, 0x09, 0x60, 0x09, 0x61, 0x09, 0xff, 0x62, 0x09, 0x63,
+  0x09, 0x40, 0x09, 0x41, 0x09, 0xdf, 0x42, 0x09, 0x43, 0x09, 0x13, 0xbb,
+  0x70, 0x03, 0xd5, 0xff, 0x5b, 0x42, 0x52, 0x42, 0x63, 0xf1, 0x00, 0x03,
+  0xff, 0x9c, 0xea, 0x21, 0x0c, 0x00, 0xf0, 0x17, 0x80, 0xbf, 0x10, 0xb5,
+  0x64, 0x46, 0x03, 0xd3, 0x63, 0xa1, 0x61, 0xbe, 0x63, 0xa2, 0x0e, 0xf8,
+  0x64, 0x00, 0x04, 0x0f, 0x06, 0x24, 0xf9, 0x42, 0x31, 0x07, 0x9b, 0xc1,
+  0x1b, 0x42, 0x13, 0xd1, 0x09, 0xff, 0x42, 0x36, 0xd1, 0x2a, 0xb1, 0x84,
+  0x46, 0xb0, 0xfb, 0xfb, 0xf2, 0x7f, 0xb0, 0x10, 0xc2, 0x70, 0x47, 0x07,
+  0xdf, 0xf0, 0xe1, 0xbd, 0xfc, 0xd3, 0x0f, 0x10, 0x23, 0x70, 0xdf, 0x47,
+  0x0b, 0x00, 0x02, 0x00, 0x0f, 0xe1, 0x70, 0x47, 0xf7, 0x90, 0x42, 0x71,
+  0x79, 0x60, 0xf6, 0xd3, 0x70, 0xb5, 0xfe, 0x87, 0x60, 0xf4, 0xb3, 0xfa,
+  0x83, 0xf5, 0x2c, 0x1b, 0xfb, 0xa3, 0x40, 0xc5, 0x90, 0x05, 0x32, 0xfa,
+  0x05, 0xf6, 0xff, 0x33, 0x43, 0xa2, 0x40, 0x5f, 0xf0, 0x00, 0x46, 0xff,
+  0xe6, 0x40, 0x02, 0xe0, 0x5b, 0x08, 0x5f, 0xea, 0x6f, 0x32, 0x02, 0x84,
+  0x1a, 0x2f, 0x00, 0x05, 0x24, 0x65, 0x40, 0xff, 0x29, 0x46, 0x76, 0x41,
+  0xf4, 0xd3, 0x02, 0x00, 0xf7, 0x0b, 0x00, 0x30, 0x4b, 0x00, 0x70, 0xbd,
+  0x01, 0x2a, 0xff, 0xcf, 0xd9, 0x70, 0xb5, 0x14, 0x0c, 0x20, 0xd0, 0xde,
+  0x49, 0x01, 0xb2, 0xfa, 0x82, 0xf5, 0x0b, 0xa1, 0x64, 0x19, 0x7f, 0xb4,
+  0xf1, 0x20, 0x06, 0xd6, 0xd3, 0xb2, 0x47, 0x01, 0xff, 0x44, 0xf4, 0x40,
+  0x00, 0x25, 0x02, 0xe0, 0x52, 0xee, 0x49, 0x00, 0x33, 0x03, 0xc6, 0x49,
+  0x00, 0x02, 0x0e, 0x24, 0xff, 0xbf, 0x30, 0x46, 0x71, 0x46, 0x64, 0x41,
+  0x6d, 0xfb, 0x41, 0xf3, 0x4b, 0x02, 0x20, 0x00, 0x29, 0x00, 0x70, 0xff,
+  0xbd, 0x0c, 0x46, 0xb1, 0xfb, 0xf2, 0xf1, 0x02, 0xff, 0xfb, 0x11, 0x45,
+  0x2d, 0x04, 0x45, 0xea, 0x10, 0xff, 0x45, 0xb5, 0xfb, 0xf2, 0xf4, 0x02,
+  0xfb, 0x14, 0x3f, 0x55, 0x80, 0xb2, 0x40, 0xea, 0x05, 0x0d, 0x01, 0xd3,
+  0x01, 0xdf, 0x52, 0x40, 0xea, 0x04, 0x40, 0xf3, 0xd1, 0x10, 0xb5, 0x6f,
+  0xda, 0x48, 0x01, 0x1d, 0xd9, 0x01, 0x0c, 0xc1, 0xd5, 0x00, 0xdf, 0x24,
+  0x1e, 0xc0, 0x10, 0xbd, 0x9f, 0x10, 0x43, 0xd5, 0xff, 0x48, 0x87, 0xb0,
+  0x80, 0x7a, 0x00, 0xf0, 0x03, 0xfb, 0x08, 0x40, 0x97, 0x10, 0xc2, 0xfd,
+  0x00, 0x24, 0x08, 0xff, 0xb9, 0x02, 0x20, 0x55, 0xe0, 0x00, 0x26, 0xdf,
+  0xff, 0xf8, 0x38, 0x93, 0xcf, 0x4d, 0x28, 0xfa, 0x06, 0xff, 0xf0, 0xc0,
+  0x07, 0x49, 0xd5, 0x00, 0x27, 0x28, 0xff, 0x78, 0x01, 0x21, 0xb9, 0x40,
+  0x08, 0x42, 0x3f, 0xfd, 0xd0, 0x15, 0x11, 0xfb, 0xf7, 0x97, 0xff, 0x01,
+  0x2f, 0xff, 0x06, 0xd1, 0x03, 0xa9, 0x30, 0x46, 0xfe, 0xf7, 0xff, 0x26,
+  0xfd, 0x05, 0xf1, 0x18, 0x01, 0x11, 0xe0, 0xfd, 0x68, 0xcd, 0xe0, 0x39,
+  0xfe, 0x01, 0xa8, 0xfe, 0xf7, 0xff, 0xde, 0xf9, 0x01, 0x21, 0xf0, 0xb2,
+  0xfe, 0xf7, 0xff, 0xdb, 0xf8, 0xfe, 0xf7, 0x16, 0xf9, 0xb0, 0x1c, 0xff,
+  0x28, 0x21, 0x80, 0xb2, 0xfd, 0xf7, 0x3e, 0xfe, 0x7f, 0x29, 0x1d, 0x09,
+  0xf1, 0x04, 0x00, 0x00, 0x0f, 0x20, 0xef, 0x00, 0xeb, 0x47, 0x02, 0xd3,
+  0xd1, 0x6e, 0xf8, 0x04, 0xfb, 0x46, 0x40, 0x13, 0xe0, 0x09, 0xeb, 0x46,
+  0x01, 0xc0, 0xbf, 0x0f, 0x78, 0x54, 0x01, 0x2f, 0x04, 0x55, 0x04, 0x11,
+  0x6b, 0xfd, 0x05, 0x51, 0x02, 0x17, 0x51, 0x02, 0xc2, 0xf9, 0x75, 0x01,
+  0xff, 0xb9, 0xff, 0x14, 0xb9, 0x7f, 0x1c, 0x02, 0x2f, 0xff, 0xb7, 0xd3,
+  0x14, 0xb9, 0x76, 0x1c, 0x02, 0x2e, 0xdf, 0xae, 0xd3, 0x20, 0x46, 0x07,
+  0xc3, 0x31, 0x83, 0xa2, 0xfe, 0xfb, 0xd0, 0x41, 0x01, 0x40, 0x5c, 0x70,
+  0x47, 0x9f, 0x6e, 0x09, 0x00, 0x81, 0x01, 0x01, 0x39, 0x90, 0x00, 0x1d,
+  0xd9, 0xc1, 0xff, 0xfe, 0xf7, 0x5f, 0xfa, 0xfe, 0xf7, 0x77, 0xfa, 0xff,
+  0x02, 0x28, 0x01, 0xd1, 0x03, 0x20, 0x02, 0xbd, 0x7f, 0x01, 0x28, 0x0c,
+  0xbf, 0x04, 0x20, 0x00, 0x09, 0x00, 0xbd, 0xf0, 0xcd, 0x30, 0x0c, 0x46,
+  0x96, 0x48, 0x23, 0xd0, 0x02, 0xdf, 0xd2, 0xe9, 0x00, 0x01, 0x95, 0x39,
+  0x00, 0xc4, 0x06, 0xff, 0xd6, 0xe9, 0x00, 0x23, 0x80, 0x18, 0x59, 0x41,
+  0xfd, 0x2a, 0x5b, 0x40, 0xdb, 0xfc, 0xa0, 0xfb, 0x00, 0x67, 0xff, 0x00,
+  0xfb, 0x01, 0x77, 0x01, 0xfb, 0x00, 0x77, 0xb5, 0x8e, 0x29, 0x06, 0x8c,
+  0x29, 0x01, 0x04, 0xd4, 0x29, 0x01, 0x1a, 0x55, 0x99, 0x29, 0x02, 0xc6,
+  0x29, 0x01, 0x23, 0x29, 0x00, 0x33, 0x29, 0x00, 0xff, 0x33, 0xb0, 0x18,
+  0x47, 0xeb, 0x03, 0x01, 0xf0, 0xfe, 0x63, 0x10, 0xf5, 0x4f, 0x0e, 0x46,
+  0x81, 0xb0, 0xb6, 0xbf, 0xf9, 0x08, 0x10, 0xb6, 0xf9, 0x06, 0xdb, 0xf0,
+  0xd0, 0xff, 0xfc, 0x31, 0x69, 0xf0, 0x68, 0xfe, 0xf7, 0xd4, 0x7f, 0xfc,
+  0x01, 0x98, 0xfe, 0xf7, 0xd5, 0xfc, 0xcb, 0x41, 0xff, 0xd0, 0x46, 0xf0,
+  0x78, 0x00, 0x27, 0xc1, 0x46, 0xff, 0x18, 0xb1, 0xfe, 0xf7, 0x83, 0xfa,
+  0xc3, 0x46, 0xff, 0x04, 0xe0, 0x08, 0x20, 0xfe, 0xf7, 0x71, 0xfa, 0xcf,
+  0x4f, 0xf0, 0x08, 0x0b, 0x35, 0x01, 0x09, 0x61, 0x40, 0x42, 0xfe, 0x43,
+  0x00, 0x40, 0x00, 0x2c, 0x48, 0xbf, 0x64, 0x42, 0xbf, 0x84, 0x42, 0x38,
+  0xbf, 0x04, 0x46, 0x3b, 0x41, 0xb7, 0xdf, 0xfb, 0x11, 0x28, 0x04, 0xd2,
+  0x09, 0x01, 0xb2, 0xfb, 0xff, 0x11, 0x30, 0x00, 0xe0, 0x22, 0x20, 0xb1,
+  0x78, 0xff, 0x08, 0x18, 0x1d, 0x28, 0x26, 0xbf, 0x1c, 0x38, 0xff, 0x00,
+  0x90, 0xcd, 0xf8, 0x00, 0x80, 0x34, 0x78, 0xdb, 0x10, 0xe0, 0xdb, 0x70,
+  0x98, 0x29, 0x41, 0x50, 0x87, 0xff, 0xff, 0x89, 0x45, 0x05, 0xdc, 0x01,
+  0xdb, 0x80, 0x45, 0xff, 0x02, 0xd2, 0x2f, 0x19, 0x80, 0x46, 0x89, 0x46,
+  0xff, 0x6d, 0x1c, 0x03, 0x2d, 0xf0, 0xd3, 0xe4, 0x1c, 0xff, 0x70, 0x78,
+  0x80, 0x1e, 0xa0, 0x42, 0x08, 0xd3, 0xff, 0x01, 0x98, 0x21, 0x04, 0x00,
+  0xf0, 0x43, 0xf8, 0xff, 0xff, 0xf7, 0x63, 0xff, 0x5f, 0xea, 0x00, 0x0a,
+  0xbf, 0xe1, 0xd0, 0x00, 0xf0, 0x36, 0xf8, 0x9d, 0x00, 0x28, 0xff, 0x2b,
+  0xd1, 0x02, 0x99, 0x09, 0x78, 0x01, 0x98, 0xf7, 0x49, 0x1e, 0x09, 0x21,
+  0x00, 0x32, 0xf8, 0x00, 0x24, 0x7f, 0x01, 0xe0, 0x08, 0x2c, 0x1b, 0xd0,
+  0x20, 0xa9, 0x10, 0xdf, 0x1c, 0xfa, 0xff, 0xf7, 0x4b, 0x2f, 0x02, 0x16,
+  0xd1, 0xea, 0x6b, 0x05, 0x51, 0x6b, 0x00, 0x09, 0x6b, 0x02, 0x06, 0xd2,
+  0x02, 0xff, 0x9a, 0x12, 0x78, 0xaa, 0x18, 0x57, 0x1e, 0xa3, 0xfd, 0x46,
+  0x73, 0x05, 0xec, 0xd3, 0x64, 0x1c, 0x10, 0x2c, 0xdf, 0xde, 0xd3, 0x00,
+  0xf0, 0x07, 0x21, 0x20, 0x5f, 0xfc, 0xdf, 0xfe, 0xf7, 0x07, 0xfa, 0x50,
+  0x8d, 0x40, 0xfe, 0x8f, 0xff, 0x02, 0x98, 0x07, 0x70, 0x02, 0x98, 0x80,
+  0xf8, 0xff, 0x01, 0xb0, 0x70, 0x47, 0x01, 0xf4, 0xfe, 0x01, 0xff, 0x41,
+  0xea, 0x80, 0x70, 0xb1, 0x78, 0xc9, 0x05, 0xfd, 0x01, 0xed, 0x50, 0x08,
+  0x43, 0x31, 0x79, 0xc9, 0x03, 0xbf, 0x01, 0xf4, 0x00, 0x41, 0x08, 0x43,
+  0xa5, 0x91, 0x40, 0x7f, 0xf4, 0x80, 0x40, 0xfe, 0xf7, 0xba, 0xb9, 0x8d,
+  0x40, 0xaf, 0x9c, 0x0e, 0x46, 0x15, 0xef, 0x80, 0x22, 0x79, 0x00, 0x45,
+  0xff, 0xff, 0xc8, 0xb9, 0x21, 0x78, 0x71, 0x18, 0x21, 0xff, 0x70, 0xad,
+  0xb1, 0xea, 0x10, 0x05, 0xeb, 0x12, 0xff, 0x72, 0x12, 0x11, 0xc9, 0xb2,
+  0x51, 0x18, 0x63, 0xff, 0x78, 0xa5, 0xeb, 0x02, 0x12, 0xd2, 0x18, 0x12,
+  0xff, 0xb2, 0x00, 0x2a, 0x02, 0xd5, 0x49, 0x1e, 0x10, 0xbf, 0x32, 0x03,
+  0xe0, 0x10, 0x2a, 0xa4, 0xe7, 0xf0, 0x10, 0xff, 0x3a, 0x21, 0x70, 0x62,
+  0x70, 0x70, 0xbd, 0x10, 0xff, 0xb5, 0x00, 0x22, 0x17, 0x4b, 0x44, 0x24,
+  0x00, 0xff, 0xf0, 0x31, 0xf8, 0xdc, 0x63, 0x01, 0x24, 0xa3, 0xff, 0xf8,
+  0x40, 0x40, 0x94, 0x24, 0x13, 0x4b, 0x00, 0xff, 0xf0, 0x29, 0xf8, 0x9c,
+  0x61, 0x01, 0x24, 0x9c, 0xbf, 0x83, 0x58, 0xb1, 0x11, 0x4b, 0x54, 0x1f,
+  0x00, 0x21, 0xff, 0xf8, 0x9c, 0x64, 0x01, 0xeb, 0x82, 0x04, 0xa4, 0xf7,
+  0x68, 0xdc, 0x64, 0x27, 0x01, 0x50, 0x40, 0x52, 0x1c, 0xef, 0x02, 0x2a,
+  0xe0, 0xd3, 0x5b, 0x41, 0x70, 0xb8, 0x00, 0xbf, 0x20, 0x74, 0x29, 0x00,
+  0x20, 0x1c, 0x03, 0x00, 0x60, 0xaf, 0x01, 0x00, 0x45, 0xa8, 0x03, 0x00,
+  0x90, 0x03, 0x00, 0x78, 0xf6, 0x03, 0x00, 0xa0, 0xef, 0x51, 0x40, 0x27,
+  0x00, 0x20, 0x8c, 0xff, 0xed, 0x00, 0x20, 0x04, 0xfb, 0x02, 0x33, 0x51,
+  0xfb, 0xf8, 0x22, 0x57, 0x60, 0x01, 0xb4, 0xbd, 0xf8, 0x02, 0x7f, 0x00,
+  0x5a, 0x28, 0x03, 0xdb, 0xbd, 0xf8, 0xab, 0x30, 0x77, 0x28, 0x01, 0xdb,
+  0xe4, 0x30, 0xe0, 0x01, 0x20, 0x03, 0x11, 0x7d, 0xfe, 0xd5, 0xf2, 0x00,
+  0x26, 0x55, 0xf8, 0x26, 0xce, 0xc0, 0xff, 0xff, 0xf7, 0xe9, 0xff, 0x07,
+  0x46, 0x34, 0xb1, 0x6d, 0x05, 0x41, 0x30, 0x80, 0x68, 0x0f, 0x01, 0xe1,
+  0xff, 0x29, 0x01, 0x9f, 0x17, 0xb1, 0x10, 0xb1, 0x01, 0x33, 0x00, 0xeb,
+  0x60, 0xa9, 0xa7, 0xc0, 0xb2, 0x41, 0x2b, 0x00, 0x1d, 0x31, 0xe4, 0xcf,
+  0x10, 0x00, 0xef, 0x28, 0x1e, 0xbf, 0x02, 0x5b, 0x81, 0x20, 0xc0, 0xb2,
+  0xff, 0xfe, 0xbd, 0x35, 0x49, 0x00, 0x20, 0x08, 0x80, 0xbe, 0xe9, 0x41,
+  0x7f, 0xbb, 0x07, 0xf0, 0x7e, 0x03, 0x00, 0x7d, 0xfc, 0x03, 0x02, 0x2b,
+  0x80, 0x73, 0x42, 0xf8, 0x04, 0x39, 0x10, 0xff, 0x60, 0x10, 0x1f, 0x2d,
+  0x4a, 0x40, 0xf8, 0x04, 0x5f, 0x29, 0x4f, 0xf0, 0x12, 0x32, 0x07, 0x03,
+  0x03, 0x07, 0x04, 0xe5, 0x02, 0x07, 0x04, 0x01, 0x07, 0x02, 0x03, 0x00,
+  0x19, 0x4f, 0xf0, 0xab, 0x11, 0x31, 0x07, 0x03, 0x10, 0x07, 0x04, 0x09,
+  0x07, 0x04, 0x08, 0xaa, 0x07, 0x04, 0x07, 0x07, 0x04, 0x06, 0x07, 0x04,
+  0x05, 0x07, 0x04, 0x04, 0xd7, 0x31, 0x01, 0x60, 0x85, 0x01, 0x41, 0x7d,
+  0x00, 0x46, 0xbb, 0xff, 0x80, 0xb5, 0x07, 0xf0, 0x44, 0xfb, 0x0e, 0x48,
+  0xff, 0x01, 0x88, 0x49, 0x1c, 0x01, 0x80, 0x89, 0xb2, 0x4f, 0x05, 0x29,
+  0x05, 0xd3, 0xfd, 0x90, 0x07, 0x60, 0x01, 0x49, 0x60, 0xff, 0xd1, 0xb9,
+  0x01, 0xbd, 0x80, 0xb5, 0x00, 0xf0, 0xff, 0x13, 0xf8, 0x08, 0x49, 0x0a,
+  0x78, 0x52, 0x1c, 0xff, 0x0a, 0x70, 0x80, 0xf3, 0x11, 0x88, 0xfa, 0xf7,
+  0x7b, 0xdf, 0xf9, 0x1f, 0x01, 0xfa, 0xf7, 0x79, 0xb9, 0x18, 0x10, 0xff,
+  0xf3, 0x00, 0x20, 0xbd, 0x2a, 0x00, 0x01, 0x18, 0xff, 0xbd, 0x00, 0x20,
+  0xef, 0xf3, 0x11, 0x80, 0x60, 0xe3, 0x21, 0x81, 0x23, 0x00, 0xfd, 0x30,
+  0x05, 0x02, 0x1b, 0x48, 0xff, 0xff, 0x21, 0x01, 0x70, 0x00, 0x20, 0x80,
+  0xf3, 0x09, 0xf7, 0x88, 0x19, 0x48, 0x4d, 0xb0, 0x70, 0x18, 0x48, 0x19,
+  0xff, 0x49, 0x01, 0x60, 0x62, 0xb6, 0xfe, 0xe7, 0x16, 0xfb, 0x48, 0x16,
+  0x09, 0x00, 0x70, 0x47, 0x14, 0x48, 0x14, 0xfe, 0x07, 0x02, 0x72, 0xb6,
+  0xef, 0xf3, 0x09, 0x80, 0x28, 0xff, 0xb1, 0x20, 0x38, 0x80, 0xe8, 0xf0,
+  0x0f, 0x10, 0xff, 0x49, 0x09, 0x68, 0x08, 0x60, 0x00, 0xb5, 0x0f, 0xff,
+  0x48, 0x80, 0x47, 0x5d, 0xf8, 0x04, 0xeb, 0x0e, 0xfb, 0x48, 0x0f, 0x83,
+  0x00, 0x02, 0x70, 0x0a, 0x48, 0x0e, 0xff, 0x49, 0x0a, 0x68, 0x02, 0x60,
+  0x10, 0x68, 0x90, 0xf6, 0x25, 0x00, 0x20, 0x30, 0x59, 0x01, 0x4e, 0xf0,
+  0x04, 0x0e, 0xff, 0x62, 0xb6, 0x70, 0x47, 0x22, 0xed, 0x00, 0xe0, 0x55,
+  0x1d, 0x87, 0x00, 0x04, 0x07, 0x00, 0x00, 0xce, 0x10, 0x38, 0x0b, 0x00,
+  0x5f, 0xdf, 0x79, 0x00, 0x01, 0x1a, 0x07, 0x00, 0x1b, 0x03, 0x00, 0xfd,
+  0x40, 0x03, 0x00, 0x00, 0x22, 0x07, 0xf0, 0xcd, 0xba, 0xff, 0x00, 0x00,
+  0x62, 0xf3, 0x0f, 0x22, 0x62, 0xf3, 0xff, 0x1f, 0x42, 0x40, 0x18, 0x10,
+  0xf0, 0x03, 0x03, 0xff, 0x08, 0xd0, 0xc9, 0x1a, 0x1f, 0xd3, 0xdb, 0x07,
+  0xfe, 0xf7, 0x90, 0xf8, 0x01, 0x2d, 0x28, 0xbf, 0x20, 0xf8, 0x7f, 0x02,
+  0x2d, 0x13, 0x00, 0x30, 0xb4, 0x14, 0xdb, 0x20, 0xfb, 0x10, 0x39, 0x0f,
+  0x00, 0xe9, 0x3c, 0x00, 0xfa, 0xd8, 0xdb, 0x49, 0x07, 0x09, 0x01, 0x0c,
+  0x00, 0x13, 0x40, 0xf8, 0x04, 0xe7, 0x2d, 0x89, 0x00, 0x27, 0x03, 0x33,
+  0x03, 0x30, 0xbc, 0x70, 0x2f, 0x47, 0xc9, 0x18, 0x18, 0x0b, 0x02, 0xcb,
+  0x27, 0x00, 0x07, 0x01, 0xfa, 0xb7, 0x81, 0x58, 0x45, 0x20, 0x03, 0x2c,
+  0x16, 0xda, 0x04, 0xff, 0xf0, 0xe2, 0xfe, 0xbb, 0x4a, 0xbc, 0x4e, 0x12,
+  0xff, 0x68, 0x09, 0x07, 0x41, 0xea, 0x10, 0x11, 0x00, 0xb7, 0x07, 0x00,
+  0x23, 0x17, 0xa0, 0xfc, 0x06, 0xd7, 0x40, 0xc2, 0x7e, 0xd7, 0x40, 0x20,
+  0x46, 0x04, 0xf0, 0xd1, 0xfe, 0x0d, 0x03, 0xff, 0x06, 0x01, 0x51, 0xbd,
+  0x7c, 0xb5, 0xb2, 0x49, 0xef, 0x0f, 0xf2, 0x28, 0x34, 0xf9, 0x30, 0xf0,
+  0x03, 0x02, 0xff, 0x89, 0x08, 0x01, 0xf0, 0x01, 0x03, 0x60, 0xcc, 0xff,
+  0x69, 0x46, 0x01, 0x2a, 0x60, 0xc1, 0x4f, 0xf4, 0xfb, 0x7a, 0x71, 0x03,
+  0xe0, 0x01, 0x04, 0xd1, 0x1b, 0xb1, 0xff, 0x49, 0x00, 0x41, 0xea, 0xd0,
+  0x71, 0x40, 0x00, 0xff, 0x6c, 0x46, 0x04, 0xeb, 0x83, 0x03, 0xd2, 0x5c,
+  0xf1, 0x02, 0x93, 0x50, 0x59, 0x80, 0x5b, 0x00, 0x4a, 0xbc, 0xa2, 0x49,
+  0xff, 0x09, 0x78, 0x49, 0x07, 0x46, 0xbf, 0x05, 0x21, 0x3f, 0xb0, 0xfb,
+  0xf1, 0xf0, 0x80, 0x08, 0xa1, 0x50, 0x11, 0x00, 0xef, 0xc9, 0x07, 0x9e,
+  0x49, 0xc1, 0x00, 0x08, 0x09, 0x78, 0xdf, 0xc1, 0xf3, 0x41, 0x01, 0xc8,
+  0x05, 0x30, 0x10, 0xb5, 0xff, 0x95, 0x48, 0x95, 0x4c, 0x40, 0x68, 0xff,
+  0xf7, 0x6f, 0xc4, 0xff, 0x20, 0x63, 0x3b, 0xa0, 0xff, 0x60, 0x05, 0x00,
+  0xbf, 0xe9, 0xff, 0xa0, 0x63, 0x95, 0x49, 0x39, 0x01, 0x40, 0xb7, 0x1c,
+  0xe0, 0x63, 0x73, 0x01, 0xa0, 0x6b, 0x0d, 0x01, 0x20, 0xff, 0x64, 0x10,
+  0xbd, 0x4b, 0x01, 0x19, 0x18, 0x8f, 0xff, 0x48, 0x20, 0x22, 0x18, 0x18,
+  0x02, 0xf0, 0x10, 0xff, 0xb8, 0xf8, 0xb5, 0x8d, 0x4d, 0x8d, 0x4a, 0x29,
+  0xf7, 0x68, 0x51, 0x18, 0x5f, 0x30, 0x4a, 0x91, 0x42, 0x0c, 0xff, 0xd2,
+  0x69, 0x68, 0x8b, 0x4a, 0x51, 0x18, 0x8b, 0xfe, 0x0b, 0x00, 0x06, 0xd2,
+  0x29, 0x7a, 0x04, 0x29, 0x03, 0xff, 0xda, 0x69, 0x89, 0xb1, 0xf5, 0x00,
+  0x7f, 0x00, 0xff, 0xd3, 0x01, 0x20, 0xae, 0x7a, 0x86, 0x49, 0x87, 0xff,
+  0x4a, 0x87, 0x4b, 0x88, 0x4c, 0x03, 0x27, 0x3e, 0xff, 0x42, 0x0c, 0xd0,
+  0x2e, 0x7c, 0x03, 0x2e, 0x07, 0xff, 0xda, 0x6e, 0x69, 0xa6, 0x19, 0x9e,
+  0x42, 0x03, 0xff, 0xd2, 0x6e, 0x6a, 0x00, 0xf0, 0x69, 0xf8, 0x02, 0xf7,
+  0xe0, 0x01, 0x26, 0xc3, 0x10, 0x26, 0x30, 0x43, 0xae, 0x7b, 0x7a, 0x0c,
+  0x25, 0x00, 0x09, 0xd0, 0xee, 0x6a, 0x1f, 0x03, 0xd3, 0xae, 0x6b, 0xb7,
+  0x91, 0x1f, 0x09, 0x30, 0x1f, 0x00, 0x0b, 0xd0, 0xfb, 0x2e, 0x6c, 0x1f,
+  0x01, 0x05, 0xd2, 0xee, 0x6c, 0x73, 0x7f, 0x4f, 0xbe, 0x42, 0xb6, 0x41,
+  0xf6, 0x0f, 0x23, 0x07, 0xbf, 0x6e, 0x89, 0x4f, 0xf4, 0xe0, 0x77, 0x6b,
+  0x01, 0x6e, 0xef, 0x6d, 0xa4, 0x19, 0x9c, 0x93, 0x00, 0x2b, 0x6e, 0xd2,
+  0xff, 0x18, 0x8a, 0x42, 0x89, 0x41, 0xc9, 0x43, 0xc9, 0xfc, 0x27, 0x01,
+  0x85, 0x90, 0x00, 0x21, 0x51, 0xea, 0x00, 0x04, 0xb7, 0x06, 0xd0, 0x04,
+  0xa9, 0x70, 0x00, 0x21, 0xa5, 0x60, 0xf0, 0xff, 0xe4, 0xf9, 0x22, 0xe0,
+  0x4f, 0x4e, 0x64, 0x22, 0xff, 0x29, 0x46, 0x30, 0x46, 0x01, 0xf0, 0x9d,
+  0xff, 0xaf, 0x70, 0x89, 0xc0, 0xf3, 0xd3, 0x90, 0xb1, 0x85, 0x70, 0xf0,
+  0x9b, 0x1e, 0xf8, 0x0d, 0x01, 0x01, 0x10, 0xfb, 0x30, 0x0d, 0x00, 0x17,
+  0xea, 0x0d, 0x02, 0x82, 0x0d, 0x00, 0x02, 0x0d, 0x00, 0x10, 0xf8, 0xb0,
+  0xff, 0x7a, 0x03, 0x21, 0x08, 0x42, 0x1c, 0xbf, 0x05, 0xff, 0xf1, 0x64,
+  0x00, 0xff, 0xf7, 0x69, 0xff, 0x20, 0xbf, 0x46, 0xf2, 0xbd, 0x96, 0x19,
+  0x8e, 0x95, 0x01, 0x43, 0x6f, 0xf6, 0x0f, 0x70, 0x47, 0x17, 0x01, 0x5d,
+  0xe7, 0x59, 0x31, 0xf7, 0x43, 0xf8, 0x0e, 0xe7, 0x50, 0x35, 0xf8, 0x00,
+  0x21, 0xf7, 0x40, 0xf2, 0x09, 0x65, 0x70, 0x54, 0xf9, 0x00, 0xf0, 0x5f,
+  0x33, 0xf8, 0x00, 0x22, 0x03, 0x0f, 0x00, 0x0a, 0x0f, 0x00, 0xf7, 0x56,
+  0xf9, 0xf8, 0x89, 0x00, 0x35, 0xf8, 0xbd, 0xe8, 0xf7, 0x02, 0x40, 0x0e,
+  0x09, 0x00, 0xa5, 0xb8, 0x80, 0xb5, 0xff, 0x05, 0x21, 0x4f, 0xf4, 0xd8,
+  0x70, 0xfb, 0xf7, 0x57, 0x3e, 0xf9, 0x00, 0x09, 0x00, 0x82, 0x09, 0x00,
+  0x39, 0x35, 0x00, 0x5f, 0x1e, 0xf8, 0x10, 0xd0, 0xff, 0x45, 0x04, 0x31,
+  0x0f, 0x00, 0xfb, 0x0b, 0xf8, 0x89, 0x91, 0xbd, 0xe8, 0x08, 0x40, 0x03,
+  0xf2, 0x4d, 0x06, 0x2f, 0xcf, 0x30, 0x23, 0x00, 0xf6, 0x89, 0x50, 0xfb,
+  0xb7, 0xf7, 0x1f, 0xb9, 0x17, 0x02, 0xf6, 0x8a, 0x0b, 0x00, 0x23, 0xcf,
+  0xb9, 0x15, 0x48, 0x80, 0xb3, 0x02, 0x11, 0x50, 0x07, 0x0a, 0x5f, 0xd5,
+  0x11, 0x49, 0x49, 0x89, 0x75, 0x23, 0x89, 0x05, 0x60, 0xff, 0x02, 0x11,
+  0x41, 0xf0, 0x0f, 0x01, 0x08, 0x40, 0xbc, 0xd7, 0xc0, 0x77, 0x02, 0x02,
+  0xb9, 0x00, 0x28, 0x1b, 0xf0, 0x22, 0xf7, 0x00, 0x22, 0x02, 0x89, 0x04,
+  0x03, 0xb9, 0x38, 0xb9, 0x13, 0x16, 0x49, 0x69, 0xd1, 0xb1, 0x30, 0xbf,
+  0x01, 0x03, 0xfb, 0x21, 0x8b, 0x51, 0x7d, 0xf8, 0xd3, 0xb0, 0x19, 0x01,
+  0x00, 0x46, 0x02, 0x03, 0x00, 0xfd, 0x18, 0x03, 0x00, 0x08, 0x0d, 0x00,
+  0x46, 0x40, 0x42, 0xeb, 0x0f, 0x00, 0xe4, 0x90, 0x20, 0xa3, 0x30, 0x20,
+  0xc0, 0x87, 0xff, 0x82, 0xfe, 0xc1, 0x57, 0x95, 0x11, 0x20, 0xf9, 0xff,
+  0xa5, 0xff, 0x21, 0x79, 0x61, 0x00, 0x81, 0x77, 0xff, 0x8e, 0x06, 0x00,
+  0xd3, 0xce, 0xfe, 0x01, 0x70, 0xff, 0x28, 0x12, 0x00, 0xa0, 0x15, 0xff,
+  0x00, 0x2d, 0xcb, 0x31, 0x01, 0xcf, 0x31, 0x10, 0x47, 0x30, 0xb3, 0x61,
+  0x01, 0x21, 0xff, 0x81, 0x40, 0x49, 0x1e, 0x21, 0x42, 0x18, 0xbf, 0xff,
+  0x40, 0x1c, 0x10, 0xbd, 0xb0, 0xfa, 0x80, 0xf0, 0xff, 0xc0, 0xf1, 0x1f,
+  0x00, 0x70, 0x47, 0x04, 0x06, 0xbf, 0x08, 0x0c, 0x05, 0x0f, 0x0a, 0x0f,
+  0x8f, 0x11, 0x1f, 0xce, 0x3b, 0xc0, 0x11, 0x4a, 0x04, 0xd7, 0x11, 0x0b,
+  0x02, 0x0f, 0x4a, 0x3f, 0x40, 0x09, 0x42, 0xf8, 0x20, 0x10, 0xdd, 0x00,
+  0x11, 0x04, 0xef, 0x0c, 0x4a, 0xf5, 0xe7, 0x0b, 0x05, 0x0a, 0x4a, 0xef,
+  0xff, 0xe7, 0x09, 0x01, 0x00, 0x28, 0x06, 0xd5, 0x08, 0xff, 0x4a, 0x00,
+  0xf0, 0x0f, 0x00, 0x80, 0x18, 0x00, 0xff, 0xf8, 0x04, 0x1c, 0x70, 0x47,
+  0x06, 0x4a, 0x81, 0xf5, 0x54, 0xc7, 0x40, 0xe2, 0x1b, 0x20, 0xe1, 0x00,
+  0xe0, 0x80, 0xea, 0x03, 0x00, 0x00, 0x0b, 0x00, 0x18, 0x5b, 0x41, 0xe4,
+  0x00, 0xe0, 0xbf, 0x42, 0x48, 0x00, 0xf1, 0x08, 0x01, 0xd1, 0xc0, 0x21,
+  0xff, 0xc1, 0x80, 0x04, 0x21, 0x81, 0x80, 0x00, 0x21, 0xf7, 0x3f, 0x48,
+  0x81, 0x29, 0xe0, 0x7f, 0x41, 0x01, 0x60, 0xa7, 0x15, 0x21, 0x81, 0xcf,
+  0x40, 0x0d, 0x59, 0x37, 0xb3, 0x40, 0x10, 0xff, 0x60, 0x01, 0xf5, 0x80,
+  0x50, 0x00, 0x1d, 0x82, 0xff, 0x42, 0x2c, 0xbf, 0x01, 0xf1, 0x08, 0x00,
+  0x10, 0xff, 0x1d, 0x08, 0x60, 0xc8, 0x88, 0xb0, 0xf5, 0x80, 0x2b, 0x6f,
+  0xbc, 0xcb, 0x00, 0xc8, 0x1b, 0x60, 0x38, 0xe3, 0x00, 0x7d, 0x31, 0x5d,
+  0x05, 0xe9, 0x00, 0x11, 0xf8, 0x85, 0x39, 0x00, 0x31, 0x1b, 0xc0, 0xbe,
+  0x85, 0x61, 0xff, 0xf7, 0xd8, 0xff, 0x06, 0x15, 0x00, 0x06, 0xeb, 0xf8,
+  0x28, 0x0b, 0x02, 0x86, 0x55, 0x01, 0xbd, 0x23, 0x48, 0x7f, 0x01, 0x68,
+  0x00, 0x22, 0x42, 0x60, 0x15, 0x03, 0x00, 0xff, 0x44, 0xea, 0xc1, 0x10,
+  0xcb, 0xe7, 0x10, 0xb5, 0xff, 0x1f, 0x4a, 0x04, 0x46, 0xd2, 0xe9, 0x02,
+  0x01, 0xfd, 0x22, 0x55, 0xa0, 0x33, 0xfa, 0xc0, 0x07, 0x04, 0xd5, 0xfd,
+  0x44, 0x97, 0x10, 0xbd, 0xe8, 0x10, 0x40, 0xcf, 0xe7, 0xf7, 0x10, 0xbd,
+  0x38, 0x73, 0x20, 0x1f, 0xf8, 0xc0, 0x07, 0xff, 0x08, 0xd5, 0x05, 0xf0,
+  0x01, 0x00, 0x44, 0xea, 0xbf, 0x80, 0x10, 0xbd, 0xe8, 0x32, 0x40, 0xd1,
+  0x71, 0xc0, 0xeb, 0xe7, 0x31, 0x1d, 0x02, 0x10, 0x1d, 0x00, 0x0c, 0xd5,
+  0x68, 0xff, 0x0e, 0x00, 0xf0, 0x40, 0x00, 0x04, 0xf0, 0x3f, 0xdf, 0x02,
+  0x69, 0x00, 0x10, 0x43, 0x19, 0xd1, 0x49, 0x08, 0xaa, 0x25, 0x01, 0xb7,
+  0x25, 0x00, 0x07, 0x61, 0x00, 0x0d, 0x63, 0x06, 0x01, 0x76, 0x4b, 0x50,
+  0xb8, 0x82, 0xcb, 0x11, 0x30, 0x59, 0x04, 0x03, 0x00, 0xb1, 0x88, 0xd7,
+  0x10, 0xab, 0x15, 0x21, 0xa0, 0xf0, 0x3d, 0x83, 0x20, 0x10, 0xff, 0x40,
+  0x07, 0xf0, 0x2d, 0xb8, 0x10, 0xb5, 0x30, 0xe1, 0x48, 0x3b, 0x30, 0x5f,
+  0x31, 0x05, 0xb2, 0xf3, 0x70, 0xf0, 0x05, 0xf8, 0xff, 0x23, 0xea, 0x00,
+  0x00, 0x42, 0xf8, 0x21, 0x00, 0xff, 0x10, 0xbd, 0x29, 0x4a, 0x01, 0x09,
+  0x52, 0xf8, 0xef, 0x21, 0x30, 0x01, 0x24, 0x79, 0x00, 0xfa, 0x00, 0xf0,
+  0xff, 0x70, 0x47, 0x30, 0xb5, 0x02, 0x09, 0x23, 0x4b, 0xfd, 0x53, 0xa9,
+  0x70, 0x40, 0x00, 0x40, 0x1c, 0x07, 0x25, 0xdf, 0x85, 0x40, 0xac, 0x43,
+  0x43, 0x0d, 0x00, 0x01, 0xf0, 0xab, 0x07, 0x01, 0x15, 0x01, 0x01, 0x25,
+  0x00, 0x20, 0x11, 0x01, 0x00, 0xdf, 0x30, 0xbd, 0x19, 0x4a, 0x03, 0x3d,
+  0x00, 0x23, 0x20, 0xff, 0x43, 0x00, 0x5b, 0x1c, 0xda, 0x40, 0x02, 0xf0,
+  0x77, 0x07, 0x02, 0x8a, 0xab, 0x90, 0xff, 0xf7, 0xdd, 0x89, 0x20, 0xff,
+  0xf0, 0xb5, 0xef, 0xf3, 0x10, 0x84, 0x72, 0xb6, 0xff, 0x11, 0x4d, 0xd5,
+  0xe9, 0x00, 0x67, 0x26, 0xea, 0xff, 0x02, 0x02, 0x27, 0xea, 0x03, 0x03,
+  0x10, 0x43, 0xf7, 0x19, 0x43, 0xc5, 0x79, 0x50, 0x84, 0xf3, 0x10, 0x88,
+  0xe7, 0xf0, 0xbd, 0xd0, 0xb3, 0x00, 0x25, 0x00, 0x80, 0x72, 0xb6, 0x97,
+  0x08, 0x49, 0xd1, 0x25, 0x00, 0x80, 0x15, 0x00, 0x29, 0x00, 0x00, 0x5c,
+  0x29, 0x00, 0xe7, 0x00, 0xbd, 0xe8, 0xd0, 0x0f, 0x70, 0x8b, 0xef, 0x60,
+  0xdf, 0x08, 0x00, 0x00, 0x49, 0x10, 0x03, 0x00, 0x3c, 0x48, 0xff, 0x01,
+  0x74, 0xc9, 0xb2, 0x03, 0x29, 0x9c, 0xbf, 0xbf, 0x00, 0x20, 0xff, 0xf7,
+  0x7f, 0xbe, 0xad, 0x01, 0x37, 0xff, 0x4d, 0x85, 0xb0, 0x04, 0x46, 0x55,
+  0xf8, 0x24, 0xff, 0x10, 0xa1, 0xb9, 0x03, 0xa9, 0x02, 0x91, 0x00, 0xff,
+  0x90, 0x00, 0x21, 0x33, 0x48, 0x34, 0x4b, 0x01, 0xef, 0x91, 0x01, 0x22,
+  0x50, 0xa1, 0xd0, 0xfa, 0xf7, 0xfa, 0xfb, 0xfc, 0x45, 0x07, 0x00, 0x9d,
+  0xf8, 0x0c, 0x10, 0x48, 0xfe, 0x79, 0xb0, 0xc0, 0x0f, 0xff, 0xf7, 0x62,
+  0xfe, 0x05, 0xdb, 0xb0, 0x30, 0x79, 0x10, 0x28, 0x4d, 0x39, 0x02, 0x00,
+  0x20, 0xff, 0xb1, 0x69, 0x46, 0xfa, 0xf7, 0x24, 0xfd, 0x00, 0x9f, 0xf0,
+  0x1b, 0xf8, 0x00, 0x20, 0x2d, 0x01, 0x97, 0x13, 0x3b, 0x5f, 0xf8, 0x11,
+  0xd1, 0x1f, 0x4d, 0x21, 0x01, 0x68, 0x21, 0x02, 0xff, 0x6f, 0xfd, 0x01,
+  0x28, 0x08, 0xd1, 0x00, 0xf0, 0xd3, 0x08, 0xf8, 0x13, 0x01, 0x11, 0x01,
+  0x86, 0x33, 0x00, 0x01, 0xf8, 0xdf, 0x31, 0xbd, 0x9d, 0xf8, 0x00, 0x5d,
+  0x06, 0x33, 0xbe, 0xbe, 0x3b, 0x01, 0x1d, 0xf8, 0x1a, 0xd1, 0x10, 0x3b,
+  0x02, 0xb0, 0xfe, 0x3b, 0x02, 0x51, 0xfd, 0x03, 0x28, 0x11, 0xd1, 0xff,
+  0x37, 0xf7, 0xea, 0xff, 0x3b, 0x05, 0x12, 0xfd, 0x77, 0x21, 0x0d, 0x01,
+  0xbb, 0x6b, 0x46, 0x95, 0xe1, 0xfa, 0xf7, 0x8b, 0x11, 0x00, 0xda, 0xf7,
+  0xff, 0x31, 0xbd, 0xbd, 0x60, 0x48, 0x00, 0x7c, 0x01, 0xcd, 0x28, 0xcf,
+  0x31, 0x08, 0x1f, 0x5b, 0x90, 0x03, 0x00, 0x21, 0x81, 0xfc, 0xe7, 0xd0,
+  0x27, 0x92, 0x38, 0xb5, 0xff, 0xf7, 0xee, 0xff, 0xbd, 0x0b, 0x7b, 0xa1,
+  0x2c, 0xe8, 0xb2, 0x02, 0x53, 0x00, 0x7c, 0xef, 0xff, 0x01, 0xe0, 0xff,
+  0xa3, 0xc0, 0x6d, 0x1c, 0x04, 0x5f, 0x2d, 0xf4, 0xd3, 0x31, 0xbd, 0x05,
+  0x39, 0x30, 0x8b, 0x00, 0xbf, 0x11, 0xf8, 0x23, 0x43, 0x13, 0x60, 0x23,
+  0xc1, 0x01, 0xdf, 0x22, 0x42, 0x70, 0x30, 0xbd, 0x13, 0x01, 0x07, 0xf8,
+  0xf1, 0xa3, 0x13, 0x04, 0xcd, 0x20, 0x13, 0x00, 0xdf, 0xf8, 0xb0, 0x2c,
+  0xff, 0xdf, 0xf8, 0xd4, 0x1d, 0x13, 0x68, 0x11, 0xf9, 0xdf, 0x10, 0x50,
+  0x01, 0x24, 0xac, 0xa3, 0x60, 0xdf, 0xf8, 0xef, 0xa0, 0x0c, 0xc0, 0x6c,
+  0x07, 0x01, 0x9c, 0x1c, 0xdf, 0x7f, 0xf8, 0x94, 0x0c, 0x89, 0x6b, 0xc0,
+  0x6c, 0x07, 0x00, 0xfd, 0x2c, 0x8b, 0xd1, 0x48, 0x43, 0xdf, 0xf8, 0x68,
+  0x1d, 0xfd, 0x48, 0x73, 0x30, 0x80, 0xb5, 0xdf, 0xf8, 0x3c, 0x0d, 0xff,
+  0x00, 0x21, 0x41, 0x71, 0x84, 0x30, 0xfb, 0xf7, 0xdf, 0xc3, 0xf9, 0x06,
+  0xf0, 0xcc, 0xab, 0x82, 0x06, 0xf0, 0xff, 0xfc, 0xb8, 0xdf, 0xf8, 0xc8,
+  0x1d, 0x02, 0x20, 0xfd, 0x08, 0x25, 0x00, 0xdf, 0xf8, 0x18, 0x0d, 0x41,
+  0x79, 0x3f, 0xd0, 0xf8, 0x80, 0x00, 0x00, 0x29, 0x47, 0x40, 0xd7, 0x20,
+  0xfe, 0x13, 0x01, 0x04, 0x0d, 0x01, 0x79, 0x00, 0x29, 0x0e, 0x5c, 0xcf,
+  0x10, 0x19, 0x01, 0xc0, 0xf3, 0x02, 0x2f, 0x40, 0x10, 0x4f, 0x00, 0xff,
+  0x28, 0x4c, 0xa1, 0x7c, 0x4f, 0xf4, 0x17, 0x60, 0xbf, 0xfa, 0xf7, 0x85,
+  0xfe, 0xe1, 0x7c, 0xcd, 0x21, 0x40, 0xbf, 0xf6, 0x71, 0x10, 0xfa, 0xf7,
+  0x7e, 0x67, 0xf1, 0x47, 0xb7, 0x06, 0x21, 0x31, 0xff, 0x10, 0xdf, 0xfd,
+  0x05, 0x01, 0xc1, 0xfa, 0x05, 0x02, 0xc4, 0x39, 0x10, 0xac, 0xff, 0xdf,
+  0xf8, 0xb4, 0x9f, 0x4c, 0xdf, 0xf8, 0xd0, 0x5c, 0x03, 0x00, 0xaf, 0x00,
+  0xe4, 0xed, 0x9b, 0x91, 0xa0, 0x71, 0x68, 0xd1, 0x80, 0x06, 0x21, 0x10,
+  0xbe, 0x23, 0x00, 0xc7, 0xfd, 0x02, 0x21, 0x0c, 0x07, 0x00, 0xc3, 0xaa,
+  0x07, 0x00, 0x0a, 0x07, 0x00, 0xbf, 0x07, 0x00, 0x1d, 0x07, 0x00, 0xbb,
+  0xaa, 0x07, 0x00, 0x0d, 0x07, 0x00, 0xb7, 0x07, 0x00, 0x0b, 0x07, 0x00,
+  0xb3, 0xaa, 0x07, 0x00, 0x1e, 0x07, 0x00, 0xaf, 0x07, 0x00, 0x1f, 0x07,
+  0x00, 0xab, 0xbf, 0xfd, 0xdf, 0xf8, 0xc4, 0x0d, 0x40, 0x89, 0x61, 0x01,
+  0x3f, 0x89, 0xf8, 0x04, 0x10, 0x01, 0x23, 0x41, 0xe0, 0x09, 0x00, 0xff,
+  0x05, 0x10, 0x00, 0x21, 0x03, 0xfa, 0x01, 0xf8, 0xff, 0x08, 0xea, 0x00,
+  0x06, 0x0f, 0x1d, 0x8a, 0x1c, 0xff, 0x16, 0xf0, 0x03, 0x0f, 0x03, 0xfa,
+  0x07, 0xf7, 0xef, 0x03, 0xfa, 0x02, 0xf2, 0x17, 0x00, 0xfe, 0x0d, 0xd1,
+  0xff, 0x2e, 0x78, 0x42, 0xea, 0x0e, 0x0a, 0x47, 0xea, 0xff, 0x0a, 0x0a,
+  0x4a, 0xea, 0x06, 0x06, 0x2e, 0x70, 0xee, 0x33, 0x90, 0x0a, 0x6e, 0x78,
+  0x0b, 0x01, 0x6e, 0x70, 0x08, 0xbf, 0xea, 0x90, 0x0a, 0x8e, 0x1d, 0x1a,
+  0x33, 0x02, 0x06, 0xf7, 0xf6, 0x0b, 0xd1, 0x29, 0x00, 0x02, 0x94, 0xf8,
+  0x06, 0xdf, 0xa0, 0x17, 0x43, 0x37, 0x43, 0x31, 0x00, 0x07, 0xa7, 0xbf,
+  0x71, 0x4a, 0x19, 0x7f, 0x27, 0x97, 0x27, 0x00, 0x10, 0xfb, 0x17, 0x17,
+  0x25, 0x00, 0x02, 0xd1, 0xe7, 0x79, 0x37, 0xff, 0x43, 0xe7, 0x71, 0x49,
+  0x1c, 0x02, 0x29, 0xc3, 0xfd, 0xdb, 0xf9, 0x61, 0x20, 0xb9, 0xe0, 0x79,
+  0x40, 0xf0, 0x7e, 0x06, 0xd0, 0x71, 0x15, 0xe0, 0x80, 0x22, 0x80, 0x17,
+  0x60, 0x7d, 0x02, 0x2f, 0x10, 0xf7, 0xfd, 0xc0, 0x22, 0xc0, 0x63, 0x60,
+  0xdd, 0x1f, 0xf9, 0x20, 0xf1, 0xfd, 0x3f, 0x09, 0x00, 0x8c, 0x50, 0xdf,
+  0xfa, 0xf7, 0xe2, 0xfd, 0x03, 0x1f, 0x00, 0x03, 0x70, 0x57, 0xfa, 0xf7,
+  0xdd, 0x1f, 0x04, 0x14, 0x1f, 0x00, 0xe1, 0x0b, 0x04, 0x55, 0x12, 0x0b,
+  0x00, 0xdb, 0x0b, 0x04, 0x13, 0x0b, 0x00, 0xd5, 0x0b, 0x03, 0xab, 0xf2,
+  0x42, 0x39, 0x00, 0xcf, 0x0b, 0x04, 0x43, 0x0b, 0x00, 0xc9, 0xeb, 0xfd,
+  0x00, 0x0b, 0x02, 0xe4, 0x67, 0x00, 0xc3, 0xfd, 0x99, 0xef, 0xf8, 0x04,
+  0x00, 0x99, 0x05, 0x10, 0x40, 0xea, 0x81, 0xbb, 0x00, 0xc4, 0xbd, 0x10,
+  0x06, 0xf0, 0x0d, 0x77, 0x40, 0xf0, 0xff, 0x47, 0x05, 0xf0, 0x4d, 0xbe,
+  0x80, 0xb5, 0x4f, 0xf7, 0xf0, 0x92, 0x41, 0x7d, 0xb0, 0x60, 0x04, 0x21,
+  0x01, 0xb6, 0x43, 0x10, 0x09, 0xfd, 0x05, 0x01, 0xf1, 0xfc, 0x87, 0xe1,
+  0xf8, 0x6d, 0xb5, 0x7d, 0x11, 0xe5, 0xfc, 0x7b, 0x11, 0xe2, 0xfc, 0x91,
+  0x11, 0x3f, 0xdf, 0xfc, 0xdf, 0xf8, 0x78, 0x3c, 0x03, 0x00, 0xb9, 0x10,
+  0xff, 0x30, 0x2a, 0xdf, 0xf8, 0xf0, 0x4a, 0x00, 0x20, 0xff, 0x98, 0x60,
+  0x18, 0x60, 0x28, 0x60, 0x4f, 0xf4, 0xff, 0x00, 0x21, 0x90, 0x78, 0x70,
+  0xb9, 0x00, 0xf0, 0xff, 0xfd, 0xf9, 0x10, 0x79, 0xc2, 0x07, 0x4c, 0xbf,
+  0xfd, 0x80, 0x03, 0x70, 0xa2, 0x65, 0x80, 0x07, 0x58, 0xbf, 0xff, 0x00,
+  0x21, 0x21, 0x66, 0x03, 0x20, 0x20, 0x72, 0xff, 0x45, 0xe0, 0x03, 0xf1,
+  0x40, 0x00, 0x60, 0x62, 0x7f, 0x03, 0xf1, 0x3c, 0x00, 0xa0, 0x62, 0x05,
+  0x0b, 0x00, 0xf7, 0x20, 0x63, 0x05, 0x0b, 0x00, 0x60, 0x63, 0x80, 0x20,
+  0xff, 0xd8, 0x63, 0xe9, 0x63, 0x98, 0x6c, 0x40, 0xf0, 0xdf, 0x80, 0x00,
+  0x98, 0x64, 0xd8, 0x07, 0x02, 0xd8, 0x64, 0xff, 0xa8, 0x6c, 0x40, 0xf4,
+  0x00, 0x20, 0xa8, 0x64, 0xfd, 0xe8, 0x07, 0x02, 0xe8, 0x64, 0xdf, 0xf8,
+  0xe8, 0x0b, 0xff, 0x46, 0x89, 0xc6, 0xf3, 0x81, 0x07, 0x03, 0x2f, 0xff,
+  0x04, 0xbf, 0x12, 0x78, 0x00, 0x2a, 0x40, 0xf2, 0xff, 0x05, 0x10, 0x05,
+  0xd1, 0x80, 0x21, 0x99, 0x60, 0xff, 0x08, 0x22, 0x04, 0x21, 0x21, 0x72,
+  0x11, 0xe0, 0xff, 0x00, 0x22, 0x22, 0x72, 0xc6, 0xf3, 0x80, 0x02, 0x7f,
+  0x1a, 0xb1, 0x80, 0x22, 0x1a, 0x60, 0x01, 0x0d, 0x00, 0xf7, 0xb2, 0x08,
+  0x92, 0xe7, 0x50, 0x29, 0x60, 0x21, 0x7a, 0xff, 0x41, 0xf0, 0x02, 0x01,
+  0x21, 0x72, 0x00, 0x22, 0xf5, 0x08, 0xc1, 0x30, 0x38, 0x0f, 0x40, 0xc3,
+  0xf9, 0x05, 0xf0, 0x77, 0xcd, 0xff, 0xd4, 0x11, 0x10, 0x80, 0x08, 0x80,
+  0x19, 0x12, 0xfa, 0xef, 0x01, 0x82, 0xef, 0x02, 0x7f, 0xfc, 0xbd, 0xe8,
+  0xf2, 0xbd, 0x40, 0xf3, 0x01, 0x7a, 0xbc, 0xf8, 0xb5, 0x75, 0x21, 0x61,
+  0xad, 0xfc, 0x73, 0x21, 0x5e, 0xfc, 0x71, 0x21, 0x5b, 0x07, 0x10, 0xf8,
+  0xf5, 0x5b, 0x03, 0x00, 0x6b, 0x01, 0x30, 0x39, 0xdf, 0xf8, 0xdc, 0xd4,
+  0xc5, 0x21, 0xc3, 0xc0, 0xa8, 0x09, 0x10, 0x30, 0x0b, 0x10, 0x80, 0x12,
+  0x7d, 0x98, 0x0b, 0x12, 0x6a, 0xf9, 0x58, 0x79, 0xc3, 0x0b, 0x10, 0xbf,
+  0x40, 0x23, 0x00, 0x23, 0xa3, 0x64, 0x0b, 0x12, 0x22, 0xff, 0x22, 0x65,
+  0x03, 0x20, 0x08, 0x70, 0x43, 0xe0, 0xfe, 0xf9, 0x01, 0xe0, 0x60, 0x05,
+  0xf1, 0x38, 0x00, 0x20, 0xf3, 0x61, 0x06, 0x11, 0x11, 0x05, 0x00, 0x38,
+  0x00, 0xe0, 0x61, 0x7f, 0x40, 0x20, 0xa8, 0x63, 0xb2, 0x63, 0x68, 0x03,
+  0x10, 0xe7, 0x40, 0x00, 0x68, 0x03, 0x11, 0x07, 0x00, 0xa8, 0x64, 0x70,
+  0xbe, 0x03, 0x10, 0x80, 0x10, 0x70, 0x64, 0xb0, 0x07, 0x02, 0xb0, 0xfe,
+  0x0b, 0x10, 0xdc, 0x0a, 0x47, 0x89, 0x07, 0xf0, 0x03, 0xff, 0x0c, 0xbc,
+  0xf1, 0x03, 0x0f, 0x04, 0xbf, 0x5b, 0xf7, 0x78, 0x00, 0x2b, 0x0d, 0x11,
+  0x04, 0xd1, 0x40, 0x22, 0xff, 0xaa, 0x60, 0x04, 0x22, 0x0a, 0x70, 0x0f,
+  0xe0, 0xff, 0x00, 0x23, 0x0b, 0x70, 0xfb, 0x07, 0x03, 0xd5, 0x5f, 0x40,
+  0x23, 0x2b, 0x60, 0x01, 0x0b, 0x00, 0xbb, 0x07, 0x10, 0xff, 0x32, 0x60,
+  0x0a, 0x78, 0x42, 0xf0, 0x02, 0x02, 0xf7, 0x0a, 0x70, 0x00, 0x31, 0x10,
+  0xfa, 0xf7, 0xb4, 0xfc, 0xff, 0x00, 0xf0, 0x6f, 0xf9, 0xff, 0xf7, 0x19,
+  0xfe, 0xce, 0x07, 0x11, 0x20, 0xf0, 0x0c, 0x07, 0x12, 0xe9, 0x01, 0xfe,
+  0xfb, 0xe6, 0xe9, 0x01, 0xfb, 0xfb, 0x07, 0x11, 0xff, 0x01, 0xf6, 0xbb,
+  0x2d, 0xdb, 0xe9, 0xf8, 0x4b, 0x40, 0x38, 0x58, 0xf7, 0x10, 0x6b, 0xe8,
+  0xed, 0x78, 0x05, 0x00, 0x48, 0x98, 0xe3, 0x00, 0x12, 0xf9, 0x30, 0xff,
+  0x60, 0x10, 0x20, 0x60, 0x64, 0xa9, 0x79, 0x48, 0xed, 0x08, 0xb7, 0x40,
+  0xf0, 0x01, 0x19, 0x90, 0x00, 0xf0, 0x02, 0xfb, 0x00, 0x89, 0x1b, 0x70,
+  0x01, 0xf0, 0x04, 0x01, 0x08, 0xef, 0x43, 0xa0, 0x66, 0x37, 0x01, 0xe1,
+  0xf0, 0x88, 0xfb, 0xfb, 0x80, 0x46, 0x3d, 0xe0, 0xf0, 0x84, 0xfb, 0x07,
+  0x46, 0x7d, 0x02, 0x07, 0x00, 0x80, 0xfb, 0x81, 0x46, 0x03, 0x07, 0x00,
+  0xff, 0x7c, 0xfb, 0xa8, 0xf1, 0x04, 0x01, 0x04, 0x2f, 0xff, 0x21, 0x67,
+  0x0a, 0xd2, 0x07, 0xf1, 0x0a, 0x02, 0x7f, 0x62, 0x67, 0x0a, 0x30, 0xe0,
+  0x67, 0x09, 0x09, 0x00, 0xff, 0xa2, 0x67, 0xdf, 0xf8, 0x88, 0x0b, 0x0c,
+  0xe0, 0xff, 0x10, 0x2f, 0x09, 0xd2, 0x3a, 0x1f, 0x62, 0x67, 0x7f, 0x00,
+  0x1f, 0xe0, 0x67, 0xa9, 0xf1, 0x04, 0x17, 0x00, 0xfc, 0x2b, 0x11, 0x57,
+  0xe1, 0xe0, 0x63, 0x01, 0x20, 0x88, 0x40, 0xff, 0x06, 0xf1, 0x34, 0x01,
+  0x21, 0x64, 0x60, 0x64, 0xff, 0x70, 0x63, 0x30, 0x60, 0x31, 0x6c, 0x08,
+  0x43, 0x6b, 0x30, 0x64, 0x25, 0xa3, 0x05, 0x89, 0x40, 0x43, 0xfc, 0x09,
+  0xa3, 0xf7, 0xfa, 0xf7, 0x34, 0xb5, 0x10, 0xb4, 0x0b, 0x00, 0x78, 0xdf,
+  0x60, 0x70, 0x29, 0x7e, 0xc9, 0xcd, 0xc0, 0x40, 0xf0, 0xb1, 0xc0, 0xf6,
+  0xe0, 0xd5, 0x70, 0x07, 0x20, 0x3a, 0xfd, 0xff, 0x01, 0xdf, 0x3f, 0xf8,
+  0x98, 0x1b, 0x20, 0xf0, 0x70, 0x03, 0x12, 0x13, 0x30, 0xd7, 0x70, 0x1f,
+  0x20, 0xfd, 0x00, 0x43, 0x89, 0xc0, 0xbb, 0xdf, 0xff, 0xf8, 0x84, 0x0b,
+  0x01, 0x79, 0x01, 0x29, 0x0c, 0x9d, 0xbf, 0xc5, 0xa0, 0x21, 0x01, 0x71,
+  0x38, 0x00, 0xff, 0x42, 0xec, 0x7f, 0x47, 0x20, 0x79, 0x02, 0x28, 0x6d,
+  0xd1, 0x63, 0x50, 0xbf, 0x0b, 0x01, 0x68, 0x21, 0xf0, 0xc0, 0xf5, 0x80,
+  0x41, 0xbe, 0x07, 0x02, 0x41, 0x60, 0xdf, 0xf8, 0x58, 0x13, 0x01, 0xf4,
+  0xe3, 0xc0, 0x11, 0x13, 0x02, 0x07, 0x00, 0x13, 0x01, 0xf8, 0x16, 0xc9,
+  0xff, 0x78, 0x01, 0x29, 0x05, 0xd1, 0x01, 0x68, 0x23, 0xff, 0x6f, 0x01,
+  0x22, 0x9a, 0x40, 0x91, 0x43, 0x01, 0xff, 0x60, 0x05, 0xf0, 0xe9, 0xfe,
+  0x00, 0xf0, 0x60, 0xde, 0xd3, 0x60, 0xa0, 0x65, 0x20, 0x66, 0x75, 0x21,
+  0x3f, 0xfb, 0xf6, 0x8b, 0x21, 0x3c, 0xfb, 0x8b, 0x21, 0x39, 0xfb, 0x00,
+  0xf0, 0xdd, 0x45, 0x1b, 0x01, 0x64, 0x20, 0x65, 0x89, 0x11, 0x31, 0xfb,
+  0xea, 0x9f, 0x11, 0x2e, 0x9f, 0x12, 0x2b, 0x1b, 0x00, 0x51, 0xf8, 0xa0,
+  0xfd, 0x66, 0xff, 0x41, 0x25, 0xfb, 0xdf, 0xf8, 0xd8, 0x1a, 0xa9, 0x01,
+  0xb7, 0x00, 0x45, 0x51, 0x18, 0x41, 0x02, 0x15, 0x41, 0x02, 0x12, 0xd5,
+  0xfb, 0x53, 0x01, 0x0f, 0x37, 0x02, 0x0c, 0x37, 0x02, 0x09, 0xfb, 0xf6,
+  0x49, 0x01, 0x06, 0xfb, 0x37, 0x01, 0x03, 0xfb, 0x06, 0xf0, 0xfd, 0x5d,
+  0xf1, 0x30, 0xff, 0xf7, 0xa1, 0xfa, 0xff, 0xf7, 0xff, 0x5d, 0xfa, 0x07,
+  0x22, 0x04, 0xf1, 0x8c, 0x01, 0xff, 0x0f, 0xf6, 0xfc, 0x20, 0xfa, 0xf7,
+  0xb8, 0xfb, 0xdd, 0x04, 0x65, 0x10, 0xff, 0xf7, 0x94, 0x19, 0x00, 0x50,
+  0xfa, 0xff, 0x00, 0x20, 0x20, 0x71, 0x10, 0xbd, 0x04, 0xf1, 0xdd, 0x48,
+  0xb9, 0x20, 0x04, 0xf1, 0x4c, 0xb9, 0x20, 0x04, 0xf1, 0x9d, 0x50, 0xb9,
+  0x20, 0x04, 0xf1, 0x54, 0xb9, 0x20, 0x67, 0xa0, 0xf1, 0xdd, 0x58, 0xdf,
+  0x30, 0x04, 0xf1, 0x5c, 0xdf, 0x30, 0x04, 0xf1, 0xb5, 0x60, 0xdf, 0x30,
+  0x04, 0xcd, 0xb0, 0x60, 0x63, 0x19, 0x01, 0x68, 0x7b, 0x00, 0xe0, 0x0d,
+  0x00, 0x6c, 0x00, 0x20, 0x64, 0xed, 0x50, 0xff, 0x67, 0x01, 0x20, 0xa0,
+  0x67, 0x02, 0x20, 0xe0, 0xb5, 0x67, 0x47, 0x11, 0x38, 0x47, 0x10, 0xe0,
+  0x45, 0xc3, 0x60, 0x16, 0xff, 0x20, 0x7b, 0x89, 0x79, 0xdf, 0xf8, 0xb8,
+  0x56, 0x7f, 0x20, 0xea, 0x01, 0x01, 0x40, 0xf6, 0x84, 0xc9, 0x40, 0xbf,
+  0x5a, 0xfb, 0x60, 0x7b, 0xa9, 0x78, 0x0f, 0x03, 0x85, 0xbe, 0x0f, 0x00,
+  0x52, 0xfb, 0xa0, 0x7b, 0xe9, 0x0f, 0x04, 0x86, 0x56, 0x0f, 0x00, 0x4a,
+  0xfb, 0xdd, 0x11, 0x01, 0xdd, 0x10, 0x45, 0x09, 0x00, 0xb4, 0xf1, 0x10,
+  0xb3, 0x00, 0x40, 0xb3, 0x20, 0x34, 0x40, 0x0d, 0x01, 0x06, 0xf6, 0x0d,
+  0x00, 0x39, 0xbb, 0x5f, 0x01, 0x64, 0x46, 0xdf, 0xf8, 0xbf, 0xcc, 0x59,
+  0x21, 0x78, 0x28, 0x7c, 0x3b, 0x03, 0x89, 0xbe, 0x3b, 0x00, 0x2c, 0xfb,
+  0x68, 0x7c, 0x61, 0x4b, 0x04, 0x8a, 0xaa, 0x0f, 0x00, 0x24, 0x41, 0x02,
+  0x09, 0x33, 0x00, 0x1f, 0x41, 0x06, 0x0a, 0xb6, 0x0d, 0x00, 0x18, 0xbb,
+  0x39, 0x71, 0x04, 0x16, 0x3d, 0x70, 0x05, 0xff, 0xc9, 0x79, 0x40, 0x69,
+  0xc9, 0x43, 0x01, 0x40, 0x5f, 0xc9, 0xb2, 0x40, 0xf6, 0x87, 0x33, 0x00,
+  0x0a, 0x29, 0x00, 0xf5, 0x04, 0x29, 0x02, 0x07, 0x29, 0x00, 0x03, 0xbb,
+  0xf8, 0xb5, 0xff, 0x00, 0x24, 0x0f, 0xf6, 0x18, 0x25, 0x0f, 0xf6, 0xff,
+  0x10, 0x26, 0xa0, 0x5d, 0xfb, 0xf7, 0x48, 0xfe, 0xf7, 0x30, 0xb1, 0x20,
+  0x21, 0xd0, 0x6d, 0xfd, 0x10, 0xb9, 0x7f, 0x20, 0x46, 0x05, 0xf0, 0x95,
+  0xf9, 0x60, 0x15, 0x00, 0xd7, 0x3d, 0xfe, 0x10, 0x15, 0x00, 0xfd, 0xdf,
+  0x80, 0x64, 0x1c, 0xff, 0x02, 0x2c, 0xea, 0xd3, 0x04, 0xf0, 0x83, 0xfa,
+  0xbf, 0x08, 0xb1, 0x04, 0xf0, 0x84, 0xfa, 0xc1, 0x10, 0x44, 0xbf, 0xe0,
+  0x78, 0x01, 0x28, 0x43, 0xd1, 0x31, 0x31, 0xef, 0x7f, 0xf9, 0x00, 0x1f,
+  0x0c, 0x28, 0x3b, 0xd2, 0x35, 0x31, 0x77, 0xe9, 0xf9, 0x05, 0x35, 0x32,
+  0xe5, 0xf9, 0x06, 0x35, 0x32, 0xdf, 0xe1, 0xf9, 0x04, 0x2d, 0xb8, 0x5b,
+  0x50, 0x07, 0xdb, 0xfd, 0x10, 0x07, 0x00, 0x01, 0x21, 0x03, 0xdb, 0x13,
+  0x2d, 0xbd, 0xb4, 0x9d, 0x20, 0x03, 0x21, 0x04, 0x2e, 0x17, 0x00, 0x22,
+  0xac, 0x17, 0x00, 0x07, 0x00, 0x01, 0x22, 0x17, 0x00, 0x2e, 0x17, 0x00,
+  0x22, 0x2f, 0x03, 0x22, 0x04, 0x28, 0x17, 0x00, 0x23, 0x17, 0x00, 0x07,
+  0x00, 0xeb, 0x01, 0x23, 0x17, 0x00, 0x28, 0x17, 0x00, 0x23, 0x03, 0x23,
+  0xff, 0x03, 0x29, 0x0a, 0xd2, 0x91, 0x42, 0x08, 0xbf, 0xff, 0x99, 0x42,
+  0x06, 0xd1, 0x02, 0x29, 0x06, 0xd1, 0xff, 0x10, 0x2d, 0x04, 0xbf, 0x11,
+  0x2e, 0x12, 0x28, 0xdf, 0x01, 0xd0, 0x04, 0x20, 0xf2, 0xa3, 0x80, 0x10,
+  0x86, 0xfb, 0x72, 0xb6, 0xff, 0x00, 0x55, 0x0f, 0xf6, 0xec, 0x00, 0x77,
+  0x07, 0x22, 0x05, 0x1b, 0x20, 0xfa, 0xf7, 0xbf, 0x0f, 0x20, 0xdf, 0xef,
+  0xfc, 0xff, 0xf7, 0x71, 0xcf, 0x70, 0xf3, 0xfd, 0xdf, 0x21, 0x7a, 0x4f,
+  0xf4, 0xdb, 0x83, 0x10, 0x83, 0xfa, 0xdf, 0x61, 0x7a, 0x40, 0xf2, 0xb7,
+  0xff, 0x71, 0xfa, 0x08, 0x7e, 0x35, 0x20, 0x67, 0xf9, 0x40, 0xf2, 0x2f,
+  0x47, 0xf3, 0x61, 0xdd, 0x38, 0x47, 0x90, 0x7e, 0xfa, 0x00, 0x09, 0x04,
+  0x79, 0xfa, 0xd5, 0xa0, 0xe3, 0x00, 0x18, 0x1d, 0xa2, 0x67, 0x7d, 0x40,
+  0xa3, 0xfb, 0x9f, 0x01, 0x20, 0x28, 0x71, 0x86, 0x55, 0xa0, 0xb9, 0x21,
+  0xb2, 0xef, 0xf9, 0x28, 0x7a, 0x41, 0x9f, 0x30, 0x0c, 0x20, 0x08, 0x5f,
+  0xd4, 0xc0, 0x07, 0x44, 0xbf, 0xc7, 0x21, 0xa8, 0x13, 0x00, 0x6f, 0x80,
+  0x07, 0x02, 0xd5, 0xcd, 0x21, 0xa2, 0xf9, 0x6d, 0x30, 0x97, 0x47, 0x20,
+  0x78, 0x23, 0x01, 0x0d, 0x23, 0x04, 0xd9, 0x21, 0x96, 0x67, 0xf9, 0x20,
+  0x78, 0x23, 0x01, 0xdf, 0x21, 0x90, 0xf9, 0xd9, 0x21, 0xb5, 0x8d, 0xe3,
+  0x80, 0xa7, 0xb5, 0x20, 0xf2, 0xbd, 0x8d, 0x80, 0x41, 0xfc, 0xe9, 0x60,
+  0x65, 0x20, 0x3c, 0x64, 0x28, 0x68, 0x69, 0x68, 0xff, 0x6f, 0x68, 0x4f,
+  0xea, 0x11, 0x28, 0x31, 0x79, 0xff, 0x00, 0x24, 0x01, 0x29, 0x04, 0xbf,
+  0x00, 0xf0, 0xff, 0x3f, 0x00, 0x0a, 0x28, 0x63, 0xd1, 0x00, 0x21, 0xff,
+  0xff, 0xf7, 0x53, 0xfa, 0xff, 0xb2, 0x61, 0x2f, 0xde, 0x8d, 0x20, 0x07,
+  0x40, 0xd0, 0x64, 0x67, 0x60, 0x80, 0x78, 0xdf, 0x00, 0x28, 0x56, 0xd1,
+  0xd6, 0x11, 0x40, 0x08, 0xf0, 0xff, 0x0f, 0x08, 0x88, 0xea, 0x00, 0x07,
+  0xf8, 0x07, 0xdf, 0x0b, 0xd5, 0x71, 0x6a, 0x08, 0x23, 0xc0, 0xc0, 0x01,
+  0xff, 0x08, 0x60, 0x01, 0x24, 0xb1, 0x6a, 0xf0, 0x6a, 0xbb, 0x08, 0x60,
+  0xa5, 0x01, 0x64, 0xf9, 0xb8, 0x1b, 0x00, 0x31, 0xdb, 0x6b, 0x08, 0xff,
+  0x40, 0x80, 0x04, 0x1b, 0x01, 0x71, 0x6b, 0xef, 0xb0, 0x6b, 0x08, 0x60,
+  0xb5, 0x01, 0x56, 0xf9, 0x78, 0xfe, 0x1b, 0x00, 0xf1, 0x68, 0x08, 0xf0,
+  0x04, 0x00, 0x00, 0x7e, 0x37, 0x02, 0x31, 0x69, 0x70, 0x69, 0x08, 0x60,
+  0xb9, 0x01, 0xff, 0x48, 0xf9, 0x38, 0x07, 0x1c, 0xd5, 0xb1, 0x69, 0xdf,
+  0x08, 0xf0, 0x08, 0x00, 0x40, 0x37, 0x00, 0xf1, 0x69, 0xfd, 0x30, 0x51,
+  0x00, 0x1e, 0x20, 0x0f, 0xe0, 0xc0, 0x78, 0xb7, 0xc0, 0xb9, 0xf1, 0x4f,
+  0x00, 0x07, 0x00, 0xa1, 0x70, 0x28, 0xff, 0x32, 0x6c, 0x71, 0x6c, 0x11,
+  0x60, 0x04, 0xbf, 0xbd, 0xc8, 0x5d, 0xf0, 0x00, 0xf0, 0xf3, 0xfa, 0xe3,
+  0x01, 0x2a, 0xff, 0xf9, 0x00, 0xe0, 0x5c, 0xb1, 0x00, 0x20, 0x28, 0x7c,
+  0x81, 0x00, 0xd5, 0x70, 0x41, 0xfb, 0xf7, 0x2d, 0xbc, 0x07, 0x01, 0xed,
+  0x0f, 0x1b, 0x00, 0x1c, 0xb9, 0x09, 0x00, 0x81, 0x10, 0xb5, 0xff, 0x05,
+  0xf0, 0xca, 0xfc, 0x05, 0xf0, 0xfe, 0xfb, 0xad, 0xd8, 0xb2, 0x30, 0xa0,
+  0x60, 0x77, 0x30, 0x60, 0x8b, 0x91, 0xf8, 0xef, 0xf8, 0xcb, 0x48, 0x01,
+  0x0d, 0xa2, 0xd1, 0x49, 0x49, 0x7f, 0x68, 0x21, 0x60, 0x70, 0x21, 0xa1,
+  0x60, 0xc1, 0x91, 0xdf, 0xfa, 0xf7, 0xb5, 0xbc, 0x70, 0x79, 0xa0, 0x8c,
+  0xf8, 0xef, 0x10, 0xd5, 0x30, 0x78, 0x7f, 0x61, 0x30, 0x70, 0x04, 0xae,
+  0x2f, 0x00, 0xae, 0xfa, 0xd5, 0x05, 0x10, 0x40, 0xf7, 0x00, 0xc5, 0x9e,
+  0x1f, 0x52, 0xc0, 0x46, 0xc0, 0x46, 0x65, 0x60, 0x07, 0x02, 0x30, 0x2f,
+  0x78, 0x00, 0xf0, 0xbf, 0x27, 0x04, 0xa4, 0x27, 0x03, 0x0d, 0x60, 0xbe,
+  0x27, 0x01, 0x62, 0xe0, 0x70, 0xb5, 0xb1, 0xed, 0x90, 0x54, 0x9b, 0x56,
+  0x61, 0x2d, 0x70, 0x50, 0x66, 0x29, 0x80, 0x6d, 0x80, 0x4f, 0xfb, 0xf6,
+  0xfe, 0x2b, 0x70, 0x20, 0x6b, 0x00, 0x68, 0x00, 0xd5, 0x03, 0x65, 0x03,
+  0x80, 0x3d, 0x00, 0x05, 0x3d, 0x00, 0x7b, 0xfa, 0x12, 0x89, 0x51, 0x40,
+  0x41, 0x10, 0x85, 0x51, 0x01, 0x65, 0x04, 0x07, 0x03, 0x65, 0x01, 0x95,
+  0x7f, 0x27, 0x04, 0x71, 0x27, 0x02, 0x20, 0x27, 0x04, 0x37, 0x21, 0xa5,
+  0xee, 0x23, 0x50, 0x28, 0x60, 0x70, 0x15, 0xe0, 0x00, 0xf0, 0x2e, 0x6b,
+  0xf8, 0x13, 0x55, 0x02, 0xc0, 0x93, 0x04, 0x50, 0xfa, 0x33, 0x01, 0xd5,
+  0x4d, 0xc1, 0x04, 0x03, 0x99, 0x02, 0x02, 0x53, 0x02, 0x12, 0xe0, 0x54,
+  0x07, 0x03, 0x5b, 0x01, 0x3f, 0x2d, 0x04, 0x43, 0x2d, 0x02, 0x40, 0x2d,
+  0x02, 0x28, 0x1b, 0x81, 0x2d, 0x01, 0x61, 0x01, 0x74, 0x61, 0x00, 0x20,
+  0x61, 0x00, 0x0d, 0x60, 0xd7, 0x45, 0x7c, 0x4d, 0x05, 0x00, 0x65, 0xc7,
+  0x01, 0x20, 0x60, 0xb7, 0x80, 0x20, 0xa9, 0xaf, 0x10, 0x68, 0x6a, 0xcd,
+  0x00, 0x06, 0xfe, 0xcf, 0x41, 0x00, 0xf0, 0x75, 0xf8, 0x0c, 0xd5, 0x41,
+  0xbf, 0xf0, 0x10, 0x01, 0x01, 0x70, 0x06, 0x37, 0x00, 0x11, 0x7c, 0x77,
+  0x04, 0xf9, 0x10, 0xf0, 0x3f, 0xf8, 0x0b, 0xe0, 0xd9, 0x30, 0xca, 0x19,
+  0x04, 0x0e, 0x19, 0x02, 0x20, 0x19, 0x00, 0x63, 0x01, 0x2a, 0xe0, 0x9e,
+  0xab, 0x41, 0x28, 0x45, 0x65, 0x4d, 0x57, 0x03, 0x49, 0x80, 0x10, 0xed,
+  0xe9, 0x23, 0x20, 0xa9, 0x69, 0x95, 0xb0, 0x05, 0x09, 0x68, 0xaf, 0xc9,
+  0x02, 0x01, 0x78, 0x57, 0x01, 0x20, 0x3d, 0x00, 0x07, 0xb2, 0x9b, 0x91,
+  0xf9, 0x57, 0x03, 0x77, 0xd0, 0xf0, 0x13, 0x57, 0x02, 0xdf, 0x4a, 0x19,
+  0x04, 0xe2, 0x19, 0x02, 0x20, 0x19, 0x00, 0xbb, 0x05, 0x16, 0xbb, 0x02,
+  0xab, 0x31, 0xbd, 0x0f, 0x01, 0x0e, 0x79, 0x01, 0xb8, 0xa7, 0x01, 0x21,
+  0x6b, 0xf8, 0x0f, 0x4f, 0x00, 0x30, 0x8d, 0x04, 0xbd, 0xf9, 0x3b, 0x01,
+  0xfd, 0xba, 0x55, 0x04, 0x0c, 0x00, 0xff, 0xf7, 0xe8, 0xff, 0x55, 0x0e,
+  0x55, 0x00, 0xcf, 0x1f, 0x04, 0xb7, 0x1f, 0x02, 0xb4, 0x5b, 0x04, 0x6d,
+  0x0c, 0x5b, 0x02, 0xd0, 0xe7, 0x0f, 0xa0, 0x44, 0x39, 0xb1, 0x04, 0xb7,
+  0x40, 0x20, 0x29, 0xaf, 0x00, 0xe9, 0x68, 0xa1, 0x30, 0x04, 0xbf, 0x09,
+  0x68, 0x49, 0x06, 0x01, 0x78, 0x1b, 0xd1, 0x18, 0xfa, 0x13, 0xe0, 0x4c,
+  0x1b, 0xd0, 0xf8, 0xf1, 0x00, 0x20, 0x40, 0xff, 0x42, 0x0f, 0x00, 0xf8,
+  0xb5, 0x2d, 0x48, 0x02, 0xf3, 0x6c, 0x41, 0xcb, 0x20, 0x4d, 0xc0, 0x10,
+  0xc1, 0xf3, 0x02, 0xff, 0x14, 0xc1, 0x6b, 0x91, 0xb1, 0x09, 0x68, 0x42,
+  0xbf, 0x6f, 0x21, 0xfa, 0x02, 0xf3, 0x82, 0x05, 0x01, 0xf5, 0xfe, 0x83,
+  0xf0, 0x02, 0x5b, 0x08, 0xc3, 0x6f, 0x52, 0x41, 0xfd, 0xd9, 0xd3, 0xe0,
+  0x01, 0x01, 0x42, 0xea, 0x81, 0x05, 0xff, 0xed, 0xb2, 0x04, 0xe0, 0xdf,
+  0xf8, 0x10, 0x14, 0xfb, 0x09, 0x78, 0xe5, 0xe0, 0x05, 0xac, 0x42, 0x35,
+  0xd0, 0xfc, 0x3f, 0x01, 0x53, 0x70, 0x63, 0x21, 0xf0, 0x70, 0x01, 0x41,
+  0xef, 0xea, 0x05, 0x11, 0xc0, 0x0f, 0x00, 0x10, 0x20, 0xfe, 0xd7, 0xf7,
+  0x9f, 0xff, 0x8f, 0x01, 0x30, 0x6f, 0x70, 0xd8, 0x03, 0xe7, 0x00, 0x7e,
+  0xc0, 0x05, 0x90, 0x57, 0x60, 0x03, 0x00, 0xf0, 0xfb, 0x83, 0xf8, 0x3b,
+  0xd0, 0x73, 0x0f, 0xf2, 0x50, 0x41, 0xfd, 0x38, 0xef, 0x10, 0xef, 0x00,
+  0x38, 0x70, 0x20, 0x46, 0xfd, 0x51, 0x93, 0xe0, 0x88, 0x47, 0x0f, 0xf2,
+  0x1c, 0x41, 0xff, 0x51, 0xf8, 0x25, 0x10, 0x28, 0x46, 0x88, 0x47, 0xf5,
+  0x38, 0x39, 0x20, 0x10, 0x1b, 0x00, 0x00, 0x20, 0x30, 0x60, 0xfd, 0x1c,
+  0x03, 0x81, 0x40, 0xfe, 0xf7, 0x76, 0xbf, 0xf1, 0xd3, 0xbd, 0xd0, 0xc3,
+  0x00, 0x23, 0x80, 0x03, 0x03, 0x00, 0x23, 0x01, 0xef, 0x78, 0x92, 0xf8,
+  0x6b, 0x87, 0x50, 0xe0, 0x01, 0x11, 0xbd, 0x43, 0x91, 0x13, 0x70, 0x47,
+  0x28, 0xf3, 0xeb, 0xf1, 0x20, 0x9f, 0x59, 0xdf, 0xf8, 0x7c, 0x13, 0x3f,
+  0x81, 0x19, 0x10, 0x13, 0xef, 0x08, 0x80, 0x70, 0x47, 0x2b, 0x81, 0x00,
+  0xf0, 0x2b, 0xff, 0xf8, 0x00, 0xf0, 0x65, 0xf8, 0xa4, 0x7c, 0x00, 0xff,
+  0xf0, 0x69, 0xf8, 0x49, 0x7d, 0x81, 0x70, 0x01, 0xff, 0x21, 0x11, 0x70,
+  0xd4, 0x4a, 0x41, 0x79, 0x00, 0xff, 0xf0, 0x54, 0xf8, 0x41, 0x71, 0x01,
+  0x20, 0x11, 0x1f, 0xe0, 0xb0, 0x28, 0x00, 0x20, 0x29, 0x01, 0xab, 0x10,
+  0x41, 0x20, 0xff, 0xa4, 0x7c, 0x23, 0x43, 0x03, 0x70, 0x09, 0x78, 0xfb,
+  0x89, 0x18, 0x2d, 0x02, 0x20, 0x00, 0xf0, 0x68, 0xf8, 0xbf, 0x05, 0x20,
+  0x05, 0xf0, 0x49, 0xf9, 0xb5, 0xe0, 0xf9, 0xed, 0x08, 0x97, 0x00, 0x10,
+  0x40, 0x99, 0xe0, 0xb8, 0xc6, 0x48, 0xfb, 0xc6, 0x4a, 0x9b, 0x80, 0xf0,
+  0x7f, 0x01, 0x01, 0x71, 0xff, 0x70, 0x47, 0x0c, 0x00, 0x00, 0x59, 0x80,
+  0xb5, 0xf7, 0x00, 0xe0, 0x80, 0xf5, 0x30, 0x67, 0xf9, 0xc1, 0x48, 0x7f,
+  0x81, 0x78, 0x41, 0xf0, 0x80, 0x01, 0x81, 0xe7, 0x80, 0xeb, 0x05, 0xf8,
+  0x33, 0x01, 0x02, 0x33, 0x00, 0xd3, 0xb8, 0x01, 0xd0, 0x15, 0x00, 0xab,
+  0x80, 0xb3, 0x00, 0x6f, 0x01, 0x49, 0x6f, 0x00, 0x18, 0xf8, 0xff, 0x24,
+  0x7e, 0x00, 0xf0, 0x1c, 0xf8, 0xc9, 0x7e, 0x97, 0x81, 0x70, 0x02, 0x99,
+  0x00, 0xad, 0x53, 0x00, 0x7d, 0xe1, 0x01, 0xeb, 0x71, 0x02, 0x73, 0x00,
+  0x0f, 0x73, 0x00, 0x42, 0xf8, 0xc5, 0xaf, 0xe7, 0x92, 0xf8, 0x43, 0xf3,
+  0x00, 0xc0, 0xf3, 0x00, 0x70, 0xff, 0x47, 0xab, 0x49, 0x03, 0x78, 0x0c,
+  0x78, 0xa4, 0x7f, 0x18, 0x03, 0xf0, 0xc0, 0x03, 0x70, 0x47, 0xab, 0x05,
+  0x2b, 0xa0, 0x4a, 0x53, 0x03, 0x1f, 0x53, 0x00, 0x13, 0x53, 0x00, 0x17,
+  0x05, 0x5c, 0x57, 0x02, 0xc3, 0x00, 0x06, 0xf8, 0x06, 0x4f, 0x00, 0xe7,
+  0x1d, 0x00, 0xff, 0x1a, 0xf8, 0x9d, 0xe7, 0x95, 0x49, 0x08, 0x70, 0xf7,
+  0x55, 0xe7, 0x99, 0x49, 0x0a, 0x00, 0x00, 0x74, 0x29, 0x7f, 0x00, 0x20,
+  0x95, 0x48, 0x91, 0x4a, 0xc1, 0xe7, 0x10, 0xb7, 0xbf, 0x01, 0xc1, 0xa5,
+  0x00, 0x00, 0x00, 0x3b, 0x30, 0x50, 0x5e, 0x03, 0x00, 0x58, 0x7c, 0x48,
+  0x01, 0x15, 0x00, 0x3f, 0xbb, 0x00, 0xe9, 0x09, 0x3b, 0x80, 0xe5, 0x01,
+  0xf4, 0x4b, 0x00, 0x07, 0xf8, 0x91, 0xf5, 0xe7, 0x0b, 0x01, 0xee, 0x0b,
+  0x00, 0x01, 0xf8, 0x8b, 0xe7, 0xf7, 0x87, 0x48, 0x41, 0xe1, 0x00, 0x40,
+  0x01, 0x41, 0x70, 0x7c, 0xe9, 0x05, 0x2d, 0x01, 0x10, 0xb5, 0x79, 0x49,
+  0x7a, 0xb3, 0xc0, 0x7f, 0x08, 0x70, 0x7a, 0x49, 0x7b, 0x48, 0x13, 0x01,
+  0x20, 0xdd, 0x1c, 0x65, 0x12, 0x13, 0x70, 0x93, 0x0b, 0x00, 0x16, 0xf8,
+  0x7f, 0x64, 0x7d, 0x23, 0x43, 0x93, 0x70, 0x53, 0x0b, 0x00, 0xfd, 0x10,
+  0xb9, 0x02, 0x53, 0x70, 0xd3, 0x78, 0x00, 0x78, 0xfd, 0x40, 0x97, 0x02,
+  0xc0, 0x7e, 0x18, 0x43, 0xd0, 0x70, 0xeb, 0x10, 0xbd, 0x6b, 0x30, 0x50,
+  0x03, 0x00, 0x58, 0x04, 0x78, 0xf9, 0x64, 0xaf, 0x04, 0x77, 0x01, 0xb2,
+  0xf8, 0x6b, 0x48, 0xff, 0xe7, 0xf7, 0x54, 0xff, 0x75, 0x01, 0xfb, 0x90,
+  0x70, 0x63, 0x49, 0xbd, 0x8a, 0x67, 0xb0, 0xc0, 0x02, 0x8a, 0x70, 0x6f,
+  0xb1, 0xc0, 0xba, 0x6f, 0xb0, 0x4a, 0x07, 0x02, 0x4a, 0x70, 0x81, 0xa9,
+  0x10, 0xcc, 0xff, 0x01, 0x81, 0x71, 0x60, 0x48, 0x61, 0x49, 0x0a, 0xff,
+  0x78, 0x03, 0x78, 0x1a, 0x40, 0x83, 0x78, 0x1a, 0x55, 0x43, 0x1f, 0x01,
+  0x43, 0x0b, 0x00, 0xc3, 0x0b, 0x00, 0x4a, 0x19, 0x20, 0xd7, 0x41, 0x60,
+  0x81, 0x3e, 0x90, 0x42, 0x1d, 0x10, 0x01, 0xbd, 0xf7, 0x08, 0xb1, 0x57,
+  0x07, 0x00, 0x70, 0x47, 0x56, 0x48, 0xfd, 0x00, 0x4d, 0x30, 0x80, 0xb5,
+  0x55, 0x48, 0x53, 0x4a, 0xef, 0x81, 0x79, 0x46, 0x4b, 0xf1, 0x11, 0x81,
+  0x71, 0x41, 0xfe, 0x4f, 0x00, 0x3f, 0x01, 0x41, 0x71, 0x12, 0x78, 0x0f,
+  0xff, 0xf2, 0xa4, 0x11, 0x51, 0x5c, 0x4e, 0x4a, 0x11, 0xff, 0x70, 0x04,
+  0x22, 0x1a, 0x70, 0x01, 0x70, 0xff, 0xaf, 0xf7, 0xa9, 0xfe, 0x04, 0x6b,
+  0x10, 0x31, 0x13, 0x10, 0x05, 0x75, 0xf8, 0x1d, 0x61, 0x02, 0xc7, 0x20,
+  0xcb, 0xbf, 0x2c, 0x41, 0x16, 0x1e, 0xbb, 0x03, 0x54, 0xf8, 0x40, 0x48,
+  0xd3, 0xa0, 0x99, 0x00, 0x29, 0x22, 0xfc, 0x51, 0x00, 0xc3, 0x02, 0x71,
+  0x0a, 0x20, 0xe7, 0xe6, 0x00, 0x33, 0x00, 0x54, 0xd3, 0x20, 0x53, 0x20,
+  0x58, 0x44, 0xf7, 0x00, 0xd3, 0xf1, 0xff, 0x04, 0x46, 0x91, 0x46, 0x9a,
+  0x46, 0xfe, 0xf7, 0xff, 0xa1, 0xff, 0x1c, 0x4f, 0x80, 0x46, 0x38, 0x79,
+  0xff, 0x01, 0x28, 0x25, 0xd1, 0x02, 0x2c, 0x21, 0xd1, 0xff, 0xfe, 0xf7,
+  0x98, 0xff, 0x30, 0x4e, 0x31, 0x49, 0xbf, 0x35, 0x68, 0x04, 0x46, 0x4f,
+  0xf0, 0xfe, 0x50, 0x60, 0x7d, 0xd7, 0x1d, 0x40, 0xc0, 0xf3, 0x02, 0x10,
+  0x03, 0xe9, 0x70, 0xdf, 0x04, 0x28, 0x09, 0xd0, 0x05, 0x07, 0x00, 0x06,
+  0x28, 0xff, 0x05, 0xd0, 0x02, 0x22, 0x48, 0x46, 0x51, 0x46, 0xbf, 0x03,
+  0xf0, 0xa6, 0xfc, 0x00, 0xe0, 0xcf, 0x21, 0x00, 0xff, 0x41, 0x31, 0x60,
+  0x84, 0xf3, 0x11, 0x88, 0x06, 0xde, 0x0d, 0x00, 0x04, 0xe0, 0x22, 0x46,
+  0x1d, 0x03, 0x97, 0xfc, 0xed, 0x88, 0x13, 0x00, 0xc0, 0xb2, 0xc1, 0x60,
+  0x87, 0x41, 0x0c, 0xbf, 0x00, 0x46, 0x61, 0x2c, 0x00, 0x20, 0x7f, 0x31,
+  0x4c, 0xd4, 0x87, 0x00, 0x03, 0x00, 0x58, 0x4f, 0x41, 0x48, 0x0b, 0x00,
+  0xb0, 0x01, 0xff, 0x00, 0x46, 0x28, 0x0b, 0x00, 0x46, 0x42, 0x06, 0xff,
+  0x00, 0x46, 0x15, 0x08, 0x00, 0x46, 0x60, 0xee, 0xf7, 0x00, 0x20, 0x04,
+  0x13, 0x00, 0xfe, 0x01, 0x00, 0x41, 0x55, 0x10, 0x0f, 0x00, 0x48, 0x4b,
+  0x20, 0x12, 0x07, 0x00, 0x68, 0x07, 0x00, 0xd5, 0x69, 0x03, 0x00, 0x11,
+  0x0b, 0x00, 0x13, 0x03, 0x00, 0x42, 0x05, 0x4f, 0x00, 0x46, 0xe8, 0x2b,
+  0xe7, 0xe0, 0x3b, 0x00, 0x60, 0x5b, 0x00, 0xfd, 0x1a, 0x13, 0x00, 0x0c,
+  0x02, 0x00, 0x46, 0x00, 0xe1, 0xfc, 0x3b, 0x30, 0x03, 0x00, 0x04, 0x02,
+  0x84, 0x0d, 0x05, 0x02, 0x3f, 0x85, 0x0d, 0x06, 0x02, 0x86, 0x0d, 0x7f,
+  0x00, 0xde, 0xe0, 0xd7, 0x00, 0x01, 0x33, 0x03, 0x00, 0xcd, 0x03, 0x00,
+  0xb9, 0x91, 0x7f, 0x00, 0x01, 0x7d, 0x92, 0x00, 0x01, 0x5d, 0x0b, 0x00,
+  0xa9, 0x21, 0x0b, 0x00, 0x1b, 0x01, 0x31, 0x03, 0x00, 0xa1, 0x03, 0x00,
+  0x8b, 0xaa, 0x0f, 0x00, 0x0f, 0x1b, 0x00, 0xcb, 0x03, 0x00, 0xa5, 0x0f,
+  0x00, 0x97, 0xfc, 0x0f, 0x00, 0x1b, 0x01, 0x08, 0x09, 0x00, 0x00, 0x0c,
+  0x0d, 0xff, 0x00, 0x00, 0x00, 0x03, 0x0c, 0x30, 0x0f, 0xf2, 0xfb, 0x2c,
+  0x02, 0x21, 0x30, 0x00, 0x80, 0x5c, 0x08, 0xb9, 0xfd, 0x03, 0x97, 0x20,
+  0x01, 0x22, 0x02, 0xfa, 0x01, 0xf1, 0x97, 0x08, 0x42, 0x14, 0x11, 0x90,
+  0x02, 0x0f, 0x00, 0x8b, 0x40, 0x02, 0xaf, 0x06, 0x23, 0x03, 0xfb, 0xa9,
+  0x20, 0x5c, 0xfb, 0x21, 0x0c, 0xff, 0x18, 0x1c, 0x1c, 0x18, 0x3e, 0x3e,
+  0x18, 0x00, 0x0f, 0x3e, 0x1c, 0x3e, 0x3e, 0x8b, 0x00, 0x5d, 0x80, 0x98,
+  0x60, 0x4b, 0x00, 0x9a, 0x00, 0x00, 0x02, 0x07, 0x00, 0x02, 0x02, 0x0b,
+  0x04, 0x08, 0x00, 0x80, 0xc0, 0x0b, 0x06, 0x04, 0x01, 0x0b, 0x04, 0x04,
+  0x06, 0x06, 0x06, 0x23, 0x0a, 0x80, 0xb5, 0x7f, 0x08, 0x46, 0x6b, 0x46,
+  0x40, 0x68, 0x01, 0x1b, 0xf0, 0xef, 0xf8, 0xf7, 0x56, 0xff, 0x43, 0x31,
+  0x01, 0xbd, 0x9d, 0xff, 0xf8, 0x00, 0x10, 0x48, 0x1e, 0x80, 0x41, 0xc0,
+  0xef, 0x0f, 0xfe, 0xf7, 0x9d, 0x11, 0x80, 0x82, 0xb0, 0x0d, 0xff, 0xf1,
+  0x01, 0x00, 0xfa, 0xf7, 0x59, 0xfa, 0x01, 0xff, 0x24, 0x67, 0x4d, 0x58,
+  0x20, 0x00, 0xfb, 0x04, 0xff, 0x56, 0x33, 0x69, 0x18, 0x00, 0x03, 0xd0,
+  0x70, 0xff, 0x6a, 0x00, 0x22, 0x00, 0x21, 0x98, 0x47, 0x69, 0xfd, 0x46,
+  0xe3, 0x50, 0xf7, 0x85, 0xfe, 0x70, 0x60, 0xff, 0xff, 0xf7, 0xe0, 0xff,
+  0x64, 0x1c, 0x11, 0x2c, 0xeb, 0xdf, 0xd3, 0x05, 0xf0, 0x28, 0xff, 0x37,
+  0x01, 0x00, 0xf0, 0xff, 0xe0, 0xfa, 0x73, 0xbd, 0xf8, 0xb5, 0xfe, 0xf7,
+  0xff, 0x70, 0xfe, 0x00, 0x24, 0x57, 0x4d, 0x57, 0x4e, 0xff, 0xe0, 0xb2,
+  0xfb, 0xf7, 0xc0, 0xf8, 0x60, 0xb1, 0xff, 0xa0, 0x5d, 0x58, 0x21, 0x01,
+  0xfb, 0x00, 0x57, 0x5f, 0x00, 0xf0, 0x25, 0xf8, 0x3b, 0x4f, 0x02, 0x78,
+  0x4f, 0x00, 0xdd, 0x02, 0x4f, 0x00, 0x64, 0x1c, 0x10, 0x41, 0x00, 0xf1,
+  0xbd, 0xff, 0x10, 0xb5, 0x4b, 0x4c, 0x82, 0xb0, 0x60, 0x62, 0xff, 0x60,
+  0x68, 0x20, 0xb9, 0x69, 0x46, 0xf8, 0xf7, 0xff, 0x54, 0xfe, 0x60, 0x60,
+  0x03, 0xe0, 0x00, 0xf0, 0xbf, 0x98, 0xf8, 0xff, 0xf7, 0xac, 0xff, 0x73,
+  0x50, 0xf0, 0xd7, 0x08, 0xf8, 0x23, 0x39, 0x02, 0x60, 0x39, 0x04, 0x13,
+  0xbd, 0xff, 0x30, 0xb5, 0x04, 0x46, 0x3d, 0x48, 0x58, 0x21, 0xff, 0x87,
+  0xb0, 0x01, 0xfb, 0x04, 0x05, 0xfb, 0xf7, 0xff, 0x49, 0xf8, 0xc4, 0xb1,
+  0x3b, 0x48, 0x20, 0x5c, 0xff, 0xfb, 0xf7, 0x86, 0xf8, 0x00, 0x28, 0x36,
+  0xd0, 0xfd, 0x20, 0x87, 0xa0, 0x0f, 0xfe, 0x05, 0xa9, 0x02, 0x91, 0xfb,
+  0x00, 0x95, 0xfd, 0x20, 0x91, 0x01, 0x46, 0x35, 0x4b, 0xff, 0x01, 0x22,
+  0x00, 0x20, 0xf9, 0xf7, 0xb6, 0xfa, 0xff, 0xa8, 0x62, 0x9d, 0xf8, 0x14,
+  0x10, 0xff, 0xf7, 0xff, 0x80, 0xff, 0xeb, 0x6b, 0xa8, 0x6c, 0xe9, 0x6c,
+  0xfb, 0x01, 0x90, 0x3d, 0xb0, 0x92, 0x02, 0x91, 0x9a, 0xb2, 0xff, 0x00,
+  0x92, 0x00, 0xeb, 0x81, 0x00, 0x03, 0x94, 0xff, 0x02, 0x1f, 0x69, 0x6a,
+  0x68, 0x6c, 0xdb, 0xb2, 0x7f, 0xf9, 0xf7, 0x7e, 0xf9, 0x8d, 0xf8, 0x14,
+  0xdd, 0x00, 0xff, 0x4d, 0xf8, 0xe8, 0x6b, 0x29, 0x6c, 0x05, 0xaa, 0xed,
+  0xc0, 0x13, 0x00, 0x2b, 0xfa, 0x3f, 0x03, 0x60, 0xff, 0x29, 0xbf, 0x46,
+  0x20, 0x46, 0xf9, 0xf7, 0x35, 0xa3, 0x00, 0x07, 0xff, 0xb0, 0x30, 0xbd,
+  0x38, 0xb5, 0x05, 0x46, 0x18, 0xfe, 0x93, 0x00, 0x01, 0xfb, 0x05, 0x04,
+  0xfb, 0xf7, 0x00, 0xbf, 0xf8, 0x25, 0xb1, 0x17, 0x48, 0x28, 0x91, 0x00,
+  0x3d, 0xef, 0xf8, 0xf8, 0xb1, 0x28, 0x8f, 0x00, 0xab, 0xf8, 0xa0, 0xdf,
+  0x6a, 0x68, 0xb1, 0x6b, 0x46, 0x4d, 0x11, 0xf9, 0xf7, 0xef, 0x58, 0xfb,
+  0xa0, 0x6a, 0x39, 0x10, 0x01, 0xf9, 0xf7, 0xf5, 0xab, 0x4f, 0x00, 0x01,
+  0x4f, 0x00, 0x38, 0xff, 0x60, 0x68, 0xbc, 0xfb, 0x50, 0xf5, 0x00, 0x31,
+  0xff, 0xe0, 0x6b, 0x69, 0x01, 0x86, 0xdc, 0x7d, 0x00, 0xc3, 0x10, 0xf0,
+  0x0e, 0xf8, 0xad, 0x10, 0x00, 0x00, 0xff, 0xb1, 0x02, 0x20, 0x32, 0xbd,
+  0x00, 0x00, 0xd8, 0xef, 0x20, 0x00, 0x20, 0xc8, 0x03, 0x00, 0xf4, 0x1e,
+  0x00, 0xbf, 0x20, 0xd1, 0x94, 0x00, 0x01, 0x40, 0xc5, 0x14, 0xba, 0xfd,
+  0xbb, 0x5b, 0x01, 0x4f, 0xf6, 0xff, 0x71, 0xf8, 0xf7, 0xff, 0x63, 0xbe,
+  0x00, 0x00, 0x2c, 0x21, 0xfe, 0xf7, 0xef, 0x05, 0xba, 0x00, 0x00, 0x1d,
+  0xb1, 0x88, 0x46, 0x04, 0xff, 0x46, 0x00, 0x25, 0xc9, 0xb2, 0x48, 0x09,
+  0x05, 0xff, 0x28, 0x01, 0xf0, 0x1f, 0x01, 0x49, 0xda, 0x0f, 0xff, 0xf2,
+  0xac, 0x03, 0x03, 0xeb, 0xc0, 0x02, 0x57, 0xff, 0x68, 0x00, 0x2f, 0x42,
+  0xd0, 0x13, 0xf8, 0x30, 0xff, 0x30, 0x99, 0x42, 0x3e, 0xda, 0x23, 0x4b,
+  0x53, 0xff, 0xf8, 0x20, 0x60, 0x01, 0x27, 0x07, 0xfa, 0x01, 0xff, 0xfe,
+  0x0e, 0xea, 0x06, 0x06, 0xd3, 0xf8, 0x14, 0xff, 0xe0, 0x9b, 0x69, 0x07,
+  0xfa, 0x00, 0xf0, 0x00, 0xbf, 0xea, 0x0e, 0x00, 0x30, 0x43, 0x43, 0x21,
+  0xb0, 0x50, 0xff, 0x68, 0x00, 0xeb, 0xc1, 0x06, 0xfb, 0xf7, 0xd4, 0xff,
+  0xf9, 0x04, 0x28, 0x03, 0xd1, 0xf0, 0x88, 0x80, 0xfe, 0x33, 0xa0, 0x07,
+  0x43, 0x00, 0x2c, 0x1c, 0xbf, 0x00, 0xff, 0x2f, 0x06, 0x25, 0x1d, 0xd1,
+  0x30, 0x68, 0xb1, 0xfb, 0x88, 0x00, 0xff, 0xb1, 0x29, 0x14, 0xd0, 0x4f,
+  0xea, 0xff, 0x08, 0x23, 0x4f, 0xea, 0x18, 0x62, 0x02, 0xeb, 0xff, 0x13,
+  0x46, 0xb1, 0x42, 0x0a, 0xdb, 0x00, 0xeb, 0xff, 0x13, 0x40, 0x0b, 0x4b,
+  0x00, 0x2c, 0x12, 0xbf, 0xff, 0x19, 0x46, 0x01, 0x46, 0x18, 0x46, 0x00,
+  0xf0, 0xff, 0x6e, 0xfa, 0x04, 0xe0, 0x07, 0x25, 0x02, 0xe0, 0xbb, 0x05,
+  0x25, 0x95, 0x30, 0x25, 0x28, 0x46, 0xd3, 0xa1, 0x02, 0x6d, 0x49, 0xa3,
+  0x20, 0x00, 0x88, 0x73, 0xe0, 0x10, 0x27, 0x73, 0x71, 0xa7, 0x00, 0x20,
+  0x13, 0x04, 0x00, 0x57, 0xe0, 0x01, 0x9b, 0x50, 0x00, 0xc7, 0xc8, 0x6e,
+  0x01, 0x70, 0x20, 0x00, 0x0b, 0x17, 0x01, 0x98, 0x75, 0x7f, 0x01, 0x01,
+  0x10, 0xb5, 0x01, 0x21, 0x15, 0x21, 0x80, 0xfb, 0x08, 0xfc, 0xb3, 0x11,
+  0x84, 0x4c, 0xf9, 0xf7, 0x59, 0xfd, 0xfc, 0xbf, 0xc3, 0xf9, 0xf7, 0x23,
+  0xfc, 0x61, 0x7a, 0xfb, 0x80, 0x4c, 0xc1, 0xc1, 0xf9, 0xf7, 0x1d, 0xfc,
+  0xfe, 0xeb, 0xf7, 0xbc, 0xb1, 0xc0, 0x03, 0xdb, 0xd0, 0x33, 0x40, 0xf9,
+  0xbf, 0xf7, 0x1f, 0xfc, 0x00, 0x22, 0x01, 0x0b, 0x00, 0x4c, 0xaa, 0x0b,
+  0x00, 0x19, 0x0b, 0x00, 0x0f, 0x0b, 0x00, 0x2e, 0x0b, 0x00, 0x13, 0xfa,
+  0x0b, 0x00, 0x03, 0x83, 0xe0, 0x89, 0x60, 0xf9, 0xf7, 0x0d, 0xbf, 0xfc,
+  0x21, 0x78, 0x40, 0xf2, 0x35, 0x15, 0x00, 0xfe, 0xbf, 0xfb, 0x61, 0x7d,
+  0x40, 0xf2, 0x36, 0x09, 0x00, 0xf9, 0xaf, 0xfb, 0xff, 0xf7, 0x8e, 0xb1,
+  0x10, 0xbc, 0x03, 0x00, 0xdb, 0xfd, 0xf8, 0xb3, 0x71, 0x04, 0x20, 0xfc,
+  0xf7, 0xc2, 0xbf, 0xdf, 0x80, 0xb5, 0x04, 0x20, 0xfd, 0x03, 0x20, 0x00,
+  0xf0, 0xdf, 0x0a, 0xf8, 0xf9, 0xf7, 0x04, 0x6d, 0x00, 0xa0, 0xfa, 0xfc,
+  0x4b, 0xe3, 0x9d, 0x01, 0xb9, 0xbb, 0x09, 0x22, 0x5f, 0x49, 0xf7, 0x0f,
+  0xf2, 0x78, 0x0d, 0x40, 0x2d, 0xe9, 0xf1, 0x4f, 0xff, 0xdf, 0xf8, 0x74,
+  0xa1, 0x5d, 0x4e, 0x5d, 0x4f, 0xf7, 0x82, 0xb0, 0x9a, 0xe7, 0x11, 0x90,
+  0x00, 0x24, 0x74, 0xff, 0x60, 0xb4, 0x81, 0x03, 0x21, 0xb8, 0x7a, 0x08,
+  0xff, 0x42, 0x06, 0xd0, 0x01, 0x20, 0x03, 0xf0, 0x41, 0xff, 0xf8, 0x00,
+  0x29, 0x08, 0xbf, 0x00, 0x28, 0x15, 0xff, 0xd0, 0x78, 0x89, 0xc0, 0xf3,
+  0x81, 0x00, 0x30, 0xae, 0x13, 0xc0, 0x03, 0xf0, 0x36, 0x15, 0x04, 0x0a,
+  0x15, 0x02, 0x82, 0xcb, 0x10, 0x40, 0x21, 0x20, 0x03, 0x89, 0x81, 0x15,
+  0x02, 0x01, 0xd1, 0xff, 0x05, 0x24, 0x53, 0xe0, 0x00, 0x98, 0x20, 0x28,
+  0xf9, 0x4f, 0x63, 0xe0, 0xbf, 0x61, 0x34, 0x61, 0x00, 0x27, 0xdf, 0xf7,
+  0xf8, 0x14, 0x81, 0x03, 0x00, 0x91, 0x00, 0xe0, 0x7f, 0xff, 0x1c, 0x00,
+  0x98, 0x87, 0x42, 0x3d, 0xd2, 0x07, 0xbf, 0xeb, 0x0a, 0x00, 0x0c, 0x21,
+  0x40, 0x17, 0x70, 0x1f, 0xdf, 0x05, 0x0f, 0xf2, 0x00, 0x10, 0xbf, 0x20,
+  0x0b, 0xdb, 0xfd, 0xf8, 0x8d, 0x70, 0x28, 0xed, 0xd0, 0x02, 0x98, 0xe8,
+  0xff, 0x40, 0xc0, 0x07, 0xe9, 0xd5, 0x29, 0x46, 0x16, 0xde, 0xb7, 0x00,
+  0x6c, 0xfb, 0x49, 0x46, 0xdf, 0x01, 0x5e, 0xff, 0xff, 0x9b, 0xf8, 0x08,
+  0x00, 0xfe, 0xf7, 0x66, 0xfa, 0x96, 0x27, 0x00, 0x20, 0x41, 0x17, 0x40,
+  0x90, 0x39, 0x60, 0x19, 0x01, 0x77, 0xff, 0xff, 0xe4, 0xb2, 0x1c, 0xb1,
+  0x35, 0x73, 0x74, 0xff, 0x73, 0x07, 0x24, 0x10, 0xe0, 0x01, 0x21, 0x72,
+  0xff, 0x68, 0xa9, 0x40, 0x0a, 0x43, 0x72, 0x60, 0x32, 0xff, 0x68, 0x11,
+  0x43, 0x31, 0x60, 0x31, 0x69, 0x49, 0xff, 0x44, 0x08, 0x1a, 0x30, 0x61,
+  0xfa, 0xf7, 0x32, 0x7f, 0xfe, 0x00, 0x28, 0xbe, 0xd0, 0x06, 0x24, 0x23,
+  0xe1, 0xdb, 0x08, 0xff, 0xf9, 0x10, 0x24, 0x20, 0xf9, 0x10, 0xfe, 0x8f,
+  0x77, 0x1f, 0x49, 0x01, 0xbf, 0x70, 0x70, 0x47, 0xf8, 0xdf, 0x30, 0xdf,
+  0x0d, 0x46, 0x16, 0x46, 0x19, 0x5b, 0x00, 0xfc, 0xf7, 0xef, 0xcc, 0xff,
+  0x00, 0x27, 0xa9, 0xf0, 0xfe, 0x08, 0xb1, 0xff, 0x02, 0x27, 0x0d, 0xe0,
+  0x04, 0xf1, 0x8c, 0x40, 0xff, 0x05, 0xea, 0x06, 0x01, 0x00, 0x78, 0x28,
+  0x40, 0x6f, 0x88, 0x42, 0x05, 0xd0, 0x21, 0x01, 0xd3, 0xff, 0xad, 0x01,
+  0xfd, 0x01, 0x2d, 0x20, 0xfc, 0xf7, 0x45, 0xff, 0x38, 0x46, 0xff, 0xf2,
+  0xbd, 0x09, 0x48, 0x81, 0x68, 0x00, 0x68, 0x0d, 0x08, 0x21, 0x00, 0x0c,
+  0xbf, 0x5d, 0x90, 0x69, 0x10, 0x27, 0x21, 0x57, 0x61, 0x3f, 0x31, 0x04,
+  0x00, 0x46, 0xf4, 0xf2, 0x6f, 0x60, 0x8f, 0x90, 0xd9, 0xe0, 0x07, 0x00,
+  0x8f, 0x81, 0x58, 0xb5, 0xe9, 0xc0, 0xe1, 0xe4, 0xfb, 0x00, 0x92, 0xe3,
+  0x92, 0x00, 0x00, 0x6d, 0x52, 0x01, 0xfb, 0x01, 0x05, 0x07, 0x00, 0x11,
+  0x55, 0x01, 0x01, 0x13, 0x7c, 0x03, 0x00, 0x0b, 0x01, 0xdd, 0x68, 0x01,
+  0x01, 0xdf, 0x03, 0x00, 0xec, 0x0b, 0x01, 0x00, 0x01, 0xff, 0x37, 0x0b,
+  0x07, 0x8d, 0x63, 0x01, 0xf9, 0x01, 0xba, 0x11, 0x00, 0x01, 0x55, 0x76,
+  0x01, 0x01, 0x38, 0xaa, 0x07, 0x00, 0x91, 0x78, 0xb0, 0x93, 0x03, 0x00,
+  0xc8, 0x0b, 0x00, 0x49, 0xf1, 0x75, 0x4f, 0x60, 0x03, 0x00, 0x17, 0x01,
+  0x5d, 0x17, 0x00, 0x01, 0xb3, 0xc9, 0x13, 0x0b, 0x03, 0x00, 0x01, 0x8f,
+  0x15, 0x0b, 0x03, 0x37, 0xcf, 0x58, 0x01, 0x01, 0x77, 0x03, 0x00, 0x0b,
+  0x01, 0x15, 0x5b, 0xef, 0x01, 0x01, 0x0b, 0x5c, 0x0b, 0x03, 0x11, 0x5d,
+  0x01, 0xa3, 0x01, 0x55, 0x03, 0x00, 0x2f, 0x05, 0x00, 0x05, 0x79, 0x1f,
+  0x00, 0x25, 0x7c, 0x17, 0x00, 0x5f, 0x01, 0x79, 0xdb, 0x00, 0x01, 0xd1,
+  0x03, 0x00, 0x3e, 0x83, 0x01, 0x99, 0xa5, 0x00, 0x01, 0xf9, 0x03, 0x00,
+  0x2f, 0x01, 0x9f, 0xc1, 0x60, 0x00, 0x01, 0xf1, 0x03, 0x00, 0x0b, 0x01,
+  0x4b, 0xcf, 0x34, 0x00, 0x01, 0x4d, 0x03, 0x00, 0x0b, 0x01, 0x2e, 0x04,
+  0xff, 0x33, 0x04, 0x35, 0x04, 0x36, 0x04, 0x48, 0x04, 0x7f, 0x4c, 0x04,
+  0x5b, 0x04, 0x5c, 0x04, 0x5d, 0xee, 0x10, 0xfe, 0x53, 0x51, 0x4a, 0x4d,
+  0x87, 0xb0, 0x08, 0x21, 0x28, 0xff, 0x1d, 0xf8, 0xf7, 0x21, 0xfd, 0x28,
+  0x60, 0x00, 0xfb, 0xb1, 0x01, 0xf5, 0x10, 0x8e, 0xf9, 0x03, 0x21, 0x04,
+  0xff, 0x91, 0x00, 0xf0, 0x24, 0xf8, 0x05, 0xaa, 0x0f, 0xaf, 0xf2, 0x10,
+  0x11, 0x16, 0x05, 0x60, 0xa9, 0xf3, 0x40, 0x12, 0x9f, 0xe0, 0x30, 0xb5,
+  0x87, 0xb0, 0x1b, 0x01, 0x5b, 0x40, 0xf0, 0xd5, 0x15, 0xeb, 0x20, 0x0d,
+  0x21, 0x02, 0x00, 0x21, 0x02, 0x98, 0xff, 0xb7, 0x00, 0x2d, 0x0c, 0xf1,
+  0x62, 0x20, 0x70, 0x1d, 0x51, 0x05, 0xfd, 0x46, 0xa7, 0x45, 0x66, 0xb9,
+  0x00, 0x21, 0x03, 0x91, 0xff, 0x4f, 0xf4, 0x20, 0x71, 0x02, 0x91, 0x16,
+  0x21, 0xff, 0x2f, 0x48, 0x01, 0x90, 0x00, 0x91, 0x00, 0xf6, 0xff, 0xfc,
+  0x12, 0x16, 0x23, 0x00, 0x21, 0x0f, 0xf2, 0x7f, 0x39, 0x00, 0xf8, 0xf7,
+  0xc3, 0xbe, 0x38, 0x8b, 0x00, 0xdd, 0x00, 0x7b, 0x00, 0x1d, 0xfb, 0x03,
+  0x05, 0x00, 0x1a, 0xfb, 0xff, 0x24, 0x48, 0x00, 0x68, 0xf8, 0xf7, 0x12,
+  0xfd, 0xef, 0xff, 0xf7, 0xdc, 0xff, 0x5d, 0x01, 0xf9, 0xfe, 0xff, 0xeb,
+  0xf7, 0xd6, 0x61, 0x08, 0x31, 0x17, 0x50, 0x38, 0xb5, 0x1b, 0x7f, 0x4c,
+  0x23, 0xe0, 0xfe, 0xf7, 0x36, 0xf9, 0x39, 0x01, 0xfb, 0xe2, 0xfa, 0xed,
+  0x51, 0x91, 0xfe, 0x01, 0x28, 0x19, 0xef, 0xd0, 0x29, 0x0e, 0x0c, 0x11,
+  0x00, 0x0d, 0xfa, 0x01, 0xeb, 0x21, 0x0b, 0x07, 0x00, 0xfa, 0x1f, 0x00,
+  0xf9, 0xf7, 0x99, 0xff, 0xfd, 0x01, 0x00, 0x0c, 0xd0, 0x48, 0x68, 0xc9,
+  0xaf, 0x68, 0x88, 0x47, 0x00, 0x17, 0x02, 0xee, 0x17, 0x02, 0xf2, 0xf5,
+  0xfd, 0x3d, 0x01, 0xe1, 0x3d, 0x00, 0xfe, 0xf7, 0xde, 0xfa, 0xdf, 0x20,
+  0x68, 0x6a, 0x46, 0x00, 0x35, 0x70, 0xe4, 0xfc, 0xff, 0x00, 0x68, 0x05,
+  0x04, 0xc0, 0xb2, 0x07, 0x28, 0xa6, 0x4d, 0x23, 0xcb, 0xe7, 0x57, 0x70,
+  0x3b, 0x20, 0x68, 0x5b, 0x80, 0x41, 0xff, 0x6e, 0x61, 0x6c, 0x79, 0x73,
+  0x69, 0x73, 0x54, 0xc7, 0x61, 0x73, 0x6b, 0x97, 0x11, 0x0f, 0x06, 0x0e,
+  0x00, 0x62, 0xb3, 0xff, 0x8b, 0x07, 0x08, 0xd0, 0x52, 0x1e, 0x11, 0xf8,
+  0xf7, 0x01, 0x3b, 0x00, 0x03, 0x01, 0xf0, 0x24, 0x80, 0x8b, 0xff, 0x07,
+  0xf6, 0xd1, 0x83, 0x07, 0x40, 0xf0, 0x20, 0xff, 0x80, 0x00, 0xbf, 0x10,
+  0x3a, 0x07, 0xd3, 0x30, 0xff, 0xb4, 0xb1, 0xe8, 0x38, 0x10, 0x10, 0x3a,
+  0xa0, 0xfe, 0x05, 0x00, 0xf9, 0xd2, 0x30, 0xbc, 0x53, 0x07, 0x24, 0xbf,
+  0xbf, 0xb1, 0xe8, 0x08, 0x10, 0xa0, 0x03, 0x00, 0x44, 0xbf, 0xbf, 0x51,
+  0xf8, 0x04, 0x3b, 0x40, 0x03, 0x00, 0xd2, 0xbe, 0x15, 0x00, 0x31, 0xf8,
+  0x02, 0x2b, 0x20, 0x03, 0x00, 0x44, 0x2f, 0xbf, 0x0b, 0x78, 0x03, 0x25,
+  0x30, 0x08, 0x3d, 0x00, 0x29, 0x01, 0xf3, 0x08, 0x3a, 0x21, 0x01, 0x03,
+  0x00, 0xcb, 0xf7, 0xd2, 0x53, 0xfb, 0x07, 0xe4, 0x9b, 0x01, 0xb5, 0x30,
+  0x48, 0x4f, 0xf0, 0xff, 0x80, 0x71, 0x01, 0x63, 0xc2, 0x6b, 0x42, 0xf0,
+  0xff, 0x80, 0x72, 0xc2, 0x63, 0x01, 0x60, 0x20, 0x20, 0x5d, 0x01, 0x11,
+  0x60, 0x07, 0xf9, 0x20, 0xd9, 0x00, 0xe9, 0xab, 0x40, 0xdb, 0x02, 0x40,
+  0x09, 0x01, 0xea, 0xb8, 0x1f, 0x61, 0x82, 0xb0, 0xff, 0x00, 0x24, 0x00,
+  0x25, 0x24, 0x4e, 0x06, 0xeb, 0xff, 0xc5, 0x07, 0xd7, 0xf8, 0x08, 0x80,
+  0x0e, 0xe0, 0xff, 0x30, 0x68, 0x64, 0x1c, 0x84, 0x42, 0x05, 0xd3, 0xdf,
+  0x71, 0x68, 0xb0, 0x69, 0x6a, 0x95, 0x70, 0x7a, 0xfd, 0xf7, 0x00, 0x24,
+  0x40, 0xe7, 0x10, 0x0a, 0xf8, 0x08, 0xf1, 0xff, 0x04, 0x08, 0xf8, 0x68,
+  0x80, 0x45, 0xed, 0xd3, 0xff, 0x6d, 0x1c, 0x02, 0x2d, 0xe5, 0xd3, 0xbd,
+  0xe8, 0xff, 0xf3, 0x81, 0x80, 0xb5, 0x72, 0xb6, 0x15, 0x48, 0xef, 0x16,
+  0x49, 0x01, 0x60, 0x6d, 0x70, 0x60, 0x62, 0xb6, 0x7f, 0x00, 0x22, 0xf0,
+  0x21, 0x40, 0xf6, 0x59, 0x21, 0x50, 0xbf, 0x72, 0xf9, 0xbd, 0xe8, 0x08,
+  0x40, 0x0f, 0x03, 0x51, 0xfe, 0x0f, 0x00, 0x6a, 0xb9, 0x80, 0xb5, 0xff,
+  0xf7, 0xaf, 0x5d, 0xff, 0xc9, 0x71, 0x4f, 0xf4, 0x45, 0x57, 0x50, 0x61,
+  0x77, 0x10, 0xff, 0xf8, 0xf7, 0x22, 0xfd, 0x04, 0x49, 0x88, 0x61, 0xff,
+  0x01, 0xbd, 0x03, 0x48, 0x80, 0x69, 0xf8, 0xf7, 0xd5, 0x9f, 0xcf, 0x10,
+  0x10, 0x07, 0xa0, 0x30, 0x07, 0xa4, 0x00, 0x00, 0xfb, 0xab, 0xab, 0x91,
+  0x11, 0x48, 0xb8, 0x00, 0x00, 0x0f, 0xeb, 0x28, 0xb4, 0xd1, 0x34, 0x70,
+  0x89, 0xc0, 0x12, 0xf8, 0x2c, 0xff, 0x43, 0x1c, 0x60, 0x02, 0xeb, 0x40,
+  0x00, 0x01, 0x77, 0x23, 0x07, 0xe0, 0x11, 0x01, 0x09, 0xf8, 0xac, 0x11,
+  0x04, 0xff, 0x00, 0x23, 0x43, 0x70, 0x81, 0xf3, 0x10, 0x88, 0xff, 0x70,
+  0xbd, 0xef, 0xf3, 0x10, 0x81, 0x72, 0xb6, 0xff, 0x1d, 0x4b, 0x1d, 0x4a,
+  0x1c, 0x68, 0x12, 0xf9, 0xbf, 0x10, 0x60, 0x01, 0x25, 0xb5, 0x40, 0x89,
+  0x91, 0x78, 0xff, 0x02, 0x19, 0x49, 0x82, 0x5c, 0x52, 0xb9, 0x11, 0x7f,
+  0xf8, 0x10, 0x00, 0x17, 0x49, 0xc2, 0x08, 0x6b, 0xc0, 0x2f, 0x00, 0x51,
+  0x5c, 0xc1, 0x93, 0xe1, 0x00, 0xb9, 0x90, 0x43, 0x00, 0xfd, 0x40, 0x95,
+  0xb0, 0x38, 0xb5, 0x0f, 0x4b, 0x03, 0xeb, 0xfb, 0x40, 0x03, 0x45, 0x00,
+  0x84, 0x72, 0xb6, 0x0f, 0xf2, 0xff, 0x40, 0x05, 0x45, 0x5d, 0x01, 0x2d,
+  0x0a, 0xd1, 0xff, 0x02, 0xb9, 0x13, 0x21, 0x19, 0x70, 0x59, 0x78, 0xff,
+  0x11, 0xb1, 0xff, 0xf7, 0xb9, 0xff, 0x03, 0xe0, 0x77, 0xff, 0xf7, 0xbf,
+  0xcb, 0x40, 0x19, 0x70, 0x84, 0x73, 0x00, 0x6f, 0x31, 0xbd, 0x02, 0x49,
+  0x55, 0x01, 0x70, 0x47, 0x1f, 0xf1, 0xfa, 0xfb, 0xd1, 0x26, 0x8b, 0xa0,
+  0x0f, 0xf2, 0x04, 0x01, 0x40, 0xee, 0xf5, 0x92, 0x00, 0x00, 0x01, 0x00,
+  0x07, 0x00, 0xef, 0xf3, 0xdf, 0x11, 0x80, 0x60, 0x21, 0x81, 0x13, 0xb0,
+  0x70, 0x47, 0x5f, 0xdf, 0xf8, 0x9c, 0x06, 0x00, 0x8d, 0x50, 0x02, 0x3b,
+  0x00, 0xbe, 0x07, 0x31, 0x0d, 0x46, 0xff, 0xf7, 0xef, 0x2f, 0x10, 0x00,
+  0xaf, 0x23, 0xc5, 0xe9, 0x02, 0x03, 0x00, 0x04, 0x03, 0x00, 0x06, 0xf6,
+  0x2b, 0x30, 0xca, 0x00, 0x81, 0xe0, 0x56, 0xab, 0x50, 0x49, 0xf9, 0x1c,
+  0x3f, 0x60, 0x07, 0x00, 0x16, 0x29, 0xf5, 0xd3, 0xa1, 0xee, 0x13, 0x00,
+  0x6c, 0x26, 0x41, 0x51, 0xf0, 0x11, 0x60, 0x16, 0xfd, 0xe0, 0x3d, 0x05,
+  0xd0, 0xff, 0xdf, 0xf8, 0x58, 0x26, 0x6b, 0x24, 0xb9, 0x05, 0x00, 0x36,
+  0xff, 0x00, 0x78, 0x03, 0x67, 0xf0, 0xfd, 0x50, 0x09, 0x00, 0x52, 0x78,
+  0x24, 0xf0, 0x02, 0x04, 0x77, 0x44, 0xea, 0x45, 0xf1, 0xd0, 0x19, 0x60,
+  0x80, 0x7d, 0x00, 0xff, 0x31, 0xbd, 0x7f, 0xb5, 0x0a, 0xb1, 0x00, 0xf5,
+  0xff, 0x80, 0x70, 0x40, 0xf2, 0xfc, 0x72, 0x02, 0xea, 0xe7, 0x80, 0x00,
+  0x40, 0x87, 0x00, 0x03, 0x70, 0xeb, 0x82, 0x05, 0xff, 0x33, 0xf8, 0x22,
+  0x60, 0xb5, 0xf9, 0x02, 0x50, 0xff, 0x46, 0xea, 0x05, 0x45, 0x4d, 0xf8,
+  0x22, 0x50, 0xff, 0x52, 0x1c, 0x04, 0x2a, 0xf2, 0xdb, 0x03, 0x9a, 0xff,
+  0x02, 0x9b, 0x01, 0x9c, 0x00, 0x29, 0x0c, 0xbf, 0xef, 0xdf, 0xf8, 0x00,
+  0x16, 0x03, 0x01, 0x00, 0x9d, 0x4d, 0xff, 0x60, 0x8c, 0x60, 0xcb, 0x60,
+  0x0a, 0x61, 0x08, 0xfb, 0x60, 0x7f, 0x4f, 0x00, 0x04, 0x46, 0x68, 0x46,
+  0x10, 0xff, 0x21, 0xfd, 0xf7, 0xbf, 0xfd, 0x4f, 0xf4, 0x00, 0x7b, 0x50,
+  0xad, 0xa2, 0x41, 0x25, 0x00, 0x26, 0x86, 0xa3, 0x00, 0xef, 0xc9, 0xb2,
+  0xe0, 0xb2, 0xe3, 0x91, 0x6b, 0x46, 0x32, 0xef, 0x46, 0x21, 0x46, 0x28,
+  0xa9, 0x00, 0xc0, 0xff, 0x76, 0xef, 0x1c, 0x02, 0x2e, 0xf0, 0x59, 0x20,
+  0xff, 0x2d, 0xec, 0xff, 0xd9, 0x7f, 0xbd, 0xc0, 0x0b, 0x00, 0x21, 0x00,
+  0xff, 0xfa, 0x01, 0xf2, 0x12, 0x05, 0x03, 0xd4, 0x49, 0xff, 0x1c, 0xc9,
+  0xb2, 0x07, 0x29, 0xf7, 0xdb, 0xc1, 0xf3, 0xf1, 0x07, 0x39, 0x00, 0x5d,
+  0x80, 0xbf, 0x4a, 0x1e, 0x00, 0xf7, 0x22, 0xd0, 0x40, 0x6b, 0xb1, 0x40,
+  0xea, 0x41, 0x10, 0xcf, 0x70, 0x47, 0x41, 0x09, 0x0d, 0x60, 0x0d, 0x01,
+  0xf0, 0x20, 0xff, 0x00, 0x4a, 0x1e, 0x90, 0x40, 0x02, 0x29, 0x04, 0x9f,
+  0xdb, 0x01, 0x22, 0x89, 0x1e, 0x7f, 0xb2, 0xd3, 0xe0, 0x10, 0xff, 0xb5,
+  0x02, 0x46, 0x0b, 0x46, 0x14, 0x68, 0x18, 0xfe, 0x6d, 0x00, 0xfc, 0xf7,
+  0xb5, 0xfe, 0x38, 0xbf, 0x1c, 0xbf, 0x46, 0x83, 0xf0, 0x00, 0x43, 0x20,
+  0x67, 0x60, 0xfc, 0xfb, 0xf7, 0xad, 0x0f, 0x02, 0x14, 0x60, 0x10, 0xbd,
+  0x2d, 0xff, 0xe9, 0xf7, 0x4f, 0x8e, 0xb0, 0x9a, 0x46, 0x1a, 0xff, 0x9c,
+  0xdf, 0xf8, 0x34, 0xb5, 0x00, 0x26, 0x4f, 0xff, 0xf0, 0x8c, 0x48, 0x0d,
+  0xf1, 0x14, 0x09, 0xf0, 0xfe, 0xad, 0x00, 0xcd, 0xff, 0x80, 0x03, 0x01,
+  0xf0, 0x0f, 0xff, 0xf8, 0x01, 0x46, 0x0e, 0x9a, 0x00, 0x94, 0x53, 0xff,
+  0x46, 0x05, 0xa8, 0x01, 0xf0, 0x74, 0xfb, 0x00, 0xbf, 0x25, 0x59, 0xf8,
+  0x35, 0x00, 0x41, 0x45, 0x00, 0x9c, 0xbb, 0xfe, 0x49, 0x09, 0x02, 0x05,
+  0xa8, 0x00, 0x4b, 0x30, 0x78, 0xff, 0x68, 0xfc, 0xf7, 0x93, 0xfe, 0x78,
+  0x60, 0x59, 0xdb, 0x46, 0x38, 0xdd, 0x00, 0xbf, 0xff, 0x07, 0x00, 0x1d,
+  0xff, 0xf7, 0xf7, 0xbb, 0xff, 0x2d, 0x01, 0xfc, 0xf7, 0xf2, 0xfe, 0xbf,
+  0x01, 0xa9, 0x21, 0xf8, 0x25, 0x00, 0x25, 0x01, 0xec, 0xfe, 0x0b, 0x00,
+  0x01, 0xeb, 0x85, 0x01, 0x6d, 0x1c, 0x04, 0xff, 0x2d, 0x48, 0x80, 0xd7,
+  0xd3, 0x10, 0x9a, 0x0f, 0xaf, 0x99, 0x01, 0xab, 0x30, 0x35, 0x00, 0x36,
+  0x13, 0x10, 0xff, 0xdf, 0x2e, 0xc0, 0xd9, 0x11, 0xb0, 0x1b, 0x90, 0x8f,
+  0x10, 0xb7, 0xb5, 0x04, 0x00, 0x6b, 0x11, 0xa0, 0x24, 0x03, 0x01, 0xc8,
+  0x5f, 0xb2, 0x10, 0x60, 0x08, 0x1d, 0x31, 0x20, 0x14, 0x03, 0x00, 0xff,
+  0x24, 0x89, 0x6b, 0x52, 0x69, 0xa1, 0xfb, 0x00, 0xff, 0x01, 0x00, 0x23,
+  0xfd, 0xf7, 0xc8, 0xf9, 0xdf, 0xff, 0xf8, 0x8c, 0x14, 0x40, 0x1c, 0x41,
+  0xf8, 0x24, 0xfb, 0x00, 0x10, 0x99, 0xb0, 0x00, 0x88, 0x00, 0x0a, 0x0c,
+  0xfb, 0x46, 0x80, 0xcd, 0x10, 0x59, 0x00, 0xc0, 0x00, 0x01, 0xff, 0xf0,
+  0x02, 0x01, 0x00, 0xf0, 0x18, 0x00, 0x08, 0xff, 0x43, 0x15, 0x46, 0x40,
+  0xf0, 0x01, 0x07, 0xff, 0xdf, 0xf7, 0xbe, 0xfe, 0x06, 0x46, 0xcf, 0xa1,
+  0xff, 0xf7, 0xfd, 0xce, 0x2d, 0x20, 0x2c, 0x04, 0x1c, 0xb9, 0x00, 0x78,
+  0x7f, 0xdf, 0xf8, 0x28, 0x14, 0x02, 0xe0, 0x40, 0x07, 0x00, 0x7f, 0x24,
+  0x14, 0x38, 0x43, 0x08, 0x60, 0x86, 0x21, 0x20, 0x7d, 0xf1, 0x4b, 0x00,
+  0x07, 0x00, 0x0c, 0x46, 0x1a, 0x79, 0x50, 0xf7, 0xdf, 0xf8, 0x30, 0x77,
+  0x00, 0x30, 0x14, 0x15, 0x46, 0xff, 0x08, 0x60, 0x1e, 0x46, 0xdf, 0xf8,
+  0x1c, 0x04, 0x77, 0x50, 0xf8, 0x27, 0xd7, 0x00, 0x91, 0xfb, 0xc7, 0x9f,
+  0x80, 0x7f, 0xb0, 0x42, 0x2e, 0xda, 0x41, 0x42, 0xc9, 0x91, 0x20, 0xf7,
+  0x10, 0x24, 0x00, 0xa7, 0xe0, 0xdf, 0xf8, 0x0c, 0x24, 0xff, 0x52, 0x58,
+  0xd2, 0x08, 0x5a, 0x80, 0xdf, 0xf8, 0x9d, 0x08, 0x09, 0x02, 0x25, 0xf8,
+  0x20, 0x43, 0x00, 0x79, 0x40, 0xf0, 0xff, 0x1b, 0xf8, 0xe7, 0xe7, 0x00,
+  0x20, 0x14, 0xe0, 0xbe, 0x2f, 0x03, 0xf0, 0x23, 0x00, 0xf0, 0x19, 0x2f,
+  0x00, 0xec, 0xa5, 0x23, 0x2f, 0x05, 0xe8, 0x09, 0x02, 0x2f, 0x03, 0xe0,
+  0x1d, 0x00, 0x03, 0xff, 0xf8, 0xb0, 0x42, 0xe8, 0xdb, 0xf1, 0xbd, 0x51,
+  0xff, 0x58, 0x05, 0xeb, 0x80, 0x02, 0xc9, 0x08, 0x51, 0x5f, 0x80, 0x40,
+  0x1c, 0x70, 0x47, 0x23, 0x01, 0x24, 0x23, 0x00, 0xf7, 0x04, 0xeb, 0x80,
+  0xb9, 0xf0, 0xf8, 0xb5, 0x06, 0x46, 0xdf, 0x0c, 0x46, 0x15, 0x46, 0x1f,
+  0xd3, 0x00, 0x4f, 0xfe, 0xfe, 0x2f, 0x31, 0x56, 0xf8, 0x31, 0x30, 0xdf,
+  0xf8, 0x44, 0xff, 0xc3, 0x4c, 0xf8, 0x02, 0x30, 0x06, 0xeb, 0xc1, 0x7f,
+  0x03, 0xdf, 0xf8, 0x3c, 0xc3, 0x5b, 0x68, 0x0d, 0x01, 0xff, 0x49, 0x1c,
+  0x15, 0x29, 0xee, 0xd3, 0xdf, 0xf8, 0xff, 0x88, 0x13, 0x0c, 0x60, 0x4d,
+  0x60, 0x3f, 0x06, 0xff, 0x06, 0x99, 0x3a, 0x0d, 0x02, 0xf0, 0xf0, 0x02,
+  0xff, 0x42, 0xea, 0x81, 0x01, 0xc6, 0x4a, 0x41, 0xf0, 0x49, 0x03, 0x4f,
+  0x30, 0x1f, 0x31, 0xf1, 0xe5, 0xb0, 0x99, 0x60, 0x21, 0x29, 0x61, 0x7f,
+  0x50, 0xf9, 0x20, 0x69, 0x04, 0xf1, 0xbc, 0x47, 0x10, 0xff, 0x21, 0xf8,
+  0x05, 0x00, 0x07, 0xd1, 0x21, 0x68, 0xbf, 0x20, 0x69, 0x00, 0xf0, 0x76,
+  0xf8, 0x05, 0x01, 0x58, 0xff, 0xf8, 0x05, 0x46, 0x20, 0x69, 0xfc, 0xf7,
+  0xe9, 0xaf, 0xf9, 0x28, 0x46, 0x32, 0xe1, 0xc0, 0x04, 0x27, 0xc0, 0x27,
+  0xff, 0xfc, 0x03, 0x28, 0x06, 0xd1, 0x04, 0xf0, 0xfd, 0xf7, 0xf8, 0x00,
+  0x21, 0x37, 0x00, 0x00, 0xfb, 0xf7, 0x27, 0xb6, 0x1b, 0x50, 0x10, 0x40,
+  0x4b, 0x01, 0x87, 0xb9, 0x85, 0x51, 0x04, 0xb3, 0x46, 0x88, 0x27, 0x00,
+  0x73, 0xa0, 0x26, 0x03, 0x77, 0xf0, 0xe0, 0xd6, 0x01, 0xc0, 0x47, 0xfc,
+  0x37, 0x70, 0x46, 0x4d, 0xc0, 0xf9, 0x00, 0xff, 0x2d, 0x48, 0xbf, 0x14,
+  0x26, 0x20, 0xd4, 0x28, 0xbe, 0x0d, 0x00, 0x21, 0xf9, 0xfb, 0xf7, 0x53,
+  0x03, 0x00, 0x3e, 0xff, 0xf9, 0x01, 0x2d, 0x0c, 0xd1, 0x03, 0x27, 0x02,
+  0xff, 0x20, 0x04, 0xf0, 0x7a, 0xf8, 0xb3, 0x48, 0xb0, 0xf7, 0xf8, 0x54,
+  0x10, 0xf9, 0xc1, 0xd5, 0xfb, 0x60, 0xb1, 0xff, 0x13, 0x26, 0x0a, 0xe0,
+  0x02, 0x27, 0x00, 0x2d, 0xff, 0xf0, 0xd1, 0x01, 0x20, 0xef, 0xe7, 0xf9,
+  0xf7, 0xe7, 0xe8, 0xfb, 0x02, 0xbb, 0x60, 0x2b, 0x00, 0x27, 0xf8, 0xb2,
+  0xff, 0xfa, 0xf7, 0xeb, 0xf9, 0x18, 0xb9, 0xf9, 0xf7, 0x7f, 0x5d, 0xfc,
+  0x00, 0xb9, 0x0c, 0x26, 0x30, 0x73, 0xb2, 0xde, 0xd7, 0x01, 0x01, 0x20,
+  0xa0, 0x40, 0x5b, 0x71, 0x00, 0x25, 0x7f, 0x08, 0xb9, 0x02, 0x25, 0x0a,
+  0xe0, 0x04, 0x97, 0x50, 0xff, 0xe4, 0xfe, 0x08, 0xb9, 0x01, 0x25, 0x04,
+  0xe0, 0xfe, 0xcf, 0xd1, 0x6d, 0xfa, 0x00, 0xb1, 0x11, 0x25, 0xfa, 0xce,
+  0x7b, 0x00, 0x00, 0xb1, 0x00, 0xab, 0xb0, 0xd9, 0x01, 0x0c, 0x46, 0xff,
+  0x21, 0x78, 0x09, 0x04, 0x01, 0xf4, 0xfe, 0x01, 0xfb, 0x41, 0xea, 0x35,
+  0x40, 0xf0, 0x00, 0x40, 0x40, 0xf4, 0xff, 0x80, 0x40, 0xfb, 0xf7, 0x29,
+  0xfc, 0x60, 0x78, 0xde, 0xdd, 0x01, 0xfb, 0xf7, 0x47, 0xbc, 0x5b, 0x01,
+  0xf7, 0xf7, 0xbf, 0x03, 0xfd, 0x20, 0x68, 0xc0, 0x78, 0x2d, 0xc0, 0x05,
+  0xff, 0xa0, 0x68, 0x20, 0x30, 0x2a, 0x46, 0x01, 0x79, 0xdf, 0x00, 0x91,
+  0x03, 0x68, 0x21, 0x43, 0x10, 0x14, 0x00, 0xff, 0xff, 0xf7, 0x45, 0xfe,
+  0x20, 0x68, 0x02, 0x78, 0x5f, 0x21, 0x69, 0xa0, 0x68, 0x2b, 0xaf, 0x10,
+  0xa7, 0x0d, 0x00, 0xff, 0xc5, 0x70, 0xbd, 0xe8, 0x31, 0x40, 0xf7, 0xf7,
+  0xff, 0xfc, 0xbc, 0x2d, 0xe9, 0xf8, 0x43, 0x80, 0x46, 0xff, 0x4f, 0xf4,
+  0xd4, 0x70, 0x00, 0xfb, 0x08, 0xf5, 0x7b, 0x7a, 0x4e, 0x19, 0x20, 0x91,
+  0xaf, 0x19, 0xf8, 0x4b, 0x01, 0xbf, 0x04, 0x09, 0xf1, 0x20, 0x00, 0x22,
+  0x4b, 0x00, 0x03, 0xbf, 0x68, 0x00, 0x91, 0x07, 0xf1, 0x28, 0x79, 0x30,
+  0xff, 0xff, 0xf7, 0x1f, 0xfe, 0xaa, 0x5d, 0x23, 0x46, 0x41, 0xbb, 0x46,
+  0x48, 0x0b, 0x00, 0x82, 0xfe, 0xfc, 0x47, 0x00, 0xf1, 0xff, 0x83, 0x10,
+  0xb5, 0xcb, 0x07, 0x55, 0x4a, 0x0d, 0xff, 0xd5, 0x55, 0x4b, 0x28, 0xb1,
+  0x04, 0x24, 0x14, 0xff, 0x70, 0x1c, 0x68, 0x44, 0xf0, 0x04, 0x04, 0x04,
+  0xeb, 0xe0, 0x00, 0x0b, 0x02, 0x24, 0x0b, 0x00, 0x1c, 0x60, 0x89, 0xdf,
+  0x07, 0x0c, 0xd5, 0x4e, 0x49, 0x1f, 0x00, 0x20, 0x50, 0xff, 0x70, 0x08,
+  0x68, 0x40, 0xf0, 0x04, 0x00, 0x03, 0x95, 0xe0, 0x09, 0x01, 0x20, 0x09,
+  0x00, 0x08, 0x17, 0x40, 0x95, 0xa5, 0x1f, 0xfc, 0x3f, 0x40, 0x99, 0x31,
+  0x30, 0xfd, 0x20, 0x88, 0x00, 0x90, 0xfe, 0x97, 0x00, 0x71, 0x20, 0x46,
+  0xfd, 0xf7, 0x4f, 0xfb, 0xfd, 0xbd, 0xdb, 0x40, 0x20, 0x80, 0x4f, 0xf2,
+  0xff, 0x71, 0xff, 0x38, 0x88, 0x08, 0x40, 0xa0, 0x80, 0x04, 0xf5, 0xff,
+  0xce, 0x70, 0x39, 0x6a, 0x01, 0x60, 0x97, 0xf8, 0xaf, 0x24, 0x10, 0x01,
+  0x71, 0x31, 0x01, 0x78, 0x5d, 0x80, 0xe0, 0xd7, 0x70, 0x00, 0x21, 0x49,
+  0x41, 0x30, 0x0b, 0x00, 0x28, 0x85, 0xbf, 0x68, 0x85, 0xf1, 0xbd, 0x46,
+  0x49, 0x43, 0x00, 0x72, 0xff, 0x02, 0xfb, 0x00, 0x10, 0x90, 0xf8, 0xa1,
+  0x01, 0x74, 0x75, 0x91, 0xcb, 0x40, 0x4a, 0x13, 0x00, 0x73, 0x03, 0xfb,
+  0x50, 0x00, 0xbf, 0xf8, 0xa1, 0x11, 0x70, 0x47, 0x3d, 0x23, 0x05, 0x11,
+  0xff, 0x01, 0xf1, 0xe0, 0x00, 0x28, 0x31, 0xb8, 0x22, 0x36, 0x85, 0xf0,
+  0xbb, 0x70, 0x91, 0x02, 0x36, 0x48, 0x83, 0x01, 0x09, 0xf0, 0xef, 0x06,
+  0x00, 0x20, 0x86, 0x41, 0x00, 0x28, 0x07, 0x03, 0xfb, 0xd5, 0x31, 0xcb,
+  0x32, 0xdf, 0xfc, 0x68, 0x07, 0x04, 0xef, 0xd5, 0xb8, 0x21, 0x06, 0x19,
+  0x10, 0xf8, 0xf7, 0x64, 0xff, 0xfd, 0xe8, 0x07, 0x08, 0xd5, 0x2c, 0x48,
+  0x2b, 0xbb, 0x4b, 0x94, 0xa5, 0xe0, 0x04, 0x01, 0x22, 0xc5, 0x02, 0x94,
+  0xdf, 0xff, 0xa8, 0x07, 0x0a, 0xd5, 0x21, 0x01, 0x06, 0xf1, 0xdb, 0xe0,
+  0x01, 0x57, 0x01, 0xb4, 0xfb, 0x8d, 0xb1, 0x70, 0x40, 0x5f, 0x42, 0xe7,
+  0x70, 0xbd, 0x1f, 0x9b, 0x06, 0x80, 0x09, 0x70, 0xfe, 0xb7, 0x61, 0x10,
+  0x09, 0x00, 0x46, 0x08, 0x00, 0x60, 0xb3, 0x59, 0x0c, 0x03, 0x00, 0x95,
+  0xd0, 0x59, 0x8c, 0x33, 0xb2, 0x40, 0xae, 0x0b, 0x00, 0x50, 0x59, 0x04,
+  0x07, 0x00, 0x04, 0x07, 0x00, 0x00, 0xaf, 0xfc, 0x7f, 0x46, 0x18, 0x0b,
+  0x00, 0x18, 0x0b, 0x00, 0xf8, 0x55, 0xf1, 0x63, 0xb3, 0x30, 0x27, 0x00,
+  0x1c, 0x0f, 0x00, 0x1c, 0x17, 0x00, 0x55, 0x4c, 0x07, 0x00, 0x50, 0x03,
+  0x00, 0x8c, 0x03, 0x00, 0x90, 0x03, 0x00, 0x55, 0x4c, 0x13, 0x00, 0x50,
+  0x03, 0x00, 0x8c, 0x03, 0x00, 0x90, 0x03, 0x00, 0xf9, 0xb0, 0x57, 0x00,
+  0xab, 0xb1, 0x08, 0xb2, 0x00, 0x20, 0x2c, 0xf2, 0xd5, 0xb0, 0x70, 0x03,
+  0x00, 0x05, 0x21, 0xdf, 0xf8, 0x4c, 0x8a, 0xf7, 0x88, 0x21, 0x40, 0x6d,
+  0x10, 0x98, 0xfa, 0x00, 0x25, 0xff, 0x0f, 0xf6, 0x11, 0x29, 0xdf, 0xf8,
+  0x40, 0x7a, 0xff, 0xd4, 0x20, 0x00, 0xfb, 0x05, 0xf4, 0x44, 0x20, 0xfb,
+  0xe5, 0x53, 0x07, 0x00, 0x86, 0x6f, 0xf0, 0xc7, 0x00, 0xff, 0x70, 0x61,
+  0xf8, 0xf7, 0xb3, 0xfa, 0x70, 0x63, 0xfb, 0x00, 0x21, 0xbb, 0x40, 0x0a,
+  0x28, 0x18, 0x4b, 0x46, 0xff, 0x81, 0x70, 0x01, 0x71, 0x01, 0x22, 0xe9,
+  0xb2, 0xfd, 0x02, 0xd3, 0x20, 0x4a, 0xfe, 0xe0, 0x19, 0x00, 0xf0, 0xeb,
+  0x98, 0xfc, 0xbf, 0x81, 0xe0, 0xbf, 0x80, 0xf1, 0x43, 0xf8, 0x67, 0xf7,
+  0xee, 0xbe, 0x81, 0x30, 0x5f, 0x00, 0xf8, 0x09, 0x6d, 0x40, 0xff, 0x99,
+  0xdf, 0xf8, 0xf4, 0x79, 0x89, 0xb0, 0x80, 0x7d, 0x7a, 0x69, 0x40, 0x08,
+  0xff, 0xf7, 0xc2, 0xff, 0x1d, 0x91, 0xff, 0x28, 0xfa, 0x05, 0xf0, 0xc0,
+  0x07, 0x3d, 0xd5, 0x7f, 0xdf, 0xf8, 0xcc, 0x09, 0x01, 0x95, 0xd4, 0xe7,
+  0xf1, 0xfe, 0xab, 0x40, 0xd0, 0x19, 0x02, 0x91, 0x03, 0x97, 0x44, 0xfe,
+  0x0d, 0x01, 0x91, 0x04, 0x91, 0x08, 0x90, 0x00, 0xf1, 0xff, 0xd0, 0x06,
+  0x05, 0x80, 0x00, 0x21, 0x31, 0x70, 0xff, 0x71, 0x70, 0x00, 0xf0, 0x66,
+  0xfc, 0x01, 0xa8, 0xff, 0x00, 0xf0, 0x6a, 0xfc, 0x04, 0x00, 0x09, 0xd1,
+  0xff, 0x02, 0x98, 0x00, 0x96, 0xb0, 0xf9, 0x02, 0x20, 0xff, 0x01, 0x88,
+  0x03, 0x1d, 0x01, 0x98, 0xfd, 0xf7, 0xf3, 0xde, 0xf8, 0x71, 0x30, 0x1d,
+  0x00, 0x8e, 0xfc, 0x14, 0xb9, 0xff, 0x30, 0x78, 0x5a, 0x28, 0x05, 0xda,
+  0x04, 0x98, 0xff, 0x3c, 0x30, 0x00, 0x21, 0xc1, 0x80, 0x81, 0x80, 0xf4,
+  0xe5, 0xc0, 0x0b, 0x00, 0x01, 0x0b, 0x02, 0x08, 0x99, 0x11, 0xf8, 0xff,
+  0xd0, 0x2f, 0x42, 0x80, 0x49, 0x78, 0x01, 0x80, 0xbe, 0xb1, 0x01, 0xba,
+  0xd3, 0x20, 0x46, 0x09, 0x0b, 0x61, 0x83, 0xfe, 0xdb, 0xf1, 0xf1, 0x4f,
+  0xa0, 0xb0, 0xf8, 0xf7, 0x14, 0x7f, 0xfe, 0x03, 0x90, 0x36, 0x21, 0x20,
+  0x98, 0xaf, 0x60, 0xfd, 0x69, 0x11, 0x10, 0x79, 0x09, 0x90, 0x44, 0x22,
+  0x06, 0xef, 0xf1, 0x10, 0x00, 0x0a, 0x9d, 0x20, 0x84, 0x58, 0x20, 0xff,
+  0x98, 0x01, 0xfb, 0x00, 0xf5, 0xe8, 0x19, 0x0b, 0x7b, 0x90, 0x20, 0xd9,
+  0x00, 0x0c, 0x09, 0x02, 0xfb, 0xfb, 0xa0, 0xd7, 0x90, 0xd4, 0x22, 0x0d,
+  0x01, 0x00, 0x0d, 0x02, 0x10, 0x90, 0xff, 0x08, 0x90, 0xf7, 0xf7, 0x32,
+  0xfb, 0xe8, 0x19, 0xdf, 0xdf, 0xf8, 0xfc, 0x18, 0x36, 0x03, 0x20, 0xa2,
+  0xfa, 0xff, 0x0c, 0x98, 0x10, 0x99, 0xc0, 0x8f, 0x81, 0xf8, 0xeb, 0xd0,
+  0x00, 0x09, 0x01, 0x80, 0x09, 0x00, 0xd1, 0x00, 0xf7, 0xff, 0xf7, 0x35,
+  0xfb, 0x0b, 0x98, 0x20, 0x99, 0x30, 0xff, 0xf9, 0x11, 0x00, 0x02, 0x90,
+  0x0c, 0x98, 0x41, 0xff, 0x6b, 0x81, 0x63, 0xf8, 0xf7, 0xfe, 0xf9, 0x0c,
+  0xff, 0x9d, 0x68, 0x63, 0x28, 0x6b, 0x40, 0x1c, 0x28, 0xff, 0x63, 0x20,
+  0x98, 0x06, 0xeb, 0x80, 0x00, 0x11, 0xbf, 0x90, 0x02, 0x98, 0xfc, 0xf7,
+  0x6e, 0x83, 0x60, 0xb8, 0xaf, 0x18, 0xfc, 0xf7, 0x84, 0x07, 0x00, 0xb4,
+  0x07, 0x00, 0x80, 0xff, 0xf9, 0x00, 0xf0, 0xac, 0xfa, 0x11, 0x99, 0x88,
+  0xff, 0x60, 0x02, 0x98, 0x68, 0x61, 0x03, 0x98, 0x68, 0xff, 0x62, 0xb5,
+  0xf8, 0x40, 0x00, 0x30, 0xb9, 0x08, 0xff, 0x98, 0x00, 0xf0, 0xd1, 0xfb,
+  0x49, 0xf2, 0x80, 0xff, 0x28, 0x06, 0x25, 0x8b, 0xe2, 0x00, 0x20, 0x07,
+  0xff, 0x90, 0x00, 0x90, 0x06, 0x90, 0x05, 0x90, 0x04, 0xeb, 0x90, 0x09,
+  0x1f, 0x10, 0xcb, 0x67, 0x10, 0x1e, 0xd1, 0x10, 0xff, 0x98, 0x90, 0xf8,
+  0xd0, 0x10, 0x09, 0x98, 0xff, 0x77, 0xf7, 0x7e, 0xfc, 0x2d, 0x90, 0x87,
+  0x60, 0x20, 0x8f, 0x51, 0xff, 0x20, 0x98, 0xf8, 0xf7, 0x27, 0xfe, 0x20,
+  0x98, 0xfb, 0x80, 0x19, 0x45, 0xc0, 0x20, 0x01, 0x99, 0x08, 0x71, 0xff,
+  0x00, 0xf0, 0x7f, 0xfa, 0x00, 0x8c, 0x50, 0xb9, 0xdf, 0x01, 0x99, 0x88,
+  0x70, 0x87, 0x21, 0x00, 0x4f, 0xf0, 0xef, 0x00, 0x0b, 0x85, 0xe0, 0x47,
+  0x01, 0xda, 0xfb, 0x5d, 0x57, 0xe2, 0x20, 0x98, 0xcd, 0xb1, 0x01, 0x7d,
+  0xe0, 0xee, 0x57, 0xf0, 0xff, 0xec, 0xe7, 0x00, 0x26, 0x12, 0xaa, 0x12,
+  0xa8, 0xff, 0x32, 0xf9, 0x26, 0x20, 0x00, 0xeb, 0x86, 0x0a, 0xff, 0xd3,
+  0x17, 0xa2, 0xfb, 0x02, 0x49, 0xba, 0xf9, 0xff, 0x02, 0x00, 0x02, 0xfb,
+  0x03, 0x99, 0x03, 0xfb, 0xff, 0x02, 0x99, 0xc1, 0x17, 0xa0, 0xfb, 0x00,
+  0x23, 0xef, 0x00, 0xfb, 0x01, 0x33, 0x41, 0x10, 0x33, 0x49, 0x46, 0xff,
+  0xa0, 0x18, 0x59, 0x41, 0xfc, 0xf7, 0xd0, 0xf8, 0xff, 0x07, 0x99, 0xfc,
+  0xf7, 0x0b, 0xfa, 0x07, 0x90, 0xfd, 0x19, 0xe5, 0x70, 0x86, 0x07, 0x30,
+  0xf9, 0x26, 0x00, 0xde, 0x29, 0x03, 0xb7, 0xf9, 0x02, 0x40, 0x2d, 0x05,
+  0x4f, 0xea, 0xf7, 0xe4, 0x79, 0xa4, 0x65, 0x30, 0x04, 0xfb, 0x09, 0x11,
+  0xdf, 0x09, 0xfb, 0x04, 0x11, 0x10, 0x3b, 0x02, 0xb2, 0xf8, 0x1d, 0x00,
+  0x3b, 0x00, 0xed, 0xf9, 0x00, 0x3b, 0x00, 0x2d, 0x01, 0x3b, 0x00, 0x9d,
+  0x70, 0x71, 0x00, 0x20, 0x12, 0xa8, 0x2f, 0x01, 0x0d, 0x00, 0xc0, 0x5d,
+  0xa2, 0x33, 0x00, 0xd3, 0x17, 0x02, 0x35, 0x00, 0x03, 0x35, 0x00, 0xff,
+  0xcc, 0xfb, 0x07, 0x01, 0xfc, 0xf7, 0x97, 0xf8, 0xfd, 0x06, 0x35, 0x00,
+  0xd2, 0xf9, 0x06, 0x90, 0x22, 0x46, 0xaf, 0x12, 0xa8, 0x4b, 0x46, 0x71,
+  0x01, 0xa0, 0xab, 0x00, 0xc1, 0x3b, 0x17, 0x00, 0xa9, 0x00, 0x19, 0xa8,
+  0x01, 0xab, 0x00, 0x13, 0x01, 0xf6, 0x49, 0x00, 0x10, 0x81, 0x01, 0x80,
+  0x20, 0x1a, 0x69, 0xeb, 0xdd, 0x01, 0x37, 0x00, 0x7b, 0xf8, 0x05, 0x37,
+  0x00, 0xb6, 0xf9, 0xff, 0x76, 0x1c, 0x07, 0x2e, 0x05, 0x90, 0x88, 0xd3,
+  0xbf, 0x0b, 0xf1, 0x01, 0x0b, 0x00, 0xf0, 0xe9, 0xc0, 0x8b, 0xef, 0x83,
+  0x45, 0x1a, 0xd2, 0x77, 0x10, 0x88, 0x07, 0x23, 0xff, 0x12, 0xaa, 0x19,
+  0xa9, 0xff, 0xf7, 0x14, 0xfc, 0xf7, 0xf9, 0xf7, 0x67, 0x17, 0x10, 0x3f,
+  0xf4, 0x75, 0xaf, 0x7f, 0x0c, 0x99, 0x04, 0x20, 0x08, 0x60, 0xab, 0x2b,
+  0x00, 0x16, 0x37, 0x11, 0x3e, 0xfb, 0x05, 0x01, 0x08, 0xed, 0x21, 0x33,
+  0x10, 0x93, 0x13, 0xff, 0x34, 0xfb, 0x04, 0x98, 0x00, 0x28, 0x02, 0xbf,
+  0xff, 0x01, 0x98, 0x00, 0x79, 0x00, 0x28, 0x05, 0xd1, 0xff, 0x01, 0x98,
+  0x80, 0x78, 0x18, 0xb1, 0x0f, 0x25, 0xf6, 0xc3, 0x11, 0xaa, 0xe1, 0x21,
+  0x21, 0x00, 0xeb, 0x41, 0x06, 0x7f, 0x00, 0x24, 0x30, 0x8b, 0xc0, 0xeb,
+  0xc0, 0x11, 0x80, 0x7f, 0x69, 0xf8, 0x07, 0x46, 0x00, 0x98, 0x39, 0x1f,
+  0x90, 0xdf, 0x7e, 0xf8, 0xfc, 0xf7, 0xb0, 0x07, 0x20, 0xa1, 0xf9, 0x57,
+  0x80, 0x46, 0x07, 0x11, 0x02, 0x75, 0x11, 0x00, 0xa7, 0x11, 0x00, 0xff,
+  0x98, 0xf9, 0x04, 0x90, 0x01, 0x98, 0x07, 0x78, 0xdf, 0xb0, 0x8a, 0xfc,
+  0xf7, 0x5b, 0xfd, 0x70, 0x88, 0x16, 0xef, 0xfc, 0xf7, 0x67, 0xf8, 0x53,
+  0x91, 0xe0, 0xf9, 0x38, 0xae, 0x6d, 0x80, 0x0b, 0xd3, 0x30, 0x19, 0x00,
+  0x4e, 0x19, 0x00, 0x6c, 0x7a, 0x19, 0x00, 0x5a, 0x19, 0x02, 0xd3, 0xf9,
+  0x12, 0xd2, 0x93, 0x00, 0xff, 0x2f, 0x0f, 0xd8, 0xdf, 0xe8, 0x07, 0xf0,
+  0x03, 0xff, 0x0a, 0x05, 0x03, 0x03, 0x00, 0x18, 0xb9, 0x05, 0xff, 0xe0,
+  0x08, 0xb9, 0x04, 0x24, 0x05, 0xe0, 0x02, 0xfb, 0x24, 0x03, 0x09, 0x00,
+  0x01, 0x24, 0x00, 0xe0, 0x03, 0xfb, 0x24, 0x01, 0x1b, 0x30, 0x30, 0x76,
+  0x04, 0x70, 0xf7, 0xbf, 0xf7, 0xbf, 0xf9, 0x0c, 0x9e, 0x01, 0x43, 0x40,
+  0x03, 0xdf, 0xf0, 0xb2, 0xfa, 0x00, 0xf0, 0x7d, 0xc0, 0xf0, 0x6b, 0xff,
+  0xf9, 0xfc, 0xf7, 0x2c, 0xfa, 0xb0, 0x62, 0x01, 0xbf, 0x21, 0x04, 0x98,
+  0x03, 0xf0, 0xa7, 0x15, 0x00, 0x56, 0xfa, 0x15, 0x00, 0x60, 0x15, 0x00,
+  0x21, 0xfa, 0xf0, 0x62, 0x01, 0xdf, 0x98, 0x04, 0x78, 0x4c, 0xb9, 0xcf,
+  0x80, 0x61, 0xf0, 0xf7, 0x61, 0x30, 0x62, 0xe1, 0x01, 0xf7, 0xf7, 0xb2,
+  0xf9, 0xbf, 0x0b, 0x25, 0x36, 0xe1, 0x04, 0x98, 0x83, 0x01, 0x15, 0xdf,
+  0xf8, 0x81, 0x46, 0x06, 0x98, 0xd5, 0x11, 0x10, 0xf8, 0xde, 0x29, 0xa0,
+  0x4b, 0x00, 0xf0, 0x65, 0x41, 0x00, 0x31, 0xf9, 0x57, 0x82, 0x46, 0x05,
+  0x15, 0x02, 0x05, 0x19, 0xf0, 0x5c, 0x11, 0x00, 0x7f, 0x28, 0xf9, 0x83,
+  0x46, 0x50, 0x46, 0x51, 0x31, 0x00, 0xdd, 0x8a, 0xfd, 0x10, 0x59, 0x46,
+  0x58, 0x09, 0x00, 0x85, 0xf9, 0xfa, 0x21, 0x01, 0xe6, 0x01, 0x10, 0x26,
+  0xf9, 0x01, 0x2c, 0x1c, 0xff, 0xbf, 0x03, 0x2c, 0x81, 0x46, 0x01, 0x21,
+  0x48, 0xaa, 0x9b, 0x00, 0x64, 0x31, 0x00, 0x13, 0x85, 0x00, 0x1d, 0x85,
+  0x00, 0xde, 0xef, 0xf9, 0xb0, 0x61, 0x51, 0x5f, 0x90, 0x6c, 0x05, 0xfc,
+  0xfb, 0xf7, 0x6c, 0x0f, 0x00, 0xd6, 0xf9, 0xf0, 0x61, 0x59, 0xea, 0x0f,
+  0x00, 0x5c, 0x0f, 0x00, 0x64, 0x0f, 0x00, 0xce, 0xf9, 0x30, 0xef, 0x62,
+  0xf7, 0xf7, 0x68, 0x2d, 0x00, 0x01, 0xf9, 0x81, 0xff, 0x8c, 0x61, 0xb1,
+  0x0c, 0x99, 0x02, 0x9a, 0x89, 0xff, 0x69, 0x00, 0x8d, 0x89, 0x1a, 0x48,
+  0xbf, 0x49, 0xdf, 0x42, 0x88, 0x42, 0x03, 0xda, 0xb5, 0x01, 0x10, 0x25,
+  0x7f, 0xdd, 0xe0, 0x03, 0xa8, 0x00, 0x88, 0xfb, 0x71, 0xb0, 0x5d, 0x06,
+  0x3d, 0x00, 0x2c, 0x05, 0x31, 0x81, 0x00, 0x44, 0x9b, 0x30, 0xff, 0x24,
+  0x15, 0xfb, 0xf7, 0xb2, 0xff, 0x00, 0xf0, 0x7d, 0xde, 0xd5, 0xa0, 0x08,
+  0x98, 0x43, 0x46, 0x4a, 0xe7, 0xd0, 0xfd, 0xe4, 0x9d, 0x40, 0xfc, 0xf7,
+  0xa1, 0xf9, 0x10, 0xf1, 0xff, 0x01, 0x0f, 0x18, 0xbf, 0x10, 0xf1, 0x02,
+  0x0f, 0xff, 0x49, 0xf2, 0xb2, 0x28, 0x05, 0xd0, 0x10, 0xf1, 0xfd, 0x03,
+  0x0f, 0x02, 0x04, 0x0f, 0x03, 0xd1, 0x0c, 0x99, 0xff, 0x03, 0x98, 0x48,
+  0x62, 0x29, 0xe0, 0x11, 0x99, 0xf7, 0x89, 0x68, 0x20, 0x97, 0x80, 0x90,
+  0xff, 0x82, 0x46, 0xff, 0x0b, 0x9c, 0x20, 0x98, 0x04, 0xeb, 0x40, 0x09,
+  0xbf, 0xb9, 0xf8, 0x04, 0x00, 0x20, 0xb9, 0x21, 0x03, 0x09, 0xb7, 0x25,
+  0xa0, 0xe0, 0x21, 0x21, 0x10, 0xb1, 0x87, 0x01, 0x5f, 0xef, 0xe0, 0xb9,
+  0xf8, 0x1c, 0xfd, 0x80, 0x69, 0xff, 0x4f, 0xff, 0xf0, 0x5e, 0x51, 0xfc,
+  0xf7, 0x03, 0xf9, 0x01, 0x7b, 0x46, 0x04, 0x2d, 0x40, 0xed, 0xf8, 0x06,
+  0xd2, 0x2f, 0x03, 0x7f, 0x49, 0xf2, 0xcb, 0x28, 0x07, 0x25, 0x86, 0x27,
+  0x00, 0xf5, 0x0c, 0x27, 0x00, 0x55, 0x8f, 0xa0, 0x88, 0x14, 0xfc, 0xf7,
+  0x57, 0xef, 0xf8, 0x80, 0x1b, 0x10, 0x50, 0x1b, 0x10, 0xd6, 0xe9, 0x00,
+  0x7f, 0x85, 0xf8, 0x00, 0x90, 0x00, 0xf0, 0xb3, 0x09, 0x00, 0xfb, 0x80,
+  0xf8, 0xc7, 0x02, 0xf8, 0x82, 0x46, 0x11, 0xe0, 0x7f, 0x4f, 0xf0, 0x7c,
+  0x50, 0x00, 0xf0, 0xa8, 0x5b, 0x20, 0xd5, 0x00, 0x53, 0x40, 0xa4, 0x1d,
+  0x00, 0x71, 0x1d, 0x02, 0x35, 0xf8, 0x5f, 0x0c, 0x99, 0x82, 0x46, 0x08,
+  0xd5, 0x20, 0x50, 0x0d, 0x00, 0xff, 0x36, 0xf9, 0x0f, 0xfa, 0x80, 0xfb,
+  0xbb, 0xf5, 0x7f, 0x52, 0x7f, 0xe6, 0xd2, 0xb9, 0xf8, 0x08, 0x63, 0x00,
+  0xdd, 0x23, 0xfd, 0x00, 0x5c, 0xf8, 0x06, 0x93, 0x10, 0xfb, 0xf7, 0xd7,
+  0x13, 0xff, 0x01, 0x17, 0x70, 0xfc, 0x27, 0x20, 0x9c, 0xbf, 0xef, 0xb2,
+  0x46, 0x0a, 0x25, 0x31, 0x01, 0x1d, 0xf9, 0x06, 0x7d, 0x46, 0xc1, 0x01,
+  0x49, 0xf2, 0xe4, 0x28, 0x08, 0xe7, 0x20, 0xfd, 0x38, 0x9b, 0x00, 0x2e,
+  0x00, 0xb9, 0xf8, 0x32, 0x20, 0xff, 0x11, 0x18, 0x82, 0x1a, 0xb6, 0xb2,
+  0xb1, 0x42, 0xde, 0x93, 0xe0, 0x27, 0x00, 0x27, 0x96, 0x07, 0x01, 0x23,
+  0x00, 0xff, 0x23, 0x3b, 0x43, 0x12, 0xd0, 0x20, 0x9b, 0x1b, 0xff, 0x19,
+  0x93, 0xf8, 0x2c, 0x30, 0x13, 0xb1, 0x02, 0xff, 0x2b, 0x02, 0xd0, 0x06,
+  0xe0, 0x06, 0x46, 0x06, 0xff, 0xe0, 0x00, 0x2f, 0x0c, 0xbf, 0x16, 0x46,
+  0x0e, 0xff, 0x46, 0x01, 0xe0, 0x0c, 0x98, 0x46, 0x6a, 0x11, 0xff, 0x25,
+  0x01, 0xe0, 0x49, 0xf6, 0xe4, 0x28, 0x20, 0xff, 0x98, 0x0f, 0xf2, 0xc4,
+  0x34, 0x47, 0x00, 0x30, 0xbf, 0x04, 0x01, 0x0e, 0x34, 0xf8, 0x17, 0xa9,
+  0x70, 0xcd, 0xff, 0xf9, 0x04, 0xeb, 0x47, 0x00, 0xf1, 0xb2, 0x40, 0xff,
+  0x88, 0xf8, 0xf7, 0xc7, 0xf9, 0x0c, 0x98, 0xb6, 0xff, 0xb2, 0x46, 0x62,
+  0x42, 0x46, 0x0c, 0x98, 0x29, 0xea, 0xfd, 0x00, 0x17, 0x53, 0xa0, 0x21,
+  0x0b, 0xc2, 0x4f, 0xf0, 0x64, 0xf6, 0x3f, 0x10, 0x63, 0xb8, 0x45, 0x31,
+  0x60, 0xb8, 0x01, 0x46, 0xcb, 0xd9, 0x48, 0x11, 0x30, 0xba, 0x7d, 0x34,
+  0x3d, 0xe0, 0xcf, 0x49, 0xf7, 0xfc, 0xf7, 0x54, 0xdf, 0xf0, 0xf6, 0x4f,
+  0x04, 0x46, 0xdf, 0x1d, 0x46, 0x87, 0xb0, 0x28, 0xb9, 0xa0, 0xfc, 0xf7,
+  0xdf, 0x39, 0xf8, 0x04, 0xd2, 0x20, 0xe1, 0x10, 0x18, 0xf9, 0xff, 0xce,
+  0x48, 0x08, 0xe1, 0x60, 0x88, 0x10, 0x28, 0xbf, 0x1d, 0xda, 0x0c, 0x22,
+  0x07, 0x99, 0xe3, 0x70, 0x40, 0xdf, 0x01, 0x61, 0x60, 0x88, 0x08, 0x09,
+  0x02, 0x41, 0x61, 0xef, 0x29, 0x46, 0x60, 0x88, 0x09, 0x01, 0x85, 0x61,
+  0xa0, 0xfe, 0x9f, 0xc0, 0x1e, 0xf8, 0x38, 0xbf, 0xa5, 0x60, 0x03, 0xef,
+  0xd3, 0x00, 0xf0, 0xf2, 0x09, 0x00, 0xe5, 0x60, 0x60, 0xff, 0x88, 0x40,
+  0x1c, 0x60, 0x80, 0x08, 0x98, 0xe7, 0xbf, 0xe0, 0x8b, 0x46, 0x00, 0x26,
+  0x8a, 0xb9, 0xa0, 0x89, 0xff, 0x46, 0x02, 0x91, 0x06, 0x91, 0x05, 0x91,
+  0xad, 0xbf, 0xf8, 0x10, 0x10, 0x00, 0x27, 0x0c, 0x93, 0x70, 0x07, 0xfb,
+  0x40, 0x03, 0xe7, 0x20, 0x00, 0x69, 0x01, 0x90, 0x7f, 0xff, 0x1c, 0xfb,
+  0xf7, 0x73, 0xff, 0x83, 0x46, 0x03, 0xbf, 0x98, 0x40, 0x69, 0x00, 0x90,
+  0x31, 0x65, 0x10, 0x6c, 0xb8, 0x83, 0x20, 0x3d, 0x40, 0xfd, 0x20, 0x03,
+  0xf8, 0x49, 0x0f, 0x00, 0x64, 0xed, 0xff, 0xf9, 0x20, 0x98, 0x01, 0x09,
+  0x00, 0xfb, 0xff, 0x51, 0xea, 0x05, 0x00, 0x5c, 0x4b, 0x20, 0x00, 0x0f,
+  0x02, 0xf3, 0xff, 0x41, 0xfe, 0x05, 0x00, 0x54, 0xff, 0x10, 0x2f, 0x80,
+  0x46, 0xd3, 0xdf, 0xd3, 0x4f, 0xf0, 0x83, 0x40, 0x1f, 0x01, 0xe8, 0xff,
+  0x5d, 0x07, 0xad, 0x10, 0x00, 0xf0, 0xaf, 0xb3, 0x20, 0x38, 0x0f, 0x00,
+  0xef, 0xd0, 0xfe, 0x07, 0x46, 0x1b, 0x01, 0x00, 0xf0, 0xa9, 0x96, 0x27,
+  0x20, 0x30, 0x46, 0x63, 0x01, 0xd6, 0xc9, 0x10, 0x3d, 0xb1, 0xc2, 0x51,
+  0xfe, 0x3d, 0xa0, 0x1b, 0x00, 0x67, 0x01, 0xcc, 0x67, 0x00, 0x58, 0x1d,
+  0x02, 0xf5, 0xc7, 0x1d, 0x00, 0x48, 0x07, 0x00, 0xb3, 0xfe, 0x81, 0x46,
+  0xf7, 0x8c, 0x49, 0x38, 0x43, 0x10, 0xc6, 0xf8, 0x21, 0xd8, 0xfd, 0x40,
+  0x07, 0x00, 0xc2, 0xf8, 0x1d, 0xd8, 0x01, 0x20, 0xf8, 0xc7, 0x00, 0x4d,
+  0xa0, 0x5b, 0x01, 0xb2, 0xff, 0xfb, 0xf7, 0x56, 0xbe, 0x2d, 0x04, 0x1e,
+  0xfe, 0x05, 0x90, 0x39, 0x09, 0x02, 0x19, 0xab, 0xfe, 0x02, 0x81, 0x20,
+  0x6f, 0x7f, 0x00, 0x30, 0xfb, 0x21, 0xfe, 0xff, 0x4f, 0xf0, 0x76, 0x51,
+  0xfb, 0xf7, 0x9c, 0xff, 0xff, 0x06, 0x90, 0x29, 0x46, 0xe0, 0x68, 0xfb,
+  0xf7, 0xff, 0x85, 0xff, 0x03, 0xd2, 0xa1, 0x68, 0x00, 0xf0, 0xdf, 0x5b,
+  0xf8, 0x26, 0xd3, 0xbd, 0x4b, 0x00, 0x20, 0xb1, 0xff, 0x05, 0x98, 0x73,
+  0x49, 0xfb, 0xf7, 0x79, 0xff, 0xff, 0x01, 0xd2, 0x72, 0x4a, 0x1d, 0xe0,
+  0x02, 0x99, 0xff, 0x07, 0x98, 0xfb, 0xf7, 0x84, 0xff, 0x06, 0x99, 0x7f,
+  0xfb, 0xf7, 0xe5, 0xfe, 0x08, 0x99, 0x06, 0x45, 0x00, 0xdd, 0x6d, 0xa7,
+  0xc0, 0xfb, 0xf7, 0x68, 0x39, 0x00, 0x08, 0x98, 0xfa, 0xa3, 0x01, 0x65,
+  0x17, 0x00, 0xfb, 0xf7, 0xe4, 0xfd, 0x67, 0xfe, 0xc9, 0x10, 0x77, 0xf8,
+  0x98, 0xbf, 0x4f, 0xf0, 0x40, 0xff, 0x42, 0x00, 0xd9, 0x08, 0x9a, 0xa0,
+  0x88, 0x0c, 0xfe, 0x71, 0x80, 0x00, 0x40, 0x07, 0x99, 0x01, 0x61, 0x0c,
+  0x77, 0x21, 0xa0, 0x88, 0x0b, 0x01, 0x08, 0x99, 0x41, 0x0b, 0x06, 0xf3,
+  0x00, 0x23, 0xb5, 0x10, 0xa1, 0x10, 0xc1, 0x10, 0x00, 0xeb, 0xff, 0x11,
+  0x71, 0x09, 0x11, 0xa0, 0xeb, 0x01, 0x10, 0xbb, 0xa0, 0x80, 0x93, 0x11,
+  0x03, 0x40, 0x85, 0x63, 0xb0, 0x29, 0xd6, 0x5b, 0x00, 0x35, 0xff, 0xd1,
+  0x15, 0x09, 0xd1, 0x12, 0x5b, 0x1c, 0xdf, 0x10, 0x2b, 0xed, 0xd3, 0x10,
+  0x5b, 0x83, 0x8f, 0xe1, 0xdd, 0x68, 0x69, 0xc1, 0x23, 0xbf, 0x59, 0x05,
+  0x00, 0x32, 0xbf, 0xbe, 0x81, 0x11, 0x2f, 0xbf, 0x00, 0x21, 0x41, 0x8f,
+  0x80, 0x81, 0x7f, 0x60, 0x45, 0x49, 0xc1, 0x60, 0x70, 0x47, 0x09, 0xd5,
+  0xff, 0xf8, 0xf7, 0xcb, 0xfa, 0x20, 0x68, 0x04, 0xf1, 0x7f, 0x10, 0x01,
+  0xff, 0xf7, 0x9c, 0xf9, 0x05, 0xe9, 0x80, 0xfb, 0xe0, 0x69, 0x05, 0x90,
+  0x01, 0x20, 0x68, 0xff, 0xf7, 0xfb, 0xef, 0xf9, 0x05, 0x01, 0xd1, 0xf9,
+  0x05, 0x46, 0x01, 0xaf, 0x2d, 0x0b, 0xd0, 0x02, 0x03, 0x00, 0x0c, 0x03,
+  0x00, 0x11, 0xfa, 0x03, 0x00, 0x13, 0x03, 0x00, 0x14, 0x2d, 0x08, 0xbf,
+  0x0d, 0x7f, 0x25, 0x08, 0xe0, 0x02, 0x25, 0x06, 0xe0, 0x63, 0xc1, 0xff,
+  0x0e, 0x25, 0x02, 0xe0, 0x03, 0x25, 0x00, 0xe0, 0xb7, 0x0c, 0x25, 0x20,
+  0x3f, 0x10, 0x4b, 0xfb, 0x3b, 0xd5, 0xf8, 0xf7, 0xf7, 0x89, 0xfd, 0x3b,
+  0xd1, 0x03, 0xf0, 0x5f, 0xfa, 0x7e, 0x3b, 0xd1, 0x10, 0x00, 0xfa, 0xf7,
+  0x89, 0xfa, 0x3b, 0xd3, 0x7f, 0xf8, 0xf7, 0xe9, 0xba, 0x12, 0x4a, 0x22,
+  0x73, 0x20, 0xfc, 0x9d, 0xa1, 0x2d, 0x01, 0x0e, 0x49, 0x01, 0xeb, 0x44,
+  0x01, 0xdf, 0x09, 0x8c, 0x29, 0xb1, 0x01, 0xeb, 0x70, 0x0b, 0xfa, 0xfd,
+  0x10, 0x4f, 0xb0, 0x00, 0xe0, 0x00, 0x20, 0x06, 0x49, 0xff, 0x61, 0x18,
+  0x88, 0x70, 0x8a, 0x78, 0x50, 0x1e, 0xff, 0x80, 0x41, 0xc0, 0x0f, 0x08,
+  0x71, 0x10, 0xbd, 0xff, 0x00, 0x00, 0xa0, 0xef, 0x00, 0x20, 0xc4, 0xe6,
+  0xaa, 0xdb, 0x50, 0x26, 0xa3, 0xa3, 0xd8, 0x07, 0x00, 0xc0, 0x03, 0x00,
+  0xd4, 0xed, 0xac, 0xd3, 0xa1, 0xc8, 0x42, 0x21, 0x00, 0x41, 0x00, 0x00,
+  0xbf, 0x7a, 0x44, 0xcd, 0xcc, 0x4c, 0x3d, 0x0b, 0x00, 0xc1, 0xcf, 0x0a,
+  0xd7, 0x23, 0x3c, 0xe3, 0xb0, 0x13, 0x00, 0x80, 0xc0, 0x7f, 0x70, 0x12,
+  0x83, 0x3a, 0xcd, 0xcc, 0xcc, 0x17, 0x00, 0xf7, 0x40, 0xc0, 0xce, 0x1f,
+  0x00, 0xec, 0x78, 0xad, 0x60, 0xff, 0x61, 0x09, 0x60, 0x09, 0x63, 0x09,
+  0x62, 0x09, 0xff, 0x01, 0x22, 0x41, 0x1c, 0x03, 0xe0, 0x0a, 0x46, 0xff,
+  0xb0, 0xfb, 0xf2, 0xf1, 0x89, 0x18, 0x49, 0x08, 0xfd, 0x8a, 0x89, 0x50,
+  0x52, 0x42, 0x02, 0x2a, 0xf5, 0xda, 0xff, 0x01, 0xfb, 0x01, 0xf2, 0x90,
+  0x42, 0x38, 0xbf, 0xff, 0x49, 0x1e, 0xf9, 0xd3, 0x08, 0x46, 0x70, 0x47,
+  0xff, 0x30, 0xb5, 0x4f, 0xf4, 0x80, 0x53, 0x03, 0x60, 0xff, 0x41, 0x60,
+  0x02, 0x23, 0x00, 0xeb, 0x83, 0x05, 0xfe, 0xc9, 0x70, 0xf4, 0x55, 0xf8,
+  0x04, 0x5c, 0x6c, 0x43, 0xff, 0x64, 0x0b, 0x40, 0xf8, 0x23, 0x40, 0x5b,
+  0x1c, 0xbf, 0x08, 0x2b, 0xf2, 0xdb, 0x30, 0xbd, 0x1f, 0xe1, 0x06, 0xfd,
+  0x9e, 0x87, 0xa1, 0x26, 0xfa, 0x05, 0xfe, 0x5f, 0xea, 0xff, 0xce, 0x7e,
+  0x4f, 0xea, 0xd5, 0x0c, 0x05, 0xf0, 0xdf, 0x07, 0x07, 0x49, 0xd5, 0xbc,
+  0x93, 0x50, 0x01, 0xeb, 0xdf, 0x87, 0x07, 0x11, 0xd0, 0xbc, 0xad, 0x50,
+  0x05, 0xd1, 0xff, 0x3f, 0x6a, 0xb2, 0xf9, 0x00, 0xc0, 0xb2, 0xf9, 0x7f,
+  0x02, 0xe0, 0x1f, 0xe0, 0x3f, 0x68, 0xbc, 0xbb, 0x50, 0xdf, 0xf6, 0xd1,
+  0xb2, 0xf9, 0x04, 0x11, 0x00, 0x06, 0xe0, 0xff, 0x16, 0xe0, 0x93, 0xb1,
+  0x5f, 0xea, 0x83, 0x7c, 0xff, 0x4c, 0xbf, 0x3f, 0x6c, 0x3f, 0x6a, 0x5f,
+  0xea, 0xef, 0xc3, 0x7c, 0xe8, 0xd5, 0x93, 0x80, 0xc0, 0xb2, 0xf8, 0xff,
+  0x04, 0xe0, 0xb2, 0xf8, 0x06, 0x80, 0xf4, 0x44, 0xff, 0xb2, 0xf8, 0x02,
+  0xe0, 0xc6, 0x44, 0x02, 0xe0, 0xff, 0x00, 0x27, 0xbe, 0x46, 0xbc, 0x46,
+  0x0f, 0xfa, 0xff, 0x8c, 0xfc, 0x07, 0xfb, 0x0c, 0xfc, 0x4f, 0xea, 0xff,
+  0x6c, 0x28, 0x0c, 0xeb, 0x98, 0x5c, 0x4f, 0xea, 0xff, 0xac, 0x2c, 0x40,
+  0xf8, 0x34, 0xc0, 0x0f, 0xfa, 0xff, 0x8e, 0xfe, 0x07, 0xfb, 0x0e, 0xf7,
+  0x4f, 0xea, 0xff, 0x67, 0x2c, 0x07, 0xeb, 0x9c, 0x57, 0x00, 0xeb, 0xff,
+  0xc4, 0x0c, 0x64, 0x1c, 0xbf, 0x12, 0x15, 0x2c, 0xff, 0xcc, 0xf8, 0x04,
+  0x70, 0x02, 0xd2, 0x6d, 0x1c, 0xb7, 0x20, 0x2d, 0xa9, 0x5b, 0xb0, 0xf0,
+  0x81, 0x57, 0xb1, 0x00, 0xff, 0x24, 0x61, 0xe0, 0x00, 0x26, 0x00, 0xeb,
+  0x44, 0xff, 0x05, 0xa8, 0x27, 0x07, 0xfb, 0x04, 0x27, 0x07, 0xff, 0xeb,
+  0xc6, 0x07, 0x57, 0xf8, 0xa8, 0xef, 0x95, 0xff, 0xf9, 0x01, 0x80, 0xd7,
+  0xf8, 0x04, 0x90, 0x10, 0xff, 0xf9, 0x14, 0xc0, 0x09, 0xfb, 0x08, 0xf8,
+  0x0e, 0x7f, 0xfb, 0x0c, 0x8c, 0x52, 0xf8, 0x36, 0xe0, 0x6d, 0x00, 0xfd,
+  0x18, 0x6d, 0x00, 0x6c, 0x0e, 0xeb, 0xac, 0x1c, 0x42, 0xd7, 0xf8, 0x36,
+  0xc0, 0x23, 0x00, 0xe0, 0x23, 0x01, 0x3f, 0x68, 0xfa, 0x21, 0x00, 0xfc,
+  0x35, 0x00, 0xe0, 0x07, 0xfb, 0x1e, 0xc7, 0x6f, 0x02, 0xeb, 0xc6, 0x0c,
+  0x7f, 0x00, 0x18, 0xdc, 0x1d, 0x00, 0xff, 0x07, 0xeb, 0x98, 0x67, 0x76,
+  0x1c, 0x0e, 0xeb, 0xef, 0xa7, 0x17, 0x15, 0x2e, 0x81, 0x01, 0xca, 0xd3,
+  0x03, 0xf7, 0xeb, 0xc4, 0x06, 0x29, 0x01, 0xd6, 0xf8, 0x0c, 0x80, 0xfe,
+  0x3b, 0x00, 0x70, 0xd6, 0xf8, 0x08, 0xc0, 0x08, 0xfb, 0x7f, 0x0e, 0xfe,
+  0x0c, 0xfb, 0x07, 0xe7, 0xd3, 0xf1, 0x00, 0x7e, 0x39, 0x00, 0x1e, 0x07,
+  0xeb, 0x9e, 0x67, 0x0c, 0x33, 0x00, 0xcb, 0x1f, 0x60, 0x25, 0x00, 0xc0,
+  0x25, 0x01, 0x31, 0x00, 0x50, 0xb6, 0xfd, 0x68, 0x23, 0x00, 0xf7, 0x06,
+  0xfb, 0x15, 0x75, 0x5e, 0xff, 0x68, 0x6f, 0x11, 0x05, 0xeb, 0x97, 0x65,
+  0x06, 0xff, 0xeb, 0xa5, 0x15, 0x5d, 0x60, 0x64, 0x1c, 0x8c, 0xcb, 0x42,
+  0x9b, 0xd3, 0x01, 0x83, 0xd3, 0x00, 0x53, 0x50, 0xad, 0xf2, 0xff, 0x5c,
+  0x4d, 0xa0, 0x68, 0x00, 0x88, 0xc0, 0xf3, 0xff, 0x01, 0x1a, 0x20, 0x68,
+  0x0f, 0x46, 0x81, 0x88, 0xdb, 0x08, 0x0a, 0x31, 0xc0, 0x00, 0x8d, 0xfb,
+  0x60, 0x90, 0x46, 0xb7, 0x01, 0xf0, 0x0f, 0x09, 0x00, 0x05, 0x00, 0x4d,
+  0xf0, 0xeb, 0xfb, 0x85, 0x00, 0xf9, 0xb0, 0x00, 0x38, 0xf9, 0x25, 0x10,
+  0xff, 0x00, 0xf0, 0x63, 0xfb, 0xa1, 0x68, 0x91, 0xf8, 0xdf, 0x24, 0x20,
+  0x01, 0x46, 0xde, 0x3d, 0xa0, 0x45, 0x10, 0xff, 0xff, 0xf7, 0xfd, 0xfe,
+  0x6d, 0x1c, 0x07, 0x2d, 0xff, 0xeb, 0xd3, 0x00, 0x20, 0x02, 0xae, 0x37,
+  0xf9, 0xff, 0x20, 0x10, 0x46, 0xf8, 0x30, 0x10, 0x02, 0xaa, 0xff, 0x07,
+  0xeb, 0x80, 0x01, 0x02, 0xeb, 0xc0, 0x02, 0xfd, 0xb1, 0xd3, 0x90, 0x51,
+  0x60, 0x40, 0x1c, 0x05, 0x28, 0xdf, 0xf0, 0xd3, 0x00, 0x27, 0xa8, 0x23,
+  0x30, 0x00, 0xf0, 0xff, 0x29, 0xf8, 0x7f, 0x1c, 0x57, 0x45, 0xfa, 0xd3,
+  0xff, 0x05, 0x2f, 0x1f, 0xd2, 0x00, 0xf0, 0x22, 0xf8, 0xff, 0xa7, 0xeb,
+  0x0a, 0x0b, 0x0c, 0xa8, 0x05, 0xfb, 0xf7, 0x0b, 0x09, 0x02, 0x53, 0x00,
+  0xcb, 0x03, 0xa0, 0x68, 0xfd, 0x4a, 0x69, 0x80, 0x0e, 0x30, 0xff, 0xf7,
+  0x40, 0xff, 0xff, 0x20, 0x69, 0x9d, 0xf8, 0x05, 0x30, 0xc0, 0xb2, 0xfe,
+  0x53, 0xb0, 0xeb, 0xcb, 0x02, 0x7f, 0x1c, 0xd2, 0xe9, 0xef, 0x00, 0x01,
+  0x0a, 0x46, 0xcd, 0x41, 0xfe, 0xf7, 0x6d, 0x8f, 0xff, 0xdd, 0xe7, 0x0d,
+  0xc5, 0x00, 0xf1, 0x31, 0xc9, 0x00, 0x6a, 0xff, 0x9d, 0xf8, 0x04, 0x30,
+  0x00, 0x90, 0x08, 0xeb, 0xdb, 0x87, 0x02, 0x9b, 0x01, 0x47, 0x11, 0x53,
+  0x01, 0x07, 0x00, 0xdb, 0xc0, 0xe6, 0x43, 0x61, 0xdf, 0xb0, 0xaf, 0xc0,
+  0x20, 0xa2, 0xf7, 0x68, 0xd2, 0x7e, 0xa3, 0x41, 0xa2, 0xff, 0x04, 0xf0,
+  0xff, 0x74, 0xf8, 0xcd, 0xe9, 0x0e, 0x01, 0x20, 0x69, 0xaf, 0x00, 0x28,
+  0x14, 0xbf, 0x9d, 0x80, 0x0b, 0x03, 0x01, 0x04, 0xfe, 0x87, 0xb0, 0x02,
+  0x90, 0x5f, 0x98, 0x02, 0x99, 0xa8, 0x7d, 0x22, 0x59, 0xc1, 0x00, 0x27,
+  0x03, 0x90, 0x04, 0x0d, 0x00, 0xff, 0x00, 0xeb, 0xc1, 0x00, 0x00, 0xeb,
+  0x07, 0x22, 0xdf, 0x00, 0xf0, 0xc5, 0xf9, 0x04, 0x2d, 0x60, 0x5f, 0x98,
+  0xdd, 0xa8, 0xc1, 0x40, 0x07, 0x00, 0x06, 0x2b, 0x02, 0x00, 0xeb, 0xa7,
+  0xc7, 0x00, 0x07, 0x09, 0x00, 0x25, 0x01, 0x05, 0x3b, 0xc0, 0xb8, 0xbf,
+  0x42, 0x37, 0xd1, 0x38, 0xb1, 0xdd, 0x5d, 0x00, 0x22, 0xbf, 0x46, 0x43,
+  0x46, 0x04, 0xf0, 0x5f, 0x8d, 0x80, 0x88, 0xbf, 0x46, 0x00, 0x25, 0x21,
+  0xe0, 0xa8, 0xeb, 0xd1, 0xf2, 0xdf, 0x05, 0x98, 0x13, 0x18, 0xd3, 0xc7,
+  0x00, 0x07, 0x9b, 0xff, 0xd6, 0x18, 0xd6, 0xe9, 0x00, 0x23, 0x04, 0xf0,
+  0xf5, 0xc2, 0xbd, 0x70, 0x03, 0x3f, 0x00, 0xc5, 0x02, 0x89, 0x46, 0xfe,
+  0xe1, 0x01, 0x06, 0x9a, 0x02, 0xeb, 0xc5, 0x0c, 0x6d, 0xab, 0x1c, 0xdc,
+  0x1d, 0x02, 0xb3, 0x83, 0x90, 0x7f, 0x0d, 0x80, 0x6c, 0xfe, 0x7b, 0x02,
+  0xbd, 0x42, 0xdb, 0xdb, 0x20, 0x46, 0x41, 0xfe, 0x57, 0x00, 0x79, 0xf9,
+  0x03, 0x9a, 0x02, 0x9b, 0x02, 0x8f, 0xeb, 0xc3, 0x02, 0x5c, 0x71, 0xd0,
+  0x87, 0x01, 0x2b, 0x40, 0xeb, 0xef, 0xc7, 0x02, 0x00, 0x25, 0x39, 0x80,
+  0xf9, 0x40, 0xe0, 0xf8, 0xd7, 0x90, 0x51, 0x00, 0x4f, 0x01, 0xcd, 0xe9,
+  0x0c, 0x01, 0x00, 0x7f, 0xf0, 0x46, 0xf9, 0xcd, 0xe9, 0x0a, 0x01, 0x83,
+  0x03, 0xed, 0x07, 0x83, 0x00, 0x6d, 0x1c, 0x85, 0x01, 0xcd, 0xe9, 0x08,
+  0xff, 0x01, 0x05, 0x98, 0x10, 0x18, 0xd0, 0xe9, 0x00, 0xd3, 0xab, 0xdd,
+  0x0b, 0x00, 0xeb, 0x91, 0xcd, 0x17, 0x00, 0xdd, 0xe9, 0xf7, 0x0a, 0x23,
+  0xdd, 0x37, 0x00, 0x04, 0xf0, 0x73, 0xf8, 0x5d, 0xdd, 0x87, 0x00, 0x03,
+  0xf0, 0xfb, 0x67, 0x80, 0x2a, 0x83, 0x02, 0x2e, 0x17, 0x01, 0x00, 0xf0,
+  0x14, 0x25, 0xa0, 0x8b, 0x0b, 0x00, 0x27, 0x01, 0x7d, 0x08, 0x27, 0x00,
+  0x5f, 0xf8, 0x02, 0x46, 0x0b, 0x25, 0xa0, 0x55, 0x59, 0x9b, 0x00, 0xa3,
+  0xaf, 0x00, 0x25, 0x77, 0x80, 0x89, 0xaf, 0x00, 0x7f, 0xba, 0xdb, 0x06,
+  0x9a, 0x00, 0xf0, 0x37, 0x11, 0x00, 0xff, 0x20, 0xf9, 0x05, 0x9a, 0xa8,
+  0x23, 0x03, 0xfb, 0xd2, 0x49, 0x11, 0x0e, 0xbd, 0x01, 0xad, 0x00, 0xc2,
+  0x6b, 0x00, 0x02, 0x98, 0xff, 0x7f, 0x1c, 0xb8, 0x42, 0xbf, 0xf6, 0x49,
+  0xaf, 0xff, 0x40, 0x1c, 0x15, 0x28, 0x02, 0x90, 0xff, 0xf6, 0xcf, 0x3d,
+  0xaf, 0x00, 0x27, 0xa5, 0xb0, 0x73, 0x10, 0x7d, 0x1e, 0xff, 0xd2, 0xe9,
+  0x2a, 0x01, 0x03, 0xf0, 0x8e, 0xff, 0x79, 0x04, 0x69, 0x90, 0x6b, 0x11,
+  0x00, 0xf5, 0xa8, 0x52, 0x4f, 0x10, 0xeb, 0xf0, 0xff, 0x35, 0x10, 0x89,
+  0x8b, 0x16, 0x03, 0x90, 0x3d, 0xea, 0x5b, 0x20, 0xd4, 0xd5, 0x10, 0x06,
+  0x9b, 0x00, 0xf5, 0xf8, 0x00, 0xff, 0xeb, 0x05, 0x10, 0x02, 0x90, 0x5b,
+  0x46, 0x0a, 0x56, 0x0b, 0x20, 0x05, 0x12, 0x05, 0x11, 0x52, 0x97, 0x00,
+  0x0d, 0x1f, 0x00, 0xfc, 0xdb, 0x00, 0x4d, 0x30, 0xdd, 0xe9, 0x06, 0x23,
+  0xdc, 0xe9, 0x55, 0x02, 0xb7, 0x00, 0x03, 0xdf, 0x04, 0x8b, 0xdf, 0x00,
+  0xba, 0xab, 0x10, 0xd2, 0x31, 0x02, 0x1c, 0xe5, 0x01, 0x21, 0x01, 0x00,
+  0x7b, 0x00, 0xf2, 0xff, 0xe8, 0x31, 0x01, 0x39, 0x01, 0x31, 0x00, 0x23,
+  0xe1, 0x01, 0x03, 0xf0, 0xe8, 0xe2, 0x2d, 0x00, 0x97, 0x99, 0x10, 0x77,
+  0x40, 0x85, 0x00, 0x6d, 0x1e, 0x00, 0xbf, 0x2d, 0xbf, 0xd5, 0x00, 0xf0,
+  0xc3, 0x11, 0x00, 0xad, 0xfe, 0x03, 0x00, 0x9c, 0xf8, 0x0a, 0xaa, 0x02,
+  0xeb, 0x07, 0xef, 0x12, 0x7f, 0x1c, 0xc2, 0x63, 0x00, 0x15, 0x2f, 0x98,
+  0xf7, 0xdb, 0x14, 0x27, 0x57, 0x01, 0x07, 0x10, 0xa8, 0x21, 0xfa, 0x69,
+  0x10, 0x48, 0x0b, 0x03, 0x04, 0x90, 0xd0, 0xe9, 0x02, 0xfb, 0x69, 0x5f,
+  0xe1, 0xe0, 0x07, 0x00, 0x7d, 0x1c, 0x03, 0x4b, 0x90, 0x41, 0xc1, 0x00,
+  0x73, 0xa1, 0x00, 0x85, 0x11, 0x94, 0xc1, 0x01, 0xcd, 0x13, 0xa1, 0x13,
+  0x06, 0x01, 0xc7, 0x04, 0xd1, 0x00, 0x02, 0x46, 0xf5, 0x6d, 0x05, 0x30,
+  0x02, 0xcd, 0x00, 0x03, 0xf0, 0xa6, 0xff, 0xaa, 0xa9, 0x13, 0x08, 0x81,
+  0x10, 0x06, 0xa7, 0x00, 0x9e, 0x93, 0x00, 0x4d, 0x1d, 0xf8, 0x75, 0x21,
+  0x03, 0xf0, 0x24, 0x2f, 0x10, 0xc3, 0x02, 0x4b, 0x00, 0xd3, 0x3f, 0xf8,
+  0xbf, 0x01, 0xad, 0x13, 0x08, 0xf5, 0x02, 0x03, 0xf0, 0xdf, 0x88, 0xff,
+  0x52, 0x46, 0x5b, 0x27, 0x00, 0x10, 0xff, 0xae, 0xb5, 0x11, 0x30, 0x46,
+  0x49, 0x1d, 0x10, 0xc8, 0xcb, 0x02, 0x15, 0xbf, 0x2d, 0xbb, 0xdb, 0x00,
+  0xf0, 0x5e, 0xc5, 0x00, 0x48, 0x7e, 0x03, 0x00, 0x37, 0xf8, 0x04, 0x9a,
+  0x7f, 0x1e, 0xc5, 0x01, 0xaf, 0x9e, 0xd5, 0x00, 0x24, 0x85, 0x01, 0x04,
+  0x4d, 0x12, 0x04, 0x7e, 0x63, 0x20, 0x60, 0x99, 0x41, 0xf8, 0x34, 0x00,
+  0x13, 0x05, 0xfa, 0x4b, 0x11, 0x67, 0x13, 0x00, 0x01, 0xeb, 0xc4, 0x01,
+  0x64, 0xff, 0x1c, 0x15, 0x2c, 0x48, 0x60, 0xe7, 0xdb, 0x61, 0x8c, 0x8f,
+  0x72, 0x69, 0x03, 0x4f, 0xbf, 0x69, 0x01, 0x6b, 0x10, 0x27, 0x00, 0x93,
+  0x99, 0xb8, 0xef, 0x23, 0x49, 0x01, 0x70, 0x47, 0x17, 0x01, 0xd3, 0x23,
+  0x87, 0xed, 0xb8, 0x37, 0x13, 0x4b, 0x46, 0x17, 0x21, 0x32, 0x46, 0x28,
+  0xbe, 0x6b, 0x12, 0x32, 0xbf, 0x32, 0x46, 0x4b, 0x07, 0x00, 0xba, 0xb3,
+  0xbe, 0x05, 0xc3, 0x00, 0xdf, 0x03, 0x28, 0xbf, 0x3b, 0x01, 0x03, 0xb7,
+  0xf0, 0x82, 0xbe, 0x79, 0x31, 0xc7, 0x00, 0x05, 0x21, 0x05, 0xfd, 0x00,
+  0xc5, 0x21, 0x0a, 0xa8, 0x70, 0x47, 0x03, 0x9a, 0xef, 0xdf, 0xf8, 0xa0,
+  0x17, 0x5f, 0x20, 0x0c, 0x00, 0x20, 0xf6, 0x45, 0x33, 0x62, 0xb9, 0xf7,
+  0x41, 0x89, 0xb0, 0x90, 0x46, 0xff, 0x04, 0x46, 0x12, 0x9a, 0x9b, 0x46,
+  0x68, 0x46, 0x6f, 0xff, 0xf7, 0x9f, 0xfc, 0x29, 0x70, 0x21, 0x44, 0xb1,
+  0x40, 0xfd, 0x04, 0xab, 0x40, 0x40, 0x1c, 0x04, 0x28, 0x51, 0x60, 0xfd,
+  0xf7, 0xa7, 0x40, 0x00, 0x25, 0x4f, 0xf0, 0x6a, 0x59, 0xff, 0x2b, 0xfa,
+  0x05, 0xf0, 0xc0, 0x07, 0x27, 0xd5, 0xce, 0xa7, 0x60, 0x00, 0x5d, 0xf8,
+  0x36, 0x30, 0xaf, 0xc0, 0x82, 0x46, 0x6f, 0x58, 0xf8, 0x37, 0x00, 0xc3,
+  0x91, 0x06, 0xfb, 0x91, 0x91, 0xff, 0x03, 0xfb, 0xee, 0x08, 0x54, 0xf8,
+  0x36, 0x10, 0xff, 0xfb, 0xf7, 0x62, 0xfa, 0x51, 0x46, 0x44, 0xf8, 0x7f,
+  0x36, 0x00, 0x04, 0xeb, 0xc6, 0x06, 0x08, 0x8f, 0x00, 0xb7, 0x7f, 0x1c,
+  0x40, 0x07, 0x80, 0xf3, 0xfa, 0x25, 0x01, 0xf0, 0xfb, 0xfa, 0x71, 0x0b,
+  0x00, 0x51, 0xfa, 0x15, 0x2f, 0x70, 0xcd, 0x60, 0x5d, 0x63, 0xd0, 0xd3,
+  0xa9, 0x83, 0x93, 0x01, 0x0d, 0x46, 0x5f, 0x9d, 0xb0, 0x82, 0x46, 0xa8,
+  0x8b, 0x50, 0x00, 0x81, 0x51, 0xbf, 0x04, 0x00, 0x26, 0x0a, 0xeb, 0x86,
+  0x73, 0x52, 0x3a, 0xfb, 0xf9, 0x26, 0x73, 0x50, 0xa9, 0xf8, 0xa9, 0x68,
+  0x20, 0xff, 0x31, 0x0a, 0x79, 0x00, 0x92, 0x05, 0xf1, 0x14, 0xa7, 0x02,
+  0x0b, 0x68, 0x71, 0xc0, 0x71, 0x10, 0x46, 0x7b, 0x50, 0x96, 0xff, 0xff,
+  0x76, 0x1c, 0x03, 0x2e, 0xe7, 0xd3, 0xa0, 0xff, 0x07, 0x4c, 0xbf, 0x40,
+  0x27, 0x20, 0x27, 0xba, 0xfb, 0xf9, 0x06, 0xa5, 0x00, 0x11, 0xf9, 0x04,
+  0xae, 0x05, 0xff, 0x46, 0x71, 0x68, 0xf0, 0x6a, 0xfb, 0xf7, 0x17, 0xe7,
+  0xfa, 0x83, 0x46, 0x57, 0xf0, 0x15, 0x00, 0x06, 0xf9, 0x03, 0xaf, 0x90,
+  0xba, 0xf9, 0x04, 0x09, 0x00, 0x01, 0x61, 0xc0, 0x04, 0xbb, 0x99, 0xb0,
+  0x1d, 0x00, 0x08, 0xfa, 0x81, 0x1d, 0x00, 0x00, 0xfa, 0x13, 0x00, 0xf7,
+  0x81, 0xc0, 0x04, 0xa8, 0x3f, 0x18, 0x49, 0x7f, 0x46, 0xb8, 0x69, 0xfb,
+  0xf7, 0xfc, 0xf9, 0xe1, 0x01, 0x7f, 0x95, 0xfa, 0x00, 0x90, 0x41, 0x46,
+  0x30, 0x0f, 0x00, 0x77, 0x90, 0xfa, 0x00, 0xc9, 0x90, 0xf1, 0xf9, 0x01,
+  0x11, 0xb0, 0x5d, 0xf8, 0x0f, 0x00, 0xec, 0xf9, 0x03, 0x0f, 0x00, 0x85,
+  0x1f, 0x00, 0x57, 0x29, 0x46, 0x70, 0x0f, 0x00, 0x80, 0x1f, 0x02, 0xe1,
+  0x0b, 0xd0, 0xfd, 0x01, 0x15, 0xa0, 0x69, 0xf9, 0xfb, 0xf7, 0xe3, 0xfa,
+  0xa9, 0xad, 0x9b, 0xc0, 0x4d, 0x03, 0xd5, 0x2d, 0x02, 0x6e, 0x6b, 0x00,
+  0x30, 0x39, 0x69, 0x29, 0xf0, 0x31, 0xb2, 0xcb, 0xf9, 0x81, 0x49, 0x00,
+  0x9f, 0x91, 0xd5, 0xc6, 0x6b, 0x02, 0x5f, 0xa7, 0x00, 0x70, 0x1d, 0x00,
+  0x15, 0xff, 0xd6, 0x13, 0x01, 0xbc, 0xf9, 0x23, 0x01, 0xb9, 0x47, 0x00,
+  0xbf, 0xfa, 0xff, 0x06, 0x46, 0xe0, 0x07, 0xad, 0xf8, 0x0a, 0x60, 0x7f,
+  0x21, 0xd5, 0xbd, 0xf8, 0x08, 0x40, 0xb8, 0x23, 0x00, 0x95, 0x03, 0x8b,
+  0xb0, 0xf8, 0x07, 0x00, 0x73, 0xbd, 0xa0, 0xf3, 0xc1, 0x31, 0x5e, 0x27,
+  0x00, 0xab, 0xfa, 0x00, 0x19, 0x71, 0x01, 0x29, 0x71, 0x02, 0x73, 0x38,
+  0xfa, 0x77, 0x90, 0x21, 0x00, 0xee, 0xfe, 0x21, 0xc7, 0x01, 0xee, 0x1f,
+  0x00, 0x9b, 0xfa, 0x80, 0x1f, 0x00, 0x0a, 0x00, 0x02, 0x9b, 0x98, 0x1d,
+  0x77, 0x12, 0x40, 0x43, 0xcb, 0x80, 0xd3, 0x50, 0xd0, 0xfb, 0x70, 0x40,
+  0x47, 0x10, 0x86, 0xbb, 0x01, 0xb4, 0xbd, 0xde, 0x25, 0x10, 0xbd, 0xf9,
+  0x00, 0x10, 0x19, 0x03, 0x01, 0xb0, 0x7f, 0x70, 0x47, 0x49, 0x43, 0x00,
+  0xfb, 0x00, 0x99, 0x90, 0x77, 0x38, 0xb5, 0x0d, 0x71, 0x60, 0xfb, 0xf7,
+  0x0d, 0x55, 0x00, 0xfc, 0x85, 0xc0, 0x11, 0x30, 0x21, 0x46, 0xbd, 0xe8,
+  0x34, 0x40, 0xfc, 0xeb, 0xa0, 0x53, 0x20, 0xf9, 0x42, 0x82, 0xb0, 0x0c,
+  0x46, 0xdf, 0xbd, 0xf9, 0x0a, 0x00, 0x15, 0x23, 0x00, 0x53, 0xf8, 0xa9,
+  0x07, 0x0b, 0x00, 0x95, 0xd1, 0x4e, 0x4b, 0x30, 0x20, 0xab, 0xb2, 0xf1,
+  0xca, 0xeb, 0x00, 0x38, 0x37, 0x00, 0x1b, 0xaf, 0x00, 0x7b, 0xb1, 0xd9,
+  0xf8, 0x9c, 0x27, 0x00, 0x1f, 0x10, 0x00, 0x00, 0x39, 0x21, 0x00, 0x37,
+  0x11, 0x04, 0xee, 0x7f, 0x30, 0x00, 0xf0, 0x0b, 0x57, 0x00, 0xfb, 0xf7,
+  0x3e, 0xfa, 0xad, 0x00, 0x44, 0x1d, 0x00, 0x02, 0x00, 0x00, 0x98, 0x04,
+  0x7a, 0xab, 0x01, 0x82, 0xef, 0xa1, 0xcf, 0xb9, 0x0e, 0xb4, 0x2b, 0x20,
+  0x7f, 0x4a, 0x84, 0xb0, 0x81, 0x46, 0x0f, 0x98, 0xb3, 0x61, 0xff, 0x4f,
+  0xf0, 0xff, 0x37, 0x01, 0x27, 0xdd, 0xe9, 0x97, 0x0d, 0x45, 0x93, 0x45,
+  0x02, 0xbe, 0x97, 0xf0, 0xef, 0xb1, 0x12, 0x7d, 0xf8, 0x41, 0x11, 0xb7,
+  0xf9, 0xff, 0xf7, 0xe3, 0xf5, 0xb0, 0x25, 0x00, 0x8f, 0x10, 0xa1, 0x89,
+  0x02, 0x15, 0x01, 0xac, 0x69, 0x00, 0x23, 0x01, 0xd7, 0x00, 0xf8, 0x0b,
+  0x91, 0x10, 0xa5, 0x23, 0x00, 0xd1, 0xff, 0x7e, 0x73, 0x01, 0x04, 0xf9,
+  0xc9, 0xe9, 0x00, 0x60, 0x6d, 0x02, 0xff, 0x0a, 0x5d, 0xf8, 0x10, 0xfb,
+  0xfe, 0xb5, 0x06, 0xff, 0x46, 0x10, 0x46, 0x19, 0x46, 0xfa, 0xf7, 0xb9,
+  0x7c, 0xa9, 0xc0, 0xdd, 0x51, 0xfa, 0xf7, 0xb4, 0xff, 0x39, 0x0f, 0x00,
+  0xa7, 0xfd, 0xff, 0x05, 0xf1, 0x51, 0x0f, 0x00, 0xac, 0x0f, 0x02, 0xf5,
+  0xae, 0x1f, 0x00, 0x28, 0x46, 0x39, 0x4b, 0x30, 0x6c, 0x6f, 0x40, 0x29,
+  0xfe, 0x99, 0xf0, 0x88, 0x0d, 0xfb, 0xf7, 0x78, 0xf9, 0x21, 0xd2, 0x1b,
+  0x00, 0xe7, 0x11, 0x00, 0x1b, 0x03, 0x5e, 0x35, 0x00, 0xdf, 0xf8, 0x77,
+  0x74, 0x0d, 0x39, 0x6b, 0x00, 0x6a, 0xf9, 0x29, 0x1b, 0x00, 0x7f, 0xd9,
+  0xff, 0xc6, 0xe9, 0x00, 0x40, 0xfe, 0x19, 0xa1, 0xff, 0x4f, 0x07, 0x46,
+  0x8f, 0xb0, 0x38, 0x68, 0x00, 0xaf, 0x22, 0xc0, 0xe9, 0x06, 0x03, 0x00,
+  0x04, 0x03, 0x00, 0x02, 0xff, 0x22, 0x00, 0x24, 0x0d, 0xf1, 0x04, 0x0a,
+  0x0d, 0xff, 0xf1, 0x20, 0x09, 0x38, 0x69, 0x07, 0x23, 0x01, 0xff, 0xaa,
+  0x08, 0xa9, 0xfe, 0xf7, 0x21, 0xfb, 0xf8, 0xbf, 0xf7, 0x74, 0xfd, 0x48,
+  0xb1, 0x38, 0xfb, 0x70, 0xb4, 0xfd, 0xfb, 0x05, 0x01, 0x97, 0xfb, 0x64,
+  0x1e, 0x00, 0x28, 0x7f, 0x40, 0xd0, 0x56, 0xe0, 0x00, 0x25, 0x01, 0x13,
+  0x30, 0xf7, 0x85, 0x06, 0xd7, 0x1b, 0x90, 0xb6, 0xf9, 0x02, 0xb0, 0xa5,
+  0x08, 0x0d, 0x01, 0x08, 0xe9, 0x41, 0x5b, 0x41, 0xb8, 0x4d, 0xa0, 0x39,
+  0x3b, 0xf9, 0x25, 0x4f, 0x30, 0x25, 0x10, 0x0b, 0x45, 0x90, 0x65, 0xc0,
+  0xff, 0xe0, 0xc1, 0x17, 0x10, 0x18, 0x59, 0x41, 0xcc, 0xd4, 0x21, 0x00,
+  0x19, 0x00, 0x20, 0x33, 0x00, 0x30, 0x1d, 0x00, 0x60, 0x5a, 0xdf, 0x43,
+  0xdc, 0xe9, 0x04, 0x01, 0x2f, 0x00, 0x30, 0x06, 0xff, 0xfb, 0x13, 0x22,
+  0x80, 0x18, 0x41, 0xeb, 0xe2, 0xfb, 0x71, 0xcc, 0x11, 0x00, 0x59, 0xf8,
+  0x25, 0x00, 0x00, 0xff, 0x90, 0xff, 0xf7, 0xeb, 0xfe, 0x3e, 0x68, 0x00,
+  0x93, 0x21, 0xd6, 0x19, 0x60, 0x3d, 0x01, 0xc6, 0x5d, 0x50, 0xfd, 0x81,
+  0xc0, 0xff, 0xdb, 0x64, 0x1c, 0x80, 0x2c, 0xa9, 0xdb, 0x3a, 0xff, 0x68,
+  0xb8, 0x68, 0x80, 0x8b, 0xd2, 0xe9, 0x06, 0xff, 0x45, 0xa0, 0xfb, 0x00,
+  0x23, 0x4f, 0xf4, 0x60, 0xdf, 0x70, 0xa0, 0xfb, 0x02, 0x68, 0xb7, 0xc0,
+  0x88, 0x45, 0xff, 0x45, 0x03, 0xd8, 0x2c, 0xbf, 0xb4, 0x42, 0x07, 0xeb,
+  0x20, 0x00, 0x29, 0x90, 0x0f, 0xfb, 0x34, 0xf1, 0x4f, 0xad, 0xff, 0xf5,
+  0x06, 0x7d, 0x84, 0x68, 0x00, 0x68, 0x03, 0xff, 0x90, 0x20, 0x21, 0x7e,
+  0xa8, 0xfb, 0xf7, 0x8b, 0xef, 0xff, 0x66, 0xa8, 0x60, 0xa1, 0x80, 0x87,
+  0xff, 0x3c, 0xbb, 0xa8, 0xa8, 0x07, 0x00, 0x83, 0xff, 0x12, 0x07, 0x02,
+  0x7f, 0xf7, 0xff, 0x07, 0xa8, 0xaf, 0xc0, 0x22, 0x06, 0xc0, 0x03, 0xe7,
+  0x98, 0xd4, 0x30, 0xbb, 0xd0, 0x4f, 0x40, 0xa5, 0xf8, 0x05, 0xd7, 0xd1,
+  0x02, 0x98, 0x65, 0x41, 0xa0, 0xa7, 0x50, 0xf2, 0x80, 0x7f, 0x03, 0x9a,
+  0x0d, 0xf5, 0xfc, 0x7a, 0xd2, 0xad, 0x10, 0xff, 0xff, 0xf7, 0xa5, 0xfe,
+  0x02, 0x9a, 0x09, 0x90, 0xfc, 0x21, 0x51, 0xe5, 0x40, 0xfe, 0x04, 0x90,
+  0x01, 0x20, 0x01, 0xfc, 0x99, 0x80, 0x1d, 0x50, 0x9b, 0x03, 0x98, 0xcd,
+  0xf8, 0x00, 0xff, 0xb0, 0x4b, 0x46, 0xd0, 0xe9, 0x08, 0x9b, 0x49, 0xdf,
+  0x46, 0x5a, 0x46, 0x05, 0xa8, 0x05, 0x20, 0xfe, 0x05, 0xff, 0x98, 0x04,
+  0x99, 0xfa, 0xf7, 0x0e, 0xff, 0x05, 0xbf, 0x90, 0x4f, 0xf0, 0x8c, 0x49,
+  0x06, 0x0d, 0x02, 0x07, 0xff, 0xff, 0x02, 0x99, 0x06, 0x90, 0x09, 0x89,
+  0x34, 0x5f, 0xf8, 0x0c, 0x2f, 0x8d, 0x1a, 0x91, 0x31, 0x8c, 0xb9, 0x20,
+  0x5f, 0xf6, 0xf8, 0xad, 0xf8, 0x06, 0xd9, 0x30, 0x05, 0xff, 0xd1, 0xfa,
+  0x0f, 0x00, 0xee, 0x0f, 0x00, 0x04, 0x00, 0x0d, 0xf1, 0x48, 0xff, 0x0b,
+  0x0b, 0xe0, 0x00, 0xbf, 0x00, 0x98, 0x41, 0xfe, 0x91, 0x10, 0x00, 0x91,
+  0xf9, 0xd1, 0x08, 0xf1, 0x01, 0xff, 0x08, 0xb8, 0xf1, 0x04, 0x0f, 0x6f,
+  0xd3, 0x6d, 0xff, 0x1c, 0x02, 0x99, 0x09, 0x89, 0xe8, 0xb2, 0x88, 0xff,
+  0x42, 0x80, 0xf0, 0x9f, 0x80, 0xfe, 0xf7, 0x8a, 0xbf, 0xf9, 0x80, 0x03,
+  0xff, 0xf7, 0xcc, 0x2d, 0x40, 0x20, 0xb7, 0x7e, 0x00, 0x90, 0x63, 0x90,
+  0x98, 0x63, 0x73, 0xd0, 0x28, 0xfb, 0x02, 0x0a, 0x89, 0x00, 0x2d, 0xfd,
+  0x0a, 0xa8, 0x49, 0xbb, 0x46, 0x50, 0x63, 0x50, 0xfb, 0xf7, 0x55, 0x5d,
+  0x00, 0xbf, 0x6b, 0xf8, 0x4a, 0x0b, 0x00, 0x49, 0xfd, 0x62, 0xc7, 0x00,
+  0xeb, 0x01, 0xfd, 0x4a, 0x15, 0x00, 0xb4, 0xf8, 0x7e, 0xa9, 0x01, 0xeb,
+  0xff, 0xc7, 0x01, 0x7f, 0x1c, 0x04, 0x2f, 0x48, 0x60, 0xff, 0xe5, 0xdb,
+  0xe8, 0xb2, 0xfe, 0xf7, 0x5f, 0xf9, 0xb7, 0xfa, 0xf7, 0x9e, 0xc7, 0xe0,
+  0x8d, 0x41, 0xff, 0x30, 0xf8, 0xed, 0x09, 0xdf, 0x20, 0x35, 0xf8, 0xc5,
+  0x01, 0xa4, 0xfe, 0x01, 0x7f, 0xf0, 0x12, 0xff, 0xff, 0xf7, 0x94, 0xf9,
+  0x99, 0x30, 0xfe, 0xa9, 0x00, 0xad, 0xf8, 0x1c, 0x00, 0x00, 0x26, 0xbd,
+  0x5e, 0xc3, 0x00, 0xad, 0xf8, 0x1e, 0x00, 0x11, 0x03, 0x20, 0x07, 0x00,
+  0xfe, 0x0f, 0x01, 0x22, 0x00, 0x22, 0x7e, 0x66, 0xa8, 0x39, 0xed, 0x46,
+  0x5d, 0x53, 0x90, 0xf9, 0x5d, 0x51, 0xf5, 0xdb, 0x07, 0xef, 0xaa, 0x86,
+  0x98, 0x80, 0x5f, 0xa0, 0x00, 0x90, 0x66, 0x6f, 0xa9, 0x03, 0x98, 0x80,
+  0xa5, 0x53, 0x03, 0x3c, 0xad, 0x00, 0xbf, 0x93, 0xf9, 0x00, 0x26, 0xb0,
+  0x46, 0x2f, 0x60, 0x20, 0xd5, 0x4b, 0xa5, 0x00, 0x12, 0x93, 0x04, 0x15,
+  0x93, 0x00, 0xf6, 0xdb, 0xff, 0x61, 0x69, 0x00, 0xeb, 0xc8, 0x02, 0xd1,
+  0x40, 0xff, 0xc9, 0x07, 0x0f, 0xd5, 0x3c, 0xa9, 0x12, 0xaa, 0x65, 0x51,
+  0x25, 0x60, 0x4b, 0x03, 0x00, 0xf7, 0xb0, 0x02, 0x3c, 0x29, 0x00, 0xff,
+  0xc6, 0x01, 0x76, 0x1c, 0x49, 0x68, 0x51, 0x60, 0xff, 0x15, 0x2e, 0x02,
+  0xd2, 0x40, 0x1c, 0x08, 0x28, 0xbf, 0xe6, 0xd3, 0x86, 0x98, 0x00, 0x69,
+  0xe9, 0xa1, 0x0a, 0xf6, 0x37, 0x00, 0x00, 0x23, 0xe9, 0xa5, 0x12, 0xa8,
+  0xfe, 0xf7, 0xff, 0xf8, 0xf9, 0x4f, 0xf4, 0xc8, 0x70, 0x00, 0x90, 0xbf,
+  0x4f, 0xe7, 0x0d, 0xf5, 0x07, 0x7d, 0x3b, 0x21, 0x70, 0xf3, 0xb5, 0x82,
+  0xd1, 0xa0, 0xe9, 0x90, 0x26, 0x54, 0xf8, 0x26, 0xfe, 0x99, 0x20, 0x76,
+  0x1c, 0xff, 0xf7, 0x9d, 0xfd, 0x45, 0xff, 0x19, 0x07, 0x2e, 0xf6, 0xd3,
+  0x28, 0x46, 0x76, 0x7d, 0xbd, 0x1f, 0x0d, 0xff, 0xf7, 0x8e, 0xfd, 0x85,
+  0xb9, 0xd0, 0x7f, 0x05, 0x46, 0x76, 0x1c, 0x07, 0x2e, 0xf4, 0x23, 0x02,
+  0xff, 0x38, 0xb5, 0x00, 0x24, 0x02, 0xfb, 0x02, 0xf5, 0xf7, 0x11, 0xb9,
+  0xff, 0xab, 0x30, 0x03, 0xe0, 0xff, 0xf7, 0xff, 0xd4, 0xff, 0xc5, 0xeb,
+  0xc5, 0x05, 0xa8, 0x42, 0xdf, 0x28, 0xbf, 0x01, 0x24, 0x20, 0xbf, 0xe0,
+  0xc9, 0xb2, 0xff, 0x51, 0xb1, 0x15, 0x29, 0x08, 0xda, 0xc0, 0x68, 0xff,
+  0x00, 0xeb, 0x81, 0x01, 0x0a, 0x6c, 0x52, 0x1c, 0xff, 0x0a, 0x64, 0x01,
+  0x6c, 0x49, 0x1c, 0x01, 0x64, 0x7e, 0x61, 0x70, 0x68, 0x00, 0xf1, 0x08,
+  0x01, 0x03, 0x91, 0x60, 0x5d, 0x18, 0xe1, 0x30, 0x4d, 0xba, 0x10, 0x71,
+  0x02, 0x6a, 0x55, 0xf2, 0xff, 0xf7, 0xf7, 0xd2, 0xfc, 0x00, 0x98, 0xdf,
+  0xf8, 0x6f, 0x84, 0x29, 0x04, 0x60, 0x0f, 0x03, 0x56, 0xfd, 0x05, 0x01,
+  0xf7, 0x0f, 0xfd, 0x13, 0xb7, 0xe0, 0x00, 0x20, 0x70, 0x59, 0xdb, 0x00,
+  0x00, 0x03, 0x01, 0xf0, 0x3f, 0x8b, 0xc3, 0xd3, 0xb0, 0xff, 0xa3, 0x68,
+  0x08, 0x93, 0x20, 0x68, 0x08, 0x9a, 0xff, 0x05, 0x90, 0xe1, 0x68, 0x06,
+  0x91, 0x00, 0x21, 0xff, 0x10, 0x91, 0x0f, 0x91, 0x0e, 0x91, 0x08, 0x99,
+  0xff, 0x24, 0x31, 0x04, 0x91, 0x05, 0x99, 0x01, 0xf5, 0xf7, 0xcc, 0x71,
+  0x09, 0x07, 0x00, 0x12, 0x88, 0x89, 0x88, 0xff, 0x22, 0xf4, 0x00, 0x62,
+  0x91, 0x42, 0x0b, 0xd1, 0xff, 0x09, 0x99, 0x08, 0x9a, 0x49, 0x68, 0x12,
+  0x6a, 0xf7, 0x91, 0x42, 0x05, 0x0b, 0x00, 0x04, 0x9a, 0x09, 0x7a, 0xff,
+  0x12, 0x78, 0x91, 0x42, 0x03, 0xd0, 0x22, 0x69, 0xff, 0x06, 0x99, 0xfe,
+  0xf7, 0x88, 0xfa, 0x05, 0x98, 0xf7, 0x08, 0x30, 0x07, 0x5f, 0x90, 0x04,
+  0x23, 0x00, 0x2b, 0x3f, 0x08, 0xbf, 0x00, 0x2a, 0x0b, 0xd0, 0xfd, 0x20,
+  0x0b, 0x04, 0x73, 0x0c, 0xd1, 0x77, 0x90, 0x0b, 0x04, 0x06, 0xd1, 0x20,
+  0xbf, 0x00, 0xff, 0xbb, 0xfd, 0x5f, 0xea, 0x00, 0x09, 0x40, 0xf0, 0xff,
+  0xbe, 0x82, 0x00, 0x20, 0x0b, 0x90, 0x6a, 0x46, 0xbf, 0x07, 0x98, 0x0a,
+  0xc8, 0x0a, 0xc2, 0x03, 0x01, 0x07, 0xd7, 0x98, 0x00, 0x25, 0x45, 0x01,
+  0x0c, 0xef, 0x10, 0x73, 0xfd, 0xee, 0xf9, 0xa1, 0x05, 0x9a, 0xc2, 0xa1,
+  0x91, 0x20, 0xcd, 0xe9, 0x7b, 0x18, 0x00, 0x59, 0xb0, 0x00, 0x04, 0x9a,
+  0x08, 0x2f, 0x30, 0xff, 0x04, 0x9b, 0x40, 0x88, 0x92, 0x89, 0x49, 0x8a,
+  0xff, 0xdb, 0x89, 0x03, 0x90, 0x12, 0x18, 0x64, 0x31, 0x7f, 0x9a, 0x18,
+  0x51, 0x43, 0x64, 0x22, 0xb1, 0x43, 0xf0, 0xff, 0x01, 0x20, 0x14, 0x91,
+  0x01, 0x90, 0x0d, 0xe0, 0xff, 0x02, 0x28, 0x03, 0xd1, 0x04, 0x99, 0x03,
+  0x98, 0x7f, 0x89, 0x89, 0x04, 0xe0, 0x03, 0x28, 0x05, 0x0b, 0x02, 0x7f,
+  0xc9, 0x89, 0x08, 0x18, 0x80, 0xb2, 0x03, 0x9f, 0x30, 0xbe, 0x0f, 0x61,
+  0x00, 0xf0, 0xa1, 0xfb, 0x0a, 0x83, 0xc2, 0x76, 0xbf, 0xe0, 0xdd, 0xe9,
+  0x18, 0x01, 0x0b, 0x4d, 0x10, 0xc0, 0xe7, 0x19, 0x59, 0x41, 0x69, 0x00,
+  0xe5, 0x90, 0x0c, 0x23, 0x00, 0x9f, 0x21, 0x12, 0xeb, 0x0b, 0x00, 0x0f,
+  0x01, 0x85, 0x00, 0x98, 0xf7, 0x00, 0x79, 0x00, 0xa5, 0xd0, 0x01, 0x21,
+  0x08, 0x30, 0xff, 0x01, 0xfa, 0x00, 0xf0, 0xc1, 0x17, 0xcd, 0xe9, 0xe7,
+  0x16, 0x01, 0x07, 0xe3, 0x31, 0x17, 0x00, 0x6b, 0xfb, 0x38, 0xff, 0x1a,
+  0x69, 0xeb, 0x01, 0x01, 0x07, 0x9a, 0x10, 0x7f, 0xeb, 0x0a, 0x00, 0x41,
+  0xeb, 0xea, 0x71, 0x4f, 0x91, 0xfa, 0x1d, 0x01, 0x02, 0x1d, 0x00, 0x5c,
+  0xfb, 0x3a, 0x1a, 0x15, 0xf5, 0x98, 0x1f, 0x00, 0x03, 0x05, 0x51, 0x07,
+  0x9a, 0x59, 0x41, 0xd4, 0xdf, 0x91, 0x1d, 0x01, 0x04, 0x1d, 0x00, 0x4d,
+  0x3b, 0x04, 0x00, 0x23, 0x74, 0x3d, 0x01, 0x6f, 0x01, 0xc2, 0x01, 0x50,
+  0x1a, 0xa8, 0x50, 0x49, 0x20, 0xf7, 0x15, 0x90, 0x05, 0x25, 0x00, 0x08,
+  0x23, 0x11, 0x46, 0xf7, 0x15, 0x98, 0x1a, 0x37, 0x10, 0x7f, 0xfc, 0x1a,
+  0xa9, 0xfd, 0x41, 0x17, 0x00, 0x1a, 0xa8, 0x21, 0xa9, 0x30, 0xf9, 0xf7,
+  0x26, 0x00, 0x31, 0xb1, 0x80, 0x40, 0x1a, 0x11, 0x90, 0xcb, 0x13, 0x98,
+  0x43, 0x50, 0x10, 0xc3, 0x81, 0x27, 0xc0, 0xfb, 0x08, 0xff, 0x99, 0x49,
+  0x89, 0x49, 0x43, 0x81, 0x42, 0x02, 0xbf, 0xd2, 0x0e, 0x98, 0x40, 0x1c,
+  0x0e, 0xad, 0x20, 0x07, 0x7f, 0x2e, 0x62, 0xd3, 0x1a, 0xaa, 0x21, 0xa9,
+  0x7b, 0x11, 0x7f, 0xb7, 0xf8, 0x6d, 0x1c, 0x03, 0x98, 0x85, 0x1d, 0x40,
+  0xfb, 0x90, 0x80, 0x7d, 0xc0, 0xfb, 0x06, 0x99, 0x0a, 0x98, 0xff, 0x08,
+  0x62, 0x6e, 0x1e, 0xf8, 0xf7, 0x7d, 0xfa, 0xdb, 0x88, 0xb1, 0x29, 0xc0,
+  0xfb, 0x20, 0xeb, 0x50, 0xa1, 0xf8, 0xfe, 0xa1, 0x11, 0x35, 0x46, 0x07,
+  0xd1, 0x08, 0x99, 0x05, 0xff, 0x98, 0x09, 0x88, 0x80, 0x88, 0x21, 0xf4,
+  0x00, 0xff, 0x61, 0x88, 0x42, 0xe0, 0xd0, 0xe3, 0xe1, 0x01, 0xff, 0x98,
+  0x01, 0x28, 0x31, 0xd0, 0x0a, 0x98, 0xfa, 0xff, 0xf7, 0xa7, 0xfe, 0x00,
+  0xf0, 0xf9, 0xfa, 0x40, 0xff, 0xbb, 0x02, 0x98, 0x45, 0x1c, 0x01, 0x98,
+  0x03, 0xeb, 0x28, 0x1b, 0x65, 0x10, 0xbd, 0x59, 0x10, 0x09, 0x8a, 0x88,
+  0xd3, 0x42, 0x03, 0x67, 0x30, 0x65, 0x11, 0x12, 0x2d, 0xd0, 0xc0, 0x88,
+  0x4f, 0xfa, 0xf7, 0x87, 0xfc, 0x2f, 0xc0, 0x39, 0x10, 0xcf, 0x03, 0x00,
+  0xef, 0xf3, 0xfa, 0x01, 0x46, 0x3f, 0x01, 0x1b, 0xfe, 0x0a, 0x7e, 0x8b,
+  0x14, 0x02, 0x95, 0x02, 0x98, 0x14, 0x99, 0xb3, 0x41, 0xff, 0xdc, 0x81,
+  0x35, 0x46, 0xad, 0xe7, 0x00, 0xf0, 0xdf, 0xd3, 0xfa, 0x0a, 0x90, 0x21,
+  0x05, 0x20, 0x51, 0xfe, 0xf7, 0x0b, 0x99, 0x81, 0x4b, 0x30, 0x01, 0x46,
+  0x0b, 0x91, 0x4f, 0x00, 0x26, 0x21, 0xa8, 0xa1, 0x90, 0xbd, 0x80, 0x1a,
+  0x07, 0x00, 0xf7, 0xa5, 0xfa, 0x07, 0x07, 0x01, 0xeb, 0x86, 0x01, 0x13,
+  0xf7, 0x91, 0x1a, 0xaa, 0xfb, 0xe0, 0x00, 0x32, 0xf9, 0x26, 0x9b, 0x20,
+  0x21, 0xed, 0x30, 0x86, 0x08, 0x53, 0x61, 0x1d, 0x11, 0x43, 0x7d, 0x43,
+  0x59, 0xe0, 0x3a, 0x21, 0xa9, 0x1a, 0xaa, 0x0d, 0x01, 0xf6, 0x1f, 0x01,
+  0x48, 0x43, 0x2b, 0x11, 0x02, 0xfb, 0x11, 0x01, 0xff, 0x08, 0x98, 0x15,
+  0x91, 0x00, 0x89, 0x40, 0x43, 0xdf, 0x58, 0x45, 0x03, 0xd2, 0x10, 0x29,
+  0x10, 0x10, 0x90, 0x7b, 0x69, 0xe7, 0x17, 0xd0, 0xf4, 0xf9, 0xae, 0x0f,
+  0x0d, 0x00, 0xdf, 0x0f, 0x90, 0x62, 0xe7, 0x01, 0x07, 0x00, 0xc0, 0xb2,
+  0xf7, 0x04, 0x28, 0x01, 0x23, 0xd0, 0xd7, 0xae, 0x00, 0xf0, 0xd7, 0x80,
+  0xfa, 0x03, 0x17, 0x61, 0x88, 0x07, 0xc1, 0x07, 0x26, 0xff, 0x04, 0x98,
+  0x80, 0x7e, 0x00, 0x28, 0x60, 0xd0, 0xde, 0xdf, 0x00, 0x8b, 0xfa, 0xf7,
+  0x17, 0xdf, 0x00, 0x64, 0xfa, 0x7f, 0xdf, 0xf8, 0x04, 0x16, 0xfa, 0xf7,
+  0x21, 0x0b, 0x00, 0xb7, 0x81, 0xfa, 0x05, 0x41, 0xd0, 0x82, 0x8b, 0x81,
+  0xb1, 0xa2, 0xf7, 0xfb, 0x00, 0x79, 0x87, 0x00, 0x99, 0xa2, 0xfb, 0x07,
+  0xbf, 0x01, 0x02, 0xfb, 0x09, 0x11, 0xa6, 0x0f, 0x00, 0x06, 0xfa, 0x0f,
+  0x00, 0x38, 0x07, 0xc0, 0xfa, 0xf7, 0xcc, 0xfb, 0xff, 0xff, 0xf7, 0xc4,
+  0xfb, 0x03, 0xf0, 0xf4, 0xfc, 0x02, 0xff, 0x46, 0x20, 0x69, 0x0b, 0x46,
+  0x01, 0x28, 0x0c, 0xff, 0xbf, 0x02, 0x21, 0x01, 0x21, 0x00, 0x25, 0xef,
+  0xff, 0xf3, 0x11, 0x8a, 0x60, 0x20, 0x80, 0xf3, 0x11, 0xff, 0x88, 0x09,
+  0x98, 0xc0, 0x7a, 0x38, 0xbb, 0x09, 0xef, 0x98, 0x80, 0x7a, 0x80, 0xeb,
+  0xe0, 0x0c, 0x70, 0x83, 0xff, 0x42, 0x08, 0xd8, 0x28, 0xbf, 0xba, 0x42,
+  0x05, 0xff, 0xd2, 0x09, 0x9a, 0x95, 0x72, 0x01, 0x20, 0xfe, 0xbf, 0xf7,
+  0xa4, 0xf8, 0x17, 0xe0, 0x00, 0x07, 0x00, 0xa0, 0xfb, 0xf8, 0x12, 0xcd,
+  0x20, 0x0c, 0x23, 0x4b, 0x45, 0x0f, 0x7a, 0x21, 0x02, 0x0c, 0x21, 0x00,
+  0x01, 0x20, 0x90, 0x72, 0x1b, 0x01, 0xff, 0x92, 0xf8, 0xa0, 0x68, 0x90,
+  0xf8, 0x3f, 0x10, 0x77, 0x20, 0x69, 0xfe, 0x83, 0xa0, 0x0f, 0x25, 0x8a,
+  0x59, 0x00, 0x7f, 0x00, 0x2d, 0x72, 0xd1, 0x08, 0x98, 0x80, 0xa7, 0x01,
+  0xf5, 0x23, 0x3f, 0x70, 0x79, 0x3f, 0x70, 0x99, 0xa0, 0xfb, 0x07, 0xff,
+  0x23, 0x00, 0xfb, 0x09, 0x33, 0xa6, 0xfb, 0x02, 0xdf, 0x01, 0x06, 0xfb,
+  0x03, 0x11, 0x4f, 0x01, 0x8b, 0x42, 0xfd, 0x07, 0x4f, 0x00, 0x82, 0x42,
+  0x04, 0xd2, 0x21, 0x68, 0xff, 0x00, 0xf0, 0x09, 0xfa, 0x07, 0x20, 0xdb,
+  0xe1, 0xff, 0x10, 0x9a, 0x02, 0x2a, 0x07, 0xd3, 0xa3, 0x68, 0xee, 0x05,
+  0x41, 0x05, 0x98, 0xfe, 0xa1, 0x60, 0x08, 0x20, 0xd0, 0xf1, 0xe1, 0x4b,
+  0x30, 0x2d, 0x00, 0x81, 0x71, 0x82, 0x42, 0x05, 0x20, 0xff, 0xf6, 0xd3,
+  0x0f, 0x98, 0x04, 0x28, 0x03, 0xd3, 0x7e, 0x1f, 0xa0, 0xf9, 0x06, 0x20,
+  0xc1, 0xe1, 0x0e, 0x27, 0x20, 0xbe, 0x0d, 0x01, 0xe7, 0xf9, 0x0a, 0x20,
+  0xba, 0x2b, 0x00, 0x0c, 0xf6, 0x6b, 0x30, 0x00, 0x23, 0xdf, 0xa0, 0xf8,
+  0xfa, 0xf7, 0x47, 0xff, 0xfb, 0xfa, 0xf7, 0xb7, 0xfc, 0x01, 0xf0, 0xf1,
+  0xff, 0xfb, 0x07, 0x90, 0x11, 0x25, 0x0f, 0xf2, 0x80, 0xbf, 0x56, 0x0f,
+  0xf2, 0xd4, 0x47, 0x28, 0x23, 0x60, 0xa8, 0xdf, 0x22, 0xfd, 0xf7, 0x7e,
+  0xfc, 0xbf, 0xf0, 0x01, 0x28, 0xff, 0xab, 0x01, 0x22, 0x43, 0xf8, 0x35,
+  0x20, 0x00, 0xff, 0x23, 0x22, 0x69, 0xd2, 0xb2, 0x00, 0x92, 0x6d, 0xfd,
+  0x1c, 0xb7, 0x51, 0x28, 0xa8, 0xfd, 0xf7, 0x1c, 0xff, 0x6f, 0x15, 0x2d,
+  0xe8, 0xd3, 0xe3, 0x21, 0x09, 0xfc, 0x05, 0x01, 0xff, 0x6d, 0xfd, 0x20,
+  0x46, 0xfd, 0xf7, 0x3c, 0xff, 0xff, 0x05, 0x00, 0x03, 0xd0, 0x00, 0xf0,
+  0xa2, 0xf9, 0x2f, 0x28, 0x46, 0x82, 0xe1, 0x47, 0x41, 0x0c, 0xbd, 0xe0,
+  0x45, 0x60, 0xfe, 0x11, 0x00, 0x80, 0x46, 0x02, 0x97, 0xbb, 0x46, 0xba,
+  0xbb, 0x46, 0x01, 0xb9, 0x50, 0x63, 0xe0, 0x80, 0xa5, 0x20, 0x34, 0x7f,
+  0xfb, 0x80, 0x46, 0x4f, 0xf0, 0x00, 0x09, 0x7f, 0x31, 0x5f, 0x29, 0x00,
+  0x05, 0x9a, 0x00, 0xd5, 0x70, 0x08, 0x19, 0x62, 0xe7, 0x00, 0x98, 0xff,
+  0x1f, 0xb0, 0x7f, 0x31, 0x29, 0x00, 0x09, 0xff, 0xf1, 0x01, 0x09, 0xb9,
+  0xf1, 0x03, 0x0f, 0xeb, 0x3b, 0xd3, 0x21, 0x81, 0x20, 0xff, 0xf7, 0xd3,
+  0x0d, 0xa0, 0xcd, 0xa1, 0x8f, 0xbd, 0xf9, 0x84, 0x00, 0x8f, 0x31, 0xdd,
+  0xa0, 0x0b, 0x00, 0x86, 0xaa, 0x8d, 0x30, 0x4d, 0x27, 0x70, 0x0a, 0x51,
+  0x10, 0xfa, 0x93, 0x00, 0x03, 0xfb, 0x90, 0x1a, 0x43, 0x00, 0x81, 0xfa,
+  0xfa, 0xf7, 0x01, 0xbb, 0xfb, 0x59, 0xf7, 0x10, 0x00, 0xfc, 0x83, 0x55,
+  0x02, 0x78, 0xfa, 0x11, 0x00, 0xf8, 0xcf, 0xc0, 0xfa, 0xf7, 0xf7, 0xfb,
+  0x82, 0xfb, 0x46, 0x21, 0x11, 0x00, 0x6f, 0xfa, 0xfd, 0xf7, 0x97, 0xff,
+  0xfd, 0x5f, 0xfa, 0x80, 0xf9, 0xdd, 0xe9, 0x11, 0xfe, 0x53, 0x80, 0x71,
+  0xfa, 0x04, 0x99, 0x49, 0x88, 0x49, 0xff, 0x43, 0x88, 0x42, 0x3c, 0xbf,
+  0x4f, 0x45, 0x4f, 0x62, 0x13, 0xa0, 0x0c, 0xa7, 0xe0, 0x8c, 0x40, 0x2b,
+  0x00, 0x59, 0xfa, 0x3f, 0x11, 0xb8, 0xc3, 0x50, 0x21, 0x90, 0xa9, 0x41,
+  0x76, 0x1c, 0x08, 0x6f, 0x30, 0x86, 0xff, 0x42, 0x3d, 0xda, 0x00, 0xf0,
+  0x39, 0xf9, 0xf8, 0x6a, 0xf3, 0x10, 0xa6, 0xad, 0x00, 0x60, 0xd9, 0x30,
+  0x21, 0xf9, 0x0f, 0x11, 0xaf, 0xb4, 0xfe, 0x4e, 0x46, 0xdb, 0x31, 0xea,
+  0x13, 0x10, 0x18, 0xbf, 0xf9, 0x48, 0x46, 0xf8, 0xe0, 0x40, 0x79, 0x00,
+  0xc2, 0xfe, 0xb1, 0x20, 0x14, 0xf9, 0x00, 0x28, 0x04, 0x98, 0x7f, 0x7f,
+  0xf4, 0x7b, 0xaf, 0x00, 0x8a, 0xad, 0xb2, 0xbf, 0x61, 0x2f, 0x6d, 0x1c,
+  0x10, 0xd3, 0xbd, 0x33, 0xa8, 0xb5, 0x30, 0xe5, 0xf0, 0x73, 0xf0, 0xf0,
+  0x03, 0x00, 0x27, 0x00, 0xf0, 0xf8, 0xf8, 0x3b, 0x10, 0xc6, 0x1d, 0x30,
+  0x01, 0x25, 0x23, 0xf0, 0xb9, 0x32, 0xd3, 0x11, 0xf0, 0xf8, 0x7f, 0x0d,
+  0x20, 0xd0, 0xe0, 0x4e, 0x46, 0xbc, 0xbf, 0x30, 0xfd, 0xea, 0xe7, 0xf0,
+  0x0c, 0x01, 0x40, 0x1c, 0x41, 0xf1, 0x55, 0x00, 0xbf, 0xa0, 0x5a, 0xf1,
+  0x30, 0x03, 0xf1, 0x30, 0x94, 0xeb, 0x00, 0x7f, 0xc6, 0xfb, 0xb8, 0x49,
+  0xfa, 0xf7, 0x1d, 0xe7, 0x10, 0xff, 0xfd, 0xfa, 0x06, 0x99, 0xc8, 0x60,
+  0x09, 0x98, 0xff, 0x06, 0x99, 0x00, 0x68, 0x48, 0x62, 0x06, 0x98, 0xdb,
+  0xc6, 0x68, 0x89, 0x20, 0x88, 0xb0, 0xb9, 0x40, 0x00, 0xf0, 0xf7, 0xd7,
+  0xf8, 0x33, 0x39, 0x40, 0xb0, 0xf8, 0x0a, 0x80, 0xff, 0xb8, 0xf1, 0x00,
+  0x0f, 0x2f, 0xd0, 0x00, 0x89, 0xd7, 0xfa, 0xf7, 0x65, 0x85, 0x00, 0xb2,
+  0xf3, 0xf4, 0xd1, 0xf8, 0xab, 0x05, 0x46, 0xb9, 0x01, 0x5b, 0x13, 0x00,
+  0xa8, 0x8d, 0x00, 0x30, 0xfa, 0x0b, 0x00, 0x55, 0xbf, 0xc0, 0x09, 0x98,
+  0x00, 0x68, 0xff, 0x7b, 0xf7, 0x1c, 0xff, 0xc0, 0x4f, 0xf0, 0x7e, 0x50,
+  0xfd, 0xa1, 0xd7, 0xd8, 0xfa, 0x31, 0x05, 0x00, 0xe5, 0x41, 0xe0, 0xfa,
+  0xf7, 0xb7, 0x46, 0xfb, 0x01, 0x21, 0x00, 0x01, 0x60, 0x39, 0x01, 0xdc,
+  0xfd, 0xfb, 0x17, 0x01, 0xc7, 0xfb, 0x01, 0xd2, 0x09, 0x20, 0xfb, 0x75,
+  0xe0, 0x19, 0x31, 0x3a, 0x00, 0xa0, 0xb3, 0x01, 0xff, 0x21, 0x58, 0x46,
+  0x01, 0xf0, 0xba, 0xfc, 0x90, 0xfe, 0xa3, 0x00, 0xcb, 0xfb, 0x06, 0x46,
+  0x01, 0x21, 0x50, 0xae, 0x0f, 0x00, 0xb2, 0xfc, 0x8c, 0x0f, 0x00, 0xc3,
+  0x1d, 0x20, 0x30, 0xfe, 0x39, 0xf0, 0xfa, 0xf7, 0xae, 0xfa, 0x00, 0x21,
+  0xfa, 0xb7, 0xf7, 0xa9, 0xfb, 0xe3, 0x30, 0xd2, 0x40, 0x77, 0xc0, 0xfa,
+  0xfb, 0xf7, 0xa5, 0xef, 0x30, 0x84, 0x48, 0xff, 0xf7, 0xdf, 0xfb, 0xf9,
+  0x05, 0x2f, 0x00, 0x90, 0xfa, 0xe1, 0x68, 0x08, 0x5f, 0x63, 0xa6, 0x68,
+  0xb0, 0x8f, 0xff, 0x10, 0xfa, 0x85, 0x01, 0x7f, 0x93, 0xfb, 0x06, 0xd2,
+  0x96, 0xf8, 0x3b, 0x7b, 0x30, 0xff, 0xfd, 0xf7, 0x39, 0xff, 0x0e, 0x20,
+  0x3c, 0xe0, 0xee, 0x8d, 0x11, 0x87, 0xfe, 0x0b, 0x37, 0x30, 0xfd, 0xfc,
+  0x06, 0xef, 0x99, 0x08, 0x85, 0x06, 0x07, 0x10, 0x40, 0x8d, 0x09, 0xfb,
+  0x8d, 0x88, 0x79, 0x10, 0x08, 0x46, 0x06, 0x99, 0x48, 0x7b, 0x85, 0xa0,
+  0xa5, 0xe0, 0x40, 0x05, 0x26, 0xd5, 0x5d, 0x70, 0x7f, 0x9a, 0x50, 0xf8,
+  0xd0, 0x1f, 0x92, 0x7e, 0xe5, 0x61, 0xfd, 0x91, 0xe5, 0x60, 0x07, 0x9a,
+  0x91, 0x42, 0x1a, 0xd2, 0xdf, 0x81, 0x89, 0x02, 0x60, 0xb9, 0x2d, 0x00,
+  0x87, 0x81, 0x7c, 0x9f, 0x60, 0x37, 0x70, 0x08, 0x23, 0xd4, 0x30, 0xc0,
+  0x7f, 0xf1, 0xcf, 0xeb, 0xc5, 0x00, 0x00, 0x2b, 0x80, 0xd5, 0x81, 0x05,
+  0x9a, 0xbd, 0x02, 0xf9, 0xf0, 0x28, 0x32, 0x6d, 0x1c, 0x93, 0x61, 0x15,
+  0xeb, 0x2d, 0xf0, 0x11, 0xb0, 0x53, 0x95, 0xd3, 0x1a, 0x12, 0x90, 0xd6,
+  0x5f, 0x23, 0x41, 0xb9, 0x6d, 0x61, 0x13, 0xb7, 0x80, 0x32, 0xb9, 0xdd,
+  0x54, 0xe7, 0x00, 0xc1, 0xb9, 0x52, 0x05, 0x00, 0xbe, 0xb9, 0x6f, 0xdd,
+  0xe9, 0x16, 0x23, 0xa3, 0x43, 0x94, 0xbe, 0xf5, 0x01, 0xbb, 0x43, 0xbb,
+  0xb3, 0x01, 0xad, 0xbd, 0x02, 0xd9, 0x40, 0x81, 0xcd, 0x8a, 0x9d, 0x51,
+  0x94, 0xbb, 0x05, 0x50, 0x1f, 0x20, 0x98, 0xb9, 0x3b, 0x05, 0x99, 0xd9,
+  0x01, 0xbc, 0xbb, 0x20, 0x41, 0xc0, 0x6b, 0x61, 0xff, 0xfd, 0xf7, 0x00,
+  0xbd, 0x01, 0x46, 0x3f, 0x48, 0xff, 0xfa, 0xf7, 0x9f, 0xbd, 0x80, 0xb5,
+  0x41, 0x68, 0xee, 0x99, 0xb0, 0x92, 0x0b, 0x1d, 0xa5, 0x50, 0x20, 0x09,
+  0x88, 0xdd, 0x00, 0x35, 0xe0, 0x74, 0xf8, 0x02, 0x8f, 0xc0, 0xf8, 0x43,
+  0xff, 0x04, 0x46, 0x25, 0x69, 0x26, 0x68, 0xd4, 0xf8, 0xf7, 0x0c, 0x90,
+  0x88, 0x5b, 0x00, 0x96, 0xfb, 0x00, 0x27, 0xff, 0x08, 0xb9, 0x0b, 0x27,
+  0x30, 0xe0, 0x00, 0x2d, 0xff, 0x14, 0xbf, 0x32, 0x48, 0x33, 0x48, 0x01,
+  0x21, 0x7f, 0x01, 0x60, 0x2a, 0x46, 0xa3, 0x68, 0x49, 0x79, 0x10, 0xef,
+  0xfd, 0xf7, 0x53, 0xfe, 0x0d, 0x21, 0x86, 0xf8, 0xa1, 0xff, 0x71, 0x03,
+  0xd1, 0xe0, 0x68, 0xf3, 0x78, 0x42, 0xfb, 0x8b, 0x15, 0x47, 0x10, 0xff,
+  0xf7, 0xce, 0xff, 0x07, 0xff, 0x00, 0x03, 0xd1, 0x20, 0x68, 0x01, 0x78,
+  0x5a, 0xff, 0x29, 0x04, 0xda, 0xe1, 0x68, 0x00, 0x20, 0x88, 0xff, 0x83,
+  0x03, 0x27, 0x0d, 0xe0, 0xe2, 0x68, 0x51, 0xdf, 0x83, 0x40, 0x78, 0x10,
+  0x83, 0x01, 0x50, 0x83, 0xf3, 0xbf, 0x78, 0x32, 0x78, 0xa0, 0x68, 0x29,
+  0x45, 0x00, 0x8d, 0xbf, 0xfc, 0x01, 0x20, 0xb0, 0x70, 0x38, 0x57, 0xe0,
+  0xf2, 0xff, 0x83, 0x10, 0xb5, 0x00, 0x21, 0x1a, 0x4a, 0x20, 0xff, 0xfa,
+  0x01, 0xf3, 0xdb, 0x07, 0x06, 0xd5, 0x4f, 0xff, 0xf4, 0xd4, 0x74, 0x04,
+  0xfb, 0x01, 0x24, 0x01, 0xff, 0x23, 0x84, 0xf8, 0xa3, 0x31, 0x49, 0x1c,
+  0x02, 0x5f, 0x29, 0xf1, 0xd3, 0x10, 0xbd, 0x23, 0x01, 0x11, 0x23, 0x0e,
+  0xbd, 0x00, 0x23, 0x0a, 0xae, 0x47, 0x81, 0x3f, 0x03, 0x00, 0xbf, 0xf7,
+  0x6b, 0xbe, 0x00, 0xea, 0xe0, 0xa0, 0x41, 0x00, 0x00, 0xb3, 0x7a, 0x44,
+  0x7c, 0x90, 0x07, 0x00, 0xc8, 0x42, 0x0f, 0x00, 0xc1, 0xf7, 0x00, 0x00,
+  0x50, 0x83, 0x90, 0x40, 0x59, 0x08, 0xb2, 0xf3, 0x00, 0x20, 0x7b, 0x80,
+  0x00, 0x0f, 0x9b, 0x10, 0xb4, 0x50, 0xf8, 0xff, 0x04, 0x1b, 0x79, 0xb1,
+  0x02, 0x68, 0x43, 0x68, 0xff, 0x12, 0x18, 0x08, 0x30, 0xdc, 0x07, 0x44,
+  0xbf, 0xff, 0xa9, 0xf1, 0x01, 0x04, 0xe3, 0x18, 0x52, 0xf8, 0xf7, 0x04,
+  0x4b, 0x43, 0x03, 0x00, 0x09, 0x1f, 0xf9, 0xd1, 0xbf, 0xec, 0xe7, 0x10,
+  0xbc, 0x70, 0x47, 0x2f, 0x01, 0x04, 0xff, 0x28, 0x07, 0xda, 0xdf, 0xf8,
+  0xa0, 0x1c, 0x28, 0x3f, 0x22, 0x02, 0xfb, 0x00, 0x12, 0xd2, 0xed, 0x80,
+  0x17, 0x00, 0xff, 0x20, 0x00, 0x21, 0x70, 0x47, 0xf0, 0xb5, 0xdf, 0xff,
+  0xf8, 0x8c, 0x3c, 0x0f, 0xf2, 0x48, 0x05, 0x1b, 0xff, 0x68, 0x4f, 0xf4,
+  0x7a, 0x74, 0x0a, 0x46, 0xb3, 0xf7, 0xfb, 0xf4, 0xf3, 0x53, 0x70, 0x24,
+  0x42, 0xf2, 0x10, 0xff, 0x77, 0x15, 0xf8, 0x14, 0x60, 0x7e, 0x43, 0x9e,
+  0xff, 0x42, 0x0d, 0xd3, 0x05, 0xeb, 0x44, 0x04, 0x94, 0xff, 0xf9, 0x01,
+  0x40, 0x00, 0x2c, 0x0a, 0xd4, 0x14, 0xff, 0x70, 0x03, 0x2c, 0x07, 0xbf,
+  0x5a, 0x00, 0x02, 0xff, 0x60, 0xe3, 0x40, 0x03, 0x60, 0x03, 0xe0, 0x64,
+  0xff, 0x1c, 0x05, 0x2c, 0xe9, 0xd3, 0x04, 0x21, 0x08, 0xfb, 0x46, 0xf0,
+  0xdf, 0xa0, 0x02, 0xff, 0x04, 0x03, 0x08, 0xaf, 0x00, 0x10, 0x01, 0x20,
+  0xfc, 0x80, 0xf8, 0x63, 0xb0, 0x00, 0xff, 0x27, 0x0f, 0xf2, 0xf4, 0x25,
+  0xdf, 0xf8, 0x24, 0xff, 0x6c, 0x28, 0x20, 0x78, 0x43, 0xf9, 0xb2, 0x81,
+  0xff, 0x53, 0x80, 0x19, 0x35, 0xf8, 0x17, 0x20, 0x42, 0xff, 0x80, 0x01,
+  0x21, 0x80, 0xf8, 0x27, 0x10, 0x02, 0xff, 0xf1, 0x22, 0x00, 0x0e, 0x21,
+  0x00, 0xf0, 0x70, 0xfd, 0xfb, 0xcf, 0xc1, 0xec, 0xdb, 0xdf, 0xf8, 0xfc,
+  0x5b, 0xff, 0x68, 0x89, 0xc0, 0xf3, 0x81, 0x00, 0x80, 0xb1, 0xff, 0x00,
+  0x22, 0x10, 0x21, 0x4f, 0xf4, 0x10, 0x70, 0x7f, 0xf6, 0xf7, 0x2c, 0xfb,
+  0x03, 0x22, 0x32, 0x4b, 0xb0, 0xbf, 0x00, 0xf0, 0x36, 0xfc, 0x04, 0x46,
+  0x13, 0x01, 0x00, 0xff, 0xf0, 0x20, 0xfc, 0xec, 0xb9, 0xa8, 0x7a, 0x03,
+  0x5f, 0x21, 0x08, 0x42, 0x1a, 0xd0, 0x29, 0x03, 0x2c, 0x29, 0x00, 0x55,
+  0x17, 0x29, 0x02, 0x01, 0x29, 0x00, 0x21, 0x29, 0x02, 0x2c, 0x29, 0x00,
+  0xff, 0x0b, 0xfc, 0xa8, 0x69, 0xdf, 0xf8, 0xa8, 0x2b, 0xff, 0x40, 0x08,
+  0x00, 0xf5, 0x43, 0x40, 0x50, 0x30, 0xfb, 0x00, 0x21, 0x7b, 0x31, 0xec,
+  0xb9, 0x68, 0x89, 0x4f, 0xbf, 0xf4, 0xf8, 0x71, 0x08, 0x42, 0x18, 0x3f,
+  0x04, 0x50, 0xfe, 0x3f, 0x00, 0xf7, 0xfa, 0x03, 0x22, 0x4f, 0xf4, 0xfa,
+  0x4b, 0x71, 0x02, 0x41, 0x00, 0x00, 0x41, 0x00, 0x0d, 0x03, 0x03, 0x0d,
+  0x00, 0xaf, 0xf9, 0xfb, 0x04, 0xb9, 0x51, 0x01, 0x50, 0x51, 0x00, 0xe2,
+  0x7a, 0x95, 0x90, 0xf2, 0xbf, 0xf1, 0x47, 0x16, 0x46, 0x86, 0xf9, 0xb0,
+  0xff, 0x8a, 0x46, 0x35, 0x88, 0x06, 0xf1, 0x10, 0x01, 0xfd, 0x02, 0x83,
+  0x30, 0x55, 0xff, 0x00, 0x28, 0x42, 0xd1, 0xbf, 0x30, 0x7c, 0x0f, 0xf6,
+  0x44, 0x51, 0x2b, 0xd0, 0x00, 0xff, 0x80, 0x00, 0x40, 0xf0, 0x13, 0x00,
+  0x30, 0x74, 0xfb, 0x00, 0x27, 0x61, 0x10, 0x70, 0x51, 0xf8, 0x27, 0x20,
+  0xfe, 0xd7, 0x70, 0x89, 0xca, 0x45, 0x05, 0xd3, 0x01, 0xd8, 0xff, 0x44,
+  0x45, 0x02, 0xd3, 0x7f, 0x1c, 0x08, 0x2f, 0xff, 0xf3, 0xd3, 0x00, 0x2f,
+  0x18, 0xbf, 0x08, 0x2f, 0xff, 0x25, 0xd0, 0xc7, 0xf1, 0x07, 0x07, 0x02,
+  0x22, 0x5f, 0xba, 0x40, 0xd3, 0x17, 0xa4, 0x25, 0x00, 0x04, 0xab, 0x60,
+  0xff, 0x0a, 0xfb, 0x02, 0x99, 0xcd, 0xe9, 0x04, 0x89, 0x7d, 0x77, 0x41,
+  0x00, 0x0f, 0xf6, 0x64, 0x31, 0xdd, 0x8f, 0xb0, 0xfa, 0x6d, 0x60, 0x23,
+  0x49, 0x00, 0x80, 0xa0, 0xfb, 0x08, 0x23, 0xfe, 0x6f, 0x60, 0x89, 0x99,
+  0x45, 0x04, 0xd8, 0x2e, 0xbf, 0xff, 0x90, 0x45, 0x7f, 0x1c, 0x34, 0x2f,
+  0xee, 0xd3, 0xff, 0x78, 0x1c, 0x01, 0xd0, 0x36, 0x28, 0x01, 0xd3, 0xef,
+  0x04, 0x20, 0x8c, 0xe0, 0x33, 0x01, 0xdc, 0x41, 0x7a, 0xfb, 0x5c, 0x82,
+  0xab, 0x60, 0x7f, 0x1c, 0x07, 0x2f, 0xf9, 0xff, 0xd3, 0xc7, 0xf1, 0x0d,
+  0x01, 0x41, 0xf0, 0x40, 0xff, 0x01, 0xb1, 0x74, 0xa0, 0xf1, 0x1e, 0x01,
+  0x05, 0xff, 0x29, 0x34, 0xbf, 0xc2, 0x22, 0xc1, 0x22, 0xf2, 0xff, 0x74,
+  0x08, 0x28, 0x38, 0xbf, 0x04, 0x22, 0x06, 0xfb, 0xd3, 0x11, 0x07, 0x00,
+  0x06, 0x22, 0x02, 0xd3, 0x07, 0xff, 0x22, 0x1a, 0x28, 0x05, 0xd0, 0x08,
+  0x29, 0x03, 0xbf, 0xd3, 0x28, 0x28, 0x01, 0xd0, 0x2c, 0x4f, 0x00, 0x03,
+  0xff, 0x21, 0x00, 0xe0, 0x02, 0x21, 0x42, 0xea, 0xc1, 0xff, 0x01, 0x31,
+  0x75, 0x0f, 0xf6, 0xa0, 0x21, 0x41, 0xff, 0x18, 0x11, 0xf8, 0x01, 0x1c,
+  0x01, 0xf0, 0x0f, 0xbf, 0x01, 0xc9, 0x00, 0x71, 0x75, 0x1e, 0x37, 0x00,
+  0x0c, 0xff, 0x21, 0x03, 0xd3, 0x23, 0x28, 0x34, 0xbf, 0x0d, 0xff, 0x21,
+  0x0e, 0x21, 0xb1, 0x75, 0xd4, 0x22, 0xdf, 0xf7, 0xf8, 0x38, 0x1a, 0x03,
+  0x00, 0x7a, 0x02, 0xfb, 0x05, 0x7f, 0x11, 0x01, 0xeb, 0x80, 0x00, 0x00,
+  0x21, 0xb9, 0x20, 0xff, 0x0c, 0x0f, 0xf6, 0x20, 0x42, 0xc6, 0xf8, 0x17,
+  0xfe, 0x8e, 0x30, 0x12, 0xf8, 0x11, 0x30, 0xa7, 0xfb, 0x03, 0xaf, 0x89,
+  0xd1, 0x45, 0x06, 0xcd, 0x80, 0xa0, 0xf9, 0x90, 0x49, 0xff, 0x1c, 0x04,
+  0x29, 0xf3, 0xd3, 0x02, 0xe0, 0x02, 0x7f, 0xeb, 0x41, 0x00, 0x40, 0x78,
+  0xf0, 0x76, 0x33, 0x10, 0x7f, 0x71, 0x02, 0x98, 0x01, 0xfb, 0x00, 0xf4,
+  0xf7, 0x00, 0xdf, 0x01, 0x00, 0xf0, 0xe9, 0xfc, 0xff, 0x01, 0x07, 0x46,
+  0xff, 0x04, 0xfb, 0x10, 0x20, 0xdf, 0xf8, 0xe0, 0x19, 0xfb, 0xa1, 0xfb,
+  0xdf, 0x30, 0xf0, 0xde, 0xfc, 0x40, 0x1c, 0xff, 0x40, 0x08, 0xdf, 0xf8,
+  0xd4, 0x19, 0x88, 0x42, 0xff, 0x06, 0xf1, 0x21, 0x01, 0x04, 0xbf, 0x00,
+  0x20, 0xff, 0x7f, 0x1c, 0x0f, 0x70, 0x3f, 0x04, 0x3a, 0x0e, 0xff, 0x02,
+  0xf0, 0x03, 0x02, 0x4a, 0x70, 0xb0, 0x77, 0xff, 0x01, 0x0a, 0x00, 0x0c,
+  0x00, 0xf0, 0x7f, 0x00, 0x7d, 0x86, 0xf1, 0xe0, 0xf1, 0x77, 0x00, 0x20,
+  0x06, 0x75, 0x51, 0xff, 0x87, 0x70, 0xb5, 0x04, 0x46, 0x0f, 0xf2, 0x50,
+  0xbb, 0x00, 0x30, 0xeb, 0x20, 0x4f, 0xf4, 0x96, 0xf7, 0x10, 0xf9, 0xff,
+  0xf7, 0x71, 0xfe, 0x00, 0x25, 0x06, 0xf1, 0x8c, 0x7f, 0x46, 0x30, 0x78,
+  0xc0, 0x07, 0x04, 0xd5, 0x11, 0x01, 0xbf, 0x80, 0xfe, 0x00, 0x28, 0xf7,
+  0xd0, 0x0f, 0x01, 0x0d, 0xff, 0xd4, 0x20, 0x46, 0x00, 0xf0, 0x92, 0xf9,
+  0x20, 0xb5, 0xb9, 0x17, 0x01, 0x74, 0x17, 0x00, 0xf6, 0xd0, 0x11, 0x01,
+  0x89, 0xe7, 0xf9, 0x00, 0xb1, 0x7d, 0x70, 0x13, 0x00, 0xe2, 0xfd, 0x28,
+  0xff, 0x46, 0x70, 0xbd, 0x40, 0x02, 0xb0, 0x02, 0x40, 0xb7, 0x03, 0x40,
+  0x03, 0x23, 0x20, 0x4d, 0x80, 0x1f, 0x20, 0x15, 0xdf, 0x46, 0xdf, 0xf8,
+  0x20, 0x09, 0x0b, 0x10, 0x29, 0x28, 0xff, 0x21, 0x01, 0xfb, 0x05, 0x06,
+  0x00, 0x20, 0x01, 0xef, 0x23, 0x9a, 0x45, 0x04, 0x03, 0x20, 0x90, 0x45,
+  0x01, 0xff, 0xd3, 0x02, 0x20, 0x06, 0xe0, 0x82, 0x45, 0xdf, 0x77, 0xf8,
+  0x1c, 0x29, 0x0f, 0x01, 0x00, 0xd3, 0x01, 0xdb, 0x00, 0xff, 0x14, 0x19,
+  0xdf, 0xf8, 0xf0, 0x28, 0x47, 0x18, 0xff, 0x20, 0x31, 0x05, 0xb3, 0x02,
+  0x2d, 0x3b, 0xd0, 0xff, 0x62, 0xd2, 0x93, 0x7a, 0x12, 0x7b, 0x08, 0x70,
+  0xff, 0x02, 0xf0, 0x01, 0x0b, 0x3a, 0x78, 0x03, 0xf0, 0xf7, 0x03, 0x04,
+  0x3f, 0xb3, 0x20, 0x01, 0x60, 0xf6, 0xf7, 0xff, 0x9d, 0xf9, 0xba, 0x79,
+  0x3f, 0x21, 0x40, 0xf6, 0xff, 0x11, 0x00, 0xf6, 0xf7, 0x97, 0xf9, 0xfa,
+  0x78, 0x7a, 0x0b, 0x01, 0x12, 0x0b, 0x00, 0x91, 0xf9, 0x7a, 0x7a, 0x0b,
+  0x01, 0xdf, 0x13, 0x00, 0x2f, 0xe0, 0x50, 0x53, 0x31, 0x04, 0x10, 0x7f,
+  0x7b, 0x3a, 0x78, 0x00, 0xf0, 0x02, 0x0b, 0x39, 0x01, 0xf5, 0xa4, 0x39,
+  0x00, 0x80, 0x39, 0x03, 0xf2, 0x21, 0x50, 0xf6, 0x5b, 0xf7, 0x7a, 0x39,
+  0x03, 0xf2, 0x22, 0x0b, 0x00, 0x74, 0x39, 0x03, 0xff, 0xf2, 0x23, 0x50,
+  0x12, 0xe0, 0x52, 0x89, 0x12, 0xbf, 0xf4, 0xf8, 0x72, 0x14, 0x46, 0x18,
+  0x17, 0xf0, 0x48, 0xff, 0x70, 0x3f, 0x21, 0x3a, 0x7b, 0x40, 0xf6, 0x1e,
+  0x9e, 0x5d, 0x00, 0x62, 0xf9, 0xfa, 0x7b, 0x9b, 0x90, 0x4b, 0x00, 0x40,
+  0xfb, 0xf6, 0x1f, 0x0f, 0x00, 0x5a, 0xf9, 0x00, 0x20, 0xc6, 0xff, 0xe9,
+  0x02, 0x00, 0x4f, 0xf0, 0xff, 0x31, 0xdf, 0xff, 0xf8, 0x5c, 0x08, 0x18,
+  0xeb, 0x00, 0x02, 0x4a, 0xfe, 0x65, 0xd0, 0x01, 0x21, 0x8b, 0x42, 0xdf,
+  0xf8, 0x50, 0xfd, 0x08, 0xeb, 0x01, 0x82, 0x42, 0x01, 0xd3, 0x05, 0x20,
+  0xff, 0x4b, 0xe0, 0x0c, 0xb9, 0x05, 0x27, 0x47, 0xe0, 0xf5, 0x32, 0x31,
+  0x80, 0x51, 0x2d, 0x60, 0x5b, 0xfe, 0x07, 0x00, 0xdf, 0x6e, 0xd1, 0x74,
+  0x88, 0xbb, 0x4b, 0x60, 0x3f, 0xd0, 0xdf, 0x01, 0x2d, 0x1a, 0xd1, 0x80,
+  0x7b, 0x00, 0x02, 0x20, 0x5f, 0xf6, 0xf7, 0x26, 0xf9, 0x01, 0xa9, 0x00,
+  0x40, 0x97, 0x30, 0xd7, 0x21, 0xf9, 0x10, 0x13, 0x00, 0xca, 0x13, 0x00,
+  0x1c, 0xf9, 0xd7, 0xf2, 0x7e, 0x1f, 0x73, 0x00, 0x15, 0x73, 0x00, 0x20,
+  0xf9, 0xfe, 0x41, 0x01, 0x00, 0xf0, 0x52, 0xf8, 0x07, 0x46, 0x14, 0xab,
+  0xe0, 0x80, 0x2b, 0x00, 0x00, 0x2b, 0x00, 0x0b, 0x35, 0x02, 0x24, 0xaa,
+  0x09, 0x00, 0x06, 0x35, 0x02, 0x5a, 0x35, 0x00, 0x01, 0x35, 0x03, 0xf2,
+  0xfd, 0x25, 0xdd, 0x00, 0x05, 0xf9, 0x04, 0xf1, 0x42, 0x00, 0xbd, 0x07,
+  0x75, 0x40, 0x35, 0xf9, 0x27, 0xb9, 0xb3, 0x00, 0x8a, 0xed, 0x28, 0x4d,
+  0x70, 0x84, 0xfe, 0x81, 0x61, 0xf0, 0x8d, 0x00, 0xbb, 0x21, 0x30, 0x51,
+  0x00, 0xaf, 0xf8, 0x28, 0x99, 0x00, 0xf0, 0xff, 0xfe, 0x08, 0xb9, 0x07,
+  0x27, 0xf2, 0xe7, 0x04, 0xff, 0xf1, 0x08, 0x00, 0x80, 0xb2, 0x00, 0xf1,
+  0x8c, 0xfb, 0x40, 0x00, 0x3f, 0x10, 0xfd, 0x00, 0x70, 0x75, 0xe0, 0xdd,
+  0x1d, 0x0f, 0x05, 0x30, 0x77, 0xa0, 0x0b, 0x04, 0x01, 0x2d, 0x7e, 0x1d,
+  0x01, 0x7f, 0x00, 0x70, 0x77, 0xd4, 0xd1, 0x97, 0x03, 0xf9, 0x06, 0x97,
+  0x00, 0x87, 0xc0, 0xf8, 0xcb, 0xe7, 0x06, 0x27, 0xf3, 0xcf, 0xe7, 0x0b,
+  0x20, 0x09, 0x10, 0x20, 0x47, 0xdf, 0xf8, 0xf7, 0x44, 0x77, 0xd4, 0x25,
+  0xa1, 0x26, 0x84, 0x18, 0x41, 0xbf, 0xeb, 0x03, 0x09, 0x01, 0x25, 0xa9,
+  0x0d, 0x42, 0xbc, 0xbf, 0x42, 0x02, 0xd3, 0x84, 0x1a, 0x61, 0x11, 0x00,
+  0xdf, 0xff, 0xf8, 0xf4, 0x56, 0x05, 0xf1, 0x80, 0x07, 0xd7, 0xfe, 0xa7,
+  0x40, 0x89, 0x45, 0x08, 0xbf, 0x84, 0x42, 0x22, 0xff, 0xd0, 0xc7, 0xe9,
+  0x00, 0x66, 0x05, 0xf1, 0x78, 0xfb, 0x02, 0x20, 0x01, 0x80, 0xff, 0xf7,
+  0xc1, 0xfd, 0x06, 0x9f, 0x00, 0x18, 0xd1, 0x00, 0x21, 0x11, 0x00, 0xd7,
+  0xa0, 0x58, 0xff, 0xf8, 0x02, 0x20, 0xff, 0xf7, 0x99, 0xfe, 0x70, 0x7f,
+  0xb1, 0xdf, 0xf8, 0xec, 0x06, 0x81, 0x78, 0xcb, 0x90, 0xff, 0x01, 0x79,
+  0x73, 0x41, 0x78, 0x39, 0x75, 0x00, 0xf5, 0x78, 0x37, 0x00, 0x49, 0x95,
+  0x01, 0x78, 0x75, 0x00, 0xe0, 0xf7, 0x04, 0x26, 0x30, 0xe3, 0x01, 0x82,
+  0xdf, 0xf8, 0x94, 0x7f, 0x06, 0x10, 0xb5, 0xd0, 0xe9, 0x20, 0x23, 0xa1,
+  0x50, 0xff, 0x2b, 0x08, 0xbf, 0x00, 0x2a, 0x0b, 0xd0, 0x01, 0x77, 0x21,
+  0x78, 0x30, 0xf7, 0x01, 0x04, 0x46, 0x32, 0xc5, 0x20, 0xfb, 0x9b, 0xfc,
+  0x31, 0x50, 0x16, 0x01, 0x20, 0x08, 0x60, 0xff, 0x20, 0x46, 0x10, 0xbd,
+  0xdf, 0xf8, 0x9c, 0x06, 0xdf, 0x00, 0x68, 0x70, 0x47, 0x38, 0x2f, 0x60,
+  0x58, 0x26, 0xff, 0x04, 0x20, 0xd2, 0xe9, 0x16, 0x45, 0x00, 0x2d, 0xba,
+  0x37, 0x00, 0x2c, 0x37, 0x01, 0x02, 0xf1, 0x50, 0x83, 0x00, 0x16, 0x75,
+  0xf8, 0x37, 0x01, 0x7f, 0x37, 0x00, 0x70, 0x16, 0x00, 0x37, 0x00, 0xef,
+  0x32, 0xbd, 0x30, 0xb1, 0x3b, 0xd1, 0xdf, 0xf8, 0x64, 0xfd, 0x06, 0x03,
+  0x01, 0x01, 0xe0, 0xdf, 0xf8, 0x60, 0x06, 0xde, 0x21, 0x11, 0x01, 0x00,
+  0x70, 0x47, 0x0b, 0x10, 0x41, 0x07, 0xff, 0x46, 0xbc, 0x1c, 0x88, 0x46,
+  0x25, 0x88, 0xb5, 0xff, 0xf5, 0x10, 0x7f, 0x0c, 0xd0, 0xb5, 0xf5, 0x2c,
+  0xff, 0x7f, 0xa1, 0x7b, 0x14, 0xd1, 0x40, 0xf2, 0x32, 0xee, 0xaf, 0x10,
+  0x29, 0xf8, 0x62, 0xe5, 0x14, 0x08, 0xe0, 0xa1, 0x2f, 0x7b, 0x4f, 0xf4,
+  0x0c, 0xcd, 0x10, 0x1f, 0x13, 0x03, 0xc3, 0x12, 0x7f, 0x23, 0xf8, 0x03,
+  0xe0, 0x40, 0xf2, 0x33, 0x29, 0x00, 0xef, 0x14, 0xf8, 0x39, 0x46, 0x19,
+  0x61, 0xd3, 0xf8, 0x17, 0xff, 0xf8, 0x22, 0x2f, 0xa8, 0x1c, 0x07, 0x21,
+  0x80, 0xff, 0xb2, 0xf6, 0xf7, 0x13, 0xf8, 0xe1, 0x7f, 0x68, 0xff, 0x1c,
+  0x00, 0xf0, 0x44, 0xf8, 0xe1, 0x7b, 0x05, 0xfe, 0xed, 0x10, 0x00, 0xf0,
+  0x3f, 0xf8, 0x78, 0x79, 0x28, 0xfd, 0xb1, 0xcd, 0x50, 0x60, 0xf9, 0xf7,
+  0x2c, 0xfc, 0x00, 0xdf, 0x20, 0x78, 0x71, 0xae, 0x1d, 0xbd, 0x81, 0x05,
+  0xf1, 0xff, 0x08, 0x07, 0x12, 0xd1, 0x80, 0x22, 0x80, 0x21, 0x7f, 0xb0,
+  0xb2, 0xf5, 0xf7, 0xf7, 0xff, 0x00, 0x09, 0x04, 0xdd, 0xf2, 0x09, 0x00,
+  0x02, 0x21, 0xb8, 0x09, 0x00, 0xed, 0xff, 0xff, 0x01, 0x22, 0x01, 0x21,
+  0x28, 0x46, 0x18, 0xe0, 0xff, 0x00, 0xf0, 0x99, 0xf8, 0xf5, 0xf7, 0xe5,
+  0xff, 0xbf, 0xe0, 0x7e, 0x40, 0xf0, 0x80, 0x01, 0x25, 0x01, 0xd5, 0xff,
+  0xff, 0xa1, 0x7e, 0xe8, 0x1d, 0x00, 0xf0, 0x10, 0x76, 0x03, 0xb0, 0x84,
+  0xf8, 0x2d, 0x01, 0xd6, 0xff, 0x01, 0x07, 0x10, 0x7f, 0xfb, 0xfb, 0x00,
+  0x22, 0x00, 0xf0, 0x85, 0x2d, 0x00, 0x6f, 0xce, 0xff, 0x00, 0x20, 0x73,
+  0x10, 0x81, 0x80, 0x1b, 0x00, 0x3b, 0xbe, 0xbf, 0xf7, 0x01, 0x06, 0x46,
+  0xb4, 0xf7, 0x06, 0xe1, 0x00, 0xdf, 0x07, 0x08, 0xd0, 0xa1, 0x7b, 0xfd,
+  0x01, 0x0c, 0xbf, 0x94, 0xfb, 0x01, 0xd5, 0x01, 0x09, 0xf3, 0x04, 0xf8,
+  0x55, 0x30, 0xf3, 0x05, 0x04, 0xef, 0xe0, 0xf8, 0xf7, 0x53, 0x0d, 0x02,
+  0x38, 0x46, 0xf8, 0xdf, 0xf7, 0x75, 0xf9, 0x31, 0x46, 0xe5, 0x61, 0x58,
+  0xf8, 0xef, 0x96, 0xf8, 0x22, 0x20, 0xf5, 0x03, 0xf8, 0xf7, 0x6a, 0x99,
+  0xf9, 0xf5, 0x01, 0x09, 0x01, 0x3e, 0xf9, 0xf7, 0x03, 0x0b, 0x01, 0x38,
+  0xab, 0xf9, 0xaf, 0xe9, 0x05, 0x06, 0xe9, 0x03, 0xb8, 0x15, 0x00, 0x54,
+  0xa9, 0xf9, 0xe9, 0x01, 0x09, 0x01, 0x4f, 0x09, 0x00, 0x02, 0xf3, 0x00,
+  0xf8, 0xd7, 0xf7, 0x4a, 0xf9, 0xe9, 0x03, 0x19, 0xe9, 0x00, 0x24, 0xf8,
+  0xcf, 0xf8, 0xf7, 0x42, 0xf9, 0xe9, 0x03, 0x25, 0x01, 0x15, 0xf9, 0xb4,
+  0xe9, 0x01, 0x4f, 0x01, 0x10, 0x71, 0xc0, 0x0e, 0xf8, 0x2f, 0x01, 0x32,
+  0xd5, 0xf9, 0xeb, 0x01, 0x85, 0xeb, 0x02, 0x0f, 0x2f, 0x00, 0x2a, 0xf9,
+  0xed, 0x04, 0xeb, 0x02, 0xe0, 0x7c, 0xe5, 0x11, 0x40, 0xf0, 0x02, 0x7b,
+  0x02, 0x03, 0x65, 0x80, 0x05, 0xf1, 0x13, 0x08, 0x75, 0x01, 0xff, 0x1f,
+  0xfa, 0x88, 0xf0, 0x70, 0x47, 0xb0, 0xb5, 0xdd, 0x88, 0x31, 0x70, 0x0d,
+  0x46, 0x68, 0x77, 0x50, 0x48, 0x61, 0xff, 0x20, 0x22, 0xfc, 0xf7, 0x59,
+  0xfd, 0xa8, 0x7c, 0xdb, 0x8d, 0xf8, 0xa6, 0x90, 0x27, 0xe8, 0x07, 0x00,
+  0x03, 0x00, 0x7f, 0x28, 0x7d, 0x8d, 0xf8, 0x05, 0x00, 0x68, 0x05, 0x00,
+  0x77, 0x07, 0x00, 0xa8, 0x05, 0x00, 0x0b, 0x00, 0xe8, 0x05, 0x00, 0xff,
+  0x0f, 0x00, 0x28, 0x7e, 0x8d, 0xf8, 0x11, 0x00, 0xdd, 0x68, 0x05, 0x00,
+  0x13, 0x00, 0xa8, 0x05, 0x00, 0x15, 0x00, 0x7f, 0xa8, 0x7f, 0x8d, 0xf8,
+  0x19, 0x00, 0xe8, 0x05, 0x00, 0xf7, 0x1b, 0x00, 0x95, 0xd7, 0x50, 0x8d,
+  0xf8, 0x1d, 0x00, 0xff, 0x68, 0x88, 0x1d, 0xf8, 0x17, 0x10, 0x08, 0x18,
+  0xff, 0x69, 0x46, 0x01, 0xeb, 0x47, 0x01, 0x01, 0x2c, 0xff, 0x49, 0x78,
+  0x80, 0xb2, 0x02, 0xd1, 0xf8, 0xf7, 0xff, 0xb5, 0xf8, 0x01, 0xe0, 0xf5,
+  0xf7, 0xfd, 0xfe, 0xfe, 0x17, 0x60, 0x2f, 0xec, 0xd3, 0x08, 0xb0, 0xb0,
+  0xbd, 0xfa, 0xfb, 0x51, 0x00, 0xd7, 0xe0, 0xe4, 0x56, 0x06, 0xeb, 0x45,
+  0xef, 0x00, 0x41, 0x78, 0x16, 0x51, 0x00, 0x00, 0x19, 0xff, 0xff, 0xf7,
+  0x2a, 0xff, 0x6d, 0x1c, 0x14, 0x2d, 0xf4, 0xff, 0xd3, 0x70, 0xbd, 0x03,
+  0x46, 0x06, 0x20, 0x04, 0x7f, 0x2b, 0x00, 0xdb, 0x70, 0x47, 0x10, 0xb5,
+  0x27, 0x00, 0xff, 0x54, 0x34, 0xf8, 0x13, 0x40, 0xa1, 0x42, 0x22, 0xef,
+  0xbf, 0x0f, 0xf2, 0xe0, 0x0b, 0x02, 0x8c, 0x42, 0x14, 0xff, 0xd3, 0x0f,
+  0xf2, 0xdc, 0x54, 0x1c, 0x5d, 0xa2, 0xfa, 0x15, 0x02, 0xd4, 0x09, 0x00,
+  0x94, 0x42, 0x0a, 0xd3, 0xcd, 0xe7, 0x48, 0x28, 0x24, 0xbb, 0x70, 0xf5,
+  0xb0, 0x24, 0x03, 0x19, 0xff, 0x80, 0x9a, 0x70, 0xbd, 0xe8, 0x10, 0x40,
+  0x0b, 0xed, 0xe0, 0xb9, 0xa1, 0xc6, 0x4b, 0x19, 0x01, 0x00, 0x30, 0x30,
+  0xff, 0xf8, 0x24, 0x3f, 0x0b, 0x80, 0x80, 0x78, 0x10, 0xfb, 0x70, 0x10,
+  0x47, 0x81, 0x4f, 0x04, 0x46, 0x89, 0xb0, 0xbf, 0x20, 0x78, 0x0f, 0xf2,
+  0x98, 0x58, 0x67, 0xf0, 0x39, 0xd7, 0x07, 0x90, 0x04, 0x4d, 0x80, 0x06,
+  0x4d, 0x80, 0x2e, 0xfb, 0xff, 0xc0, 0xb2, 0x00, 0x25, 0x00, 0x28, 0x55,
+  0xd1, 0xff, 0x59, 0xf8, 0x25, 0x00, 0x06, 0x99, 0xb0, 0xfb, 0xff, 0xf1,
+  0xfb, 0x0f, 0xf2, 0x74, 0x40, 0x30, 0xf8, 0xff, 0x15, 0xa0, 0x0f, 0xf2,
+  0x18, 0x30, 0x00, 0x68, 0xfe, 0x3d, 0xf1, 0x03, 0xa8, 0x02, 0x90, 0x08,
+  0xeb, 0x87, 0xff, 0x06, 0x04, 0xa8, 0x01, 0x90, 0xcd, 0xf8, 0x00, 0x7f,
+  0xa0, 0x72, 0x78, 0x31, 0x78, 0x5b, 0x46, 0x97, 0x61, 0xff, 0x3d, 0xf8,
+  0xf1, 0x78, 0x01, 0x29, 0x05, 0xd1, 0xff, 0xbd, 0xf8, 0x0c, 0x10, 0xb2,
+  0x78, 0x91, 0x42, 0xff, 0x07, 0xd1, 0x09, 0xe0, 0x02, 0x29, 0x02, 0xbf,
+  0xb7, 0xbd, 0xf8, 0x0e, 0x0f, 0x02, 0x02, 0xd0, 0x77, 0x91, 0xde, 0xff,
+  0xd3, 0x10, 0xbb, 0x07, 0x9a, 0xa2, 0x49, 0xd4, 0xff, 0x23, 0x03, 0xfb,
+  0x02, 0x11, 0x9d, 0xf8, 0x15, 0xff, 0x20, 0x01, 0xeb, 0x85, 0x01, 0x02,
+  0xf0, 0x3f, 0xff, 0x02, 0x0a, 0x70, 0x9d, 0xf8, 0x10, 0x30, 0x9d, 0xff,
+  0xf8, 0x11, 0x20, 0x03, 0xf0, 0x0f, 0x03, 0x43, 0xaf, 0xea, 0x02, 0x12,
+  0x4a, 0x11, 0x00, 0x12, 0x11, 0x00, 0x13, 0xfa, 0x11, 0x06, 0x8a, 0x11,
+  0x00, 0x14, 0x20, 0x02, 0xf0, 0x0f, 0xff, 0x02, 0xca, 0x70, 0x6d, 0x1c,
+  0x35, 0x2d, 0xa7, 0xfb, 0xd3, 0x09, 0xd1, 0xc2, 0x2d, 0xe9, 0xfe, 0x4f,
+  0x9c, 0xee, 0xeb, 0x10, 0x04, 0xa8, 0x28, 0x9d, 0xd0, 0x9c, 0xfb, 0x12,
+  0x7e, 0x07, 0x02, 0x98, 0xfb, 0x04, 0xf1, 0x24, 0x00, 0xd7, 0x70, 0xff,
+  0x72, 0x01, 0x88, 0x0f, 0xf2, 0x6c, 0x3b, 0x51, 0xff, 0x43, 0x93, 0x4a,
+  0xa2, 0xfb, 0x01, 0x23, 0x12, 0x7f, 0x0c, 0x42, 0xea, 0x03, 0x42, 0x1b,
+  0x0c, 0xdb, 0x81, 0x7b, 0x84, 0x78, 0xd5, 0x80, 0x01, 0x00, 0x23, 0x22,
+  0x97, 0x50, 0xbf, 0x40, 0xf8, 0xcd, 0xe9, 0x10, 0x01, 0x69, 0x60, 0x09,
+  0xf6, 0x13, 0x01, 0xa4, 0xfb, 0x4f, 0xd0, 0xfb, 0x01, 0x33, 0xcd, 0xfb,
+  0xe9, 0x02, 0xf9, 0x80, 0x02, 0x01, 0x89, 0x00, 0x41, 0xff, 0xea, 0x90,
+  0x71, 0x80, 0x00, 0xcd, 0xe9, 0x0e, 0x7f, 0x01, 0xca, 0x46, 0x3f, 0x27,
+  0x0c, 0x97, 0x25, 0x00, 0xff, 0x45, 0x1e, 0x9a, 0x28, 0x9b, 0xa2, 0xfb,
+  0x04, 0xfd, 0x01, 0x77, 0x81, 0x3a, 0x46, 0x5a, 0x43, 0x00, 0xf0, 0xfd,
+  0xce, 0xff, 0xe0, 0x10, 0x45, 0x0a, 0x90, 0x02, 0x46, 0xea, 0x17, 0x00,
+  0x68, 0x17, 0x00, 0x88, 0x53, 0x90, 0x68, 0x14, 0x46, 0xeb, 0x50, 0x08,
+  0x45, 0x00, 0x23, 0x13, 0x01, 0x03, 0xfb, 0x04, 0xfd, 0x88, 0x5b, 0x81,
+  0xb2, 0x1a, 0x68, 0xeb, 0x03, 0x03, 0xdf, 0xcd, 0xe9, 0x06, 0x23, 0x0b,
+  0x8f, 0xd0, 0x0e, 0x23, 0xfe, 0xad, 0x90, 0x45, 0x00, 0xfb, 0x03, 0x55,
+  0xcd, 0xe9, 0xff, 0x08, 0x45, 0x00, 0x22, 0x04, 0xab, 0x0a, 0xac, 0x7f,
+  0x00, 0x25, 0x0b, 0xeb, 0x05, 0x1e, 0xd3, 0x8d, 0x00, 0x7f, 0xde, 0xe9,
+  0x02, 0x68, 0x41, 0x45, 0x0c, 0xbb, 0x50, 0xef, 0xb0, 0x42, 0x09, 0xd3,
+  0x15, 0x00, 0x1c, 0xdc, 0xe9, 0xf6, 0x80, 0x20, 0x45, 0x03, 0x11, 0x00,
+  0x86, 0x42, 0x00, 0xd3, 0xff, 0x52, 0x1c, 0x08, 0x33, 0x6d, 0x1c, 0x03,
+  0x2d, 0xfd, 0xe6, 0xe5, 0xd0, 0x0f, 0xf2, 0xb0, 0x23, 0x21, 0x68, 0x7f,
+  0x53, 0xf8, 0x30, 0x30, 0x99, 0x42, 0x21, 0x2b, 0x20, 0xff, 0xa0, 0x23,
+  0x03, 0xeb, 0xc0, 0x03, 0x5b, 0x68, 0xff, 0x8b, 0x42, 0x28, 0xbf, 0x52,
+  0x1c, 0x24, 0x1d, 0xff, 0x40, 0x1c, 0x02, 0x28, 0xec, 0xd3, 0xad, 0xf8,
+  0xff, 0x34, 0x20, 0x92, 0xb2, 0xbd, 0xf9, 0x70, 0x10, 0x7f, 0x8a, 0x42,
+  0x18, 0xda, 0xbd, 0xf9, 0x74, 0x07, 0x00, 0xff, 0x07, 0xdb, 0x91, 0x46,
+  0x12, 0xa8, 0x04, 0xa9, 0xfd, 0x28, 0x2b, 0x30, 0xc3, 0xfb, 0xad, 0xf8,
+  0x6e, 0x90, 0xdf, 0x7f, 0x1e, 0x01, 0x2f, 0x89, 0x1d, 0x01, 0x00, 0x81,
+  0x7f, 0x45, 0x0d, 0xdb, 0x29, 0x99, 0x12, 0xa8, 0x81, 0x41, 0x7f, 0x1b,
+  0x98, 0x04, 0xe0, 0x29, 0x99, 0x04, 0x0b, 0x00, 0xff, 0x0a, 0xf8, 0x0d,
+  0x98, 0x2a, 0x99, 0x08, 0x60, 0xff, 0x01, 0xe0, 0x4f, 0xf0, 0x05, 0x0a,
+  0x50, 0x46, 0xfd, 0x1f, 0x8f, 0x14, 0xf0, 0x43, 0x00, 0xf1, 0x18, 0x04,
+  0xff, 0x05, 0x46, 0x00, 0x6a, 0x0f, 0xf2, 0x20, 0x29, 0xf7, 0x48, 0x71,
+  0xce, 0x87, 0x40, 0x00, 0x27, 0x09, 0xeb, 0x7f, 0xc7, 0x00, 0x22, 0x68,
+  0x41, 0x68, 0x91, 0xbb, 0xe0, 0xff, 0x0f, 0x20, 0x0d, 0xd3, 0x59, 0xf8,
+  0x37, 0x10, 0xfd, 0x91, 0x95, 0x00, 0x00, 0x20, 0x07, 0xd2, 0x40, 0x68,
+  0xff, 0x41, 0x0c, 0xc0, 0x03, 0x00, 0xf0, 0x2e, 0xf8, 0xff, 0xc0, 0xf5,
+  0x04, 0x20, 0xc0, 0x0b, 0x24, 0x1d, 0xff, 0x7f, 0x1c, 0x02, 0x2f, 0x06,
+  0xf8, 0x01, 0x0b, 0xff, 0xe3, 0xd3, 0x00, 0x24, 0x0f, 0xf2, 0xac, 0x16,
+  0x9f, 0x06, 0xeb, 0x04, 0x1e, 0xd5, 0xb3, 0x10, 0x0b, 0x10, 0x01, 0xff,
+  0x8b, 0x42, 0x03, 0xd8, 0x2c, 0xbf, 0x82, 0x42, 0x0f, 0x0f, 0x20, 0x0c,
+  0xd3, 0x17, 0x00, 0x0d, 0x11, 0x13, 0x00, 0xf9, 0x75, 0xfe, 0xf3, 0x80,
+  0xe0, 0xf9, 0xf7, 0x58, 0xff, 0x08, 0x35, 0xdf, 0x64, 0x1c, 0x03, 0x2c,
+  0x08, 0x43, 0x00, 0xe0, 0xd3, 0xfe, 0x97, 0x00, 0x83, 0x22, 0x46, 0x00,
+  0x23, 0xf9, 0xf7, 0xff, 0x4c, 0xbf, 0x60, 0xee, 0x00, 0x20, 0x74, 0x29,
+  0xef, 0x00, 0x20, 0x40, 0xf3, 0x07, 0x00, 0xdf, 0x00, 0x20, 0xd7, 0x80,
+  0x96, 0x98, 0xb7, 0x50, 0xff, 0x48, 0xc0, 0x7f, 0x00, 0xff, 0x00, 0xf2,
+  0x05, 0x2a, 0x00, 0x5e, 0xd0, 0xb2, 0xfd, 0x48, 0x1f, 0x00, 0x80, 0x18,
+  0x42, 0xfd, 0x81, 0xb5, 0xff, 0xd8, 0x68, 0x01, 0x9d, 0x96, 0x6b, 0x46,
+  0x03, 0xf7, 0x00, 0x46, 0x68, 0x2f, 0x00, 0xc7, 0x02, 0x00, 0x46, 0x75,
+  0x57, 0x0b, 0x00, 0x57, 0x07, 0x00, 0x7e, 0x48, 0x06, 0x27, 0xd2, 0x1d,
+  0x0f, 0x00, 0x06, 0x0e, 0x0d, 0x0c, 0x00, 0x06, 0x0a, 0x00, 0x0d, 0x01,
+  0xd9, 0x0e, 0x00, 0x01, 0x07, 0x00, 0x0b, 0x0b, 0x02, 0x00, 0x0b, 0x0c,
+  0xf1, 0x0d, 0x25, 0x01, 0x00, 0x01, 0x37, 0x00, 0x48, 0x56, 0xc0, 0x00,
+  0xff, 0x08, 0xd8, 0xba, 0x00, 0xd0, 0xab, 0xb5, 0x00, 0xff, 0xa0, 0xd1,
+  0xb0, 0x00, 0xc0, 0x3d, 0xac, 0x00, 0xff, 0x18, 0xf4, 0xa7, 0x00, 0xf0,
+  0xe8, 0xa3, 0x00, 0xff, 0x60, 0x18, 0xa0, 0x00, 0x50, 0x86, 0x9c, 0x00,
+  0xff, 0x20, 0x23, 0x99, 0x00, 0xd8, 0xf5, 0x95, 0x00, 0xff, 0x7c, 0xf5,
+  0x92, 0x00, 0xb4, 0x1f, 0x90, 0x00, 0xf7, 0x28, 0x72, 0x8d, 0x1f, 0x00,
+  0x8a, 0x00, 0x7c, 0x82, 0xff, 0x88, 0x00, 0x48, 0x3b, 0x86, 0x00, 0xc4,
+  0x11, 0xff, 0x84, 0x00, 0x98, 0x03, 0x82, 0x00, 0x6c, 0x0e, 0xff, 0x80,
+  0x00, 0x4c, 0x30, 0x7e, 0x00, 0x0c, 0x68, 0xff, 0x7c, 0x00, 0xb8, 0xb3,
+  0x7a, 0x00, 0xc0, 0x11, 0xff, 0x79, 0x00, 0xf8, 0x80, 0x77, 0x00, 0xd0,
+  0xff, 0xff, 0x75, 0x00, 0x80, 0x8d, 0x74, 0x00, 0xdc, 0x28, 0xff, 0x73,
+  0x00, 0xb8, 0xd0, 0x71, 0x00, 0xb0, 0x84, 0xff, 0x70, 0x00, 0xfc, 0x43,
+  0x6f, 0x00, 0x70, 0x0d, 0xff, 0x6e, 0x00, 0x0c, 0xe1, 0x6c, 0x00, 0x08,
+  0xbe, 0xff, 0x6b, 0x00, 0x9c, 0xa3, 0x6a, 0x00, 0xc8, 0x91, 0xff, 0x69,
+  0x00, 0x28, 0x88, 0x68, 0x00, 0x58, 0x86, 0xff, 0x67, 0x00, 0xf4, 0x8b,
+  0x66, 0x00, 0x98, 0x98, 0xff, 0x65, 0x00, 0xa8, 0xac, 0x64, 0x00, 0xc0,
+  0xc7, 0xff, 0x63, 0x00, 0x7c, 0xe9, 0x62, 0x00, 0x78, 0x11, 0xff, 0x62,
+  0x00, 0x18, 0x40, 0x61, 0x00, 0xf8, 0x74, 0xff, 0x60, 0x00, 0xb4, 0xaf,
+  0x5f, 0x00, 0xb0, 0xf0, 0xff, 0x5e, 0x00, 0x24, 0x37, 0x5e, 0x00, 0x10,
+  0x83, 0xff, 0x5d, 0x00, 0x10, 0xd4, 0x5c, 0x00, 0x24, 0x2a, 0xdf, 0x5c,
+  0x00, 0x84, 0x84, 0x5b, 0x38, 0xe3, 0x04, 0x05, 0xbd, 0x09, 0x96, 0xd0,
+  0x00, 0x00, 0x95, 0x8d, 0xf3, 0xe3, 0x80, 0x73, 0xaf, 0x2b, 0x3d, 0x80,
+  0x5f, 0x10, 0xba, 0x82, 0x07, 0x0f, 0x02, 0xf7, 0xf1, 0x42, 0x4f, 0x07,
+  0x01, 0x18, 0x2f, 0xf4, 0x04, 0xfa, 0x06, 0x00, 0x1c, 0x2c, 0x00, 0xdb,
+  0x21, 0x00, 0x00, 0xae, 0xfe, 0x0b, 0x00, 0xe2, 0x0a, 0x00, 0x00, 0x6e,
+  0x46, 0xb6, 0xff, 0x3f, 0xee, 0x39, 0xf8, 0x34, 0xac, 0x30, 0xe2, 0xff,
+  0x2c, 0x90, 0x29, 0x9d, 0x26, 0xff, 0x23, 0xa8, 0xff, 0x21, 0x8e, 0x1f,
+  0xa9, 0x1d, 0xf3, 0x1b, 0x65, 0xff, 0x1a, 0xfb, 0x18, 0xb0, 0x17, 0xa8,
+  0x17, 0x83, 0xff, 0x16, 0x75, 0x15, 0x7c, 0x14, 0x95, 0x13, 0xbf, 0xfe,
+  0xd8, 0xb0, 0x2d, 0x12, 0x77, 0x11, 0xc2, 0x11, 0x18, 0xff, 0x11, 0x79,
+  0x10, 0xe4, 0x0f, 0xa7, 0x13, 0xfd, 0xff, 0x12, 0x5c, 0x12, 0xc3, 0x11,
+  0x33, 0x11, 0x02, 0xff, 0x0d, 0x60, 0x0d, 0xfa, 0x0c, 0x99, 0x0c, 0x3c,
+  0xff, 0x0c, 0x38, 0x10, 0xc6, 0x0f, 0x58, 0x0f, 0xf0, 0xff, 0x0e, 0x8d,
+  0x0f, 0x27, 0x0f, 0xc6, 0x0e, 0x69, 0xff, 0x0e, 0x0f, 0x0e, 0xbe, 0x0e,
+  0x66, 0x0e, 0x11, 0xff, 0x0e, 0xc0, 0x0d, 0x72, 0x0d, 0x00, 0x00, 0x1e,
+  0xff, 0x0b, 0x50, 0x0a, 0x78, 0x0a, 0xa0, 0x05, 0xb0, 0xff, 0xb3, 0x00,
+  0x00, 0x36, 0x6e, 0x01, 0x00, 0x6c, 0xff, 0xdc, 0x02, 0x00, 0xd8, 0xb8,
+  0x05, 0x00, 0xb0, 0xff, 0x71, 0x0b, 0x00, 0x60, 0xe3, 0x16, 0x00, 0xc0,
+  0xdf, 0xc6, 0x2d, 0x00, 0x20, 0x14, 0xe3, 0x00, 0x17, 0x19, 0xff, 0x23,
+  0x27, 0x2b, 0x30, 0x00, 0x0a, 0x00, 0x09, 0xbf, 0x00, 0x12, 0x00, 0x08,
+  0x00, 0x15, 0xbc, 0xe0, 0x20, 0xff, 0x70, 0x0b, 0x00, 0x0e, 0x00, 0x0f,
+  0x00, 0x10, 0xff, 0x00, 0x0d, 0x84, 0x03, 0x00, 0x04, 0x00, 0x05, 0xfe,
+  0xbf, 0x00, 0x1d, 0x00, 0x1d, 0x2b, 0x1c, 0x0f, 0x1d, 0x77, 0x6b, 0x1d,
+  0x2a, 0x05, 0x00, 0x6a, 0x1d, 0x29, 0x05, 0x00, 0xff, 0x69, 0x1d, 0x28,
+  0x1c, 0x00, 0x1d, 0x68, 0x1d, 0xdd, 0x27, 0x05, 0x00, 0x67, 0x1d, 0x26,
+  0x05, 0x00, 0x66, 0x1d, 0xff, 0x20, 0x32, 0x00, 0x32, 0x00, 0xf4, 0x01,
+  0xf4, 0x97, 0x01, 0xee, 0x02, 0x01, 0x03, 0x03, 0x00, 0x00, 0x41, 0x21,
+  0x05, 0xff, 0x02, 0x05, 0x01, 0x04, 0x04, 0x04, 0x01, 0x04, 0xef, 0x03,
+  0x03, 0x02, 0x03, 0x17, 0x10, 0x03, 0x49, 0x09, 0xff, 0x68, 0xc1, 0x40,
+  0xc8, 0x07, 0x01, 0xd4, 0x01, 0xbf, 0x21, 0x03, 0xe0, 0x70, 0x47, 0x74,
+  0x83, 0x20, 0x00, 0xfe, 0xaf, 0x80, 0x01, 0x50, 0xf5, 0xf7, 0xcb, 0xbb,
+  0x00, 0x77, 0x00, 0x70, 0xb5, 0xf1, 0x31, 0x74, 0x21, 0x11, 0x3d, 0x50,
+  0xff, 0x7b, 0x4c, 0x63, 0x43, 0x7b, 0x4c, 0x24, 0x68, 0xff, 0xa3, 0x42,
+  0x24, 0xbf, 0x01, 0xeb, 0x40, 0x02, 0xff, 0x52, 0x78, 0x40, 0x1c, 0x04,
+  0x28, 0xf1, 0xd3, 0xf7, 0xd2, 0xb2, 0x03, 0xa7, 0xa0, 0xbb, 0x70, 0xf5,
+  0xf7, 0xeb, 0xbc, 0xfb, 0x4b, 0x31, 0x50, 0x8b, 0x60, 0x60, 0x26, 0xa1,
+  0xff, 0x5d, 0x35, 0xf8, 0x14, 0x00, 0xf5, 0xf7, 0xa8, 0xbf, 0xfb, 0x64,
+  0x1c, 0x09, 0x2c, 0xf7, 0x0b, 0xc0, 0x70, 0x7f, 0xbd, 0x30, 0xb5, 0x14,
+  0x46, 0x6c, 0x4a, 0xef, 0x50, 0x7b, 0x23, 0x12, 0x23, 0x60, 0x48, 0x25,
+  0xe3, 0x5c, 0xd5, 0xc1, 0xff, 0x52, 0x5d, 0xd2, 0x18, 0x52, 0xb2, 0x00,
+  0x2a, 0xff, 0x02, 0xd4, 0xf9, 0xf7, 0xb7, 0xfc, 0x02, 0xe0, 0xff, 0x52,
+  0x42, 0xf5, 0xf7, 0x93, 0xfd, 0x07, 0x2c, 0xff, 0x08, 0xbf, 0x03, 0x22,
+  0x02, 0xd0, 0x08, 0x2c, 0xff, 0x05, 0xd1, 0x05, 0x22, 0xbd, 0xe8, 0x30,
+  0x40, 0xfe, 0x5d, 0x31, 0x9d, 0xbd, 0x30, 0xbd, 0x23, 0x29, 0x05, 0xff,
+  0xd3, 0x02, 0xd8, 0xb0, 0xf1, 0xf1, 0x4f, 0x01, 0xff, 0xd3, 0x3f, 0x20,
+  0x0d, 0xe0, 0x40, 0x0b, 0x40, 0xff, 0xea, 0xc1, 0x40, 0x50, 0x21, 0x48,
+  0x43, 0x40, 0xf7, 0xf2, 0xcb, 0x21, 0x59, 0x60, 0xf0, 0x00, 0xf5, 0x80,
+  0xff, 0x40, 0xc0, 0x0b, 0x18, 0xbf, 0x40, 0x1e, 0xc0, 0xff, 0xb2, 0x70,
+  0x47, 0xf8, 0xb5, 0x06, 0x46, 0x4d, 0x3f, 0x48, 0x14, 0x46, 0x02, 0x68,
+  0x1d, 0x35, 0x51, 0x4d, 0x52, 0xff, 0x00, 0x0f, 0x40, 0xea, 0x01, 0x10,
+  0x09, 0x0f, 0xf7, 0x00, 0xf0, 0x98, 0x9d, 0x70, 0x01, 0xd5, 0x00, 0x20,
+  0xd7, 0xf2, 0xbd, 0x3a, 0x69, 0x60, 0x29, 0x93, 0xa0, 0xac, 0xff, 0xfb,
+  0x05, 0x2e, 0xd9, 0x71, 0x03, 0xda, 0x0f, 0xf2, 0xa8, 0xff, 0x10, 0x31,
+  0x5c, 0x09, 0xb9, 0x40, 0x48, 0x01, 0xff, 0x78, 0x40, 0xf2, 0x0b, 0x20,
+  0xf5, 0xf7, 0x41, 0xfe, 0xb5, 0x60, 0x50, 0x10, 0x39, 0x5c, 0x40, 0xf2,
+  0x81, 0xcf, 0x10, 0xf5, 0xf7, 0x3a, 0x3f, 0xf0, 0x31, 0x01, 0xb6, 0xff,
+  0xeb, 0x02, 0x46, 0x67, 0xc1, 0x77, 0x13, 0x02, 0x22, 0x0f, 0x42, 0xff,
+  0xea, 0x05, 0x12, 0xd1, 0xb2, 0x40, 0xf2, 0x75, 0xfe, 0x0f, 0x00, 0x28,
+  0xfb, 0x6f, 0xf0, 0x70, 0x40, 0x20, 0xff, 0x40, 0x4f, 0xf4, 0xff, 0x12,
+  0xa2, 0xfb, 0x00, 0xff, 0x45, 0x24, 0x0f, 0x44, 0xea, 0x05, 0x14, 0xe1,
+  0xff, 0xb2, 0x4f, 0xf4, 0xba, 0x70, 0x2d, 0x0f, 0xf5, 0xdf, 0xf7, 0x18,
+  0xfb, 0x24, 0x0a, 0x11, 0x00, 0x64, 0xe1, 0xfa, 0x2f, 0x00, 0x73, 0x2f,
+  0x00, 0x10, 0xfb, 0x21, 0x0a, 0x4f, 0xbb, 0xf4, 0xb9, 0x4d, 0x10, 0x0b,
+  0xfb, 0x01, 0x53, 0x00, 0x7f, 0xee, 0x13, 0x00, 0x06, 0xfb, 0x01, 0x9f,
+  0x00, 0x10, 0xb5, 0x05, 0x9a, 0x67, 0x10, 0xb8, 0x19, 0x00, 0xfe, 0xfa,
+  0x19, 0xc1, 0x09, 0x01, 0xf9, 0xff, 0xfa, 0x1a, 0x49, 0x01, 0x20, 0xf8,
+  0xf7, 0x7b, 0xff, 0xff, 0xf6, 0xf7, 0xc8, 0xfd, 0x50, 0xb9, 0x17, 0xfd,
+  0x48, 0x99, 0xa0, 0x06, 0x01, 0xd5, 0x01, 0x24, 0x05, 0xf5, 0xe0, 0x17,
+  0x01, 0x87, 0xc5, 0xf0, 0xf1, 0xd0, 0x00, 0x24, 0xd6, 0x0b, 0x01, 0xf9,
+  0xfe, 0x03, 0xb1, 0x10, 0x2d, 0x81, 0x20, 0x10, 0xff, 0x2b, 0x0e, 0xd2,
+  0x1b, 0x07, 0x43, 0xea, 0x12, 0x7f, 0x11, 0x10, 0x07, 0x06, 0x4a, 0x12,
+  0x68, 0x5b, 0x11, 0xe7, 0xef, 0xfc, 0x02, 0x01, 0x10, 0xe3, 0x72, 0x46,
+  0x64, 0xe7, 0xf3, 0x10, 0xbd, 0xb7, 0x41, 0xc7, 0x41, 0x76, 0x01, 0x00,
+  0x46, 0x7d, 0x0b, 0x8f, 0x40, 0x40, 0x42, 0x0f, 0x00, 0x7f, 0x0b, 0x00,
+  0xb3, 0x10, 0xb5, 0xf5, 0x61, 0x31, 0x01, 0xd6, 0xfc, 0x25, 0xd0, 0x34,
+  0xfb, 0x00, 0x21, 0xd1, 0x10, 0x02, 0x52, 0xf8, 0x21, 0x30, 0xfd, 0x83,
+  0x1d, 0x50, 0x0c, 0x46, 0x02, 0xe0, 0x49, 0x1c, 0xef, 0x09, 0x29, 0xf6,
+  0xd3, 0x6d, 0x01, 0xf4, 0xef, 0x02, 0xff, 0x00, 0xe8, 0xdf, 0x05, 0x00,
+  0xd0, 0xbf, 0x0b, 0xff, 0x00, 0xa0, 0x7f, 0x17, 0x00, 0x98, 0x9e, 0x19,
+  0xff, 0x00, 0x38, 0x07, 0x20, 0x00, 0x80, 0xb9, 0x2a, 0xff, 0x00, 0xe0,
+  0x7e, 0x46, 0x00, 0x60, 0x56, 0x6c, 0xff, 0x00, 0x00, 0x01, 0x02, 0x03,
+  0x04, 0x14, 0x24, 0xfd, 0x05, 0xdf, 0x21, 0x03, 0x02, 0x01, 0x00, 0xff,
+  0xff, 0xfc, 0x2b, 0x50, 0xe6, 0x31, 0x03, 0x08, 0x00, 0x10, 0x01, 0x64,
+  0xef, 0x02, 0x7d, 0x01, 0x7e, 0x01, 0x02, 0x79, 0x01, 0x7a, 0xdf, 0x01,
+  0x7b, 0x01, 0x7c, 0x01, 0x83, 0x00, 0x00, 0x86, 0x3f, 0x08, 0x01, 0x05,
+  0xe5, 0x5b, 0x35, 0x8a, 0xf0, 0x00, 0x00, 0xff, 0x01, 0x02, 0xff, 0x00,
+  0x54, 0x2c, 0x04, 0xf8, 0xfe, 0x0a, 0x00, 0x40, 0x00, 0x0d, 0xd2, 0x01,
+  0x0e, 0x7f, 0xff, 0x39, 0x0a, 0xd4, 0xd1, 0xf1, 0x1f, 0x01, 0x04, 0xff,
+  0xd4, 0xc0, 0x01, 0x40, 0xf0, 0x00, 0x40, 0xc8, 0x5f, 0x40, 0x70, 0x47,
+  0x7f, 0xf0, 0xcd, 0x20, 0x47, 0x54, 0x30, 0xdb, 0x47, 0x03, 0x23, 0x10,
+  0x18, 0xb9, 0x05, 0x01, 0x00, 0xf0, 0xbd, 0x07, 0x13, 0x00, 0x88, 0x02,
+  0x00, 0x20, 0x27, 0x40, 0x46, 0xff, 0x2d, 0xe9, 0xf8, 0x43, 0x88, 0x4c,
+  0x4f, 0xf4, 0xff, 0x94, 0x71, 0x04, 0xf1, 0x44, 0x00, 0xf9, 0xf7, 0xff,
+  0xa7, 0xff, 0x00, 0x25, 0x85, 0x4e, 0x0f, 0xf2, 0xff, 0x2c, 0x28, 0x85,
+  0x4f, 0x4f, 0xf4, 0xd4, 0x79, 0xff, 0x84, 0x48, 0x09, 0xfb, 0x05, 0x00,
+  0x49, 0x46, 0xff, 0x88, 0x30, 0xf5, 0xf7, 0xff, 0xf9, 0x94, 0x20, 0xf7,
+  0x00, 0xfb, 0x05, 0xd5, 0x10, 0x7a, 0x71, 0x01, 0x65, 0xff, 0x79, 0x69,
+  0x41, 0x65, 0x39, 0x6c, 0x81, 0x65, 0xff, 0x00, 0x20, 0x58, 0xf8, 0x25,
+  0x10, 0x08, 0x60, 0xff, 0x04, 0x20, 0xa8, 0x55, 0x6d, 0x1c, 0x02, 0x2d,
+  0xed, 0xe5, 0x17, 0x60, 0xf1, 0x83, 0x57, 0x01, 0x74, 0x48, 0xdf, 0xbf,
+  0xf8, 0xc8, 0x81, 0x80, 0x7a, 0x0c, 0xa9, 0x90, 0x00, 0xff, 0xf0, 0x03,
+  0x09, 0x00, 0x27, 0x29, 0xfa, 0x07, 0xff, 0xf0, 0xc0, 0x07, 0x35, 0xd5,
+  0x08, 0xf5, 0xb6, 0xfb, 0x70, 0x60, 0xb3, 0xf0, 0xd4, 0x71, 0x6c, 0x48,
+  0x27, 0xff, 0x61, 0x01, 0xfb, 0x07, 0x00, 0xc4, 0xf8, 0x08, 0xff, 0x80,
+  0x88, 0x30, 0x20, 0x60, 0x94, 0x21, 0x08, 0xfc, 0x87, 0x00, 0x11, 0x01,
+  0xe0, 0x60, 0xf4, 0xf7, 0xa4, 0xf8, 0xff, 0xe0, 0x68, 0x00, 0x21, 0x41,
+  0x60, 0x01, 0x60, 0xaf, 0x81, 0x60, 0xc1, 0x62, 0x77, 0x01, 0xc1, 0x15,
+  0x00, 0xae, 0xff, 0xf8, 0x20, 0x46, 0xfc, 0xf7, 0xf5, 0xfa, 0x06, 0xff,
+  0x00, 0x04, 0xd1, 0x01, 0x21, 0x20, 0x46, 0xfe, 0xef, 0xf7, 0x80, 0xfd,
+  0x06, 0xc5, 0x10, 0xfc, 0xf7, 0x05, 0xff, 0xfb, 0xe0, 0x68, 0x16, 0xb9,
+  0x01, 0x21, 0xc1, 0xef, 0x83, 0x03, 0xe0, 0x00, 0x05, 0x00, 0x06, 0x60,
+  0x35, 0xdd, 0x46, 0xf3, 0x61, 0xc2, 0xd3, 0x28, 0xe3, 0x10, 0xf2, 0x83,
+  0xfc, 0x0b, 0x10, 0xd5, 0xc0, 0x50, 0x49, 0x51, 0x49, 0x00, 0x22, 0xef,
+  0x08, 0x68, 0x0a, 0x60, 0x0f, 0x03, 0x4c, 0x48, 0x4d, 0x73, 0x48, 0x01,
+  0x0b, 0x00, 0x63, 0x70, 0x47, 0x48, 0x4e, 0xbd, 0xf0, 0xbf, 0xa1, 0x0c,
+  0x46, 0x80, 0x46, 0x44, 0xeb, 0x00, 0x08, 0xff, 0xf5, 0xa8, 0x19, 0xa0,
+  0x60, 0xc4, 0xf8, 0x10, 0xd5, 0x80, 0xab, 0x00, 0x70, 0x0f, 0x00, 0x60,
+  0xa3, 0x01, 0x91, 0x46, 0xfe, 0x07, 0x11, 0x08, 0xa0, 0x44, 0x30, 0xe0,
+  0x60, 0x01, 0xff, 0x27, 0xf4, 0xf7, 0x51, 0xf8, 0xa8, 0x19, 0x51, 0xff,
+  0x46, 0x44, 0x22, 0xfb, 0xf7, 0xd2, 0xff, 0x20, 0xbf, 0x68, 0x90, 0xf8,
+  0xa1, 0x11, 0x40, 0x8b, 0x00, 0xec, 0x7e, 0x8b, 0x00, 0x21, 0x68, 0x40,
+  0x8b, 0x08, 0x70, 0x07, 0x01, 0xef, 0x00, 0x8b, 0x48, 0x70, 0x29, 0x01,
+  0xfc, 0xf7, 0xca, 0xbf, 0xf8, 0x48, 0xb9, 0x0b, 0x25, 0x29, 0xaf, 0x00,
+  0xfe, 0xdb, 0xf7, 0xab, 0xdf, 0x00, 0x05, 0x60, 0x9b, 0x01, 0xf0, 0x87,
+  0xff, 0xe0, 0x68, 0x80, 0x8b, 0x10, 0xb9, 0x03, 0x25, 0xef, 0xf1, 0xe7,
+  0x7f, 0x1c, 0xcb, 0x01, 0x85, 0xfa, 0x05, 0x77, 0x00, 0x06, 0xd0, 0x09,
+  0x01, 0x9a, 0xfa, 0x15, 0x85, 0x81, 0x9f, 0x25, 0xe8, 0xe7, 0x20, 0x68,
+  0x93, 0x30, 0x11, 0x00, 0xb7, 0xfd, 0xf9, 0x3d, 0x01, 0xbd, 0xf8, 0x05,
+  0x46, 0xe0, 0x68, 0xff, 0xc1, 0x6a, 0x49, 0x1c, 0x00, 0x2d, 0xc1, 0x62,
+  0x7f, 0xec, 0xd1, 0x81, 0x68, 0x49, 0x1c, 0xb9, 0x2b, 0xc0, 0xff, 0x81,
+  0x60, 0xcf, 0xd0, 0xa1, 0x68, 0x09, 0x8b, 0xff, 0x8f, 0x42, 0xd9, 0xd3,
+  0xc0, 0x68, 0xf8, 0xf7, 0xff, 0x6f, 0xfe, 0x21, 0x68, 0xc1, 0xf8, 0x98,
+  0x01, 0xfb, 0xc4, 0xe7, 0xc5, 0x21, 0xd4, 0x74, 0x12, 0x49, 0xc8, 0xff,
+  0x22, 0x02, 0xfb, 0x00, 0x12, 0x0a, 0x49, 0x10, 0xff, 0x61, 0x01, 0xf5,
+  0xb6, 0x73, 0x53, 0x60, 0x91, 0xf7, 0x60, 0x0a, 0x4b, 0xd9, 0xa0, 0x33,
+  0x88, 0x33, 0x13, 0xfb, 0x60, 0x94, 0x47, 0xa0, 0x00, 0x10, 0x44, 0x30,
+  0xd0, 0xd7, 0x60, 0x00, 0x21, 0x17, 0x31, 0x10, 0x69, 0x00, 0xd0, 0xbc,
+  0x9f, 0x2c, 0x27, 0x00, 0x20, 0x8c, 0xdb, 0x71, 0xc3, 0x71, 0xb1, 0xfe,
+  0x2f, 0x50, 0x00, 0x40, 0x59, 0x00, 0x00, 0x50, 0x59, 0xf3, 0x6c, 0xe8,
+  0x0b, 0x07, 0x1f, 0xd1, 0xf9, 0xf7, 0x10, 0xff, 0xef, 0xf8, 0xf7, 0x88,
+  0xfd, 0x03, 0x40, 0xfa, 0x01, 0xf0, 0xfd, 0x54, 0xa1, 0x30, 0x98, 0xfe,
+  0xf7, 0xf7, 0x1f, 0xfe, 0xff, 0xff, 0xf7, 0x54, 0xfd, 0xfe, 0xf7, 0xd4,
+  0xfd, 0xbe, 0x4b, 0xa0, 0xfa, 0xfa, 0xf7, 0x8b, 0xfa, 0x33, 0x51, 0x54,
+  0xfd, 0x15, 0x0f, 0x50, 0x16, 0x36, 0xf8, 0x24, 0x00, 0x93, 0xff, 0x21,
+  0xf5, 0xf7, 0x0e, 0xf9, 0x06, 0xeb, 0x84, 0x7b, 0x00, 0x82, 0xd9, 0xf0,
+  0x5d, 0xf8, 0x00, 0xbf, 0x01, 0x01, 0x5d, 0x02, 0x0b, 0x00, 0x58, 0xf8,
+  0x35, 0x1f, 0x00, 0x8c, 0x1f, 0x00, 0x57, 0xfe, 0xf8, 0x05, 0x1f, 0x00,
+  0x80, 0x13, 0x00, 0x4d, 0x1f, 0x04, 0xfe, 0x2e, 0x60, 0xf0, 0x48, 0xf8,
+  0x64, 0x1c, 0x02, 0x2c, 0xfd, 0xdc, 0xc9, 0xb0, 0xe4, 0x06, 0xf7, 0xf7,
+  0x8a, 0xfc, 0xff, 0x00, 0x24, 0x4f, 0xf0, 0x0c, 0x08, 0x00, 0x27, 0xff,
+  0x08, 0xfb, 0x04, 0xf5, 0x09, 0xe0, 0xa8, 0x19, 0xf7, 0x40, 0x68, 0x08,
+  0x4b, 0x20, 0x18, 0xb1, 0x00, 0x68, 0xff, 0x01, 0x00, 0x18, 0xbf, 0x80,
+  0x47, 0x7f, 0x1c, 0xbf, 0xa8, 0x5d, 0x87, 0x42, 0xf2, 0xd3, 0x35, 0x01,
+  0xeb, 0xff, 0xd3, 0x12, 0x48, 0x12, 0x4a, 0x40, 0x89, 0x10, 0xff, 0xf0,
+  0x03, 0x01, 0x18, 0xbf, 0x01, 0x21, 0x91, 0xff, 0x60, 0xc0, 0xf3, 0x81,
+  0x01, 0x01, 0xb1, 0x4e, 0xdf, 0x21, 0x93, 0x68, 0x19, 0x43, 0x0d, 0x01,
+  0x01, 0x13, 0xef, 0x03, 0xb1, 0x4e, 0x23, 0x0b, 0x03, 0x82, 0x10, 0x00,
+  0xff, 0xb1, 0x08, 0x20, 0x08, 0x43, 0x90, 0x60, 0x00, 0x6b, 0x22, 0x70,
+  0x2d, 0x60, 0x8a, 0x2d, 0x60, 0xbe, 0xf8, 0xb9, 0x10, 0xdf, 0x41, 0xfb,
+  0xf7, 0x5e, 0xbd, 0x17, 0x11, 0xe0, 0xf2, 0xbf, 0x00, 0x20, 0x47, 0x88,
+  0x38, 0x46, 0xff, 0x50, 0xb8, 0xfe, 0x9f, 0xc1, 0x15, 0x46, 0x0e, 0x46,
+  0x28, 0x04, 0x48, 0xff, 0xbf, 0xf3, 0xf7, 0x40, 0xff, 0x26, 0x60, 0x28,
+  0xef, 0x06, 0x44, 0xbf, 0x05, 0xcb, 0xf0, 0x60, 0x60, 0xe8, 0xfb, 0x05,
+  0x48, 0x9f, 0x90, 0x03, 0xd4, 0xa8, 0x05, 0x02, 0xff, 0xd5, 0xe0, 0x68,
+  0x40, 0x1c, 0xe0, 0x60, 0x68, 0xfa, 0x11, 0x04, 0x28, 0x11, 0x00, 0x20,
+  0x69, 0x40, 0x1c, 0x20, 0xef, 0x61, 0xe8, 0x04, 0x44, 0x11, 0x00, 0xa0,
+  0x60, 0x28, 0xfe, 0x07, 0x00, 0xbd, 0xe8, 0x70, 0x40, 0xf3, 0xf7, 0x33,
+  0xbf, 0xbf, 0x70, 0xbd, 0x00, 0x00, 0x13, 0xfb, 0x31, 0x9a, 0xd7, 0x00,
+  0x01, 0x58, 0xa3, 0x60, 0x08, 0x0a, 0x00, 0x68, 0x6e, 0xfd, 0x01, 0x19,
+  0x40, 0x00, 0x00, 0xe6, 0x06, 0xe7, 0x06, 0xff, 0xe8, 0x06, 0xe9, 0x06,
+  0xe0, 0x08, 0xe1, 0x08, 0xff, 0xe2, 0x08, 0xe3, 0x08, 0x2d, 0xe9, 0xf1,
+  0x41, 0xff, 0xc0, 0xf3, 0xc7, 0x50, 0xff, 0x28, 0x81, 0xb0, 0xff, 0x0c,
+  0x46, 0x09, 0xd1, 0x01, 0x98, 0x00, 0x26, 0xf7, 0x40, 0x02, 0x02, 0x07,
+  0x01, 0x28, 0x18, 0xd4, 0x01, 0xff, 0x98, 0xbd, 0xe8, 0xf6, 0x81, 0x01,
+  0x28, 0x0b, 0xfb, 0xda, 0x01, 0x71, 0xa0, 0x0f, 0xff, 0x01, 0x28, 0x06,
+  0xff, 0xdb, 0x00, 0xf0, 0x45, 0xff, 0x22, 0x21, 0x01, 0xf7, 0x60, 0x5a,
+  0x48, 0x1b, 0x02, 0x99, 0x21, 0xf0, 0xff, 0xff, 0x41, 0x41, 0xf0, 0x7c,
+  0x51, 0x01, 0x91, 0xa0, 0xf7, 0xf1, 0x7e, 0x06, 0x37, 0x01, 0x07, 0xd5,
+  0x00, 0xf0, 0x97, 0x33, 0xff, 0x21, 0x23, 0x00, 0x6f, 0x5f, 0x40, 0x25,
+  0x01, 0x50, 0xff, 0x49, 0xf8, 0xf7, 0xcc, 0xfe, 0x06, 0xd2, 0x01, 0xff,
+  0x46, 0x4f, 0xf0, 0x80, 0x40, 0xf8, 0xf7, 0xd8, 0xff, 0xfe, 0x01, 0x90,
+  0x76, 0x1e, 0x01, 0x99, 0x4b, 0xff, 0x48, 0xf8, 0xf7, 0x36, 0xfe, 0x05,
+  0x46, 0x01, 0xff, 0x99, 0x4f, 0xf0, 0x7e, 0x50, 0xf8, 0xf7, 0x30, 0xef,
+  0xfe, 0x01, 0x46, 0x28, 0xf9, 0xe0, 0x3a, 0xfd, 0x07, 0xfb, 0x46, 0x39,
+  0x07, 0x00, 0xc4, 0xfe, 0x80, 0x46, 0x43, 0xbb, 0x48, 0x41, 0x09, 0x00,
+  0xbf, 0xfe, 0x42, 0x43, 0x00, 0x20, 0x5d, 0xfe, 0x0b, 0x01, 0xb9, 0xfe,
+  0x40, 0x0b, 0x00, 0x1a, 0x0b, 0x02, 0xed, 0xb3, 0x31, 0x04, 0x9f, 0xfd,
+  0x2f, 0x01, 0xac, 0xfe, 0x07, 0xeb, 0x46, 0x30, 0xb3, 0xe0, 0x00, 0xe7,
+  0x30, 0x84, 0xb9, 0x37, 0xdb, 0x48, 0x31, 0x13, 0x00, 0xa2, 0xfe, 0x19,
+  0x01, 0x8f, 0xfd, 0x7d, 0x29, 0x05, 0x00, 0x00, 0xfe, 0x04, 0x46, 0x33,
+  0x15, 0x02, 0xff, 0x97, 0xfe, 0x21, 0x46, 0x3c, 0xe0, 0x01, 0x2c, 0xaf,
+  0x23, 0xdb, 0x30, 0x48, 0x19, 0x01, 0x8f, 0x19, 0x00, 0x2e, 0xaa, 0x09,
+  0x02, 0x8a, 0x8f, 0x00, 0x2d, 0x23, 0x02, 0x85, 0x7d, 0x00, 0x2b, 0x55,
+  0x48, 0x3d, 0x01, 0x80, 0x65, 0x00, 0x40, 0x07, 0x00, 0x6c, 0x45, 0x02,
+  0xf7, 0xdd, 0xfd, 0x21, 0x05, 0x00, 0xda, 0xfd, 0x04, 0x46, 0xf5, 0x25,
+  0x27, 0x02, 0x71, 0x4b, 0x00, 0x16, 0xe0, 0x23, 0x4c, 0xab, 0x28, 0x46,
+  0x17, 0x01, 0x6a, 0x35, 0x00, 0x21, 0x49, 0x02, 0x65, 0x6a, 0x49, 0x00,
+  0x38, 0x13, 0x02, 0x60, 0xa5, 0x04, 0x4c, 0xfd, 0xb3, 0x01, 0x9b, 0xbd,
+  0xfd, 0x35, 0x01, 0xba, 0xfd, 0x19, 0x11, 0x71, 0x61, 0x0a, 0x5d, 0x48,
+  0x23, 0x01, 0x4e, 0xfe, 0x09, 0xd5, 0x00, 0xaf, 0x5b, 0x02, 0x2b, 0x48,
+  0xfe, 0x51, 0x31, 0x06, 0x0f, 0x00, 0xa7, 0xcb, 0x10, 0xb4, 0x90, 0xdf,
+  0xff, 0xf3, 0x04, 0x35, 0x3f, 0x07, 0x00, 0xbf, 0x15, 0xff, 0x02, 0x99,
+  0x3e, 0x11, 0xae, 0xcc, 0x3e, 0xc0, 0xff, 0xaa, 0x2a, 0x3f, 0xe8, 0xe8,
+  0xfb, 0x33, 0x16, 0xff, 0x72, 0x31, 0x3f, 0xd8, 0x5b, 0xde, 0x3e, 0x28,
+  0xff, 0x37, 0xa9, 0x32, 0xf4, 0x3e, 0xa1, 0x33, 0xd9, 0xfe, 0x0b, 0x00,
+  0x98, 0x20, 0x9a, 0x3e, 0x3b, 0xaa, 0xb8, 0xff, 0x3f, 0x60, 0x70, 0xa5,
+  0x32, 0xef, 0xf3, 0x11, 0xff, 0x80, 0x60, 0x21, 0x81, 0xf3, 0x11, 0x88,
+  0x70, 0xff, 0x47, 0x80, 0xb5, 0xff, 0xf7, 0xf7, 0xff, 0xdf, 0x77, 0xf8,
+  0x9c, 0x1a, 0x03, 0x00, 0x3a, 0x09, 0x68, 0x6f, 0xd0, 0xff, 0x42, 0x1a,
+  0x60, 0x04, 0xbd, 0xdf, 0xf8, 0x88, 0xcb, 0x3a, 0x01, 0x0b, 0x02, 0x80,
+  0x27, 0x02, 0x9f, 0x31, 0xdf, 0xf8, 0xeb, 0x7c, 0x6a, 0x03, 0x00, 0x4a,
+  0x03, 0x00, 0x5a, 0x82, 0xb0, 0xfb, 0x70, 0x89, 0xe3, 0x20, 0x10, 0x00,
+  0x28, 0x41, 0xd0, 0xdf, 0x07, 0x21, 0x05, 0xf1, 0x32, 0xb1, 0xb0, 0xa3,
+  0xfc, 0xf5, 0x00, 0x09, 0x00, 0x34, 0x09, 0x02, 0x30, 0x6c, 0xdf, 0xf8,
+  0xff, 0x5c, 0x8a, 0x00, 0x90, 0x23, 0x46, 0x13, 0x22, 0x7f, 0x05, 0xf1,
+  0x36, 0x01, 0x05, 0xf1, 0x38, 0x17, 0x00, 0xfb, 0x1b, 0xfc, 0xf1, 0x30,
+  0x90, 0x4f, 0xf4, 0x00, 0x63, 0xfb, 0x32, 0x6c, 0x15, 0x07, 0x45, 0xfc,
+  0x33, 0x6c, 0x22, 0xeb, 0x46, 0x0a, 0x3b, 0x00, 0x3a, 0x0d, 0x00, 0x21,
+  0xfc, 0x02, 0xff, 0x27, 0x0c, 0x20, 0xc0, 0x21, 0x00, 0xfb, 0x07, 0xfd,
+  0x80, 0xcb, 0x50, 0x81, 0x01, 0xf5, 0x2c, 0x71, 0x01, 0xfb, 0x60, 0x07,
+  0xd3, 0xf0, 0x41, 0x44, 0x01, 0xf2, 0xba, 0xff, 0x51, 0x41, 0x60, 0x7f,
+  0x1c, 0x18, 0x21, 0x01, 0xbf, 0x72, 0x2f, 0x21, 0x41, 0x72, 0x18, 0xc5,
+  0x30, 0x73, 0xdf, 0xfc, 0x04, 0x2f, 0xe6, 0xd3, 0x8d, 0x01, 0x82, 0x10,
+  0xab, 0xd0, 0xb1, 0x8b, 0x01, 0x40, 0x45, 0x00, 0x5d, 0x8b, 0x02, 0x42,
+  0x56, 0x09, 0x02, 0x70, 0x6d, 0x87, 0x05, 0x44, 0x71, 0x00, 0x46, 0x13,
+  0x00, 0xaf, 0xd7, 0xfb, 0x73, 0x6d, 0x71, 0x03, 0x48, 0x0d, 0x00, 0xe8,
+  0xff, 0xfb, 0xbd, 0xe8, 0xf3, 0x41, 0x00, 0xe0, 0x00, 0x7f, 0xbf, 0xf8,
+  0xb5, 0xdf, 0xf8, 0xa8, 0x49, 0x09, 0x10, 0xfb, 0x59, 0x0e, 0x2d, 0x00,
+  0x2e, 0x01, 0x20, 0x46, 0xfb, 0xb7, 0xf7, 0xf6, 0xfc, 0x0b, 0x01, 0x3c,
+  0x01, 0x99, 0xf0, 0x00, 0xff, 0xfb, 0xf7, 0xff, 0xfc, 0xa5, 0x88, 0x4f,
+  0xf6, 0xff, 0xfe, 0x70, 0x00, 0xea, 0x05, 0x06, 0x20, 0x78, 0xbf, 0x01,
+  0x06, 0x45, 0xf0, 0x01, 0x07, 0xdb, 0x21, 0x7f, 0xff, 0x00, 0x65, 0x84,
+  0xa5, 0x84, 0x65, 0x85, 0xa5, 0xff, 0x85, 0x20, 0x70, 0x1b, 0xe0, 0x02,
+  0x20, 0xf6, 0xff, 0xf7, 0x12, 0xfa, 0x00, 0x28, 0x14, 0xbf, 0x67, 0xaf,
+  0x84, 0x66, 0x84, 0x03, 0x0d, 0x00, 0x0b, 0x0d, 0x02, 0xa7, 0xaf, 0x84,
+  0xa6, 0x84, 0x10, 0x0d, 0x00, 0x04, 0x1b, 0x03, 0x85, 0xb7, 0x66, 0x85,
+  0x11, 0x0d, 0x00, 0xfd, 0xf9, 0x1b, 0x02, 0x85, 0x7f, 0xa6, 0x85, 0x20,
+  0x7c, 0x01, 0x06, 0x04, 0x4d, 0x02, 0x7f, 0x25, 0x85, 0x20, 0x74, 0x06,
+  0xe0, 0x12, 0x1d, 0x00, 0xfd, 0xee, 0x1d, 0x02, 0x27, 0x85, 0x26, 0x85,
+  0x21, 0x78, 0xff, 0x60, 0x88, 0x00, 0x29, 0x0e, 0xbf, 0x40, 0xf0, 0xff,
+  0x10, 0x00, 0x4f, 0xf6, 0xef, 0x71, 0x08, 0x40, 0xbf, 0x60, 0x80, 0x21,
+  0x7c, 0x60, 0x8a, 0x13, 0x0c, 0x82, 0xfd, 0xf1, 0x37, 0xa0, 0x0f, 0xf6,
+  0x50, 0x11, 0x0f, 0xf6, 0xff, 0x2c, 0x12, 0x51, 0xf8, 0x20, 0x30, 0xdf,
+  0xf8, 0xff, 0xd4, 0x18, 0x0f, 0xf6, 0x60, 0x14, 0xdf, 0xf8, 0xff, 0xd0,
+  0x58, 0x0b, 0x63, 0x52, 0xf8, 0x20, 0x20, 0xbf, 0x34, 0xf8, 0x10, 0x40,
+  0x2c, 0x80, 0x93, 0xa0, 0x00, 0xff, 0x00, 0x24, 0x1c, 0x70, 0xdf, 0xf8,
+  0xbc, 0x38, 0xff, 0xd4, 0x88, 0x5c, 0x80, 0x14, 0x89, 0x9c, 0x80, 0xff,
+  0x54, 0x89, 0xdc, 0x80, 0x94, 0x89, 0x1c, 0x81, 0xff, 0x0c, 0x6b, 0xdf,
+  0xf8, 0xac, 0x18, 0xa5, 0x89, 0xff, 0x1d, 0x82, 0xe5, 0x89, 0x5d, 0x82,
+  0x25, 0x8a, 0xbf, 0x9d, 0x82, 0x64, 0x8a, 0xdc, 0x82, 0x2d, 0x00, 0x80,
+  0xff, 0x00, 0x8c, 0x18, 0x80, 0x50, 0x88, 0x08, 0x80, 0xfd, 0x30, 0x23,
+  0x20, 0x84, 0x08, 0x4f, 0xf4, 0xc0, 0x41, 0xff, 0x01, 0x80, 0xdf, 0xf8,
+  0x74, 0x18, 0x0a, 0x6b, 0xff, 0x7a, 0xb1, 0xb0, 0xf9, 0x10, 0x30, 0x93,
+  0x81, 0xdf, 0xb0, 0xf9, 0x12, 0x30, 0xd3, 0x05, 0x00, 0x14, 0x30, 0xff,
+  0x13, 0x82, 0xb0, 0xf9, 0x16, 0x00, 0x50, 0x82, 0xaf, 0x01, 0x20, 0x10,
+  0x70, 0x73, 0x40, 0x63, 0x5b, 0xa1, 0x04, 0xff, 0x46, 0x0f, 0xf6, 0xb4,
+  0x00, 0xdf, 0xf8, 0x40, 0xff, 0x78, 0x50, 0xf8, 0x24, 0x50, 0x0f, 0xf6,
+  0x88, 0xfd, 0x00, 0x07, 0x00, 0x60, 0x0f, 0xf6, 0xc0, 0x00, 0x30, 0xff,
+  0xf8, 0x14, 0x10, 0xdf, 0xf8, 0x2c, 0x08, 0xf7, 0xff, 0xf7, 0x30, 0xf8,
+  0xf1, 0x88, 0xdf, 0xf8, 0x30, 0xfe, 0x09, 0x00, 0x2b, 0xf8, 0x31, 0x89,
+  0xdf, 0xf8, 0x28, 0xae, 0x09, 0x00, 0x26, 0xf8, 0x71, 0x09, 0x00, 0x24,
+  0x09, 0x00, 0x21, 0xeb, 0xf8, 0xb1, 0x09, 0x00, 0x1c, 0x09, 0x00, 0x1c,
+  0xf8, 0xa9, 0xba, 0x09, 0x00, 0x18, 0x09, 0x00, 0x17, 0xf8, 0xe9, 0x09,
+  0x00, 0x10, 0xfe, 0x09, 0x00, 0x12, 0xf8, 0x29, 0x8a, 0xdf, 0xf8, 0x0c,
+  0xae, 0x09, 0x00, 0x0d, 0xf8, 0x69, 0x09, 0x00, 0x04, 0x09, 0x00, 0x08,
+  0x7f, 0xf8, 0x29, 0x46, 0x07, 0xf1, 0x30, 0x00, 0x4f, 0x01, 0x7f, 0x00,
+  0x21, 0x28, 0x46, 0xf6, 0xf7, 0xef, 0xf3, 0x20, 0x7b, 0xc8, 0x57, 0x0b,
+  0x03, 0xf9, 0xff, 0x07, 0xeb, 0x37, 0x80, 0xdd, 0x8c, 0x0b, 0x01, 0xf3,
+  0xff, 0x71, 0x79, 0x00, 0xb0, 0x07, 0xff, 0xbd, 0xe8, 0xf4, 0x40, 0xf6,
+  0xf7, 0xec, 0xbf, 0xad, 0x70, 0x11, 0x20, 0xa0, 0x47, 0xe5, 0x01, 0x20,
+  0x1d, 0x00, 0xe4, 0xfe, 0x35, 0x00, 0x88, 0x57, 0x2e, 0x6b, 0xf6, 0xb1,
+  0x21, 0xff, 0x8a, 0x06, 0xf1, 0x0c, 0x00, 0xf6, 0xf7, 0xdb, 0xeb, 0xff,
+  0x61, 0x09, 0x00, 0x0e, 0x09, 0x00, 0xd6, 0xff, 0xa1, 0xba, 0x09, 0x00,
+  0x10, 0x09, 0x00, 0xd1, 0xff, 0xe1, 0x09, 0x00, 0x12, 0xbe, 0x09, 0x00,
+  0xcc, 0xff, 0x01, 0x21, 0x30, 0x37, 0x00, 0xb8, 0xf3, 0xff, 0x05, 0x7d,
+  0x00, 0x8b, 0x51, 0x00, 0x21, 0xf6, 0xf7, 0xfd, 0xe9, 0x8d, 0x50, 0xdf,
+  0xf8, 0x38, 0x17, 0xdf, 0xf8, 0xff, 0x50, 0x07, 0xca, 0x8e, 0x4f, 0xf6,
+  0xe0, 0x73, 0xff, 0x1a, 0x40, 0x02, 0x80, 0x09, 0x8f, 0xc8, 0xe0, 0xe4,
+  0xdf, 0x00, 0x15, 0x00, 0x3c, 0x15, 0x00, 0x0f, 0x01, 0x41, 0x80, 0x70,
+  0xfd, 0x47, 0x7f, 0x01, 0x48, 0x17, 0x82, 0xb0, 0x00, 0x20, 0x7f, 0x88,
+  0x61, 0xdf, 0xf8, 0xfc, 0x46, 0x60, 0xe7, 0x20, 0xbd, 0x81, 0x51, 0xe0,
+  0xdf, 0xf8, 0xf8, 0x56, 0xeb, 0x21, 0x24, 0xae, 0xbf, 0x20, 0xe7, 0xfa,
+  0x0c, 0x09, 0x00, 0x26, 0x09, 0x02, 0xe0, 0xbe, 0xa1, 0x30, 0xdc, 0x66,
+  0x00, 0x90, 0x33, 0xef, 0x22, 0x28, 0xfa, 0xef, 0x20, 0x2a, 0x17, 0x00,
+  0x5f, 0xfa, 0xe3, 0x6a, 0x32, 0xca, 0xef, 0x22, 0x2c, 0x0d, 0x00, 0x70,
+  0x41, 0x70, 0xf3, 0x10, 0x56, 0x0c, 0xfe, 0x89, 0x80, 0x04, 0x50, 0x05,
+  0xeb, 0x44, 0x21, 0x30, 0x7f, 0x31, 0x01, 0x60, 0x05, 0xeb, 0xc4, 0x01,
+  0xd1, 0x70, 0xbf, 0x61, 0x41, 0x60, 0x64, 0x1c, 0xc0, 0x5f, 0x30, 0xff,
+  0xfa, 0x5f, 0x30, 0x40, 0x5f, 0x30, 0xc3, 0xfa, 0x02, 0x2c, 0xe9, 0xd3,
+  0xd3, 0x73, 0x07, 0xb0, 0x33, 0x00, 0x46, 0x03, 0x00, 0x16, 0x0e, 0xad,
+  0x22, 0x17, 0x31, 0x7a, 0xfb, 0xff, 0x21, 0x03, 0xad, 0x22, 0x20, 0xef,
+  0x70, 0x17, 0xe0, 0x00, 0xab, 0x20, 0x98, 0xf8, 0xa1, 0xff, 0x88, 0x00,
+  0x28, 0x12, 0xbf, 0x41, 0xf0, 0x01, 0xfe, 0x8d, 0x20, 0xfe, 0x70, 0x08,
+  0x40, 0xa0, 0x80, 0x01, 0xfe, 0x17, 0x00, 0x8c, 0xf8, 0x00, 0x28, 0xa0,
+  0x88, 0x12, 0xea, 0xa5, 0x20, 0x02, 0x17, 0x00, 0xfd, 0xa5, 0x20, 0xa0,
+  0x80, 0x00, 0xdf, 0x20, 0x20, 0x61, 0x06, 0x21, 0x0f, 0xb0, 0x30, 0xa0,
+  0xff, 0x82, 0x02, 0x20, 0xf9, 0xf7, 0x93, 0xfc, 0xdf, 0xff, 0xf8, 0x64,
+  0x06, 0x4f, 0xf6, 0xff, 0x71, 0x01, 0xdd, 0x80, 0x05, 0x00, 0x61, 0x41,
+  0x80, 0x15, 0x01, 0x6d, 0xfc, 0x7e, 0x05, 0x01, 0x70, 0xfc, 0x61, 0x88,
+  0x23, 0x78, 0x09, 0x10, 0xfd, 0x06, 0x03, 0x00, 0x26, 0x33, 0xb9, 0x00,
+  0xf0, 0x11, 0xdf, 0xf8, 0x01, 0x20, 0xa0, 0x61, 0x11, 0x51, 0x39, 0xe0,
+  0x3f, 0x4e, 0xf6, 0xef, 0x73, 0x19, 0x40, 0x9b, 0xa0, 0xdb, 0x10, 0xff,
+  0x01, 0x82, 0x41, 0x82, 0x01, 0x83, 0x41, 0x83, 0xdf, 0xa1, 0x61, 0x10,
+  0xbd, 0x11, 0x47, 0x00, 0xfc, 0x72, 0xdf, 0xa1, 0x88, 0x11, 0x40, 0x01,
+  0x49, 0x10, 0xdf, 0xf8, 0x3f, 0x00, 0x06, 0x00, 0x21, 0x81, 0x61, 0x13,
+  0x01, 0x75, 0x00, 0x37, 0x31, 0x81, 0x82, 0x43, 0x10, 0x05, 0x01, 0x1d,
+  0x02, 0x63, 0x01, 0xfb, 0x47, 0xbc, 0x39, 0x10, 0x15, 0xdf, 0xf8, 0xec,
+  0x05, 0x7b, 0x0a, 0x89, 0x93, 0x15, 0x49, 0x89, 0x19, 0x40, 0x85, 0x11,
+  0x17, 0xdf, 0xf8, 0xc4, 0x19, 0x00, 0xd4, 0x19, 0x00, 0x13, 0x01, 0x11,
+  0x01, 0x6e, 0x29, 0x41, 0xb0, 0x45, 0xa0, 0xa4, 0xf0, 0x5d, 0xd0, 0x09,
+  0x00, 0xeb, 0x55, 0x28, 0x15, 0x40, 0xfc, 0xd7, 0x00, 0x28, 0x80, 0x00,
+  0xff, 0xf0, 0x9f, 0xfa, 0x20, 0x79, 0x00, 0x27, 0xc0, 0xed, 0x07, 0x65,
+  0x00, 0x36, 0x05, 0x29, 0xd0, 0x00, 0xf0, 0x84, 0xff, 0xfd, 0x08, 0xb9,
+  0x26, 0x8a, 0x01, 0x27, 0x20, 0xbf, 0x79, 0x80, 0x07, 0x09, 0xd5, 0x01,
+  0x11, 0x00, 0x7b, 0xff, 0xfd, 0x28, 0xb9, 0x60, 0x8a, 0x86, 0x42, 0x47,
+  0xff, 0xf0, 0x02, 0x07, 0x28, 0xbf, 0x06, 0x46, 0x22, 0xfe, 0xa9, 0x20,
+  0x28, 0x05, 0x0a, 0x21, 0x96, 0x42, 0x01, 0xff, 0xfb, 0x06, 0x01, 0x06,
+  0xd2, 0x91, 0xf8, 0x5a, 0xdf, 0x20, 0xd2, 0x07, 0x5c, 0xbf, 0x45, 0x10,
+  0x72, 0x17, 0x5f, 0x40, 0x62, 0x8a, 0x96, 0x42, 0x13, 0x03, 0x92, 0x13,
+  0x02, 0xfd, 0xfd, 0x13, 0x00, 0xbf, 0xb1, 0xb0, 0xf8, 0x58, 0x00, 0xff,
+  0x86, 0x42, 0x32, 0xbf, 0x01, 0xf1, 0x5a, 0x00, 0xfe, 0xc3, 0xa0, 0x1d,
+  0x41, 0x88, 0x69, 0x80, 0x81, 0x88, 0xff, 0xa9, 0x80, 0xc1, 0x88, 0xe9,
+  0x80, 0x01, 0x89, 0xfb, 0x29, 0x81, 0x91, 0x01, 0x00, 0x88, 0x08, 0x40,
+  0x38, 0x7f, 0x43, 0x28, 0x80, 0x30, 0x46, 0x01, 0xe0, 0x6b, 0x11, 0xff,
+  0x47, 0xea, 0x06, 0x11, 0xa0, 0x82, 0x3d, 0x20, 0xfe, 0xdf, 0x21, 0xf9,
+  0xf7, 0x5c, 0xbc, 0xf1, 0xbd, 0x38, 0x6e, 0x91, 0x30, 0xff, 0xf7, 0xf5,
+  0x7d, 0x10, 0xe0, 0x14, 0x75, 0x70, 0xf7, 0xeb, 0x44, 0x01, 0xa9, 0x30,
+  0x82, 0x00, 0x22, 0x00, 0x6c, 0x1d, 0xb0, 0x79, 0xb0, 0xf8, 0x85, 0xff,
+  0x50, 0x31, 0xbd, 0xb7, 0x31, 0x77, 0x0d, 0x46, 0x16, 0x29, 0x00, 0xe0,
+  0xfc, 0x07, 0x05, 0x20, 0xd7, 0xc0, 0x04, 0x01, 0xf1, 0x01, 0x72, 0x3d,
+  0x11, 0x14, 0xb9, 0xdf, 0x05, 0x82, 0x46, 0x82, 0x03, 0x39, 0x70, 0x04,
+  0xbf, 0xff, 0x05, 0x83, 0x46, 0x83, 0xff, 0xf7, 0x70, 0xff, 0xed, 0x87,
+  0x35, 0x00, 0xf1, 0xbd, 0xc9, 0xb1, 0x80, 0x46, 0x0f, 0xff, 0xf2, 0xc4,
+  0x40, 0x50, 0xf8, 0x28, 0x50, 0x0e, 0xfb, 0x46, 0x17, 0x3f, 0x00, 0xc6,
+  0xfc, 0x04, 0x46, 0x89, 0xff, 0x46, 0xf9, 0xf7, 0x9c, 0xfd, 0x40, 0x45,
+  0x0a, 0xb9, 0xd1, 0x07, 0x40, 0x49, 0x02, 0xfe, 0x72, 0x0a, 0x6f, 0x10,
+  0x06, 0xff, 0x82, 0x47, 0x82, 0x01, 0x80, 0x03, 0xe0, 0xae, 0xff, 0x81,
+  0xef, 0x81, 0x01, 0x20, 0x28, 0x70, 0x20, 0xfb, 0x46, 0x49, 0xdf, 0xa0,
+  0xf4, 0x43, 0xb7, 0xe4, 0x00, 0xfd, 0x28, 0x29, 0x00, 0x14, 0x0c, 0xbf,
+  0x01, 0x20, 0x02, 0xd3, 0x20, 0x89, 0xd3, 0x00, 0xcf, 0x12, 0x14, 0xc1,
+  0x41, 0x90, 0xf8, 0x38, 0x44, 0xa0, 0x6f, 0x20, 0x11, 0x01, 0x1c, 0x24,
+  0x02, 0xd3, 0x41, 0x05, 0x20, 0x7f, 0x2e, 0xe7, 0x2d, 0xe9, 0xfc, 0x47,
+  0x06, 0xa9, 0x00, 0xdf, 0xd4, 0x93, 0x0c, 0x20, 0x88, 0x79, 0x00, 0x00,
+  0xfb, 0xdf, 0x06, 0x9a, 0x39, 0x46, 0x50, 0xd3, 0x00, 0x6a, 0xf9, 0xef,
+  0x00, 0x25, 0x20, 0xb1, 0x0b, 0x03, 0x58, 0xf9, 0x05, 0xb6, 0x23, 0x00,
+  0xf0, 0x73, 0xfd, 0x00, 0x43, 0x38, 0xc3, 0x14, 0x38, 0xff, 0x80, 0x06,
+  0xbb, 0xb7, 0xf9, 0x10, 0x00, 0xad, 0xbe, 0x20, 0xd0, 0x6a, 0x46, 0xb7,
+  0xf9, 0x12, 0x09, 0x00, 0x02, 0xeb, 0x00, 0x41, 0x09, 0x00, 0x14, 0x09,
+  0x00, 0x04, 0x00, 0xb7, 0xbe, 0xd3, 0x40, 0xad, 0xf8, 0x06, 0x00, 0x48,
+  0x3f, 0x00, 0x59, 0xff, 0xf9, 0x3d, 0xb1, 0x28, 0x88, 0x38, 0x82, 0x68,
+  0xff, 0x88, 0x78, 0x82, 0xa8, 0x88, 0xb8, 0x82, 0xe8, 0xf7, 0x88, 0xf8,
+  0x82, 0xd9, 0x20, 0x82, 0x21, 0xe0, 0x01, 0xbf, 0x2e, 0x1f, 0xd1, 0xb7,
+  0xf9, 0x18, 0x45, 0x06, 0x1a, 0x4a, 0x45, 0x06, 0x1c, 0x45, 0x04, 0x1e,
+  0x45, 0x02, 0x85, 0x01, 0x36, 0x45, 0x03, 0xd5, 0x83, 0x45, 0x00, 0x83,
+  0x45, 0x00, 0x83, 0x45, 0x00, 0x83, 0x00, 0xbf, 0x20, 0x60, 0x82, 0xff,
+  0xf7, 0xcb, 0xf5, 0x70, 0xf3, 0xfd, 0x87, 0xcb, 0x03, 0x04, 0x2e, 0x8a,
+  0x46, 0x14, 0x46, 0xbf, 0x57, 0xda, 0xc0, 0x48, 0x0c, 0x21, 0x25, 0x20,
+  0x08, 0xa1, 0x21, 0x7f, 0x80, 0xa1, 0x10, 0xcd, 0x02, 0x0b, 0x03, 0xf1,
+  0xd5, 0xb0, 0xff, 0xef, 0xf7, 0x15, 0xfc, 0x02, 0x8f, 0xf0, 0x89, 0x46,
+  0x02, 0xff, 0xd1, 0xf5, 0xf7, 0x1c, 0xf9, 0x01, 0xe0, 0xf5, 0xef, 0xf7,
+  0x2d, 0xf9, 0x06, 0x71, 0x10, 0xe3, 0xfc, 0xb0, 0xbf, 0x42, 0x25, 0xd1,
+  0xb4, 0x4e, 0x37, 0xc1, 0x62, 0x38, 0xbf, 0x40, 0x30, 0x80, 0x6a, 0x46,
+  0xb6, 0xe7, 0x04, 0x51, 0x94, 0x09, 0x00, 0xe7, 0x03, 0xb6, 0xe5, 0x04,
+  0xb6, 0xe5, 0x04, 0x57, 0x01, 0xe6, 0x55, 0xf8, 0x9f, 0x01, 0x30, 0xe5,
+  0x00, 0x70, 0xe5, 0x00, 0xb0, 0xe5, 0x00, 0xff, 0xf0, 0x82, 0x37, 0x80,
+  0x0e, 0xe0, 0x6d, 0xb1, 0xff, 0x0f, 0xf2, 0xe8, 0x20, 0x50, 0xf8, 0x26,
+  0x00, 0xff, 0x29, 0x88, 0x81, 0x81, 0x69, 0x88, 0xc1, 0x81, 0xbf, 0xa9,
+  0x88, 0x01, 0x82, 0xe9, 0x88, 0x83, 0x30, 0x21, 0xdd, 0x01, 0xbd, 0x12,
+  0xff, 0xf7, 0xda, 0x5d, 0x71, 0x87, 0x10, 0xff, 0xf1, 0x14, 0x0f, 0xb8,
+  0xbf, 0x1f, 0x20, 0x04, 0xef, 0xdb, 0x0a, 0x28, 0xac, 0x9d, 0xa0, 0xc0,
+  0xf1, 0x0a, 0xff, 0x00, 0x80, 0xb2, 0x70, 0x47, 0x10, 0xb5, 0x91, 0xff,
+  0x42, 0x04, 0x46, 0x05, 0xd2, 0xb2, 0xfb, 0xf1, 0xfd, 0xf0, 0xed, 0x30,
+  0xfa, 0x24, 0x1a, 0x06, 0xe0, 0x8a, 0xbf, 0x42, 0x04, 0xd2, 0xb1, 0xfb,
+  0xf2, 0x0f, 0x00, 0x65, 0xe7, 0xfa, 0x04, 0x19, 0x15, 0xf1, 0xa3, 0x21,
+  0x1f, 0x2a, 0xac, 0xbf, 0xbf, 0x6f, 0xf0, 0x14, 0x00, 0xc2, 0x39, 0x00,
+  0x0d, 0x6f, 0x46, 0x04, 0x9a, 0x19, 0x8b, 0x21, 0xff, 0xff, 0x37, 0xd0,
+  0xff, 0x21, 0x88, 0x4e, 0xf2, 0xff, 0x02, 0x11, 0x40, 0xff, 0x41, 0xea,
+  0x00, 0x21, 0x21, 0x80, 0x29, 0x88, 0xff, 0x17, 0xe0, 0x38, 0xb5, 0x05,
+  0x46, 0x0f, 0x29, 0xfb, 0x14, 0x46, 0x31, 0x01, 0x0e, 0x00, 0x48, 0x42,
+  0x1a, 0xae, 0x71, 0x90, 0xff, 0xf7, 0xc9, 0xdb, 0xf0, 0x58, 0x7b, 0x00,
+  0x04, 0xff, 0xd5, 0x10, 0xf1, 0x0e, 0x0f, 0xb4, 0xbf, 0x0f, 0xbf, 0x20,
+  0x40, 0x42, 0x29, 0x88, 0x4f, 0x3b, 0x05, 0x20, 0xfb, 0x28, 0x80, 0xe7,
+  0x21, 0x05, 0x46, 0x0c, 0x46, 0x10, 0xff, 0x46, 0x1e, 0x46, 0xf7, 0xf7,
+  0xf1, 0xff, 0x79, 0xe6, 0x6d, 0x90, 0x8c, 0xf9, 0x3f, 0xa0, 0x0d, 0x00,
+  0xea, 0xff, 0x01, 0xee, 0xb9, 0x90, 0xf7, 0xf7, 0xf6, 0x73, 0x00, 0x64,
+  0xf8, 0x06, 0xef, 0x99, 0x46, 0x1a, 0x30, 0x15, 0xc0, 0x01, 0x20, 0xc0,
+  0xdf, 0xb2, 0xf9, 0xf7, 0xd5, 0xf9, 0x21, 0x01, 0xd9, 0xff, 0xf6, 0x61,
+  0x30, 0x37, 0x39, 0x69, 0x00, 0x5e, 0xfa, 0x01, 0x46, 0xed, 0x6b, 0xc7,
+  0xa0, 0x5e, 0xf8, 0xd7, 0xa0, 0xf9, 0xff, 0xf7, 0xff, 0x80, 0xff, 0x2a,
+  0x88, 0x01, 0x02, 0xc2, 0xf3, 0xe7, 0x04, 0x23, 0x98, 0xdb, 0x00, 0xad,
+  0x00, 0x03, 0x1a, 0x40, 0xbf, 0x0a, 0x43, 0x2a, 0x80, 0x22, 0x88, 0x13,
+  0x08, 0x00, 0xff, 0x10, 0x40, 0x08, 0x43, 0x20, 0x80, 0xf1, 0xbd, 0x7f,
+  0x02, 0x88, 0x61, 0xf3, 0x0a, 0x22, 0x02, 0x65, 0x40, 0xff, 0x02, 0x88,
+  0x02, 0xf4, 0x7f, 0x42, 0x11, 0x43, 0xfe, 0xbf, 0x41, 0x40, 0x68, 0xc9,
+  0x08, 0xf4, 0xf7, 0x5b, 0xbd, 0xba, 0x0b, 0x11, 0x00, 0xf0, 0x3e, 0xf8,
+  0x17, 0xf0, 0x28, 0xff, 0x5c, 0xbf, 0x21, 0x68, 0x01, 0xeb, 0xc0, 0x05,
+  0xd7, 0x28, 0x46, 0x32, 0x23, 0x10, 0x05, 0x17, 0x00, 0x32, 0xf8, 0xff,
+  0x00, 0x24, 0x00, 0x28, 0x0b, 0xd4, 0x69, 0x68, 0xfb, 0xc2, 0x10, 0xad,
+  0xf1, 0x51, 0x5c, 0x01, 0x22, 0x02, 0xff, 0xfa, 0x00, 0xf0, 0x08, 0x40,
+  0x01, 0x28, 0xa8, 0xcf, 0xbf, 0x01, 0x24, 0x20, 0x29, 0x00, 0x5f, 0xc3,
+  0x00, 0xf0, 0xed, 0x1c, 0x95, 0x50, 0x18, 0xd4, 0x25, 0x00, 0x02, 0x01,
+  0x23, 0xff, 0x03, 0xfa, 0x02, 0xf2, 0x63, 0x68, 0xc1, 0x10, 0xff, 0xce,
+  0x5c, 0x96, 0x43, 0xce, 0x54, 0x23, 0x68, 0xff, 0x03, 0xeb, 0xc0, 0x00,
+  0x2b, 0x88, 0x03, 0x80, 0xff, 0x6b, 0x88, 0x43, 0x80, 0xab, 0x88, 0x83,
+  0x80, 0xff, 0xeb, 0x88, 0xc3, 0x80, 0x60, 0x68, 0x0b, 0x5c, 0xff, 0x1a,
+  0x43, 0x0a, 0x54, 0x70, 0xbd, 0x03, 0x7a, 0xfe, 0xe9, 0x00, 0x32, 0x99,
+  0x42, 0x22, 0xbf, 0x40, 0x7a, 0xbf, 0x88, 0x42, 0xca, 0x1a, 0x10, 0x46,
+  0xa9, 0x61, 0x3c, 0xbe, 0x45, 0x50, 0x14, 0xfa, 0x29, 0x48, 0x04, 0x47,
+  0x32, 0x21, 0x7e, 0x19, 0x40, 0x00, 0xf0, 0x19, 0xf8, 0x22, 0x48, 0x09,
+  0x80, 0xff, 0x10, 0x00, 0x29, 0x10, 0xd4, 0x00, 0x22, 0x0f, 0xff, 0xf2,
+  0xec, 0x03, 0x33, 0xf8, 0x12, 0x50, 0x2c, 0xff, 0x42, 0x06, 0xd0, 0x00,
+  0xeb, 0x42, 0x05, 0x2e, 0xff, 0x8a, 0xb1, 0x42, 0xa4, 0xbf, 0x76, 0x1c,
+  0x2e, 0xbf, 0x82, 0x52, 0x1c, 0x02, 0x2a, 0xf1, 0xfd, 0xf0, 0x70, 0xff,
+  0x40, 0x51, 0xe5, 0x4f, 0xf4, 0x80, 0x70, 0x16, 0xeb, 0x49, 0x08, 0xff,
+  0x53, 0xb9, 0xea, 0xa0, 0xe1, 0x00, 0xe0, 0xf9, 0x80, 0x03, 0x00, 0x27,
+  0xd1, 0x00, 0x00, 0xa6, 0x0e, 0x4c, 0xfd, 0x1f, 0x47, 0xe0, 0xa2, 0x00,
+  0x20, 0x0c, 0xc8, 0x00, 0xff, 0x20, 0x02, 0x08, 0x00, 0x41, 0x20, 0x01,
+  0x00, 0xab, 0x41, 0xfe, 0x03, 0x00, 0x22, 0x03, 0x00, 0x24, 0x03, 0x00,
+  0x26, 0xaa, 0x03, 0x00, 0x28, 0x03, 0x00, 0x30, 0x03, 0x00, 0x32, 0x03,
+  0x00, 0x34, 0xaa, 0x03, 0x00, 0x36, 0x03, 0x00, 0xc4, 0x63, 0xd0, 0x6c,
+  0x3b, 0x00, 0x08, 0xaa, 0x33, 0x00, 0x00, 0x0f, 0x00, 0xfc, 0x03, 0x00,
+  0x04, 0x1f, 0x01, 0x80, 0x3f, 0x37, 0x3a, 0x48, 0xe1, 0x9a, 0xbf, 0x55,
+  0xb1, 0x53, 0x01, 0xc4, 0x03, 0x01, 0x0b, 0x01, 0x1c, 0x0b, 0x04, 0x0f,
+  0x05, 0x00, 0x01, 0x64, 0x20, 0xa7, 0x00, 0x20, 0x78, 0x03, 0x00, 0x0b,
+  0x01, 0x8c, 0x07, 0x00, 0xa0, 0xd2, 0x03, 0x00, 0xb4, 0x0f, 0x04, 0x00,
+  0x02, 0x10, 0x07, 0x07, 0x01, 0x00, 0xff, 0x02, 0x00, 0x1f, 0xb5, 0x00,
+  0xf0, 0xb7, 0xf8, 0xba, 0xf7, 0xc1, 0x1f, 0x5b, 0x20, 0x0c, 0x46, 0x2b,
+  0x51, 0x20, 0x6b, 0xde, 0x73, 0x40, 0x12, 0xd8, 0x2a, 0x4e, 0xf1, 0xb1,
+  0x5d, 0xf8, 0x7f, 0x29, 0x49, 0xf7, 0xf7, 0xbe, 0xff, 0x07, 0x0b, 0xc0,
+  0xd5, 0x31, 0x43, 0x20, 0xb9, 0x65, 0x24, 0xc3, 0x27, 0xc0, 0x44, 0xf0,
+  0xdf, 0x01, 0x04, 0x28, 0x46, 0x22, 0x31, 0x00, 0x38, 0xf8, 0xf7, 0x03,
+  0xd3, 0x21, 0x07, 0x00, 0x4e, 0xf9, 0x21, 0xd8, 0xee, 0x45, 0xc1, 0x42,
+  0xf8, 0x06, 0x2f, 0x02, 0xf8, 0xf7, 0x3d, 0xeb, 0xf8, 0x1c, 0x17, 0x00,
+  0x3a, 0xdf, 0x80, 0xf7, 0xf7, 0x9b, 0xef, 0xff, 0x05, 0x46, 0x19, 0x7d,
+  0xc2, 0x32, 0xf8, 0x18, 0xb6, 0x55, 0x00, 0x93, 0xff, 0x0b, 0x01, 0x2c,
+  0xf8, 0x47, 0xd0, 0x51, 0x57, 0xf7, 0xf7, 0x8c, 0x59, 0x00, 0x28, 0x25,
+  0x00, 0x96, 0x59, 0x00, 0xff, 0xa0, 0x07, 0x48, 0xbf, 0x85, 0xf0, 0x00,
+  0x45, 0xfd, 0x14, 0x21, 0x20, 0x07, 0xd0, 0x0f, 0xf2, 0x38, 0x01, 0xaa,
+  0x27, 0xa0, 0x00, 0x43, 0x01, 0x79, 0x43, 0x00, 0x20, 0x1d, 0x04, 0x28,
+  0xff, 0x46, 0xf2, 0xbd, 0xa4, 0x30, 0x89, 0x3e, 0xd7, 0xf3, 0xb3, 0xdd,
+  0x67, 0xc2, 0x03, 0x00, 0xb9, 0x01, 0x00, 0x80, 0xff, 0x39, 0x6a, 0xd5,
+  0x03, 0x3f, 0x2b, 0x94, 0xa9, 0xef, 0x3d, 0xb8, 0x2a, 0x59, 0x17, 0x00,
+  0x00, 0x00, 0x92, 0xff, 0x0a, 0x06, 0x3f, 0xdb, 0x0f, 0xc9, 0x3f, 0x92,
+  0xfb, 0x0a, 0x86, 0x07, 0x04, 0x06, 0x40, 0xdb, 0x0f, 0x49, 0xff, 0x40,
+  0x36, 0x8d, 0x27, 0x40, 0x02, 0x68, 0x02, 0xff, 0xf0, 0x00, 0x43, 0x01,
+  0x21, 0x52, 0x02, 0x52, 0xff, 0x0a, 0x02, 0xd1, 0x06, 0xe0, 0x52, 0x00,
+  0x49, 0x7f, 0x1e, 0x5f, 0xea, 0x02, 0x2c, 0xfa, 0xd5, 0x11, 0x01, 0xdf,
+  0x1a, 0x43, 0x02, 0x60, 0x08, 0x3b, 0x20, 0x02, 0x68, 0xff, 0xc2, 0xf3,
+  0xc7, 0x52, 0xff, 0x2a, 0x05, 0xd1, 0xef, 0x00, 0x68, 0x40, 0x02, 0xe5,
+  0x53, 0x70, 0x47, 0x03, 0xff, 0x68, 0x5b, 0x00, 0x16, 0xd0, 0xc2, 0xf1,
+  0x96, 0xff, 0x02, 0x52, 0x1a, 0x01, 0x2a, 0x11, 0xdb, 0x18, 0x5f, 0x2a,
+  0x04, 0xdb, 0x01, 0x68, 0x95, 0xc0, 0x41, 0x0f, 0xc0, 0xf9, 0xe0, 0x73,
+  0xf0, 0x5d, 0x00, 0x49, 0x1e, 0x11, 0x40, 0x4a, 0xdf, 0x40, 0x02, 0x60,
+  0x11, 0xb1, 0xdd, 0x61, 0x70, 0x47, 0x7e, 0x8a, 0x80, 0x47, 0x01, 0x48,
+  0xf1, 0xf7, 0xb6, 0x37, 0x20, 0xaf, 0x14, 0xbd, 0x00, 0x20, 0xb7, 0xc0,
+  0x4d, 0xb9, 0x61, 0x27, 0xff, 0x68, 0xc7, 0xf3, 0xc7, 0x51, 0xff, 0x29,
+  0x16, 0x77, 0x46, 0x09, 0xd0, 0x2b, 0x03, 0x09, 0xe0, 0x78, 0x69, 0x00,
+  0xd7, 0x00, 0x20, 0x6f, 0x3b, 0x60, 0x03, 0x0b, 0x00, 0x14, 0xbf, 0xdf,
+  0x02, 0x20, 0x01, 0x20, 0xc5, 0x87, 0x02, 0x09, 0xd0, 0xbd, 0x12, 0x23,
+  0x01, 0x31, 0x09, 0xe0, 0x69, 0x23, 0x01, 0x21, 0xe6, 0x23, 0x00, 0x01,
+  0x03, 0x0b, 0x00, 0x23, 0x00, 0x21, 0x01, 0x21, 0xfb, 0x02, 0x00, 0x71,
+  0xf0, 0x29, 0x3e, 0xd4, 0x02, 0x28, 0xff, 0x00, 0xf0, 0xc6, 0x80, 0x02,
+  0x29, 0x08, 0xbf, 0x7f, 0x25, 0x60, 0x18, 0xd0, 0x39, 0xb9, 0x38, 0xc9,
+  0xe0, 0xff, 0xff, 0x41, 0xf7, 0xf7, 0x53, 0xff, 0x0a, 0xd0, 0xff, 0x25,
+  0x60, 0x38, 0xe0, 0x01, 0x29, 0x10, 0xd1, 0x77, 0x38, 0x46, 0x5c, 0x89,
+  0x10, 0x4a, 0xff, 0x18, 0x23, 0x00, 0xdf, 0x40, 0xd1, 0xff, 0xf7, 0xb1,
+  0x03, 0xf6, 0x20, 0x60, 0xfd, 0x02, 0x85, 0x70, 0xf0, 0x8d, 0x70, 0xb9,
+  0x25, 0x60, 0xbb, 0x31, 0x46, 0x6b, 0x71, 0x61, 0xff, 0x04, 0x51, 0x41,
+  0x2c, 0x7f, 0x40, 0xf0, 0x9a, 0x80, 0xff, 0xf7, 0x9c, 0x51, 0xf2, 0xfb,
+  0x94, 0xe0, 0x55, 0x05, 0x28, 0xff, 0x0a, 0xd1, 0x08, 0x7d, 0x46, 0xa3,
+  0x11, 0x43, 0xff, 0x20, 0x60, 0x1a, 0x17, 0x00, 0xfd, 0x46, 0x59, 0x00,
+  0x2b, 0xff, 0x07, 0xd2, 0x00, 0x20, 0xaa, 0x15, 0x01, 0x38, 0x15, 0x00,
+  0x00, 0x51, 0x02, 0x41, 0x11, 0x20, 0x39, 0x57, 0xf8, 0x0c, 0xd8, 0x37,
+  0x00, 0x40, 0x19, 0x01, 0x2b, 0x19, 0x00, 0x57, 0xff, 0xf7, 0x74, 0x4f,
+  0x02, 0x01, 0x21, 0x02, 0x3a, 0xc1, 0xe0, 0xff, 0xf7, 0xf7, 0x1f, 0xff,
+  0x00, 0x21, 0xf7, 0xf7, 0xff, 0x0a, 0xff, 0x34, 0xbf, 0x4f, 0xf0, 0x3f,
+  0x41, 0xf9, 0x4f, 0xaf, 0xf0, 0xff, 0x10, 0xfe, 0xf7, 0xf7, 0x7f, 0xff,
+  0xfd, 0x80, 0x1d, 0x00, 0x68, 0xfd, 0x82, 0x46, 0x31, 0x48, 0x55, 0x51,
+  0x09, 0x00, 0x0b, 0x93, 0x24, 0xf7, 0x81, 0xf0, 0x2d, 0x11, 0x02, 0xfd,
+  0x02, 0x11, 0x04, 0xee, 0xfd, 0x4f, 0xf0, 0x33, 0x41, 0xff, 0xf8, 0xf7,
+  0x02, 0xf8, 0x82, 0x46, 0x03, 0xd8, 0xbd, 0x27, 0x8f, 0x00, 0xe3, 0xfe,
+  0x2d, 0xd3, 0x21, 0x01, 0xf1, 0xbf, 0xfe, 0x83, 0x46, 0x24, 0x48, 0x59,
+  0x09, 0x00, 0xec, 0xda, 0x7f, 0xf0, 0x23, 0x09, 0x02, 0xe7, 0xfe, 0x63,
+  0x03, 0x47, 0xfe, 0x4e, 0x21, 0x01, 0xe0, 0xfe, 0x82, 0x43, 0x00, 0x09,
+  0x01, 0x3f, 0x17, 0x00, 0x92, 0xa1, 0x21, 0x3b, 0x33, 0x00, 0x11, 0x03,
+  0xc2, 0x57, 0x00, 0x11, 0x01, 0x32, 0xea, 0x23, 0xf0, 0x58, 0x0f, 0x00,
+  0x3c, 0x63, 0xf0, 0xf7, 0xf7, 0xc7, 0xbe, 0xb9, 0x20, 0x25, 0x60, 0x06,
+  0xeb, 0x08, 0x97, 0xd0, 0x00, 0x57, 0xf0, 0xca, 0xfe, 0x2d, 0x13, 0x03,
+  0x55, 0x10, 0x06, 0xdb, 0x02, 0xdd, 0x20, 0x2b, 0x80, 0xf0, 0x8d, 0x00,
+  0xa7, 0x21, 0xff, 0x00, 0x7f, 0x00, 0x65, 0xc3, 0x01, 0x00, 0x65, 0x43,
+  0xf3, 0xe1, 0xff, 0x00, 0x60, 0x31, 0x3f, 0xbf, 0xbf, 0x90, 0x39, 0xff,
+  0x01, 0x00, 0x00, 0x33, 0x9e, 0xbf, 0xcc, 0x3d, 0xef, 0x13, 0x54, 0x08,
+  0x3c, 0x29, 0x20, 0x00, 0xd2, 0xb2, 0xff, 0x20, 0x3a, 0x22, 0xbf, 0x41,
+  0xfa, 0x02, 0xf0, 0xff, 0xc9, 0x17, 0x70, 0x47, 0x20, 0x32, 0xd1, 0x41,
+  0x7f, 0xd0, 0x40, 0x48, 0x40, 0x91, 0x40, 0xd1, 0x05, 0x02, 0xf3, 0x11,
+  0x41, 0xd3, 0x40, 0x01, 0x00, 0x00, 0xf0, 0xad, 0xb9, 0xfe, 0x27, 0xf1,
+  0xf5, 0xf7, 0x3c, 0xfa, 0xbd, 0xe8, 0x01, 0xfa, 0x67, 0xa0, 0xa5, 0x0f,
+  0x00, 0x00, 0xf0, 0xa1, 0xb8, 0x00, 0xff, 0xb5, 0x00, 0xbf, 0x13, 0x00,
+  0x96, 0x46, 0x94, 0xff, 0x46, 0x10, 0x39, 0x28, 0xbf, 0xa0, 0xe8, 0x0c,
+  0xff, 0x50, 0xfa, 0xd8, 0x5f, 0xea, 0x41, 0x7c, 0x28, 0xff, 0xbf, 0x0c,
+  0xc0, 0x48, 0xbf, 0x40, 0xf8, 0x04, 0x7b, 0x2b, 0xc9, 0xdb, 0x90, 0x20,
+  0xf8, 0x02, 0x2b, 0x2f, 0x20, 0xef, 0xf8, 0x01, 0x2b, 0x00, 0xb7, 0xf0,
+  0x80, 0xb5, 0x4f, 0xf7, 0xf0, 0x92, 0x41, 0x83, 0x40, 0x60, 0x06, 0x21,
+  0x0f, 0xff, 0x20, 0xf8, 0xf7, 0x18, 0xff, 0xbd, 0xe8, 0x02, 0xff, 0x40,
+  0x02, 0xe0, 0x0c, 0x49, 0x08, 0x60, 0x70, 0xdd, 0x47, 0x11, 0x01, 0xfa,
+  0xbe, 0x1c, 0x23, 0x01, 0x44, 0x08, 0xff, 0x49, 0x20, 0x68, 0x00, 0x90,
+  0x60, 0x68, 0x09, 0x7f, 0x68, 0x01, 0x90, 0x00, 0x98, 0x00, 0xf0, 0x6a,
+  0x30, 0xef, 0x90, 0x68, 0x46, 0x88, 0xe1, 0x20, 0x20, 0x60, 0x13, 0xfe,
+  0x49, 0x00, 0x00, 0x00, 0x5c, 0xf3, 0x00, 0x20, 0x10, 0x7f, 0xb5, 0x93,
+  0x48, 0x93, 0x4c, 0x4f, 0xf4, 0xa0, 0x20, 0xff, 0x62, 0xc2, 0x6a, 0x42,
+  0xf4, 0xf0, 0x02, 0xc2, 0xf7, 0x62, 0x02, 0x6b, 0x07, 0x01, 0x02, 0x63,
+  0x01, 0x60, 0xbd, 0x11, 0x4f, 0x00, 0xe1, 0xfe, 0x06, 0x21, 0x07, 0x01,
+  0xe3, 0xfd, 0xfe, 0x05, 0x01, 0xcb, 0xfe, 0x4f, 0xf4, 0x40, 0x30, 0xff,
+  0xe0, 0x62, 0xa1, 0x6b, 0x41, 0xf4, 0x40, 0x31, 0xf7, 0xa1, 0x63, 0xe1,
+  0x07, 0x02, 0xe1, 0x63, 0x20, 0x60, 0x6d, 0x21, 0x1d, 0x02, 0x06, 0x21,
+  0x07, 0x01, 0xcd, 0xfe, 0x05, 0x01, 0x5b, 0xb5, 0xfe, 0x83, 0x80, 0x60,
+  0x22, 0x09, 0x00, 0xbf, 0x17, 0x00, 0xd6, 0x07, 0x01, 0xc1, 0xfe, 0x05,
+  0x01, 0xa9, 0x17, 0x00, 0xa0, 0x60, 0xa5, 0x23, 0x09, 0x00, 0xb3, 0x17,
+  0x00, 0x07, 0x01, 0xb5, 0xa5, 0x80, 0x10, 0xbd, 0x40, 0x09, 0x01, 0x9b,
+  0xbe, 0x80, 0xb5, 0x67, 0x01, 0xa0, 0xaa, 0x41, 0x02, 0x9d, 0x2f, 0x02,
+  0x9a, 0x1d, 0x00, 0x02, 0x1d, 0x02, 0x95, 0x37, 0xbe, 0x69, 0x49, 0x69,
+  0x41, 0x00, 0xb1, 0x37, 0x71, 0x55, 0x11, 0xfa, 0x1f, 0x01, 0x90, 0x1f,
+  0x06, 0x8b, 0xbe, 0xf8, 0xb5, 0x00, 0xff, 0x24, 0x0f, 0xf2, 0x88, 0x15,
+  0x5d, 0x4e, 0x5f, 0xff, 0x4f, 0x57, 0xf8, 0x24, 0x00, 0x38, 0xb1, 0x30,
+  0xff, 0x68, 0x55, 0xf8, 0x24, 0x10, 0x08, 0x43, 0x30, 0xfe, 0xcd, 0x02,
+  0x7a, 0xfe, 0x07, 0xeb, 0x84, 0x01, 0x64, 0xfd, 0x1c, 0xf9, 0x50, 0x2c,
+  0xc8, 0x60, 0xed, 0xd3, 0xf1, 0xfe, 0x97, 0xc0, 0x54, 0x4c, 0xa0, 0x68,
+  0x30, 0xb1, 0x52, 0x15, 0x49, 0xd9, 0x01, 0x08, 0xc7, 0x02, 0x67, 0xb9,
+  0x01, 0x01, 0xc0, 0x7f, 0xa0, 0xef, 0x4f, 0x01, 0x21, 0x36, 0x11, 0x00,
+  0xd8, 0xfe, 0x00, 0xf7, 0x24, 0x48, 0x4d, 0x5d, 0xe0, 0x81, 0x0f, 0xf2,
+  0x44, 0xff, 0x1b, 0x48, 0x4e, 0x0f, 0xf2, 0x24, 0x19, 0x0f, 0xef, 0xf2,
+  0x2c, 0x1a, 0x5a, 0x63, 0x00, 0x59, 0xf8, 0x24, 0xff, 0x70, 0x01, 0x68,
+  0x39, 0x40, 0x29, 0xd0, 0x01, 0xff, 0x60, 0xf0, 0x69, 0xa0, 0x42, 0x05,
+  0xd1, 0x01, 0xbf, 0x20, 0xb0, 0x61, 0x01, 0x21, 0x3b, 0x37, 0x00, 0xbc,
+  0xbb, 0xfe, 0x5b, 0x21, 0x00, 0x00, 0x68, 0x06, 0x75, 0x00, 0x38, 0xef,
+  0x40, 0xca, 0x68, 0x46, 0x0d, 0x00, 0x52, 0x1c, 0xca, 0xff, 0x60, 0x30,
+  0xb1, 0xb8, 0xf8, 0x56, 0x00, 0x90, 0xff, 0x42, 0x02, 0xd2, 0x28, 0x68,
+  0xb8, 0x43, 0x28, 0xbe, 0x7b, 0x20, 0xff, 0xf7, 0xbf, 0xfa, 0x56, 0xa9,
+  0x00, 0x01, 0xff, 0xb1, 0x01, 0x21, 0x04, 0xf1, 0x38, 0x00, 0xc9, 0xff,
+  0xb2, 0xc0, 0xb2, 0xf8, 0xf7, 0x9c, 0xfe, 0x64, 0xef, 0x1c, 0x02, 0x2c,
+  0xcb, 0xd9, 0x60, 0xf4, 0x4f, 0x00, 0xfe, 0x89, 0x02, 0x93, 0xbe, 0x38,
+  0xb5, 0x01, 0x21, 0x37, 0xfe, 0x09, 0x00, 0x8e, 0xfe, 0x25, 0x4c, 0x25,
+  0x4d, 0xe0, 0xfb, 0x6a, 0x00, 0x91, 0x12, 0xe9, 0x69, 0x02, 0x29, 0x06,
+  0xeb, 0xd1, 0x28, 0x19, 0x10, 0xa8, 0x7b, 0x04, 0x7e, 0xfe, 0x20, 0xf7,
+  0x6b, 0x69, 0x69, 0x1d, 0x01, 0x49, 0x1c, 0xa8, 0x60, 0x7f, 0x69, 0x61,
+  0x50, 0xb1, 0x1b, 0x48, 0xb0, 0x75, 0x00, 0xf7, 0x88, 0x42, 0x3c, 0xb7,
+  0x40, 0x20, 0x60, 0xa9, 0x68, 0xfd, 0x11, 0x6b, 0x00, 0x00, 0xe0, 0x00,
+  0x21, 0xc9, 0xb2, 0x95, 0x3a, 0x2f, 0x00, 0x66, 0x47, 0x10, 0x34, 0x61,
+  0xe0, 0x5b, 0x01, 0x60, 0xff, 0xbe, 0x0f, 0x49, 0x0f, 0xf2, 0x58, 0x02,
+  0x0f, 0xdf, 0xf2, 0x3c, 0x03, 0xc8, 0x61, 0xf3, 0xf1, 0x12, 0x68, 0x7d,
+  0x53, 0x79, 0x10, 0x10, 0x40, 0x88, 0x61, 0x01, 0x37, 0x31, 0xfc, 0x33,
+  0x00, 0x63, 0x01, 0x4c, 0xbe, 0x05, 0x49, 0x89, 0x69, 0xd3, 0x00, 0x20,
+  0xb5, 0x00, 0x39, 0x50, 0x00, 0xc8, 0x61, 0x50, 0x14, 0x0f, 0x00, 0x00,
+  0x58, 0xa4, 0x2b, 0x70, 0x67, 0x71, 0x0e, 0x00, 0x69, 0x20, 0xad, 0x28,
+  0x03, 0x00, 0x03, 0x00, 0x59, 0xb0, 0x50, 0x03, 0x04, 0x58, 0xd9, 0x44,
+  0x07, 0x00, 0x03, 0x04, 0x58, 0x80, 0xe3, 0x60, 0x13, 0xf8, 0xf5, 0x19,
+  0x4d, 0x00, 0x96, 0xb7, 0x30, 0xa4, 0x41, 0x15, 0x48, 0x6f, 0x08, 0x60,
+  0x00, 0x21, 0x0f, 0x01, 0xa9, 0xfd, 0x31, 0x31, 0xe7, 0x12, 0x49, 0x01,
+  0xef, 0x20, 0x0f, 0x01, 0x8c, 0xbd, 0x80, 0xbd, 0xb5, 0x07, 0x01, 0x91,
+  0xfd, 0x0d, 0x49, 0x03, 0x31, 0x01, 0xff, 0xbd, 0xef, 0xf3, 0x11, 0x80,
+  0x60, 0x21, 0x81, 0xfe, 0x2d, 0xc0, 0x09, 0x49, 0x0a, 0x68, 0x42, 0xf0,
+  0x02, 0xef, 0x03, 0x0b, 0x60, 0x22, 0xbc, 0x20, 0x0a, 0x60, 0x80, 0x9c,
+  0x13, 0x00, 0x03, 0x60, 0x48, 0x00, 0x68, 0xdd, 0xb3, 0x82, 0x00, 0x70,
+  0x7f, 0x17, 0x00, 0x04, 0x00, 0x00, 0x52, 0x00, 0x41, 0x00, 0xfd, 0x1c,
+  0x01, 0x30, 0x09, 0x42, 0x40, 0xf1, 0x0d, 0x80, 0xff, 0xf4, 0x46, 0x49,
+  0x42, 0x40, 0x42, 0x71, 0xf1, 0x5e, 0x6e, 0x70, 0xf0, 0x06, 0xf8, 0x51,
+  0x1d, 0x60, 0x60, 0x2b, 0x00, 0xff, 0x09, 0x42, 0x00, 0xbf, 0x08, 0xbf,
+  0x00, 0xf0, 0xff, 0x15, 0xbd, 0x02, 0x46, 0x08, 0x46, 0xb0, 0xfa, 0xff,
+  0x80, 0xf1, 0x50, 0x40, 0x8a, 0x40, 0xc1, 0xf1, 0xff, 0x20, 0x01, 0xc8,
+  0x41, 0x50, 0x40, 0xc9, 0x1e, 0xff, 0x01, 0xf5, 0x84, 0x61, 0x09, 0x05,
+  0x01, 0xeb, 0xff, 0xd0, 0x21, 0x40, 0x05, 0x40, 0xea, 0xd2, 0x20, 0xff,
+  0x52, 0x05, 0x72, 0xf1, 0x00, 0x42, 0x50, 0xf1, 0xf7, 0x00, 0x00, 0x41,
+  0x49, 0x00, 0x70, 0x47, 0xf0, 0xb4, 0xfd, 0x4f, 0x01, 0x70, 0x91, 0xea,
+  0x03, 0x0c, 0x44, 0xbf, 0xfd, 0x6b, 0xf3, 0x30, 0xbf, 0xb9, 0x00, 0xbf,
+  0x84, 0x1a, 0xff, 0x71, 0xeb, 0x03, 0x06, 0x03, 0xd2, 0x00, 0x1b, 0xff,
+  0xb1, 0x41, 0x12, 0x19, 0x73, 0x41, 0x4f, 0xf4, 0xff, 0x00, 0x1c, 0x1c,
+  0xeb, 0x41, 0x0f, 0x34, 0xbf, 0xff, 0x7c, 0xeb, 0x43, 0x04, 0x43, 0xe0,
+  0x0c, 0x0d, 0xff, 0xa4, 0xeb, 0x13, 0x56, 0x35, 0x2e, 0x50, 0xdc, 0xff,
+  0x45, 0xea, 0xc3, 0x23, 0xdb, 0x0a, 0x45, 0xea, 0xff, 0xc1, 0x21, 0xc9,
+  0x12, 0xb6, 0xf1, 0x20, 0x05, 0xff, 0x0d, 0xdd, 0x63, 0xfa, 0x05, 0xf6,
+  0xeb, 0x40, 0xff, 0x86, 0xea, 0x03, 0x05, 0x12, 0x42, 0x18, 0xbf, 0x7f,
+  0x45, 0xf0, 0x01, 0x05, 0xc0, 0x18, 0x51, 0x69, 0x00, 0xff, 0x0c, 0xd2,
+  0x13, 0xe0, 0x62, 0xfa, 0x06, 0xf5, 0xff, 0xf2, 0x40, 0x55, 0x40, 0xf3,
+  0x41, 0x5a, 0x40, 0xff, 0xb3, 0x40, 0xf3, 0x40, 0x5a, 0x40, 0x80, 0x18,
+  0xff, 0x59, 0x41, 0x07, 0xd3, 0x49, 0x08, 0x5f, 0xea, 0x7f, 0x30, 0x00,
+  0x5f, 0xea, 0x35, 0x05, 0x28, 0x31, 0x02, 0x7f, 0x01, 0xf5, 0x80, 0x11,
+  0x42, 0x08, 0x75, 0xa7, 0x05, 0xdf, 0xeb, 0x04, 0x51, 0xf0, 0xbc, 0x83,
+  0x05, 0x38, 0xbf, 0x7e, 0xfb, 0x61, 0x09, 0x0d, 0x09, 0x05, 0x70, 0x47,
+  0x0f, 0x01, 0xff, 0x10, 0xd2, 0x52, 0xea, 0x43, 0x06, 0x0b, 0xd0, 0xfd,
+  0xbc, 0x0b, 0x00, 0x05, 0xd8, 0x0c, 0x0d, 0xab, 0x43, 0xff, 0x66, 0x1e,
+  0x34, 0x2e, 0xb5, 0xdd, 0x02, 0xe0, 0x9b, 0xab, 0x43, 0x5d, 0x01, 0xf0,
+  0xbc, 0xe3, 0x00, 0x03, 0x00, 0xb0, 0xfb, 0xb5, 0x81, 0xe3, 0x00, 0x0c,
+  0xf0, 0x00, 0x4c, 0x40, 0xff, 0xf2, 0xff, 0x75, 0x15, 0xea, 0x11, 0x54,
+  0x1d, 0xff, 0xbf, 0x15, 0xea, 0x13, 0x57, 0xac, 0x42, 0xaf, 0xff, 0x42,
+  0x39, 0xe0, 0xe4, 0x19, 0x23, 0xea, 0x45, 0xff, 0x53, 0x43, 0xf4, 0x80,
+  0x13, 0xc9, 0x02, 0x41, 0xfe, 0x59, 0x10, 0x41, 0xea, 0x50, 0x5e, 0xc7,
+  0x02, 0x11, 0x7f, 0x00, 0xa7, 0xfb, 0x02, 0x02, 0x00, 0x28, 0x21, 0x10,
+  0xdf, 0x00, 0xee, 0xfb, 0x01, 0x20, 0x07, 0x00, 0x01, 0xe3, 0xff, 0xfb,
+  0x07, 0x21, 0x18, 0xbf, 0x42, 0xf0, 0x01, 0xff, 0x02, 0x40, 0x18, 0x00,
+  0x21, 0x49, 0x41, 0xe3, 0xff, 0xfb, 0x0e, 0x01, 0xa4, 0xf5, 0x80, 0x64,
+  0x0f, 0xff, 0x03, 0x02, 0xd2, 0x52, 0x00, 0x40, 0x41, 0x49, 0xff, 0x41,
+  0x54, 0xf1, 0x01, 0x04, 0x6c, 0xdd, 0x47, 0xd5, 0x08, 0x67, 0x15, 0x51,
+  0xbf, 0x00, 0xa1, 0xd1, 0x00, 0x5c, 0xbf, 0xff, 0x41, 0xea, 0x0c, 0x01,
+  0xb0, 0xbd, 0x4c, 0xea, 0x7f, 0x05, 0x51, 0x00, 0x20, 0xb0, 0xbd, 0x05,
+  0x7d, 0x02, 0xff, 0x14, 0xbf, 0xaf, 0x42, 0x41, 0xe0, 0x50, 0xea, 0xef,
+  0x41, 0x0e, 0x1c, 0xbf, 0xc9, 0x00, 0x0e, 0x02, 0xe0, 0xfb, 0x61, 0x46,
+  0x1d, 0x01, 0x24, 0x42, 0x3c, 0x44, 0x1b, 0xff, 0xd1, 0x5f, 0xea, 0x07,
+  0x0e, 0xf6, 0xd0, 0x09, 0xef, 0x03, 0x02, 0xbf, 0x01, 0x15, 0x00, 0xae,
+  0xf1, 0x14, 0xff, 0x0e, 0xb1, 0xfa, 0x81, 0xf7, 0xae, 0xeb, 0x07, 0xff,
+  0x04, 0x01, 0xfa, 0x07, 0xfe, 0x0c, 0x37, 0xc7, 0xfe, 0xe7, 0x10, 0x00,
+  0xfa, 0x07, 0xf7, 0xc8, 0x40, 0x4e, 0x77, 0xea, 0x00, 0x0e, 0xc3, 0x05,
+  0xa2, 0xe7, 0x33, 0x8b, 0x80, 0xff, 0xb3, 0xfa, 0x83, 0xf7, 0x04, 0xbf,
+  0xb2, 0xfa, 0xff, 0x82, 0xfe, 0x77, 0x44, 0x0b, 0x3f, 0xe4, 0x1b, 0xff,
+  0xb7, 0xf1, 0x20, 0x0e, 0x2f, 0xbf, 0x02, 0xfa, 0xef, 0x0e, 0xf3, 0xbb,
+  0x40, 0x37, 0x00, 0x0e, 0x22, 0xfa, 0xff, 0x0e, 0xfe, 0x38, 0xbf, 0x43,
+  0xea, 0x0e, 0x03, 0xbf, 0xba, 0x40, 0x64, 0x1c, 0x82, 0xe7, 0x83, 0x01,
+  0x14, 0xf4, 0x83, 0x02, 0xb5, 0x70, 0x01, 0x6f, 0x10, 0x17, 0x17, 0xeb,
+  0x43, 0xbf, 0x0f, 0x8a, 0xbf, 0x19, 0x46, 0x17, 0x5b, 0x10, 0xb5, 0xf5,
+  0xe7, 0xb7, 0x05, 0xd4, 0xdf, 0x00, 0xb4, 0xf1, 0x20, 0x07, 0x77, 0x0f,
+  0xda, 0xc4, 0x05, 0x00, 0x52, 0x08, 0x28, 0x0d, 0x12, 0xef, 0x10, 0xfa,
+  0x07, 0xf5, 0x93, 0x00, 0xf7, 0xe1, 0xbf, 0xf7, 0x2a, 0x43, 0xe0, 0x89,
+  0xf0, 0xe1, 0x40, 0x0f, 0xe0, 0xef, 0x35, 0x2c, 0x98, 0xdc, 0x69, 0x00,
+  0x04, 0x52, 0xea, 0xbf, 0x40, 0x02, 0x20, 0xfa, 0x07, 0xf2, 0x37, 0x13,
+  0x31, 0x6f, 0xfa, 0x07, 0xf0, 0xa1, 0x15, 0xc0, 0x00, 0x21, 0x21, 0x17,
+  0xf6, 0x17, 0x11, 0x00, 0x00, 0x99, 0x10, 0x7c, 0x0b, 0x0d, 0x4d, 0xff,
+  0xd0, 0x63, 0x45, 0x66, 0xd2, 0x30, 0xb4, 0x21, 0xff, 0xea, 0x03, 0x51,
+  0x41, 0xf4, 0x80, 0x11, 0x03, 0xff, 0xf2, 0xfd, 0x3c, 0x5f, 0xea, 0x5c,
+  0x0c, 0x01, 0xff, 0xd3, 0x00, 0x18, 0x49, 0x41, 0x89, 0x00, 0x41, 0xdf,
+  0xea, 0x90, 0x71, 0x80, 0x00, 0x03, 0x50, 0x14, 0x00, 0xff, 0x23, 0xe2,
+  0x02, 0xd5, 0x0a, 0xb1, 0xf5, 0x10, 0xff, 0x01, 0x07, 0xd4, 0x6d, 0x08,
+  0x1d, 0xd2, 0x09, 0xf7, 0x1b, 0x64, 0x19, 0x23, 0x01, 0x49, 0x1b, 0xf7,
+  0xd5, 0xff, 0x6d, 0x08, 0x0a, 0xd2, 0x09, 0x19, 0x64, 0x1b, 0xfa, 0x0f,
+  0x03, 0xef, 0x0f, 0x00, 0xf7, 0xd3, 0x01, 0xe0, 0x52, 0xff, 0x08, 0x17,
+  0xd0, 0xc0, 0x18, 0x61, 0x41, 0x9b, 0xf7, 0x1a, 0xac, 0x41, 0x19, 0x01,
+  0x80, 0x1a, 0xa9, 0x41, 0xff, 0xf4, 0xd4, 0x52, 0x08, 0x0a, 0xd0, 0xc0,
+  0x1a, 0x5f, 0xa1, 0x41, 0x9b, 0x18, 0x6c, 0x15, 0x06, 0xe9, 0x15, 0x00,
+  0xff, 0xf4, 0xd1, 0x5b, 0x1c, 0x6c, 0x41, 0x61, 0x08, 0xff, 0x4f, 0xea,
+  0x33, 0x00, 0x01, 0xeb, 0x0c, 0x51, 0xfd, 0x30, 0x47, 0x20, 0x50, 0xea,
+  0x01, 0x03, 0xfb, 0xd0, 0xbb, 0x30, 0xb4, 0x87, 0x10, 0xf3, 0x11, 0xb9,
+  0x6f, 0x30, 0xf4, 0xdf, 0x1b, 0x19, 0x0b, 0x3b, 0xb3, 0xe5, 0x00, 0x2f,
+  0xbf, 0x7f, 0x00, 0xfa, 0x04, 0xf1, 0x99, 0x40, 0xc3, 0x0b, 0x00, 0xff,
+  0x20, 0xfa, 0x04, 0xf4, 0x38, 0xbf, 0x21, 0x43, 0xff, 0x98, 0x40, 0xd3,
+  0xf1, 0x01, 0x03, 0x9d, 0xe7, 0xff, 0x63, 0x45, 0xe1, 0xd0, 0x11, 0xf5,
+  0x80, 0x1f, 0xfb, 0xde, 0xd8, 0x65, 0x10, 0x01, 0xdb, 0xd0, 0xd9, 0x43,
+  0xaf, 0xff, 0xf7, 0x66, 0xba, 0x7b, 0x36, 0x0f, 0x7b, 0x31, 0xff, 0xf7,
+  0xf7, 0x43, 0xbe, 0x7b, 0x35, 0x04, 0xd2, 0x6e, 0x40, 0xf6, 0x7d, 0x3f,
+  0x03, 0x06, 0x84, 0x7d, 0x34, 0x36, 0x2e, 0x7d, 0xdc, 0xf7, 0x01, 0x2e,
+  0x43, 0x81, 0x32, 0x43, 0xea, 0x52, 0x53, 0xff, 0x12, 0xbf, 0xd2, 0x02,
+  0x92, 0x02, 0x5b, 0x08, 0xf3, 0x24, 0x05, 0x8d, 0x31, 0xbf, 0x20, 0x51,
+  0xd2, 0xeb, 0xc0, 0x7f, 0x20, 0x99, 0x41, 0x25, 0xd4, 0x07, 0xd1, 0xa5,
+  0x00, 0x7f, 0xf6, 0x10, 0xfa, 0x06, 0xf1, 0x64, 0xd0, 0x4d, 0x50, 0xf7,
+  0x36, 0x08, 0xe0, 0xbb, 0x00, 0xf6, 0xb1, 0x40, 0xc6, 0xf9, 0xf1, 0x7c,
+  0xa0, 0x0d, 0xd0, 0x11, 0x43, 0xb0, 0x40, 0x4f, 0xff, 0xea, 0xf4, 0x74,
+  0xb4, 0xeb, 0x46, 0x54, 0x34, 0xff, 0xf0, 0x01, 0x06, 0x4f, 0xea, 0x74,
+  0x04, 0x0a, 0xff, 0xd8, 0xd6, 0xf5, 0x00, 0x16, 0x76, 0x0d, 0x04, 0xff,
+  0xf0, 0x00, 0x44, 0xf0, 0x40, 0x61, 0xfa, 0x06, 0xef, 0xf2, 0x50, 0x40,
+  0xf1, 0x2d, 0x80, 0xc0, 0x0a, 0x40, 0xef, 0xea, 0x41, 0x50, 0x21, 0x21,
+  0x30, 0x28, 0xbf, 0x5f, 0xf7, 0xea, 0x50, 0x05, 0xbd, 0x11, 0x44, 0xeb,
+  0xd1, 0x21, 0xeb, 0x37, 0xe0, 0x09, 0x48, 0x0a, 0x09, 0x41, 0x0e, 0xdd,
+  0x42, 0xff, 0xea, 0x02, 0x42, 0x12, 0x0c, 0xc5, 0xf1, 0x20, 0xef, 0x06,
+  0x03, 0xfa, 0x06, 0x13, 0x40, 0x42, 0xea, 0x06, 0xbf, 0x05, 0x6d, 0x42,
+  0x98, 0x41, 0x61, 0x0d, 0x40, 0x0d, 0xfe, 0x0b, 0x46, 0x63, 0xfa, 0x06,
+  0xfc, 0x82, 0xea, 0x0c, 0xfd, 0x02, 0x0d, 0x41, 0x6d, 0x42, 0x90, 0x41,
+  0x61, 0xeb, 0xff, 0x03, 0x01, 0x11, 0xf4, 0x80, 0x1f, 0x05, 0xd1, 0x7f,
+  0x64, 0x1e, 0x62, 0x05, 0x02, 0xd0, 0x6d, 0x53, 0x32, 0x95, 0x21, 0x07,
+  0x20, 0x43, 0x11, 0x41, 0x43, 0x11, 0x47, 0xff, 0x33, 0x15, 0xf3, 0xd2,
+  0x23, 0xeb, 0x20, 0x03, 0x43, 0x4f, 0xea, 0x4c, 0x0c, 0xf2, 0x07, 0x41,
+  0x04, 0x07, 0x40, 0x05, 0x41, 0xb7, 0xdd, 0xeb, 0xe7, 0xaf, 0x80, 0x1a,
+  0x99, 0x41, 0x73, 0x10, 0x06, 0x23, 0x50, 0x21, 0x5f, 0xe4, 0xe7, 0x08,
+  0xbf, 0x1c, 0xd3, 0x20, 0x28, 0x2d, 0xf0, 0xff, 0x00, 0x01, 0xdd, 0xe7,
+  0x4f, 0xea, 0xf1, 0x7c, 0xff, 0xbc, 0xf1, 0xe0, 0x4c, 0x2c, 0xbf, 0xbc,
+  0xf5, 0xdf, 0x00, 0x1f, 0x11, 0xe0, 0x5f, 0x3f, 0x00, 0x34, 0xbf, 0xdf,
+  0xbc, 0xf1, 0x7f, 0x5f, 0x2e, 0x0b, 0x00, 0x9c, 0x0c, 0xff, 0x4f, 0xea,
+  0x0c, 0x1c, 0x4f, 0xea, 0x3c, 0x0c, 0xfb, 0xc1, 0x00, 0x75, 0x50, 0x41,
+  0x4c, 0xeb, 0x50, 0x70, 0xf3, 0x70, 0x47, 0x1f, 0x40, 0x5b, 0x10, 0xc0,
+  0x02, 0x18, 0xbf, 0xf9, 0x41, 0x8a, 0x80, 0x2b, 0x41, 0x4f, 0xea, 0x6c,
+  0x50, 0xc0, 0xff, 0xf1, 0x09, 0x00, 0x21, 0x28, 0x10, 0xd2, 0x40, 0xff,
+  0xea, 0xcc, 0x7c, 0xcc, 0xf1, 0x20, 0x0c, 0x11, 0x7f, 0xfa, 0x0c, 0xf0,
+  0x70, 0xf1, 0x00, 0x40, 0x0b, 0x01, 0xd9, 0x21, 0x0b, 0x00, 0x77, 0x42,
+  0xeb, 0x0c, 0xdd, 0x50, 0x4f, 0xea, 0xdd, 0xcc, 0x45, 0x00, 0x49, 0x00,
+  0x11, 0x71, 0x00, 0x04, 0xd8, 0x5e, 0x0d, 0x00, 0x10, 0xff, 0x30, 0xc0,
+  0xcb, 0x40, 0xc8, 0x99, 0x90, 0xe2, 0xc3, 0xb0, 0x41, 0x9d, 0x41, 0xa9,
+  0x45, 0xa5, 0x4b, 0xe9, 0xe0, 0xbc, 0xff, 0x41, 0xc1, 0xf3, 0x13, 0x01,
+  0xc3, 0xf3, 0x13, 0xf9, 0x03, 0xd5, 0x01, 0xe9, 0x31, 0x04, 0xd2, 0x64,
+  0x1e, 0x40, 0xf1, 0x00, 0xb1, 0x20, 0xe9, 0x40, 0x99, 0x03, 0xb1, 0xfb,
+  0xf3, 0xf6, 0xff, 0x03, 0xfb, 0x16, 0x11, 0xa2, 0xfb, 0x06, 0x75, 0xfd,
+  0xd7, 0x01, 0x20, 0xa9, 0x41, 0x02, 0xd2, 0x76, 0x1e, 0x5e, 0x1f, 0x0a,
+  0xfe, 0x03, 0xfb, 0x1e, 0x1f, 0x00, 0x0e, 0x1f, 0x04, 0xbf, 0x03, 0xd2,
+  0xae, 0xf1, 0x01, 0x0e, 0x21, 0x01, 0x89, 0xfe, 0x21, 0x00, 0x90, 0x51,
+  0x76, 0x05, 0x46, 0xea, 0x8e, 0xf5, 0x2e, 0x47, 0x0b, 0x80, 0x47, 0x0e,
+  0x4e, 0xea, 0x06, 0x0e, 0xde, 0x6b, 0x0f, 0x11, 0xf7, 0x03, 0xfb, 0x17,
+  0x1f, 0x00, 0x07, 0x35, 0xbd, 0xd3, 0x1f, 0x02, 0x67, 0xf1, 0x00, 0x07,
+  0x67, 0xc0, 0x42, 0xff, 0x47, 0xf0, 0x01, 0x07, 0x66, 0xf3, 0xd5, 0x27,
+  0x7f, 0x4f, 0xea, 0x1e, 0x31, 0xb8, 0x08, 0x14, 0x3f, 0x50, 0xef, 0x14,
+  0xdd, 0xbd, 0x07, 0xf1, 0x52, 0xeb, 0x0e, 0x50, 0xf0, 0x31, 0x51, 0x2d,
+  0x31, 0x31, 0x53, 0xeb, 0xa0, 0x81, 0x4c, 0xf0, 0x7f, 0xcf, 0x61, 0x41,
+  0xf0, 0xe0, 0x4f, 0xa0, 0x0d, 0x01, 0xbd, 0x07, 0x3f, 0x6d, 0x08, 0x40,
+  0xea, 0x0e, 0x50, 0x1d, 0x41, 0x8d, 0x44, 0xfb, 0x06, 0x0a, 0x8d, 0x41,
+  0x06, 0x02, 0x00, 0xe0, 0x40, 0xff, 0x01, 0xfa, 0x06, 0xf3, 0xe1, 0x40,
+  0x18, 0x43, 0xff, 0xb2, 0x40, 0x15, 0x43, 0x0e, 0xe0, 0x34, 0x2c, 0xfb,
+  0x14, 0xdc, 0xe9, 0x20, 0x04, 0x45, 0xea, 0x40, 0x05, 0xf7, 0x6d, 0x08,
+  0x20, 0xc9, 0x20, 0x15, 0x43, 0x21, 0xfa, 0x85, 0x06, 0x81, 0x40, 0x0d,
+  0x81, 0x40, 0x63, 0x65, 0x81, 0x41, 0x59, 0x01, 0x00, 0xfb, 0x20, 0x5f,
+  0x71, 0x04, 0xcf, 0xb9, 0x92, 0x18, 0x5b, 0x7d, 0x41, 0x43, 0x56, 0xf6,
+  0xbf, 0x19, 0x0b, 0x3f, 0x41, 0x50, 0xb5, 0x06, 0x41, 0x51, 0x06, 0x41,
+  0x53, 0x06, 0x22, 0xd7, 0x20, 0x38, 0xff, 0xbf, 0x33, 0x43, 0xba, 0x40,
+  0x1c, 0xb1, 0xe4, 0xff, 0x19, 0x64, 0x1e, 0x2f, 0xe7, 0x7f, 0x42, 0x31,
+  0xdc, 0x11, 0x20, 0x5f, 0x30, 0xf4, 0x04, 0xbf, 0x75, 0x31, 0xa4, 0x19,
+  0xf3, 0x0b, 0x3c, 0x9d, 0x01, 0x1b, 0x41, 0x06, 0xf1, 0xa1, 0x40, 0xf8,
+  0xa3, 0x01, 0x83, 0x00, 0x35, 0x00, 0x31, 0x43, 0xa0, 0x40, 0x3c, 0x7f,
+  0x1b, 0x16, 0xe7, 0xac, 0x42, 0x1a, 0xbf, 0x09, 0x61, 0xd7, 0xaf, 0x42,
+  0x14, 0x05, 0x61, 0x06, 0x05, 0x62, 0x06, 0xbf, 0x7e, 0x8d, 0x51, 0x07,
+  0x30, 0x46, 0x61, 0x46, 0x1c, 0x03, 0x10, 0xf3, 0x05, 0x51, 0x91, 0x01,
+  0x17, 0x00, 0x0c, 0x08, 0xbf, 0xc1, 0xd9, 0x43, 0xa7, 0x03, 0x15, 0x40,
+  0x16, 0x16, 0xeb, 0x20, 0x98, 0xbf, 0x75, 0x16, 0xd1, 0x20, 0x08, 0x05,
+  0x00, 0x41, 0x0f, 0x24, 0x1d, 0x00, 0x7b, 0x05, 0xe0, 0x0f, 0x01, 0x0c,
+  0xbf, 0x61, 0x46, 0xaf, 0x51, 0xee, 0x2b, 0x02, 0x00, 0x41, 0x00, 0x1b,
+  0x50, 0x0e, 0x7f, 0x39, 0xff, 0x1a, 0xd4, 0x20, 0x29, 0x08, 0xda, 0xc1,
+  0xf1, 0xe7, 0x1f, 0x0c, 0x01, 0xe5, 0x62, 0x99, 0x21, 0x00, 0x21, 0x70,
+  0x7f, 0x47, 0xd1, 0xf1, 0x3f, 0x0c, 0x08, 0xd4, 0x13, 0x03, 0xf9, 0x61,
+  0x13, 0x00, 0x17, 0x00, 0xf1, 0x48, 0x40, 0x70, 0x47, 0xa0, 0x25, 0x30,
+  0x6c, 0x80, 0x6f, 0x71, 0x25, 0x01, 0xd3, 0xb1, 0x01, 0x91, 0x80, 0xd3,
+  0xf5, 0xf8, 0x05, 0x01, 0xd0, 0x6d, 0xf0, 0xa0, 0x40, 0x03, 0x21, 0xff,
+  0x01, 0x64, 0x01, 0x60, 0x09, 0x20, 0x06, 0x21, 0x5f, 0xf8, 0xf7, 0x27,
+  0xf9, 0x09, 0x17, 0x00, 0x1e, 0x05, 0x02, 0xef, 0x0c, 0xf9, 0x4f, 0xf0,
+  0x55, 0x40, 0xf0, 0x00, 0x71, 0xba, 0x1f, 0x01, 0x1c, 0x1f, 0x02, 0x17,
+  0xf9, 0x1c, 0x19, 0x00, 0x0e, 0xe7, 0xf9, 0xff, 0xe7, 0x05, 0xb1, 0x0b,
+  0x01, 0xf9, 0xb8, 0x05, 0x7f, 0x28, 0xba, 0xbf, 0x27, 0x49, 0x40, 0x5c,
+  0xcd, 0xe1, 0x7f, 0x38, 0xb5, 0x25, 0x49, 0x24, 0x4d, 0x03, 0x2d, 0x90,
+  0xff, 0x00, 0x20, 0xf3, 0xf7, 0x0f, 0xfa, 0x29, 0x78, 0x7f, 0x04, 0x46,
+  0x8c, 0x42, 0x0a, 0xd0, 0x22, 0xf9, 0x60, 0xef, 0xfe, 0xf7, 0x8c, 0xfd,
+  0x85, 0x00, 0xf0, 0x77, 0xf9, 0x7d, 0x18, 0x37, 0x00, 0x56, 0xf9, 0x2c,
+  0x70, 0x01, 0x23, 0x00, 0xd7, 0xfd, 0xf9, 0x69, 0x23, 0x06, 0x01, 0x23,
+  0x00, 0x7a, 0xfd, 0xed, 0x01, 0x23, 0x00, 0x65, 0xf9, 0x79, 0x91, 0x44,
+  0xf9, 0x6c, 0xff, 0x70, 0x31, 0xbd, 0xf8, 0xb5, 0x11, 0x49, 0x0f, 0xf5,
+  0x4d, 0x09, 0xb0, 0x06, 0x8b, 0x00, 0x70, 0x08, 0x60, 0x02, 0xf7, 0x24,
+  0x36, 0xf8, 0xf5, 0x90, 0xf1, 0x8c, 0x40, 0x07, 0xef, 0x78, 0x61, 0x5d,
+  0x8f, 0x39, 0x00, 0x3a, 0x46, 0xe0, 0xff, 0xb2, 0xfe, 0xf7, 0xc3, 0xfd,
+  0xe0, 0xb2, 0x00, 0xef, 0xf0, 0x48, 0xf9, 0x1a, 0x39, 0x00, 0x27, 0xf9,
+  0x67, 0xbf, 0x55, 0x64, 0x1c, 0x05, 0x2c, 0xe9, 0x73, 0xb0, 0x00, 0xf3,
+  0x00, 0x48, 0x7b, 0xc0, 0x0b, 0xa5, 0xb0, 0x04, 0xb3, 0x04, 0xdf, 0x5b,
+  0x04, 0x5c, 0x04, 0x5d, 0x9c, 0x90, 0x38, 0xb5, 0xf6, 0x6d, 0xf1, 0x20,
+  0x68, 0x17, 0x00, 0x0e, 0xff, 0x28, 0x04, 0xfd, 0xd1, 0x09, 0x00, 0x02,
+  0x14, 0xd0, 0x02, 0x20, 0x32, 0xdf, 0xbd, 0x20, 0xb9, 0x20, 0x46, 0x5c,
+  0xe0, 0xff, 0x01, 0xff, 0x28, 0x46, 0xda, 0x01, 0x2d, 0x0c, 0xdb, 0xc0,
+  0x7f, 0xf1, 0xff, 0x01, 0x8d, 0x42, 0x08, 0xd3, 0xe5, 0xc0, 0x5f, 0x28,
+  0x4c, 0xbf, 0x1f, 0x48, 0xad, 0xe1, 0x20, 0x9f, 0xe0, 0xff, 0x32, 0xbd,
+  0x41, 0x42, 0xa9, 0x42, 0x21, 0x68, 0xf7, 0x06, 0xda, 0x21, 0xf7, 0xe0,
+  0x40, 0x19, 0x41, 0xea, 0xff, 0xc0, 0x50, 0x20, 0x60, 0x26, 0xe0, 0x22,
+  0x68, 0xff, 0x52, 0x02, 0x40, 0x1e, 0x52, 0x0a, 0x45, 0x19, 0xff, 0x42,
+  0xf4, 0x00, 0x02, 0x05, 0xf1, 0x18, 0x00, 0xfd, 0x01, 0x97, 0x10, 0x22,
+  0x60, 0x18, 0x28, 0x28, 0xbf, 0xf7, 0x21, 0x60, 0x1c, 0x05, 0xf0, 0x6a,
+  0x42, 0x06, 0xd0, 0xff, 0x20, 0x68, 0xc2, 0xf1, 0x20, 0x03, 0x98, 0x40,
+  0xff, 0x23, 0x68, 0xd3, 0x40, 0x23, 0x60, 0x22, 0x68, 0xff, 0x0a, 0x43,
+  0xb0, 0xf1, 0x00, 0x4f, 0x22, 0x60, 0xff, 0x03, 0xd8, 0x08, 0xd1, 0x20,
+  0x78, 0xc0, 0x07, 0xbb, 0x05, 0xd5, 0x91, 0x00, 0x1c, 0x20, 0x60, 0x6d,
+  0x00, 0x30, 0x7e, 0x93, 0x00, 0x68, 0x88, 0x42, 0xf9, 0xd1, 0x00, 0x73,
+  0x00, 0xdc, 0x33, 0xe1, 0x1f, 0xe0, 0xbf, 0x09, 0xd0, 0x2b, 0xa1, 0x88,
+  0x40, 0x47, 0xc9, 0x1c, 0xc1, 0x21, 0xa8, 0x07, 0xe0, 0x97, 0xc0, 0x67,
+  0x31, 0x10, 0xfb, 0xbc, 0x16, 0xe3, 0xb1, 0x4f, 0xf4, 0x7c, 0x70, 0x00,
+  0xff, 0xfb, 0x04, 0x50, 0x00, 0xf0, 0xf2, 0xf8, 0x64, 0xff, 0x1c, 0x04,
+  0x2c, 0xf4, 0xd3, 0x61, 0x4e, 0x62, 0xff, 0x4d, 0xf4, 0xf7, 0x3c, 0xfe,
+  0xf1, 0x6a, 0x04, 0xfe, 0x9b, 0xe0, 0x43, 0xf8, 0xa5, 0xf8, 0x4a, 0x00,
+  0x20, 0xbf, 0x46, 0x31, 0x6c, 0x00, 0xf0, 0x3d, 0x0b, 0x00, 0x5a, 0x7f,
+  0x01, 0x70, 0xbd, 0x0f, 0xf2, 0x80, 0x11, 0xfb, 0xc2, 0xf7, 0xf0, 0x6a,
+  0xb9, 0xb3, 0xb0, 0xbf, 0xf0, 0xb5, 0x14, 0xff, 0x46, 0x83, 0xb0, 0x20,
+  0x70, 0x61, 0x70, 0x05, 0xef, 0x00, 0x0f, 0xf2, 0x54, 0x1b, 0x00, 0x25,
+  0x60, 0x4f, 0xf7, 0x49, 0x66, 0x60, 0x5b, 0x00, 0x72, 0x02, 0xfb, 0x05,
+  0xf7, 0x11, 0xa1, 0x60, 0xa5, 0xb0, 0x2d, 0x4b, 0x49, 0x07, 0xff, 0xbf,
+  0xcf, 0x6a, 0x01, 0x20, 0x0f, 0x6c, 0x03, 0xff, 0x20, 0xf4, 0xf7, 0x8a,
+  0xf9, 0x04, 0xf1, 0x10, 0xff, 0x01, 0x01, 0x91, 0x06, 0xf1, 0x48, 0x03,
+  0x04, 0xff, 0xf1, 0x0c, 0x01, 0x00, 0x91, 0x3a, 0x46, 0x01, 0xfb, 0x46,
+  0x30, 0x71, 0x00, 0x27, 0xf8, 0x0f, 0xf2, 0x20, 0xff, 0x10, 0x50, 0xf8,
+  0x25, 0x10, 0x20, 0x46, 0x03, 0xf9, 0xb0, 0xdf, 0x20, 0xb3, 0xa0, 0x4a,
+  0xb9, 0x38, 0xb5, 0x0d, 0xff, 0x46, 0x04, 0x46, 0xb5, 0xf1, 0x00, 0x5f,
+  0x80, 0xff, 0x41, 0xc0, 0x0f, 0xf7, 0xf7, 0x81, 0xff, 0xb4, 0xe7, 0xeb,
+  0x45, 0x0f, 0x31, 0x80, 0xf1, 0x00, 0x28, 0x09, 0x60, 0xff, 0x21, 0x48,
+  0x43, 0x21, 0x09, 0xb0, 0xfb, 0xf1, 0xdf, 0xf0, 0x30, 0x28, 0x01, 0xd2,
+  0x79, 0x11, 0x2f, 0x38, 0x9f, 0xff, 0x28, 0x88, 0xbf, 0xff, 0x09, 0x00,
+  0x39, 0xd0, 0x43, 0xff, 0x80, 0x46, 0x08, 0xf1, 0x48, 0x06, 0x0c, 0x46,
+  0xff, 0x70, 0x88, 0x91, 0x46, 0x1d, 0x46, 0xf5, 0xf7, 0xff, 0xcf, 0xf8,
+  0x07, 0x46, 0x15, 0x2c, 0x2c, 0xbf, 0xfb, 0x14, 0x3c, 0x4b, 0xd0, 0x46,
+  0xf6, 0xf7, 0x61, 0xfd, 0x77, 0x81, 0x46, 0x20, 0x07, 0x00, 0x5d, 0xfd,
+  0x49, 0x05, 0x00, 0x7f, 0xf8, 0xfe, 0x04, 0x46, 0x07, 0xf1, 0x30, 0xfc,
+  0x90, 0x7f, 0x48, 0x43, 0xf6, 0xf7, 0x53, 0xfd, 0x01, 0x1b, 0x02, 0xff,
+  0x5f, 0xfd, 0xfd, 0xf7, 0xcd, 0xfd, 0x08, 0x9f, 0xff, 0x09, 0x9c, 0xd0,
+  0xb1, 0xf7, 0xf7, 0x7d, 0xff, 0xfd, 0x0c, 0xad, 0x10, 0x0c, 0x20, 0x31,
+  0x88, 0x4f, 0xf2, 0xff, 0xff, 0x02, 0x11, 0x40, 0x41, 0xea, 0x00, 0x21,
+  0xff, 0x29, 0x80, 0xc0, 0xf1, 0x0c, 0x00, 0x01, 0x21, 0xff, 0x01, 0xfa,
+  0x00, 0xf0, 0x08, 0xf5, 0x84, 0x71, 0xff, 0x0a, 0x88, 0x02, 0xb9, 0x02,
+  0x46, 0x3a, 0x60, 0xff, 0x49, 0x88, 0x41, 0xb1, 0x21, 0x60, 0x07, 0xe0,
+  0xfd, 0x30, 0x2b, 0x01, 0x01, 0x08, 0x40, 0x28, 0x80, 0x00, 0xff, 0x20,
+  0x38, 0x60, 0x20, 0x60, 0xbd, 0xe8, 0xf1, 0x3f, 0x83, 0x04, 0x28, 0x06,
+  0xda, 0x04, 0xef, 0xd0, 0x29, 0x11, 0xdf, 0x00, 0x10, 0x00, 0xf0, 0xe5,
+  0xf5, 0x60, 0x00, 0x00, 0xff, 0xc0, 0x92, 0x00, 0x20, 0x74, 0x29, 0x00,
+  0x20, 0x3b, 0x98, 0x02, 0x9b, 0x20, 0x42, 0x0f, 0x00, 0x07, 0x01, 0x03,
+  0x01, 0xdb, 0xa8, 0x03, 0x03, 0x03, 0xfc, 0xe9, 0x0f, 0x00, 0xea, 0x00,
+  0x3f, 0x20, 0x34, 0xeb, 0x00, 0x20, 0xd0, 0x03, 0x00, 0x7b, 0xc7, 0xff,
+  0x70, 0x47, 0x01, 0x68, 0x11, 0xf1, 0x01, 0x0f, 0xdf, 0x1c, 0xbf, 0x49,
+  0x1c, 0x01, 0x87, 0xf0, 0x01, 0x88, 0xbf, 0x4f, 0xf6, 0xff, 0x72, 0x91,
+  0x42, 0x0f, 0x02, 0x80, 0xfc, 0x83, 0x31, 0xd5, 0x10, 0x20, 0x20, 0x80,
+  0x60, 0x80, 0x60, 0xef, 0x60, 0x0d, 0x46, 0xc0, 0xdf, 0xd0, 0x08, 0x00,
+  0xf7, 0xfb, 0xf7, 0x2f, 0xed, 0xc0, 0x80, 0x40, 0xa0, 0x66, 0x00, 0xfa,
+  0x0f, 0x00, 0xd0, 0x34, 0xc0, 0x4f, 0xf0, 0x7e, 0x51, 0x41, 0xfe, 0xf9,
+  0xc0, 0x81, 0x60, 0x01, 0x73, 0x04, 0xf1, 0xe0, 0xfe, 0x9f, 0x20, 0xec,
+  0xfe, 0x28, 0x46, 0xbd, 0xe8, 0x32, 0xff, 0x40, 0x58, 0xe0, 0x38, 0xb5,
+  0x00, 0x25, 0x05, 0xff, 0x80, 0x00, 0xf1, 0xe0, 0x04, 0x45, 0x80, 0xd0,
+  0xff, 0x30, 0x65, 0x68, 0x45, 0x60, 0x25, 0x68, 0x85, 0xff, 0x60, 0x01,
+  0x70, 0x01, 0x25, 0x05, 0x73, 0x00, 0xdf, 0x25, 0x45, 0x73, 0x20, 0x46,
+  0xea, 0x90, 0xe8, 0x30, 0xff, 0x40, 0x01, 0xf0, 0x55, 0xbe, 0x70, 0xb5,
+  0x0c, 0xfa, 0x63, 0x00, 0x06, 0x71, 0x00, 0x30, 0x80, 0x70, 0x80, 0x70,
+  0xbf, 0x60, 0x06, 0xf1, 0xe0, 0x05, 0x06, 0x71, 0x02, 0xf6, 0xfd, 0xfc,
+  0x71, 0x01, 0xb0, 0x66, 0x06, 0xf1, 0xd0, 0x01, 0xff, 0x05, 0xf5, 0x0a,
+  0x70, 0x42, 0x68, 0x4a, 0x60, 0xf7, 0x00, 0x68, 0x88, 0x35, 0x30, 0x08,
+  0x73, 0x00, 0x20, 0xff, 0x48, 0x73, 0x95, 0xf8, 0xf4, 0x02, 0x08, 0x70,
+  0xeb, 0x21, 0x46, 0x75, 0x01, 0x70, 0x4b, 0x00, 0xf8, 0xbe, 0x00, 0xff,
+  0x21, 0x01, 0x60, 0x41, 0x60, 0x81, 0x60, 0xc1, 0xfe, 0xf1, 0x21, 0x31,
+  0x01, 0x61, 0x00, 0x21, 0x41, 0x61, 0xff, 0x70, 0x47, 0x42, 0x68, 0x11,
+  0x43, 0x41, 0x60, 0xff, 0x08, 0x30, 0x83, 0xe7, 0x02, 0x69, 0x8a, 0x42,
+  0xff, 0x88, 0xbf, 0x0a, 0x46, 0x02, 0x61, 0x42, 0x69, 0xbf, 0x91, 0x42,
+  0x38, 0xbf, 0x11, 0x46, 0x1f, 0x01, 0x0c, 0xef, 0x30, 0x76, 0xe7, 0x10,
+  0xf3, 0x03, 0x60, 0x28, 0x21, 0xd7, 0x64, 0x20, 0x60, 0x2f, 0x32, 0xa0,
+  0x81, 0x40, 0xe0, 0x60, 0xdf, 0x20, 0x61, 0x04, 0xf1, 0x74, 0x8b, 0x00,
+  0xb0, 0xfc, 0xff, 0x04, 0xf1, 0x5c, 0x00, 0xff, 0xf7, 0xce, 0xff, 0xed,
+  0x20, 0x6d, 0x00, 0x10, 0x40, 0x2f, 0x01, 0x04, 0xf1, 0x44, 0xaa, 0x11,
+  0x00, 0xc5, 0x11, 0x0a, 0x2c, 0x11, 0x00, 0xbc, 0x11, 0x04, 0x14, 0xe7,
+  0x30, 0xb6, 0xe7, 0xcd, 0x71, 0x23, 0x41, 0xad, 0xf5, 0x7c, 0xfb, 0x7d,
+  0x05, 0x49, 0x00, 0xc4, 0xf8, 0x60, 0x03, 0x00, 0xfd, 0x22, 0x43, 0x11,
+  0x30, 0x00, 0xf4, 0xf7, 0x1a, 0xff, 0xef, 0xff, 0xf7, 0x33, 0xff, 0xfb,
+  0x01, 0x28, 0x60, 0x68, 0x3b, 0x60, 0x28, 0x55, 0xf0, 0xdc, 0xff, 0x86,
+  0xa1, 0x10, 0xeb, 0x10, 0xff, 0x78, 0xa1, 0x68, 0x42, 0x46, 0x68, 0x46,
+  0xf9, 0xdf, 0xf7, 0x3d, 0xfd, 0x00, 0x27, 0x19, 0x01, 0xd8, 0xff, 0xfd,
+  0x69, 0x63, 0x20, 0x00, 0xf0, 0x98, 0xf8, 0xff, 0xf7, 0xd5, 0x19, 0x33,
+  0x00, 0xa0, 0x1f, 0x00, 0x69, 0x1f, 0x00, 0x2d, 0xfd, 0xfd, 0xe8, 0xe3,
+  0x30, 0xe8, 0x60, 0x60, 0x7f, 0x10, 0xb1, 0xff, 0x28, 0x69, 0x40, 0x1c,
+  0x28, 0x61, 0xa0, 0x68, 0x7f, 0x61, 0x68, 0x40, 0x88, 0x89, 0x8a, 0x90,
+  0xeb, 0x20, 0xfd, 0x64, 0x81, 0x20, 0x63, 0x20, 0x68, 0x60, 0x61, 0x69,
+  0xf7, 0x09, 0xb3, 0x05, 0xc1, 0x02, 0x78, 0xff, 0x61, 0x69, 0xa5, 0x05,
+  0xb9, 0x02, 0x73, 0x09, 0x02, 0xb1, 0x01, 0x6e, 0x09, 0x02, 0x14, 0xfe,
+  0x09, 0x00, 0x69, 0xff, 0x60, 0x69, 0xc1, 0x06, 0x01, 0xff, 0xd5, 0x03,
+  0x20, 0x07, 0xe0, 0x81, 0x07, 0x02, 0xfb, 0xd5, 0x01, 0x99, 0x00, 0x3c,
+  0xe0, 0xc0, 0x07, 0x3b, 0xfb, 0xd5, 0x02, 0x09, 0x00, 0x37, 0xe0, 0x20,
+  0x69, 0xa8, 0xff, 0xb3, 0xa0, 0x7f, 0x00, 0x28, 0x1c, 0xbf, 0xe0, 0x7e,
+  0x05, 0x00, 0x30, 0xd0, 0x20, 0x6a, 0xa8, 0x60, 0x39, 0x01, 0xff, 0x21,
+  0x6a, 0xff, 0xf7, 0x50, 0xff, 0x21, 0x6a, 0x92, 0x4f, 0x03, 0x4b, 0x09,
+  0x02, 0x63, 0x01, 0x46, 0x09, 0x02, 0x77, 0x01, 0x41, 0xff, 0xff, 0x20,
+  0x78, 0xa9, 0x68, 0x32, 0x30, 0xc0, 0xff, 0xb2, 0xf7, 0xf7, 0x97, 0xfe,
+  0xe0, 0x7f, 0x02, 0xb7, 0x28, 0x10, 0xd1, 0x73, 0x03, 0x3f, 0xff, 0x35,
+  0x03, 0x3b, 0xe4, 0x07, 0x00, 0x33, 0x01, 0x37, 0x07, 0x00, 0x31, 0x01,
+  0x33, 0xff, 0x00, 0xb7, 0xe0, 0x01, 0x27, 0x23, 0x03, 0xa6, 0xfe, 0x23,
+  0x03, 0xa2, 0xe4, 0x07, 0x00, 0x23, 0x01, 0x9e, 0x07, 0x00, 0x23, 0x01,
+  0x9a, 0xfe, 0x60, 0xff, 0x78, 0x08, 0xb9, 0x01, 0x27, 0x00, 0xe0, 0x0f,
+  0xf3, 0xb1, 0x64, 0xe7, 0x00, 0x3d, 0x11, 0x00, 0x2f, 0x3f, 0xf4, 0x9f,
+  0x66, 0xaf, 0x28, 0x68, 0x0d, 0x73, 0x10, 0xfb, 0x61, 0xf8, 0xfe, 0xdb,
+  0x12, 0x60, 0x61, 0x20, 0x76, 0x60, 0x76, 0xa0, 0x7f, 0x76, 0xe0, 0x76,
+  0x20, 0x77, 0x60, 0x77, 0x29, 0x40, 0xf7, 0xf1, 0x24, 0x00, 0x87, 0x10,
+  0xf5, 0x56, 0x76, 0x01, 0xff, 0x70, 0x41, 0x60, 0x41, 0x70, 0xb1, 0x61,
+  0xf1, 0xff, 0x61, 0x20, 0x69, 0x88, 0xb1, 0x31, 0x68, 0x00, 0xff, 0x29,
+  0x1c, 0xbf, 0x71, 0x79, 0x01, 0x29, 0x0b, 0xff, 0xd1, 0x61, 0x68, 0x2a,
+  0x88, 0x4b, 0x8a, 0x9a, 0xbf, 0x42, 0x06, 0xd3, 0x6a, 0x88, 0x8b, 0x07,
+  0x00, 0x89, 0xdf, 0x41, 0xc9, 0x43, 0xc9, 0x0f, 0xcf, 0x40, 0x21, 0xa1,
+  0xff, 0x77, 0xa1, 0x7f, 0x01, 0xb9, 0xe0, 0x68, 0x30, 0xff, 0x84, 0x01,
+  0xf0, 0xfe, 0xfe, 0x30, 0x8c, 0x88, 0xff, 0xb9, 0x60, 0x69, 0x40, 0xf0,
+  0x10, 0x00, 0x60, 0xff, 0x61, 0x0c, 0xe0, 0x20, 0x7e, 0x03, 0x28, 0x56,
+  0xbb, 0xd0, 0x02, 0x23, 0x10, 0x60, 0x7e, 0x01, 0x15, 0x60, 0x60, 0xff,
+  0x68, 0x80, 0x78, 0x08, 0xb1, 0xf2, 0xf7, 0x98, 0xff, 0xfb, 0x60, 0x69,
+  0x00, 0x28, 0x38, 0xd1, 0xdf, 0x7f, 0xf8, 0x78, 0x75, 0x20, 0x78, 0x47,
+  0xf8, 0x52, 0x60, 0xfb, 0x20, 0xf0, 0x95, 0x04, 0x00, 0x21, 0xf3, 0xf7,
+  0x77, 0xf5, 0xf8, 0xdf, 0x11, 0x4a, 0x05, 0x02, 0xed, 0xf8, 0xf0, 0x69,
+  0xfd, 0x98, 0x43, 0x60, 0x00, 0xf0, 0x8d, 0xf8, 0x20, 0x7e, 0xbd, 0x70,
+  0x09, 0x02, 0xaa, 0xf8, 0x28, 0xb3, 0xc7, 0x00, 0x76, 0xfe, 0x0b, 0x01,
+  0x05, 0xf9, 0x30, 0x68, 0x31, 0x8c, 0x88, 0xdf, 0x42, 0xeb, 0xd3, 0x01,
+  0x20, 0x3d, 0x00, 0x20, 0x21, 0x7a, 0x4f, 0x00, 0x21, 0x83, 0x50, 0x00,
+  0xf0, 0x5e, 0xf8, 0x39, 0x71, 0xf7, 0xae, 0xf8, 0xb0, 0x6b, 0x00, 0x04,
+  0xbf, 0xa0, 0x7e, 0xff, 0x00, 0x28, 0xb6, 0xd0, 0xa0, 0x7e, 0x70, 0xb1,
+  0xfd, 0x29, 0x3d, 0x22, 0x08, 0xfa, 0xe0, 0x7e, 0x28, 0xb9, 0x7f, 0x01,
+  0x20, 0x20, 0x77, 0x07, 0xe0, 0x01, 0x4b, 0x00, 0xfb, 0xe1, 0xe7, 0xf5,
+  0x20, 0x77, 0xf1, 0xbd, 0x20, 0x7f, 0xfd, 0x60, 0x21, 0x04, 0x7b, 0xfa,
+  0x08, 0xb1, 0x01, 0x20, 0x0b, 0x04, 0xe0, 0xcf, 0x01, 0x04, 0xcf, 0x00,
+  0x71, 0x00, 0x1f, 0x00, 0x13, 0x41, 0xff, 0x60, 0x68, 0x18, 0x30, 0xf4,
+  0xf7, 0x0d, 0xfd, 0xff, 0x20, 0x78, 0x02, 0x28, 0x18, 0xbf, 0x03, 0x28,
+  0xff, 0x27, 0xd1, 0xf3, 0xf7, 0x0c, 0xfb, 0x03, 0x28, 0xdd, 0x23, 0x6b,
+  0x60, 0x02, 0x28, 0x02, 0x0d, 0x00, 0x5c, 0xfb, 0xff, 0x01, 0xe0, 0xf3,
+  0xf7, 0x6d, 0xfb, 0x05, 0x46, 0x7f, 0x04, 0xf5, 0x59, 0x70, 0xf4, 0xf7,
+  0xf4, 0xf3, 0x10, 0xef, 0x03, 0x28, 0x0c, 0xbf, 0x91, 0x70, 0x20, 0xf5,
+  0xf7, 0xff, 0x15, 0xf8, 0x05, 0x2d, 0x18, 0xbf, 0x06, 0x2d, 0xff, 0x02,
+  0xd1, 0xf5, 0xf7, 0x47, 0xf8, 0x01, 0xe0, 0xff, 0xf5, 0xf7, 0x40, 0xf8,
+  0xf5, 0xf7, 0x2b, 0xf8, 0x7e, 0x35, 0x43, 0xfd, 0xf7, 0x68, 0xbf, 0x31,
+  0xbd, 0x45, 0x31, 0xd7, 0xf4, 0xf7, 0x25, 0x63, 0x06, 0x0c, 0x55, 0x00,
+  0xda, 0xfa, 0xff, 0x03, 0x28, 0x08, 0xd1, 0xfd, 0xf7, 0xb0, 0xff, 0xfc,
+  0x55, 0x01, 0x59, 0x31, 0x00, 0x21, 0xf4, 0xf7, 0xd8, 0xbf, 0xfd, 0x10,
+  0x2d, 0x00, 0x00, 0xf0, 0x52, 0xf8, 0xfe, 0xf7, 0xff, 0x00, 0xff, 0x60,
+  0x68, 0x23, 0x78, 0xa1, 0x7f, 0xff, 0x00, 0xf1, 0x18, 0x02, 0x0f, 0xf2,
+  0xb8, 0x40, 0xff, 0x18, 0x5c, 0xf4, 0xf7, 0x0c, 0xfd, 0x01, 0x28, 0xff,
+  0x03, 0xd0, 0xa1, 0x68, 0xd1, 0xf8, 0xec, 0x13, 0xcd, 0x09, 0xd1, 0x00,
+  0x08, 0xe0, 0x51, 0x01, 0x13, 0x10, 0xd0, 0x61, 0xdd, 0x69, 0xb5, 0xb1,
+  0x03, 0x20, 0x61, 0x7b, 0x10, 0x10, 0xbd, 0xf5, 0xd0, 0x43, 0x00, 0x30,
+  0x43, 0x00, 0xf2, 0xfe, 0x01, 0x28, 0xff, 0x20, 0xd0, 0x00, 0x26, 0x00,
+  0x27, 0x01, 0x22, 0xff, 0xdf, 0xf8, 0xd8, 0x03, 0x00, 0xf0, 0x1e, 0xf8,
+  0xd7, 0xdf, 0xf8, 0xd4, 0x07, 0x00, 0x1a, 0x07, 0x00, 0xd0, 0x03, 0x7f,
+  0x50, 0xf8, 0x22, 0x00, 0xc1, 0x17, 0x49, 0x79, 0xe0, 0xff, 0xd0, 0x71,
+  0x16, 0xeb, 0x40, 0x06, 0x4f, 0x41, 0xff, 0x52, 0x1c, 0x18, 0x2a, 0xe9,
+  0xd3, 0x60, 0x68, 0xff, 0xd0, 0xe9, 0x02, 0x23, 0x9f, 0x42, 0x04, 0xdc,
+  0xdf, 0x01, 0xdb, 0x96, 0x42, 0x01, 0x99, 0x70, 0xd0, 0xbd, 0xf9, 0x01,
+  0x03, 0x00, 0x2f, 0x01, 0x16, 0xeb, 0x00, 0x16, 0x57, 0xff, 0xeb, 0x10,
+  0x77, 0x70, 0x47, 0x04, 0x46, 0x0f, 0x7f, 0xf2, 0x24, 0x40, 0x21, 0x78,
+  0x08, 0x5c, 0x5d, 0x71, 0xff, 0x04, 0x46, 0xa5, 0x7f, 0x05, 0xb1, 0x01,
+  0x25, 0xff, 0x21, 0x78, 0x0f, 0xf2, 0x14, 0x40, 0x08, 0x5c, 0xff, 0xff,
+  0xf7, 0x7d, 0xfb, 0x04, 0xf5, 0x54, 0x76, 0xff, 0xb1, 0x68, 0x29, 0xb1,
+  0x31, 0x7b, 0x81, 0x42, 0xff, 0x04, 0xbf, 0x71, 0x7b, 0xa9, 0x42, 0x08,
+  0xd0, 0xa7, 0x01, 0x46, 0x2a, 0xa7, 0x20, 0x29, 0x41, 0x05, 0xf9, 0x80,
+  0xc6, 0xff, 0xe9, 0x00, 0x00, 0xa1, 0x68, 0x00, 0x20, 0xc1, 0x5f, 0xf8,
+  0xec, 0x03, 0x70, 0xbd, 0x45, 0x41, 0x30, 0x8f, 0x10, 0xf3, 0xf8, 0xbc,
+  0x79, 0x43, 0x25, 0x01, 0x3a, 0xfd, 0xd4, 0xe9, 0x7f, 0x0c, 0x01, 0xc4,
+  0xe9, 0x3e, 0x01, 0x10, 0xd3, 0x60, 0xff, 0xf0, 0x4f, 0x04, 0x46, 0xad,
+  0xf2, 0xfc, 0x5d, 0xff, 0xe0, 0x68, 0x00, 0xf5, 0x4b, 0x71, 0x91, 0xf8,
+  0xff, 0x00, 0x80, 0x4f, 0x78, 0x01, 0x21, 0x21, 0x77, 0xfe, 0xf9, 0x20,
+  0x06, 0x00, 0x21, 0x61, 0x77, 0x71, 0x70, 0xff, 0xa1, 0x68, 0x67, 0x90,
+  0x5c, 0x31, 0x66, 0x91, 0xff, 0x20, 0x68, 0xe0, 0x30, 0x68, 0x90, 0x60,
+  0x68, 0xff, 0x69, 0x90, 0x61, 0x69, 0x20, 0x69, 0x01, 0xf0, 0xff, 0xf9,
+  0xfd, 0x6a, 0x90, 0x20, 0x68, 0x90, 0xf8, 0xff, 0xd0, 0x10, 0x88, 0x45,
+  0x03, 0xd1, 0xd0, 0xf8, 0xff, 0xf8, 0x12, 0x01, 0x29, 0x08, 0xd1, 0x68,
+  0x99, 0xff, 0x01, 0xf5, 0x04, 0x71, 0x0a, 0x68, 0x52, 0x1c, 0xf5, 0x0a,
+  0xf7, 0x50, 0xc0, 0x15, 0x01, 0x2f, 0x1b, 0xd1, 0x69, 0xff, 0x46, 0x66,
+  0xa8, 0x01, 0xf0, 0x8e, 0xfc, 0x60, 0xff, 0x77, 0x00, 0x20, 0x27, 0x68,
+  0x78, 0x80, 0x65, 0xf7, 0x7f, 0x1d, 0xb9, 0x3f, 0x51, 0x20, 0x62, 0x09,
+  0xe0, 0xff, 0x00, 0x98, 0xfd, 0xf7, 0x45, 0xfa, 0x02, 0x2d, 0x7f, 0x20,
+  0x62, 0x03, 0xd1, 0x41, 0x46, 0x38, 0xc5, 0x40, 0xfd, 0x08, 0x9d, 0x90,
+  0x70, 0x70, 0x02, 0x20, 0xbe, 0xe0, 0xde, 0xc9, 0x90, 0x90, 0x68, 0x98,
+  0x00, 0x51, 0x00, 0x08, 0x68, 0x7b, 0x98, 0xb1, 0x45, 0x01, 0x00, 0xf0,
+  0xdc, 0xf9, 0x63, 0x03, 0xff, 0x48, 0x60, 0x48, 0x68, 0x03, 0x28, 0x15,
+  0xd0, 0xfb, 0x48, 0x68, 0xc3, 0x11, 0x08, 0x68, 0x40, 0x1e, 0x08, 0xfb,
+  0x60, 0x0e, 0x31, 0x00, 0x0d, 0xe0, 0x48, 0x68, 0x02, 0xfd, 0x28, 0x2b,
+  0x01, 0x02, 0xd1, 0x00, 0xf0, 0xc5, 0xf9, 0xdf, 0x01, 0xe0, 0x00, 0xf0,
+  0x6d, 0x33, 0x00, 0xc1, 0xf8, 0xfb, 0x14, 0x02, 0x57, 0x01, 0x00, 0x2f,
+  0x68, 0x98, 0xd0, 0xfe, 0x0b, 0x00, 0x69, 0x99, 0x48, 0x62, 0x40, 0xf0,
+  0x8e, 0xf6, 0x43, 0x70, 0x00, 0x90, 0xf3, 0x90, 0x09, 0x27, 0x68, 0x07,
+  0xfe, 0x55, 0x60, 0x05, 0xf1, 0xcc, 0x00, 0x29, 0x68, 0x40, 0xff, 0x68,
+  0xf6, 0xf7, 0x7d, 0xfa, 0x33, 0x90, 0x33, 0xff, 0xa8, 0x05, 0xeb, 0x89,
+  0x0b, 0x00, 0xeb, 0x89, 0xff, 0x0a, 0xdb, 0xf8, 0x04, 0x00, 0xd5, 0xf8,
+  0xcc, 0xbf, 0x10, 0xf6, 0xf7, 0x0d, 0xfb, 0xca, 0x0b, 0x00, 0x09, 0xff,
+  0xf1, 0x01, 0x09, 0xdb, 0xf8, 0x68, 0x00, 0xca, 0xfe, 0x03, 0x00, 0xb9,
+  0xf1, 0x19, 0x0f, 0xe9, 0xd3, 0x00, 0xff, 0x25, 0x33, 0xa8, 0x00, 0xeb,
+  0x85, 0x09, 0x73, 0xf3, 0x49, 0xd9, 0x1f, 0x00, 0x03, 0x80, 0xfa, 0x82,
+  0x46, 0x33, 0xef, 0x98, 0xd9, 0xf8, 0x68, 0x33, 0x00, 0x57, 0xfa, 0x81,
+  0xaf, 0x46, 0x50, 0x46, 0x51, 0xfd, 0x70, 0xee, 0x15, 0x00, 0x48, 0xed,
+  0x46, 0x1d, 0x81, 0xe9, 0xfa, 0x0f, 0x01, 0x4a, 0xfa, 0x4f, 0xff, 0xf0,
+  0x7a, 0x51, 0xf6, 0xf7, 0xe2, 0xfa, 0x01, 0xfe, 0xad, 0x50, 0xd0, 0xf8,
+  0x00, 0x01, 0xf6, 0xf7, 0xca, 0xbb, 0xfa, 0x08, 0x7b, 0x80, 0x30, 0x70,
+  0x41, 0x35, 0xa0, 0xff, 0xf7, 0xf7, 0x81, 0xfc, 0xb5, 0x01, 0x38, 0xe0,
+  0x6d, 0x1c, 0xff, 0x19, 0x2d, 0xcd, 0xd3, 0x07, 0xf1, 0xd4, 0x00, 0xff,
+  0x01, 0x7a, 0x49, 0xb9, 0x34, 0x99, 0x01, 0x60, 0xef, 0x33, 0x99, 0x41,
+  0x60, 0x25, 0x80, 0x72, 0x01, 0x20, 0xff, 0x21, 0x68, 0x81, 0xf8, 0xdd,
+  0x00, 0x20, 0x68, 0x6f, 0x80, 0xf8, 0xd0, 0x80, 0x33, 0x01, 0x28, 0xfc,
+  0x0b, 0x00, 0xbf, 0x1c, 0xff, 0xf7, 0x24, 0xfc, 0xa0, 0x21, 0x41, 0x68,
+  0xff, 0xd4, 0x30, 0x18, 0x26, 0x41, 0x68, 0x33, 0x91, 0xdf, 0x00, 0x68,
+  0x34, 0x99, 0xf6, 0x79, 0xb0, 0x05, 0x46, 0xbe, 0xab, 0x01, 0x86, 0x07,
+  0x29, 0x46, 0x78, 0xe9, 0x00, 0xa4, 0xbf, 0xfa, 0x76, 0x1e, 0x78, 0x60,
+  0xf5, 0x07, 0xa0, 0x01, 0xbf, 0x1d, 0x6b, 0x46, 0x01, 0xaa, 0x33, 0xab,
+  0x10, 0x21, 0xce, 0x4b, 0x20, 0x20, 0x77, 0x0d, 0x19, 0x20, 0x1d, 0x50,
+  0x8f, 0x70, 0xff, 0xb5, 0x82, 0xb0, 0x04, 0x46, 0x0e, 0x46, 0x6a, 0xfb,
+  0x46, 0x00, 0x40, 0x40, 0xf2, 0xf7, 0xe6, 0xff, 0x00, 0x5b, 0x98, 0x30,
+  0x21, 0x40, 0xe0, 0x76, 0x01, 0x41, 0x08, 0x01, 0x40, 0xff, 0x73, 0xbd,
+  0x20, 0x78, 0x01, 0x46, 0x02, 0x29, 0x7e, 0x37, 0x20, 0x05, 0x08, 0xd0,
+  0x03, 0x29, 0x09, 0x93, 0x30, 0xff, 0x7b, 0xf9, 0x68, 0x70, 0x68, 0x78,
+  0xfd, 0xf7, 0xf7, 0xb3, 0xff, 0x0b, 0xf1, 0x30, 0x60, 0xf9, 0xf7, 0xe7,
+  0xf9, 0x00, 0x5d, 0x30, 0x25, 0x21, 0x0f, 0xf2, 0x38, 0x10, 0x08, 0x7f,
+  0x5c, 0xfd, 0xf7, 0x9d, 0xff, 0x40, 0x1e, 0x87, 0x91, 0xff, 0x68, 0x60,
+  0x00, 0x98, 0x06, 0x60, 0x00, 0x99, 0x95, 0xd4, 0xf9, 0x60, 0x48, 0x07,
+  0x00, 0x60, 0xc1, 0x70, 0xad, 0x21, 0x00, 0xfb, 0x99, 0xc8, 0x0d, 0x00,
+  0x68, 0x68, 0x88, 0x61, 0x21, 0xff, 0x78, 0x1e, 0x48, 0x01, 0x29, 0x03,
+  0xd9, 0x89, 0xdf, 0x1e, 0x01, 0x29, 0x05, 0xd9, 0x35, 0x20, 0x9a, 0x41,
+  0xbf, 0x6b, 0x11, 0x61, 0xc0, 0x6a, 0x08, 0x09, 0x00, 0x81, 0xbf, 0x6c,
+  0x11, 0x61, 0x00, 0x6c, 0x03, 0x09, 0x00, 0xc1, 0xff, 0x6d, 0x11, 0x61,
+  0x40, 0x6d, 0x00, 0x99, 0x14, 0xf3, 0x4a, 0x48, 0xd7, 0x70, 0xe3, 0x41,
+  0x1d, 0xf8, 0x00, 0x98, 0x7f, 0x90, 0xf8, 0x25, 0x00, 0x10, 0xb1, 0x20,
+  0x59, 0x20, 0xff, 0x77, 0xfe, 0x00, 0x98, 0x40, 0x7f, 0xe0, 0x77, 0xff,
+  0x00, 0x98, 0x50, 0xf8, 0x20, 0x1f, 0x21, 0x62, 0xff, 0x00, 0x79, 0x28,
+  0x70, 0x00, 0x98, 0x00, 0x7f, 0x7d, 0xe0, 0x1d, 0x50, 0xf2, 0xf7, 0xc3,
+  0xff, 0x73, 0xf5, 0xa0, 0xcd, 0x10, 0xc7, 0xb0, 0x80, 0x16, 0x0a, 0xd0,
+  0x03, 0x00, 0x80, 0x17, 0xee, 0x07, 0x00, 0x00, 0x80, 0xbf, 0x43, 0x91,
+  0x29, 0x06, 0x01, 0x79, 0x01, 0x03, 0xa1, 0x3f, 0xa1, 0x0f, 0xf2, 0x78,
+  0x00, 0x97, 0x30, 0xfb, 0x5c, 0x38, 0x87, 0x40, 0x32, 0xfc, 0x80, 0x46,
+  0xf1, 0xf7, 0xf7, 0xf6, 0xf9, 0xa7, 0x31, 0x70, 0x00, 0x08, 0x5c, 0x7f,
+  0x40, 0xf0, 0x02, 0x09, 0x29, 0x1d, 0x40, 0x19, 0x00, 0x7f, 0xc4, 0xfb,
+  0x00, 0x26, 0x28, 0xb1, 0x49, 0xd3, 0x20, 0xff, 0xf4, 0xf7, 0x2b, 0xfc,
+  0x00, 0xb1, 0x01, 0x26, 0xf9, 0x95, 0xa5, 0x10, 0x71, 0x52, 0x6a, 0x00,
+  0x28, 0x0e, 0xd0, 0x9f, 0x02, 0x2f, 0x06, 0xd3, 0x94, 0x9b, 0x00, 0xa5,
+  0x31, 0xfd, 0xee, 0x5b, 0x40, 0x02, 0xe0, 0x20, 0x2d, 0x10, 0xc0, 0xfe,
+  0x00, 0xfb, 0x20, 0x85, 0x27, 0x00, 0xf1, 0xf7, 0xe1, 0xf9, 0x30, 0xb6,
+  0xf5, 0x40, 0xf2, 0x83, 0xb1, 0x80, 0x80, 0x01, 0x4b, 0x30, 0xec, 0xbd,
+  0x13, 0xd3, 0x91, 0x00, 0x01, 0x02, 0x02, 0x03, 0x04, 0x03, 0xfa, 0x0d,
+  0x00, 0x04, 0xb9, 0x61, 0x04, 0xf1, 0x14, 0x06, 0x06, 0xfb, 0xf5, 0xd0,
+  0xb1, 0x60, 0x01, 0x20, 0xb8, 0x62, 0x05, 0xff, 0x20, 0xe1, 0x68, 0x08,
+  0x60, 0xa0, 0x68, 0x00, 0xbf, 0xf0, 0x89, 0xf9, 0x00, 0x22, 0x31, 0xb1,
+  0x52, 0xcc, 0xff, 0xf9, 0x28, 0x68, 0x20, 0xbb, 0x38, 0x68, 0x10, 0xdd,
+  0xb3, 0x0f, 0x03, 0x1c, 0xf9, 0xe1, 0x25, 0x40, 0x08, 0x62, 0x7b, 0x01,
+  0x22, 0x6d, 0xc0, 0x78, 0x00, 0xf0, 0x0f, 0x85, 0xb0, 0xd7, 0x20, 0xf8,
+  0x29, 0xd7, 0x60, 0x08, 0xff, 0x40, 0x0f, 0xd1, 0x7e, 0x3d, 0x00, 0x68,
+  0xc6, 0xf8, 0x34, 0x02, 0x02, 0x1f, 0x01, 0xaf, 0x88, 0xc0, 0xf3, 0x03,
+  0x2f, 0xd0, 0x10, 0x1f, 0x06, 0x01, 0xf1, 0xd0, 0x2f, 0x10, 0x2b, 0xc0,
+  0x19, 0x03, 0xf8, 0x62, 0x03, 0x22, 0xff, 0x00, 0xf0, 0x03, 0xf8, 0xf4,
+  0xe7, 0x40, 0x1c, 0xfb, 0xf8, 0x62, 0x5f, 0x03, 0x26, 0xbc, 0x51, 0x46,
+  0x70, 0xba, 0x5b, 0x20, 0x76, 0xe7, 0x30, 0x7e, 0x50, 0x29, 0x1b, 0xb1,
+  0xb8, 0xf8, 0x6d, 0x40, 0xe3, 0x40, 0xab, 0x00, 0x05, 0x05, 0xf5, 0xd0,
+  0x76, 0xff, 0x84, 0xb0, 0x01, 0x20, 0xb0, 0x62, 0x0f, 0x46, 0xff, 0xe0,
+  0x68, 0x02, 0x21, 0x01, 0x62, 0x02, 0x22, 0xdd, 0x05, 0x97, 0x90, 0x20,
+  0x46, 0x29, 0x3b, 0x00, 0x76, 0xf9, 0xff, 0x38, 0x68, 0x08, 0xb9, 0x30,
+  0x68, 0x38, 0xb9, 0xee, 0x11, 0x31, 0x10, 0x02, 0x00, 0x1d, 0x60, 0x02,
+  0x20, 0x03, 0xb7, 0x20, 0x3e, 0xe0, 0x0f, 0x03, 0x30, 0xb1, 0x4f, 0x50,
+  0xf8, 0x7f, 0x28, 0x03, 0x40, 0x28, 0xb6, 0x41, 0xf6, 0x69, 0x71, 0x7d,
+  0x26, 0x3b, 0x60, 0x90, 0x02, 0xab, 0x01, 0xaa, 0x9d, 0x63, 0x7f, 0x2e,
+  0xf8, 0xa7, 0x68, 0x02, 0x98, 0x39, 0x7d, 0x00, 0xfb, 0x27, 0xf8, 0x81,
+  0xb1, 0xcc, 0x05, 0x1e, 0xb1, 0x01, 0xff, 0x98, 0x28, 0x60, 0x6c, 0x60,
+  0x1c, 0xe0, 0xdf, 0xdf, 0xf8, 0xdc, 0x9d, 0x28, 0x68, 0xbb, 0x50, 0x8d,
+  0x01, 0xff, 0xf0, 0x02, 0xf8, 0x82, 0x46, 0x01, 0x98, 0x01, 0xfc, 0xb9,
+  0x00, 0x89, 0x31, 0x85, 0xf8, 0x28, 0x60, 0x49, 0x46, 0xed, 0x68, 0x35,
+  0x00, 0x1c, 0xf9, 0xc5, 0xb1, 0x00, 0xf0, 0xf7, 0xff, 0xff, 0x00, 0xf0,
+  0xbc, 0xfb, 0x68, 0x60, 0x38, 0xbe, 0x0b, 0x00, 0xe4, 0xf8, 0x30, 0x46,
+  0x04, 0x45, 0xc1, 0x87, 0xbf, 0x2d, 0xe9, 0xf1, 0x4f, 0x84, 0xb0, 0xd5,
+  0x01, 0x03, 0xff, 0x90, 0x88, 0x46, 0x0e, 0x9f, 0x00, 0x20, 0x02, 0xff,
+  0x90, 0x00, 0x2f, 0x08, 0xf5, 0x13, 0x75, 0x14, 0xff, 0xbf, 0x6c, 0x46,
+  0x03, 0xac, 0x68, 0x60, 0x91, 0xff, 0x46, 0x9a, 0x46, 0x28, 0x60, 0x01,
+  0x26, 0x04, 0xdf, 0x98, 0x80, 0x68, 0x01, 0x90, 0x67, 0x30, 0x00, 0x40,
+  0xff, 0x68, 0x00, 0x90, 0xd8, 0xf8, 0x90, 0x01, 0xf0, 0xff, 0x40, 0xc0,
+  0x07, 0x1a, 0xd5, 0x58, 0xf8, 0x26, 0xff, 0x10, 0x20, 0x68, 0x08, 0xeb,
+  0x86, 0x0b, 0xf6, 0xbf, 0xf7, 0xe6, 0xf8, 0xdb, 0xf8, 0xc8, 0x21, 0x40,
+  0xe2, 0xfb, 0xf8, 0x69, 0x79, 0x00, 0x43, 0xf8, 0x68, 0x60, 0x21, 0xab,
+  0x68, 0x08, 0x8d, 0x00, 0xda, 0x17, 0x04, 0xd6, 0x73, 0x10, 0xf6, 0xfb,
+  0xf7, 0x37, 0x9b, 0x00, 0x76, 0x1c, 0x18, 0x2e, 0xd5, 0xff, 0xdb, 0x68,
+  0x68, 0x29, 0x68, 0xf5, 0xf7, 0x3d, 0xf7, 0xff, 0xc9, 0xf8, 0xfb, 0x10,
+  0x2f, 0x14, 0xbf, 0xe9, 0x5f, 0x46, 0x0d, 0xf1, 0x08, 0x09, 0xfa, 0x30,
+  0x60, 0x71, 0x00, 0xff, 0x27, 0x01, 0x98, 0x00, 0xeb, 0x87, 0x00, 0x80,
+  0xf5, 0x6e, 0x6d, 0x03, 0xf8, 0x6d, 0x00, 0x1b, 0xd5, 0x08, 0xeb, 0xff,
+  0x87, 0x04, 0x04, 0xf1, 0x64, 0x06, 0xd9, 0xf8, 0xfe, 0x17, 0xc1, 0xc5,
+  0xf8, 0x01, 0x46, 0xd4, 0xf8, 0x2c, 0xff, 0x01, 0xf5, 0xf7, 0x99, 0xff,
+  0x71, 0x6e, 0xf6, 0xeb, 0xf7, 0xa6, 0x77, 0x02, 0x07, 0x77, 0x00, 0x70,
+  0x6e, 0x01, 0xfa, 0x77, 0x00, 0x9e, 0x6f, 0x00, 0xf5, 0xf7, 0xff, 0xff,
+  0x28, 0xbf, 0x60, 0x7f, 0x1c, 0x18, 0x2f, 0xd6, 0x6f, 0x04, 0x05, 0x2b,
+  0xff, 0xca, 0x6f, 0x00, 0x05, 0xff, 0x01, 0x8f, 0x03, 0x30, 0x33, 0x60,
+  0xff, 0x00, 0x26, 0x20, 0x69, 0x00, 0x90, 0x0d, 0x46, 0xff, 0xb3, 0x46,
+  0xb0, 0x46, 0xb1, 0x46, 0xb2, 0x46, 0x7e, 0x7b, 0x00, 0xe0, 0x03, 0x2f,
+  0x0b, 0xda, 0x04, 0x7f, 0x00, 0xff, 0x00, 0xf5, 0x34, 0x70, 0x01, 0x68,
+  0x40, 0x6e, 0xf7, 0xf5, 0xf7, 0xdb, 0x41, 0x10, 0x1e, 0xfb, 0x06, 0x46,
+  0xfe, 0x97, 0x50, 0xf0, 0x5b, 0xfe, 0x01, 0x46, 0x00, 0x98, 0xdf, 0xb8,
+  0x42, 0x04, 0xda, 0x40, 0x39, 0xd0, 0xce, 0xff, 0xdf, 0x80, 0x46, 0x03,
+  0xe0, 0x58, 0x09, 0x00, 0xc9, 0xff, 0xfd, 0x83, 0x5f, 0x10, 0x4c, 0xfe,
+  0xd5, 0xf8, 0x9c, 0x11, 0xff, 0xf9, 0x40, 0xc9, 0x07, 0x03, 0xd5, 0x00,
+  0xf0, 0xd7, 0x01, 0xfb, 0x81, 0x1d, 0x00, 0x51, 0x1d, 0x00, 0xba, 0xff,
+  0xfb, 0x82, 0x46, 0x89, 0x01, 0xd0, 0xdb, 0x58, 0x46, 0x41, 0xce, 0x0f,
+  0x00, 0xb2, 0xff, 0x02, 0x49, 0x50, 0x3f, 0x51, 0x37, 0xf8, 0xff, 0x10,
+  0x46, 0x31, 0x46, 0x05, 0xd2, 0xf6, 0xf7, 0xd7, 0x32, 0xf8, 0x2c, 0x3d,
+  0x80, 0x04, 0xf9, 0x50, 0xf6, 0xf7, 0xb7, 0x2c, 0xf8, 0x38, 0x2b, 0x20,
+  0x08, 0xd3, 0x59, 0x01, 0x9c, 0x7b, 0xff, 0x41, 0x27, 0x00, 0x23, 0xf8,
+  0x34, 0xbf, 0xbd, 0x20, 0xf8, 0x13, 0x32, 0x4d, 0x30, 0xbf, 0x00, 0xf0,
+  0x41, 0x80, 0x46, 0x00, 0xff, 0x27, 0x08, 0xf5, 0x01, 0x75, 0x08, 0xf1,
+  0xcc, 0xf5, 0x06, 0x1f, 0x11, 0x30, 0x0d, 0xb0, 0xf6, 0xf7, 0x20, 0xf8,
+  0xef, 0x60, 0x60, 0x28, 0x68, 0x35, 0x11, 0x05, 0xd5, 0xd4, 0xfb, 0xf8,
+  0xd4, 0x2d, 0x10, 0x2e, 0xf8, 0xc4, 0xf8, 0xd4, 0xed, 0x00, 0x7f, 0x01,
+  0xeb, 0xdb, 0xf1, 0x11, 0x30, 0x60, 0x00, 0xeb, 0x27, 0xd8, 0x47, 0x10,
+  0x70, 0x13, 0x10, 0x6d, 0xff, 0xc8, 0xb8, 0x13, 0x10, 0x3d, 0x00, 0xef,
+  0x00, 0x9c, 0x74, 0x68, 0x37, 0x02, 0x04, 0xfa, 0x43, 0x50, 0x71, 0x1b,
+  0x00, 0xeb, 0xfe, 0x20, 0x60, 0xa8, 0xf6, 0x11, 0x04, 0x60, 0x6e, 0x11,
+  0x01, 0xe2, 0xfe, 0x60, 0x66, 0xbe, 0x47, 0x01, 0xe6, 0xdb, 0x00, 0x20,
+  0x70, 0x87, 0x00, 0xf0, 0xef, 0x81, 0xf1, 0x68, 0x30, 0x17, 0x00, 0xe6,
+  0xbf, 0x2d, 0xdb, 0xe9, 0xf6, 0x4f, 0x10, 0x85, 0xb0, 0xd3, 0x23, 0xf5,
+  0xf7, 0x7f, 0x3f, 0xfe, 0x05, 0x46, 0x4f, 0xf0, 0x8a, 0xad, 0xe0, 0xd5,
+  0xd1, 0x19, 0x10, 0x82, 0x0b, 0x00, 0x8e, 0x0b, 0x00, 0xcb, 0xff, 0xf7,
+  0x05, 0x46, 0x06, 0x0b, 0x00, 0x00, 0x08, 0x00, 0xf0, 0xff, 0x6e, 0xfa,
+  0x04, 0xeb, 0x88, 0x07, 0xd2, 0xe9, 0xfd, 0x00, 0xc5, 0x10, 0xfa, 0xfd,
+  0x59, 0x46, 0x07, 0xf5, 0xbf, 0x34, 0x79, 0xf5, 0xf7, 0x33, 0xfe, 0x13,
+  0x21, 0x07, 0xff, 0xf5, 0x66, 0x77, 0x00, 0xf0, 0x5d, 0xfa, 0xd2, 0x5b,
+  0xe9, 0x32, 0x1d, 0x00, 0xeb, 0xfd, 0x43, 0x11, 0x26, 0x19, 0x00, 0xd5,
+  0x64, 0xdf, 0x30, 0x52, 0x15, 0x00, 0x64, 0x15, 0x00, 0xd2, 0xfd, 0xfd,
+  0x29, 0x15, 0x00, 0x1b, 0xfe, 0x38, 0x60, 0x00, 0xf0, 0xff, 0x48, 0xfa,
+  0x08, 0xf1, 0x01, 0x08, 0xd2, 0xe9, 0xdd, 0x96, 0x17, 0x00, 0xc6, 0xfd,
+  0x31, 0x17, 0x00, 0x0f, 0xfe, 0xfd, 0xb8, 0xcf, 0x60, 0x78, 0x66, 0xca,
+  0xd3, 0x62, 0x68, 0x5f, 0x01, 0x25, 0xd2, 0xe9, 0xc8, 0x19, 0x00, 0xc7,
+  0xd7, 0xd0, 0xbf, 0x3a, 0x51, 0xf5, 0xf7, 0x8f, 0xff, 0x9b, 0xc0, 0x04,
+  0xff, 0xd4, 0xf8, 0xd0, 0x02, 0x01, 0x90, 0x04, 0xeb, 0xfd, 0x85, 0x73,
+  0x40, 0x34, 0x71, 0x00, 0xf0, 0x72, 0xfd, 0xbf, 0x07, 0x46, 0xd6, 0xf8,
+  0x98, 0x03, 0x89, 0xd0, 0x41, 0xdd, 0xf5, 0xd1, 0xe0, 0x00, 0xf0, 0x9b,
+  0x11, 0x00, 0x01, 0x98, 0xfd, 0x39, 0x4d, 0x00, 0x64, 0xff, 0x38, 0xbf,
+  0x01, 0x97, 0xff, 0x6d, 0x1c, 0x15, 0x2d, 0xe6, 0xd3, 0x01, 0x26, 0xed,
+  0x05, 0xcb, 0x70, 0xc8, 0x75, 0xc9, 0xc3, 0xa8, 0x60, 0xe8, 0xff, 0x60,
+  0x28, 0x61, 0xa8, 0x61, 0x68, 0x61, 0xe8, 0xff, 0x61, 0xe8, 0x62, 0x28,
+  0x63, 0x28, 0x62, 0x68, 0xf7, 0x62, 0xa8, 0x62, 0x01, 0x60, 0x14, 0xdf,
+  0xf8, 0x40, 0xbf, 0x0a, 0xf5, 0xf7, 0x59, 0xff, 0x03, 0x63, 0x00, 0x86,
+  0xf6, 0x4d, 0x21, 0x71, 0x00, 0xd5, 0x00, 0xd1, 0xf8, 0x00, 0xa0, 0xaf,
+  0x49, 0x6e, 0x00, 0x91, 0x65, 0x01, 0x38, 0x39, 0x10, 0x49, 0xf7, 0xff,
+  0x81, 0x46, 0x4f, 0x00, 0xeb, 0x86, 0x08, 0x78, 0x2b, 0x6e, 0xc8, 0xd1,
+  0x20, 0x51, 0x5d, 0x20, 0xf5, 0xfb, 0xb0, 0x4d, 0x21, 0xfb, 0xe1, 0xf9,
+  0x93, 0x30, 0x21, 0xf5, 0xf7, 0x17, 0xff, 0xdf, 0x07, 0x46, 0x36, 0xd0,
+  0x58, 0x2f, 0x20, 0xf5, 0xf7, 0xfb, 0x21, 0xfe, 0x8f, 0x01, 0xa0, 0xfd,
+  0x00, 0x21, 0xf6, 0x7f, 0xf7, 0x33, 0xf8, 0x81, 0x46, 0x04, 0xd9, 0x0b,
+  0x40, 0xaf, 0x09, 0x00, 0xf0, 0xff, 0xb3, 0xf0, 0x48, 0x19, 0x00, 0xc7,
+  0xff, 0xfe, 0x05, 0x99, 0x41, 0xf8, 0x26, 0x00, 0x50, 0xff, 0x46, 0x00,
+  0x99, 0xf5, 0xf7, 0x0a, 0xfe, 0x81, 0xae, 0x6d, 0x10, 0x7c, 0x50, 0x49,
+  0xf1, 0xf0, 0x64, 0x8d, 0x00, 0x12, 0xfa, 0x01, 0x32, 0x39, 0x13, 0x00,
+  0x3f, 0x40, 0xf5, 0xf7, 0x0b, 0xec, 0x0d, 0x00, 0x51, 0x10, 0x21, 0xda,
+  0x13, 0x00, 0xf6, 0xf7, 0x0c, 0x7f, 0xf8, 0x24, 0xbf, 0xdf, 0xf8, 0x90,
+  0x19, 0x37, 0x30, 0x7c, 0xc3, 0x50, 0x27, 0x20, 0x59, 0xd6, 0xe7, 0x29,
+  0x6b, 0xdb, 0x10, 0xff, 0xfe, 0x38, 0xbf, 0x08, 0x46, 0x28, 0x63, 0xda,
+  0xff, 0xf8, 0x64, 0x10, 0xe8, 0x6a, 0xf5, 0xf7, 0xde, 0xfe, 0x0f, 0x00,
+  0x01, 0x46, 0xe9, 0x62, 0x38, 0x46, 0x01, 0xf6, 0xe9, 0x60, 0x00, 0xa0,
+  0xe3, 0x00, 0xfd, 0x0a, 0xf1, 0x08, 0xe7, 0x0b, 0x01, 0x46, 0x5d, 0x81,
+  0x13, 0x30, 0xfe, 0x08, 0xd2, 0xdd, 0xdb, 0x65, 0x02, 0xf5, 0xf7, 0xc8,
+  0x2b, 0x00, 0x4f, 0xf0, 0xaf, 0x01, 0x0b, 0x01, 0xd3, 0xf3, 0x10, 0x0b,
+  0xf7, 0x43, 0x10, 0xf7, 0xb9, 0x06, 0x98, 0x43, 0xb1, 0xda, 0xf8, 0x8c,
+  0x00, 0xff, 0x78, 0xb1, 0x0a, 0xeb, 0x86, 0x01, 0x03, 0x98, 0xfd, 0x89,
+  0x57, 0x00, 0xc4, 0xfe, 0x00, 0x90, 0x39, 0x46, 0xff, 0xdf, 0xf8, 0x10,
+  0x09, 0xf5, 0xf7, 0xbe, 0xfe, 0xfe, 0xbd, 0x01, 0xa9, 0xfe, 0x29, 0xd3,
+  0xbb, 0xf1, 0x00, 0xfe, 0xbd, 0xf0, 0x06, 0x98, 0x01, 0x28, 0x25, 0xd0,
+  0x05, 0xbf, 0x98, 0xdf, 0xf8, 0xf0, 0x18, 0x50, 0xdd, 0x00, 0xf5, 0xcb,
+  0xf7, 0x11, 0x21, 0x10, 0xd8, 0x2f, 0x10, 0x65, 0x01, 0x19, 0xfd, 0xf7,
+  0x80, 0x46, 0x58, 0x2f, 0x10, 0xb1, 0xfc, 0x07, 0x46, 0x7d, 0x40, 0x07,
+  0x00, 0x7e, 0xfd, 0x00, 0xf0, 0xbd, 0x51, 0xf0, 0xfd, 0x7a, 0xeb, 0x10,
+  0x99, 0xfe, 0x0a, 0xf1, 0x8c, 0x01, 0xdf, 0x49, 0x69, 0xf5, 0xf7, 0x82,
+  0x8b, 0x0a, 0x28, 0x69, 0xff, 0x58, 0x44, 0x28, 0x61, 0x0b, 0xfa, 0x06,
+  0xf1, 0xff, 0x28, 0x68, 0x08, 0x43, 0x28, 0x60, 0x48, 0x46, 0xdd, 0x02,
+  0x71, 0x00, 0xf4, 0xfc, 0x01, 0xad, 0x80, 0x07, 0x69, 0xdd, 0x38, 0x55,
+  0x00, 0x6a, 0xfe, 0x05, 0xbf, 0x80, 0x5f, 0xea, 0x7f, 0x0b, 0x01, 0x0e,
+  0xd0, 0x01, 0x21, 0x0c, 0x73, 0x50, 0x9f, 0x74, 0x08, 0xf5, 0xf7, 0x71,
+  0xff, 0x30, 0x1d, 0x01, 0x5b, 0xdb, 0xfe, 0x34, 0x4d, 0x00, 0xff, 0x30,
+  0x77, 0x90, 0x21, 0xaa, 0xff, 0x69, 0x8a, 0x18, 0xaa, 0x61, 0xb1, 0x40,
+  0x6a, 0xfc, 0x7d, 0xf0, 0xaf, 0x01, 0x69, 0x60, 0x04, 0xd0, 0x10, 0xf1,
+  0xff, 0x01, 0x0f, 0x08, 0xbf, 0x01, 0x21, 0x00, 0xd0, 0xd4, 0x30, 0xe0,
+  0x1f, 0x00, 0x6a, 0x1f, 0x00, 0xaa, 0x1f, 0x00, 0xa9, 0x60, 0xfe, 0x2b,
+  0x81, 0xe9, 0x69, 0xc0, 0x0f, 0x41, 0x18, 0xe9, 0xff, 0x61, 0xb0, 0x40,
+  0xe9, 0x68, 0x76, 0x1c, 0x08, 0xff, 0x43, 0x15, 0x2e, 0xe8, 0x60, 0xff,
+  0xf4, 0xeb, 0xdd, 0xae, 0x9d, 0x31, 0x05, 0x99, 0x08, 0x73, 0xa0, 0x05,
+  0x98, 0xdf, 0xc8, 0x30, 0x41, 0x66, 0x01, 0x99, 0xf0, 0x05, 0x99, 0x3f,
+  0x48, 0x66, 0x15, 0x26, 0x05, 0x99, 0x1b, 0x01, 0xd9, 0x11, 0xfc, 0x1b,
+  0x01, 0x8d, 0x51, 0x76, 0x1c, 0xc0, 0xf8, 0x2c, 0x11, 0x6f, 0x64, 0x30,
+  0x19, 0x2e, 0x27, 0x01, 0xee, 0xd3, 0x23, 0x12, 0xbf, 0xd1, 0xe9, 0x6a,
+  0x4f, 0xf0, 0x40, 0xdb, 0x10, 0x1d, 0x87, 0xfe, 0x80, 0x46, 0xbb, 0x50,
+  0x1d, 0x90, 0x57, 0x30, 0xdd, 0x20, 0x03, 0xef, 0xfc, 0x81, 0x46, 0xd7,
+  0xdd, 0x26, 0x0e, 0xfe, 0x00, 0xf7, 0xf0, 0xb2, 0xf8, 0x89, 0x41, 0x7b,
+  0xfc, 0xdf, 0xf8, 0xff, 0xa4, 0x17, 0xf5, 0xf7, 0xf3, 0xfd, 0x04, 0xd2,
+  0x7f, 0x28, 0x68, 0x01, 0x21, 0xb1, 0x40, 0x88, 0x0d, 0x10, 0xfe, 0xa5,
+  0x51, 0xe0, 0xd3, 0x27, 0x68, 0xe9, 0x6a, 0x38, 0xfe, 0x99, 0x10, 0xf7,
+  0xfd, 0x06, 0x46, 0x29, 0x6b, 0x78, 0xe2, 0x09, 0x00, 0xf2, 0x69, 0x10,
+  0xa7, 0xe0, 0x9f, 0x52, 0x00, 0xf1, 0x64, 0x9d, 0x09, 0x67, 0x43, 0x07,
+  0xd5, 0xd9, 0x47, 0x20, 0x75, 0x31, 0xd0, 0xdd, 0xfd, 0x1b, 0x20, 0x20,
+  0x00, 0xd3, 0x67, 0x80, 0x6a, 0xb8, 0x65, 0x40, 0x57, 0x10, 0x62, 0x51,
+  0x43, 0x21, 0x01, 0x00, 0x10, 0x31, 0x51, 0xc5, 0xbf, 0x21, 0x06, 0x69,
+  0x21, 0x02, 0x2d, 0x30, 0x21, 0x02, 0x0b, 0xd5, 0x7f, 0xdf, 0xf8, 0x14,
+  0x07, 0x00, 0xf0, 0xa0, 0x81, 0x10, 0x54, 0x2b, 0x00, 0xe1, 0x10, 0xaa,
+  0x29, 0x06, 0xa9, 0x29, 0x00, 0x7f, 0x25, 0x10, 0x7f, 0x18, 0x2f, 0xa8,
+  0x62, 0xc0, 0xd3, 0x04, 0x97, 0x50, 0x6f, 0xd4, 0xf8, 0x9c, 0x63, 0xbf,
+  0x30, 0x12, 0x40, 0x41, 0x30, 0xfb, 0x0c, 0xfd, 0x11, 0x00, 0x71, 0x4f,
+  0xf0, 0x02, 0x08, 0xf9, 0x89, 0xab, 0x50, 0x3d, 0xc0, 0xf0, 0x48, 0xf8,
+  0x00, 0xf0, 0x67, 0x46, 0xf8, 0x06, 0x09, 0xf0, 0x61, 0x40, 0x01, 0x01,
+  0x57, 0x40, 0xef, 0xd1, 0xf8, 0x98, 0x73, 0x81, 0x01, 0xf5, 0xf7, 0xf5,
+  0xf9, 0xfc, 0xab, 0x00, 0x07, 0x00, 0xf1, 0xfc, 0x00, 0xf0, 0xab, 0xdf,
+  0xfb, 0x00, 0xf0, 0xa9, 0xfb, 0x39, 0x41, 0xb8, 0xf1, 0xdf, 0x18, 0x0f,
+  0xe8, 0xd3, 0xa7, 0x51, 0x70, 0x3c, 0x1d, 0x7f, 0xf5, 0xf7, 0x7f, 0xfd,
+  0x01, 0x46, 0x30, 0xab, 0x00, 0xf7, 0x69, 0xfd, 0x34, 0xcf, 0xd2, 0x87,
+  0xf8, 0x08, 0x03, 0xff, 0xe1, 0x68, 0x28, 0x68, 0x48, 0x60, 0xe1, 0x68,
+  0xdc, 0xc5, 0x90, 0x05, 0x00, 0xa8, 0x68, 0xc8, 0x05, 0x00, 0xe8, 0x68,
+  0xdb, 0x08, 0x61, 0x17, 0x00, 0x6a, 0x48, 0x05, 0x00, 0x68, 0x6a, 0x7d,
+  0x88, 0x05, 0x00, 0xa8, 0x6a, 0xc8, 0x61, 0x07, 0x5f, 0x62, 0xff, 0x60,
+  0x68, 0x00, 0xeb, 0xc8, 0x02, 0x70, 0x47, 0xf6, 0xb3, 0x31, 0xbb, 0xbc,
+  0x1b, 0x11, 0xb8, 0xbc, 0x2d, 0xe9, 0xdf, 0xf7, 0x4f, 0x86, 0xb0, 0x80,
+  0x1f, 0xb1, 0x02, 0x40, 0xbe, 0x01, 0x50, 0x01, 0x00, 0x03, 0x90, 0x07,
+  0x4b, 0x41, 0x74, 0x7e, 0x85, 0x60, 0x28, 0x00, 0xf0, 0xae, 0x81, 0x07,
+  0xe1, 0x20, 0xff, 0x0c, 0xb6, 0x00, 0xf5, 0xe8, 0x70, 0x04, 0x90, 0xed,
+  0x64, 0xe1, 0x30, 0xea, 0xfb, 0x1f, 0x01, 0x0d, 0x76, 0x14, 0x6b, 0x21,
+  0x30, 0x03, 0x60, 0xe3, 0x0d, 0x02, 0xe2, 0x70, 0xe9, 0xb1, 0xd7, 0x7e,
+  0x58, 0x08, 0xef, 0x10, 0x46, 0x1b, 0xc0, 0xdd, 0xfa, 0xfd, 0x0a, 0x5f,
+  0xe0, 0x25, 0xfd, 0x03, 0x2d, 0x30, 0x62, 0xff, 0x02, 0xd2, 0x00, 0xf0,
+  0xda, 0xfa, 0x30, 0x62, 0xff, 0x6d, 0x1c, 0x00, 0xf0, 0xe9, 0xfa, 0x18,
+  0x2d, 0xff, 0x47, 0xd2, 0x20, 0x68, 0x22, 0x6a, 0x65, 0x63, 0x7d, 0xe8,
+  0x7b, 0x50, 0x01, 0x09, 0x06, 0x98, 0x81, 0x23, 0xe0, 0xff, 0x04, 0x02,
+  0xc6, 0xf8, 0x14, 0x80, 0xe8, 0x40, 0xff, 0xea, 0x40, 0xc6, 0xf8, 0x18,
+  0x80, 0x01, 0x23, 0xfe, 0x87, 0x01, 0x02, 0xf0, 0x01, 0x02, 0xa3, 0x63,
+  0x4a, 0xff, 0xb9, 0x28, 0xb1, 0x00, 0xf0, 0x11, 0xfb, 0x06, 0xff, 0x99,
+  0x09, 0x68, 0x49, 0x69, 0xd4, 0xe7, 0xb9, 0xee, 0xcb, 0x20, 0x0a, 0xd0,
+  0x07, 0x65, 0xa0, 0x25, 0x00, 0xf0, 0xf9, 0x61, 0xa1, 0x50, 0xf7, 0x10,
+  0x85, 0x00, 0xd0, 0xf8, 0xc8, 0xbf, 0x00, 0xc6, 0xe7, 0x00, 0xf0, 0xfd,
+  0xeb, 0xb0, 0x06, 0xff, 0x98, 0x03, 0x9a, 0x00, 0x68, 0x00, 0x2a, 0x14,
+  0xff, 0xbf, 0x80, 0x69, 0xc0, 0x69, 0xbb, 0xe7, 0x02, 0x6b, 0x28, 0x72,
+  0x91, 0x00, 0x94, 0x91, 0x02, 0xdc, 0xfc, 0x91, 0x05, 0xfd, 0x91, 0x91,
+  0x00, 0x00, 0xf0, 0xa1, 0xfa, 0x6d, 0x1c, 0xff, 0x18, 0x2d, 0x80, 0xf0,
+  0xf4, 0x80, 0x60, 0x68, 0x7e, 0x91, 0x01, 0xc0, 0x07, 0x5d, 0xbf, 0xa0,
+  0x68, 0x99, 0x03, 0xfc, 0x97, 0x30, 0xc3, 0x40, 0x99, 0xfa, 0x29, 0xd4,
+  0xa1, 0x6a, 0x3d, 0xe9, 0x3d, 0x70, 0x25, 0xd4, 0x6f, 0xb1, 0x6b, 0x01,
+  0xa9, 0x01, 0xbe, 0xa5, 0x00, 0xb0, 0xd0, 0xf8, 0x38, 0x01, 0xe9, 0x01,
+  0x00, 0xfb, 0xf0, 0xb8, 0x03, 0x00, 0x7b, 0xfa, 0x01, 0x98, 0x60, 0x4e,
+  0xa9, 0x00, 0x52, 0xfa, 0x80, 0x65, 0x10, 0x91, 0x01, 0x9c, 0x1d, 0x00,
+  0xd5, 0xce, 0x19, 0x00, 0xa9, 0x03, 0x00, 0x6c, 0x1d, 0x00, 0x38, 0x43,
+  0xbf, 0xc0, 0xb2, 0x00, 0x28, 0xc6, 0xd1, 0xc1, 0x01, 0x12, 0x3f, 0xd0,
+  0x00, 0xf0, 0x43, 0xfa, 0x06, 0xc5, 0x80, 0x77, 0x50, 0x7c, 0x2d, 0x00,
+  0x33, 0x21, 0x8e, 0xfc, 0xb0, 0x61, 0xd9, 0x3d, 0x40, 0xff, 0xf0, 0x61,
+  0x01, 0x20, 0xa0, 0x63, 0xc6, 0xf8, 0xbf, 0x20, 0x80, 0xae, 0xe7, 0x70,
+  0x61, 0x69, 0x01, 0x00, 0xa3, 0xf0, 0x4f, 0x43, 0x02, 0x35, 0x50, 0x3d,
+  0x40, 0x7a, 0x25, 0x20, 0xa2, 0x76, 0xe7, 0x00, 0x31, 0x62, 0xe9, 0x0b,
+  0x8f, 0xe7, 0x60, 0xfb, 0xa0, 0xbe, 0x01, 0xb3, 0x05, 0xd0, 0x21, 0x6b,
+  0x08, 0x23, 0x61, 0xfc, 0xff, 0x02, 0x90, 0x01, 0xe0, 0xcd, 0xf8, 0x08,
+  0x80, 0xff, 0x00, 0xf0, 0x13, 0xfa, 0x0c, 0xe0, 0x02, 0x98, 0xaa, 0xb5,
+  0x61, 0x59, 0x05, 0x16, 0x0f, 0x05, 0x12, 0x1e, 0x05, 0x12, 0x71, 0xdd,
+  0xd2, 0x03, 0x1f, 0x06, 0x17, 0xfa, 0x2f, 0x03, 0x14, 0x2b, 0xd4, 0xbe,
+  0x87, 0x11, 0xd1, 0xf8, 0x14, 0xa0, 0x77, 0x0b, 0x11, 0x01, 0x7e, 0x0b,
+  0x14, 0x80, 0xd1, 0xf8, 0x38, 0x11, 0x00, 0xc3, 0x00, 0xf5, 0x90, 0xbd,
+  0x20, 0x2b, 0xab, 0x00, 0xf4, 0xf9, 0x01, 0x98, 0x7d, 0x68, 0x0d, 0x10,
+  0xcb, 0xf9, 0x81, 0x68, 0x01, 0xdf, 0x00, 0x55, 0x09, 0x5f, 0x20, 0x9c,
+  0xed, 0x60, 0x80, 0x1f, 0x00, 0x1b, 0x1f, 0x00, 0xa9, 0xe4, 0x1f, 0x00,
+  0x0f, 0x13, 0xc1, 0x0f, 0x12, 0x19, 0x0f, 0x10, 0xbb, 0xaf, 0xf9, 0xb0,
+  0x61, 0x06, 0x3f, 0xe0, 0x08, 0x8b, 0x60, 0x0a, 0x26, 0x13, 0x14, 0x04,
+  0xfc, 0x07, 0x60, 0x19, 0x30, 0x00, 0x81, 0x32, 0x5b, 0x91, 0xdf, 0xeb,
+  0xfa, 0xf0, 0x61, 0xa5, 0x1d, 0x12, 0xa2, 0xe7, 0x3e, 0x7d, 0x05, 0x00,
+  0xf0, 0xbf, 0xf9, 0x08, 0x49, 0x10, 0xdf, 0x10, 0xa6, 0x23, 0x14, 0xe8,
+  0xfb, 0x25, 0x01, 0x1f, 0x10, 0x99, 0x1f, 0x10, 0x29, 0xff, 0x14, 0xbf,
+  0xd0, 0xf8, 0x18, 0xa0, 0xd0, 0xf8, 0xff, 0x1c, 0xa0, 0x7e, 0xe7, 0xe0,
+  0x6b, 0x01, 0x28, 0xff, 0x05, 0xd1, 0x30, 0x68, 0x21, 0x6c, 0xf5, 0xf7,
+  0xff, 0x47, 0xfa, 0x30, 0x60, 0x04, 0xe0, 0x02, 0x46, 0x77, 0x04, 0x98,
+  0x31, 0xa1, 0x50, 0x14, 0xfb, 0x08, 0x03, 0x60, 0x7f, 0x26, 0xd1, 0x34,
+  0x68, 0x20, 0x46, 0x21, 0x25, 0x10, 0xff, 0xa6, 0xfb, 0x2f, 0xd1, 0x06,
+  0x98, 0x85, 0x68, 0xfd, 0x95, 0x19, 0x30, 0xc0, 0x07, 0x12, 0xd5, 0x06,
+  0x98, 0xdf, 0x00, 0x68, 0x46, 0x68, 0x40, 0x19, 0x90, 0xf5, 0xf7, 0x3b,
+  0xa8, 0xfa, 0xbb, 0x91, 0xb5, 0xfb, 0x07, 0xcd, 0xa0, 0x0f, 0x01, 0xfd,
+  0xb0, 0xd7, 0x00, 0xce, 0xf9, 0x28, 0x60, 0x00, 0xe0, 0xa7, 0x2c, 0x60,
+  0xd5, 0x49, 0x31, 0xbf, 0x20, 0xc5, 0x07, 0x00, 0x46, 0xef, 0xe1, 0x00,
+  0x25, 0x00, 0x5f, 0xe0, 0xe0, 0x6b, 0x85, 0x77, 0x42, 0x0a, 0xd2, 0xab,
+  0x25, 0x34, 0x02, 0x01, 0x33, 0x00, 0xff, 0x76, 0xfb, 0xf2, 0xd0, 0x01,
+  0x20, 0x36, 0xe1, 0xe8, 0x33, 0x31, 0x85, 0xb1, 0x69, 0xb1, 0x31, 0xbd,
+  0x21, 0x69, 0x07, 0x98, 0xff, 0xe2, 0x6b, 0x00, 0xf5, 0x16, 0x70, 0x00,
+  0xf0, 0xfb, 0x84, 0xfa, 0x1d, 0x01, 0x10, 0xd1, 0x00, 0x25, 0x09, 0x7f,
+  0xe0, 0x07, 0x99, 0x01, 0xeb, 0x80, 0x00, 0x4d, 0x10, 0xff, 0x01, 0xd0,
+  0xf8, 0x5c, 0x02, 0xc1, 0xf8, 0x58, 0xff, 0x02, 0x6d, 0x1c, 0x06, 0x98,
+  0x07, 0x68, 0x78, 0x7f, 0x88, 0xa8, 0x42, 0xf0, 0xd2, 0x00, 0x25, 0x5d,
+  0x02, 0xf5, 0x0b, 0x2f, 0x01, 0x1f, 0xb7, 0x00, 0x81, 0x68, 0xdb, 0xf8,
+  0x73, 0x58, 0x62, 0x59, 0x31, 0x31, 0x00, 0x08, 0x98, 0xb1, 0x29, 0x01,
+  0x9d, 0x7f, 0xb7, 0xc0, 0x57, 0xfb, 0x01, 0xa3, 0x60, 0x13, 0x71, 0x56,
+  0xd3, 0xfb, 0x83, 0x51, 0x40, 0xab, 0x61, 0x51, 0xbd, 0x00, 0x36, 0xf9,
+  0xed, 0xc8, 0x15, 0x00, 0x2a, 0xe0, 0x05, 0x00, 0x60, 0x27, 0xe0, 0xfd,
+  0x03, 0xb5, 0x50, 0x06, 0x98, 0x82, 0x68, 0x02, 0xf5, 0xaf, 0x01, 0x76,
+  0x70, 0x68, 0x55, 0x21, 0xb0, 0x05, 0x00, 0x16, 0x75, 0xd0, 0x45, 0x03,
+  0x02, 0x51, 0x00, 0x00, 0xf0, 0x32, 0x49, 0x02, 0xa5, 0x68, 0x49, 0x00,
+  0x31, 0x87, 0xa0, 0x6d, 0x00, 0x02, 0x4b, 0x01, 0x2b, 0x6b, 0xfb, 0xff,
+  0x05, 0x90, 0xc8, 0x17, 0x00, 0x04, 0xe0, 0x13, 0x01, 0xae, 0x2b, 0x00,
+  0x01, 0x88, 0x66, 0x61, 0xf1, 0xae, 0xc7, 0xf0, 0x01, 0x8f, 0x20, 0xa8,
+  0x40, 0x00, 0x5f, 0x41, 0x41, 0x00, 0xa9, 0x01, 0x38, 0x76, 0x65, 0x02,
+  0x21, 0x6a, 0x67, 0x01, 0xe9, 0x40, 0x30, 0x75, 0x20, 0xfd, 0xc9, 0x6f,
+  0x50, 0x01, 0x00, 0x18, 0xd5, 0xd8, 0xf8, 0xfb, 0x58, 0x82, 0x3b, 0x01,
+  0x01, 0xf1, 0xd4, 0x0b, 0x50, 0xbe, 0x49, 0x20, 0x22, 0xf9, 0x00, 0xf0,
+  0xf9, 0x43, 0x50, 0xd8, 0xbf, 0xf9, 0xff, 0xf7, 0x9f, 0xfd, 0xcb, 0x8d,
+  0x50, 0x01, 0xfd, 0xe0, 0x05, 0x00, 0x80, 0x30, 0x68, 0x00, 0x99, 0x08,
+  0xff, 0x43, 0x30, 0x60, 0x8d, 0xe0, 0x00, 0x28, 0xfc, 0xf9, 0xd1, 0x31,
+  0x00, 0x03, 0x60, 0xd4, 0x0b, 0x00, 0xf0, 0x0a, 0xf2, 0x2f, 0x00, 0xe1,
+  0x6f, 0x50, 0x47, 0x00, 0x02, 0x00, 0xf0, 0xe8, 0xef, 0xfc, 0xff, 0xf7,
+  0x87, 0x35, 0x02, 0x79, 0xe0, 0x08, 0x4f, 0x98, 0x03, 0x28, 0x76, 0x77,
+  0x00, 0x69, 0x21, 0x0a, 0xdf, 0x02, 0xf6, 0xeb, 0x22, 0x07, 0xb0, 0x07,
+  0x03, 0x00, 0x01, 0x90, 0x60, 0xf5, 0x6a, 0x05, 0x31, 0x19, 0x2d, 0xb0,
+  0xde, 0xf8, 0x80, 0x46, 0x54, 0x8b, 0x21, 0x53, 0x01, 0x57, 0x85, 0x00,
+  0xdf, 0x81, 0x00, 0xb1, 0x03, 0x00, 0xd5, 0x95, 0x85, 0x00, 0x5c, 0x4f,
+  0x00, 0x64, 0x85, 0x02, 0x64, 0x80, 0x7c, 0x23, 0x10, 0x85, 0x00, 0x70,
+  0x60, 0x4a, 0xe0, 0xa0, 0x3b, 0x02, 0xb5, 0x1b, 0x3b, 0x00, 0xb0, 0x5f,
+  0x10, 0x01, 0x98, 0x3d, 0x00, 0x09, 0xaa, 0x09, 0x31, 0xc2, 0x35, 0x00,
+  0x8f, 0x4d, 0x00, 0x78, 0x83, 0x10, 0xa7, 0x6e, 0xe5, 0x62, 0xfa, 0xf9,
+  0xc9, 0x13, 0x30, 0x01, 0xe0, 0x05, 0x00, 0x79, 0xb1, 0x5d, 0x10, 0x3f,
+  0x00, 0xb0, 0x60, 0x2a, 0xe0, 0x17, 0x31, 0x3d, 0x27, 0x9d, 0x00, 0x07,
+  0x68, 0x79, 0x68, 0x5d, 0x71, 0x3f, 0x01, 0x5f, 0xf5, 0xf7, 0x70, 0xf9,
+  0x09, 0xd5, 0x02, 0x73, 0x41, 0x61, 0x2b, 0xf0, 0x93, 0x4b, 0x00, 0x7f,
+  0xd1, 0x00, 0x1e, 0x81, 0x02, 0x25, 0x01, 0xeb, 0x7e, 0x68, 0x85, 0x21,
+  0x5d, 0xf3, 0x00, 0x5d, 0xf8, 0x07, 0xd6, 0x21, 0x00, 0x72, 0xfb, 0x0f,
+  0x01, 0x65, 0x69, 0x30, 0x83, 0xf8, 0xfc, 0x65, 0x01, 0x7f, 0x11, 0xff,
+  0xf4, 0x40, 0xaf, 0x00, 0x20, 0xe9, 0x09, 0x09, 0x62, 0x39, 0x30, 0xb0,
+  0x59, 0x41, 0x06, 0x98, 0x70, 0xfd, 0x47, 0x8d, 0x12, 0x09, 0x09, 0xf1,
+  0x64, 0x01, 0x08, 0xdf, 0x68, 0x70, 0x61, 0x70, 0x47, 0xe7, 0x21, 0x40,
+  0x88, 0xff, 0x45, 0x1c, 0x70, 0x47, 0x30, 0x6a, 0xdf, 0xf8, 0xff, 0x88,
+  0x18, 0xf5, 0xf7, 0xb3, 0xb8, 0x00, 0x00, 0xff, 0x77, 0xbe, 0x7f, 0x3f,
+  0x6f, 0x12, 0x83, 0x3a, 0xef, 0x80, 0x61, 0x0c, 0x4a, 0xb7, 0xf1, 0xac,
+  0xc5, 0x27, 0xdf, 0x37, 0x52, 0x49, 0x9d, 0x39, 0x3f, 0x40, 0x98, 0x61,
+  0x91, 0xe0, 0xc9, 0x41, 0xdb, 0x21, 0xaf, 0xb0, 0x71, 0x41, 0x01, 0x0d,
+  0x00, 0xf5, 0xff, 0x02, 0x71, 0x0a, 0x68, 0x49, 0x68, 0xe9, 0x40, 0xff,
+  0x01, 0xf0, 0x01, 0x01, 0x01, 0x91, 0xea, 0x40, 0x79, 0x61, 0x41, 0x42,
+  0xd5, 0x50, 0x07, 0x70, 0x47, 0x59, 0x9d, 0x00, 0x6b, 0x7a, 0xb9, 0xd1,
+  0xc4, 0x71, 0xbb, 0x33, 0x72, 0xb9, 0xe3, 0x31, 0x56, 0x25, 0x41, 0x09,
+  0xba, 0xb7, 0x91, 0x64, 0x59, 0x20, 0x04, 0x09, 0x02, 0x76, 0x79, 0x71,
+  0xff, 0xb9, 0xd1, 0x31, 0x51, 0x46, 0x02, 0x89, 0xa0, 0x61, 0xf9, 0x29,
+  0x00, 0xfd, 0x41, 0xa7, 0x00, 0x43, 0x90, 0xf2, 0xb9, 0x4d, 0x01, 0xbb,
+  0xef, 0xb9, 0x67, 0x41, 0x59, 0x46, 0xd0, 0x55, 0xc0, 0xf0, 0x9b, 0x61,
+  0xe0, 0x17, 0x80, 0xe6, 0xb9, 0xfb, 0x11, 0x3f, 0x43, 0xd0, 0x45, 0xb8,
+  0x9b, 0x21, 0x41, 0xe5, 0x90, 0x57, 0x15, 0x93, 0xb0, 0xb8, 0x69, 0x53,
+  0xdb, 0x20, 0x6b, 0x8d, 0x31, 0xcf, 0xb9, 0x7d, 0xd1, 0x05, 0x46, 0xff,
+  0x05, 0xf1, 0x84, 0x06, 0xf1, 0x68, 0xff, 0xf7, 0x77, 0x4e, 0xf8, 0xb1,
+  0xe1, 0x30, 0xc4, 0xf9, 0x04, 0xb7, 0xe0, 0xf7, 0xf5, 0xf7, 0x22, 0x71,
+  0x10, 0x01, 0xf9, 0x29, 0x6f, 0x3f, 0xf5, 0xf7, 0x1f, 0xf9, 0x28, 0x67,
+  0xb1, 0x91, 0xbd, 0xd1, 0xdf, 0x48, 0x43, 0xf5, 0xf7, 0x15, 0xd3, 0x10,
+  0xff, 0xf7, 0xfb, 0xc6, 0xf9, 0x2d, 0x01, 0xad, 0xf9, 0x07, 0x46, 0x10,
+  0xfb, 0xe0, 0x40, 0x53, 0x30, 0x05, 0xeb, 0x8b, 0x04, 0xf5, 0xef, 0xf7,
+  0xa5, 0xf9, 0x21, 0x31, 0x00, 0x06, 0xf9, 0x20, 0xaf, 0x67, 0x0b, 0xf1,
+  0x01, 0xbd, 0x10, 0x7f, 0x45, 0x00, 0x7a, 0xfe, 0x2f, 0x00, 0xa8, 0x68,
+  0x83, 0x45, 0xeb, 0xd3, 0x68, 0xbf, 0x68, 0x40, 0x43, 0xf4, 0xf7, 0xf5,
+  0x89, 0xc0, 0x74, 0xbc, 0x13, 0x20, 0x83, 0xb0, 0xf0, 0xd0, 0xf8, 0xff,
+  0x3b, 0xe0, 0xe9, 0xfe, 0x49, 0x00, 0xec, 0xf8, 0xe8, 0x60, 0x01, 0x24,
+  0x00, 0xeb, 0xf0, 0x66, 0x11, 0x00, 0x90, 0x8d, 0xb0, 0xff, 0xf7, 0x95,
+  0x7d, 0xf9, 0xeb, 0xc1, 0x7c, 0xf9, 0x00, 0x90, 0xd5, 0xb7, 0x20, 0xef,
+  0x19, 0xe0, 0x00, 0x98, 0x15, 0x60, 0xf8, 0x05, 0xeb, 0xbf, 0x84, 0x07,
+  0x80, 0x46, 0xf8, 0x68, 0x4f, 0x21, 0xd2, 0xff, 0xf8, 0xf8, 0x60, 0x05,
+  0xeb, 0x8a, 0x07, 0x41, 0xee, 0x0f, 0x00, 0xf5, 0xf7, 0xcb, 0x0d, 0x00,
+  0x64, 0x1c, 0xa8, 0x27, 0x68, 0x82, 0x44, 0x69, 0x60, 0x5b, 0x00, 0x39,
+  0x97, 0xb0, 0x39, 0x00, 0xbf, 0x80, 0x44, 0x45, 0xe1, 0xd3, 0x34, 0x6f,
+  0x00, 0x99, 0x2a, 0x13, 0x00, 0x98, 0x4d, 0x22, 0x34, 0x63, 0x00, 0x5e,
+  0x85, 0x00, 0xd5, 0x00, 0xcf, 0x0a, 0x16, 0xe0, 0x48, 0xf9, 0xd1, 0x03,
+  0xd0, 0xf5, 0xf7, 0x97, 0x46, 0xf9, 0xf9, 0x47, 0x00, 0xa7, 0x47, 0x00,
+  0x8d, 0x81, 0x00, 0xcb, 0xf0, 0x20, 0x31, 0x00, 0x16, 0x45, 0x00, 0x55,
+  0x01, 0x84, 0x42, 0xbf, 0xea, 0xd3, 0x0a, 0xf1, 0x01, 0x0a, 0x5f, 0x00,
+  0x45, 0x55, 0x09, 0x47, 0x60, 0x12, 0x43, 0x00, 0x3c, 0x43, 0x00, 0xd9,
+  0xd3, 0xb0, 0xff, 0x01, 0x08, 0x01, 0x24, 0xed, 0xe7, 0xbd, 0xe8, 0x3b,
+  0xf1, 0x8f, 0x67, 0x81, 0x23, 0xb9, 0x81, 0xf3, 0x20, 0x9f, 0x01, 0x7f,
+  0x1e, 0xb9, 0x28, 0x68, 0xf4, 0xf7, 0x7d, 0x95, 0xd0, 0xff, 0xf8, 0x43,
+  0x80, 0x46, 0x0d, 0x46, 0x16, 0x46, 0xff, 0x99, 0x46, 0x00, 0x24, 0x00,
+  0x27, 0x0c, 0xe0, 0xff, 0x30, 0x46, 0xf4, 0xf7, 0x71, 0xff, 0x58, 0xf8,
+  0xed, 0x27, 0xa9, 0x10, 0x0b, 0xf9, 0x7b, 0x51, 0x6c, 0xf8, 0x04, 0xff,
+  0x46, 0x6e, 0x43, 0x7f, 0x1c, 0x4f, 0x45, 0xf0, 0xd7, 0xd3, 0x20, 0x46,
+  0x5b, 0xe0, 0x83, 0x35, 0x01, 0x08, 0x9c, 0xdf, 0x80, 0x46, 0x0e, 0x46,
+  0x17, 0x37, 0x01, 0x25, 0xa0, 0xff, 0x07, 0x4c, 0xbf, 0x01, 0x22, 0x2a,
+  0x46, 0x3b, 0xfb, 0x46, 0x29, 0xc5, 0x40, 0xff, 0xf7, 0xd4, 0xff, 0x48,
+  0xdc, 0x11, 0x80, 0xe7, 0x21, 0xf1, 0xd3, 0xe0, 0x1b, 0x00, 0x00, 0x26,
+  0xff, 0x58, 0xf8, 0x29, 0x60, 0x4f, 0x46, 0x20, 0xe0, 0xff, 0xc7, 0xf1,
+  0x18, 0x00, 0xf4, 0xf7, 0x41, 0xff, 0x37, 0x04, 0x46, 0xc9, 0x09, 0x02,
+  0x3c, 0xff, 0x4f, 0xb0, 0x71, 0x00, 0xb1, 0x48, 0x11, 0x00, 0x73, 0x00,
+  0xbd, 0xd0, 0x14, 0xf8, 0x17, 0xe1, 0x7e, 0xdb, 0x50, 0x21, 0x15, 0x00,
+  0xbb, 0xff, 0x39, 0x31, 0xc8, 0xf8, 0xee, 0xc7, 0xd1, 0x29, 0xf8, 0x48,
+  0x1f, 0x00, 0x7f, 0x1c, 0x19, 0x77, 0x2f, 0xdc, 0xd3, 0xcf, 0x00, 0x83,
+  0xf0, 0x68, 0x9b, 0x01, 0xff, 0xba, 0xb8, 0x2d, 0xe9, 0xf2, 0x4f, 0x8a,
+  0xb0, 0xf7, 0x80, 0x46, 0x91, 0xab, 0xf0, 0x00, 0xe0, 0x76, 0x1c, 0xf7,
+  0x4e, 0x45, 0x47, 0x7f, 0x50, 0x12, 0xe0, 0x04, 0xeb, 0x75, 0x0a, 0x4d,
+  0x00, 0x9a, 0x0b, 0x10, 0xc8, 0xfe, 0x07, 0x27, 0x10, 0xff, 0xac, 0x42,
+  0xf5, 0xd3, 0x06, 0xeb, 0x0a, 0x04, 0x57, 0x58, 0xf8, 0x24, 0x17, 0x00,
+  0x9c, 0x4d, 0x00, 0x24, 0xa1, 0x00, 0xff, 0xae, 0x42, 0x04, 0xd3, 0x00,
+  0x27, 0x00, 0x24, 0xff, 0x05, 0xfb, 0x09, 0xfa, 0xed, 0xe7, 0x06, 0xfb,
+  0xbf, 0x09, 0x61, 0x58, 0xf8, 0x21, 0x10, 0x7f, 0x01, 0xf4, 0xbb, 0xf7,
+  0xfe, 0xa1, 0xe0, 0x05, 0xa8, 0x06, 0x59, 0x10, 0x40, 0xaf, 0xf8, 0x26,
+  0x50, 0x15, 0x51, 0x00, 0x0b, 0x39, 0x00, 0x71, 0xaa, 0x51, 0x00, 0x9f,
+  0x51, 0x02, 0xb4, 0x51, 0x02, 0x0b, 0x51, 0x04, 0x73, 0xf2, 0x91, 0x10,
+  0x6c, 0x55, 0x02, 0x8b, 0x11, 0xca, 0x45, 0xb9, 0xd2, 0xfe, 0x57, 0x01,
+  0x0a, 0xfb, 0x09, 0xfb, 0xea, 0xe7, 0x0a, 0x7e, 0x1d, 0x30, 0x00, 0x90,
+  0x01, 0x25, 0x15, 0xe0, 0x67, 0x00, 0xff, 0x60, 0x58, 0xf8, 0x20, 0x00,
+  0x5d, 0xf8, 0x26, 0xaa, 0x5f, 0x10, 0x5b, 0x4b, 0x00, 0x79, 0x4b, 0x00,
+  0x76, 0x87, 0x00, 0xf1, 0xfb, 0xd3, 0x0a, 0x47, 0x92, 0x00, 0xf0, 0x4e,
+  0xf8, 0x4d, 0xf6, 0x3d, 0x12, 0x4d, 0x45, 0x15, 0x80, 0x27, 0x00, 0x26,
+  0xf0, 0xff, 0xe7, 0x68, 0x46, 0x00, 0xeb, 0x89, 0x00, 0xa9, 0xff, 0xf1,
+  0x02, 0x05, 0x50, 0xf8, 0x04, 0x1c, 0x05, 0xf9, 0xa8, 0x0d, 0x01, 0x09,
+  0x00, 0x0c, 0xf5, 0xf7, 0x3a, 0xf8, 0xdd, 0x0a, 0x89, 0x60, 0x89, 0x01,
+  0x41, 0x0d, 0x00, 0x1b, 0xe0, 0x87, 0x0a, 0x99, 0x51, 0x57, 0x00, 0x63,
+  0x05, 0xff, 0x50, 0x5f, 0x00, 0x49, 0xea, 0x5f, 0x02, 0x4e, 0xbb, 0x10,
+  0x5d, 0x5d, 0x02, 0x1f, 0xf8, 0x05, 0xaf, 0xa9, 0x51, 0xf8, 0x25, 0x7d,
+  0x00, 0x1c, 0x3b, 0x00, 0x41, 0xfe, 0x69, 0x01, 0x1e, 0x00, 0x2d, 0x02,
+  0xd4, 0x00, 0x27, 0x5f, 0x6e, 0x1c, 0xeb, 0xe7, 0x0b, 0x91, 0x42, 0x04,
+  0x07, 0x12, 0xfb, 0x20, 0x00, 0x0b, 0x11, 0xf5, 0xf7, 0x08, 0xb8, 0x02,
+  0xad, 0x98, 0x81, 0x11, 0x04, 0xb8, 0x17, 0x11, 0x39, 0x97, 0x10, 0xef,
+  0xfd, 0xbe, 0x75, 0x11, 0x04, 0x46, 0x04, 0xf5, 0x00, 0x75, 0xff, 0x50,
+  0x08, 0x03, 0x22, 0x59, 0x08, 0x2a, 0x60, 0xff, 0x40, 0x00, 0x49, 0x00,
+  0x41, 0xea, 0x00, 0x02, 0xbf, 0xa8, 0x60, 0x6a, 0x60, 0xe9, 0x60, 0x41,
+  0xd0, 0x09, 0x3f, 0x68, 0x68, 0xc0, 0x08, 0xc0, 0x00, 0x01, 0xf0, 0x07,
+  0x02, 0xec, 0x07, 0xf0, 0x07, 0x02, 0xe8, 0x60, 0x17, 0x00, 0x02, 0xc0,
+  0x0a, 0xf0, 0x17, 0x02, 0x07, 0x00, 0x17, 0x02, 0x07, 0x00, 0xe8, 0x60,
+  0x18, 0x20, 0x77, 0x69, 0x68, 0xc1, 0x95, 0x40, 0x07, 0xd4, 0xa9, 0x07,
+  0x02, 0xf7, 0x03, 0xd4, 0xe9, 0x07, 0x02, 0x01, 0xd5, 0x81, 0x46, 0xbf,
+  0x01, 0xe0, 0x40, 0x1e, 0xef, 0xd5, 0x55, 0x00, 0x0a, 0xff, 0x50, 0x46,
+  0xca, 0x45, 0xc8, 0xbf, 0x48, 0x46, 0xff, 0x04, 0xeb, 0x80, 0x07, 0x04,
+  0xeb, 0x8a, 0x08, 0x7f, 0x08, 0xf1, 0x04, 0x06, 0x78, 0x68, 0x30, 0x17,
+  0x30, 0xcf, 0xd4, 0x0b, 0x78, 0x68, 0x55, 0x61, 0x7f, 0x11, 0xb8, 0x6e,
+  0x7f, 0x70, 0x66, 0x21, 0x68, 0xb8, 0x6e, 0xf4, 0xdf, 0xd0, 0xee, 0x97,
+  0x51, 0xb8, 0x6e, 0x21, 0x67, 0x30, 0xb1, 0xf8, 0xc8, 0xfe, 0xd3, 0x40,
+  0x08, 0xf5, 0x0b, 0x70, 0x31, 0x68, 0x01, 0xfb, 0x60, 0xba, 0xff, 0xf0,
+  0x71, 0x6e, 0x41, 0x66, 0x20, 0xdf, 0x68, 0xa8, 0x62, 0xd3, 0xdb, 0x05,
+  0x01, 0x04, 0xf5, 0xf7, 0x3d, 0x70, 0x9d, 0xa3, 0x40, 0x00, 0xf0, 0x02,
+  0xf8, 0xfe, 0x33, 0x31, 0x01, 0x70, 0x29, 0x68, 0x41, 0x60, 0x69, 0xf7,
+  0x68, 0x81, 0x60, 0x91, 0x00, 0x60, 0xe9, 0x68, 0x01, 0xee, 0x91, 0x50,
+  0x38, 0xb5, 0x04, 0xa7, 0x30, 0x89, 0xfa, 0x04, 0xf7, 0xf1, 0xcc, 0x01,
+  0x0f, 0x11, 0x00, 0x22, 0x08, 0x60, 0xfd, 0x4a, 0x8f, 0xd0, 0x00, 0x25,
+  0x04, 0xeb, 0x81, 0x02, 0xff, 0x02, 0xf1, 0xd4, 0x03, 0x49, 0x1c, 0x18,
+  0x60, 0xff, 0xc2, 0xf8, 0x9c, 0x51, 0x00, 0x22, 0x19, 0x29, 0xf7, 0x5a,
+  0x66, 0xf3, 0x8f, 0xc0, 0x00, 0x75, 0x01, 0x21, 0x77, 0x29, 0x60, 0x6f,
+  0x7b, 0x50, 0x69, 0x60, 0xa9, 0x1d, 0x10, 0x3f, 0x69, 0x68, 0xc9, 0x08,
+  0xc9, 0x00, 0x0b, 0x00, 0x07, 0x02, 0x38, 0x11, 0x00, 0x07, 0x02, 0x17,
+  0x02, 0x02, 0xc9, 0x0a, 0x17, 0x02, 0x07, 0x00, 0xfc, 0x17, 0x02, 0x07,
+  0x00, 0xe9, 0x60, 0x2a, 0x61, 0x6a, 0x61, 0x7f, 0x28, 0x62, 0xaa, 0x61,
+  0xea, 0x61, 0x6a, 0xa3, 0x00, 0xed, 0x0a, 0x8b, 0x80, 0x49, 0xfa, 0xab,
+  0x01, 0x00, 0x21, 0xff, 0xff, 0xf7, 0xad, 0xff, 0x01, 0x21, 0x01, 0x75,
+  0x31, 0x35, 0xbd, 0xc9, 0x33, 0x08, 0x6b, 0x00, 0x00, 0x26, 0x65, 0xc0,
+  0x07, 0x10, 0xff, 0x08, 0xeb, 0x86, 0x09, 0x09, 0xf5, 0x0b, 0x74, 0x9f,
+  0x09, 0xf1, 0x04, 0x00, 0x21, 0xef, 0x00, 0xb5, 0x60, 0x07, 0xd7, 0x21,
+  0x68, 0x39, 0xbb, 0xd0, 0x61, 0xf5, 0x00, 0x60, 0x6e, 0xd7, 0xa9, 0x6a,
+  0xf4, 0xff, 0xf0, 0x78, 0x09, 0x02, 0x00, 0xf0, 0xef, 0x23, 0xf8, 0x19,
+  0x2e, 0x9d, 0x61, 0xe3, 0xd3, 0x08, 0xf3, 0xf1, 0xcc, 0xc7, 0x61, 0xbf,
+  0x00, 0x01, 0x60, 0x42, 0x60, 0xff, 0x08, 0xf5, 0x3e, 0x70, 0x02, 0x68,
+  0x2a, 0x60, 0xff, 0x42, 0x68, 0x6a, 0x60, 0x82, 0x68, 0xaa, 0x60, 0xf7,
+  0xc0, 0x68, 0xe8, 0x73, 0xe0, 0x68, 0x61, 0x29, 0x62, 0xfe, 0x3f, 0x80,
+  0x61, 0x00, 0x20, 0xe8, 0x61, 0x68, 0x62, 0xfc, 0x8f, 0x31, 0xdf, 0x55,
+  0x80, 0xf0, 0x00, 0x40, 0xf4, 0xf7, 0xff, 0xde, 0xbd, 0x80, 0xb5, 0x01,
+  0x21, 0xfb, 0xf7, 0xff, 0xd6, 0xff, 0xbd, 0xe8, 0x04, 0x40, 0x74, 0x49,
+  0xef, 0xf4, 0xf7, 0xe5, 0xbe, 0x99, 0x10, 0xd7, 0x23, 0x3c, 0xb7, 0x2d,
+  0xe9, 0xfe, 0x39, 0x21, 0xf1, 0x14, 0x77, 0xe0, 0xd0, 0xff, 0x76, 0x01,
+  0x20, 0xb0, 0x62, 0x88, 0x46, 0xe0, 0xff, 0x68, 0x03, 0x21, 0x01, 0x62,
+  0x01, 0x22, 0x05, 0xef, 0x21, 0x01, 0x60, 0x20, 0xb1, 0x50, 0xfe, 0xf7,
+  0xe8, 0xb9, 0xfe, 0x4b, 0x80, 0xf1, 0xc0, 0xc7, 0x80, 0x39, 0x1f, 0x40,
+  0xfe, 0xe7, 0xf7, 0x38, 0xfe, 0xad, 0xd1, 0x43, 0x30, 0xab, 0x02, 0xaa,
+  0xee, 0x11, 0x03, 0xaf, 0xfd, 0xa0, 0xd7, 0x60, 0x07, 0x77, 0x3d, 0xff,
+  0x68, 0x1d, 0xb9, 0x02, 0x98, 0x78, 0x60, 0x01, 0xff, 0x98, 0x46, 0xe0,
+  0x20, 0x68, 0x00, 0xf1, 0x88, 0xff, 0x09, 0xd9, 0xf8, 0x0c, 0x00, 0x85,
+  0x42, 0x23, 0xeb, 0xd2, 0x28, 0xa9, 0x20, 0x0c, 0xed, 0xd0, 0xb0, 0xf8,
+  0x02, 0xff, 0x99, 0xf4, 0xf7, 0x09, 0xfe, 0x81, 0x46, 0x68, 0xaf, 0x1c,
+  0xf4, 0xf7, 0x03, 0xbb, 0xd0, 0x48, 0x19, 0x00, 0x0f, 0xdf, 0xfd, 0x78,
+  0x60, 0x3d, 0x68, 0x23, 0x01, 0xfa, 0xfc, 0xdd, 0xb9, 0x0b, 0x50, 0x95,
+  0xfe, 0x01, 0x25, 0x00, 0xf6, 0xfd, 0xf2, 0x25, 0x03, 0xf0, 0xe3, 0xa0,
+  0x25, 0x01, 0xfc, 0xfc, 0x1b, 0xe0, 0xdf, 0xd9, 0xf8, 0x08, 0x50, 0xfe,
+  0x2f, 0x00, 0x00, 0xf0, 0x77, 0x8b, 0xf8, 0x82, 0xdd, 0x40, 0x78, 0xfe,
+  0x51, 0x19, 0x00, 0xb1, 0xe1, 0x3f, 0x00, 0xff, 0x11, 0x1d, 0x03, 0x02,
+  0xfd, 0x43, 0x01, 0x73, 0xfe, 0x63, 0x00, 0x01, 0x98, 0xff, 0xf7, 0x68,
+  0xfe, 0xff, 0xff, 0xf7, 0x13, 0xf9, 0xb8, 0x60, 0x01, 0x2e, 0x18, 0xbf,
+  0xbf, 0x04, 0x2e, 0x07, 0xd1, 0x20, 0x71, 0xb0, 0x88, 0xbf, 0x10, 0x34,
+  0x48, 0xf4, 0xf7, 0x62, 0x53, 0x40, 0x02, 0xbc, 0xa7, 0x00, 0x0f, 0x00,
+  0x50, 0x79, 0x68, 0x30, 0x11, 0x00, 0xbd, 0xbf, 0xfd, 0xd7, 0xf8, 0x08,
+  0x90, 0x01, 0x51, 0x00, 0x54, 0xfb, 0xfe, 0x83, 0x73, 0x00, 0xff, 0xf7,
+  0x2a, 0xfd, 0xff, 0x7f, 0xf7, 0x35, 0xfc, 0x4f, 0xf0, 0x7a, 0x5a, 0x67,
+  0x01, 0xf5, 0x49, 0x53, 0x01, 0x20, 0x49, 0x03, 0x03, 0xd1, 0x21, 0x68,
+  0xbf, 0x88, 0x31, 0x49, 0x69, 0x02, 0xe0, 0x07, 0x01, 0x09, 0xab, 0x69,
+  0x88, 0x69, 0x10, 0x91, 0x7b, 0x80, 0x30, 0x1d, 0x10, 0x02, 0xeb, 0x99,
+  0x1d, 0x4d, 0x00, 0x96, 0xdd, 0x00, 0xf4, 0xf7, 0x2f, 0xae, 0xcb, 0x00,
+  0x83, 0x46, 0x08, 0x09, 0x00, 0x2a, 0x89, 0x00, 0x0f, 0xcd, 0xfc, 0x47,
+  0x01, 0x25, 0xfe, 0xb3, 0xe1, 0xf7, 0x00, 0xfe, 0x05, 0x5b, 0xd2, 0x08,
+  0x65, 0x00, 0x2f, 0xff, 0x23, 0x21, 0x15, 0x49, 0x00, 0xfd, 0x38, 0x4b,
+  0x00, 0xc9, 0x68, 0x88, 0x42, 0x03, 0xd2, 0xd7, 0x40, 0x1c, 0x38, 0xdb,
+  0x10, 0x0c, 0x77, 0x60, 0xff, 0xf7, 0xd5, 0x1f, 0x1f, 0x02, 0x29, 0x05,
+  0x12, 0xf5, 0x69, 0xf4, 0x02, 0x20, 0xdf, 0xbd, 0xe8, 0xfe, 0x8f, 0x00,
+  0x00, 0x00, 0x20, 0x42, 0xbe, 0x03, 0x00, 0xc1, 0x71, 0x1d, 0x9e, 0x43,
+  0x7f, 0x81, 0x79, 0xfe, 0xfb, 0x00, 0xf5, 0xbd, 0x00, 0x00, 0x1a, 0x48,
+  0x01, 0xff, 0x78, 0x09, 0x06, 0x00, 0xd4, 0x70, 0x47, 0x2d, 0xff, 0xe9,
+  0xf0, 0x41, 0x00, 0x78, 0x17, 0x4d, 0x00, 0xff, 0xf0, 0x07, 0x04, 0x68,
+  0x78, 0x84, 0x42, 0x01, 0xff, 0xd1, 0x28, 0x78, 0x18, 0xbb, 0x0f, 0xf2,
+  0x5c, 0xff, 0x00, 0x13, 0x4f, 0x50, 0xf8, 0x24, 0x80, 0x4f, 0x7f, 0xf6,
+  0xff, 0x70, 0x38, 0x80, 0x01, 0x26, 0x91, 0x01, 0x77, 0x3a, 0xfc, 0x41,
+  0x05, 0x00, 0xd5, 0xfd, 0x0e, 0x25, 0x20, 0xfd, 0x44, 0x77, 0x10, 0x0d,
+  0x48, 0xf5, 0xf7, 0x45, 0xf8, 0xff, 0x4f, 0xf0, 0x8f, 0x41, 0xf4, 0xf7,
+  0xca, 0xfd, 0xff, 0xf4, 0xf7, 0x34, 0xfe, 0x27, 0xf8, 0x16, 0x00, 0xff,
+  0x76, 0x1c, 0x40, 0x2e, 0xe7, 0xd3, 0x01, 0x20, 0xef, 0x6c, 0x70, 0x28,
+  0x70, 0xa3, 0x40, 0x81, 0x13, 0x07, 0xff, 0x00, 0x46, 0x8a, 0xf3, 0x00,
+  0x20, 0x28, 0xf0, 0x4e, 0x17, 0x20, 0x00, 0xa0, 0x41, 0x8f, 0x00, 0x03,
+  0x00, 0x80, 0x65, 0x20, 0xf3, 0x00, 0xbf, 0x93, 0x01, 0x07, 0x00, 0xc0,
+  0x00, 0x00, 0x40, 0xea, 0x03, 0x00, 0x80, 0x03, 0x00, 0xa0, 0x03, 0x00,
+  0xc0, 0xc0, 0x80, 0xef, 0xb5, 0x4f, 0xf0, 0x9e, 0x55, 0x00, 0xa7, 0xfe,
+  0x02, 0xbb, 0xd8, 0x6f, 0xa7, 0x20, 0x02, 0xbd, 0x4d, 0x73, 0x00, 0x86,
+  0xbf, 0xfd, 0x24, 0xbf, 0xbd, 0xe8, 0x02, 0x4b, 0x10, 0xff, 0xb9, 0xbd,
+  0x61, 0x40, 0x15, 0x00, 0x38, 0xb5, 0x0c, 0x91, 0x00, 0xee, 0xbb, 0xfb,
+  0x46, 0x1d, 0x00, 0x89, 0xfd, 0x05, 0xa1, 0x62, 0xe7, 0xcc, 0x61, 0xb0,
+  0x2d, 0x21, 0xf3, 0xfb, 0x1b, 0x31, 0xff, 0x10, 0xfc, 0xbd, 0x3f, 0xe8,
+  0x32, 0x40, 0xfb, 0xf7, 0x5b, 0xb5, 0xf0, 0xd1, 0x21, 0x77, 0x0f, 0x46,
+  0x25, 0xcb, 0x80, 0x7c, 0x50, 0x29, 0x23, 0x00, 0xab, 0x6f, 0xfd, 0x05,
+  0x01, 0x6c, 0x31, 0x20, 0x70, 0xa3, 0x70, 0x28, 0xeb, 0x46, 0x49, 0x0d,
+  0x00, 0xd7, 0x37, 0x00, 0x9d, 0x4b, 0x59, 0xba, 0x09, 0x00, 0x60, 0xdf,
+  0x10, 0xba, 0xff, 0x38, 0x3d, 0x21, 0x58, 0xff, 0x38, 0x1d, 0x00, 0x90,
+  0x68, 0x37, 0x00, 0x25, 0xff, 0xdf, 0xf8, 0xb4, 0xa0, 0x04, 0xeb, 0x85,
+  0x06, 0xba, 0x31, 0xd1, 0xb0, 0xb5, 0x40, 0x4e, 0xfd, 0xb1, 0x05, 0x00,
+  0x4b, 0x6e, 0x41, 0x00, 0x4f, 0xf8, 0x71, 0x5d, 0x10, 0xb8, 0xfb, 0x39,
+  0x01, 0x5b, 0x43, 0xfd, 0x49, 0x01, 0xb2, 0xfb, 0x2f, 0x11, 0x3d, 0x45,
+  0x00, 0xb7, 0x97, 0xff, 0x00, 0xc1, 0x52, 0x51, 0x46, 0x33, 0x01, 0x34,
+  0x55, 0xfd, 0x29, 0x01, 0xa3, 0x29, 0x02, 0x2e, 0x29, 0x02, 0x9d, 0x29,
+  0x02, 0x5d, 0x28, 0x29, 0x00, 0x82, 0xff, 0x47, 0x27, 0x02, 0x40, 0x0f,
+  0x00, 0xfb, 0x20, 0xfd, 0x67, 0xf2, 0x46, 0xc6, 0xdb, 0x60, 0x6e, 0xaa,
+  0x25, 0x01, 0x18, 0x33, 0x20, 0x58, 0x07, 0x00, 0x86, 0x2d, 0xc0, 0x6e,
+  0xfe, 0x51, 0x00, 0x08, 0x66, 0x00, 0x20, 0x38, 0x66, 0x02, 0xfe, 0xb3,
+  0x60, 0x30, 0xb9, 0x01, 0x99, 0x00, 0x98, 0x03, 0xfe, 0x13, 0x61, 0x4f,
+  0x00, 0xf0, 0x42, 0xb9, 0xbd, 0xe8, 0x3d, 0xf7, 0xfd, 0x12, 0xfe, 0xff,
+  0xff, 0xce, 0x4f, 0x10, 0x6f, 0x11, 0xb3, 0xbf, 0x01, 0xad, 0x72, 0xdf,
+  0x30, 0xbb, 0x00, 0xbd, 0x30, 0x00, 0xfc, 0x03, 0x50, 0x0f, 0x00, 0x53,
+  0x53, 0x60, 0x49, 0x1c, 0x00, 0xff, 0x23, 0x19, 0x29, 0x93, 0x66, 0xf5,
+  0xd3, 0x70, 0xff, 0x47, 0xf8, 0xb5, 0x0f, 0x46, 0xd7, 0xf8, 0x00, 0xff,
+  0xe0, 0xd7, 0xf8, 0x04, 0xc0, 0x06, 0x46, 0x82, 0xff, 0xfb, 0x0e, 0x45,
+  0x83, 0xfb, 0x0c, 0x01, 0x20, 0xff, 0x1a, 0x65, 0xeb, 0x01, 0x01, 0x82,
+  0xfb, 0x0c, 0xfb, 0x45, 0xc3, 0x11, 0x00, 0x32, 0x68, 0x73, 0x68, 0xc0,
+  0xff, 0x0d, 0x40, 0xea, 0x41, 0x20, 0x81, 0x18, 0x31, 0xff, 0x60, 0xe4,
+  0x0d, 0x44, 0xea, 0x45, 0x24, 0xe1, 0xff, 0x18, 0x71, 0x60, 0x10, 0x1a,
+  0x38, 0x60, 0x18, 0xbf, 0x1b, 0x78, 0x60, 0xf1, 0xbd, 0x10, 0x79, 0x52,
+  0x5b, 0xff, 0xf8, 0x04, 0xf1, 0x08, 0x01, 0xff, 0xf7, 0xd5, 0xef, 0xff,
+  0x00, 0xf0, 0x55, 0x0b, 0x00, 0x18, 0x01, 0x04, 0xbf, 0xf1, 0x10, 0x00,
+  0xff, 0xf7, 0xcd, 0x0f, 0x00, 0x4d, 0xae, 0x0f, 0x00, 0x10, 0x01, 0x20,
+  0x03, 0xa1, 0xff, 0x19, 0x03, 0x08, 0xff, 0x00, 0xbd, 0xe8, 0x10, 0x40,
+  0x4f, 0xf4, 0x00, 0xff, 0x03, 0x00, 0x22, 0xbb, 0xe7, 0x30, 0xb5, 0x85,
+  0xfb, 0xb0, 0x04, 0xed, 0x80, 0x68, 0x46, 0x0f, 0xf2, 0x1c, 0xff, 0x31,
+  0x10, 0x22, 0xf7, 0xf7, 0x14, 0xfc, 0x00, 0xbf, 0x20, 0x10, 0xf8, 0x0d,
+  0x10, 0x54, 0xe9, 0x60, 0x45, 0xff, 0xf8, 0x20, 0x10, 0x40, 0x1c, 0x10,
+  0x28, 0xf6, 0xfb, 0xd3, 0x28, 0x41, 0x00, 0xc8, 0xff, 0x05, 0xf1, 0x20,
+  0x5a, 0x57, 0x00, 0xc4, 0x57, 0x00, 0x21, 0xf8, 0x0b, 0x00, 0x01, 0x15,
+  0x01, 0x7f, 0x9a, 0xff, 0xb1, 0x4c, 0x23, 0x46, 0x22, 0x99, 0xa0, 0xf7,
+  0x28, 0x01, 0x05, 0x5d, 0x00, 0xff, 0xf7, 0x91, 0xff, 0xce, 0x5d, 0x03,
+  0x05, 0xf1, 0x30, 0x11, 0x00, 0x89, 0x01, 0x88, 0xff, 0x7f, 0x23, 0x46,
+  0xa9, 0x4a, 0x05, 0xf1, 0x38, 0x0f, 0x00, 0xfd, 0x18, 0x0f, 0x00, 0x80,
+  0xff, 0x05, 0xb0, 0x30, 0xbd, 0xeb, 0x00, 0x23, 0x27, 0x00, 0x02, 0x19,
+  0x31, 0xf3, 0x43, 0x87, 0xff, 0xb0, 0xff, 0xf7, 0xb9, 0xff, 0x08, 0x98,
+  0x00, 0xff, 0xf1, 0x40, 0x01, 0x07, 0x98, 0x08, 0x30, 0xff, 0xab, 0xf7,
+  0xb2, 0x0d, 0x02, 0x80, 0x0d, 0x00, 0x10, 0x0d, 0x00, 0xab, 0xfd, 0xff,
+  0x55, 0x60, 0x98, 0x07, 0x99, 0x50, 0xf8, 0x22, 0xfb, 0x00, 0x41, 0x03,
+  0x00, 0x52, 0x1c, 0x30, 0x2a, 0xf6, 0xd7, 0xd3, 0x03, 0x20, 0x41, 0x00,
+  0x0e, 0xa1, 0x20, 0x08, 0x00, 0xbf, 0x27, 0x02, 0x90, 0x00, 0x22, 0x07,
+  0x2f, 0x80, 0x22, 0xff, 0xc0, 0x00, 0xeb, 0x82, 0x01, 0x08, 0x1d, 0x03,
+  0xff, 0x68, 0xc4, 0x6b, 0x05, 0x6c, 0xc6, 0x6f, 0x01, 0xff, 0x96, 0xd1,
+  0xf8, 0x84, 0x10, 0x00, 0x91, 0x2f, 0xff, 0xb9, 0x01, 0x98, 0x00, 0x19,
+  0x00, 0xeb, 0x0c, 0xff, 0x06, 0x48, 0x19, 0x52, 0xe0, 0x86, 0x48, 0x80,
+  0xff, 0xfb, 0x0e, 0x01, 0xcd, 0xe9, 0x04, 0x01, 0x85, 0xf6, 0x09, 0x01,
+  0x69, 0x82, 0x05, 0x00, 0x08, 0x01, 0x30, 0x1a, 0xd9, 0x69, 0x7f, 0x10,
+  0x73, 0x12, 0x2e, 0xdd, 0x1b, 0x00, 0x7e, 0x4e, 0x59, 0xc6, 0x15, 0x00,
+  0x0f, 0x02, 0x28, 0x84, 0x25, 0x00, 0x85, 0x23, 0x0b, 0xaf, 0x20, 0x84,
+  0x44, 0x85, 0x45, 0x00, 0xc4, 0x23, 0x05, 0x20, 0x17, 0xc3, 0x18, 0x8e,
+  0xb7, 0x10, 0x88, 0x0f, 0x00, 0xc9, 0x13, 0x15, 0x02, 0xeb, 0x24, 0x88,
+  0x23, 0x00, 0x80, 0x09, 0x00, 0x81, 0x25, 0x01, 0xbf, 0x98, 0x80, 0xfb,
+  0x04, 0x69, 0x00, 0x05, 0x00, 0x05, 0xfc, 0x47, 0x0a, 0x95, 0x01, 0x00,
+  0x98, 0xdd, 0xf8, 0x04, 0x90, 0xa6, 0x1f, 0x00, 0x01, 0xc9, 0x1d, 0x00,
+  0x17, 0x03, 0x08, 0xcb, 0x20, 0x27, 0xef, 0x60, 0x92, 0x1c, 0x08, 0xd1,
+  0x80, 0x87, 0x01, 0xbf, 0xff, 0x1c, 0xc0, 0x18, 0x10, 0x2a, 0x48, 0x60,
+  0x8b, 0xff, 0xd3, 0x02, 0x98, 0x40, 0x1e, 0x02, 0x90, 0x86, 0x79, 0xd1,
+  0x2d, 0xd2, 0x7b, 0xa0, 0xf3, 0x4f, 0x87, 0xb0, 0x4b, 0x11, 0xfe, 0x09,
+  0x10, 0x0e, 0x00, 0x23, 0x07, 0x98, 0x4f, 0xea, 0xef, 0xee, 0x79, 0xde,
+  0xf5, 0x19, 0x80, 0xf8, 0x23, 0x00, 0xff, 0x69, 0xeb, 0x49, 0x07, 0xc1,
+  0x17, 0xaa, 0xfb, 0xff, 0x00, 0x45, 0x0a, 0xfb, 0x01, 0x55, 0x07, 0xfb,
+  0xfb, 0x00, 0x55, 0xf5, 0x00, 0x45, 0x07, 0x99, 0x03, 0xf1, 0x7b, 0x19,
+  0x06, 0x1b, 0x90, 0x60, 0x04, 0x46, 0x50, 0x65, 0xf1, 0xff, 0x17, 0xa0,
+  0xfb, 0x06, 0xa7, 0x00, 0xfb, 0x05, 0xf7, 0x77, 0x1e, 0xf5, 0xbb, 0xe0,
+  0xfb, 0x06, 0x77, 0x49, 0xfb, 0xf1, 0x00, 0x1f, 0x10, 0x02, 0x01, 0xc2,
+  0xfb, 0x04, 0x9f, 0xa7, 0x07, 0x98, 0x59, 0x42, 0xc7, 0x20, 0x61, 0x90,
+  0x60, 0xef, 0xcf, 0x40, 0x6e, 0xcc, 0x19, 0x00, 0xdd, 0xe9, 0x02, 0xff,
+  0x45, 0xc2, 0xfb, 0x01, 0xa7, 0x40, 0x42, 0xd0, 0xff, 0x46, 0xb9, 0x46,
+  0xc1, 0x17, 0xa4, 0xfb, 0x00, 0xff, 0xa7, 0x04, 0xfb, 0x01, 0x77, 0x05,
+  0xfb, 0x00, 0x6f, 0x77, 0x4d, 0x46, 0x18, 0x55, 0xa0, 0x7d, 0x41, 0x41,
+  0x10, 0xf7, 0xa7, 0x71, 0x42, 0x25, 0x01, 0xcd, 0xe9, 0x00, 0xa7, 0xef,
+  0x4f, 0xea, 0xec, 0x71, 0x35, 0x00, 0xa7, 0xaa, 0xfb, 0xfb, 0x0c, 0x6b,
+  0x89, 0x00, 0xbb, 0x07, 0xfb, 0x0c, 0xbb, 0xff, 0xdd, 0xe9, 0x00, 0x17,
+  0x11, 0xeb, 0x06, 0x0a, 0xdf, 0x47, 0xeb, 0x0b, 0x07, 0xc2, 0x41, 0x00,
+  0x4f, 0xea, 0xff, 0xda, 0x50, 0x40, 0xea, 0x47, 0x21, 0x21, 0x48, 0xff,
+  0xff, 0x15, 0xa0, 0xfb, 0x01, 0x89, 0x00, 0xfb, 0xdf, 0x07, 0x99, 0x4f,
+  0xea, 0xd8, 0x13, 0x00, 0x49, 0x21, 0xff, 0x08, 0x98, 0xdf, 0xf8, 0x6c,
+  0xa0, 0x40, 0xf8, 0xbb, 0x33, 0x10, 0x09, 0x33, 0xed, 0x15, 0xaa, 0x2b,
+  0x10, 0x0a, 0xf7, 0xfb, 0x05, 0x11, 0x2b, 0x15, 0x01, 0xeb, 0xc3, 0x01,
+  0xff, 0x5b, 0x1c, 0x48, 0x60, 0x12, 0x49, 0x13, 0x48, 0xdf, 0x81, 0xfb,
+  0x02, 0x45, 0xc0, 0x8b, 0x10, 0x06, 0x46, 0xff, 0xce, 0xf1, 0x00, 0x00,
+  0x81, 0xfb, 0x00, 0x01, 0xf7, 0xc6, 0xfb, 0x02, 0x55, 0x10, 0xe4, 0x0d,
+  0x18, 0x2b, 0xfa, 0x2d, 0x00, 0x22, 0x41, 0x00, 0x2e, 0xff, 0xf4, 0x6a,
+  0xaf, 0xef, 0x07, 0x99, 0x08, 0x98, 0x45, 0x12, 0x4f, 0xbb, 0xe6, 0xff,
+  0x7a, 0x82, 0x5a, 0x00, 0x86, 0x7d, 0xa5, 0xff, 0xff, 0xfc, 0x20, 0x21,
+  0x00, 0x75, 0xa3, 0x7b, 0x00, 0xff, 0xab, 0xaa, 0x02, 0x00, 0x15, 0xb5,
+  0x10, 0x00, 0xf7, 0xaa, 0xe7, 0x7e, 0x12, 0x10, 0x18, 0x19, 0x0c, 0x0d,
+  0xff, 0x24, 0x25, 0x06, 0x07, 0x1e, 0x1f, 0x12, 0x13, 0xf3, 0x2a, 0x2b,
+  0xcd, 0x50, 0xe1, 0x40, 0x8b, 0xb0, 0x00, 0x20, 0xff, 0x20, 0x77, 0x04,
+  0xf1, 0x1d, 0x05, 0x60, 0x69, 0xff, 0x00, 0xf1, 0x68, 0x01, 0x00, 0x1d,
+  0x07, 0x90, 0xff, 0x06, 0x91, 0x04, 0xf5, 0xe8, 0x70, 0x02, 0x90, 0xff,
+  0x04, 0xf5, 0x24, 0x70, 0x01, 0x90, 0x04, 0xf1, 0xff, 0x50, 0x00, 0x0a,
+  0x90, 0x01, 0x20, 0xa1, 0x68, 0xff, 0x46, 0x42, 0x01, 0xeb, 0x80, 0x02,
+  0x01, 0xeb, 0xff, 0x86, 0x01, 0x13, 0x6e, 0xd1, 0xf8, 0xc0, 0x60, 0xff,
+  0x16, 0x66, 0xc1, 0xf8, 0xc0, 0x30, 0x40, 0x1c, 0xff, 0xd2, 0xf8, 0x20,
+  0x31, 0xd1, 0xf8, 0x80, 0x61, 0xff, 0xc2, 0xf8, 0x20, 0x61, 0x0c, 0x28,
+  0xc1, 0xf8, 0xef, 0x80, 0x31, 0xe8, 0xdb, 0xc3, 0x50, 0x70, 0x01, 0x26,
+  0x77, 0x02, 0x99, 0x08, 0x11, 0x50, 0x42, 0x58, 0x01, 0x07, 0x00, 0xf7,
+  0x20, 0x69, 0xf0, 0xfd, 0xf2, 0x70, 0x55, 0xa7, 0x68, 0xd7, 0x57, 0xf8,
+  0x26, 0x27, 0xc0, 0x1e, 0x4d, 0xf0, 0x31, 0xfa, 0xfd, 0x02, 0x21, 0x20,
+  0x26, 0x00, 0x07, 0xeb, 0x86, 0x00, 0xd7, 0xd0, 0xf8, 0xc0, 0x15, 0x00,
+  0x13, 0x15, 0x00, 0x26, 0xfa, 0xbd, 0x01, 0x15, 0x02, 0xa9, 0x1b, 0xe0,
+  0x68, 0x35, 0x03, 0x81, 0xf7, 0xf8, 0x30, 0x00, 0x1b, 0x80, 0xeb, 0x86,
+  0x07, 0x38, 0xca, 0x15, 0x50, 0x01, 0x23, 0x00, 0x14, 0x39, 0x00, 0x8b,
+  0x01, 0x08, 0x66, 0x7f, 0xd7, 0xf8, 0x20, 0x01, 0xf4, 0xf7, 0xf7, 0xab,
+  0xb0, 0xf9, 0x0a, 0x37, 0x00, 0x13, 0x01, 0x76, 0x1c, 0x18, 0x2e, 0x08,
+  0xff, 0x66, 0xc5, 0xdb, 0x01, 0x22, 0xdf, 0xf8, 0xdc, 0xff, 0x07, 0x01,
+  0x46, 0x40, 0x08, 0x49, 0x08, 0xc3, 0xff, 0x07, 0x5c, 0xbf, 0x00, 0x23,
+  0x53, 0x55, 0xcb, 0xfe, 0x83, 0xa0, 0xae, 0x1a, 0x00, 0x23, 0x86, 0xf8,
+  0x30, 0xff, 0x30, 0x52, 0x1c, 0x18, 0x2a, 0xf0, 0xdb, 0x00, 0xff, 0x27,
+  0x03, 0xe0, 0x00, 0x2f, 0x18, 0xbf, 0x18, 0xff, 0x2f, 0x02, 0xd1, 0x4f,
+  0xf0, 0xff, 0x39, 0x65, 0xff, 0xe0, 0x78, 0x5d, 0x00, 0x28, 0x62, 0xd0,
+  0x01, 0xee, 0x8b, 0x30, 0x27, 0xa0, 0x02, 0x05, 0x01, 0xb0, 0x58, 0x46,
+  0xbe, 0x81, 0x51, 0x6d, 0xfa, 0x00, 0x90, 0x51, 0x6d, 0x20, 0xf4, 0xef,
+  0xf7, 0x68, 0xfa, 0x00, 0x59, 0x80, 0xc9, 0xf9, 0xb9, 0xbf, 0xf1, 0x00,
+  0x0f, 0x0e, 0xd5, 0x06, 0x6b, 0x50, 0x00, 0xfd, 0x21, 0xbf, 0x50, 0xfa,
+  0xb9, 0x46, 0x08, 0xbf, 0x88, 0xaf, 0x46, 0x44, 0xd0, 0x50, 0x2f, 0x02,
+  0xc7, 0x8b, 0xe0, 0x3e, 0xdf, 0xe0, 0x00, 0x90, 0x00, 0x21, 0x8b, 0x51,
+  0x2e, 0xfa, 0x5f, 0x08, 0xbf, 0x8a, 0x46, 0x04, 0x1b, 0x04, 0xb9, 0x77,
+  0x80, 0xf7, 0x00, 0x98, 0x31, 0x09, 0x00, 0xb4, 0xf8, 0xf4, 0xf7, 0xff,
+  0xe6, 0xf9, 0xdf, 0xf8, 0x34, 0x17, 0xf4, 0xf7, 0xe7, 0xa0, 0xf9, 0x06,
+  0x5f, 0x00, 0xe1, 0x51, 0x27, 0xf9, 0x80, 0xdc, 0xdb, 0x70, 0x1f, 0x01,
+  0x32, 0xfa, 0x06, 0xe3, 0x50, 0x00, 0xf0, 0xfb, 0x9b, 0xf9, 0x0d, 0x01,
+  0x8f, 0xf9, 0xa7, 0xeb, 0x09, 0xff, 0x0b, 0x06, 0x46, 0x0b, 0xfb, 0x0b,
+  0xf0, 0xf4, 0xf7, 0xf7, 0x7c, 0xf8, 0x01, 0x83, 0x92, 0xf8, 0xdf, 0xf8,
+  0xff, 0xf8, 0x16, 0xf4, 0xf7, 0x24, 0xfb, 0x03, 0xd8, 0xff, 0x00, 0x20,
+  0x09, 0xf8, 0x05, 0x00, 0x78, 0x55, 0xff, 0xb9, 0x46, 0x00, 0x9e, 0xd0,
+  0x46, 0x7f, 0x1c, 0xef, 0x30, 0x2f, 0x8f, 0xdb, 0x47, 0xd0, 0x20, 0x02,
+  0x21, 0xff, 0x4a, 0x5d, 0x00, 0x2a, 0x1e, 0xbf, 0x6a, 0x1a, 0xff, 0x92,
+  0xf8, 0x30, 0x20, 0x00, 0x2a, 0x02, 0xd0, 0xbf, 0x01, 0x22, 0x8a, 0x40,
+  0x10, 0x43, 0xdb, 0xa0, 0x29, 0xff, 0xf1, 0xdb, 0x00, 0x21, 0x4f, 0xf4,
+  0x80, 0x72, 0xff, 0x80, 0x23, 0x4f, 0xf0, 0x17, 0x08, 0x18, 0x42, 0xf7,
+  0x1c, 0xbf, 0x1e, 0x17, 0x00, 0x0c, 0x29, 0x07, 0xd0, 0xdf, 0x10, 0x42,
+  0x03, 0xd0, 0x16, 0x0b, 0x02, 0x01, 0xd0, 0xdf, 0x5b, 0x10, 0x52, 0x00,
+  0xb8, 0x7f, 0xe0, 0xee, 0xd1, 0xff, 0x04, 0x29, 0x07, 0xda, 0x68, 0x78,
+  0x00, 0x28, 0xff, 0x1e, 0xbf, 0x95, 0xf8, 0x2f, 0x00, 0x00, 0x28, 0xbf,
+  0x46, 0xf0, 0x01, 0x06, 0x00, 0x27, 0xe1, 0xe0, 0x09, 0xf9, 0x19, 0x7b,
+  0x00, 0x17, 0x01, 0xa5, 0xeb, 0x09, 0x00, 0x90, 0xfe, 0xb5, 0x10, 0x00,
+  0x28, 0xc9, 0xf1, 0x30, 0x0a, 0x00, 0xbf, 0xf0, 0x93, 0x80, 0x01, 0x98,
+  0x02, 0xfd, 0x40, 0x29, 0xff, 0x00, 0x51, 0xf8, 0x29, 0x10, 0xf4, 0xf7,
+  0x39, 0xf7, 0xf8, 0x00, 0x90, 0xc1, 0x10, 0x98, 0x51, 0xf8, 0x2a, 0x6f,
+  0x10, 0x50, 0xf8, 0x2a, 0xf9, 0x10, 0x30, 0xf8, 0x23, 0xf0, 0xff, 0xf4,
+  0x80, 0x10, 0x05, 0x90, 0x4f, 0xf0, 0x93, 0xfd, 0x40, 0x5f, 0x11, 0xb5,
+  0xf9, 0xf4, 0xf7, 0x1f, 0xfa, 0xd4, 0xeb, 0x10, 0xef, 0x10, 0x1f, 0x03,
+  0x00, 0x20, 0x03, 0x00, 0x22, 0xf9, 0x57, 0x09, 0x90, 0x59, 0x0d, 0x10,
+  0x03, 0x1b, 0x00, 0x11, 0x1b, 0x00, 0x55, 0x06, 0x13, 0x00, 0x11, 0x03,
+  0x00, 0x12, 0x13, 0x21, 0xf9, 0x75, 0x90, 0xb6, 0xaf, 0x10, 0x29, 0xb0,
+  0xb5, 0x11, 0x29, 0x10, 0x2d, 0x91, 0x93, 0x5a, 0xd1, 0xf0, 0x59, 0x0b,
+  0x72, 0x8e, 0xf9, 0x53, 0x01, 0xef, 0x77, 0x00, 0xea, 0x23, 0x01, 0x2a,
+  0x23, 0x02, 0x2a, 0x23, 0x02, 0x81, 0xf9, 0x82, 0xac, 0x21, 0x00, 0x95,
+  0x11, 0x7c, 0xf9, 0x57, 0x91, 0xdd, 0x9b, 0x12, 0xf4, 0x37, 0xf7, 0x1b,
+  0xf9, 0xeb, 0x11, 0x18, 0xf9, 0x61, 0x30, 0x39, 0x00, 0x75, 0x5e, 0xbf,
+  0x80, 0x7c, 0x25, 0x80, 0x6a, 0xf9, 0x06, 0x9d, 0x20, 0xd4, 0xc7, 0x00,
+  0x23, 0x02, 0x63, 0x87, 0x00, 0x07, 0x03, 0x00, 0x05, 0xf9, 0xf5, 0x83,
+  0x0f, 0x02, 0x01, 0x33, 0x02, 0xfe, 0xf8, 0x07, 0x98, 0x5d, 0x40, 0x87,
+  0x00, 0x08, 0x99, 0x09, 0x13, 0x00, 0xb5, 0x39, 0x04, 0xfb, 0x4d, 0xf9,
+  0x9d, 0xd1, 0x29, 0x00, 0x26, 0xfa, 0x09, 0x5f, 0xf1, 0xc9, 0x07, 0x09,
+  0xd5, 0xe7, 0x11, 0xa7, 0x23, 0x20, 0xfe, 0x83, 0xd5, 0xa1, 0xf8, 0x07,
+  0x46, 0x09, 0xf1, 0x01, 0xff, 0x09, 0xb9, 0xf1, 0x18, 0x0f, 0xff, 0xf6,
+  0x5a, 0xbb, 0xaf, 0x38, 0x55, 0x22, 0x12, 0xf9, 0x08, 0x6d, 0xf0, 0x04,
+  0xfb, 0xd0, 0x40, 0xe5, 0x40, 0xf3, 0xf7, 0x9d, 0xff, 0x06, 0xef, 0x46,
+  0x60, 0x69, 0x06, 0x57, 0x30, 0x01, 0x08, 0xc8, 0xfa, 0x59, 0x10, 0x18,
+  0x6f, 0x10, 0x1a, 0xf8, 0x05, 0x10, 0x00, 0xff, 0x28, 0x02, 0xd0, 0x00,
+  0x29, 0x4d, 0xd1, 0x01, 0x7f, 0xe0, 0x00, 0x29, 0x4a, 0xd0, 0x40, 0xb1,
+  0xdd, 0x01, 0xf4, 0x83, 0x30, 0x05, 0x01, 0x00, 0xbf, 0xb0, 0x49, 0x07,
+  0xe0, 0x08, 0xe7, 0x00, 0x05, 0xd0, 0xf3, 0x02, 0x15, 0x02, 0x2a, 0x90,
+  0x48, 0xaa, 0x4f, 0x02, 0x75, 0xad, 0xf0, 0x06, 0xab, 0x00, 0x28, 0x21,
+  0xd0, 0x59, 0xaa, 0x89, 0x20, 0x67, 0x47, 0x10, 0x5c, 0x4b, 0x30, 0x67,
+  0x03, 0x00, 0x68, 0x62, 0x03, 0x00, 0x6a, 0x61, 0x20, 0x1f, 0x03, 0x69,
+  0x01, 0x18, 0xb1, 0x6d, 0x21, 0xef, 0x4d, 0xf8, 0x06, 0xe0, 0x73, 0x00,
+  0x00, 0x30, 0xb1, 0xbd, 0x08, 0xa1, 0x20, 0xf3, 0xf7, 0xd1, 0xff, 0x11,
+  0x11, 0x28, 0xad, 0x00, 0xaf, 0x00, 0xf0, 0x45, 0x3b, 0x10, 0x48, 0x1d,
+  0x92, 0xd6, 0x75, 0xf8, 0x4b, 0x11, 0x37, 0x53, 0x00, 0x77, 0xf8, 0x07,
+  0x1f, 0x02, 0xf5, 0x08, 0x3b, 0x20, 0xb8, 0xdb, 0x00, 0xa2, 0xdb, 0xa0,
+  0x69, 0xfe, 0x59, 0x40, 0xf5, 0x88, 0x73, 0x04, 0xf5, 0x54, 0x70, 0xdd,
+  0x00, 0x63, 0x41, 0x02, 0x60, 0x69, 0x85, 0x40, 0x01, 0x00, 0xdf, 0xf0,
+  0x36, 0xf8, 0x00, 0x24, 0x05, 0x71, 0x24, 0x20, 0xf5, 0x10, 0xfd, 0x02,
+  0x93, 0x3b, 0x10, 0x7e, 0x50, 0x1c, 0xbf, 0xed, 0x11, 0x67, 0x00, 0x1f,
+  0xff, 0x47, 0x01, 0x24, 0x00, 0x64, 0x1f, 0x1c, 0x19, 0x2c, 0xec, 0xdb,
+  0xd7, 0xe3, 0x31, 0x27, 0x1b, 0x90, 0xff, 0xb8, 0x04, 0x90, 0x03, 0xab,
+  0x00, 0x20, 0x03, 0x7f, 0x90, 0x05, 0xaa, 0x04, 0xa9, 0x8b, 0xe1, 0x53,
+  0x11, 0xfb, 0x93, 0xb8, 0x65, 0x11, 0x90, 0xb8, 0x03, 0x98, 0xf3, 0xee,
+  0xaf, 0xc0, 0x4f, 0xf0, 0x56, 0x87, 0x10, 0x89, 0xb8, 0xdf, 0x7f, 0xf8,
+  0xd0, 0x13, 0xf4, 0xf7, 0x85, 0xb8, 0x05, 0x51, 0xef, 0x9d, 0xb0, 0x0c,
+  0x46, 0xfb, 0x43, 0x02, 0x91, 0x01, 0x6f, 0x90, 0x90, 0x46, 0x9a, 0x95,
+  0xc1, 0x21, 0x48, 0x39, 0x80, 0xfd, 0x4a, 0x3d, 0x82, 0x30, 0x28, 0xf8,
+  0xdb, 0x01, 0x20, 0xfd, 0x02, 0x87, 0xf0, 0x20, 0x10, 0x81, 0xf0, 0x00,
+  0x41, 0xfe, 0x19, 0x01, 0x41, 0x42, 0x02, 0x9a, 0x52, 0xf8, 0x20, 0xff,
+  0x20, 0x08, 0xeb, 0x81, 0x03, 0x0a, 0xeb, 0x81, 0x3f, 0x01, 0xc3, 0xf8,
+  0xc0, 0x20, 0x01, 0x11, 0x02, 0x33, 0x00, 0xfc, 0x09, 0x04, 0x1d, 0x50,
+  0x20, 0x40, 0x1c, 0x18, 0x28, 0xe1, 0xdf, 0xdb, 0x4f, 0xf0, 0x18, 0x0b,
+  0xef, 0xb0, 0x5d, 0x01, 0xff, 0x29, 0x1e, 0xbf, 0x21, 0x1a, 0x91, 0xf8,
+  0x30, 0x3f, 0x10, 0x01, 0x29, 0x01, 0xd1, 0x83, 0x35, 0xc0, 0x1f, 0x01,
+  0xf7, 0xf2, 0xdb, 0x60, 0x49, 0x30, 0x1c, 0xbf, 0x94, 0xf8, 0xff, 0x2f,
+  0x10, 0x00, 0x29, 0x21, 0xd1, 0x01, 0x28, 0x7d, 0x04, 0x0b, 0x04, 0x03,
+  0xd1, 0x02, 0x20, 0x84, 0x5f, 0x30, 0xf7, 0x17, 0xe0, 0x00, 0x13, 0x03,
+  0x00, 0x01, 0x28, 0x02, 0x9e, 0x13, 0x00, 0x60, 0x70, 0x0e, 0xe0, 0x05,
+  0x01, 0xc7, 0x11, 0x2b, 0x9f, 0x00, 0xca, 0xf8, 0x04, 0x00, 0x27, 0x03,
+  0x0f, 0x05, 0xbc, 0xff, 0x00, 0x05, 0x20, 0x26, 0x9f, 0x00, 0xf0, 0x00,
+  0xfe, 0xcb, 0x10, 0xf3, 0xf8, 0x00, 0x26, 0x07, 0xf1, 0x84, 0xfd, 0x05,
+  0x45, 0x10, 0x59, 0x03, 0xe0, 0x18, 0x2e, 0x18, 0xff, 0xd0, 0x18, 0x2e,
+  0x01, 0xda, 0x3e, 0x60, 0x02, 0xff, 0xe0, 0xc6, 0xf1, 0x30, 0x00, 0x38,
+  0x60, 0xc5, 0xfa, 0x0f, 0x30, 0xc5, 0xb7, 0x70, 0x30, 0x5d, 0x28, 0xb1,
+  0x5a, 0xfa, 0x73, 0x50, 0xa8, 0x11, 0x00, 0x0c, 0x90, 0x03, 0xe0, 0xc5,
+  0xf6, 0xc1, 0xc0, 0xab, 0x48, 0x17, 0xe0, 0xf0, 0xe3, 0xf8, 0x76, 0xff,
+  0x1c, 0x30, 0x2e, 0xe1, 0xdb, 0xdd, 0xf8, 0x9c, 0xff, 0xa0, 0x9a, 0xf9,
+  0x00, 0x60, 0xba, 0x68, 0x00, 0x7f, 0x2e, 0x3a, 0xd4, 0x96, 0x42, 0x38,
+  0xd2, 0x27, 0x11, 0xff, 0x0d, 0xf1, 0x0c, 0x0c, 0x10, 0xe0, 0xb1, 0x42,
+  0xff, 0x18, 0xbf, 0xb2, 0x42, 0x07, 0xd0, 0x03, 0xfb, 0xff, 0x01, 0x23,
+  0x07, 0xeb, 0x83, 0x03, 0xdb, 0x68, 0xf7, 0x4c, 0xf8, 0x20, 0x1b, 0x60,
+  0x52, 0x1c, 0xbb, 0x68, 0xff, 0x9a, 0x42, 0xef, 0xd3, 0x49, 0x1c, 0xba,
+  0x68, 0xff, 0x91, 0x42, 0x38, 0xbf, 0x00, 0x22, 0xf6, 0xd3, 0xff, 0x70,
+  0x1c, 0x04, 0xe0, 0x07, 0xeb, 0x80, 0x01, 0x7f, 0x40, 0x1c, 0x0a, 0x6f,
+  0xca, 0x66, 0xb9, 0xa5, 0xc0, 0xff, 0xf7, 0xd3, 0x4a, 0x1e, 0x07, 0xf1,
+  0x70, 0x01, 0xff, 0x03, 0xa8, 0xfe, 0xf7, 0x01, 0xff, 0xb8, 0x68, 0xfd,
+  0x03, 0x1f, 0x02, 0xca, 0x6e, 0x0a, 0x67, 0x40, 0x1e, 0xef, 0x86, 0x42,
+  0xf8, 0xd3, 0x1d, 0x60, 0x01, 0x00, 0x20, 0x7b, 0x08, 0x67, 0xdb, 0x20,
+  0xf0, 0x90, 0xf8, 0x02, 0x33, 0xe0, 0xff, 0x9a, 0xf8, 0x01, 0x30, 0xba,
+  0x68, 0x01, 0x98, 0xfe, 0x35, 0x01, 0xfe, 0xf7, 0xa1, 0xfe, 0x00, 0x26,
+  0x0d, 0xef, 0xe0, 0x30, 0x5d, 0x02, 0x25, 0x10, 0x00, 0x20, 0x30, 0x77,
+  0x55, 0xa0, 0x1b, 0x79, 0x40, 0x10, 0x02, 0x29, 0x0d, 0x00, 0xfb, 0x21,
+  0x80, 0x09, 0x00, 0x76, 0x1c, 0x5e, 0x45, 0xef, 0xfc, 0x65, 0x17, 0x93,
+  0x40, 0x1d, 0xd1, 0xab, 0xf1, 0x01, 0x06, 0xff, 0x18, 0xe0, 0x96, 0xfb,
+  0xfb, 0xf0, 0xf3, 0xf7, 0xfb, 0xd9, 0xfd, 0xdd, 0x11, 0x2b, 0x10, 0xf3,
+  0xf7, 0x7c, 0x7f, 0xff, 0x02, 0x21, 0x31, 0x55, 0x02, 0x22, 0x31, 0x30,
+  0x7e, 0xe7, 0x10, 0x26, 0x10, 0x71, 0x42, 0x0b, 0x19, 0xe3, 0x10, 0xf3,
+  0x01, 0x83, 0x31, 0x50, 0xcf, 0x10, 0x00, 0x76, 0x1e, 0x01, 0xff, 0x2e,
+  0xe4, 0xda, 0x05, 0x20, 0x00, 0xf0, 0x52, 0x52, 0x1b, 0x30, 0x45, 0x5b,
+  0x10, 0x53, 0x11, 0x19, 0x53, 0x10, 0x03, 0x53, 0x10, 0x5f, 0x5c, 0x48,
+  0x28, 0x60, 0x04, 0x57, 0x1f, 0x01, 0x58, 0x57, 0x16, 0x5f, 0x02, 0xe0,
+  0xa8, 0x60, 0x56, 0x55, 0x12, 0x38, 0x55, 0x12, 0xbb, 0xe0, 0xdb, 0x4d,
+  0x10, 0xf0, 0x26, 0xf8, 0x9d, 0xb0, 0x67, 0xfc, 0x01, 0x12, 0xdb, 0x06,
+  0x02, 0x98, 0xfe, 0xf7, 0x35, 0xfe, 0xbf, 0x00, 0x20, 0x0d, 0xe0, 0x01,
+  0x5d, 0xc9, 0x03, 0x01, 0x5d, 0x55, 0x3b, 0x22, 0x20, 0x02, 0x2a, 0x0d,
+  0x00, 0x22, 0x11, 0x70, 0x6a, 0x5d, 0x20, 0x58, 0xd7, 0x00, 0x1d, 0x07,
+  0x32, 0x14, 0x21, 0x3f, 0x00, 0xf6, 0x45, 0x50, 0xcb, 0xbd, 0x47, 0x01,
+  0x07, 0xf1, 0x0c, 0x00, 0x7f, 0xfe, 0xf7, 0x5b, 0xbe, 0xb8, 0x60, 0x64,
+  0x17, 0x00, 0xfd, 0x0c, 0x17, 0x00, 0xbf, 0xbd, 0x01, 0x20, 0x78, 0x60,
+  0xed, 0x38, 0x65, 0xf0, 0x3b, 0xbd, 0xf5, 0x20, 0x43, 0x01, 0x24, 0xfb,
+  0x01, 0x26, 0xed, 0x61, 0xa8, 0xb1, 0x1f, 0x68, 0xb7, 0x7f, 0xf5, 0x80,
+  0x2f, 0xc8, 0xbf, 0xa7, 0xf5, 0x65, 0x40, 0xbb, 0xdc, 0x17, 0x0b, 0x00,
+  0x03, 0xda, 0x07, 0x0b, 0x00, 0x1e, 0xff, 0x60, 0x4e, 0x46, 0x2c, 0x4f,
+  0x17, 0x60, 0x00, 0xff, 0x27, 0x0f, 0x60, 0x1f, 0x68, 0x00, 0x2f, 0x13,
+  0xd7, 0xd5, 0x11, 0xe0, 0x15, 0x01, 0x17, 0x0b, 0x00, 0x09, 0xd5, 0xfd,
+  0x0e, 0x05, 0x20, 0x54, 0xbf, 0x01, 0x26, 0x4e, 0x46, 0xff, 0x7f, 0x42,
+  0x17, 0x60, 0x0f, 0x68, 0x7f, 0x42, 0xfd, 0x0f, 0x05, 0x00, 0x00, 0x2f,
+  0x00, 0xd4, 0x4c, 0x46, 0xde, 0x31, 0x00, 0xf2, 0x7c, 0x0c, 0xd2, 0x1d,
+  0xc0, 0x0d, 0x68, 0xff, 0x4e, 0xfa, 0x07, 0xf8, 0x3d, 0x41, 0x05, 0xfb,
+  0xd7, 0x14, 0xee, 0xc2, 0x0f, 0x00, 0xd1, 0x03, 0x00, 0x08, 0xfb, 0xf7,
+  0x04, 0xee, 0xc1, 0x07, 0x00, 0x5c, 0xf8, 0x27, 0x50, 0xe9, 0xd3, 0x07,
+  0x00, 0x1b, 0x01, 0xc3, 0x07, 0x00, 0x01, 0x24, 0x18, 0xbb, 0xb1, 0xbe,
+  0x4f, 0x70, 0x04, 0xd5, 0x02, 0x37, 0x00, 0x00, 0xfd, 0x2d, 0x49, 0x01,
+  0x7f, 0x1c, 0x13, 0x2f, 0xda, 0xdb, 0x7f, 0x10, 0x68, 0x70, 0x43, 0x10,
+  0x60, 0x08, 0x05, 0x00, 0xf7, 0x08, 0x60, 0x18, 0x05, 0x80, 0xc6, 0x40,
+  0x18, 0x60, 0xf8, 0x37, 0xa1, 0xb3, 0xc0, 0xb9, 0xc0, 0x80, 0xbf, 0xad,
+  0xc5, 0x27, 0xff, 0x38, 0xdb, 0x0f, 0xc9, 0x40, 0x95, 0xbf, 0xd6, 0xef,
+  0x33, 0x4f, 0xb7, 0x09, 0x13, 0x00, 0x02, 0x00, 0x40, 0xff, 0x2e, 0x01,
+  0x00, 0xb4, 0x9f, 0x00, 0x00, 0x11, 0xff, 0x51, 0x00, 0x00, 0xb1, 0x28,
+  0x00, 0x00, 0x5d, 0xff, 0x14, 0x00, 0x00, 0x2f, 0x0a, 0x00, 0x00, 0x18,
+  0xfe, 0x9e, 0x60, 0x8c, 0x02, 0x00, 0x00, 0x46, 0x01, 0x00, 0x33, 0x00,
+  0xa3, 0x29, 0x00, 0x1e, 0x00, 0x00, 0x29, 0x03, 0x00, 0x1e, 0x00, 0x85,
+  0x00, 0x1e, 0x00, 0x00, 0x1e, 0x00, 0xfa, 0xb0, 0x2e, 0x90, 0x03, 0x04,
+  0x70, 0xf7, 0x47, 0x38, 0xb5, 0x9b, 0x70, 0x04, 0x40, 0x89, 0xc0, 0xff,
+  0xf3, 0x81, 0x04, 0xc0, 0xf3, 0x01, 0x10, 0x08, 0xff, 0xb1, 0x44, 0xf0,
+  0x04, 0x04, 0x0c, 0xb9, 0x00, 0xff, 0x20, 0x32, 0xbd, 0xdf, 0xf8, 0x20,
+  0x04, 0x05, 0xfb, 0x78, 0x01, 0x3b, 0x70, 0x82, 0x70, 0xf2, 0xf7, 0x66,
+  0xff, 0xf9, 0x20, 0x46, 0xf0, 0xf7, 0x0a, 0xf8, 0x08, 0xeb, 0xb9, 0x04,
+  0x1b, 0x00, 0x20, 0x0d, 0x50, 0xbd, 0xf8, 0x04, 0x53, 0x46, 0x29, 0xd5,
+  0x60, 0x1d, 0x01, 0x57, 0x1d, 0x00, 0x32, 0x7b, 0x11, 0xff, 0x4c, 0x06,
+  0x46, 0x15, 0xb2, 0x6f, 0xf0, 0x02, 0xff, 0x00, 0x85, 0x42, 0x0c, 0x46,
+  0x1f, 0x46, 0xb8, 0xff, 0xbf, 0x05, 0x46, 0x02, 0xdb, 0x04, 0x2d, 0xa8,
+  0xff, 0xbf, 0x03, 0x25, 0xd7, 0xe9, 0x00, 0xab, 0x0f, 0xfa, 0x55, 0x30,
+  0xa2, 0xb1, 0x10, 0xb0, 0xf8, 0x5b, 0x46, 0x2a, 0xff, 0xea, 0x00, 0x0a,
+  0x23, 0xea, 0x01, 0x0b, 0xe8, 0xf7, 0x1c, 0xc1, 0x17, 0x13, 0x01, 0xa6,
+  0xf8, 0x4a, 0xea, 0xff, 0x00, 0x00, 0x4b, 0xea, 0x01, 0x01, 0xc7, 0xe9,
+  0xff, 0x00, 0x01, 0x72, 0xb6, 0xdf, 0xf8, 0xa4, 0x03, 0xff, 0x4f, 0xf6,
+  0xfe, 0x61, 0x01, 0x60, 0x01, 0x60, 0xff, 0x86, 0xf0, 0x01, 0x03, 0xdf,
+  0xf8, 0x98, 0x13, 0xff, 0x0a, 0x78, 0x1b, 0x01, 0x02, 0xf0, 0x8f, 0x02,
+  0xff, 0x03, 0xf0, 0x70, 0x03, 0x1a, 0x43, 0x0a, 0x70, 0xff, 0x04, 0xf0,
+  0x0f, 0x03, 0x4a, 0x78, 0x02, 0xf0, 0xff, 0xf0, 0x02, 0x1a, 0x43, 0x4a,
+  0x70, 0x8d, 0x70, 0xf6, 0xd3, 0xd1, 0x62, 0xb6, 0x3f, 0x10, 0x8c, 0x2d,
+  0xe9, 0xf8, 0x7f, 0x4f, 0x90, 0x46, 0x01, 0xf0, 0x04, 0x05, 0x49, 0x01,
+  0x9b, 0x58, 0xa3, 0x49, 0x00, 0x69, 0x80, 0x3f, 0x40, 0xb1, 0x80, 0xf0,
+  0xbf, 0x1c, 0x00, 0xd4, 0x4f, 0xd4, 0x4c, 0x0b, 0x01, 0x01, 0xff, 0xf0,
+  0x03, 0x01, 0x01, 0x43, 0x39, 0x70, 0x40, 0x7f, 0xea, 0x95, 0x00, 0x20,
+  0x70, 0x00, 0x20, 0x13, 0x00, 0xff, 0x00, 0x62, 0xb6, 0xce, 0x49, 0xf3,
+  0xf7, 0xbf, 0xff, 0xfb, 0x97, 0xf8, 0x00, 0xb0, 0x26, 0x78, 0xf1, 0xbf,
+  0xf7, 0x09, 0xfa, 0x08, 0xb1, 0x01, 0x83, 0x30, 0x03, 0xff, 0x21, 0x1b,
+  0xea, 0x01, 0x0f, 0x03, 0xd1, 0xf0, 0xff, 0x07, 0x01, 0xd4, 0x00, 0x26,
+  0x05, 0xe0, 0x00, 0xff, 0x20, 0xf3, 0xf7, 0xc4, 0xfb, 0x00, 0x28, 0xea,
+  0xfb, 0xd0, 0x02, 0x81, 0x80, 0xf3, 0xf7, 0x36, 0xfb, 0x86, 0xe7, 0xbb,
+  0x72, 0xb6, 0x55, 0x01, 0x65, 0x02, 0x20, 0x41, 0x01, 0xff, 0x39, 0x70,
+  0x39, 0x79, 0xfa, 0x78, 0xbb, 0x78, 0xff, 0x97, 0xf8, 0x01, 0xc0, 0x42,
+  0xea, 0x01, 0x21, 0xe5, 0x43, 0x03, 0x00, 0x4c, 0x03, 0x00, 0x65, 0x51,
+  0x40, 0x1c, 0x08, 0xff, 0x28, 0xed, 0xd3, 0x9d, 0xb1, 0x00, 0x21, 0x08,
+  0xff, 0x20, 0x4a, 0x01, 0x22, 0x70, 0x49, 0x1c, 0x22, 0xff, 0x79, 0xe3,
+  0x78, 0xa5, 0x78, 0x67, 0x78, 0x43, 0x2f, 0xea, 0x02, 0x22, 0x45, 0x03,
+  0x00, 0x47, 0x03, 0x00, 0x29, 0x00, 0xf2, 0x09, 0x30, 0x0c, 0x29, 0x00,
+  0x9b, 0x05, 0x30, 0x46, 0xbd, 0xe8, 0xfb, 0xf2, 0x8f, 0xdb, 0x51, 0xa9,
+  0xb0, 0x80, 0x46, 0x0b, 0xff, 0xa8, 0x0f, 0xf2, 0xc0, 0x21, 0x10, 0x22,
+  0xf6, 0xf7, 0xf7, 0x07, 0xfd, 0xb1, 0x40, 0xf0, 0xe2, 0xf9, 0x00, 0xbf,
+  0x21, 0x00, 0x20, 0xf0, 0xf7, 0x2f, 0x1d, 0x50, 0xec, 0xff, 0xf9, 0x00,
+  0x25, 0x07, 0xae, 0xad, 0x55, 0x6d, 0xff, 0x1c, 0x10, 0x2d, 0xfb, 0xd3,
+  0x00, 0xf0, 0x44, 0xff, 0xfa, 0x5f, 0xea, 0x00, 0x09, 0xfa, 0xd0, 0x00,
+  0xff, 0x24, 0xdf, 0xf8, 0x5c, 0xa2, 0x00, 0xf0, 0x39, 0xbf, 0xf9, 0x0a,
+  0xd5, 0x00, 0x25, 0x0a, 0xd1, 0x30, 0x00, 0x7b, 0xeb, 0xc4, 0x11, 0xe0,
+  0x00, 0xf0, 0x37, 0xf9, 0x2b, 0x01, 0xff, 0xf5, 0xd3, 0x0a, 0xeb, 0x84,
+  0x01, 0x64, 0x1c, 0xff, 0x6f, 0xf0, 0x00, 0x40, 0x06, 0x2c, 0x08, 0x66,
+  0xfb, 0xe9, 0xdb, 0xa1, 0x81, 0x04, 0x00, 0x55, 0xd1, 0x01, 0x9f, 0x90,
+  0x0d, 0xf1, 0x3c, 0x0b, 0x67, 0x00, 0x65, 0x80, 0x30, 0xbf, 0xb9, 0x00,
+  0x99, 0x0f, 0xf2, 0x54, 0x1d, 0xd0, 0x41, 0xff, 0x10, 0x03, 0x90, 0x24,
+  0xe0, 0x15, 0xa8, 0x03, 0xff, 0x90, 0x02, 0x20, 0x09, 0xf0, 0x01, 0x01,
+  0x49, 0xff, 0x42, 0x80, 0x4a, 0x11, 0x40, 0x81, 0xea, 0x59, 0xff, 0x09,
+  0x00, 0x27, 0x3a, 0x1d, 0x29, 0xfa, 0x07, 0xff, 0xf1, 0x29, 0xfa, 0x02,
+  0xf3, 0x01, 0xf0, 0x0f, 0xfb, 0x01, 0x03, 0xad, 0x10, 0x8a, 0x5d, 0x9c,
+  0x5d, 0x8c, 0xff, 0x55, 0x08, 0x37, 0x9a, 0x55, 0x20, 0x2f, 0xef, 0xff,
+  0xd3, 0x40, 0x1e, 0xe5, 0xd1, 0x00, 0x25, 0x15, 0x7f, 0xa9, 0xa8, 0x5d,
+  0x21, 0xf8, 0x15, 0x00, 0x7d, 0x01, 0xff, 0xf9, 0xd3, 0x00, 0x25, 0x03,
+  0x98, 0x30, 0xf9, 0xbb, 0x15, 0x00, 0xa5, 0xb0, 0xaa, 0x00, 0x20, 0x85,
+  0x00, 0x41, 0x7d, 0x4b, 0x2f, 0x10, 0x00, 0x21, 0x22, 0xf8, 0x10, 0x35,
+  0x10, 0xf7, 0x06, 0x28, 0xf5, 0xd5, 0xa0, 0x00, 0x24, 0x00, 0xf0, 0xff,
+  0xd9, 0xf8, 0x05, 0xd5, 0x00, 0xf0, 0xcd, 0xf8, 0xff, 0x02, 0x99, 0xfa,
+  0x1e, 0x00, 0xf0, 0xda, 0xf8, 0x5f, 0x64, 0x1c, 0x06, 0x2c, 0xf3, 0xab,
+  0x00, 0xc9, 0x33, 0x60, 0xbf, 0x06, 0xd0, 0x00, 0xf0, 0x96, 0xf9, 0x09,
+  0x11, 0x07, 0xfe, 0x99, 0x20, 0xa4, 0xe0, 0x00, 0xeb, 0xd0, 0x71, 0x49,
+  0xff, 0x10, 0x28, 0xfa, 0x01, 0xf2, 0xd1, 0x07, 0x0b, 0xaf, 0xd5, 0x1d,
+  0xa9, 0x5b, 0x57, 0x10, 0x51, 0x3d, 0x50, 0x91, 0xf7, 0x42, 0x04, 0xda,
+  0x5d, 0x01, 0x04, 0xa9, 0x21, 0xf8, 0xfb, 0x10, 0x70, 0x5d, 0x01, 0xe9,
+  0xdb, 0x7f, 0x1c, 0x07, 0xfb, 0x2f, 0xce, 0x2f, 0x10, 0xa9, 0xf8, 0x16,
+  0xd5, 0x04, 0xff, 0xa8, 0x0a, 0xeb, 0xc4, 0x07, 0x30, 0xf9, 0x14, 0xef,
+  0x00, 0x02, 0x99, 0xc2, 0xc7, 0x50, 0x30, 0x03, 0x00, 0xb7, 0xf0, 0xa5,
+  0xf8, 0x1f, 0x10, 0x03, 0x5b, 0xc5, 0x70, 0x18, 0xbb, 0x6e, 0x82, 0x3f,
+  0x00, 0xd7, 0xe9, 0x0c, 0xb1, 0x22, 0x1a, 0xed, 0x66, 0x81, 0x01, 0xe2,
+  0xdb, 0xc5, 0x01, 0x9d, 0xd3, 0x00, 0xff, 0x98, 0x40, 0x1c, 0x04, 0x28,
+  0x00, 0x90, 0xff, 0xf7, 0xf4, 0x69, 0xaf, 0xcb, 0x50, 0x28, 0x41, 0xd2,
+  0x40, 0x7f, 0x1c, 0x01, 0x90, 0x0b, 0xa8, 0x01, 0x99, 0x31, 0x10, 0xe7,
+  0x00, 0x00, 0x25, 0x21, 0x20, 0xc3, 0x00, 0x77, 0xf8, 0x2d, 0xed, 0xd5,
+  0x61, 0x00, 0x02, 0xd2, 0x3f, 0x00, 0xaa, 0x00, 0xfb, 0xff, 0xf7, 0x0a,
+  0xfe, 0x00, 0xf0, 0x0f, 0x00, 0xc7, 0xf7, 0x1e, 0x3f, 0xb2, 0x87, 0x40,
+  0xd4, 0x01, 0x2f, 0x0c, 0xd5, 0xda, 0xa9, 0x80, 0xf9, 0xbd, 0x03, 0xb0,
+  0x37, 0x00, 0x04, 0xd0, 0xff, 0x00, 0x98, 0x30, 0xf8, 0x02, 0x0c, 0xc2,
+  0x19, 0xfc, 0xd7, 0xb0, 0x09, 0x02, 0x3a, 0x1a, 0x12, 0xb2, 0x04, 0x2a,
+  0xfe, 0x5f, 0x30, 0x22, 0x04, 0xda, 0x12, 0xf1, 0x03, 0x0f, 0x7b, 0xb8,
+  0xbf, 0x7d, 0x30, 0x02, 0x00, 0xf0, 0x41, 0xc3, 0x50, 0xf5, 0x4f, 0x13,
+  0x12, 0xcb, 0x91, 0x02, 0xbf, 0xf4, 0x23, 0xaf, 0x73, 0xc5, 0xe7, 0x77,
+  0x00, 0x75, 0x00, 0x3c, 0xf8, 0x0f, 0x75, 0x02, 0x6f, 0x00, 0xf0, 0x2e,
+  0xf8, 0x79, 0x01, 0x1e, 0x46, 0x7b, 0x01, 0xbb, 0xcc, 0xfd, 0x7b, 0x01,
+  0xc2, 0x1e, 0x33, 0xdb, 0x30, 0x32, 0xaa, 0x39, 0x02, 0xe9, 0x39, 0x02,
+  0xe5, 0x0b, 0x10, 0xf0, 0xc5, 0x50, 0xf0, 0xeb, 0xf7, 0x61, 0x05, 0x00,
+  0x29, 0x91, 0x52, 0x00, 0x00, 0x74, 0xff, 0x29, 0x00, 0x20, 0x04, 0x01,
+  0x00, 0x46, 0x48, 0xff, 0x00, 0x00, 0x50, 0xb0, 0x05, 0x00, 0x46, 0xb8,
+  0xfe, 0x03, 0x00, 0x48, 0x08, 0x00, 0x46, 0x20, 0xa1, 0x07, 0x5f, 0x00,
+  0xa8, 0xf0, 0x00, 0x20, 0x5f, 0x40, 0xd0, 0x63, 0x00, 0xfb, 0x00, 0x00,
+  0x33, 0x10, 0x70, 0x47, 0x1d, 0xaa, 0x41, 0xff, 0x46, 0x04, 0x20, 0x34,
+  0xe6, 0x04, 0xeb, 0xd4, 0xfb, 0x70, 0x40, 0x87, 0x10, 0x00, 0xf1, 0xc8,
+  0x07, 0x70, 0xff, 0x47, 0x29, 0x46, 0x20, 0x46, 0xe4, 0xe5, 0x00, 0xff,
+  0x00, 0x04, 0x00, 0xfc, 0xff, 0xfe, 0xff, 0x02, 0xa8, 0x93, 0x40, 0xf4,
+  0x42, 0x9d, 0x42, 0x02, 0xa9, 0x40, 0x04, 0xb1, 0x40, 0x06, 0xbf, 0x00,
+  0x07, 0x00, 0x08, 0x00, 0x09, 0xbf, 0x40, 0x0b, 0xaf, 0x00, 0x0c, 0x00,
+  0x0d, 0x42, 0xf0, 0x0f, 0x01, 0x00, 0x0e, 0xaa, 0x09, 0x00, 0x0c, 0x11,
+  0x00, 0x0a, 0x19, 0x00, 0x08, 0x21, 0x00, 0x06, 0x12, 0x29, 0x00, 0x04,
+  0x31, 0x00, 0x43, 0x01, 0x00, 0x2f, 0x0e, 0x4f, 0x0d, 0x2f, 0x0d, 0x50,
+  0x4f, 0x0d, 0x63, 0x51, 0x43, 0x20, 0x09, 0x00, 0x0a, 0x15, 0x00, 0x0e,
+  0x23, 0x00, 0x95, 0x03, 0x2f, 0x00, 0x07, 0x1b, 0x00, 0x0b, 0x27, 0x00,
+  0x7f, 0x03, 0x0b, 0xaa, 0x0d, 0x00, 0x07, 0x15, 0x00, 0x03, 0x1d, 0x00,
+  0x0e, 0x25, 0x00, 0x0a, 0x82, 0x2d, 0x00, 0x06, 0x35, 0x00, 0x7e, 0x50,
+  0x2f, 0x0e, 0x4f, 0x0d, 0x2f, 0x0d, 0x0f, 0xfc, 0x25, 0x00, 0x4f, 0x09,
+  0x10, 0xb5, 0x04, 0x46, 0x04, 0x48, 0x77, 0xc0, 0x46, 0xc0, 0x25, 0xa0,
+  0x01, 0x70, 0x03, 0x09, 0x02, 0xff, 0x04, 0x60, 0x10, 0xbd, 0x88, 0xbc,
+  0x00, 0x20, 0xfd, 0x8c, 0x03, 0x00, 0x38, 0xb5, 0x2c, 0x48, 0x01, 0x78,
+  0xff, 0x80, 0x7d, 0xc0, 0x07, 0x03, 0xd5, 0x48, 0x07, 0xff, 0x58, 0xbf,
+  0x08, 0x22, 0x00, 0xd5, 0x04, 0x22, 0xfd, 0x0c, 0xa9, 0x50, 0xb6, 0x60,
+  0xef, 0xf7, 0xe6, 0xfc, 0xad, 0x40, 0xcb, 0x30, 0x41, 0xf8, 0x05, 0x01,
+  0x39, 0x05, 0x02, 0x31, 0xff, 0xf8, 0x21, 0x4c, 0x21, 0x4d, 0x20, 0x78,
+  0x28, 0x7d, 0x70, 0x0d, 0x01, 0x25, 0xf8, 0x60, 0x78, 0x68, 0x09, 0x00,
+  0xff, 0xbd, 0xe8, 0x38, 0x40, 0x40, 0x21, 0x40, 0xf2, 0xff, 0xe1, 0x50,
+  0xef, 0xf7, 0xcc, 0xbc, 0x80, 0xb5, 0xa8, 0x01, 0x41, 0xad, 0x70, 0x05,
+  0x00, 0x1e, 0x05, 0x02, 0x16, 0x05, 0x02, 0x0e, 0xfc, 0x05, 0x00, 0x25,
+  0x05, 0xb9, 0xfc, 0xbd, 0xe8, 0x08, 0x40, 0x5d, 0x00, 0x69, 0x06, 0xb1,
+  0xbc, 0x40, 0x09, 0x00, 0xbc, 0x09, 0x00, 0x5d, 0xac, 0x09, 0x00, 0x40,
+  0xf2, 0xdf, 0x23, 0x00, 0xa7, 0x09, 0x02, 0xd5, 0xde, 0x09, 0x00, 0xa2,
+  0x09, 0x02, 0xdd, 0x09, 0x00, 0x9d, 0xbc, 0xf4, 0x01, 0x10, 0x2b, 0x20,
+  0xe0, 0x23, 0x20, 0x8e, 0xf3, 0x00, 0x20, 0x9f, 0xf8, 0xb5, 0x34, 0x4f,
+  0x38, 0xd3, 0x00, 0xd5, 0x00, 0x46, 0xfb, 0x38, 0x1d, 0x07, 0x01, 0x05,
+  0x46, 0x07, 0xf1, 0x08, 0xd5, 0x00, 0x09, 0x01, 0x06, 0x09, 0x00, 0x0c,
+  0x09, 0x02, 0x23, 0x78, 0xff, 0x2b, 0x49, 0x2c, 0x4a, 0x00, 0x2b, 0x40,
+  0xd1, 0xff, 0x2b, 0x68, 0x02, 0xfb, 0x03, 0x13, 0x2b, 0x60, 0xf3, 0x08,
+  0x27, 0x07, 0x03, 0x05, 0x0f, 0x12, 0x03, 0x46, 0xd5, 0xf8, 0xbf, 0x00,
+  0xc0, 0x02, 0xfb, 0x0c, 0x1c, 0xad, 0x80, 0xc0, 0x3f, 0x43, 0xf8, 0x04,
+  0xcb, 0x7f, 0x1e, 0x11, 0x0d, 0x0f, 0x0f, 0x0e, 0xff, 0xdd, 0xd1, 0xc3,
+  0x6f, 0x33, 0x60, 0x01, 0x23, 0xfb, 0x23, 0x70, 0x81, 0x02, 0x11, 0x29,
+  0x60, 0x31, 0x78, 0xff, 0x01, 0xf0, 0x1f, 0x01, 0x50, 0xf8, 0x21, 0x20,
+  0xdf, 0x32, 0x60, 0x2a, 0x68, 0x40, 0x07, 0x00, 0x30, 0x68, 0xdf, 0x80,
+  0x00, 0x80, 0x08, 0xf2, 0x9b, 0x12, 0x5f, 0xf3, 0xff, 0x6e, 0x3c, 0x0d,
+  0x66, 0x19, 0x00, 0x00, 0xb5, 0xbf, 0x32, 0x38, 0xa1, 0xfb, 0x00, 0x01,
+  0xb1, 0x60, 0x24, 0xff, 0x00, 0x23, 0xf3, 0xf7, 0x2f, 0xfe, 0x80, 0xb2,
+  0xf7, 0x00, 0xbd, 0x10, 0x6b, 0x70, 0x8c, 0x44, 0x61, 0x89, 0xff, 0x00,
+  0x20, 0xc1, 0xf3, 0x81, 0x01, 0x11, 0xb1, 0xff, 0x00, 0xf0, 0x1b, 0xf8,
+  0x28, 0xb9, 0x61, 0x89, 0xef, 0xc1, 0xf3, 0x82, 0x11, 0x0d, 0x01, 0x85,
+  0xf9, 0x88, 0xfe, 0x0d, 0x02, 0x01, 0x11, 0x69, 0xb1, 0xf1, 0xf7, 0x4a,
+  0x7f, 0xf9, 0x21, 0x6c, 0xff, 0xf7, 0xda, 0xff, 0xab, 0x50, 0xff, 0x14,
+  0x08, 0x80, 0x08, 0x20, 0xf4, 0xf7, 0xdc, 0xff, 0xfa, 0xbd, 0xe8, 0x10,
+  0x40, 0xb5, 0xe0, 0x10, 0xf9, 0xbd, 0xe3, 0x51, 0xdf, 0x61, 0xef, 0xf7,
+  0x3b, 0xfe, 0x00, 0xbf, 0x22, 0x03, 0x21, 0x40, 0xf6, 0x84, 0x65, 0x10,
+  0xea, 0x6b, 0xfb, 0x10, 0x8d, 0x10, 0xc6, 0x8d, 0x10, 0xdb, 0xfb, 0x79,
+  0x11, 0x5d, 0x31, 0x09, 0x00, 0xd6, 0xfb, 0x00, 0x09, 0x00, 0x32, 0x09,
+  0x00, 0xd7, 0xd1, 0xfb, 0x33, 0x09, 0x00, 0x33, 0x09, 0x00, 0xcc, 0xfb,
+  0xd7, 0x00, 0xf0, 0x81, 0x1d, 0x40, 0x7a, 0x03, 0x00, 0x73, 0xf8, 0xf5,
+  0x32, 0x15, 0x00, 0x34, 0x15, 0x00, 0xc1, 0xfb, 0x40, 0xf2, 0xff, 0x35,
+  0x65, 0x1b, 0x22, 0x1f, 0x21, 0x28, 0x46, 0xfd, 0xef, 0xd7, 0x60, 0x40,
+  0xf2, 0x36, 0x66, 0x13, 0x21, 0x7e, 0x05, 0x20, 0xfa, 0x40, 0xf2, 0x37,
+  0x6b, 0x0a, 0x09, 0x00, 0xd5, 0x1d, 0x09, 0x00, 0x3a, 0xd1, 0x90, 0x14,
+  0x07, 0x00, 0x3b, 0x69, 0xfe, 0x41, 0xd1, 0x40, 0xf2, 0x39, 0x6a, 0x00,
+  0xf0, 0x60, 0xbe, 0x9f, 0xf0, 0xbc, 0x03, 0x00, 0x78, 0x8d, 0x9f, 0x60,
+  0x40, 0xbf, 0xf2, 0x76, 0x67, 0x00, 0x21, 0x38, 0x41, 0x00, 0x99, 0xfb,
+  0xfb, 0x02, 0x3d, 0x20, 0x5a, 0xf8, 0xe9, 0x4b, 0x00, 0x7b, 0x22, 0x02,
+  0x97, 0x00, 0xd9, 0x70, 0xf6, 0xf7, 0x93, 0x40, 0xfc, 0x07, 0x90, 0x55,
+  0x21, 0x4e, 0xf8, 0x01, 0x24, 0x9d, 0xf8, 0xfb, 0x00, 0x10, 0x29, 0x01,
+  0x84, 0xfb, 0xf1, 0xf7, 0xd7, 0xff, 0xf8, 0xdc, 0x49, 0xc9, 0x6a, 0xff,
+  0xf7, 0x62, 0xdf, 0xff, 0x07, 0x46, 0xf9, 0xb2, 0xbb, 0x03, 0x78, 0xfb,
+  0xcb, 0x39, 0x0a, 0xbb, 0x03, 0x73, 0xc5, 0x02, 0xbb, 0x01, 0x6e, 0xfb,
+  0x2d, 0x61, 0x89, 0x00, 0xcc, 0xf9, 0x8f, 0x01, 0xd5, 0x31, 0xf1, 0xc3,
+  0x00, 0xd5, 0xcc, 0x07, 0x04, 0x17, 0x03, 0x00, 0x10, 0x03, 0x00, 0x09,
+  0xf8, 0xf5, 0x7b, 0x1d, 0x00, 0xbe, 0xfd, 0x50, 0xef, 0xf7, 0x08, 0xfe,
+  0xd5, 0x20, 0x2f, 0x72, 0x11, 0x3f, 0x00, 0x41, 0x3f, 0x00, 0x4e, 0xbb,
+  0xd5, 0x00, 0x8b, 0x00, 0xc8, 0x09, 0x00, 0x49, 0x09, 0x00, 0x40, 0xf2,
+  0x7d, 0x3f, 0x09, 0x00, 0x44, 0xbb, 0x3f, 0x21, 0x50, 0x87, 0x00, 0xb5,
+  0x40, 0x11, 0x00, 0x48, 0x07, 0x00, 0x3c, 0xbb, 0xaf, 0x03, 0xef, 0xb7,
+  0xf7, 0x41, 0xbb, 0x67, 0x71, 0x87, 0xb0, 0x6f, 0x11, 0xef, 0xaf, 0xf7,
+  0x85, 0xfd, 0x10, 0xb9, 0x00, 0xad, 0x61, 0x00, 0xa0, 0xab, 0xf9, 0x10,
+  0x3b, 0x00, 0x4f, 0x3b, 0x00, 0x26, 0x69, 0x10, 0x4f, 0xab, 0xf4, 0xca,
+  0x09, 0x00, 0x21, 0xa3, 0x02, 0x51, 0x09, 0x00, 0x1c, 0xbe, 0x3b, 0x10,
+  0x52, 0x64, 0x33, 0x21, 0x20, 0x4b, 0x00, 0x16, 0xf5, 0xfb, 0x5f, 0x11,
+  0x53, 0x15, 0x00, 0x11, 0xfb, 0x7b, 0x22, 0x75, 0x7f, 0x0b, 0x00, 0x54,
+  0x0b, 0x00, 0x15, 0xfb, 0x01, 0x09, 0x00, 0xf5, 0x55, 0x09, 0x00, 0x06,
+  0x2b, 0x00, 0x56, 0x65, 0x00, 0xf0, 0xff, 0x66, 0xf9, 0x40, 0xf2, 0x57,
+  0x6a, 0x3c, 0x21, 0xff, 0xff, 0xf7, 0xba, 0xff, 0x40, 0xf2, 0x59, 0x6b,
+  0xb7, 0x00, 0xf0, 0x65, 0x11, 0x00, 0x5a, 0x68, 0x79, 0x00, 0xf0, 0xfd,
+  0x5d, 0xdf, 0x00, 0x6d, 0xf8, 0x98, 0x48, 0x97, 0x4f, 0xff, 0x00, 0x78,
+  0x01, 0x90, 0x40, 0xf2, 0x42, 0x69, 0xdf, 0x04, 0xa8, 0xf1, 0xf7, 0x24,
+  0xef, 0x70, 0xf1, 0xf7, 0xff, 0x49, 0xfd, 0x93, 0x48, 0x00, 0x78, 0x00,
+  0x90, 0xbd, 0x02, 0x39, 0x00, 0xa1, 0xff, 0x3b, 0x46, 0x6b, 0x11, 0x48,
+  0x6f, 0x46, 0xf5, 0xf7, 0x8c, 0x49, 0xf0, 0x00, 0x21, 0x27, 0x01, 0xff,
+  0x22, 0xfd, 0x1e, 0xb1, 0xff, 0xf7, 0x92, 0xff, 0xdf, 0x02, 0x26, 0x16,
+  0xe0, 0x02, 0x0f, 0x00, 0x78, 0xff, 0x7d, 0x01, 0xcd, 0x00, 0xf1, 0xf7,
+  0x75, 0xfe, 0x04, 0x33, 0x00, 0x75, 0x87, 0x33, 0x02, 0x04, 0x33, 0x02,
+  0x72, 0xff, 0x10, 0x29, 0x00, 0xef, 0x7d, 0xff, 0x03, 0x26, 0x27, 0x01,
+  0x71, 0xff, 0x00, 0x77, 0xf0, 0x02, 0xf9, 0xab, 0x11, 0x34, 0xf8, 0xff,
+  0xed, 0x04, 0xff, 0xaf, 0xfa, 0x74, 0x4f, 0x39, 0x88, 0xc9, 0xb2, 0x3e,
+  0xf1, 0x03, 0xa8, 0xfa, 0x38, 0x88, 0x01, 0xa1, 0x10, 0xf3, 0x01, 0x37,
+  0xa2, 0xfa, 0x00, 0xef, 0x02, 0x9e, 0xfa, 0x99, 0xd1, 0xc7, 0x01, 0xd5,
+  0x56, 0x3f, 0x00, 0x12, 0x2b, 0x10, 0x01, 0x91, 0x81, 0xf0, 0xfb, 0xfd,
+  0xf8, 0x0f, 0x70, 0xf0, 0x10, 0x01, 0xc9, 0xb2, 0xff, 0xf7, 0xf7, 0x4d,
+  0xff, 0x4d, 0x11, 0x3b, 0xfd, 0x30, 0x46, 0xd5, 0x07, 0x4b, 0x62, 0x3f,
+  0x41, 0x10, 0xcb, 0x43, 0x00, 0x80, 0xba, 0xb6, 0x55, 0x10, 0xf6, 0x82,
+  0xc9, 0x20, 0x85, 0xba, 0xdf, 0x21, 0xfe, 0xff, 0x4f, 0x00, 0x21, 0xef,
+  0xf7, 0xca, 0xfc, 0x00, 0xef, 0xf0, 0xe8, 0xf8, 0x5b, 0xe5, 0x00, 0x8d,
+  0xf8, 0x08, 0x7d, 0x00, 0xeb, 0x21, 0x1a, 0x00, 0xef, 0xf7, 0x6a, 0x67,
+  0x00, 0xeb, 0xd8, 0xf8, 0xe5, 0x21, 0x44, 0x39, 0x00, 0x63, 0xfa, 0x30,
+  0xaa, 0x09, 0x00, 0x45, 0x09, 0x00, 0x5e, 0x17, 0x00, 0xb7, 0xd3, 0x22,
+  0x47, 0x76, 0x0d, 0x00, 0x57, 0xfa, 0xcf, 0x21, 0x4f, 0xf4, 0xc9, 0x0b,
+  0x00, 0xd5, 0x5b, 0x19, 0x00, 0xa5, 0x8f, 0x00, 0x9e, 0xb5, 0x20, 0x4b,
+  0x65, 0xf5, 0x08, 0x93, 0x00, 0xad, 0x09, 0x00, 0x4d, 0x66, 0x00, 0xf0,
+  0x7d, 0xa4, 0x07, 0x00, 0x4e, 0x69, 0xff, 0xf7, 0x00, 0x79, 0x10, 0xd7,
+  0x4c, 0x68, 0x14, 0x19, 0x00, 0xa4, 0xf9, 0x42, 0x7e, 0xf8, 0x7f, 0x40,
+  0xf6, 0x1f, 0x07, 0x00, 0x22, 0xc0, 0xcf, 0x20, 0x1f, 0xf1, 0xf7, 0x0d,
+  0xfc, 0x38, 0x83, 0x00, 0xd9, 0xf0, 0x0f, 0xb2, 0xff, 0xf1, 0xf7, 0xde,
+  0xfb, 0x40, 0xf6, 0x15, 0x0a, 0xf7, 0x20, 0x22, 0x20, 0x3b, 0x20, 0xf1,
+  0xf7, 0xfe, 0xfb, 0xe9, 0x31, 0x87, 0x12, 0x9d, 0x10, 0x6b, 0x5f, 0x10,
+  0xf0, 0x87, 0xf8, 0xdd, 0x2b, 0xf7, 0x20, 0x01, 0x21, 0x58, 0x57, 0x10,
+  0xc6, 0xfe, 0xf7, 0x00, 0x24, 0x10, 0xdf, 0x30, 0x7c, 0xf8, 0x04, 0x24,
+  0x75, 0x00, 0x2f, 0x04, 0xe6, 0x83, 0x30, 0x53, 0xf8, 0x80, 0x65, 0x00,
+  0xf7, 0x4b, 0xf8, 0xc0, 0x61, 0x04, 0xdc, 0xfb, 0x9d, 0xf8, 0xeb, 0x08,
+  0x10, 0xdf, 0x03, 0xfa, 0xf3, 0x10, 0x68, 0xf8, 0xf0, 0xff, 0xf7, 0x43,
+  0xff, 0x16, 0x49, 0x49, 0x6d, 0xff, 0x67, 0xf7, 0xd6, 0xfd, 0x17, 0x33,
+  0xed, 0x01, 0xec, 0xf9, 0x17, 0x31, 0xaa, 0xed, 0x01, 0xe7, 0x25, 0x00,
+  0x40, 0xd3, 0x00, 0x39, 0x03, 0x00, 0x32, 0xad, 0xf8, 0xd3, 0x01, 0x43,
+  0xf8, 0xbf, 0x01, 0x44, 0x13, 0x02, 0xff, 0xd7, 0xf7, 0x97, 0xfe, 0x75,
+  0x11, 0x08, 0x75, 0x10, 0x00, 0xf0, 0xa9, 0x3e, 0xbb, 0x70, 0x63, 0x10,
+  0xfc, 0x0f, 0x31, 0xfe, 0xbf, 0x70, 0x00, 0xd7, 0x00, 0x09, 0x3d, 0xc3,
+  0x71, 0x88, 0x8f, 0x50, 0x76, 0x06, 0xbf, 0x00, 0x46, 0x40, 0x42, 0x0f,
+  0x00, 0xcf, 0x71, 0x42, 0xea, 0x0b, 0x00, 0x1a, 0xc7, 0x70, 0x80, 0xe7,
+  0x00, 0x02, 0x60, 0xf1, 0x9f, 0xf7, 0x91, 0xbb, 0x01, 0x99, 0xf1, 0x11,
+  0xf3, 0x01, 0x64, 0xeb, 0xbb, 0x0a, 0x59, 0x10, 0x4a, 0x79, 0x00, 0xaa,
+  0xb9, 0x13, 0x5a, 0x09, 0x00, 0x49, 0x09, 0x00, 0xa5, 0xb9, 0xf7, 0x21,
+  0x46, 0x09, 0x00, 0x75, 0xa0, 0x09, 0x00, 0x30, 0x03, 0x20, 0x9c, 0xb9,
+  0x0a, 0x43, 0x42, 0x53, 0x98, 0xb9, 0xe5, 0x20, 0x07, 0x00, 0x94, 0x17,
+  0x00, 0x58, 0x07, 0x00, 0x6b, 0x90, 0xb9, 0x35, 0x31, 0x43, 0x29, 0x00,
+  0x8b, 0xb9, 0x1b, 0x11, 0xf7, 0x40, 0xf6, 0x87, 0xeb, 0x10, 0x8f, 0xb9,
+  0x00, 0x00, 0xfe, 0x65, 0x31, 0x00, 0xf1, 0x58, 0x06, 0x83, 0xb0, 0x00,
+  0xff, 0xf1, 0x08, 0x05, 0x30, 0x78, 0x0c, 0x46, 0x60, 0xbf, 0xb1, 0xf1,
+  0x78, 0xb0, 0x78, 0x22, 0x71, 0xc0, 0x84, 0xff, 0xff, 0x30, 0xb9, 0x01,
+  0x20, 0x68, 0x64, 0x28, 0xcf, 0x64, 0xe8, 0x68, 0x40, 0x57, 0xc0, 0x5f,
+  0xe0, 0x2c, 0xc4, 0xff, 0xf1, 0x00, 0x0b, 0x4f, 0xf0, 0x82, 0x40, 0x4f,
+  0xff, 0xf0, 0x01, 0x0a, 0x04, 0xd5, 0x0a, 0xfa, 0x0b, 0x9f, 0xf1, 0x01,
+  0x60, 0x00, 0x21, 0x11, 0x90, 0xfd, 0xb0, 0x0a, 0xff, 0xfa, 0x04, 0xf1,
+  0x41, 0x60, 0x68, 0x6c, 0x00, 0xff, 0x28, 0x71, 0xd1, 0x70, 0x78, 0x00,
+  0x21, 0xf1, 0xff, 0xf7, 0x2f, 0xf8, 0x00, 0x28, 0x5f, 0xd1, 0x6a, 0xef,
+  0x46, 0x01, 0xa9, 0x20, 0x65, 0x10, 0x75, 0xf8, 0xd6, 0xff, 0xe9, 0x02,
+  0x23, 0x01, 0x98, 0x12, 0xeb, 0x00, 0xff, 0x08, 0x43, 0xeb, 0xe0, 0x79,
+  0xc6, 0xe9, 0x02, 0xff, 0x89, 0xd6, 0xe9, 0x04, 0x23, 0x00, 0x98, 0xc1,
+  0xff, 0x17, 0x10, 0x18, 0x59, 0x41, 0xc6, 0xe9, 0x04, 0xff, 0x01, 0x72,
+  0x68, 0x52, 0x1c, 0x72, 0x60, 0x2b, 0xff, 0x68, 0x5b, 0x88, 0x9a, 0x42,
+  0xd9, 0xd3, 0x6f, 0xff, 0x68, 0x00, 0x2c, 0x1d, 0xd4, 0xa3, 0x46, 0x77,
+  0xfd, 0xb1, 0xcb, 0x51, 0x27, 0xfb, 0x07, 0xeb, 0x8b, 0x01, 0xfb, 0x00,
+  0x23, 0x31, 0xf1, 0x40, 0x46, 0x72, 0x68, 0x49, 0xff, 0x46, 0xf3, 0xf7,
+  0x1d, 0xfb, 0x47, 0xf8, 0x2b, 0xbf, 0x00, 0xac, 0x61, 0xc5, 0xe9, 0x08,
+  0x4b, 0x01, 0x01, 0xbf, 0xc5, 0xe9, 0x0a, 0x01, 0xe8, 0x6c, 0x97, 0x01,
+  0x88, 0x3f, 0x43, 0xe8, 0x64, 0x1a, 0xe0, 0x6f, 0x39, 0x00, 0x35, 0x00,
+  0xff, 0x07, 0xf3, 0xf7, 0x08, 0xfb, 0xc7, 0xf8, 0x20, 0xf9, 0x01, 0x37,
+  0x03, 0x4d, 0x01, 0x00, 0xfb, 0x38, 0x66, 0xec, 0xba, 0x37, 0x00, 0x0c,
+  0x37, 0x04, 0x0e, 0x01, 0xa8, 0x37, 0x04, 0xa8, 0xd5, 0x64, 0x90, 0xc0,
+  0x60, 0x8d, 0x00, 0x00, 0xa1, 0x00, 0x00, 0x0b, 0xff, 0xe0, 0x01, 0x28,
+  0x08, 0xbf, 0x68, 0x64, 0x07, 0xff, 0xd0, 0xe8, 0x68, 0xc5, 0xf8, 0x44,
+  0xa0, 0x40, 0xff, 0xf0, 0x04, 0x00, 0xc5, 0xf8, 0x40, 0xa0, 0xe8, 0xfa,
+  0x2b, 0xe0, 0xf7, 0x0d, 0xc0, 0xfe, 0x4f, 0x04, 0x46, 0xdf, 0x5f, 0xf8,
+  0x90, 0x13, 0x20, 0x78, 0x63, 0x60, 0x53, 0x75, 0x30, 0xfd, 0x00, 0x81,
+  0xc1, 0x60, 0x61, 0x60, 0x78, 0x01, 0x28, 0xff, 0x04, 0xd1, 0xd1, 0xe9,
+  0x08, 0x6b, 0x2b, 0x6c, 0xff, 0xaa, 0x69, 0x03, 0xe0, 0xd1, 0xe9, 0x06,
+  0x6b, 0xff, 0xeb, 0x6a, 0x6a, 0x6b, 0xa1, 0x68, 0x0f, 0x88, 0xeb, 0x39,
+  0x0a, 0xfd, 0xc0, 0x0a, 0x57, 0x01, 0x4f, 0xf0, 0x00, 0xff, 0x0a, 0x09,
+  0xd0, 0x00, 0x21, 0x8b, 0x45, 0xd5, 0xff, 0x48, 0x05, 0xd8, 0x86, 0x42,
+  0x3c, 0xbf, 0xba, 0x7a, 0x49, 0xa0, 0x4f, 0x1d, 0x00, 0x4f, 0xf6, 0xff,
+  0x40, 0x25, 0x80, 0xff, 0xea, 0x0a, 0x20, 0xad, 0xf8, 0x0a, 0x00, 0x28,
+  0xff, 0x68, 0xb0, 0xeb, 0x83, 0x0f, 0x39, 0xd3, 0x60, 0x7f, 0x68, 0x01,
+  0x89, 0xad, 0xf8, 0x04, 0x10, 0x7f, 0x10, 0xdb, 0x09, 0x40, 0x09, 0x00,
+  0x06, 0x00, 0x41, 0x00, 0x0c, 0x01, 0xff, 0xa8, 0x4f, 0xf4, 0x7a, 0x78,
+  0x30, 0xf8, 0x1c, 0xff, 0x50, 0xa8, 0x05, 0x80, 0x0d, 0xb3, 0xfb, 0xf8,
+  0xff, 0xf8, 0xc5, 0xf3, 0x81, 0x21, 0x08, 0xfb, 0x00, 0xf7, 0xf7, 0x21,
+  0xb9, 0x19, 0x00, 0x70, 0xb7, 0xfb, 0xf0, 0xff, 0xf0, 0x07, 0xe0, 0x01,
+  0x29, 0x05, 0xd1, 0xbc, 0xff, 0x48, 0xa0, 0xfb, 0x07, 0x01, 0xc0, 0x0f,
+  0x40, 0xff, 0xea, 0x41, 0x00, 0xb0, 0xf5, 0x80, 0x6f, 0x02, 0xff, 0xd3,
+  0xc4, 0xf8, 0x14, 0x90, 0x64, 0xe1, 0x05, 0xff, 0xf4, 0x70, 0x41, 0x08,
+  0x43, 0x01, 0xa9, 0x40, 0xff, 0xf4, 0x00, 0x60, 0x21, 0xf8, 0x1c, 0x00,
+  0x0c, 0xff, 0xf1, 0x01, 0x0c, 0xbc, 0xf1, 0x02, 0x0f, 0xd1, 0xf7, 0xd3,
+  0x01, 0xe0, 0x61, 0x00, 0x09, 0x19, 0x46, 0x10, 0xfe, 0xe3, 0xf0, 0x88,
+  0xf9, 0x05, 0x28, 0x38, 0xbf, 0x04, 0xed, 0x20, 0x41, 0x20, 0x1c, 0x01,
+  0xd5, 0x30, 0x61, 0x68, 0x0a, 0xff, 0x68, 0x49, 0x68, 0x40, 0x1e, 0x02,
+  0x40, 0x08, 0xff, 0x40, 0xa1, 0x78, 0xa2, 0x61, 0x22, 0x65, 0xe0, 0xff,
+  0x61, 0x60, 0x65, 0x00, 0x29, 0x18, 0xbf, 0x01, 0xff, 0x29, 0x04, 0xf1,
+  0x58, 0x00, 0x28, 0xd1, 0x01, 0xfe, 0x45, 0x90, 0xa1, 0x78, 0x01, 0x29,
+  0x08, 0xbf, 0x04, 0xfd, 0x21, 0x41, 0xb0, 0x99, 0x00, 0x29, 0x0c, 0xbf,
+  0x01, 0xff, 0x21, 0x02, 0x21, 0xc1, 0x70, 0x61, 0x78, 0x09, 0xff, 0xb9,
+  0x81, 0x70, 0x1a, 0xe0, 0x01, 0x21, 0x81, 0xef, 0x70, 0x02, 0x21, 0x41,
+  0x3f, 0xe0, 0xa1, 0x64, 0xc0, 0xff, 0xe9, 0x02, 0x11, 0xc0, 0xe9, 0x04,
+  0x11, 0x41, 0x6f, 0x60, 0x30, 0x46, 0x59, 0x31, 0x20, 0x90, 0xfc, 0x79,
+  0x41, 0xff, 0x04, 0xf1, 0x7a, 0x06, 0xdf, 0xf8, 0x3c, 0x82, 0xff, 0x40,
+  0xf6, 0x41, 0x4b, 0x21, 0xe0, 0x61, 0x78, 0xff, 0x00, 0x29, 0xe6, 0xd1,
+  0x00, 0x99, 0xe5, 0xe7, 0xbf, 0xef, 0xf7, 0x24, 0xf8, 0xf1, 0x78, 0x3b,
+  0x70, 0x40, 0x3f, 0xef, 0xf7, 0x1f, 0xf8, 0x31, 0x79, 0x37, 0x70, 0x09,
+  0x00, 0xd7, 0x1a, 0xf8, 0xb1, 0x13, 0x00, 0x33, 0x09, 0x00, 0x15, 0xf8,
+  0xe5, 0x71, 0x09, 0x00, 0x2e, 0x09, 0x00, 0x9b, 0x61, 0x08, 0xf9, 0xef,
+  0xfb, 0xf7, 0x2a, 0x89, 0x32, 0xbb, 0xfa, 0xa1, 0x6c, 0x20, 0xff, 0x6d,
+  0x00, 0x29, 0x40, 0xf0, 0xe2, 0x80, 0x00, 0xff, 0x28, 0x04, 0xbf, 0x60,
+  0x6d, 0x00, 0x28, 0x00, 0xff, 0xf0, 0xe1, 0x80, 0x00, 0x20, 0xe0, 0x64,
+  0xef, 0xfb, 0xf7, 0x4f, 0xd7, 0x00, 0xf2, 0xf8, 0xef, 0xf7, 0x27, 0xfb,
+  0xf8, 0x73, 0x57, 0x40, 0x30, 0x70, 0x04, 0xf1, 0x70, 0xdf, 0x00, 0xf1,
+  0xf7, 0x9a, 0xfc, 0xcf, 0x11, 0x0c, 0xbf, 0xff, 0x02, 0x21, 0x03, 0x21,
+  0x00, 0x98, 0xc0, 0xb2, 0x3f, 0xf1, 0xf7, 0x92, 0xfb, 0x00, 0x98, 0x35,
+  0x41, 0x0b, 0x01, 0xfb, 0x5a, 0xfc, 0x59, 0x41, 0x5f, 0xfc, 0x00, 0x98,
+  0x03, 0xd5, 0x21, 0x0f, 0x01, 0x6d, 0x09, 0x00, 0x3f, 0x09, 0x02, 0x73,
+  0xfc, 0xbd, 0xf1, 0x09, 0x80, 0xf1, 0xf7, 0xb8, 0xfb, 0x3f, 0x01, 0x0b,
+  0x7f, 0xd1, 0x60, 0x68, 0x00, 0x7d, 0x20, 0xb1, 0x77, 0x41, 0xfd, 0x58,
+  0x31, 0x00, 0xa0, 0xf9, 0xff, 0x20, 0x60, 0x74, 0xdf, 0x04, 0x20, 0x5f,
+  0xe0, 0x98, 0xc1, 0x70, 0x70, 0x70, 0xff, 0x98, 0xf8, 0x05, 0x00, 0xb0,
+  0x70, 0x00, 0xf0, 0x7b, 0xfc, 0x01, 0xc1, 0x01, 0xee, 0xf7, 0xb4, 0xff,
+  0x47, 0x30, 0xeb, 0xf0, 0xf0, 0x0d, 0x00, 0x2e, 0x0d, 0x00, 0xad, 0xff,
+  0x98, 0xef, 0xf8, 0x07, 0x00, 0xf0, 0x25, 0x00, 0x08, 0x00, 0x30, 0xfd,
+  0x71, 0xcb, 0x90, 0xf7, 0x20, 0xfc, 0x00, 0x23, 0x99, 0xff, 0x42, 0x4a,
+  0x4a, 0x05, 0xd8, 0x90, 0x42, 0x03, 0xff, 0xd2, 0x49, 0x48, 0x90, 0xf9,
+  0x1d, 0x50, 0x02, 0xdb, 0xe0, 0x47, 0x07, 0x00, 0x24, 0x50, 0x69, 0x00,
+  0x99, 0x00, 0xbf, 0x7d, 0xc9, 0xb9, 0x20, 0xb1, 0x0c, 0x35, 0xa0, 0x58,
+  0xff, 0x46, 0xee, 0xf7, 0x97, 0xff, 0xf0, 0x78, 0x60, 0xdf, 0x74, 0xff,
+  0x27, 0xf9, 0xb2, 0x05, 0x11, 0x39, 0xf8, 0xbf, 0x85, 0x42, 0x06, 0xdb,
+  0x67, 0x74, 0xdb, 0x41, 0x35, 0xfe, 0x5d, 0x00, 0x7e, 0xff, 0x01, 0xe0,
+  0x7f, 0x1e, 0xf0, 0xff, 0xd5, 0x00, 0x20, 0x18, 0xe0, 0x20, 0xb1, 0x30,
+  0x7b, 0x22, 0x30, 0x33, 0x02, 0x7d, 0xff, 0x30, 0x79, 0x33, 0x03, 0x55,
+  0x01, 0x33, 0x00, 0x1f, 0x33, 0x08, 0x36, 0x33, 0x00, 0x64, 0x33, 0x04,
+  0xfe, 0x1b, 0x01, 0x0a, 0xf8, 0x20, 0x74, 0x60, 0x68, 0xf0, 0xfa, 0xcb,
+  0xc0, 0xbd, 0xaf, 0x20, 0xf0, 0xf7, 0xc4, 0xfd, 0xb9, 0xbf, 0xf1, 0x00,
+  0x0f, 0x06, 0xd0, 0xbd, 0x13, 0xe0, 0x24, 0xef, 0x49, 0x08, 0x80, 0xbd,
+  0xab, 0x20, 0x48, 0x80, 0x01, 0xff, 0x25, 0x07, 0xe0, 0x60, 0x6d, 0xe8,
+  0x40, 0xc0, 0xf7, 0x07, 0x08, 0xd5, 0x83, 0xc1, 0xff, 0xf7, 0xbe, 0xfd,
+  0xfd, 0xe0, 0x31, 0x40, 0xf4, 0xd0, 0xe0, 0x6c, 0x40, 0xb9, 0xbd, 0x20,
+  0x19, 0x02, 0x04, 0xd5, 0x69, 0x42, 0x19, 0x01, 0xb1, 0xff, 0xfd, 0xf4,
+  0xe7, 0x6d, 0x1c, 0x18, 0x2d, 0xee, 0x5f, 0xd3, 0xf0, 0xf7, 0x01, 0xfe,
+  0x87, 0x13, 0xe3, 0x47, 0x10, 0xfe, 0x09, 0xa0, 0x28, 0x58, 0x46, 0x7f,
+  0xf4, 0xff, 0xae, 0xbf, 0xf1, 0xf7, 0xd8, 0xf8, 0x11, 0xe7, 0xc3, 0x15,
+  0x01, 0x7f, 0xd1, 0x01, 0x20, 0x00, 0xe0, 0x00, 0x20, 0x65, 0x51, 0xef,
+  0xf8, 0xf1, 0x00, 0x20, 0x63, 0x51, 0x00, 0x9c, 0xe4, 0xff, 0xa6, 0x98,
+  0x6e, 0x12, 0x83, 0x2e, 0x04, 0x00, 0xff, 0x46, 0x41, 0x0c, 0x00, 0x46,
+  0x00, 0x28, 0x6b, 0xf3, 0xee, 0xd8, 0x17, 0x00, 0x69, 0xc0, 0x41, 0x02,
+  0x22, 0x04, 0xff, 0xf1, 0x78, 0x01, 0x0f, 0xf2, 0x1c, 0x00, 0x70, 0xbd,
+  0x47, 0xb3, 0x23, 0x05, 0xd1, 0x01, 0x00, 0x07, 0x00, 0x21, 0xed, 0x08,
+  0xfd, 0x40, 0xbe, 0xbc, 0x15, 0x00, 0x00, 0x82, 0x01, 0xd7, 0x0b, 0x02,
+  0x38, 0x13, 0xc0, 0x0d, 0xad, 0x10, 0xae, 0xfc, 0x7f, 0x20, 0x68, 0xf1,
+  0xf7, 0xa7, 0xfc, 0x28, 0xc7, 0x50, 0xbf, 0x32, 0x40, 0xf1, 0xf7, 0xad,
+  0xbc, 0x3d, 0x50, 0x41, 0xfd, 0x0d, 0x49, 0xb0, 0x00, 0x26, 0x05, 0xf5,
+  0x98, 0x77, 0xff, 0x05, 0xf5, 0x90, 0x78, 0x64, 0x42, 0x28, 0x68, 0x7d,
+  0x21, 0xf3, 0x50, 0x7a, 0xfa, 0xf1, 0xf7, 0x48, 0xfb, 0x10, 0xff, 0x60,
+  0xfc, 0x08, 0xb1, 0x04, 0x26, 0x17, 0xe0, 0xf7, 0xf9, 0x68, 0xa8, 0x3b,
+  0x00, 0x10, 0xfe, 0xa8, 0x68, 0xfd, 0x41, 0xe3, 0xd0, 0xa1, 0xfa, 0x69,
+  0x68, 0xdf, 0xf8, 0xff, 0x44, 0x04, 0xf2, 0xf7, 0x6f, 0xfd, 0x01, 0x46,
+  0xff, 0x38, 0x68, 0xf2, 0xf7, 0x73, 0xfe, 0xe1, 0xd8, 0xbf, 0x28, 0x68,
+  0x05, 0xf5, 0x9a, 0x72, 0x1f, 0x01, 0x32, 0xbb, 0xfb, 0xa8, 0xed, 0x90,
+  0x8b, 0xfa, 0x30, 0x69, 0x00, 0xf0, 0xfd, 0x81, 0x6f, 0xa1, 0x04, 0x46,
+  0x80, 0x25, 0xb4, 0xf9, 0xbf, 0x18, 0x61, 0x31, 0x00, 0x48, 0xbf, 0xe5,
+  0xf0, 0x29, 0xfe, 0x37, 0x41, 0x4f, 0xf0, 0x04, 0x08, 0x04, 0xda, 0x00,
+  0xff, 0x2e, 0x46, 0xbf, 0x75, 0x42, 0x2d, 0xb2, 0x35, 0xff, 0x46, 0x77,
+  0x1b, 0x3f, 0xb2, 0xd1, 0x46, 0x5f, 0xff, 0xea, 0xc9, 0x70, 0x52, 0xbf,
+  0x07, 0xeb, 0x45, 0xef, 0x07, 0x3f, 0xb2, 0xa7, 0x05, 0x00, 0x20, 0x68,
+  0x3a, 0x7d, 0xb2, 0x8b, 0x51, 0xb2, 0xfb, 0x21, 0x46, 0x40, 0x55, 0x10,
+  0xff, 0xa5, 0xff, 0x5f, 0xea, 0x00, 0x0b, 0x16, 0xd1, 0xf7, 0x04, 0xf5,
+  0x8c, 0x73, 0x30, 0xc2, 0x69, 0x10, 0x46, 0xff, 0xf2, 0xf7, 0x1a, 0xfd,
+  0x38, 0xbf, 0x82, 0xf0, 0x5f, 0x00, 0x42, 0x50, 0x46, 0x11, 0x0d, 0x00,
+  0x13, 0x0d, 0x00, 0xff, 0x92, 0x46, 0x09, 0xf1, 0x01, 0x09, 0xb9, 0xf1,
+  0xfd, 0x04, 0x8b, 0x40, 0x00, 0x08, 0xd4, 0xd3, 0x20, 0x68, 0x7d, 0x32,
+  0xd5, 0x80, 0xf1, 0xf7, 0x8f, 0xfb, 0xbb, 0xd5, 0x10, 0x77, 0x14, 0xd1,
+  0x28, 0x27, 0x00, 0x69, 0xfb, 0x51, 0x05, 0x00, 0xff, 0x80, 0xfb, 0xdf,
+  0x49, 0xf2, 0xf7, 0xf9, 0xfc, 0x7f, 0x38, 0xbf, 0x08, 0x46, 0x04, 0xd3,
+  0xdd, 0x0b, 0x00, 0xff, 0x0d, 0xfe, 0x98, 0xbf, 0xdc, 0x48, 0x01, 0x46,
+  0x9d, 0x20, 0xc3, 0x00, 0xc4, 0xfa, 0x58, 0x05, 0xa2, 0x29, 0x10, 0x47,
+  0xbf, 0x05, 0x46, 0x8a, 0x46, 0x17, 0x46, 0x4d, 0x41, 0x4f, 0xff, 0xf0,
+  0x06, 0x08, 0x05, 0xf5, 0x8e, 0x74, 0x38, 0xff, 0x68, 0x41, 0x42, 0x39,
+  0x60, 0x09, 0xb2, 0x28, 0xbe, 0x29, 0x00, 0xe1, 0xf9, 0xf1, 0xf7, 0xaf,
+  0x29, 0x30, 0xc7, 0xf7, 0xfb, 0x10, 0xb1, 0xd9, 0x00, 0x09, 0x28, 0xe0,
+  0x21, 0x9d, 0x6a, 0x33, 0x11, 0x76, 0xfd, 0x39, 0x3b, 0x10, 0x5b, 0x10,
+  0x72, 0xfe, 0xff, 0xa0, 0xfb, 0x21, 0x68, 0x08, 0x1a, 0x20, 0x60, 0xff,
+  0x81, 0x11, 0x00, 0xeb, 0x51, 0x60, 0x46, 0x02, 0xff, 0x36, 0x14, 0x30,
+  0x46, 0x48, 0xbf, 0x40, 0x42, 0xff, 0x7f, 0x28, 0x04, 0xdb, 0x01, 0x2e,
+  0xac, 0xbf, 0x7f, 0x7f, 0x26, 0x6f, 0xf0, 0x7e, 0x06, 0x28, 0xab, 0x00,
+  0xf5, 0x02, 0xab, 0x00, 0x39, 0x45, 0x12, 0xe8, 0xf9, 0xb8, 0xf1, 0xff,
+  0x01, 0x08, 0xc9, 0xd1, 0xaa, 0xf8, 0x00, 0x61, 0xf5, 0x48, 0x4f, 0x11,
+  0x87, 0xf3, 0x61, 0x04, 0x46, 0x8f, 0xb0, 0xff, 0x20, 0x68, 0x02, 0x90,
+  0x88, 0x46, 0xf9, 0xf7, 0xff, 0xa1, 0xfb, 0xb2, 0x4a, 0x06, 0x90, 0xd2,
+  0xe9, 0xbf, 0x08, 0x01, 0x27, 0x69, 0xb0, 0x4a, 0x1b, 0x61, 0x14, 0xff,
+  0xf8, 0x39, 0x8b, 0x00, 0x26, 0x80, 0xb2, 0x88, 0xff, 0x42, 0x34, 0xbf,
+  0xb8, 0x7c, 0xb8, 0x7e, 0x8d, 0xfe, 0xc3, 0x20, 0xaa, 0x49, 0xb7, 0xf9,
+  0x0e, 0x00, 0x81, 0xfc, 0x5b, 0xc0, 0xcd, 0x80, 0xf9, 0x05, 0x90, 0x04,
+  0xf5, 0x8a, 0xff, 0x77, 0x02, 0x98, 0xc0, 0xf1, 0x01, 0x00, 0x38, 0x7b,
+  0x70, 0xc0, 0xf1, 0x10, 0x86, 0xfc, 0x78, 0x80, 0xad, 0xa3, 0xff, 0x2e,
+  0xf8, 0x3a, 0x78, 0x79, 0x88, 0x04, 0xf1, 0x7f, 0x14, 0x00, 0x00, 0xf0,
+  0xfa, 0xfb, 0x38, 0xc1, 0x30, 0xef, 0x50, 0xfc, 0x20, 0xb1, 0x19, 0x01,
+  0x7e, 0xf8, 0x05, 0xff, 0x20, 0x22, 0xe1, 0x02, 0x98, 0x0b, 0xa9, 0xf1,
+  0xff, 0xf7, 0xb0, 0xfd, 0x40, 0xf2, 0xee, 0x20, 0xb8, 0x7f, 0x80, 0xfe,
+  0x80, 0xbe, 0x60, 0x02, 0x98, 0x5d, 0x20, 0xfb, 0xfa, 0xa0, 0xad, 0x00,
+  0x91, 0xf9, 0x02, 0x98, 0x09, 0xff, 0xa9, 0xf2, 0xf7, 0xef, 0xfe, 0xdd,
+  0xe9, 0x09, 0xff, 0x01, 0xcd, 0xe9, 0x07, 0x01, 0x8d, 0xf8, 0x1e, 0xff,
+  0x60, 0x07, 0xaa, 0x02, 0x98, 0x02, 0x21, 0xf2, 0xff, 0xf7, 0x1b, 0xff,
+  0xe2, 0x68, 0x12, 0x78, 0x02, 0xff, 0x99, 0x20, 0x69, 0x52, 0x1e, 0x12,
+  0x04, 0x02, 0xff, 0xf4, 0xfe, 0x02, 0x42, 0xea, 0x81, 0x71, 0x9d, 0xff,
+  0xf8, 0x04, 0x20, 0xd2, 0x05, 0x02, 0xf0, 0x7e, 0xff, 0x52, 0x11, 0x43,
+  0x82, 0x7d, 0xd2, 0x03, 0x02, 0xff, 0xf4, 0x00, 0x42, 0x11, 0x43, 0x02,
+  0x7d, 0x02, 0xff, 0xf0, 0x07, 0x02, 0x11, 0x43, 0x41, 0xf0, 0x00, 0xff,
+  0x41, 0x41, 0xf4, 0x80, 0x41, 0x04, 0x91, 0x85, 0xff, 0x78, 0x00, 0xe0,
+  0x6d, 0x1c, 0x20, 0x69, 0xc1, 0xff, 0x78, 0xa9, 0x42, 0xc0, 0xf0, 0x83,
+  0x80, 0x28, 0xff, 0x18, 0x01, 0x79, 0x03, 0x91, 0x06, 0x99, 0x03, 0xff,
+  0x29, 0x07, 0xd1, 0x03, 0x98, 0x1b, 0x28, 0x34, 0xef, 0xbf, 0xc0, 0xf1,
+  0x64, 0x9b, 0x10, 0x32, 0x09, 0x01, 0xff, 0xe0, 0x90, 0xf8, 0x1b, 0x90,
+  0x03, 0x9a, 0x02, 0xff, 0x98, 0x5f, 0xfa, 0x89, 0xf1, 0xf2, 0xf7, 0x16,
+  0xfd, 0xff, 0x63, 0x00, 0x10, 0x04, 0xa8, 0xff, 0xf7, 0x79, 0xff, 0xfe,
+  0xb8, 0x62, 0xe0, 0x68, 0x40, 0x78, 0xf1, 0x7f, 0xf7, 0x46, 0xfb, 0x01,
+  0x2d, 0x03, 0xd1, 0xa7, 0x31, 0xf7, 0xaf, 0xfe, 0x06, 0xd5, 0x10, 0x04,
+  0x0a, 0x86, 0xbb, 0xff, 0x21, 0x46, 0x04, 0x20, 0xff, 0xf7, 0x74, 0xfe,
+  0x7f, 0x06, 0x00, 0x2a, 0xd1, 0x78, 0x6a, 0x5e, 0x0b, 0x20, 0xff, 0xff,
+  0xfb, 0x78, 0x62, 0x5c, 0x49, 0x38, 0x6a, 0xff, 0xf2, 0xf7, 0xfa, 0xfb,
+  0x83, 0x46, 0xf8, 0x88, 0xde, 0x83, 0x70, 0xb0, 0x00, 0x90, 0x78, 0x0f,
+  0x00, 0x5e, 0xfc, 0xff, 0x00, 0x99, 0x40, 0x18, 0xf8, 0x80, 0xb8, 0x88,
+  0xd7, 0x00, 0x90, 0x58, 0x47, 0x20, 0x56, 0x0f, 0x00, 0x42, 0x18, 0xbf,
+  0xba, 0x80, 0x12, 0xb2, 0x02, 0x98, 0x69, 0x21, 0x5a, 0xff, 0xfa, 0xb7,
+  0xf9, 0x06, 0x20, 0x02, 0x98, 0x01, 0xfe, 0x0b, 0x00, 0x54, 0xfa, 0xba,
+  0xf1, 0x01, 0x0a, 0xcf, 0xff, 0xd1, 0x00, 0xe0, 0x3e, 0xbb, 0x20, 0x69,
+  0xb9, 0xff, 0x88, 0x28, 0x18, 0x04, 0x2d, 0x00, 0x79, 0x28, 0xff, 0xf8,
+  0x10, 0x10, 0x08, 0xeb, 0x40, 0x00, 0xf9, 0xff, 0x88, 0xa0, 0xf8, 0x80,
+  0x10, 0x91, 0xd2, 0x0f, 0xff, 0xf2, 0x0c, 0x10, 0x28, 0x5c, 0x03, 0x9a,
+  0x00, 0xff, 0xeb, 0x09, 0x01, 0x02, 0x98, 0xd2, 0xb2, 0xc9, 0x9f, 0xb2,
+  0xf2, 0xf7, 0xb9, 0xfe, 0xb9, 0x00, 0xdc, 0x30, 0xc9, 0x75, 0xb2, 0xbd,
+  0x01, 0x1a, 0xbd, 0x00, 0x05, 0xaa, 0x41, 0x77, 0x42, 0xbd, 0xb6, 0xa5,
+  0x00, 0x3f, 0xf4, 0x77, 0xaf, 0xe1, 0xb1, 0x20, 0xff, 0x69, 0x80, 0x78,
+  0x45, 0x1c, 0x10, 0xe0, 0x28, 0xff, 0x18, 0x90, 0xf8, 0x04, 0x90, 0x90,
+  0xf8, 0x05, 0xef, 0xa0, 0x52, 0x46, 0x49, 0x2d, 0x30, 0x00, 0xf0, 0xc2,
+  0xdd, 0xfa, 0x09, 0x01, 0x08, 0xf1, 0x80, 0xcb, 0x10, 0xbc, 0xfa, 0xfe,
+  0x3d, 0x13, 0x8d, 0x42, 0xea, 0xd3, 0x81, 0x78, 0x09, 0xff, 0x18, 0x00,
+  0x22, 0x49, 0x79, 0x0c, 0xe0, 0x38, 0xff, 0xf8, 0x11, 0x30, 0x28, 0xf8,
+  0x12, 0x30, 0x08, 0xff, 0xeb, 0x42, 0x05, 0x08, 0xeb, 0x41, 0x03, 0x52,
+  0xbf, 0x1c, 0xb3, 0xf8, 0x80, 0x30, 0xa5, 0x03, 0x00, 0x8a, 0xff, 0x42,
+  0xf0, 0xdb, 0xc1, 0x78, 0x08, 0x18, 0x00, 0xf7, 0x79, 0x41, 0x1c, 0x27,
+  0x01, 0x10, 0x20, 0x28, 0xf8, 0xf3, 0x11, 0x20, 0x23, 0x01, 0xb5, 0x00,
+  0x02, 0x49, 0x1c, 0xb2, 0xef, 0xf8, 0x80, 0x20, 0xa3, 0x03, 0x00, 0x40,
+  0x29, 0xf0, 0x6d, 0xdb, 0xf5, 0x13, 0x14, 0xfe, 0x1b, 0x23, 0xb8, 0xfc,
+  0x41, 0x27, 0xff, 0xff, 0xfa, 0x08, 0xb1, 0x06, 0xb9, 0x05, 0x26, 0xff,
+  0x00, 0x20, 0xee, 0xf7, 0x5e, 0xff, 0x02, 0x98, 0xea, 0x1f, 0x41, 0x27,
+  0x19, 0x40, 0x0f, 0xc1, 0xb2, 0xb7, 0x43, 0xba, 0xff, 0x51, 0xcd, 0xcc,
+  0xcc, 0x3e, 0x01, 0x00, 0x20, 0xe3, 0x40, 0x00, 0x03, 0x00, 0xf7, 0x41,
+  0x4f, 0xa1, 0x66, 0x66, 0x26, 0xdf, 0x3f, 0x00, 0x00, 0x0a, 0x1c, 0x73,
+  0xd1, 0x44, 0x60, 0x3f, 0xee, 0xf7, 0x8f, 0xbc, 0x80, 0xb5, 0x57, 0xa1,
+  0x0b, 0x01, 0xff, 0x89, 0xfc, 0xbd, 0xe8, 0x02, 0x40, 0x28, 0x20, 0xbf,
+  0xf2, 0xf7, 0xb6, 0xb8, 0x70, 0xb5, 0xbf, 0x41, 0x2e, 0xbf, 0x12, 0x00,
+  0x2c, 0x0c, 0xbf, 0x31, 0xe1, 0x30, 0xc9, 0xff, 0xb2, 0x40, 0xf6, 0xcb,
+  0x10, 0xee, 0xf7, 0x77, 0xd5, 0xfc, 0x11, 0x01, 0x29, 0x11, 0x04, 0xcc,
+  0x11, 0x00, 0x6e, 0xfc, 0x5f, 0x04, 0xb9, 0x00, 0x26, 0xf1, 0x0d, 0x00,
+  0xcd, 0x0d, 0x00, 0xad, 0x67, 0x0d, 0x01, 0x25, 0xe9, 0x0d, 0x00, 0xce,
+  0x0d, 0x00, 0x60, 0xfe, 0x51, 0x00, 0x70, 0x40, 0xcd, 0xe7, 0x31, 0xb1,
+  0xc9, 0xff, 0x03, 0xc0, 0x22, 0x91, 0xfb, 0xf2, 0xf1, 0xc1, 0xff, 0xf5,
+  0x80, 0x31, 0xd0, 0xe7, 0x70, 0x47, 0x10, 0xfe, 0x3b, 0x50, 0x1b, 0x04,
+  0x43, 0xea, 0x12, 0x41, 0x10, 0xff, 0x04, 0x0d, 0x4a, 0x52, 0x69, 0x00,
+  0x23, 0xf2, 0xcf, 0xf7, 0x43, 0xfe, 0xc0, 0x1d, 0x00, 0x0d, 0xb1, 0x10,
+  0x40, 0xff, 0xbe, 0xe7, 0x10, 0xb5, 0x4f, 0xf4, 0xc0, 0x74, 0x7f, 0xa4,
+  0xfb, 0x00, 0x23, 0x10, 0x46, 0x05, 0x21, 0x00, 0x5f, 0x04, 0xfb, 0x01,
+  0x33, 0x19, 0xa1, 0x90, 0xf2, 0xbb, 0xf0, 0xeb, 0x00, 0xb2, 0x71, 0xf0,
+  0x00, 0xc7, 0x51, 0xef, 0xf3, 0x11, 0xff, 0x80, 0x60, 0x21, 0x81, 0xf3,
+  0x11, 0x88, 0x70, 0xbf, 0x47, 0x50, 0x21, 0xee, 0xf7, 0xe9, 0x1f, 0xe1,
+  0x41, 0xff, 0x00, 0xf1, 0x34, 0x05, 0x0c, 0x46, 0xd5, 0xf8, 0x6f, 0x04,
+  0x80, 0xaf, 0x68, 0x43, 0x41, 0x98, 0xf9, 0x7b, 0xd0, 0xae, 0x43, 0x30,
+  0x01, 0x46, 0x30, 0x51, 0x20, 0xb1, 0x0d, 0x00, 0x31, 0xee, 0x07, 0x00,
+  0xbd, 0xfa, 0xba, 0x89, 0x20, 0xc2, 0xfb, 0x4c, 0xfb, 0xd8, 0xe8, 0x23,
+  0x00, 0x86, 0xf9, 0x80, 0x46, 0x68, 0xaa, 0x43, 0xf0, 0x7f, 0x25, 0x00,
+  0x40, 0x1d, 0x00, 0x9e, 0xc9, 0xb0, 0x48, 0xbf, 0xf8, 0x20, 0x60, 0x29,
+  0x69, 0x68, 0x87, 0x50, 0xa7, 0x3f, 0xfa, 0x07, 0x46, 0xa9, 0x69, 0xa8,
+  0x09, 0x00, 0x57, 0xd0, 0xfe, 0xe7, 0xc0, 0x00, 0xf0, 0x3a, 0xf8, 0x60,
+  0x60, 0x69, 0xab, 0x69, 0x28, 0x11, 0x00, 0x99, 0x1b, 0x00, 0xe9, 0x8b,
+  0x40, 0xf2, 0xeb, 0xf7, 0x94, 0x1b, 0x00, 0xca, 0x1b, 0x00, 0x2c, 0xf8,
+  0xa0, 0xab, 0x60, 0xa9, 0x1b, 0x02, 0x8b, 0x1b, 0x00, 0x29, 0x37, 0x02,
+  0x86, 0xfa, 0x1b, 0x00, 0xbc, 0x1b, 0x00, 0x1e, 0xf8, 0xe0, 0x60, 0x66,
+  0xdf, 0x68, 0x27, 0x68, 0x29, 0x68, 0x57, 0x01, 0xdf, 0xf9, 0x9d, 0x05,
+  0x99, 0x00, 0x44, 0xf9, 0x07, 0x99, 0x00, 0x93, 0x01, 0x73, 0xeb, 0xfa,
+  0x39, 0x05, 0x00, 0xd4, 0x7b, 0x00, 0xa3, 0xf8, 0x20, 0x77, 0x61, 0x05,
+  0xe0, 0x0d, 0x11, 0xf0, 0x41, 0x14, 0xd9, 0x00, 0xf3, 0x7c, 0xbb, 0xf3,
+  0x51, 0x23, 0x01, 0xd3, 0xb8, 0x30, 0xb5, 0x7f, 0x0c, 0x46, 0x15, 0x46,
+  0x85, 0xb0, 0x29, 0xaf, 0x20, 0xb7, 0x87, 0xff, 0x69, 0xb7, 0x22, 0x83,
+  0xff, 0xe9, 0x00, 0x99, 0xff, 0xf2, 0xf7, 0x42, 0xf9, 0x28, 0x60, 0x01,
+  0x99, 0x7e, 0x5b, 0x01, 0x3d, 0xf9, 0x68, 0x60, 0x02, 0x99, 0x7b, 0x01,
+  0x7f, 0x38, 0xf9, 0xa8, 0x60, 0x03, 0x99, 0xe8, 0x09, 0x00, 0xb7, 0x33,
+  0xf9, 0xe8, 0xd1, 0x00, 0x04, 0x98, 0xc7, 0x00, 0xf9, 0xbf, 0x28, 0x61,
+  0x05, 0xb0, 0x30, 0xbd, 0x89, 0x11, 0x79, 0xff, 0x48, 0xf2, 0xf7, 0x36,
+  0xfa, 0x78, 0x49, 0x41, 0xdf, 0xf8, 0x24, 0x00, 0x10, 0xbd, 0x07, 0x51,
+  0x82, 0x46, 0xff, 0x83, 0xb0, 0x0f, 0x46, 0x14, 0x46, 0x01, 0x20, 0xff,
+  0xf7, 0xf7, 0xf9, 0xff, 0x3d, 0x68, 0x7e, 0x68, 0xff, 0xd7, 0xf8, 0x08,
+  0xb0, 0xff, 0x68, 0x80, 0x46, 0xf7, 0x89, 0x46, 0x28, 0xb1, 0x00, 0x54,
+  0xf8, 0x00, 0x90, 0xed, 0x31, 0x4d, 0x12, 0x1a, 0xfa, 0x75, 0x01, 0x7b,
+  0xf9, 0x01, 0xf7, 0x90, 0x59, 0x46, 0xaf, 0x31, 0x12, 0xfa, 0x00, 0x90,
+  0x57, 0x39, 0x46, 0x38, 0x09, 0x00, 0x0d, 0x19, 0x02, 0x6e, 0x4f, 0x10,
+  0xfd, 0x01, 0x6f, 0x00, 0x78, 0xf8, 0xf2, 0xf7, 0xaa, 0xf9, 0xf5, 0x60,
+  0x71, 0x10, 0x65, 0x05, 0x02, 0xfe, 0xf9, 0x60, 0x60, 0xc9, 0x59, 0x4b,
+  0x00, 0x23, 0x60, 0xf9, 0x31, 0x01, 0x4b, 0x01, 0xf4, 0xf9, 0x52, 0x31,
+  0x01, 0x55, 0x0f, 0x02, 0x19, 0x01, 0xec, 0x17, 0x12, 0x59, 0x09, 0x00,
+  0xbe, 0x57, 0xd1, 0x1d, 0xf8, 0x01, 0x46, 0x00, 0x49, 0x00, 0x53, 0xff,
+  0xf8, 0x4e, 0x49, 0x51, 0xf8, 0x2a, 0x10, 0xf2, 0xeb, 0xf7, 0xdc, 0x3d,
+  0x10, 0x40, 0x87, 0x30, 0xf2, 0xf7, 0x0b, 0xcb, 0xf8, 0x4c, 0x53, 0x00,
+  0x46, 0x21, 0x00, 0x37, 0x01, 0x42, 0xf8, 0x5f, 0x80, 0xf0, 0x00, 0x40,
+  0x20, 0x89, 0xb2, 0x29, 0x0f, 0x00, 0xf3, 0xc8, 0xb9, 0x4d, 0x70, 0x07,
+  0x00, 0xb4, 0xb8, 0x2d, 0xe9, 0xff, 0xf2, 0x4f, 0x82, 0xb0, 0xd7, 0x68,
+  0xd2, 0xf8, 0xbf, 0x00, 0x80, 0x95, 0x68, 0x56, 0x68, 0x29, 0x20, 0x04,
+  0xee, 0xcf, 0x31, 0x84, 0xf8, 0x81, 0x69, 0x00, 0xff, 0xf7, 0xe8, 0xaf,
+  0xff, 0x01, 0x46, 0x48, 0x29, 0x00, 0x9f, 0x0f, 0x00, 0x20, 0xff, 0x69,
+  0x01, 0x90, 0x38, 0x46, 0xd4, 0xf8, 0x0c, 0xdd, 0xa0, 0xcf, 0x61, 0xa6,
+  0xf9, 0x83, 0xc7, 0x00, 0xff, 0xf7, 0x69, 0xd7, 0x21, 0x00, 0xe7, 0x01,
+  0x8e, 0xcb, 0x10, 0x62, 0xf8, 0x13, 0x01, 0x2e, 0x17, 0xe1, 0x00, 0x90,
+  0x51, 0xc1, 0x02, 0x93, 0xed, 0x00, 0xa3, 0x01, 0xfd, 0x7f, 0x1d, 0x00,
+  0x53, 0xf8, 0x82, 0x46, 0xa0, 0x69, 0x75, 0x00, 0x43, 0x00, 0x64, 0x57,
+  0x20, 0x4f, 0xf8, 0x07, 0x19, 0x00, 0x7f, 0xff, 0xf7, 0xb7, 0xff, 0xff,
+  0xf7, 0xb8, 0x89, 0xf0, 0x53, 0x44, 0xf8, 0xf9, 0x10, 0x3b, 0x00, 0x4a,
+  0x17, 0x00, 0x30, 0x81, 0x00, 0x75, 0x3f, 0x1d, 0xe0, 0xac, 0x17, 0x00,
+  0x38, 0xf8, 0x04, 0x61, 0x12, 0x67, 0x37, 0xf8, 0x06, 0x67, 0x00, 0x79,
+  0x01, 0x69, 0xf9, 0xf5, 0x11, 0x55, 0xca, 0x0f, 0x00, 0x28, 0x0f, 0x02,
+  0x61, 0xf5, 0x00, 0x58, 0x21, 0x00, 0xd5, 0x26, 0xed, 0x04, 0x49, 0x07,
+  0x00, 0x30, 0x87, 0x80, 0xc7, 0xff, 0xbb, 0x04, 0x46, 0x31, 0x61, 0xa9,
+  0xff, 0x0a, 0x0b, 0x10, 0x4e, 0xd6, 0x31, 0x10, 0x15, 0xf8, 0xf3, 0x80,
+  0x4f, 0xf7, 0x00, 0xb9, 0x00, 0xff, 0x24, 0x74, 0x49, 0x00, 0xcc, 0x6e,
+  0x46, 0x7c, 0xfd, 0xb8, 0xfb, 0x80, 0x00, 0x80, 0xbf, 0x00, 0xff, 0x7f,
+  0xff, 0x47, 0x28, 0x6b, 0x6e, 0x4e, 0x00, 0x30, 0x81, 0xbb, 0x45, 0x49,
+  0x3b, 0x00, 0xa9, 0xbf, 0x21, 0x49, 0x00, 0x34, 0x77, 0xb9, 0x38, 0x46,
+  0x7f, 0x21, 0x30, 0xb9, 0x41, 0x05, 0x00, 0x77, 0x2d, 0xb9, 0xf8, 0xe1,
+  0x82, 0xff, 0xf7, 0x4c, 0xc9, 0x50, 0xfd, 0x20, 0xf5, 0x90, 0xe0, 0xfb,
+  0x07, 0x46, 0x35, 0xf9, 0xdf, 0x17, 0x20, 0x00, 0x21, 0x20, 0x09, 0x90,
+  0x95, 0xff, 0xff, 0x05, 0xeb, 0x47, 0x00, 0x01, 0x21, 0xb0, 0xf9, 0xfb,
+  0x80, 0x20, 0x0f, 0x01, 0x8d, 0xff, 0x00, 0x20, 0x85, 0x6f, 0xf8, 0x02,
+  0x01, 0x86, 0x8d, 0x30, 0xf1, 0xbd, 0x3b, 0x03, 0x77, 0x17, 0x46, 0x1e,
+  0x3f, 0x00, 0x2c, 0xfe, 0x06, 0x24, 0x30, 0xff, 0x44, 0xbf, 0x0a, 0x88,
+  0x25, 0xf8, 0x16, 0x20, 0xfd, 0xba, 0xc9, 0x90, 0x49, 0x88, 0x05, 0xeb,
+  0x46, 0x02, 0xe5, 0xa2, 0x9f, 0x50, 0x80, 0x2d, 0x00, 0xf1, 0x91, 0xbd,
+  0xe8, 0xf4, 0xd7, 0x40, 0xc6, 0xe7, 0x35, 0x03, 0x16, 0x33, 0x00, 0x12,
+  0xfe, 0xfd, 0x07, 0x73, 0x02, 0xa6, 0xfb, 0xa9, 0x19, 0x91, 0xf8, 0x7f,
+  0x02, 0x21, 0x01, 0x2a, 0x18, 0xbf, 0x40, 0xd5, 0x10, 0xd7, 0x01, 0x22,
+  0x81, 0x0d, 0x00, 0x87, 0x35, 0x00, 0xf2, 0xbd, 0xff, 0xf0, 0xb5, 0x30,
+  0xf9, 0x11, 0x30, 0x30, 0xf9, 0xff, 0x12, 0x40, 0x4d, 0x1c, 0x09, 0xe0,
+  0xe6, 0x1a, 0xff, 0x6f, 0x1a, 0x7e, 0x43, 0x57, 0x1a, 0x96, 0xfb, 0xff,
+  0xf7, 0xf6, 0x9e, 0x19, 0x20, 0xf8, 0x15, 0x60, 0x7f, 0x6d, 0x1c, 0x95,
+  0x42, 0xf3, 0xdb, 0xf0, 0x2b, 0x40, 0xee, 0x15, 0x41, 0x05, 0x46, 0x0f,
+  0x59, 0x00, 0x98, 0x46, 0x00, 0xef, 0x24, 0xef, 0xf7, 0xe8, 0x7f, 0x90,
+  0x02, 0x24, 0x0d, 0xff, 0xe0, 0x05, 0xf1, 0x8c, 0x40, 0x07, 0xea, 0x06,
+  0xff, 0x01, 0x00, 0x78, 0x38, 0x40, 0x88, 0x42, 0x05, 0xfb, 0xd0, 0x40,
+  0x0b, 0x10, 0xa3, 0xfe, 0x00, 0x28, 0xed, 0x57, 0xd0, 0x01, 0x24, 0x7b,
+  0x32, 0x81, 0x87, 0x41, 0x7a, 0x55, 0xb0, 0xff, 0xf1, 0xf7, 0x7f, 0xfe,
+  0x00, 0x23, 0x00, 0x22, 0x8d, 0x40, 0x25, 0xf0, 0xff, 0x50, 0xff, 0xf0,
+  0x6d, 0x10, 0x15, 0x01, 0x04, 0x7f, 0xfe, 0x01, 0x2c, 0x16, 0xbf, 0x03,
+  0x2c, 0x63, 0xa0, 0xe3, 0x20, 0x10, 0x4d, 0x30, 0xd9, 0xc0, 0xe9, 0x30,
+  0x40, 0xf0, 0x80, 0xfb, 0x04, 0xe1, 0x05, 0x50, 0xff, 0x50, 0xee, 0xf7,
+  0xdd, 0x3f, 0xf9, 0x44, 0xf0, 0x40, 0x00, 0xc0, 0xb3, 0x40, 0x85, 0x01,
+  0xf7, 0x04, 0x46, 0x88, 0x33, 0xd0, 0xff, 0xf7, 0xea, 0xff, 0xdf, 0x00,
+  0x27, 0x00, 0x26, 0x12, 0x97, 0xa0, 0x24, 0xf8, 0xaf, 0x16, 0x00, 0x00,
+  0x25, 0x11, 0x21, 0x47, 0x59, 0xc0, 0x34, 0xff, 0xf8, 0x16, 0x10, 0xa8,
+  0x40, 0x7f, 0x1c, 0x08, 0xf7, 0x43, 0x08, 0x35, 0x19, 0x01, 0x09, 0x2d,
+  0xf1, 0xd3, 0x3f, 0x76, 0x1c, 0x46, 0x45, 0xea, 0xd3, 0x09, 0x41, 0xd9,
+  0xf0, 0x96, 0x53, 0x02, 0xb3, 0xb9, 0xfd, 0x91, 0x80, 0x39, 0x90, 0x4b,
+  0x01, 0xc4, 0x3f, 0xff, 0x00, 0x26, 0x00, 0x27, 0x83, 0xd9, 0x00, 0x1d,
+  0x00, 0xf7, 0x59, 0x16, 0xe0, 0x4d, 0x01, 0x1d, 0xf8, 0x38, 0xf9, 0xff,
+  0x14, 0x00, 0x28, 0x41, 0xc1, 0xb2, 0x4f, 0xf4, 0xdd, 0x60, 0xdd, 0x50,
+  0x9a, 0xf9, 0x59, 0xd9, 0x20, 0xee, 0xf7, 0x77, 0x96, 0xf9, 0xff, 0xb9,
+  0x10, 0x7f, 0x1c, 0x06, 0x5f, 0x00, 0xff, 0x09, 0x2d, 0xea, 0xd3, 0x64,
+  0x1c, 0x54, 0x45, 0x6f, 0xe6, 0xd3, 0x00, 0x21, 0x1b, 0x01, 0x88, 0xf9,
+  0x59, 0xa1, 0x5b, 0xf2, 0x8f, 0xc7, 0xb0, 0xf6, 0x01, 0x33, 0x00, 0x80,
+  0x65, 0x00, 0xde, 0xb1, 0x01, 0xff, 0xf7, 0x93, 0xff, 0x01, 0x21, 0x00,
+  0xf0, 0xf7, 0x1f, 0xf8, 0x44, 0xab, 0x00, 0xa4, 0xb2, 0x00, 0x27, 0xfe,
+  0x69, 0x00, 0x58, 0x0e, 0xe0, 0xff, 0xf7, 0xe9, 0xff, 0xa8, 0x4b, 0x61,
+  0x61, 0x01, 0xa7, 0x21, 0x40, 0x45, 0x00, 0x65, 0x61, 0x00, 0x64, 0xff,
+  0xff, 0x05, 0x43, 0x7f, 0x1c, 0xa7, 0x42, 0xee, 0xec, 0x59, 0x00, 0x13,
+  0x01, 0x5b, 0xf9, 0x1d, 0xb1, 0xf0, 0x81, 0x18, 0xff, 0x21, 0x04, 0x28,
+  0x0e, 0x4a, 0x12, 0xd8, 0xdf, 0xff, 0xe8, 0x00, 0xf0, 0x03, 0x03, 0x09,
+  0x09, 0x0d, 0xfb, 0x00, 0x0c, 0xf3, 0x00, 0x40, 0x09, 0x40, 0x1c, 0x00,
+  0xfd, 0x01, 0x15, 0x60, 0x78, 0xc0, 0xf3, 0x41, 0x10, 0x06, 0xed, 0xe0,
+  0x07, 0x02, 0x00, 0x02, 0x07, 0x02, 0xc1, 0x00, 0x40, 0xf7, 0x1c, 0x48,
+  0x43, 0x73, 0xb1, 0x00, 0x0e, 0x00, 0x46, 0x3d, 0x10, 0xaf, 0xb0, 0x10,
+  0x09, 0x00, 0x46, 0xf7, 0x59, 0x43, 0xa1, 0xdf, 0xad, 0xf5, 0x08, 0x7d,
+  0x04, 0x43, 0xa1, 0x08, 0xdf, 0xf7, 0xf8, 0xbc, 0x93, 0x6f, 0x91, 0xee,
+  0xf7, 0x76, 0xfb, 0xf7, 0x20, 0x88, 0x01, 0x35, 0x70, 0xbf, 0xf8, 0xa2,
+  0x69, 0xbf, 0x12, 0x78, 0x21, 0x88, 0xa0, 0x68, 0x1d, 0x99, 0xa2, 0xbd,
+  0x78, 0x1b, 0x95, 0x42, 0x78, 0x00, 0x79, 0x1d, 0x95, 0x00, 0xdf, 0xf0,
+  0x07, 0x00, 0x08, 0x43, 0x67, 0x21, 0x40, 0xf4, 0xff, 0x80, 0x40, 0xf0,
+  0xf7, 0xbc, 0xfe, 0xa0, 0x69, 0xbf, 0x40, 0x78, 0xf0, 0xf7, 0xdb, 0xfe,
+  0xad, 0x10, 0x25, 0xff, 0x04, 0xeb, 0x85, 0x00, 0x06, 0x69, 0x6d, 0xb1,
+  0xff, 0x00, 0x2f, 0x02, 0xbf, 0xe0, 0x69, 0x00, 0x68, 0xcf, 0x00, 0x28,
+  0x4b, 0xd1, 0x63, 0x00, 0xd1, 0xd0, 0xf0, 0xf7, 0xf7, 0xb5, 0xfd, 0x02,
+  0x0d, 0x20, 0x19, 0xfd, 0x00, 0xf0, 0xff, 0x18, 0xf9, 0x0f, 0xfa, 0x80,
+  0xfa, 0x30, 0x6b, 0xff, 0x82, 0x45, 0x18, 0xd0, 0x04, 0xa8, 0x31, 0x46,
+  0xff, 0x50, 0x22, 0xf4, 0xf7, 0x01, 0xff, 0x30, 0x46, 0x6f, 0x06, 0xf1,
+  0x50, 0x01, 0x0b, 0x01, 0xfb, 0xfe, 0x09, 0x00, 0xb7, 0x00, 0x04, 0xa9,
+  0x0b, 0x01, 0xf5, 0xfe, 0x27, 0x01, 0x04, 0xfd, 0xd0, 0x7b, 0x41, 0x9f,
+  0xfc, 0xc6, 0xf8, 0x30, 0xa0, 0xff, 0xf0, 0xf7, 0x38, 0xfe, 0xf0, 0xf7,
+  0x50, 0xfe, 0xff, 0x02, 0x28, 0x06, 0xd1, 0xe0, 0x69, 0x81, 0x8a, 0xff,
+  0x09, 0x04, 0x41, 0xf0, 0x01, 0x01, 0x01, 0x60, 0xff, 0x02, 0xe0, 0x01,
+  0x28, 0x08, 0xbf, 0x01, 0x27, 0xfc, 0xb9, 0xa0, 0x09, 0x40, 0x17, 0xb9,
+  0xef, 0xf7, 0x86, 0xfb, 0xff, 0x00, 0xe0, 0x01, 0x20, 0x36, 0xb2, 0x40,
+  0xea, 0xff, 0xd6, 0x77, 0x18, 0xa8, 0xe0, 0x21, 0x01, 0xfb, 0xfd, 0x05,
+  0x5f, 0xd0, 0xca, 0xfe, 0x6d, 0x1c, 0x02, 0x2d, 0x7f, 0xa9, 0xd3, 0x01,
+  0xa8, 0xf1, 0xf7, 0x95, 0xd7, 0xe0, 0xef, 0xee, 0xf7, 0x4f, 0xfb, 0xab,
+  0x03, 0x4a, 0xd1, 0x00, 0xef, 0x2f, 0x42, 0xd1, 0xa0, 0xcd, 0x00, 0x5c,
+  0xfe, 0x02, 0xff, 0x46, 0xa0, 0x68, 0x62, 0x64, 0xc1, 0x68, 0x18, 0xff,
+  0xa8, 0xf0, 0xf7, 0xdf, 0xff, 0x98, 0xb3, 0x62, 0xdf, 0x6c, 0x20, 0x69,
+  0x18, 0xa9, 0xc5, 0x00, 0xfe, 0x62, 0xef, 0x6c, 0x60, 0x69, 0x50, 0x09,
+  0x00, 0xb0, 0xfe, 0x61, 0xff, 0x69, 0x20, 0x69, 0x04, 0xf1, 0x28, 0x02,
+  0xff, 0xdf, 0xf7, 0xc7, 0xfc, 0xa0, 0x6b, 0x25, 0x41, 0x24, 0xff, 0xff,
+  0x05, 0x46, 0x61, 0x68, 0x97, 0x48, 0xf1, 0xf7, 0x75, 0x1f, 0x05, 0x50,
+  0x28, 0x11, 0x00, 0x8d, 0xfd, 0x80, 0xb9, 0x00, 0xff, 0x38, 0xff, 0x07,
+  0x46, 0xe0, 0x69, 0xc1, 0x8a, 0xef, 0x49, 0x1c, 0xc1, 0x82, 0x8f, 0x53,
+  0x17, 0xf8, 0x98, 0xdf, 0xbf, 0x64, 0x20, 0x02, 0xd9, 0xa7, 0xb0, 0xff,
+  0x80, 0xdf, 0xb2, 0xe1, 0x69, 0x48, 0x60, 0xb1, 0x31, 0x03, 0xe0, 0xff,
+  0xa0, 0x68, 0x80, 0x68, 0xed, 0xf7, 0xba, 0xfd, 0xfe, 0x25, 0x01, 0xf1,
+  0xf7, 0xea, 0xfe, 0xff, 0xf4, 0x29, 0xd5, 0xaf, 0x9d, 0x03, 0x72, 0x49,
+  0x10, 0x03, 0x79, 0xd0, 0x24, 0x01, 0xff, 0xf0, 0xf7, 0x37, 0xfe, 0xb4,
+  0xf9, 0x24, 0x60, 0xdf, 0xb4, 0xf9, 0x26, 0x90, 0x20, 0xed, 0x80, 0x3c,
+  0x02, 0xfe, 0x85, 0x00, 0x01, 0xff, 0xf7, 0xb3, 0xfc, 0x27, 0x6c, 0xfd,
+  0x38, 0x6d, 0xc2, 0xce, 0xfe, 0x38, 0xbf, 0x87, 0xf0, 0x7f, 0x00, 0x47,
+  0xe0, 0x6b, 0xf1, 0xf7, 0xc8, 0x0b, 0x00, 0xfa, 0xed, 0x51, 0x39, 0x4f,
+  0x00, 0x38, 0xfe, 0xf8, 0xf7, 0xb4, 0xef, 0xfd, 0x05, 0x46, 0x21, 0x99,
+  0x30, 0x00, 0xf0, 0x59, 0x7b, 0xf8, 0x21, 0xbf, 0x60, 0x00, 0xf0, 0x55,
+  0xf8, 0x49, 0x00, 0xff, 0x00, 0xb0, 0xf5, 0x00, 0x5f, 0xa8, 0xbf, 0x41,
+  0xbf, 0xf6, 0xff, 0x70, 0x03, 0xda, 0x10, 0x0b, 0x00, 0x01, 0x9f, 0xda,
+  0x66, 0x48, 0xe0, 0x84, 0x67, 0x00, 0x19, 0x00, 0x80, 0xff, 0x6f, 0xa8,
+  0xbf, 0x40, 0xf2, 0xff, 0x30, 0x02, 0xb9, 0xda, 0x2d, 0xe0, 0xe9, 0xe0,
+  0xa0, 0x84, 0xff, 0x63, 0x00, 0x07, 0xbd, 0x46, 0x37, 0x01, 0x48, 0x45,
+  0x04, 0xbf, 0x25, 0x02, 0x42, 0xfb, 0x13, 0xd0, 0x9d, 0x00, 0x00, 0x00,
+  0x90, 0x03, 0x22, 0xff, 0x60, 0x69, 0x03, 0x6b, 0xe1, 0x68, 0x20, 0x88,
+  0xff, 0xff, 0xf7, 0x8c, 0xfd, 0x22, 0x88, 0x20, 0x6a, 0xff, 0x01, 0x21,
+  0x91, 0x40, 0x08, 0x43, 0x20, 0x62, 0xff, 0xe0, 0x69, 0x01, 0x69, 0x49,
+  0x1c, 0x01, 0x61, 0xbb, 0x64, 0x20, 0xf1, 0x01, 0xe0, 0x69, 0x85, 0x03,
+  0x00, 0xc1, 0xb9, 0x68, 0x15, 0x10, 0x07, 0x01, 0x8a, 0x01, 0x83, 0x03,
+  0x11, 0x20, 0xbf, 0x69, 0xff, 0xf7, 0xaa, 0xfb, 0x60, 0x05, 0x00, 0xa7,
+  0xd3, 0xfb, 0x0d, 0xb5, 0x20, 0x79, 0xc1, 0xe2, 0x4b, 0x00, 0x00, 0x21,
+  0xd7, 0xff, 0xf7, 0x80, 0x21, 0x42, 0x8e, 0x0d, 0x10, 0xb0, 0x7c, 0xff,
+  0x07, 0xbf, 0xcd, 0x6b, 0x01, 0xf1, 0x24, 0x04, 0xff, 0x0d, 0x6c, 0x01,
+  0xf1, 0x26, 0x04, 0x80, 0xb1, 0xfc, 0x13, 0x60, 0xf9, 0x00, 0x6b, 0xff,
+  0x38, 0xbf, 0x4f, 0xf0, 0xff, 0x7c, 0x50, 0x04, 0xd3, 0xf1, 0xf7, 0x4b,
+  0xfe, 0x7f, 0x05, 0xd2, 0x4f, 0xf0, 0x3f, 0x40, 0x29, 0xf9, 0x00, 0xfd,
+  0xbb, 0xf5, 0x00, 0x36, 0x7c, 0x27, 0x88, 0x30, 0x09, 0x7d, 0xf1, 0x27,
+  0x10, 0x80, 0x46, 0x06, 0xf0, 0x0f, 0x15, 0xf0, 0x7b, 0xa4, 0xfc, 0xcb,
+  0x81, 0xf1, 0xf7, 0xba, 0xfc, 0x23, 0x01, 0xfb, 0x45, 0xfe, 0x49, 0xd0,
+  0xfe, 0xc0, 0x19, 0x20, 0x80, 0x62, 0x89, 0x31, 0xfe, 0xe1, 0x90, 0x51,
+  0x60, 0x6b, 0x00, 0x41, 0xd0, 0x2f, 0x33, 0x5f, 0xde, 0xf9, 0x30, 0x88,
+  0x69, 0xc7, 0x50, 0x27, 0x49, 0x80, 0xff, 0xc0, 0xf3, 0x07, 0x20, 0xc0,
+  0xb1, 0x95, 0xf9, 0xff, 0x01, 0x00, 0x1e, 0x49, 0x01, 0xfb, 0x00, 0xf4,
+  0xf7, 0x30, 0x88, 0x02, 0xe5, 0x22, 0x23, 0xfb, 0x30, 0x88, 0xff, 0x1a,
+  0x49, 0x00, 0x28, 0x14, 0xbf, 0x02, 0x20, 0xff, 0x01, 0x20, 0xd1, 0xe9,
+  0x08, 0x67, 0x32, 0x19, 0xdf, 0x47, 0xeb, 0xe4, 0x73, 0xf8, 0x3d, 0xa0,
+  0xf8, 0xf7, 0xff, 0x64, 0xfc, 0x14, 0x48, 0x04, 0x78, 0x40, 0xf6, 0xde,
+  0x8b, 0xa0, 0x22, 0xc0, 0x21, 0x30, 0x4b, 0x00, 0x3b, 0xf9, 0xff, 0x01,
+  0x20, 0x68, 0x60, 0x28, 0x68, 0x18, 0xb1, 0x7e, 0xff, 0xc0, 0xfa, 0x00,
+  0x28, 0xf9, 0xd0, 0x00, 0x0f, 0x00, 0x7d, 0x21, 0xaf, 0x60, 0xf0, 0xf7,
+  0x06, 0xf9, 0x68, 0x05, 0x00, 0xfd, 0x43, 0x35, 0x60, 0xee, 0xf7, 0xfd,
+  0xf9, 0x00, 0x20, 0xbd, 0xfe, 0xa7, 0x50, 0x00, 0x00, 0xc8, 0x42, 0xbb,
+  0xa1, 0x00, 0x87, 0xe0, 0xff, 0xff, 0xaf, 0xa1, 0xb7, 0xa1, 0x9f, 0xf1,
+  0xe3, 0x31, 0xc0, 0xfe, 0x5b, 0x00, 0x45, 0x78, 0x86, 0x78, 0xc7, 0x78,
+  0x90, 0xff, 0xf8, 0x08, 0x80, 0x90, 0xf8, 0x09, 0x90, 0xbd, 0xbf, 0x48,
+  0x00, 0x6a, 0xf1, 0xf7, 0x3b, 0xe5, 0x00, 0xbb, 0xbe, 0x93, 0x20, 0x47,
+  0xfc, 0x82, 0x46, 0x07, 0xf7, 0x00, 0x06, 0x7d, 0xeb, 0x97, 0x51, 0x30,
+  0xfc, 0x06, 0x46, 0x09, 0x0d, 0x00, 0xa5, 0x08, 0x0d, 0x02, 0x29, 0x23,
+  0x00, 0x23, 0x71, 0x35, 0x15, 0x00, 0x04, 0xfb, 0xeb, 0x05, 0x11, 0x00,
+  0x16, 0xfc, 0x4f, 0xf0, 0x76, 0xed, 0x51, 0x1b, 0x10, 0xfd, 0x31, 0x17,
+  0x00, 0xb7, 0xfd, 0x51, 0xfe, 0x05, 0x00, 0xb4, 0xfd, 0xf1, 0xf7, 0x1e,
+  0xfe, 0x80, 0xff, 0xf3, 0x09, 0x04, 0xa0, 0x05, 0x01, 0x0e, 0x40, 0xff,
+  0xf6, 0xad, 0x10, 0xed, 0xf7, 0xfe, 0xfe, 0x04, 0xf7, 0xf0, 0x03, 0x01,
+  0x31, 0x10, 0x47, 0x40, 0xf6, 0xae, 0xfe, 0x0f, 0x00, 0xf6, 0xbe, 0x10,
+  0xb5, 0xf1, 0xf7, 0x11, 0xf6, 0x3d, 0x00, 0x81, 0x44, 0x33, 0x71, 0x11,
+  0xf8, 0x4f, 0xf0, 0x7d, 0x7e, 0x47, 0x00, 0xfa, 0xfc, 0x01, 0x21, 0xf8,
+  0x23, 0x60, 0x7f, 0x9a, 0x49, 0xf1, 0xf7, 0x90, 0xfd, 0x99, 0x05, 0x00,
+  0x6b, 0xf1, 0xfc, 0x05, 0x01, 0xfc, 0xbb, 0xe0, 0xf4, 0xfd, 0xfd, 0x54,
+  0x73, 0x4f, 0x0d, 0xb5, 0x90, 0x6d, 0x13, 0x27, 0xf9, 0x92, 0xf9, 0x40,
+  0xff, 0x00, 0x24, 0xc0, 0x07, 0x00, 0xf1, 0x0c, 0x81, 0xff, 0x8a, 0x4f,
+  0x97, 0xf8, 0x10, 0x80, 0xb8, 0xf1, 0xff, 0x03, 0x0f, 0xa8, 0xbf, 0x03,
+  0x24, 0x80, 0xf2, 0xff, 0x03, 0x81, 0x0f, 0xf2, 0x68, 0x21, 0x4c, 0xc9,
+  0xff, 0x02, 0xa8, 0x40, 0xf2, 0x01, 0x1a, 0x4c, 0xc0, 0xdd, 0x78, 0xe7,
+  0x00, 0xc7, 0xfb, 0x87, 0x4f, 0x00, 0xd4, 0xfb, 0xdf, 0x06, 0x46, 0x86,
+  0x48, 0x00, 0xf9, 0x20, 0xbf, 0xfb, 0xff, 0x81, 0x46, 0x02, 0xa8, 0x84,
+  0x49, 0x50, 0xf8, 0xed, 0x28, 0xeb, 0x10, 0x56, 0xfd, 0xb9, 0x81, 0xf1,
+  0xf7, 0xc4, 0x7f, 0xfb, 0x80, 0x46, 0xb8, 0x7a, 0x7f, 0x49, 0x5f, 0x50,
+  0x5e, 0xab, 0x20, 0x40, 0xf2, 0xca, 0x2b, 0x01, 0x21, 0x47, 0xe5, 0x02,
+  0x7f, 0x32, 0xfd, 0x81, 0x46, 0x28, 0xbf, 0xb1, 0x27, 0x00, 0xef, 0xff,
+  0xf7, 0x9c, 0xff, 0xbd, 0xe1, 0x4f, 0xf0, 0x7d, 0x75, 0x51, 0x35, 0x01,
+  0x37, 0x1f, 0x00, 0xff, 0xf7, 0x92, 0xc7, 0x30, 0xef, 0x4f, 0xf0, 0x88,
+  0x41, 0x11, 0x01, 0x2e, 0xfd, 0x41, 0xaa, 0x05, 0x00, 0x9d, 0xbd, 0x00,
+  0x95, 0xe3, 0x30, 0x6c, 0xab, 0x00, 0x05, 0xff, 0xf5, 0x80, 0x79, 0x89,
+  0xf8, 0x00, 0x00, 0x6a, 0xbe, 0x0b, 0x00, 0x89, 0xf8, 0x01, 0x00, 0x69,
+  0x07, 0x02, 0x02, 0xff, 0x00, 0x00, 0x98, 0x80, 0x01, 0x40, 0xf0, 0x11,
+  0xff, 0x01, 0xc9, 0xb2, 0x50, 0x46, 0xed, 0xf7, 0x66, 0xff, 0xfe, 0x64,
+  0x48, 0x00, 0x57, 0x06, 0x28, 0x0c, 0x77, 0xbf, 0x01, 0x21, 0x19, 0x61,
+  0x11, 0x60, 0xed, 0x6f, 0x40, 0x75, 0x6e, 0xb7, 0x60, 0xc1, 0x3d, 0x10,
+  0x57, 0xfe, 0x03, 0x09, 0x00, 0xd5, 0xc2, 0x09, 0x00, 0x52, 0x09, 0x02,
+  0xac, 0x09, 0x00, 0x4d, 0xfe, 0xf7, 0x12, 0x21, 0x58, 0x39, 0x00, 0x49,
+  0xfe, 0x30, 0x46, 0xfd, 0x56, 0xe1, 0x00, 0xdf, 0xfc, 0x34, 0xbf, 0x02,
+  0x26, 0x7f, 0x01, 0x26, 0x31, 0x46, 0x4f, 0xf4, 0x1a, 0x3d, 0x00, 0x5b,
+  0x3d, 0xfe, 0x57, 0x60, 0xf6, 0xa1, 0x29, 0x00, 0x38, 0xb5, 0xd1, 0xef,
+  0x10, 0x40, 0xf6, 0xc3, 0x0b, 0x00, 0x32, 0xfe, 0x39, 0xba, 0x15, 0x00,
+  0xc4, 0x09, 0x00, 0x2d, 0xfe, 0x3c, 0x49, 0x00, 0xc5, 0xfe, 0x09, 0x00,
+  0x28, 0xfe, 0x5f, 0xfa, 0x88, 0xf1, 0x40, 0x5b, 0xf6, 0xc6, 0x0b, 0x00,
+  0x22, 0xfe, 0x2b, 0x71, 0xa4, 0x09, 0x00, 0x55, 0x1d, 0x09, 0x02, 0xa5,
+  0x09, 0x00, 0x18, 0x09, 0x02, 0xa8, 0x09, 0x00, 0xf5, 0x13, 0x09, 0x02,
+  0xa9, 0x09, 0x00, 0x0e, 0xfe, 0x00, 0x26, 0xfe, 0x25, 0x40, 0x99, 0xb0,
+  0x40, 0x01, 0x42, 0x34, 0xd0, 0xcf, 0x47, 0x1e, 0xf8, 0xb2, 0x87, 0x90,
+  0x41, 0x30, 0xfa, 0xb2, 0xb5, 0x1f, 0x4b, 0x00, 0x28, 0x15, 0x10, 0x24,
+  0xfc, 0x13, 0x01, 0x7a, 0xff, 0xfc, 0x18, 0xbb, 0xfa, 0xb2, 0x10, 0x21,
+  0x2f, 0xff, 0x48, 0xff, 0xf7, 0x41, 0xfc, 0xe8, 0xb9, 0x00, 0xbf, 0x2e,
+  0x0c, 0xbf, 0x2d, 0x21, 0x2c, 0xe1, 0x00, 0x1c, 0xde, 0xa3, 0x00, 0xeb,
+  0xfd, 0x01, 0x22, 0x15, 0xb1, 0x28, 0x4b, 0xf7, 0x00, 0x22, 0x01, 0x13,
+  0x00, 0xd9, 0x70, 0xf4, 0xf7, 0xdf, 0x93, 0xfa, 0x18, 0xb1, 0x00, 0x15,
+  0x00, 0x49, 0xf8, 0xeb, 0x02, 0x24, 0x4d, 0x07, 0x23, 0x79, 0x80, 0x04,
+  0x24, 0x02, 0xff, 0xe0, 0x76, 0x1c, 0x02, 0x2e, 0xc2, 0xd3, 0x99, 0xf7,
+  0xf8, 0x00, 0x10, 0x35, 0x11, 0xcb, 0xfd, 0x99, 0xf8, 0x6b, 0x01, 0x10,
+  0x2d, 0x13, 0xc5, 0x0b, 0x00, 0x02, 0x10, 0x11, 0x11, 0xfb, 0xc0, 0xfd,
+  0x29, 0x21, 0x6f, 0xf8, 0x20, 0x46, 0x05, 0x7e, 0xd5, 0xd2, 0x00, 0x00,
+  0xd3, 0x05, 0x00, 0x46, 0xf7, 0xc1, 0x6f, 0xc6, 0xe3, 0x33, 0x4c, 0xd7,
+  0xd0, 0x41, 0x00, 0xa8, 0x60, 0xbf, 0xcd, 0xcc, 0x4c, 0x3d, 0xe0, 0xf2,
+  0xd7, 0x91, 0x7a, 0xfd, 0x44, 0x2f, 0x31, 0x00, 0x00, 0xfa, 0x44, 0x4e,
+  0x62, 0xef, 0xd0, 0x3e, 0x01, 0x01, 0x2b, 0x73, 0xca, 0x02, 0x00, 0xf7,
+  0x46, 0xb4, 0x2a, 0x17, 0x00, 0x40, 0x9c, 0x47, 0xb6, 0xce, 0x07, 0x00,
+  0x20, 0xa1, 0x07, 0xb5, 0x90, 0xa3, 0x01, 0xed, 0xf7, 0xe5, 0x99, 0x73,
+  0x32, 0x00, 0x23, 0xe2, 0x17, 0xa0, 0x40, 0x70, 0x47, 0x75, 0xf0, 0x17,
+  0x40, 0x83, 0xa3, 0x22, 0xed, 0xf7, 0xd5, 0x5b, 0xc0, 0xfe, 0xed, 0xb3,
+  0x04, 0x00, 0x4c, 0xd1, 0x00, 0x26, 0x69, 0x7f, 0x4f, 0x07, 0xeb, 0x46,
+  0x12, 0xf1, 0xb2, 0x13, 0x01, 0xff, 0xe8, 0xf8, 0x76, 0x1c, 0x04, 0x2e,
+  0xf6, 0xdb, 0xff, 0x07, 0xf1, 0x80, 0x05, 0x40, 0xf2, 0xdd, 0x50, 0xff,
+  0x29, 0x78, 0xed, 0xf7, 0x68, 0xfd, 0x69, 0x78, 0xff, 0x40, 0xf2, 0xde,
+  0x50, 0xed, 0xf7, 0x63, 0xfd, 0xf5, 0xa9, 0x09, 0x00, 0xdf, 0x09, 0x00,
+  0x5e, 0xfd, 0xe9, 0x78, 0xf7, 0x4f, 0xf4, 0xbc, 0xd7, 0x00, 0x59, 0xfd,
+  0x29, 0x79, 0xf7, 0x40, 0xf2, 0xe1, 0x13, 0x00, 0x54, 0xfd, 0x57, 0x48,
+  0xff, 0x58, 0x4a, 0x01, 0x78, 0x40, 0x78, 0x93, 0x78, 0xff, 0xd5, 0x78,
+  0x43, 0xea, 0x05, 0x23, 0x15, 0x78, 0xff, 0x52, 0x78, 0x41, 0xea, 0x00,
+  0x20, 0x45, 0xea, 0xfe, 0x67, 0x40, 0x1a, 0xc9, 0x1a, 0x00, 0x01, 0x49,
+  0x1c, 0xff, 0x90, 0xfb, 0xf1, 0xf1, 0x89, 0xb2, 0x10, 0x29, 0x77, 0xa8,
+  0xbf, 0x0f, 0x6d, 0xe0, 0x4f, 0xf4, 0x09, 0xaf, 0x00, 0xff, 0x37, 0xfd,
+  0x4b, 0x48, 0x80, 0x7a, 0x03, 0x21, 0x9f, 0x08, 0x42, 0x04, 0xd0, 0xff,
+  0x57, 0x30, 0x41, 0x41, 0x20, 0xfe, 0x3b, 0x40, 0xed, 0xf7, 0xdc, 0xff,
+  0x20, 0x46, 0xfe, 0xb2, 0x61, 0x94, 0x0d, 0x7f, 0x40, 0x5d, 0x20, 0xf2,
+  0xd1, 0x6b, 0x00, 0x28, 0xfd, 0xfd, 0xbf, 0x90, 0x70, 0xf1, 0xf7, 0x4c,
+  0xf9, 0xc0, 0xfc, 0x93, 0x40, 0xf5, 0x03, 0x1e, 0xfd, 0x41, 0xf2, 0x88,
+  0x33, 0xfc, 0xa3, 0x41, 0xa9, 0x13, 0xbe, 0xf9, 0x08, 0xb1, 0x01, 0x20,
+  0xff, 0x60, 0xe0, 0x35, 0x4e, 0x70, 0x79, 0xb1, 0x79, 0xff, 0xf2, 0x79,
+  0x33, 0x7a, 0x37, 0x78, 0x01, 0xf0, 0x7f, 0x07, 0x01, 0x40, 0xea, 0x01,
+  0x20, 0x03, 0x07, 0x00, 0xff, 0x42, 0xea, 0x01, 0x21, 0x08, 0x18, 0x80,
+  0xb2, 0xff, 0x07, 0xf0, 0x3f, 0x01, 0xc1, 0xeb, 0x50, 0x07, 0xff, 0x2c,
+  0x48, 0x2c, 0x49, 0x00, 0x78, 0x09, 0x6b, 0xff, 0x40, 0x07, 0x4c, 0xbf,
+  0x2b, 0x48, 0x2b, 0x48, 0xff, 0xb1, 0xfb, 0xf0, 0xf0, 0x00, 0x04, 0xc0,
+  0x0a, 0x37, 0xf1, 0xf7, 0xeb, 0x45, 0xe0, 0xb8, 0xb2, 0xfb, 0x30, 0x45,
+  0xe2, 0xfd, 0xf1, 0xd7, 0x40, 0x07, 0x46, 0x2f, 0x60, 0xf1, 0xf7, 0xa5,
+  0xf3, 0x95, 0x30, 0xa4, 0x73, 0xc0, 0x73, 0x40, 0x50, 0xa9, 0x61, 0x7f,
+  0xb7, 0xfb, 0x28, 0x60, 0xab, 0x22, 0xf2, 0xd3, 0xa3, 0x00, 0xcc, 0xbd,
+  0xfc, 0x45, 0x80, 0x0a, 0x40, 0xf2, 0xd4, 0x0b, 0x00, 0xc6, 0xff, 0xfc,
+  0x70, 0x7a, 0xb1, 0x7a, 0xf7, 0x78, 0x36, 0x7d, 0x79, 0x7d, 0x01, 0x00,
+  0x03, 0xf1, 0xf7, 0xc1, 0x53, 0x00, 0x57, 0x47, 0xea, 0x06, 0xb3, 0x40,
+  0xc6, 0x55, 0x04, 0xd2, 0xc1, 0xe0, 0xbd, 0x6e, 0x55, 0x00, 0xc8, 0xfb,
+  0x60, 0x80, 0x25, 0x30, 0xf0, 0xfb, 0x66, 0x50, 0xff, 0x30, 0xfb, 0x68,
+  0x60, 0x00, 0x20, 0xbe, 0xd9, 0x51, 0x00, 0x02, 0x00, 0x20, 0xdb, 0x27,
+  0x20, 0x20, 0x94, 0xf7, 0x10, 0x2b, 0x21, 0xd2, 0x0b, 0x00, 0x02, 0x0b,
+  0x20, 0x1b, 0x21, 0x40, 0xfd, 0x4b, 0x36, 0x20, 0x09, 0x3d, 0x00, 0x01,
+  0x22, 0x40, 0xfb, 0x1c, 0x02, 0xa7, 0xa1, 0x1e, 0x80, 0xb2, 0x88, 0x42,
+  0xef, 0x88, 0xbf, 0x08, 0x46, 0x47, 0x92, 0x4f, 0x91, 0x46, 0xff, 0x0f,
+  0xf2, 0xe0, 0x02, 0x83, 0xb0, 0x04, 0x46, 0xff, 0xb2, 0xe8, 0x08, 0x04,
+  0x68, 0x46, 0x00, 0x25, 0xf9, 0xa0, 0x07, 0x00, 0x0b, 0x10, 0x00, 0x40,
+  0xf0, 0x20, 0x01, 0xde, 0xe7, 0x11, 0xed, 0xf7, 0x75, 0xfc, 0x3b, 0x30,
+  0xf2, 0xe2, 0xf6, 0x09, 0x00, 0x70, 0xfc, 0x07, 0xa0, 0xf2, 0xe4, 0x5a,
+  0x40, 0xff, 0xf2, 0xe3, 0x5b, 0x0f, 0xf2, 0xc8, 0x08, 0x20, 0xff, 0x88,
+  0x39, 0xf8, 0x17, 0x10, 0x48, 0x43, 0x3d, 0xfe, 0x05, 0x00, 0xc1, 0xeb,
+  0x10, 0x11, 0x15, 0xf8, 0x08, 0xab, 0x00, 0x89, 0x3b, 0x30, 0xc8, 0xd7,
+  0xc0, 0x3e, 0x11, 0xd0, 0x38, 0xff, 0xf8, 0x6d, 0x1c, 0x7f, 0x1c, 0x04,
+  0x2f, 0xea, 0xff, 0xdb, 0x00, 0x27, 0x09, 0xeb, 0x47, 0x01, 0x60, 0x7f,
+  0x88, 0x09, 0x89, 0x48, 0x43, 0x01, 0x01, 0x27, 0x01, 0x5f, 0x09, 0x0c,
+  0xff, 0xf7, 0xb4, 0x27, 0x00, 0x2a, 0x27, 0x00, 0xfd, 0x24, 0x27, 0x02,
+  0x07, 0x2f, 0xec, 0xdb, 0x00, 0x24, 0xff, 0x09, 0xeb, 0x44, 0x00, 0x64,
+  0x1c, 0xc1, 0x8a, 0xae, 0x23, 0x01, 0xff, 0xf7, 0xa3, 0x21, 0x00, 0x19,
+  0x21, 0x00, 0x13, 0xfe, 0x21, 0x00, 0x05, 0x2c, 0xf0, 0xdb, 0x0f, 0xf2,
+  0x38, 0xef, 0x05, 0x00, 0x24, 0x00, 0x3f, 0x42, 0x29, 0xfc, 0x61, 0xfd,
+  0x5d, 0x4b, 0x31, 0x25, 0xfc, 0x64, 0x1c, 0x15, 0x2c, 0xeb, 0xf4, 0xdb,
+  0xfd, 0xd1, 0xf1, 0x93, 0x42, 0x1c, 0xbc, 0x06, 0xdf, 0x46, 0x30, 0x04,
+  0x01, 0x0e, 0x25, 0x01, 0x16, 0xbc, 0x9f, 0x30, 0x01, 0xa0, 0x00, 0x70,
+  0xf2, 0x21, 0x00, 0x00, 0x33, 0x8a, 0x03, 0x00, 0x2c, 0x03, 0x00, 0x2a,
+  0x03, 0x00, 0xc9, 0x40, 0x03, 0x02, 0x0a, 0xff, 0x08, 0x06, 0x05, 0x0a,
+  0x0a, 0x0b, 0x09, 0x0a, 0xf7, 0x09, 0x0a, 0x05, 0x00, 0x00, 0x07, 0xb3,
+  0x49, 0x4f, 0xff, 0xf4, 0x82, 0x72, 0x02, 0xfb, 0x00, 0x11, 0x01, 0xff,
+  0xf5, 0x21, 0x71, 0xff, 0xf7, 0x74, 0xb9, 0x38, 0xf7, 0xb5, 0xae, 0x4c,
+  0x47, 0x30, 0x70, 0x00, 0x21, 0x01, 0xba, 0x79, 0x20, 0x2c, 0xa5, 0x30,
+  0xf0, 0xf7, 0xda, 0x6b, 0x90, 0x01, 0xbf, 0x25, 0x60, 0x70, 0x01, 0x21,
+  0x04, 0xd3, 0xb0, 0x28, 0x6f, 0x55, 0x29, 0x00, 0x18, 0x01, 0x50, 0xc9,
+  0xb2, 0x21, 0x01, 0xd7, 0x1b, 0xfd, 0x28, 0xa7, 0x20, 0xc9, 0xb3, 0x00,
+  0x02, 0x2d, 0xf7, 0xf0, 0xd3, 0x31, 0xa5, 0x21, 0x47, 0x9f, 0x4e, 0xdf,
+  0xff, 0xf8, 0x7c, 0x82, 0x70, 0x69, 0xdf, 0xf8, 0x70, 0xff, 0x92, 0x0c,
+  0x46, 0xb1, 0x69, 0x00, 0x25, 0x81, 0xbb, 0x42, 0x38, 0x87, 0x10, 0xf1,
+  0xf7, 0xd3, 0x51, 0x60, 0x7c, 0x6e, 0x51, 0x60, 0x6d, 0xfa, 0x98, 0x0d,
+  0x50, 0xdc, 0xf8, 0xf3, 0x50, 0xff, 0xfa, 0x96, 0x49, 0xb1, 0xf9, 0x0e,
+  0x20, 0x00, 0xff, 0xb2, 0x90, 0x42, 0xc8, 0xbf, 0x10, 0x46, 0xc8, 0x7f,
+  0x81, 0x00, 0x27, 0xb0, 0x7a, 0x21, 0x61, 0xe3, 0x50, 0xe7, 0x06, 0x08,
+  0x8a, 0x05, 0x00, 0x4b, 0xf0, 0x26, 0xfa, 0x07, 0xff, 0xf0, 0xc0, 0x07,
+  0x3e, 0xd5, 0x01, 0x20, 0xb8, 0xff, 0x40, 0xed, 0xf7, 0x0d, 0xfc, 0x08,
+  0xb9, 0x02, 0xef, 0x25, 0x3a, 0xe0, 0x39, 0x01, 0x90, 0xf1, 0xf7, 0xa1,
+  0xff, 0xfe, 0x08, 0xb9, 0x03, 0x25, 0x33, 0xe0, 0x27, 0xfb, 0x60, 0x39,
+  0xb9, 0x30, 0xe7, 0xf8, 0xe0, 0x60, 0x4f, 0xff, 0xf4, 0xa0, 0x70, 0x00,
+  0xfb, 0x07, 0x9a, 0x0a, 0xaf, 0xf1, 0x04, 0x00, 0xa0, 0x9b, 0x30, 0xcd,
+  0xcf, 0x60, 0x7e, 0x7f, 0x51, 0x38, 0x46, 0xfe, 0xf7, 0xf7, 0xff, 0xed,
+  0x00, 0x66, 0x1b, 0x01, 0x90, 0x00, 0xed, 0x00, 0x53, 0x30, 0xf7, 0x73,
+  0x5b, 0x80, 0xfe, 0x27, 0x01, 0xfe, 0xf7, 0x4e, 0xff, 0x0a, 0xf1, 0x54,
+  0xfe, 0x07, 0x00, 0x4a, 0xff, 0x43, 0x46, 0x01, 0x22, 0xf9, 0xfe, 0xdb,
+  0x02, 0x9a, 0xfc, 0xed, 0xf7, 0xb1, 0xfc, 0x15, 0xff, 0xb9, 0x01, 0x20,
+  0x07, 0xf8, 0x09, 0x00, 0x7f, 0xdf, 0x1c, 0x02, 0x2f, 0xb9, 0xd3, 0xeb,
+  0xb2, 0x87, 0x38, 0xbf, 0x21, 0x6a, 0x48, 0xf2, 0xf7, 0xba, 0x73, 0xf0,
+  0xfc, 0xff, 0x4e, 0x81, 0x46, 0x68, 0x4e, 0x1c, 0x20, 0x00, 0x77, 0xfb,
+  0x09, 0x60, 0x9b, 0x30, 0xf1, 0x28, 0x07, 0xbf, 0xb7, 0xff, 0x00, 0x21,
+  0xb9, 0x82, 0x39, 0x60, 0x64, 0x21, 0xbf, 0x79, 0x60, 0x00, 0x21, 0xf9,
+  0x82, 0x0d, 0xe1, 0x06, 0xff, 0xeb, 0xc9, 0x00, 0x01, 0x90, 0x34, 0x78,
+  0xdf, 0xef, 0xf8, 0x54, 0xb1, 0x20, 0x35, 0xe0, 0x01, 0x98, 0x84, 0xed,
+  0x69, 0x93, 0x03, 0x09, 0xb0, 0x93, 0x00, 0x7a, 0xe0, 0x07, 0xed, 0x0a,
+  0xe5, 0x01, 0x82, 0x29, 0xc7, 0x60, 0x00, 0xf0, 0x3a, 0xdf, 0xf9, 0x30,
+  0xb3, 0xb9, 0x8a, 0x2b, 0x30, 0x40, 0x38, 0xff, 0x60, 0x38, 0x68, 0x60,
+  0xb9, 0xa0, 0x07, 0x0d, 0x7b, 0xd5, 0x02, 0x1d, 0x06, 0xd1, 0xf9, 0xc8,
+  0xb1, 0x1d, 0x07, 0xff, 0x00, 0x28, 0x4d, 0xd1, 0x60, 0x07, 0x4d, 0xd5,
+  0xfd, 0x03, 0x1f, 0x00, 0x19, 0xf8, 0x0b, 0x00, 0x20, 0xb1, 0xfd, 0x49,
+  0x1f, 0x12, 0x11, 0xfe, 0x40, 0xb9, 0xb8, 0x8a, 0xf7, 0x00, 0x04, 0x40,
+  0x33, 0x70, 0x3b, 0xe0, 0x38, 0x60, 0x7f, 0xdc, 0xe7, 0x38, 0x60, 0xea,
+  0xe7, 0xa5, 0xd5, 0xf0, 0xff, 0x30, 0x1d, 0xa8, 0x60, 0xf0, 0x88, 0x00,
+  0xf0, 0xff, 0x52, 0xf8, 0x68, 0x60, 0xc5, 0xf8, 0x0c, 0xa0, 0xfe, 0x37,
+  0x13, 0x09, 0xb0, 0x01, 0x1d, 0xa4, 0x30, 0x29, 0x7b, 0x61, 0x68, 0x81,
+  0x10, 0x3e, 0xf8, 0xa8, 0x61, 0xef, 0x10, 0xff, 0x62, 0xee, 0xf7, 0xd9,
+  0xfb, 0x83, 0x46, 0xbb, 0xff, 0xf1, 0x2e, 0x0f, 0x16, 0xd3, 0x00, 0xf0,
+  0x48, 0xff, 0xf8, 0x29, 0x49, 0xf0, 0xf7, 0xfe, 0xff, 0x00, 0xcf, 0x90,
+  0xab, 0xf1, 0x2d, 0x95, 0xb0, 0x25, 0xd0, 0x99, 0xf1, 0xf7, 0xf7, 0x84,
+  0xf9, 0x23, 0x90, 0xf8, 0x40, 0x08, 0xf0, 0xdf, 0xf7, 0xa5, 0xf8, 0xa8,
+  0x70, 0x0d, 0x61, 0xa1, 0xf9, 0xdb, 0x04, 0xe0, 0x79, 0x03, 0x04, 0x00,
+  0xa1, 0x01, 0x98, 0xb9, 0xcf, 0x20, 0x07, 0x11, 0xd5, 0x79, 0x05, 0x71,
+  0x01, 0x00, 0xf0, 0xfd, 0x0d, 0x61, 0x04, 0x01, 0x98, 0x00, 0xf1, 0x18,
+  0x01, 0xf6, 0x35, 0x01, 0x21, 0xfb, 0x2b, 0x01, 0xbd, 0xe8, 0xf6, 0x8e,
+  0xfb, 0xef, 0x61, 0xc1, 0x03, 0xb5, 0xbd, 0x00, 0xf0, 0xc0, 0xcf, 0xb8,
+  0x10, 0xb5, 0xf0, 0x43, 0x30, 0x97, 0xe0, 0xf0, 0x08, 0x7c, 0xfb, 0xa0,
+  0xf3, 0x41, 0xbd, 0xe8, 0x10, 0x40, 0x0a, 0x89, 0x00, 0xbf, 0xb9, 0xbf,
+  0x03, 0x48, 0x00, 0x6c, 0x77, 0x00, 0xbf, 0xbf, 0x00, 0x00, 0x48, 0xa8,
+  0x00, 0x20, 0x17, 0x41, 0x25, 0xfd, 0x58, 0x21, 0x60, 0x24, 0x74, 0x49,
+  0x64, 0x2b, 0x00, 0xeb, 0x20, 0xb0, 0x03, 0x00, 0x88, 0x03, 0x00, 0x00,
+  0x7c, 0x92, 0xff, 0x4d, 0x53, 0x48, 0x41, 0x89, 0x03, 0x22, 0x11, 0xff,
+  0x42, 0x00, 0xd1, 0x70, 0x47, 0x80, 0xb5, 0xc1, 0xff, 0xf3, 0x01, 0x11,
+  0x61, 0xb1, 0x01, 0x6c, 0x80, 0xff, 0x69, 0xfc, 0xf7, 0x94, 0xfb, 0x05,
+  0x28, 0x28, 0xf7, 0xbf, 0x05, 0x20, 0xe3, 0xe3, 0x4a, 0x49, 0x88, 0x60,
+  0xff, 0xc8, 0x60, 0x01, 0xbd, 0xc1, 0x68, 0xca, 0x07, 0x7f, 0x01, 0xd5,
+  0x04, 0x20, 0x70, 0x47, 0x8a, 0x07, 0x00, 0xd5, 0x03, 0x07, 0x00, 0x49,
+  0x07, 0x00, 0x05, 0x07, 0x00, 0x00, 0x69, 0xe7, 0x00, 0xb1, 0x06, 0x07,
+  0x00, 0x95, 0x55, 0xdf, 0xf8, 0xf8, 0x5f, 0x80, 0x08, 0xf1, 0x08, 0x00,
+  0xa9, 0x40, 0x26, 0xd9, 0x61, 0xff, 0x40, 0xfb, 0x32, 0x28, 0x28, 0xd3,
+  0x6b, 0x68, 0xff, 0x37, 0x49, 0x9f, 0x89, 0x93, 0xf8, 0x0e, 0xc0, 0xff,
+  0x5b, 0x8a, 0x09, 0x6c, 0x1b, 0x0a, 0x0c, 0xf0, 0xfb, 0x07, 0x0c, 0x75,
+  0x50, 0x03, 0x01, 0x22, 0x63, 0x44, 0xff, 0x9a, 0x40, 0x32, 0x38, 0x92,
+  0xb2, 0xb0, 0xfb, 0xff, 0xf2, 0xf0, 0xef, 0xf7, 0xcb, 0xf8, 0x4f, 0xf6,
+  0xff, 0xc0, 0x71, 0x39, 0x40, 0x01, 0x43, 0x29, 0x81, 0x7f, 0xef, 0xf7,
+  0xeb, 0xf8, 0xf0, 0xf7, 0x3e, 0x85, 0xc0, 0xd7, 0x4f, 0xf0, 0x8f, 0xa7,
+  0xd0, 0x49, 0x17, 0x40, 0xa9, 0xf9, 0xff, 0xf7, 0xf7, 0xb5, 0xff, 0x68,
+  0x81, 0x00, 0xe0, 0xdd, 0x07, 0x0d, 0xf0, 0x86, 0xb9, 0x24, 0x11, 0x32,
+  0x0c, 0xd5, 0xeb, 0x2f, 0x60, 0xaf, 0x61, 0xbb, 0x81, 0xe0, 0xff, 0xf7,
+  0xa9, 0xff, 0xff, 0x06, 0x00, 0x03, 0xd1, 0x68, 0x69, 0x08, 0xdf, 0xeb,
+  0x87, 0x01, 0x08, 0x62, 0xad, 0x21, 0xea, 0xd3, 0xfe, 0xf3, 0xe1, 0xf0,
+  0x81, 0x38, 0xb5, 0x0c, 0x46, 0x16, 0xff, 0x48, 0x14, 0x49, 0x00, 0x68,
+  0x89, 0x7a, 0x80, 0xfb, 0x08, 0x01, 0xf3, 0x90, 0x41, 0xea, 0x80, 0x05,
+  0x05, 0xf4, 0x11, 0x20, 0xd3, 0x80, 0xfa, 0x4d, 0x30, 0x20, 0x32, 0xbd,
+  0x21, 0xfe, 0x0d, 0x70, 0xbd, 0xe8, 0x34, 0x40, 0x96, 0xe7, 0x0b, 0xff,
+  0x4a, 0x52, 0x68, 0x01, 0x23, 0x00, 0xf0, 0x01, 0xef, 0x00, 0x92, 0x08,
+  0x03, 0x47, 0x51, 0xea, 0x82, 0x00, 0xfb, 0x8b, 0xe7, 0xb3, 0xd0, 0xd2,
+  0x01, 0x46, 0x04, 0x4a, 0x27, 0x02, 0xeb, 0x80, 0x26, 0x90, 0x2d, 0xf0,
+  0xba, 0xb7, 0xe1, 0x6b, 0x11, 0xef, 0xf4, 0x28, 0x00, 0x20, 0xb3, 0xe9,
+  0x80, 0xb5, 0x8a, 0xff, 0x48, 0xc1, 0x6a, 0x40, 0x6b, 0xfc, 0xf7, 0xea,
+  0xdf, 0xfa, 0x88, 0x49, 0x4a, 0xe0, 0xcd, 0xf0, 0x43, 0x0c, 0xff, 0x46,
+  0x00, 0x27, 0x61, 0x68, 0x8d, 0x89, 0x8e, 0xdf, 0x7d, 0x61, 0x78, 0x01,
+  0x29, 0xeb, 0xd0, 0x28, 0x32, 0x7d, 0xd1, 0x25, 0x11, 0xad, 0xfa, 0x0f,
+  0x28, 0x38, 0xf9, 0xd0, 0x7f, 0x2b, 0xd3, 0x62, 0x68, 0x7c, 0x49, 0x92,
+  0x27, 0x10, 0xf5, 0x52, 0x27, 0x10, 0x12, 0x27, 0x12, 0x02, 0xf0, 0x07,
+  0x02, 0xff, 0x01, 0x23, 0x62, 0x44, 0x03, 0xfa, 0x02, 0xf2, 0xfd, 0x0f,
+  0x29, 0x16, 0x36, 0xf8, 0x80, 0x46, 0x05, 0xf0, 0x7f, 0x3f, 0x00, 0xef,
+  0xf7, 0x58, 0xf8, 0x81, 0x31, 0x60, 0xff, 0xef, 0xf7, 0x54, 0xf8, 0x48,
+  0x45, 0x0b, 0xd2, 0xbf, 0xb9, 0xfb, 0xf0, 0xf6, 0xb6, 0xb2, 0x45, 0x11,
+  0x70, 0xff, 0x43, 0x29, 0x40, 0x48, 0x45, 0x48, 0xea, 0x01, 0xff, 0x05,
+  0x38, 0xbf, 0x76, 0x1c, 0x25, 0x81, 0x66, 0xfb, 0x81, 0x38, 0xf9, 0xf1,
+  0x83, 0x80, 0xb5, 0x64, 0x48, 0xfe, 0xeb, 0x13, 0x9e, 0xfa, 0x63, 0x49,
+  0x81, 0xf8, 0x21, 0x77, 0x00, 0x01, 0xbd, 0x19, 0x11, 0x5f, 0x48, 0x5e,
+  0x19, 0x10, 0x7f, 0x49, 0x89, 0x80, 0x08, 0xc1, 0xf3, 0x81, 0x19, 0x18,
+  0xf7, 0xcb, 0xf9, 0x08, 0xf9, 0x30, 0x32, 0xbd, 0x22, 0x46, 0xfd, 0x29,
+  0x3f, 0x00, 0x38, 0x40, 0x00, 0x20, 0x22, 0xe0, 0x2e, 0x2f, 0x01, 0x54,
+  0x48, 0x52, 0x49, 0x1f, 0x03, 0xc1, 0x2f, 0x00, 0x49, 0x11, 0xfe, 0x2f,
+  0x07, 0x54, 0xe0, 0x0a, 0x46, 0x49, 0x49, 0x01, 0xe7, 0x23, 0x49, 0x68,
+  0x4d, 0x11, 0x4b, 0x11, 0x01, 0x43, 0x01, 0xfb, 0x20, 0x49, 0x11, 0x14,
+  0x04, 0xf0, 0x04, 0x01, 0xdf, 0xff, 0xf8, 0x00, 0x81, 0x15, 0x46, 0x00,
+  0x26, 0xa9, 0xff, 0x70, 0x6e, 0x70, 0x04, 0xf0, 0x08, 0x01, 0xe9, 0xf7,
+  0x70, 0x2e, 0x61, 0x45, 0x20, 0x01, 0x69, 0x60, 0x29, 0xbe, 0xd1, 0x10,
+  0x62, 0xff, 0x00, 0xb1, 0x08, 0xef, 0x10, 0x00, 0xef, 0x20, 0x02, 0xe0,
+  0x38, 0x73, 0x51, 0x20, 0x2e, 0xbb, 0xfe, 0xf9, 0x10, 0xf1, 0xc9, 0x07,
+  0x21, 0xd5, 0x34, 0x49, 0xdf, 0x2f, 0x70, 0x4f, 0xf4, 0x7c, 0xbb, 0x51,
+  0x16, 0x06, 0xff, 0xf1, 0xe0, 0x00, 0xe8, 0x60, 0x30, 0x1d, 0x68, 0x3b,
+  0x61, 0x14, 0x87, 0x40, 0x07, 0x89, 0x09, 0x53, 0xe0, 0x17, 0x21, 0xfb,
+  0x58, 0xf8, 0x05, 0x01, 0xfc, 0xf9, 0x2b, 0x6a, 0x6a, 0xff, 0x6a, 0x29,
+  0x7e, 0x30, 0x46, 0xfa, 0xf7, 0x47, 0xad, 0xf9, 0x1b, 0x07, 0x06, 0x46,
+  0x23, 0x21, 0xd2, 0x23, 0x22, 0xf2, 0xfd, 0x83, 0xc7, 0x21, 0x0c, 0x46,
+  0x15, 0x46, 0x01, 0x21, 0xdd, 0x69, 0x89, 0x00, 0x04, 0x01, 0xa9, 0x8f,
+  0x04, 0x00, 0x26, 0xdf, 0xdf, 0xf8, 0x60, 0x80, 0x6e, 0x95, 0x04, 0x2e,
+  0x61, 0x5f, 0x05, 0xf5, 0xdc, 0x71, 0xe9, 0x9d, 0x02, 0x13, 0x9d, 0x04,
+  0xed, 0xae, 0x8d, 0x24, 0x11, 0xd5, 0x7d, 0x02, 0x86, 0x2f, 0x70, 0x69,
+  0x06, 0xe9, 0xe0, 0x63, 0x01, 0x18, 0x7f, 0x02, 0xbc, 0xf9, 0x0f, 0x05,
+  0xa5, 0x1e, 0x73, 0x04, 0xe5, 0x97, 0x24, 0x3f, 0x23, 0xd8, 0x03, 0x00,
+  0x28, 0xbe, 0xbb, 0x90, 0xc0, 0x92, 0x00, 0x20, 0x10, 0x5f, 0x10, 0xff,
+  0xbf, 0xf7, 0xd8, 0xfe, 0x01, 0x21, 0x61, 0x33, 0x50, 0x21, 0x7f, 0x60,
+  0xa1, 0x60, 0xe1, 0x60, 0x21, 0x61, 0x39, 0x51, 0xcf, 0x10, 0xbd, 0x70,
+  0xb5, 0x67, 0x31, 0x6d, 0xe0, 0x07, 0x48, 0xbf, 0xbf, 0x04, 0x26, 0x10,
+  0xd4, 0x81, 0x07, 0x00, 0x03, 0xef, 0x26, 0x0c, 0xd4, 0x40, 0x07, 0x00,
+  0x07, 0x26, 0x08, 0xff, 0xd4, 0xa0, 0x7e, 0x08, 0xb1, 0x05, 0x26, 0x04,
+  0xf7, 0xe0, 0xe0, 0x7e, 0xc3, 0xd1, 0x06, 0x26, 0x00, 0x26, 0xfe, 0x57,
+  0xf0, 0xfe, 0x2e, 0x60, 0x61, 0x6a, 0xa9, 0x60, 0xff, 0x21, 0x6a, 0xe9,
+  0x60, 0x21, 0x7e, 0x29, 0x61, 0xef, 0x00, 0x21, 0x69, 0x60, 0x4d, 0x01,
+  0x30, 0x46, 0x70, 0xff, 0xbd, 0xc0, 0xf3, 0xc7, 0x52, 0x7e, 0x3a, 0xcc,
+  0xff, 0xbf, 0xd2, 0xf1, 0x18, 0x0c, 0x07, 0xe0, 0x6f, 0xff, 0xf0, 0x7f,
+  0x41, 0xd1, 0x40, 0x00, 0x42, 0x58, 0xff, 0xbf, 0x40, 0x18, 0x88, 0x43,
+  0x70, 0x47, 0x18, 0xcf, 0x2a, 0x06, 0xda, 0x41, 0x73, 0x10, 0x3b, 0x60,
+  0x50, 0x28, 0xf2, 0x05, 0x00, 0x00, 0x3f, 0xa0, 0x40, 0x70, 0x21, 0xc0,
+  0xf8, 0x98, 0xff, 0x10, 0x40, 0xf8, 0x0c, 0x1f, 0x41, 0x60, 0x70, 0x7b,
+  0x47, 0x10, 0x91, 0x00, 0xff, 0xf7, 0xf5, 0xff, 0x2b, 0x71, 0xdf, 0xfe,
+  0xf7, 0x57, 0xf9, 0x20, 0xd5, 0x00, 0x10, 0x40, 0xba, 0x49, 0x11, 0x05,
+  0xdf, 0xb0, 0x80, 0x70, 0x29, 0xf7, 0x10, 0x8b, 0xfe, 0xd1, 0x70, 0x87,
+  0xf8, 0x04, 0x46, 0xd5, 0xf8, 0x98, 0xff, 0x00, 0x00, 0x28, 0x7a, 0xd1,
+  0x29, 0x68, 0x4f, 0xbf, 0xf4, 0x40, 0x70, 0x00, 0xf0, 0x7f, 0x17, 0x00,
+  0x7b, 0xbb, 0xf8, 0x01, 0x17, 0x04, 0x6e, 0xd1, 0x20, 0x45, 0x70, 0xd2,
+  0xae, 0xe7, 0xc0, 0x4f, 0xf0, 0x44, 0xf3, 0x30, 0x4f, 0x97, 0xc0, 0x20,
+  0xeb, 0x46, 0x41, 0x13, 0x00, 0xd8, 0xcd, 0xb0, 0xf0, 0xf7, 0xdd, 0x6b,
+  0xff, 0x94, 0x1b, 0xf1, 0x51, 0x13, 0xf0, 0x41, 0xf0, 0x1f, 0xc0, 0x7f,
+  0xf0, 0xf7, 0x38, 0xff, 0xc0, 0xf5, 0x80, 0x47, 0x00, 0xdd, 0x54, 0x47,
+  0x00, 0x57, 0xf8, 0x07, 0x47, 0x04, 0x4a, 0xd1, 0xdf, 0x4f, 0xf0, 0x40,
+  0x40, 0x39, 0x37, 0x00, 0xbc, 0xfe, 0x4a, 0x3d, 0x01, 0xb9, 0x3d, 0x02,
+  0xbe, 0x37, 0x50, 0x3f, 0x02, 0x50, 0x53, 0xf1, 0xf5, 0x21, 0x17, 0x00,
+  0x11, 0x41, 0x00, 0x17, 0xff, 0x00, 0x28, 0xdf, 0x54, 0xbf, 0x08, 0x20,
+  0x6f, 0x01, 0x90, 0x84, 0x19, 0xff, 0xb4, 0xf5, 0x80, 0x6f, 0x28, 0xbf,
+  0x34, 0x1a, 0x57, 0x29, 0x68, 0x20, 0xa9, 0x10, 0x30, 0x55, 0x00, 0x2c,
+  0x69, 0x30, 0xfe, 0x55, 0x02, 0xbb, 0xa0, 0x1b, 0xf0, 0xf7, 0xec, 0xfc,
+  0x4e, 0x55, 0x01, 0x91, 0xfe, 0x04, 0x73, 0x30, 0x09, 0x01, 0x7c, 0xab,
+  0x00, 0xba, 0xb3, 0x01, 0xfa, 0x31, 0x90, 0xf0, 0xf7, 0x8d, 0x61, 0x0e,
+  0xe0, 0x7f, 0xfd, 0xf0, 0xf7, 0xe6, 0xfe, 0x30, 0x1a, 0xc1, 0x70, 0xf7,
+  0xf8, 0x6e, 0x61, 0xed, 0x11, 0x80, 0xf3, 0x0a, 0x06, 0xff, 0x29, 0x68,
+  0x30, 0x46, 0x01, 0xe0, 0x28, 0x46, 0x7b, 0x38, 0xe0, 0xcd, 0x11, 0x00,
+  0x29, 0x07, 0xbf, 0x35, 0xb0, 0x5f, 0x65, 0x4f, 0xf4, 0xdc, 0x60, 0x67,
+  0x90, 0x65, 0x79, 0x90, 0xf5, 0x60, 0x49, 0x40, 0x86, 0x49, 0x43, 0xa1,
+  0x05, 0x09, 0x0e, 0xef, 0xec, 0xf7, 0xac, 0xff, 0xa3, 0xe0, 0x04, 0x00,
+  0xf0, 0xff, 0x0f, 0xf8, 0x44, 0xf0, 0x80, 0x01, 0x00, 0xf0, 0xf5, 0x0c,
+  0x99, 0x00, 0x09, 0x03, 0x00, 0x07, 0xf8, 0x05, 0xf1, 0x7f, 0x8c, 0x40,
+  0x01, 0x78, 0x00, 0x78, 0x86, 0x75, 0x41, 0xde, 0xbf, 0x42, 0xec, 0xf7,
+  0x95, 0xbf, 0x8b, 0x10, 0x22, 0x20, 0xef, 0xfa, 0x02, 0xf3, 0xdb, 0xa7,
+  0x50, 0x11, 0x46, 0x02, 0x7f, 0xe0, 0x52, 0x1c, 0x18, 0x2a, 0xf6, 0xd3,
+  0x03, 0xa1, 0xfe, 0x71, 0x01, 0x60, 0x68, 0x40, 0x68, 0xff, 0xf7, 0xed,
+  0x7f, 0xff, 0x05, 0xb2, 0x20, 0x68, 0x20, 0x76, 0x17, 0xb0, 0xff, 0x76,
+  0x00, 0x20, 0xa0, 0x76, 0x60, 0x68, 0xe0, 0xfb, 0x61, 0x04, 0xbb, 0x50,
+  0x20, 0x62, 0x00, 0x20, 0x60, 0xff, 0x62, 0x04, 0xf1, 0x18, 0x00, 0xfd,
+  0xf7, 0x8c, 0xdf, 0xfe, 0xe0, 0x6a, 0xe0, 0x60, 0x3b, 0xb1, 0x07, 0xe0,
+  0xff, 0xa0, 0x6b, 0xa8, 0x42, 0x04, 0xbf, 0xe0, 0x6b, 0xff, 0xe8, 0x42,
+  0x03, 0xd0, 0x01, 0x20, 0x20, 0x61, 0xed, 0xc4, 0x15, 0x11, 0x20, 0xd4,
+  0x09, 0x20, 0x00, 0x29, 0x41, 0xff, 0xd1, 0xd4, 0xe9, 0x12, 0x01, 0xf0,
+  0xf7, 0x2a, 0xbf, 0xfc, 0x05, 0x46, 0xd4, 0xe9, 0x10, 0x09, 0x00, 0x25,
+  0x54, 0x8f, 0xf0, 0x13, 0x91, 0x6d, 0x11, 0x02, 0x16, 0x11, 0x00, 0x1c,
+  0x99, 0xf0, 0xd7, 0xd4, 0xe9, 0x14, 0x09, 0x00, 0x17, 0xab, 0xf2, 0xf0,
+  0xf7, 0xd7, 0x5f, 0xfc, 0x04, 0x23, 0x00, 0x29, 0x09, 0x00, 0xe8, 0xfd,
+  0xae, 0x05, 0x01, 0xe5, 0xfd, 0x10, 0xc9, 0x60, 0x54, 0x39, 0x04, 0xce,
+  0xb6, 0x39, 0x00, 0x20, 0x46, 0x45, 0x11, 0xd9, 0xfd, 0x05, 0x01, 0xd6,
+  0xcb, 0xfd, 0x08, 0x1d, 0x00, 0x45, 0x1d, 0x00, 0x71, 0x11, 0xbf, 0xfc,
+  0x7e, 0x31, 0x01, 0x30, 0xfd, 0xbd, 0xe8, 0x70, 0x40, 0x13, 0x21, 0xdf,
+  0xf0, 0xf7, 0xc6, 0xbd, 0x70, 0xeb, 0xc2, 0x40, 0x40, 0xfe, 0xfd, 0x00,
+  0x63, 0xc1, 0x61, 0x41, 0x76, 0x81, 0x76, 0xf3, 0xc1, 0x76, 0x9f, 0x27,
+  0xd1, 0x11, 0x8c, 0xf8, 0xe0, 0x69, 0xfe, 0x41, 0x80, 0x78, 0x02, 0x28,
+  0x09, 0xd0, 0xe0, 0x78, 0xff, 0x00, 0x28, 0x04, 0xbf, 0x20, 0x6b, 0x00,
+  0x28, 0xf9, 0x03, 0x77, 0x20, 0xb3, 0x21, 0x13, 0xe0, 0x10, 0xbd, 0x10,
+  0xb3, 0xb5, 0xb4, 0x1b, 0xb0, 0x27, 0x70, 0x90, 0x69, 0x67, 0x00, 0xfc,
+  0xfe, 0xe3, 0xd0, 0x6b, 0x46, 0x01, 0xaa, 0x04, 0xf5, 0x79, 0xff, 0x71,
+  0x04, 0xf5, 0x96, 0x60, 0xfc, 0xf7, 0x1a, 0xbf, 0xf8, 0x34, 0xb0, 0x10,
+  0xbd, 0xf8, 0x53, 0x00, 0x6a, 0xef, 0x46, 0x60, 0x78, 0x25, 0x43, 0x00,
+  0x0c, 0xbf, 0x2e, 0xf7, 0x46, 0x02, 0x26, 0x4f, 0xd3, 0xdf, 0xfa, 0x00,
+  0x98, 0xfd, 0x10, 0x2f, 0x50, 0x60, 0x76, 0xf1, 0xbd, 0x00, 0x99, 0xff,
+  0x29, 0x4a, 0x00, 0x20, 0x08, 0x60, 0x00, 0x99, 0xff, 0x48, 0x71, 0x00,
+  0x99, 0x94, 0xf8, 0xb4, 0x01, 0xdd, 0x08, 0x07, 0x00, 0x20, 0x6a, 0xc8,
+  0x11, 0x00, 0x60, 0x6a, 0x7f, 0x08, 0x61, 0x00, 0x99, 0x00, 0x98, 0x00,
+  0x53, 0x00, 0xfd, 0x48, 0x75, 0x10, 0x34, 0x00, 0x00, 0x99, 0x88, 0x60,
+  0x7f, 0x60, 0x68, 0x00, 0x99, 0x18, 0x30, 0x88, 0x9f, 0x30, 0xfe, 0x4b,
+  0x01, 0x45, 0xfb, 0x60, 0x69, 0x28, 0xb1, 0x00, 0xef, 0x99, 0xcc, 0x22,
+  0x01, 0x7d, 0x00, 0xf3, 0xf7, 0xd0, 0xf7, 0xfc, 0xe0, 0x68, 0x0f, 0x05,
+  0x96, 0x61, 0xf3, 0xf7, 0xbb, 0xc8, 0xfc, 0x25, 0x20, 0x87, 0x60, 0x20,
+  0xc9, 0x33, 0xee, 0xf3, 0xf7, 0x73, 0x81, 0x80, 0x29, 0x01, 0xee, 0xf7,
+  0x0d, 0xff, 0xfe, 0x83, 0x01, 0xa0, 0x76, 0x0b, 0xe0, 0x00, 0x2d, 0x0c,
+  0xdf, 0xbf, 0x0a, 0x21, 0x0e, 0x21, 0x1f, 0x01, 0x6f, 0xff, 0xff, 0x60,
+  0x78, 0x10, 0xb9, 0x28, 0x46, 0xf8, 0xf7, 0x67, 0x14, 0xfa, 0x87, 0x97,
+  0x91, 0x63, 0x00, 0xcf, 0xfa, 0xa7, 0x00, 0xdf, 0x00, 0x31, 0x62, 0x01,
+  0x01, 0x25, 0x11, 0xa0, 0xb0, 0xd7, 0x20, 0x78, 0x8d, 0xff, 0xf0, 0x60,
+  0x05, 0x00, 0x01, 0x00, 0xfd, 0xa0, 0x05, 0x00, 0x02, 0x00, 0x60, 0x68,
+  0x01, 0x90, 0xfa, 0x15, 0x21, 0x02, 0x05, 0x00, 0x34, 0x00, 0x03, 0x90,
+  0xa1, 0xff, 0x78, 0x60, 0x78, 0xfd, 0xf7, 0x64, 0xff, 0x68, 0xff, 0x46,
+  0xfd, 0xf7, 0x7d, 0xfd, 0x20, 0x69, 0x20, 0xff, 0xb1, 0x03, 0x99, 0x4f,
+  0xf4, 0xc0, 0x72, 0xf3, 0xff, 0xf7, 0x80, 0xfc, 0x9d, 0xf9, 0x10, 0x00,
+  0x40, 0xfb, 0x42, 0x84, 0xe9, 0x00, 0x9d, 0xf8, 0x11, 0x00, 0x20, 0xff,
+  0x76, 0x05, 0x98, 0xe0, 0x61, 0x06, 0x98, 0x20, 0x3f, 0x62, 0x07, 0x98,
+  0x60, 0x62, 0x20, 0x35, 0x10, 0xd7, 0x01, 0xbb, 0x10, 0xb5, 0x51, 0xa0,
+  0xf8, 0x60, 0x48, 0xb3, 0x20, 0x24, 0xff, 0x39, 0xb1, 0x41, 0x78, 0x90,
+  0xf9, 0x02, 0x00, 0xff, 0x40, 0x18, 0xc0, 0xb2, 0x00, 0xf0, 0x00, 0xf9,
+  0x97, 0x0d, 0xe0, 0x5b, 0xfb, 0xd0, 0x10, 0x47, 0x60, 0x1b, 0x70, 0x24,
+  0xeb, 0x06, 0xd0, 0x2f, 0x61, 0x80, 0x03, 0x00, 0x00, 0xf0, 0x06, 0xd4,
+  0x3b, 0x40, 0xaf, 0x01, 0xda, 0x29, 0xf0, 0x10, 0x5d, 0xb1, 0x4f, 0x89,
+  0xff, 0xb0, 0x05, 0x46, 0x04, 0xa8, 0xef, 0xf7, 0xca, 0xfd, 0xfa, 0xc1,
+  0xe1, 0xf0, 0xf7, 0x53, 0xff, 0xdd, 0xe9, 0xff, 0x00, 0x01, 0xcd, 0xe9,
+  0x02, 0x01, 0x02, 0xaa, 0xcb, 0x02, 0x21, 0x11, 0x01, 0x81, 0x91, 0x40,
+  0xc7, 0x10, 0xf0, 0xd4, 0xff, 0xf8, 0x01, 0x21, 0xe8, 0xb2, 0xef, 0xf7,
+  0xb6, 0xff, 0xf9, 0x44, 0x4a, 0x0f, 0xf2, 0xc0, 0x19, 0xd2, 0xff, 0xe9,
+  0x08, 0x01, 0xef, 0xf7, 0x5f, 0xfa, 0x01, 0xfd, 0x46, 0x15, 0x01, 0x79,
+  0xfa, 0x3e, 0x48, 0xc0, 0x69, 0xff, 0x40, 0x00, 0x05, 0x21, 0xb0, 0xfb,
+  0xf1, 0xf2, 0xf7, 0x00, 0x23, 0x28, 0x0f, 0xb0, 0xa1, 0xf9, 0x3b, 0x48,
+  0xfd, 0x3b, 0xff, 0xd0, 0x08, 0x70, 0x06, 0x23, 0x0f, 0xf2, 0xbf, 0x84,
+  0x12, 0x80, 0x08, 0x06, 0x21, 0xab, 0xe1, 0x03, 0xff, 0xfb, 0x11, 0x00,
+  0x88, 0x46, 0x10, 0xf8, 0x02, 0xff, 0xa0, 0x00, 0x26, 0x01, 0xe0, 0x00,
+  0x2c, 0x46, 0xff, 0xd1, 0x00, 0x27, 0x5f, 0xfa, 0x87, 0xfb, 0x19, 0xff,
+  0xf8, 0x1b, 0x10, 0x40, 0xf2, 0x32, 0x70, 0xec, 0xff, 0xf7, 0xd8, 0xfd,
+  0x09, 0xeb, 0x4b, 0x00, 0x00, 0xeb, 0x24, 0x41, 0x1b, 0xf0, 0x34, 0x0f,
+  0x00, 0xd0, 0xfd, 0x01, 0x5a, 0x49, 0xd0, 0x33, 0x09, 0x00, 0xcb, 0xfd,
+  0x53, 0xd1, 0x35, 0x09, 0x00, 0x7f, 0xc6, 0xfd, 0x51, 0x46, 0x40, 0xf2,
+  0x36, 0x09, 0x00, 0xd7, 0xc1, 0xfd, 0xff, 0x13, 0x00, 0x31, 0x09, 0x00,
+  0xbc, 0xfd, 0xfe, 0xa9, 0x11, 0x4f, 0xf0, 0x01, 0x0b, 0x4f, 0xf0, 0x02,
+  0xdf, 0x0b, 0x4b, 0xea, 0x48, 0x11, 0x0f, 0xf1, 0xe6, 0x60, 0xff, 0xec,
+  0xf7, 0xaf, 0xfd, 0x42, 0xf2, 0x10, 0x73, 0xf7, 0x00, 0x22, 0x59, 0x4b,
+  0x50, 0xe6, 0x60, 0xf3, 0xf7, 0xff, 0x59, 0xfa, 0x00, 0xb1, 0x03, 0x24,
+  0x4c, 0xb9, 0xff, 0x14, 0x48, 0x00, 0x78, 0x06, 0xa9, 0x71, 0x18, 0xff,
+  0x07, 0xeb, 0x47, 0x02, 0x7f, 0x1c, 0x50, 0x54, 0xfe, 0x95, 0xb1, 0x76,
+  0x1c, 0x03, 0x2e, 0xb3, 0xd3, 0x1c, 0x3f, 0xb9, 0x06, 0xa8, 0x00, 0xf0,
+  0x1b, 0x31, 0x10, 0x19, 0x13, 0xbf, 0xe6, 0xfe, 0xfe, 0xf7, 0xf8, 0xf8,
+  0x2b, 0x11, 0x41, 0xdf, 0xfa, 0x20, 0x46, 0x09, 0xb0, 0x85, 0x40, 0x8f,
+  0x00, 0xe3, 0x00, 0xb0, 0x6b, 0x60, 0x77, 0x61, 0x33, 0xe1, 0xe6, 0x04,
+  0x00, 0xff, 0x46, 0x93, 0xf3, 0x00, 0x20, 0x37, 0x07, 0x00, 0xf7, 0x46,
+  0x70, 0xb5, 0x6d, 0xd0, 0x22, 0x00, 0xeb, 0x42, 0xff, 0x03, 0x00, 0x21,
+  0xd9, 0x80, 0x02, 0xeb, 0x42, 0xff, 0x06, 0x36, 0x18, 0xdd, 0x88, 0x8e,
+  0x5d, 0x49, 0xff, 0x1c, 0x75, 0x19, 0x03, 0x29, 0xdd, 0x80, 0xf5, 0xff,
+  0xd3, 0xad, 0xb2, 0x03, 0x21, 0x52, 0x1c, 0xb5, 0x7e, 0x0f, 0x10, 0x02,
+  0x2a, 0xd9, 0x80, 0xe9, 0xd3, 0x2d, 0x00, 0xfd, 0x21, 0x27, 0x00, 0x03,
+  0x1b, 0x18, 0xcb, 0x5c, 0x5b, 0xdf, 0xb1, 0x80, 0x2b, 0x09, 0xda, 0x3d,
+  0x00, 0x06, 0xf6, 0xff, 0x88, 0x9d, 0x1b, 0x4c, 0xbf, 0xf3, 0x1a, 0x9b,
+  0xff, 0x1b, 0x9b, 0xb2, 0x04, 0x2b, 0x00, 0xd3, 0x02, 0xff, 0x24, 0x49,
+  0x1c, 0x03, 0x29, 0xea, 0xd3, 0x52, 0xff, 0x1c, 0x02, 0x2a, 0xe6, 0xd3,
+  0x3c, 0xb9, 0xc1, 0xff, 0x88, 0x00, 0x89, 0x09, 0x1a, 0xc9, 0xb2, 0x48,
+  0xd5, 0x1e, 0xfb, 0x11, 0x02, 0xd7, 0x10, 0x70, 0x7b, 0x30, 0x0c, 0x46,
+  0x7e, 0xff, 0xe0, 0xf6, 0x65, 0x10, 0xec, 0xf7, 0x33, 0xf3, 0x30, 0xee,
+  0x93, 0x31, 0x40, 0xf6, 0x66, 0x0d, 0x00, 0x2c, 0xbd, 0xcb, 0xff, 0xb5,
+  0xa1, 0x8f, 0x80, 0x72, 0x00, 0x00, 0x78, 0xff, 0x00, 0x01, 0x28, 0x3e,
+  0x48, 0x0f, 0xf2, 0x10, 0xfd, 0x12, 0x05, 0x21, 0x44, 0x68, 0xef, 0xf3,
+  0x08, 0x80, 0x7d, 0x20, 0x25, 0x70, 0xef, 0xf3, 0x09, 0x80, 0x60, 0x37,
+  0x50, 0xff, 0x03, 0x80, 0xe0, 0x60, 0x04, 0xf1, 0x10, 0x00, 0x7f, 0x52,
+  0xf8, 0x21, 0x30, 0x1b, 0x68, 0x40, 0x05, 0x00, 0xff, 0x49, 0x1c, 0x13,
+  0x29, 0xf7, 0xd3, 0x15, 0x22, 0x7f, 0x04, 0xf1, 0x5c, 0x01, 0x0f, 0xf2,
+  0x24, 0x4d, 0x00, 0xff, 0x36, 0xfd, 0x20, 0x68, 0x41, 0x6c, 0xa1, 0x60,
+  0xff, 0x11, 0xf1, 0x0f, 0x0f, 0x18, 0xbf, 0x11, 0xf1, 0xff, 0x07, 0x0f,
+  0x06, 0xd1, 0xc1, 0x6d, 0x61, 0x67, 0xff, 0x00, 0x6e, 0xa0, 0x67, 0x20,
+  0x68, 0x40, 0x6e, 0xfd, 0x02, 0xdf, 0xd0, 0x60, 0x67, 0xa0, 0x67, 0xe0,
+  0x67, 0xff, 0x25, 0x48, 0x00, 0x68, 0x90, 0xf8, 0x32, 0x00, 0xaf, 0xc4,
+  0xf8, 0x80, 0x00, 0x37, 0x10, 0x4f, 0x43, 0xf3, 0x20, 0xbf, 0x4c, 0x4f,
+  0xf0, 0xee, 0x31, 0x20, 0x69, 0x50, 0x29, 0xdf, 0xfd, 0x1b, 0x4d, 0x1e,
+  0x49, 0x83, 0x01, 0xa8, 0x60, 0xff, 0x88, 0x42, 0x24, 0xbf, 0x1c, 0x4a,
+  0x82, 0x42, 0xff, 0x04, 0xd2, 0x1b, 0x48, 0x08, 0x18, 0x40, 0x08, 0x7f,
+  0x80, 0xf3, 0x08, 0x88, 0x05, 0xf1, 0x0c, 0x0b, 0xb0, 0x5f, 0xff, 0xf7,
+  0xa6, 0xff, 0x0d, 0xc3, 0xb0, 0x94, 0x83, 0xd0, 0xfd, 0xff, 0x37, 0x02,
+  0x0d, 0xfd, 0x80, 0x22, 0x00, 0x23, 0xff, 0x80, 0x20, 0x00, 0x21, 0xf1,
+  0xf7, 0x14, 0xfd, 0xff, 0x0a, 0x20, 0xf7, 0xf7, 0xe1, 0xf8, 0xf8, 0xf7,
+  0xf7, 0x97, 0xfe, 0x00, 0x69, 0x50, 0x28, 0x70, 0xf8, 0xf7, 0xf7, 0x7a,
+  0xfe, 0x20, 0xcb, 0xc0, 0xfc, 0xd1, 0x28, 0x78, 0xdf, 0x08, 0xb1, 0xf8,
+  0xf7, 0x6d, 0xb4, 0xd0, 0xdb, 0xf8, 0x7e, 0x7f, 0x03, 0xe0, 0xb7, 0x00,
+  0x20, 0x38, 0xbd, 0x8f, 0xe0, 0xff, 0x7f, 0x01, 0x01, 0x88, 0xb8, 0x00,
+  0x20, 0x64, 0xf9, 0xbc, 0xd7, 0xb0, 0x03, 0x00, 0x00, 0xe3, 0x00, 0xe0,
+  0x04, 0x5e, 0x03, 0x01, 0xed, 0x00, 0xe0, 0x24, 0x03, 0x00, 0x28, 0x03,
+  0x00, 0x65, 0x2c, 0x03, 0x00, 0x38, 0x03, 0x00, 0x09, 0xf0, 0x50, 0x44,
+  0x03, 0x00, 0xa9, 0x48, 0x03, 0x00, 0x0b, 0x00, 0x58, 0x0b, 0x00, 0x58,
+  0x28, 0x50, 0x49, 0x55, 0x04, 0x03, 0x00, 0x08, 0x03, 0x00, 0x0c, 0x03,
+  0x00, 0x10, 0x03, 0x00, 0xf5, 0x14, 0x03, 0x00, 0x18, 0x03, 0x00, 0x00,
+  0x0d, 0x01, 0x0d, 0xff, 0x08, 0x0d, 0x09, 0x0d, 0x50, 0x0c, 0x51, 0x0c,
+  0xff, 0x52, 0x0c, 0x53, 0x0c, 0x54, 0x0c, 0x55, 0x0c, 0xff, 0x56, 0x0c,
+  0x57, 0x0c, 0x58, 0x0c, 0x59, 0x0c, 0xff, 0x5a, 0x0c, 0x5b, 0x0c, 0x5c,
+  0x0c, 0x5d, 0x0c, 0x5f, 0x5e, 0x0c, 0x5f, 0x0c, 0x60, 0x38, 0x00, 0xb4,
+  0x47, 0x20, 0xbd, 0x22, 0x76, 0x51, 0x02, 0x00, 0x20, 0x86, 0x06, 0x00,
+  0x78, 0x50, 0x47, 0x20, 0xb1, 0x30, 0x00, 0x06, 0x67, 0x21, 0x03, 0x07,
+  0x00, 0x6c, 0x6b, 0x20, 0x96, 0x6b, 0x00, 0x00, 0x58, 0x1f, 0x04, 0x1c,
+  0x0f, 0x00, 0x97, 0xf1, 0xd8, 0x90, 0x1f, 0x00, 0x97, 0x00, 0x07, 0x06,
+  0xab, 0xc1, 0x24, 0x07, 0x00, 0x4f, 0xb1, 0x20, 0x40, 0x07, 0x00, 0x13,
+  0x91, 0x0f, 0x01, 0x00, 0x05, 0x27, 0x92, 0x07, 0x00, 0x98, 0x1f, 0x00,
+  0x66, 0xab, 0x00, 0x00, 0xc0, 0x67, 0xc0, 0x07, 0x01, 0x28, 0x2c, 0x4f,
+  0x03, 0x51, 0x60, 0x5f, 0x00, 0xe3, 0xf1, 0x00, 0x0f, 0x7e, 0x4c, 0xc7,
+  0x00, 0x60, 0x03, 0x00, 0xc0, 0x63, 0x10, 0x00, 0x0b, 0x13, 0x01, 0x17,
+  0x0f, 0x02, 0x00, 0x0f, 0x11, 0x8d, 0x21, 0xf8, 0x46, 0x7b, 0x89, 0x46,
+  0xe7, 0x41, 0xec, 0xf7, 0xef, 0xfd, 0x0f, 0xf1, 0xff, 0x8d, 0xf8, 0x42,
+  0x4d, 0x42, 0x4c, 0x68, 0x89, 0xff, 0x00, 0x26, 0xc0, 0xf3, 0x01, 0x10,
+  0x00, 0x28, 0xff, 0x40, 0xf2, 0x99, 0x6a, 0x2c, 0xd0, 0xe8, 0x6c, 0xff,
+  0x00, 0xf0, 0x6f, 0xf8, 0x10, 0xb1, 0xf7, 0xf7, 0xbb, 0x83, 0xf8, 0xcf,
+  0xb0, 0x26, 0x42, 0xe0, 0x11, 0x01, 0x4e, 0xaf, 0xf8, 0xa8, 0xbf, 0x64,
+  0x21, 0x50, 0x45, 0x49, 0x80, 0x5b, 0xbf, 0xf8, 0x9c, 0x21, 0x00, 0xf0,
+  0x59, 0x09, 0x00, 0x49, 0xfe, 0x03, 0x00, 0x4c, 0xf8, 0x08, 0xb1, 0x02,
+  0x26, 0x2f, 0xff, 0xe0, 0x31, 0x4f, 0x39, 0x78, 0x40, 0xf6, 0x93, 0xff,
+  0x00, 0xec, 0xf7, 0x6b, 0xfb, 0x7a, 0x78, 0x1f, 0xef, 0x21, 0x40, 0xf6,
+  0x94, 0x0b, 0x00, 0x6f, 0xfb, 0x39, 0xef, 0x79, 0x40, 0xf6, 0x95, 0x09,
+  0x00, 0x60, 0xfb, 0x68, 0xff, 0x89, 0xc0, 0xf3, 0x81, 0x00, 0xd0, 0xb1,
+  0xa8, 0xe9, 0x6b, 0x29, 0xf1, 0x61, 0x01, 0x52, 0x61, 0x00, 0x03, 0x26,
+  0x11, 0x55, 0xe0, 0x11, 0x01, 0x1d, 0x61, 0x04, 0x14, 0x53, 0x00, 0x2a,
+  0x61, 0x02, 0xf5, 0x28, 0x09, 0x00, 0x18, 0x03, 0x00, 0x1b, 0xf8, 0x00,
+  0xb1, 0xdb, 0x04, 0x26, 0xb1, 0x01, 0x43, 0xf8, 0xbd, 0x01, 0xed, 0xfd,
+  0xda, 0x81, 0xb2, 0x86, 0x13, 0xa0, 0x01, 0x50, 0x21, 0x30, 0x33, 0xbb,
+  0xfb, 0x13, 0x49, 0x91, 0x50, 0xf0, 0xc0, 0xb2, 0x65, 0x28, 0x7f, 0x70,
+  0x47, 0x20, 0x21, 0x4f, 0xf4, 0xd9, 0x27, 0x50, 0x9f, 0x28, 0xbb, 0x4f,
+  0xf4, 0x7a, 0x0d, 0x50, 0x0f, 0x03, 0xf2, 0xaf, 0xf7, 0xd2, 0xbf, 0x1c,
+  0x09, 0x00, 0xd2, 0x27, 0x50, 0x1b, 0xff, 0xbb, 0xa4, 0xfb, 0x00, 0x23,
+  0x12, 0x0f, 0x42, 0xbf, 0xea, 0x03, 0x12, 0x1b, 0x0f, 0x00, 0x51, 0x30,
+  0x31, 0xfd, 0xb8, 0xdf, 0x41, 0x22, 0x18, 0x09, 0x91, 0x93, 0x06, 0xff,
+  0x00, 0x46, 0x40, 0x42, 0x0f, 0x00, 0x80, 0xb5, 0xdf, 0x00, 0x21, 0xff,
+  0xf7, 0xda, 0x49, 0xe0, 0x18, 0xf8, 0xf5, 0x1b, 0x79, 0x50, 0x91, 0x37,
+  0x00, 0xff, 0xfa, 0xbd, 0xe8, 0x3f, 0x04, 0x40, 0x7c, 0x21, 0x0a, 0xe0,
+  0x1d, 0x00, 0x57, 0x90, 0x55, 0xdb, 0x17, 0x04, 0xf3, 0x17, 0x02, 0x7e,
+  0x0d, 0x00, 0x0b, 0x9d, 0x00, 0xd7, 0xec, 0xba, 0x07, 0x09, 0x00, 0x83,
+  0x3b, 0x40, 0xe7, 0xba, 0xef, 0x00, 0x00, 0xfe, 0xe7, 0x01, 0x0f, 0x2c,
+  0x2e, 0x4c, 0x2f, 0xff, 0x48, 0x2f, 0x4d, 0x30, 0x49, 0x20, 0x60, 0x20,
+  0xf7, 0x60, 0x01, 0x22, 0xcf, 0x20, 0x60, 0x08, 0x60, 0x2d, 0xbf, 0x49,
+  0x08, 0x60, 0x0f, 0xf2, 0xd0, 0xa1, 0x40, 0xc8, 0xfe, 0xef, 0x60, 0x66,
+  0xf8, 0x2a, 0x49, 0x28, 0x60, 0x09, 0x7f, 0x68, 0x88, 0x42, 0x00, 0xd0,
+  0xfe, 0xe7, 0x09, 0x30, 0xfe, 0x29, 0x00, 0x27, 0x49, 0x27, 0x48, 0x01,
+  0x60, 0x4f, 0xdf, 0xf4, 0xe0, 0x21, 0xc1, 0x61, 0x31, 0x51, 0x00, 0xf0,
+  0xff, 0xab, 0xb8, 0x1c, 0x48, 0x23, 0x4c, 0x4f, 0xf6, 0xff, 0xfe, 0x61,
+  0x01, 0x60, 0x01, 0x60, 0x22, 0x49, 0xff, 0x0a, 0x78, 0x0b, 0x78, 0x43,
+  0xf0, 0x08, 0x03, 0xff, 0x0b, 0x70, 0x23, 0x46, 0x1d, 0x68, 0x1d, 0x60,
+  0xd7, 0x1e, 0x68, 0xae, 0xab, 0x90, 0x17, 0xc3, 0x40, 0x03, 0x60, 0xff,
+  0xfe, 0xe7, 0x1b, 0x1d, 0x04, 0xf5, 0x80, 0x75, 0xff, 0xab, 0x42, 0xf1,
+  0xd3, 0x18, 0x4d, 0xab, 0x42, 0xfb, 0x14, 0xd2, 0x8b, 0x40, 0x35, 0x1d,
+  0x60, 0x1d, 0x68, 0x7f, 0x15, 0xf1, 0x01, 0x0f, 0x03, 0xd0, 0x0d, 0x25,
+  0x04, 0xbb, 0x00, 0x25, 0x13, 0x01, 0x1d, 0xb1, 0x09, 0x35, 0x06, 0xe7,
+  0x87, 0xe7, 0x0a, 0x70, 0x51, 0x90, 0x61, 0x00, 0xfb, 0xb1, 0x43, 0x41,
+  0x00, 0x4f, 0x00, 0xab, 0xab, 0xe4, 0x7f, 0x40, 0x83, 0x41, 0xf4, 0x03,
+  0x00, 0x99, 0xe0, 0x03, 0x00, 0x8e, 0x20, 0x01, 0x08, 0x6b, 0x40, 0x07,
+  0x00, 0x20, 0x3f, 0x00, 0x0d, 0x00, 0x46, 0xff, 0xff, 0x07, 0x00, 0x13,
+  0x00, 0xf9, 0xdf, 0x1b, 0x00, 0x0b, 0xc1, 0x00, 0x23, 0x00, 0x25, 0x0f,
+  0xff, 0xf2, 0x64, 0x08, 0x15, 0xe0, 0x17, 0xf8, 0x06, 0xff, 0xe0, 0x4f,
+  0xea, 0x1e, 0x14, 0x44, 0xea, 0x03, 0xff, 0x14, 0x1b, 0x0f, 0x58, 0xf8,
+  0x23, 0x30, 0x63, 0xdf, 0x40, 0x0e, 0xf0, 0x0f, 0x04, 0x0f, 0x09, 0x7f,
+  0x1c, 0xff, 0x67, 0x45, 0xea, 0xd3, 0x6d, 0x1c, 0x95, 0x42, 0xff, 0x08,
+  0xd2, 0x50, 0xf8, 0x25, 0x60, 0x51, 0xf8, 0xff, 0x25, 0x70, 0xbf, 0x1b,
+  0x07, 0xf1, 0x01, 0x0c, 0x7f, 0x00, 0x27, 0xf1, 0xe7, 0x04, 0x20, 0x19,
+  0x27, 0x00, 0x7f, 0x21, 0x10, 0x81, 0xea, 0x03, 0x11, 0x0a, 0x09, 0x00,
+  0xff, 0x22, 0x20, 0x40, 0x1e, 0x82, 0xea, 0x01, 0x13, 0xf7, 0xf3, 0xd1,
+  0x18, 0x51, 0xd4, 0x00, 0x00, 0xb7, 0x1d, 0xff, 0xc1, 0x04, 0x6e, 0x3b,
+  0x82, 0x09, 0xd9, 0x26, 0xff, 0x43, 0x0d, 0xdc, 0x76, 0x04, 0x13, 0x6b,
+  0x6b, 0xff, 0xc5, 0x17, 0xb2, 0x4d, 0x86, 0x1a, 0x05, 0x50, 0xff, 0x47,
+  0x1e, 0xb8, 0xed, 0x08, 0x26, 0x0f, 0xf0, 0xff, 0xc9, 0x22, 0xd6, 0xd6,
+  0x8a, 0x2f, 0x61, 0xcb, 0xff, 0x4b, 0x2b, 0x64, 0x9b, 0x0c, 0x35, 0xd3,
+  0x86, 0xff, 0xcd, 0x31, 0x0a, 0xa0, 0x8e, 0x3c, 0xbd, 0xbd, 0xff, 0x4f,
+  0x38, 0x01, 0x20, 0xc0, 0x46, 0x00, 0x28, 0xb5, 0x01, 0x7f, 0x80, 0x08,
+  0x9b, 0x20, 0xc0, 0x46, 0x0d, 0x00, 0xf0, 0xf5, 0x17, 0x6f, 0x10, 0x6f,
+  0x1b, 0x90, 0x10, 0xb5, 0x07, 0x49, 0xff, 0x79, 0x44, 0x18, 0x31, 0x06,
+  0x4c, 0x7c, 0x44, 0xff, 0x16, 0x34, 0x04, 0xe0, 0x0a, 0x68, 0x08, 0x1d,
+  0xff, 0x51, 0x18, 0x88, 0x47, 0x01, 0x46, 0xa1, 0x42, 0xff, 0xf8, 0xd1,
+  0x10, 0xbd, 0x20, 0x0a, 0x00, 0x00, 0xfd, 0xfc, 0x03, 0x00, 0x00, 0xb5,
+  0x87, 0xb0, 0xf1, 0xf7, 0xf3, 0x50, 0xf9, 0x3d, 0x01, 0x01, 0x01, 0xea,
+  0xf7, 0xc4, 0xff, 0xff, 0x03, 0x21, 0x04, 0x91, 0x00, 0x21, 0x03, 0x91,
+  0xff, 0x64, 0x21, 0x02, 0x91, 0x05, 0x21, 0x1e, 0x48, 0xff, 0x01, 0x90,
+  0x00, 0x91, 0x00, 0xf5, 0xc6, 0x72, 0xff, 0x05, 0x23, 0x00, 0x21, 0x0f,
+  0xf2, 0x1d, 0x00, 0xff, 0xeb, 0xf7, 0x2d, 0xfe, 0x05, 0xaa, 0x0f, 0xf2,
+  0xff, 0x70, 0x01, 0x05, 0x20, 0xeb, 0xf7, 0xde, 0xfe, 0x77, 0xeb, 0xf7,
+  0x7b, 0x7f, 0x00, 0x07, 0xb0, 0x00, 0xa3, 0x90, 0xff, 0x80, 0xb5, 0xf0,
+  0xf7, 0xaf, 0xff, 0x40, 0x1e, 0xff, 0x80, 0x41, 0xc0, 0x0f, 0xf1, 0xf7,
+  0xab, 0xf8, 0xff, 0xf7, 0xf7, 0x74, 0xf8, 0x0e, 0x48, 0x00, 0x6c, 0xff,
+  0x40, 0x1e, 0xb0, 0xf1, 0x80, 0x7f, 0x08, 0xd2, 0xff, 0x0c, 0x49, 0x0d,
+  0x4a, 0x48, 0x60, 0xf0, 0x20, 0xdb, 0x10, 0x70, 0x0f, 0x60, 0x60, 0x07,
+  0x77, 0xa0, 0xeb, 0xf7, 0xff, 0x31, 0xf8, 0x68, 0x46, 0xf2, 0xf7, 0xf8,
+  0xfb, 0xff, 0xeb, 0xf7, 0x41, 0xf8, 0xf3, 0xf7, 0x2a, 0xf8, 0xbf, 0xf2,
+  0xf7, 0xf0, 0xff, 0xfc, 0xe7, 0xc3, 0x10, 0x80, 0xbe, 0xf7, 0x73, 0x10,
+  0xe0, 0x00, 0xe0, 0x23, 0xb3, 0x10, 0x53, 0xef, 0x74, 0x61, 0x72, 0x74,
+  0x34, 0x11, 0xf0, 0x00, 0xb8, 0x77, 0x07, 0x46, 0x38, 0xed, 0x00, 0x02,
+  0xf8, 0xfb, 0x27, 0x00, 0xfb, 0x80, 0xb5, 0xb9, 0x01, 0x02, 0x4a, 0x11,
+  0x00, 0x18, 0xbf, 0x20, 0xab, 0xbe, 0xfb, 0xe7, 0x26, 0xe4, 0x50, 0x49,
+  0xff, 0x6e, 0x69, 0x74, 0x20, 0x43, 0x61, 0x6c, 0x54, 0x77, 0x61, 0x73,
+  0x6b, 0x32, 0x01, 0x52, 0x78, 0x31, 0x0e, 0x06, 0x57, 0x52, 0x78, 0x32,
+  0x0b, 0x06, 0x54, 0x17, 0x08, 0x54, 0x17, 0x0c, 0xe7, 0x4c, 0x4f, 0x4c,
+  0x1b, 0x0a, 0x0f, 0x09, 0x4f, 0x52, 0x58, 0xc0, 0x38, 0x07, 0x00, 0x00,
+  0x0f, 0x00, 0x3c, 0x07, 0x00, 0x00, 0x3f, 0x01, 0x44, 0x50, 0x71, 0x44,
+  0x3f, 0x0a, 0x0f, 0x0b, 0x3e, 0x00, 0x4c, 0x47, 0x43, 0x33, 0x0b, 0xfc,
+  0x42, 0x00, 0x13, 0x0e, 0x31, 0x20, 0x56, 0x53, 0x57, 0x52, 0xfc, 0x27,
+  0x0d, 0x13, 0x0f, 0x00, 0x31, 0x20, 0x50, 0x41, 0x20, 0x42, 0xe7, 0x49,
+  0x41, 0x53, 0x73, 0x0a, 0x13, 0x0d, 0x65, 0xfe, 0x00, 0xf0, 0xf6, 0x62,
+  0xbd, 0x30, 0x00, 0x06, 0x0b, 0x05, 0x31, 0x16, 0x00, 0x01, 0x7d, 0x38,
+  0x07, 0x00, 0x5d, 0x59, 0x01, 0x01, 0x65, 0x03, 0x00, 0x3e, 0x0b, 0x01,
+  0x67, 0xdc, 0x00, 0x01, 0x85, 0x03, 0x00, 0x52, 0x20, 0x3e, 0x00, 0x0a,
+  0xd1, 0x61, 0x00, 0x01, 0xd3, 0x03, 0x00, 0x17, 0x01, 0x9f, 0x4b, 0x34,
+  0x00, 0x01, 0x4d, 0x03, 0x00, 0x0b, 0x01, 0x98, 0x9a, 0x5f, 0x70, 0x10,
+  0x61, 0x00, 0xa8, 0x03, 0x07, 0x03, 0x2f, 0x75, 0x88, 0x7c, 0x2f, 0x70,
+  0xff, 0x61, 0x2c, 0x27, 0x00, 0x20, 0x44, 0x82, 0x00, 0x55, 0xd8, 0x0f,
+  0x70, 0x36, 0x07, 0x00, 0xf4, 0x17, 0x00, 0x1a, 0x4f, 0x71, 0xfe, 0x0f,
+  0x74, 0xfc, 0xe9, 0x00, 0x20, 0x98, 0xea, 0x00, 0xfb, 0x20, 0x9c, 0x0b,
+  0x00, 0x34, 0xeb, 0x00, 0x20, 0xd0, 0x94, 0x03, 0x00, 0x0b, 0x01, 0x90,
+  0x07, 0x20, 0xc4, 0x03, 0x00, 0x81, 0xc0, 0x00, 0x95, 0xb0, 0x33, 0x00,
+  0xcc, 0x03, 0x00, 0x1c, 0x5b, 0x61, 0x4f, 0x00, 0x04, 0xfa, 0x63, 0x70,
+  0x94, 0x0b, 0x00, 0xa0, 0xef, 0x00, 0x20, 0xe4, 0xfc, 0x03, 0x00, 0x37,
+  0x80, 0x00, 0x8c, 0xed, 0x00, 0x20, 0xe0, 0x2a, 0x03, 0x00, 0x54, 0x0b,
+  0x00, 0x38, 0x5b, 0x00, 0x3c, 0x03, 0x00, 0x47, 0x80, 0xfc, 0xf5, 0x30,
+  0x1b, 0x93, 0x83, 0xb0, 0x07, 0x46, 0xed, 0xf7, 0xff, 0x62, 0xf9, 0xed,
+  0xf7, 0x36, 0xf9, 0x00, 0x2f, 0xff, 0x04, 0x46, 0x0c, 0xbf, 0x02, 0x25,
+  0x03, 0x25, 0xff, 0x35, 0x4e, 0xdf, 0xf8, 0xd4, 0x80, 0xed, 0xf7, 0xff,
+  0x63, 0xf9, 0xb8, 0x55, 0x4f, 0xf0, 0x6c, 0x0a, 0xfe, 0x85, 0xc1, 0x85,
+  0xff, 0x07, 0xf1, 0x1f, 0x00, 0x8d, 0xff, 0xf8, 0x04, 0x00, 0x4c, 0xb9,
+  0x06, 0xe0, 0x01, 0xff, 0x21, 0xed, 0xf7, 0x77, 0xf9, 0x14, 0xb1, 0x14,
+  0xfe, 0x8d, 0x40, 0x01, 0xd0, 0xed, 0xf7, 0xd1, 0xf9, 0xb8, 0xab, 0x5d,
+  0x03, 0x13, 0x00, 0x6d, 0x07, 0x00, 0x00, 0x07, 0x00, 0x69, 0xeb, 0xf9,
+  0x9d, 0x29, 0x00, 0x01, 0x2f, 0x90, 0x01, 0xf8, 0xed, 0xfb, 0xf7, 0x98,
+  0x5f, 0x00, 0x3d, 0xf9, 0x0a, 0xfb, 0x00, 0xff, 0x89, 0xeb, 0xf7, 0xa6,
+  0xfd, 0xc9, 0xf8, 0x38, 0xbf, 0x00, 0x4f, 0xf4, 0x60, 0x71, 0x06, 0xa7,
+  0xc0, 0x01, 0xef, 0xfb, 0x07, 0x02, 0x01, 0xff, 0xb0, 0xf8, 0xf7, 0x5c,
+  0xfb, 0xff, 0x81, 0x33, 0xc0, 0xec, 0xf7, 0x05, 0xfb, 0xed, 0xff, 0xf7,
+  0x27, 0xf9, 0x83, 0x46, 0xeb, 0xf7, 0x91, 0xff, 0xfd, 0x0a, 0xfb, 0x0b,
+  0x81, 0x8a, 0x6b, 0x82, 0xfb, 0x42, 0x23, 0x6b, 0xb0, 0xff, 0x33, 0x9a,
+  0x1a, 0x80, 0x7f, 0x18, 0x80, 0x1a, 0xc8, 0x63, 0x00, 0x21, 0x5b, 0x01,
+  0xff, 0xf0, 0xf7, 0xd4, 0xff, 0xb8, 0x5d, 0xb9, 0xf1, 0x5f, 0x00, 0x0f,
+  0xb8, 0xd0, 0x02, 0x71, 0x00, 0x30, 0x79, 0x00, 0xfa, 0x95, 0x01, 0x2c,
+  0x6b, 0x00, 0x0e, 0xf9, 0x0d, 0xf1, 0x05, 0xad, 0x01, 0xad, 0x30, 0x23,
+  0x82, 0x7b, 0x60, 0xeb, 0x0f, 0x00, 0xa9, 0x7e, 0x1f, 0x30, 0x40, 0xc8,
+  0x00, 0x20, 0x8c, 0x09, 0xe7, 0x40, 0xea, 0xfb, 0x0a, 0xe4, 0x9f, 0x00,
+  0xb8, 0x7d, 0xb0, 0x38, 0x00, 0x18, 0xf7, 0xbf, 0x01, 0x20, 0xdf, 0x01,
+  0xed, 0xf7, 0xe7, 0xf8, 0xff, 0x32, 0x4d, 0xdf, 0xf8, 0xcc, 0x80, 0x78,
+  0x55, 0xef, 0x07, 0xf1, 0x1d, 0x06, 0x6d, 0x01, 0xf8, 0xf7, 0x05, 0xd9,
+  0xff, 0x09, 0x11, 0xfb, 0x05, 0xf9, 0xf8, 0xfb, 0x07, 0x53, 0xf9, 0x5d,
+  0x78, 0xfb, 0x02, 0xef, 0xf8, 0x78, 0xfb, 0x02, 0xeb, 0xc1, 0xc0, 0xff,
+  0xf0, 0xb2, 0xf0, 0xf7, 0x84, 0xff, 0xed, 0xf7, 0xad, 0x1b, 0x8d, 0x00,
+  0xc0, 0xf8, 0xf9, 0x03, 0x29, 0xf9, 0x06, 0x05, 0xbc, 0xf9, 0x04, 0x23,
+  0x13, 0xf8, 0xf7, 0xdd, 0xfe, 0xfb, 0x03, 0x87, 0x5f, 0xfa, 0xed, 0xf7,
+  0xa9, 0xf8, 0xfb, 0x01, 0x13, 0xfb, 0x0f, 0x07, 0xae, 0x59, 0x01, 0x57,
+  0xff, 0x78, 0xf9, 0x02, 0xb9, 0xf9, 0x02, 0xb3, 0xb4, 0x77, 0x00, 0x93,
+  0x01, 0xaf, 0xc9, 0x00, 0x91, 0xf8, 0xf9, 0x0b, 0x91, 0xdf, 0xf8, 0xaa,
+  0xe7, 0x48, 0xcf, 0xf7, 0x09, 0xfe, 0x4f, 0xd5, 0x05, 0xf5, 0x00, 0x69,
+  0x2b, 0x00, 0x3d, 0xf5, 0x00, 0x02, 0x95, 0xff, 0xed, 0xf7, 0x70, 0xf8,
+  0x81, 0x46, 0x02, 0x98, 0xff, 0xdf, 0xf8, 0xb8, 0x80, 0x01, 0x27, 0x00,
+  0xf1, 0xfb, 0x25, 0x06, 0xe7, 0x01, 0x44, 0xb9, 0x05, 0xe0, 0x00, 0x1b,
+  0xf0, 0x56, 0xe5, 0x08, 0xe0, 0xf8, 0xb7, 0x80, 0x83, 0x80, 0xdb, 0x03,
+  0xd5, 0x16, 0xdb, 0x00, 0xad, 0x43, 0x00, 0x52, 0xdb, 0x01, 0x85, 0xeb,
+  0xff, 0xf7, 0xbb, 0xfc, 0xa8, 0x63, 0xc8, 0x23, 0x02, 0xff, 0x99, 0x1d,
+  0x48, 0x03, 0xfb, 0x01, 0x01, 0x02, 0xff, 0x98, 0x3a, 0x46, 0xf6, 0xf7,
+  0x5b, 0xfd, 0x05, 0xac, 0xeb, 0x80, 0x2d, 0x01, 0xff, 0xfe, 0xdd, 0x01,
+  0x18, 0xdd, 0x00, 0x3a, 0xb6, 0xdd, 0x02, 0xa4, 0xfc, 0xdd, 0x01, 0x00,
+  0x27, 0xdf, 0x0f, 0x00, 0x01, 0xff, 0x2d, 0x18, 0xbf, 0x02, 0x2d, 0x04,
+  0xd0, 0x03, 0xff, 0x2d, 0x1c, 0xbf, 0x04, 0x2d, 0x0c, 0x2d, 0xbc, 0xab,
+  0xd1, 0x02, 0x75, 0x00, 0x13, 0xcd, 0x50, 0x10, 0x6d, 0x00, 0x22, 0x77,
+  0xf8, 0x01, 0xa9, 0xdb, 0x07, 0x23, 0xf8, 0xaf, 0xd5, 0x10, 0x6c, 0xe3,
+  0x20, 0xdb, 0x00, 0x6c, 0xe8, 0xa7, 0xa0, 0x21, 0x48, 0xd9, 0x00, 0xe9,
+  0x2c, 0x65, 0xb0, 0xdf, 0x15, 0x83, 0x99, 0x80, 0xf4, 0xff, 0xec, 0xaf,
+  0xf7, 0xc8, 0xff, 0x04, 0x09, 0x00, 0xfc, 0x61, 0x20, 0x0b, 0xff, 0xf1,
+  0x29, 0x06, 0x6c, 0x27, 0xdf, 0xf8, 0xac, 0x5d, 0x80, 0xc9, 0x13, 0x00,
+  0xf0, 0x54, 0xe3, 0x08, 0x6e, 0xe3, 0x02, 0xfd, 0x4b, 0xe3, 0x04, 0xa4,
+  0xfe, 0xed, 0xf7, 0x3b, 0xf8, 0x5f, 0xec, 0xf7, 0xe0, 0xff, 0x07, 0xe3,
+  0x02, 0x49, 0xe3, 0x00, 0x7f, 0x1d, 0x48, 0x00, 0xeb, 0x4b, 0x11, 0x58,
+  0x9f, 0xf0, 0xf3, 0x93, 0xff, 0xdd, 0x00, 0xd5, 0x00, 0xad, 0xf9, 0xec,
+  0xf7, 0xf7, 0xcf, 0xff, 0x82, 0xd5, 0x00, 0x39, 0xfc, 0x07, 0xfb, 0xad,
+  0x0a, 0xb3, 0x1f, 0x07, 0x7d, 0xfe, 0xdb, 0x05, 0x04, 0xdb, 0x00, 0x05,
+  0xaf, 0x2d, 0x0b, 0x2d, 0xbf, 0xdb, 0x02, 0x14, 0x6d, 0x00, 0x00, 0xdb,
+  0xf0, 0x11, 0x67, 0x00, 0xb3, 0xff, 0xdd, 0x07, 0xea, 0xf7, 0x99, 0xb4,
+  0x7f, 0x60, 0xdf, 0x07, 0x40, 0xf2, 0x3f, 0x40, 0xc3, 0x00, 0xbd, 0xfd,
+  0xbf, 0xe7, 0x51, 0x01, 0x29, 0x08, 0xbf, 0xfe, 0xf7, 0xa3, 0xce, 0xfb,
+  0x2b, 0x40, 0x5d, 0xf2, 0xe9, 0x03, 0x7f, 0xe9, 0x00, 0x53, 0x6a, 0xe9,
+  0x02, 0x87, 0xe9, 0x02, 0x23, 0xe9, 0x02, 0x98, 0x80, 0xcb, 0x13, 0xdd,
+  0x4c, 0xe7, 0x06, 0xec, 0xf7, 0xfa, 0x6b, 0xf1, 0xf0, 0x44, 0xbe, 0xe7,
+  0x04, 0x30, 0xfe, 0xec, 0xf7, 0xc7, 0x3b, 0x00, 0x6c, 0xfe, 0xe7, 0x04,
+  0xd5, 0xfb, 0xa8, 0x63, 0x4f, 0xf4, 0x22, 0xff, 0x71, 0x18, 0x48, 0x01,
+  0xfb, 0x0b, 0x01, 0x58, 0x56, 0x61, 0xf0, 0xe6, 0xfa, 0xeb, 0x03, 0x37,
+  0xeb, 0x00, 0x59, 0xeb, 0x02, 0xfb, 0xc3, 0xfb, 0xeb, 0x0f, 0x0a, 0x07,
+  0xfe, 0x00, 0x2d, 0xc5, 0xae, 0x9b, 0x20, 0x00, 0xf0, 0x12, 0xb9, 0x10,
+  0x0f, 0xdb, 0x00, 0x45, 0xce, 0xdb, 0x0a, 0x46, 0xff, 0xb8, 0xd9, 0x00,
+  0xd7, 0x01, 0x50, 0xd6, 0x5e, 0xb7, 0x13, 0xec, 0xf7, 0x50, 0xbf, 0xb7,
+  0x1b, 0x18, 0x91, 0x00, 0xab, 0xec, 0xfe, 0xcd, 0x01, 0x20, 0xcd, 0x02,
+  0x27, 0xcd, 0x02, 0xa0, 0xaa, 0xcd, 0x04, 0x4d, 0xcd, 0x08, 0x93, 0xcd,
+  0x02, 0x45, 0xcd, 0x04, 0xc9, 0xa9, 0xfd, 0xe7, 0xa0, 0x3b, 0x00, 0x05,
+  0xcd, 0x04, 0x6e, 0xcd, 0x00, 0x58, 0x5f, 0x46, 0xf3, 0xf7, 0x28, 0xf9,
+  0xc3, 0x03, 0xd5, 0x8d, 0x00, 0xeb, 0xf7, 0xfe, 0xc3, 0x01, 0x61, 0xc3,
+  0x0f, 0x0b, 0xa5, 0xfd, 0x05, 0xea, 0xaf, 0x10, 0x01, 0xaf, 0x10, 0x06,
+  0xaf, 0x10, 0x02, 0x2d, 0x0e, 0xab, 0x2d, 0xc3, 0xaf, 0x12, 0x11, 0xd1,
+  0x00, 0x0e, 0x43, 0x00, 0xdc, 0x9d, 0xfe, 0xd1, 0x09, 0xdd, 0xfe, 0xb6,
+  0xab, 0x16, 0xcf, 0x03, 0xe8, 0x55, 0xbe, 0xcf, 0x0b, 0xb0, 0x65, 0x10,
+  0x84, 0xcf, 0x02, 0xb8, 0xed, 0x30, 0x57, 0x0b, 0xf1, 0x21, 0x9d, 0x1a,
+  0x4b, 0xcf, 0x08, 0x2b, 0xcf, 0x02, 0xd5, 0x43, 0xcf, 0x04, 0x61, 0xcf,
+  0x00, 0xf8, 0x3b, 0x00, 0x9d, 0xfe, 0xda, 0xcf, 0x03, 0x06, 0xcf, 0x00,
+  0x38, 0x21, 0x9b, 0x15, 0xea, 0xf7, 0xab, 0x7e, 0xf8, 0xd7, 0x03, 0x69,
+  0x93, 0x00, 0x8b, 0xd7, 0x02, 0xf5, 0x7d, 0xfa, 0xd7, 0x0f, 0x0a, 0x39,
+  0xfd, 0x00, 0x2d, 0xc6, 0x9b, 0x1a, 0x5d, 0x77, 0xc9, 0x0a, 0x78, 0xfe,
+  0xb9, 0x9b, 0x14, 0x20, 0x67, 0x60, 0xd6, 0xcb, 0x03, 0x82, 0xbe, 0x9b,
+  0xb1, 0x64, 0x17, 0xd1, 0x1f, 0x00, 0xab, 0x20, 0x84, 0x07, 0x00, 0xd0,
+  0x6b, 0x60, 0x21, 0x17, 0xe1, 0x08, 0x57, 0x00, 0x20, 0x5c, 0x07, 0x00,
+  0x74, 0x57, 0x64, 0x1c, 0x1f, 0x00, 0x92, 0x1b, 0xd1, 0x30, 0x07, 0x00,
+  0x3f, 0xe1, 0x88, 0x07, 0x71, 0x07, 0x00, 0x19, 0xff, 0xe0, 0x50, 0xf8,
+  0x04, 0x1b, 0xcb, 0x07, 0x44, 0xff, 0xbf, 0xa9, 0xf1, 0x01, 0x03, 0x59,
+  0x18, 0x12, 0xff, 0x1f, 0x00, 0x23, 0x04, 0x2a, 0x41, 0xf8, 0x04, 0xff,
+  0x3b, 0xf9, 0xd2, 0x5f, 0xea, 0x82, 0x7c, 0x0b, 0xff, 0x46, 0x04, 0xd5,
+  0x4f, 0xf0, 0x00, 0x0c, 0xa1, 0xbf, 0xf8, 0x00, 0xc0, 0x9b, 0x1c, 0xd1,
+  0x27, 0x00, 0x00, 0xf7, 0x21, 0x19, 0x70, 0x33, 0x00, 0x2b, 0x00, 0x2a,
+  0xe1, 0x77, 0xd1, 0x70, 0x47, 0xf3, 0x21, 0x04, 0xd0, 0x02, 0xf7, 0x20,
+  0xff, 0xf2, 0xf7, 0xcb, 0xf8, 0x01, 0xe0, 0xf2, 0xf7, 0xf3, 0x0c, 0xf9,
+  0xfd, 0x21, 0xdf, 0x90, 0x4c, 0x02, 0x21, 0x21, 0xff, 0x60, 0x00, 0x21,
+  0x61, 0x60, 0xf2, 0xf7, 0x17, 0x7f, 0xf9, 0x08, 0x21, 0x60, 0x60, 0x21,
+  0x60, 0xb3, 0xf1, 0xdb, 0x0e, 0xf8, 0x1d, 0xb0, 0x00, 0x20, 0x97, 0x00,
+  0x38, 0xb5, 0xff, 0x0c, 0x4c, 0x0c, 0x49, 0x20, 0x68, 0xc9, 0x6a, 0xff,
+  0x88, 0x42, 0x34, 0xbf, 0x65, 0x79, 0x25, 0x79, 0xd7, 0x2a, 0x46, 0x7f,
+  0x87, 0xc0, 0x9e, 0x73, 0x90, 0xe1, 0xfc, 0xff, 0x94, 0xf9, 0x06, 0x00,
+  0x41, 0x19, 0xc9, 0xb2, 0xf7, 0x4f, 0xf4, 0xe2, 0x0f, 0x00, 0xcf, 0xfc,
+  0x00, 0x20, 0x31, 0x32, 0xbf, 0x90, 0xff, 0xe1, 0xf3, 0x01, 0x49, 0xff,
+  0x19, 0xb0, 0x1f, 0xa0, 0x35, 0x68, 0xaf, 0xe0, 0x00, 0xd0, 0x00, 0x68,
+  0x36, 0x07, 0x00, 0xa0, 0x70, 0xab, 0x68, 0x76, 0x07, 0x00, 0x06, 0x07,
+  0x00, 0x4e, 0x07, 0x04, 0x54, 0xca, 0x07, 0x04, 0x5a, 0x07, 0x04, 0x60,
+  0x07, 0x00, 0x10, 0x10, 0x68, 0x66, 0xaa, 0x07, 0x04, 0x6a, 0x07, 0x04,
+  0x6e, 0x07, 0x04, 0x72, 0x4f, 0x04, 0x3e, 0xb4, 0x07, 0x04, 0xc3, 0x10,
+  0xf0, 0x27, 0x80, 0x68, 0x7c, 0x07, 0x03, 0x58, 0x69, 0x7e, 0x3d, 0x20,
+  0x3f, 0xf1, 0x81, 0x07, 0x03, 0x48, 0x82, 0x77, 0x04, 0x8f, 0x78, 0x00,
+  0x20, 0x90, 0x1f, 0x00, 0x13, 0xa1, 0x0f, 0x02, 0x7a, 0xff, 0x00, 0x20,
+  0x7c, 0x36, 0x00, 0x00, 0x18, 0xbd, 0xbe, 0xbf, 0xb2, 0x00, 0x6b, 0xb8,
+  0xfe, 0xff, 0xc7, 0x81, 0x6e, 0xbc, 0xeb, 0xf0, 0xe3, 0xf1, 0x99, 0x51,
+  0xff, 0xff, 0x0a, 0x01, 0x10, 0x9f, 0x8a, 0xfe, 0xff, 0x88, 0xbc, 0xbb,
+  0x13, 0x9f, 0xf1, 0x94, 0xb8, 0x0b, 0x00, 0xc0, 0x82, 0xa3, 0x20, 0x80,
+  0xb5, 0xec, 0x65, 0x22, 0x35, 0xff, 0xfd, 0xbd, 0xe8, 0x01, 0x40, 0xec,
+  0xf7, 0x68, 0xfc, 0xff, 0x00, 0x00, 0x0f, 0x72, 0x10, 0x25, 0xe0, 0x02,
+  0xd4, 0x01, 0xff, 0xbf, 0x00, 0x63, 0x00, 0x00, 0x05, 0x4b, 0x01, 0xff,
+  0xc4, 0x07, 0x32, 0x01, 0xf8, 0x04, 0x99, 0x00, 0xff, 0xbc, 0x03, 0x24,
+  0x00, 0x30, 0x00, 0x1e, 0x00, 0xff, 0x17, 0x00, 0xcd, 0x00, 0xc4, 0x01,
+  0x80, 0x01, 0xff, 0xc7, 0x00, 0x69, 0x20, 0x10, 0x0b, 0xb6, 0x02, 0xff,
+  0x22, 0x07, 0x56, 0x03, 0xd5, 0x05, 0x72, 0x02, 0xf7, 0xe5, 0x03, 0x17,
+  0x0f, 0x00, 0x26, 0x00, 0x1d, 0x00, 0x7d, 0xe3, 0x18, 0xb0, 0xc7, 0x01,
+  0xc1, 0x00, 0x65, 0x0f, 0x00, 0xff, 0xbf, 0x00, 0x89, 0x07, 0xa8, 0x00,
+  0x04, 0x05, 0xff, 0x56, 0x00, 0xe9, 0x03, 0x27, 0x20, 0xf0, 0x04, 0xff,
+  0x0f, 0x1f, 0x00, 0x18, 0x00, 0xcf, 0x00, 0x60, 0xfd, 0x80, 0x8b, 0x10,
+  0x01, 0x02, 0x03, 0x00, 0x01, 0x52, 0xf7, 0xff, 0x01, 0x30, 0x57, 0x10,
+  0x64, 0x16, 0x50, 0x01, 0xff, 0xdf, 0xa2, 0x05, 0x1e, 0x10, 0x01, 0x03,
+  0x00, 0xff, 0x0a, 0x0a, 0xf0, 0x31, 0x00, 0xb8, 0x0c, 0xf6, 0xff, 0x0d,
+  0x42, 0x15, 0x4f, 0x1b, 0xf9, 0x24, 0xb1, 0xff, 0x2d, 0xb7, 0x39, 0xd5,
+  0x44, 0xeb, 0x52, 0xfe, 0xff, 0x5f, 0x8b, 0x6f, 0xe2, 0x7d, 0x14, 0x8e,
+  0xc9, 0xff, 0x9c, 0x9f, 0xac, 0xa8, 0xba, 0x0e, 0xc9, 0x5d, 0xff, 0xd5,
+  0x45, 0xe1, 0xde, 0xea, 0x5f, 0xf3, 0x79, 0xff, 0xf9, 0xe7, 0xfd, 0xff,
+  0xff, 0x1f, 0xe0, 0x00, 0xff, 0x01, 0x12, 0x03, 0x71, 0x10, 0x0a, 0x0a,
+  0xd7, 0xfb, 0xa3, 0x3b, 0xab, 0x50, 0x40, 0xac, 0xc5, 0xa7, 0x38, 0xff,
+  0x22, 0x20, 0x0f, 0x3f, 0x6f, 0x12, 0x83, 0x3a, 0xff, 0x17, 0xb7, 0xd1,
+  0x38, 0x95, 0xbf, 0xd6, 0x33, 0xff, 0x0a, 0xd7, 0x23, 0x3c, 0x04, 0x11,
+  0x20, 0x20, 0xff, 0x5f, 0x3f, 0xed, 0xdf, 0x4b, 0x3e, 0x33, 0x63, 0xff,
+  0x94, 0x35, 0xdc, 0x6e, 0xc8, 0x37, 0x5e, 0x72, 0xff, 0x0b, 0x37, 0x1a,
+  0xd6, 0x38, 0x36, 0x46, 0xf6, 0xff, 0x71, 0x35, 0x0f, 0xde, 0x8e, 0x34,
+  0xc7, 0xb4, 0xff, 0x6f, 0x33, 0x63, 0x2e, 0x2e, 0x31, 0x06, 0xb1, 0xff,
+  0xe7, 0x31, 0x88, 0x5d, 0x01, 0x33, 0xe2, 0x10, 0xff, 0x70, 0x33, 0x5b,
+  0xb5, 0xaf, 0x33, 0x34, 0x9f, 0xff, 0xe3, 0x33, 0xb3, 0x7c, 0x07, 0x34,
+  0xdb, 0x33, 0xff, 0x1d, 0x34, 0x6c, 0x83, 0x31, 0x34, 0xa5, 0x95, 0xff,
+  0x47, 0x34, 0xae, 0xb5, 0x64, 0x34, 0xb7, 0xff, 0xff, 0x8a, 0x34, 0x99,
+  0x7f, 0xc1, 0x34, 0x10, 0x6f, 0xff, 0x2e, 0x35, 0xa0, 0xd0, 0x56, 0x36,
+  0xbd, 0x37, 0xff, 0x86, 0x35, 0x9e, 0x21, 0x8c, 0x21, 0xee, 0x12, 0xff,
+  0x06, 0x04, 0x12, 0x08, 0x04, 0x20, 0x02, 0xf9, 0xff, 0x83, 0x01, 0x3d,
+  0x04, 0xc1, 0xba, 0x45, 0x10, 0xff, 0xf4, 0x01, 0x5c, 0xb6, 0x5c, 0x38,
+  0x10, 0x21, 0x7f, 0x04, 0xf5, 0x85, 0x10, 0xf1, 0xff, 0x01, 0x02, 0x04,
+  0x7f, 0x21, 0x01, 0xb0, 0x05, 0xff, 0x00, 0x07, 0x18, 0xb1, 0xff, 0x04,
+  0x43, 0x90, 0x01, 0x04, 0x43, 0x70, 0x17, 0xff, 0x04, 0xc3, 0x32, 0x00,
+  0x04, 0x52, 0xc8, 0x04, 0xff, 0x43, 0xe8, 0x03, 0x04, 0xd2, 0x20, 0x04,
+  0x2d, 0x9f, 0xf0, 0x05, 0xf2, 0xff, 0x00, 0x2f, 0x05, 0x02, 0x0f, 0x24,
+  0x20, 0xff, 0x01, 0xfc, 0x0d, 0x02, 0x01, 0x06, 0x07, 0x04, 0xff, 0x05,
+  0x02, 0x03, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0xff, 0x0d, 0x0e, 0x0f, 0x91,
+  0x16, 0x2d, 0x76, 0x1c, 0xff, 0x8f, 0xa0, 0x0f, 0xc8, 0x16, 0x21, 0x04,
+  0x2d, 0xff, 0x00, 0x17, 0x12, 0x5e, 0x05, 0x33, 0x30, 0x75, 0xff, 0x31,
+  0x1e, 0x20, 0xa6, 0x1c, 0x2e, 0x20, 0x17, 0xef, 0x17, 0xe0, 0x02, 0xff,
+  0x95, 0xe0, 0x43, 0x12, 0x0c, 0xff, 0x11, 0x80, 0x06, 0x3f, 0x0c, 0xc8,
+  0x16, 0xf0, 0xfe, 0x1b, 0x20, 0x1d, 0x10, 0x0a, 0x3c, 0x3c, 0xb3, 0x28,
+  0xff, 0x00, 0x00, 0x0f, 0xe0, 0x0f, 0xe0, 0x00, 0x80, 0xff, 0x0e, 0x13,
+  0x00, 0xb1, 0x0e, 0x3c, 0x01, 0x2d, 0xff, 0xe0, 0x2d, 0x94, 0x1b, 0x1c,
+  0x01, 0x30, 0x00, 0xff, 0xb1, 0xed, 0x1a, 0x30, 0x01, 0x31, 0xe0, 0x31,
+  0xff, 0x0e, 0x43, 0x23, 0x00, 0x84, 0x1e, 0x23, 0x56, 0xff, 0x17, 0x50,
+  0x0e, 0x03, 0x00, 0xb4, 0x2c, 0x10, 0xff, 0x20, 0x0f, 0xaa, 0x0f, 0xaa,
+  0x00, 0x89, 0xb7, 0xff, 0x2d, 0x00, 0x30, 0x0a, 0x40, 0x01, 0x2e, 0x00,
+  0xff, 0x24, 0x0a, 0xfd, 0x07, 0x50, 0x17, 0x40, 0x03, 0xfe, 0x2a, 0xb0,
+  0x50, 0x40, 0x04, 0x21, 0x0c, 0x12, 0x58, 0xef, 0x08, 0x70, 0x02, 0x58,
+  0x7a, 0x20, 0x18, 0xb2, 0x80, 0xff, 0x18, 0x92, 0x08, 0x0c, 0xf1, 0x46,
+  0x01, 0xf2, 0xff, 0x02, 0x80, 0x5a, 0xf1, 0x36, 0x14, 0x54, 0x06, 0xbf,
+  0x01, 0x02, 0x07, 0x08, 0x05, 0x06, 0x07, 0x10, 0x62, 0xff, 0x10, 0x1a,
+  0x6d, 0x5c, 0x1e, 0x2c, 0x02, 0x19, 0xff, 0x76, 0x01, 0x01, 0x5c, 0x1e,
+  0xf1, 0x13, 0xdc, 0xff, 0x12, 0x04, 0x25, 0x10, 0x03, 0x50, 0x6d, 0x01,
+  0xff, 0x01, 0x31, 0x34, 0x17, 0x68, 0x36, 0xe4, 0x42, 0xff, 0x02, 0x14,
+  0x2d, 0xf0, 0x18, 0x56, 0x01, 0xce, 0xff, 0x21, 0x58, 0x25, 0xa0, 0xf3,
+  0x19, 0x65, 0x70, 0xff, 0x58, 0x12, 0x12, 0x25, 0x12, 0x60, 0x58, 0x12,
+  0xef, 0x69, 0x34, 0x40, 0x04, 0x20, 0x41, 0x80, 0x01, 0x58, 0xff, 0x21,
+  0x52, 0x22, 0x02, 0x65, 0x11, 0x01, 0xf1, 0xff, 0x0b, 0x58, 0xf2, 0x06,
+  0x01, 0x65, 0x12, 0x13, 0xff, 0x18, 0x62, 0x6c, 0x58, 0xc2, 0x60, 0x58,
+  0x56, 0xff, 0x03, 0x02, 0x21, 0x06, 0x21, 0x14, 0xf3, 0x19, 0xff, 0x25,
+  0x73, 0xb0, 0x12, 0x0e, 0x25, 0x12, 0x78, 0xf7, 0x58, 0x12, 0x33, 0x53,
+  0x00, 0x66, 0x08, 0x86, 0x01, 0xff, 0x08, 0x32, 0x04, 0x0a, 0xf1, 0x0d,
+  0x58, 0xf1, 0xff, 0x07, 0xb0, 0x2d, 0x70, 0x03, 0x62, 0x84, 0x58, 0xff,
+  0xc2, 0x6e, 0x58, 0x32, 0x03, 0xfe, 0x41, 0x58, 0xff, 0x21, 0x40, 0xf3,
+  0x19, 0xcd, 0x74, 0xb0, 0x2d, 0xff, 0x30, 0x1e, 0x12, 0x90, 0x58, 0x12,
+  0xd1, 0x34, 0xff, 0x83, 0x68, 0x6a, 0x58, 0x32, 0x90, 0x08, 0xf2, 0xfb,
+  0x10, 0x06, 0x2b, 0x01, 0x12, 0x07, 0x18, 0x62, 0xa0, 0xff, 0x58, 0xc2,
+  0x72, 0x58, 0x32, 0x05, 0x1e, 0x85, 0xff, 0xb8, 0xf3, 0x19, 0x69, 0x6f,
+  0xb0, 0x29, 0xa5, 0xff, 0x12, 0xb0, 0x58, 0x12, 0x6d, 0x34, 0xc7, 0x68,
+  0xff, 0x4e, 0xb8, 0xf0, 0x01, 0x10, 0x06, 0x00, 0x08, 0xfe, 0x28, 0x02,
+  0x11, 0x18, 0x62, 0xc0, 0x58, 0xea, 0x54, 0xff, 0x10, 0x72, 0x09, 0x58,
+  0x29, 0x72, 0xf3, 0x19, 0xff, 0x5d, 0x71, 0xb0, 0x21, 0x92, 0x12, 0xd0,
+  0x58, 0xff, 0x12, 0x61, 0x34, 0x8f, 0x68, 0x3e, 0x18, 0x03, 0x77, 0x2d,
+  0xf8, 0x1b, 0x2c, 0x00, 0x04, 0x00, 0x0a, 0x2c, 0x01, 0xff, 0x21, 0x92,
+  0x62, 0xe0, 0x58, 0xc2, 0x46, 0x58, 0xfd, 0xb0, 0x25, 0x30, 0x0b, 0x58,
+  0xfa, 0x1a, 0xfd, 0xc0, 0xfe, 0x2b, 0x00, 0xf0, 0x58, 0x16, 0x01, 0xb8,
+  0x17, 0xc4, 0xff, 0xe2, 0x08, 0xa2, 0x00, 0xb0, 0xf2, 0x10, 0x0c, 0xfe,
+  0x27, 0x03, 0x53, 0x04, 0x6e, 0x58, 0xc2, 0xe4, 0x58, 0xfd, 0x70, 0x28,
+  0x00, 0x0d, 0x58, 0x21, 0x04, 0xf3, 0x19, 0xfb, 0x45, 0x72, 0x57, 0x01,
+  0x18, 0x58, 0x12, 0x49, 0x34, 0x7b, 0x50, 0x03, 0xed, 0x41, 0x7c, 0x58,
+  0x32, 0xc8, 0xad, 0x00, 0xfd, 0x0e, 0x2f, 0x03, 0x52, 0x2c, 0x58, 0xc3,
+  0x58, 0x7e, 0xfe, 0x2f, 0x02, 0x0f, 0x58, 0x25, 0x08, 0xf3, 0x19, 0x71,
+  0xff, 0x77, 0x58, 0x12, 0x14, 0x18, 0x12, 0x40, 0x58, 0xf3, 0x12, 0x75,
+  0x30, 0x00, 0x0e, 0x51, 0x1c, 0x58, 0x2d, 0x2c, 0xff, 0x07, 0x3a, 0x04,
+  0xde, 0xf1, 0x25, 0x58, 0x12, 0xff, 0x15, 0x18, 0x52, 0x54, 0x58, 0xc3,
+  0x48, 0x82, 0xff, 0x58, 0x81, 0x01, 0x23, 0x80, 0xbf, 0x04, 0x22, 0xff,
+  0x29, 0x84, 0x26, 0x7f, 0x1c, 0x1e, 0xff, 0x89, 0xff, 0x07, 0x1d, 0x54,
+  0x03, 0x42, 0x01, 0x04, 0x60, 0xff, 0x02, 0x30, 0xf8, 0x30, 0xf8, 0x2e,
+  0x12, 0x4b, 0xff, 0x02, 0x12, 0x64, 0x02, 0x3d, 0xbc, 0x05, 0x1d, 0xff,
+  0x69, 0x05, 0x12, 0xde, 0x02, 0x6d, 0xc8, 0x05, 0xff, 0x50, 0x05, 0x58,
+  0x02, 0x58, 0x02, 0x01, 0x01, 0xff, 0xa4, 0x02, 0xf1, 0x01, 0x91, 0xa1,
+  0x13, 0x1c, 0xff, 0x03, 0x15, 0x07, 0x00, 0x02, 0x64, 0x75, 0x06, 0xff,
+  0x70, 0x05, 0x10, 0x27, 0x00, 0x10, 0x0a, 0x00, 0xff, 0x40, 0x1a, 0x28,
+  0x02, 0x05, 0x00, 0x5a, 0x0f, 0xff, 0x04, 0xbc, 0x05, 0x3f, 0x3e, 0x3f,
+  0x1e, 0x04, 0xff, 0x00, 0xfa, 0xab, 0x06, 0x1a, 0x01, 0x16, 0x11, 0xff,
+  0x44, 0x23, 0x01, 0x2c, 0x49, 0xf0, 0x01, 0xff, 0xfb, 0x02, 0x64, 0x05,
+  0x30, 0x07, 0x01, 0xf5, 0x07, 0xd8, 0xff, 0x1e, 0x09, 0xd6, 0x03, 0x1e,
+  0x0b, 0x2a, 0x03, 0xff, 0xf2, 0x04, 0x13, 0x02, 0x2d, 0xfc, 0x04, 0x1f,
+  0xfe, 0x25, 0x21, 0xf4, 0x09, 0x11, 0x05, 0x0b, 0x0e, 0x0c, 0xff, 0x07,
+  0x08, 0x0a, 0x11, 0x09, 0x0f, 0x10, 0x73, 0xff, 0x4c, 0x02, 0x0a, 0x20,
+  0x0a, 0x20, 0x86, 0x04, 0xff, 0x55, 0xf0, 0x29, 0xb1, 0x4a, 0x02, 0xbc,
+  0x20, 0xff, 0x01, 0x20, 0x7f, 0x0b, 0x13, 0x80, 0x01, 0x10, 0xff, 0x00,
+  0xf0, 0x84, 0x11, 0x14, 0xd3, 0x00, 0x00, 0xff, 0x14, 0x40, 0x04, 0x2e,
+  0x33, 0x33, 0x2b, 0x28, 0xff, 0x1c, 0x06, 0xa0, 0x04, 0x2c, 0x2c, 0x37,
+  0x20, 0xff, 0x20, 0x11, 0x12, 0x51, 0x84, 0xf8, 0x06, 0x5a, 0xff, 0xe1,
+  0xf5, 0x05, 0x43, 0x44, 0x02, 0x00, 0x01, 0xff, 0x06, 0x1e, 0xfc, 0x73,
+  0x03, 0x21, 0x04, 0x21, 0xff, 0xe4, 0x2d, 0xfc, 0x05, 0x11, 0xb3, 0xf0,
+  0x04, 0xff, 0x26, 0x07, 0x01, 0xf6, 0x01, 0x00, 0xff, 0x84, 0xff, 0xa1,
+  0x50, 0x5e, 0x0e, 0xf4, 0x05, 0xf0, 0x01, 0xff, 0x1d, 0x01, 0x00, 0x01,
+  0xd4, 0x4d, 0xe3, 0x07, 0xff, 0x5e, 0x47, 0x93, 0x07, 0x5e, 0x48, 0x43,
+  0x07, 0xff, 0x5e, 0x53, 0xf3, 0x06, 0x30, 0x01, 0x54, 0x00, 0xff, 0x2f,
+  0x08, 0x1e, 0x59, 0x13, 0x0b, 0x11, 0x01, 0xff, 0x63, 0x10, 0x59, 0x5b,
+  0x21, 0x64, 0x10, 0x01, 0xff, 0x01, 0x1e, 0xff, 0x37, 0x11, 0x82, 0x10,
+  0x16, 0xff, 0xff, 0xf7, 0xff, 0x13, 0x00, 0xdc, 0xff, 0x58, 0xff, 0x00,
+  0x9d, 0xfe, 0x45, 0x42, 0x9c, 0xfe, 0x5a, 0xff, 0x00, 0xd9, 0xff, 0x17,
+  0x00, 0xf3, 0xff, 0x05, 0xff, 0x1c, 0x21, 0x96, 0x20, 0x02, 0xc8, 0x00,
+  0xb8, 0xff, 0x0b, 0x50, 0x32, 0x80, 0x99, 0x30, 0x03, 0x10, 0xff, 0x00,
+  0x30, 0x1b, 0x0f, 0x04, 0x1c, 0x04, 0x58, 0xff, 0x3e, 0x0f, 0x00, 0xa0,
+  0xbb, 0x12, 0x05, 0x3c, 0xf7, 0x04, 0x09, 0x11, 0x51, 0x60, 0x02, 0x16,
+  0x04, 0x3e, 0xff, 0x80, 0xcc, 0x03, 0x37, 0x01, 0x00, 0x9a, 0x34, 0xff,
+  0x02, 0x01, 0x00, 0x2f, 0x02, 0xfa, 0x42, 0x01, 0xef, 0xde, 0x1c, 0x0c,
+  0xff, 0x14, 0x10, 0x03, 0xff, 0x04, 0xff, 0xff, 0x05, 0x06, 0xff, 0x07,
+  0x08, 0xff, 0x5f, 0xff, 0x0a, 0x2e, 0xff, 0x60, 0x0a, 0x40, 0x28, 0xff,
+  0xff, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0xff, 0x18, 0x19,
+  0x1a, 0xff, 0x1b, 0x1c, 0x1d, 0xff, 0xff, 0x1e, 0xff, 0x1f, 0x20, 0xff,
+  0x21, 0x22, 0x23, 0xff, 0x24, 0xff, 0x25, 0x26, 0x27, 0x28, 0xff, 0x29,
+  0xff, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0xff, 0x9d, 0xbd,
+  0x11, 0xe2, 0x5c, 0x09, 0x0d, 0x1b, 0xff, 0x2b, 0x34, 0x37, 0x39, 0x00,
+  0x00, 0x28, 0x00, 0xff, 0x3c, 0x1c, 0x05, 0x20, 0x05, 0xa0, 0x0f, 0x11,
+  0xff, 0x3c, 0x3c, 0x14, 0x02, 0x01, 0x55, 0x03, 0x3d, 0xff, 0x26, 0x04,
+  0x13, 0x00, 0xf4, 0x06, 0xf8, 0x03, 0xff, 0x46, 0xff, 0xe6, 0xdb, 0x2e,
+  0x12, 0x2a, 0x96, 0xff, 0x01, 0xb2, 0x12, 0x32, 0x02, 0x2e, 0x20, 0xc7,
+  0xff, 0x0c, 0xff, 0x0c, 0x02, 0x00, 0x98, 0x23, 0xfd, 0xff, 0x07, 0x90,
+  0x03, 0xf1, 0x03, 0x14, 0xa1, 0x01, 0xc7, 0x03, 0x01, 0x01, 0xb1, 0x70,
+  0x00, 0x0f, 0xff, 0x00, 0x0f, 0x77, 0x42, 0x5d, 0x03, 0xc0, 0x96, 0xdb,
+  0x71, 0x0f, 0x05, 0xeb, 0x75, 0x0f, 0x05
+};
+const unsigned int firmware_Mykonos_M3_lz_len = 87823;
+const unsigned int firmware_Mykonos_M3_bin_len = 98304;
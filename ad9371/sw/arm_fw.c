@@ -0,0 +1,171 @@
+/***************************************************************************//**
+ *   @file   arm_fw.c
+ *   @brief  Implementation of the compressed ARM firmware loader.
+********************************************************************************
+ * Copyright 2017(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include "arm_fw.h"
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+static arm_fw_stream	arm_fw_st;
+static uint8_t			arm_fw_head[ARM_FW_CHUNK_SIZE];
+static uint8_t			arm_fw_chunk[ARM_FW_CHUNK_SIZE];
+
+/***************************************************************************//**
+ * @brief arm_fw_stream_init
+*******************************************************************************/
+void arm_fw_stream_init(arm_fw_stream *st,
+						const uint8_t *src,
+						uint32_t src_len,
+						uint32_t out_len)
+{
+	st->src = src;
+	st->src_len = src_len;
+	st->src_pos = 0;
+	st->out_len = out_len;
+	st->out_pos = 0;
+	st->flags = 0;
+	st->flag_bits = 0;
+	st->match_off = 0;
+	st->match_len = 0;
+}
+
+/***************************************************************************//**
+ * @brief arm_fw_stream_read - decompress up to max bytes into buf
+ *
+ * @return Number of bytes written to buf, 0 at the end of the image or -1 if
+ *         the compressed data is corrupt.
+*******************************************************************************/
+int32_t arm_fw_stream_read(arm_fw_stream *st,
+						   uint8_t *buf,
+						   uint32_t max)
+{
+	uint32_t n = 0;
+	uint8_t b0, b1;
+	uint8_t data;
+
+	while (n < max) {
+		if (st->match_len) {
+			if (st->out_pos == st->out_len)
+				return -1;
+			data = st->window[(st->out_pos - st->match_off) &
+							  (ARM_FW_WINDOW_SIZE - 1)];
+			st->match_len--;
+		} else {
+			if (st->out_pos == st->out_len)
+				break;
+			if (st->flag_bits == 0) {
+				if (st->src_pos >= st->src_len)
+					return -1;
+				st->flags = st->src[st->src_pos++];
+				st->flag_bits = 8;
+			}
+			if (st->flags & 1) {
+				if (st->src_pos >= st->src_len)
+					return -1;
+				data = st->src[st->src_pos++];
+			} else {
+				if (st->src_pos + 2 > st->src_len)
+					return -1;
+				b0 = st->src[st->src_pos++];
+				b1 = st->src[st->src_pos++];
+				st->match_off = (((b1 & 0xF0) << 4) | b0) + 1;
+				st->match_len = (b1 & 0x0F) + ARM_FW_MIN_MATCH;
+				if (st->match_len == ARM_FW_EXT_MATCH) {
+					if (st->src_pos >= st->src_len)
+						return -1;
+					st->match_len += st->src[st->src_pos++];
+				}
+				if (st->match_off > st->out_pos)
+					return -1;
+				st->flags >>= 1;
+				st->flag_bits--;
+				continue;
+			}
+			st->flags >>= 1;
+			st->flag_bits--;
+		}
+		st->window[st->out_pos & (ARM_FW_WINDOW_SIZE - 1)] = data;
+		st->out_pos++;
+		buf[n++] = data;
+	}
+
+	return n;
+}
+
+/***************************************************************************//**
+ * @brief arm_fw_load - load a compressed ARM image
+ *
+ * The image is decompressed one chunk at a time and each chunk is written to
+ * the ARM program memory as soon as it is available, so neither the image nor
+ * a decompressed copy is ever held in RAM. The first chunk, which holds the
+ * stack pointer and boot vectors, is passed to MYKONOS_loadArmFromBinary()
+ * last; it writes it at the start of program memory and boots the ARM.
+*******************************************************************************/
+mykonosErr_t arm_fw_load(mykonosDevice_t *device,
+						 const uint8_t *src,
+						 uint32_t src_len,
+						 uint32_t bin_len)
+{
+	mykonosErr_t mykError;
+	uint32_t address;
+	int32_t head_len;
+	int32_t n;
+
+	arm_fw_stream_init(&arm_fw_st, src, src_len, bin_len);
+
+	head_len = arm_fw_stream_read(&arm_fw_st, arm_fw_head, ARM_FW_CHUNK_SIZE);
+	if (head_len <= 0)
+		return MYKONOS_ERR_LOADBIN_INVALID_BYTECOUNT;
+
+	address = ARM_FW_PROG_ADDR + head_len;
+	while ((n = arm_fw_stream_read(&arm_fw_st, arm_fw_chunk,
+								   ARM_FW_CHUNK_SIZE)) > 0) {
+		mykError = MYKONOS_writeArmMem(device, address, arm_fw_chunk, n);
+		if (mykError != MYKONOS_ERR_OK)
+			return mykError;
+		address += n;
+	}
+
+	if ((n < 0) || (address - ARM_FW_PROG_ADDR != bin_len))
+		return MYKONOS_ERR_LOADBIN_INVALID_BYTECOUNT;
+
+	return MYKONOS_loadArmFromBinary(device, arm_fw_head, head_len);
+}
@@ -0,0 +1,96 @@
+/***************************************************************************//**
+ *   @file   arm_fw.h
+ *   @brief  Header file of the compressed ARM firmware loader.
+********************************************************************************
+ * Copyright 2017(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef ARM_FW_H_
+#define ARM_FW_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include "mykonos.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/*
+ * Compressed image format (LZSS), as written by scripts/fw_compress.c:
+ * a flag byte precedes each group of up to 8 items, LSB first.
+ *   flag bit 1 - literal, one byte
+ *   flag bit 0 - match, b0 b1 [b2]
+ *                offset = (((b1 & 0xF0) << 4) | b0) + 1	(1..4096)
+ *                length = (b1 & 0x0F) + 3			(3..17)
+ *                length = 18 + b2 if (b1 & 0x0F) == 0x0F	(18..273)
+ */
+#define ARM_FW_WINDOW_SIZE	4096
+#define ARM_FW_MIN_MATCH	3
+#define ARM_FW_EXT_MATCH	18
+#define ARM_FW_CHUNK_SIZE	1024
+#define ARM_FW_PROG_ADDR	0x01000000
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+typedef struct {
+	const uint8_t	*src;
+	uint32_t		src_len;
+	uint32_t		src_pos;
+	uint32_t		out_len;
+	uint32_t		out_pos;
+	uint8_t			flags;
+	uint8_t			flag_bits;
+	uint32_t		match_off;
+	uint32_t		match_len;
+	uint8_t			window[ARM_FW_WINDOW_SIZE];
+} arm_fw_stream;
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+void arm_fw_stream_init(arm_fw_stream *st,
+						const uint8_t *src,
+						uint32_t src_len,
+						uint32_t out_len);
+int32_t arm_fw_stream_read(arm_fw_stream *st,
+						   uint8_t *buf,
+						   uint32_t max);
+mykonosErr_t arm_fw_load(mykonosDevice_t *device,
+						 const uint8_t *src,
+						 uint32_t src_len,
+						 uint32_t bin_len);
+
+#endif
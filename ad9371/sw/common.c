@@ -24,6 +24,50 @@ ADI_LOGLEVEL CMB_LOGLEVEL = ADIHAL_LOG_NONE;
 static uint32_t _desired_time_to_elapse_us = 0;
 extern spi_device spi_dev;
 
+/* Last known register values, used to skip the read in CMB_SPIWriteField().
+ * Entries are only trusted within one generation; the generation advances on
+ * a reset and whenever the API waits, as the device may update registers on
+ * its own (calibrations, self clearing bits) while the host is idle. */
+typedef struct
+{
+	uint32_t gen;
+	uint16_t addr;
+	uint8_t chipSelectIndex;
+	uint8_t data;
+} spiCacheEntry_t;
+
+static spiCacheEntry_t _spi_cache[SPI_FIELD_CACHE_SIZE];
+static uint32_t _spi_cache_gen = 1;
+static uint8_t _spi_buf[2 + SPI_MAX_STREAM_BYTES];
+
+static void CMB_SPICacheStore(uint8_t chipSelectIndex, uint16_t addr, uint8_t data)
+{
+	spiCacheEntry_t *entry = &_spi_cache[addr % SPI_FIELD_CACHE_SIZE];
+
+	entry->gen = _spi_cache_gen;
+	entry->addr = addr;
+	entry->chipSelectIndex = chipSelectIndex;
+	entry->data = data;
+}
+
+static uint8_t CMB_SPICacheLookup(uint8_t chipSelectIndex, uint16_t addr, uint8_t *data)
+{
+	spiCacheEntry_t *entry = &_spi_cache[addr % SPI_FIELD_CACHE_SIZE];
+
+	if ((entry->gen != _spi_cache_gen) || (entry->addr != addr) ||
+		(entry->chipSelectIndex != chipSelectIndex))
+		return(0);
+
+	*data = entry->data;
+
+	return(1);
+}
+
+static void CMB_SPICacheInvalidate(void)
+{
+	_spi_cache_gen++;
+}
+
 commonErr_t CMB_closeHardware(void)
 {
 	return(COMMONERR_OK);
@@ -49,6 +93,8 @@ commonErr_t CMB_hardReset(uint8_t spiChipSelectIndex)
 		return(COMMONERR_FAILED);
 	}
 
+	CMB_SPICacheInvalidate();
+
 	gpio_set_value(resetGPIO, 0x1);
 	CMB_wait_ms(1);
 	gpio_set_value(resetGPIO, 0x0);
@@ -80,17 +126,46 @@ commonErr_t CMB_SPIWriteByte(spiSettings_t *spiSettings, uint16_t addr, uint8_t
 	buf[2] = (uint8_t) data;
 
 	spi_write_and_read(&spi_dev, buf, 3);
+	CMB_SPICacheStore(spiSettings->chipSelectIndex, addr, data);
 
 	return(COMMONERR_OK);
 }
 
+/* With streaming enabled, runs of consecutive addresses (in the configured
+ * increment direction) are sent as one instruction word followed by the data
+ * bytes; any other write gets its own instruction word. */
 commonErr_t CMB_SPIWriteBytes(spiSettings_t *spiSettings, uint16_t *addr, uint8_t *data, uint32_t count)
 {
 	uint32_t index;
+	uint32_t run;
+	uint32_t i;
+	uint16_t next;
 
-	for (index = 0; index < count; index++)
-		if (CMB_SPIWriteByte(spiSettings, *(addr + index), *(data + index)) != COMMONERR_OK)
-			return(COMMONERR_FAILED);
+	spi_dev.chip_select = spiSettings->chipSelectIndex;
+
+	index = 0;
+	while (index < count) {
+		run = 1;
+		if (spiSettings->enSpiStreaming) {
+			while ((index + run < count) && (run < SPI_MAX_STREAM_BYTES)) {
+				next = spiSettings->autoIncAddrUp ?
+					(uint16_t)(addr[index] + run) : (uint16_t)(addr[index] - run);
+				if (addr[index + run] != next)
+					break;
+				run++;
+			}
+		}
+
+		_spi_buf[0] = (uint8_t) ((addr[index] >> 8) & 0x7f);
+		_spi_buf[1] = (uint8_t) (addr[index] & 0xff);
+		for (i = 0; i < run; i++) {
+			_spi_buf[2 + i] = data[index + i];
+			CMB_SPICacheStore(spiSettings->chipSelectIndex, addr[index + i], data[index + i]);
+		}
+
+		spi_write_and_read(&spi_dev, _spi_buf, run + 2);
+		index += run;
+	}
 
 	return(COMMONERR_OK);
 }
@@ -107,6 +182,7 @@ commonErr_t CMB_SPIReadByte(spiSettings_t *spiSettings, uint16_t addr, uint8_t *
 
 	spi_write_and_read(&spi_dev, buf, 3);
 	*readdata = buf[2];
+	CMB_SPICacheStore(spiSettings->chipSelectIndex, addr, buf[2]);
 
 	return(COMMONERR_OK);
 }
@@ -115,8 +191,9 @@ commonErr_t CMB_SPIWriteField(spiSettings_t *spiSettings, uint16_t addr, uint8_t
 {
 	uint8_t data;
 
-	if (CMB_SPIReadByte(spiSettings, addr, &data) != COMMONERR_OK)
-		return(COMMONERR_FAILED);
+	if (!CMB_SPICacheLookup(spiSettings->chipSelectIndex, addr, &data))
+		if (CMB_SPIReadByte(spiSettings, addr, &data) != COMMONERR_OK)
+			return(COMMONERR_FAILED);
 
 	data = (data & ~mask) | ((field_val << start_bit) & mask);
 
@@ -184,6 +261,7 @@ commonErr_t CMB_flushLog(void)
 
 commonErr_t CMB_wait_ms(uint32_t time_ms)
 {
+	CMB_SPICacheInvalidate();
 	mdelay(time_ms);
 
 	return(COMMONERR_OK);
@@ -191,6 +269,7 @@ commonErr_t CMB_wait_ms(uint32_t time_ms)
 
 commonErr_t CMB_wait_us(uint32_t time_us)
 {
+	CMB_SPICacheInvalidate();
 	udelay(time_us);
 
 	return(COMMONERR_OK);
@@ -212,6 +291,7 @@ commonErr_t CMB_setTimeout_us(uint32_t timeOut_us)
 
 commonErr_t CMB_hasTimeoutExpired()
 {
+	CMB_SPICacheInvalidate();
 	udelay(1);
 
 	_desired_time_to_elapse_us--;
@@ -44,7 +44,8 @@
 #include "common.h"
 #include "ad9528.h"
 #include "mykonos.h"
-#include "mykonos_m3.h"
+#include "Mykonos_M3_lz.h"
+#include "arm_fw.h"
 #include "mykonos_gpio.h"
 #include "platform_drivers.h"
 #include "adc_core.h"
@@ -122,6 +123,158 @@ dac_core  ad9371_tx_core_init = {
 		DAC_GPIO_PLDDR_BYPASS, 			// plddr_bypass_gpio
 };
 
+/******************************************************************************/
+/************************** Bring-up Scheduling *******************************/
+/******************************************************************************/
+#define INIT_CALS_TIMEOUT_MS	60000
+#define MAX_BRINGUP_PHASES		24
+
+/* Bring-up step that does not depend on the Mykonos init calibrations and is
+ * run while the ARM is busy calibrating */
+typedef struct {
+	const char	*name;
+	int32_t		(*run)(void);
+} bringup_task;
+
+typedef struct {
+	const char	*name;
+	uint32_t	time_us;
+	uint8_t		overlapped;
+} bringup_phase;
+
+static bringup_phase	bringup_phases[MAX_BRINGUP_PHASES];
+static uint32_t			bringup_num_phases;
+static uint32_t			bringup_mark_us;
+
+/***************************************************************************//**
+ * @brief bringup_record
+*******************************************************************************/
+static void bringup_record(const char *name, uint32_t time_us, uint8_t overlapped)
+{
+	if (bringup_num_phases == MAX_BRINGUP_PHASES)
+		return;
+
+	bringup_phases[bringup_num_phases].name = name;
+	bringup_phases[bringup_num_phases].time_us = time_us;
+	bringup_phases[bringup_num_phases].overlapped = overlapped;
+	bringup_num_phases++;
+}
+
+/***************************************************************************//**
+ * @brief bringup_mark - record the time spent since the previous mark
+*******************************************************************************/
+static void bringup_mark(const char *name)
+{
+	uint32_t now = timer_get_us();
+
+	bringup_record(name, now - bringup_mark_us, 0);
+	bringup_mark_us = now;
+}
+
+/***************************************************************************//**
+ * @brief bringup_report
+*******************************************************************************/
+static void bringup_report(void)
+{
+	uint32_t i;
+
+	printf("Bring-up timing (us):\n");
+	for (i = 0; i < bringup_num_phases; i++)
+		printf("  %s%-24s %10u\n", bringup_phases[i].overlapped ? "  " : "",
+			   bringup_phases[i].name,
+			   (unsigned int)bringup_phases[i].time_us);
+}
+
+/***************************************************************************//**
+ * @brief bringup_clkgen
+*******************************************************************************/
+static int32_t bringup_clkgen(void)
+{
+	return clkgen_setup(&mykDevice);
+}
+
+/***************************************************************************//**
+ * @brief bringup_jesd
+*******************************************************************************/
+static int32_t bringup_jesd(void)
+{
+	return jesd_setup(&mykDevice);
+}
+
+/***************************************************************************//**
+ * @brief bringup_xcvr
+*******************************************************************************/
+static int32_t bringup_xcvr(void)
+{
+	return xcvr_setup(&mykDevice);
+}
+
+static const bringup_task init_cal_tasks[] = {
+	{"clkgen_setup", bringup_clkgen},
+	{"jesd_setup", bringup_jesd},
+	{"xcvr_setup", bringup_xcvr},
+};
+
+/***************************************************************************//**
+ * @brief bringup_init_cals - run the init calibrations and the given tasks
+ *        concurrently. Calibration progress is polled between tasks; once the
+ *        tasks are done the remaining calibration time is waited for.
+ *
+ * @return Mykonos error; *task_status is -1 if any of the tasks failed.
+*******************************************************************************/
+static mykonosErr_t bringup_init_cals(const char *name,
+									  uint32_t calMask,
+									  const bringup_task *tasks,
+									  uint32_t num_tasks,
+									  uint8_t *errorFlag,
+									  uint8_t *errorCode,
+									  int32_t *task_status)
+{
+	mykonosErr_t	mykError;
+	uint32_t		start_us;
+	uint32_t		task_us;
+	uint8_t			running = 1;
+	uint32_t		i;
+
+	*task_status = 0;
+	*errorFlag = 0;
+	*errorCode = 0;
+
+	start_us = timer_get_us();
+	if ((mykError = MYKONOS_runInitCals(&mykDevice, calMask)) != MYKONOS_ERR_OK)
+		return mykError;
+
+	for (i = 0; i < num_tasks; i++) {
+		if (running) {
+			mykError = MYKONOS_checkInitCalComplete(&mykDevice, &running,
+													errorFlag, errorCode);
+			if (mykError != MYKONOS_ERR_OK)
+				return mykError;
+			if (!running)
+				bringup_record(name, timer_get_us() - start_us, 0);
+		}
+
+		task_us = timer_get_us();
+		if (tasks[i].run() != 0) {
+			printf("%s() failed\n", tasks[i].name);
+			*task_status = -1;
+		}
+		bringup_record(tasks[i].name, timer_get_us() - task_us, 1);
+	}
+
+	if (running) {
+		mykError = MYKONOS_waitInitCals(&mykDevice, INIT_CALS_TIMEOUT_MS,
+										errorFlag, errorCode);
+		if (mykError != MYKONOS_ERR_OK)
+			return mykError;
+		bringup_record(name, timer_get_us() - start_us, 0);
+	}
+
+	bringup_mark_us = timer_get_us();
+
+	return MYKONOS_ERR_OK;
+}
+
 /***************************************************************************//**
  * @brief main
 *******************************************************************************/
@@ -130,13 +283,13 @@ int main(void)
 	ADI_ERR				ad9528Error;
 	ad9528Device_t 		*clockAD9528_device = &clockAD9528_;
 	mykonosErr_t		mykError;
+	mykonosGpioErr_t	mykGpioErr;
 	const char			*errorString;
 	uint8_t				pllLockStatus;
 	uint8_t				mcsStatus;
 	uint8_t				arm_major;
 	uint8_t				arm_minor;
 	uint8_t				arm_release;
-	mykonosGpioErr_t	mykGpioErr;
 	uint32_t			initCalMask = TX_BB_FILTER | ADC_TUNER | TIA_3DB_CORNER | DC_OFFSET |
 									  TX_ATTENUATION_DELAY | RX_GAIN_DELAY | FLASH_CAL |
 									  PATH_DELAY | TX_LO_LEAKAGE_INTERNAL | TX_QEC_INIT |
@@ -151,6 +304,7 @@ int main(void)
 	uint32_t			trackingCalMask = TRACK_ORX1_QEC | TRACK_ORX2_QEC | TRACK_RX1_QEC |
 										  TRACK_RX2_QEC | TRACK_TX1_QEC | TRACK_TX2_QEC;
 	uint32_t			status;
+	int32_t				task_status;
 
 	/* Allocating memory for the errorString */
 	errorString = (const char*) malloc(sizeof(char) * 200);
@@ -159,6 +313,8 @@ int main(void)
 
 	platform_init();
 
+	bringup_mark_us = timer_get_us();
+
 	/**************************************************************************/
 	/*****      System Clocks Initialization Initialization Sequence      *****/
 	/**************************************************************************/
@@ -183,31 +339,16 @@ int main(void)
 	if (ad9528Error != ADIERR_OK)
 		printf("WARNING: AD9528_initialize() issues. Possible cause: REF_CLK not connected.\n");
 
-	/* Initialize CLKGENs */
-	status = clkgen_setup(&mykDevice);
-	if (status != 0) {
-		printf("clkgen_setup() failed\n");
-		return -1;
-	}
-
-	/* Initialize JESDs */
-	status = jesd_setup(&mykDevice);
-	if (status != 0) {
-		printf("jesd_setup() failed\n");
-		return -1;
-	}
-
-	/* Initialize ADXCVRs */
-	status = xcvr_setup(&mykDevice);
-	if (status != 0) {
-		printf("xcvr_setup() failed\n");
-		return -1;
-	}
+	bringup_mark("AD9528 init");
 
 	/*************************************************************************/
 	/*****                Mykonos Initialization Sequence                *****/
 	/*************************************************************************/
 
+	/* Stream consecutive register writes (SPI config is set by the reset) */
+	mykDevice.spiSettings->enSpiStreaming = 1;
+	mykDevice.spiSettings->autoIncAddrUp = 1;
+
 	/* Perform a hard reset on the MYKONOS DUT (Toggle RESETB pin on device) */
 	if ((mykError = MYKONOS_resetDevice(&mykDevice)) != MYKONOS_ERR_OK) {
 		errorString = getMykonosErrorMessage(mykError);
@@ -219,6 +360,8 @@ int main(void)
 		goto error;
 	}
 
+	bringup_mark("Mykonos init");
+
 	/*************************************************************************/
 	/*****                Mykonos CLKPLL Status Check                    *****/
 	/*************************************************************************/
@@ -261,6 +404,8 @@ int main(void)
 	else
 		printf("MCS failed\n");
 
+	bringup_mark("MCS");
+
 	/*************************************************************************/
 	/*****                Mykonos Load ARM file                          *****/
 	/*************************************************************************/
@@ -272,7 +417,7 @@ int main(void)
 			goto error;
 		}
 
-		if ((mykError = MYKONOS_loadArmFromBinary(&mykDevice, &firmware_Mykonos_M3_bin[0], firmware_Mykonos_M3_bin_len)) != MYKONOS_ERR_OK) {
+		if ((mykError = arm_fw_load(&mykDevice, &firmware_Mykonos_M3_lz[0], firmware_Mykonos_M3_lz_len, firmware_Mykonos_M3_bin_len)) != MYKONOS_ERR_OK) {
 			errorString = getMykonosErrorMessage(mykError);
 			goto error;
 		}
@@ -285,6 +430,8 @@ int main(void)
 	if ((mykError = MYKONOS_getArmVersion(&mykDevice, &arm_major, &arm_minor, &arm_release, NULL)) == MYKONOS_ERR_OK)
 		printf("AD9371 ARM version %d.%d.%d\n", arm_major, arm_minor, arm_release);
 
+	bringup_mark("ARM load");
+
 	/*************************************************************************/
 	/*****                Mykonos Set RF PLL Frequencies                 *****/
 	/*************************************************************************/
@@ -319,6 +466,8 @@ int main(void)
 		return -1;
 	}
 
+	bringup_mark("RF PLLs");
+
 	/*************************************************************************/
 	/*****                Mykonos Set GPIOs                              *****/
 	/*************************************************************************/
@@ -405,16 +554,21 @@ int main(void)
 	/*****           Mykonos ARM Initialization Calibrations             *****/
 	/*************************************************************************/
 
-    if ((mykError = MYKONOS_runInitCals(&mykDevice, (initCalMask & ~TX_LO_LEAKAGE_EXTERNAL))) != MYKONOS_ERR_OK) {
-		errorString = getMykonosErrorMessage(mykError);
-		goto error;
-	}
+	bringup_mark("gains/attenuations");
 
-	if ((mykError = MYKONOS_waitInitCals(&mykDevice, 60000, &errorFlag, &errorCode)) != MYKONOS_ERR_OK) {
+	/* FPGA clocks and links are set up while the ARM calibrates */
+	if ((mykError = bringup_init_cals("init cals",
+									  (initCalMask & ~TX_LO_LEAKAGE_EXTERNAL),
+									  init_cal_tasks,
+									  sizeof(init_cal_tasks) / sizeof(bringup_task),
+									  &errorFlag, &errorCode, &task_status)) != MYKONOS_ERR_OK) {
 		errorString = getMykonosErrorMessage(mykError);
 		goto error;
 	}
 
+	if (task_status != 0)
+		return -1;
+
 	if ((errorFlag != 0) || (errorCode != 0)) {
 		/*** < Info: abort init cals > ***/
 		if ((mykError = MYKONOS_abortInitCals(&mykDevice, &initCalsCompleted)) != MYKONOS_ERR_OK) {
@@ -433,12 +587,9 @@ int main(void)
 
 	/* Please ensure PA is enabled operational at this time */
 	if (initCalMask & TX_LO_LEAKAGE_EXTERNAL) {
-		if ((mykError = MYKONOS_runInitCals(&mykDevice, TX_LO_LEAKAGE_EXTERNAL)) != MYKONOS_ERR_OK) {
-			errorString = getMykonosErrorMessage(mykError);
-			goto error;
-		}
-
-		if ((mykError = MYKONOS_waitInitCals(&mykDevice, 60000, &errorFlag, &errorCode)) != MYKONOS_ERR_OK) {
+		if ((mykError = bringup_init_cals("external LOL cal",
+										  TX_LO_LEAKAGE_EXTERNAL, NULL, 0,
+										  &errorFlag, &errorCode, &task_status)) != MYKONOS_ERR_OK) {
 			errorString = getMykonosErrorMessage(mykError);
 			goto error;
 		}
@@ -537,6 +688,8 @@ int main(void)
 		if (deframerStatus != 0x68)
 			printf("DeframerStatus = 0x%x\n", deframerStatus);
 
+	bringup_mark("JESD links");
+
 	/*************************************************************************/
 	/*****           Mykonos enable tracking calibrations                *****/
 	/*************************************************************************/
@@ -582,6 +735,9 @@ int main(void)
 						  sine_lut_iq,
 						  sizeof(sine_lut_iq) / sizeof(uint32_t));
 
+	bringup_mark("radio on, DAC/ADC setup");
+	bringup_report();
+
 	mdelay(1000);
 
 	adc_capture(&ad9371_rx_core_init, 16384);
@@ -191,3 +191,12 @@ uint32_t ad_pow2(uint32_t number) {
 
 	return mask;
 }
+
+/***************************************************************************//**
+ * @brief timer_get_us - free running microsecond time stamp, system clock
+ *                       tick resolution
+*******************************************************************************/
+uint32_t timer_get_us(void)
+{
+	return alt_nticks() * (1000000 / alt_ticks_per_second());
+}
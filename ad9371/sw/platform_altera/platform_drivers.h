@@ -47,6 +47,7 @@
 #include <stdio.h>
 #include <system.h>
 #include <alt_types.h>
+#include <sys/alt_alarm.h>
 #include "altera_avalon_spi.h"
 #include "altera_avalon_spi_regs.h"
 #include "../mykonos/mykonos.h"
@@ -166,4 +167,5 @@ int32_t altera_bridge_init(void);
 int32_t altera_bridge_uninit(void);
 uint32_t alt_avl_spi_read(uint32_t reg_addr);
 uint32_t ad_pow2(uint32_t number);
+uint32_t timer_get_us(void);
 #endif // PLATFORM_DRIVERS_H_
@@ -250,3 +250,20 @@ uint32_t find_first_bit(uint32_t word)
 			num += 1;
 	return num;
 }
+
+/***************************************************************************//**
+ * @brief timer_get_us - free running microsecond time stamp (0 if there is no
+ *                       timer in the design)
+*******************************************************************************/
+uint32_t timer_get_us(void)
+{
+#ifdef _XPARAMETERS_PS_H_
+	XTime time;
+
+	XTime_GetTime(&time);
+
+	return (uint32_t)(time / (COUNTS_PER_SECOND / 1000000));
+#else
+	return 0;
+#endif
+}
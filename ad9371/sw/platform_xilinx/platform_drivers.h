@@ -45,6 +45,7 @@
 #ifdef _XPARAMETERS_PS_H_
 #include <xspips.h>
 #include <xgpiops.h>
+#include <xtime_l.h>
 #else
 #include <xspi.h>
 #include <xgpio.h>
@@ -127,4 +128,5 @@ int32_t gpio_set_value(uint8_t gpio,
 					   uint8_t value);
 uint32_t ad_pow2(uint32_t number);
 uint32_t find_first_bit(uint32_t word);
+uint32_t timer_get_us(void);
 #endif
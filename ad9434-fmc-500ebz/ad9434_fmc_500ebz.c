@@ -45,6 +45,12 @@
 #include "platform_drivers.h"
 #include "ad9434.h"
 
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+/* Not cleared at startup, the lane delays are reapplied after a warm boot */
+adc_delay_map ad9434_delay_map __attribute__((section(".noinit")));
+
 /***************************************************************************//**
 * @brief main
 *******************************************************************************/
@@ -79,7 +85,8 @@ int main(void)
 	adc_setup(ad9434_core);
 
 	ad9434_testmode_set(&ad9434_device, TESTMODE_PN9_SEQ);
-	adc_delay_calibrate(ad9434_core, nr_of_lanes + over_range_signal, ADC_PN9);
+	adc_delay_calibrate(ad9434_core, nr_of_lanes + over_range_signal, ADC_PN9,
+			    &ad9434_delay_map);
 
 	ad9434_testmode_set(&ad9434_device, TESTMODE_OFF);
 	ad9434_outputmode_set(&ad9434_device, OUTPUT_MODE_TWOS_COMPLEMENT);
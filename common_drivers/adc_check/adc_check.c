@@ -0,0 +1,351 @@
+/***************************************************************************//**
+ * @file adc_check.c
+ * @brief Implementation of the capture data integrity checker.
+ ********************************************************************************
+ * Copyright 2016(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in
+ * the documentation and/or other materials provided with the
+ * distribution.
+ * - Neither the name of Analog Devices, Inc. nor the names of its
+ * contributors may be used to endorse or promote products derived
+ * from this software without specific prior written permission.
+ * - The use of this software may or may not infringe the patent rights
+ * of one or more patent holders. This license does not release you
+ * from the requirement that you obtain separate licenses from these
+ * patent holders to use this software.
+ * - Use of the software either in source or binary form, must be run
+ * on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *******************************************************************************/
+#include "adc_check.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ADC_CHECK_NEON
+#endif
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define ADC_CHECK_MATCH		0
+#define ADC_CHECK_MISMATCH	1
+#define ADC_CHECK_SEED		2
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+typedef struct {
+	uint32_t	expected;	// next ramp value
+	uint64_t	pn_state;	// last received PN bits, newest in bit 0
+	uint32_t	phase;		// PN seed samples or user pattern index
+	uint8_t		locked;
+} adc_check_state;
+
+/***************************************************************************//**
+ * @brief adc_check_read
+ *******************************************************************************/
+static inline uint32_t adc_check_read(const uint8_t *data,
+		uint8_t sample_bytes)
+{
+	if (sample_bytes == 4)
+		return *(const uint32_t *)data;
+	if (sample_bytes == 2)
+		return *(const uint16_t *)data;
+
+	return *data;
+}
+
+/***************************************************************************//**
+ * @brief adc_check_pn_next - generate the next width bits of the sequence
+ *        b[n] = b[n - lag_a] ^ b[n - lag_b], MSB first. Up to lag_b bits only
+ *        depend on the state and are generated in one step.
+ *******************************************************************************/
+static uint32_t adc_check_pn_next(uint64_t state,
+		uint8_t width,
+		uint8_t lag_a,
+		uint8_t lag_b)
+{
+	uint32_t data = 0;
+	uint32_t bits;
+	uint8_t n;
+
+	while (width) {
+		n = (width < lag_b) ? width : lag_b;
+		bits = ((state >> (lag_a - n)) ^ (state >> (lag_b - n))) &
+				((1 << n) - 1);
+		state = (state << n) | bits;
+		data = (data << n) | bits;
+		width -= n;
+	}
+
+	return data;
+}
+
+/***************************************************************************//**
+ * @brief adc_check_sample - compare one sample of a channel against its
+ *        pattern and advance the channel state.
+ *
+ * A ramp is seeded by the first sample and then runs free. A PN monitor is
+ * seeded by enough samples to fill its register and resyncs on the received
+ * data, so a corrupted sample only fails the samples that depend on it. A
+ * user pattern locks on the first sample that is found in it.
+ *******************************************************************************/
+static uint8_t adc_check_sample(const adc_check_config *config,
+		adc_check_state *state,
+		uint32_t data,
+		uint32_t mask,
+		uint32_t *expected)
+{
+	uint8_t lag_a;
+	uint8_t lag_b;
+	uint32_t index;
+
+	switch (config->pattern) {
+	case ADC_CHECK_RAMP:
+		if (!state->locked) {
+			state->locked = 1;
+			state->expected = (data + config->ramp_step) & mask;
+			return ADC_CHECK_SEED;
+		}
+		*expected = state->expected;
+		state->expected = (state->expected + config->ramp_step) & mask;
+		break;
+	case ADC_CHECK_PN9:
+	case ADC_CHECK_PN23:
+		lag_a = (config->pattern == ADC_CHECK_PN9) ? 9 : 23;
+		lag_b = (config->pattern == ADC_CHECK_PN9) ? 5 : 18;
+		if (config->pn_invert)
+			data = ~data & mask;
+		if (state->phase * config->resolution < lag_a) {
+			state->pn_state = (state->pn_state << config->resolution) | data;
+			state->phase++;
+			return ADC_CHECK_SEED;
+		}
+		*expected = adc_check_pn_next(state->pn_state, config->resolution,
+				lag_a, lag_b);
+		state->pn_state = (state->pn_state << config->resolution) | data;
+		if (config->pn_invert) {
+			data = ~data & mask;
+			*expected = ~*expected & mask;
+		}
+		break;
+	case ADC_CHECK_USER:
+		if (!state->locked) {
+			for (index = 0; index < config->user_length; index++)
+				if ((config->user_data[index] & mask) == data)
+					break;
+			if (index < config->user_length) {
+				state->locked = 1;
+				state->phase = (index + 1) % config->user_length;
+				return ADC_CHECK_SEED;
+			}
+			*expected = config->user_data[0] & mask;
+			break;
+		}
+		*expected = config->user_data[state->phase] & mask;
+		if (++state->phase == config->user_length)
+			state->phase = 0;
+		break;
+	default:
+		return ADC_CHECK_SEED;
+	}
+
+	return (data == *expected) ? ADC_CHECK_MATCH : ADC_CHECK_MISMATCH;
+}
+
+#ifdef ADC_CHECK_NEON
+/***************************************************************************//**
+ * @brief adc_check_ramp_neon - compare 16-bit ramps eight samples at a time.
+ *        The number of channels must divide eight.
+ *
+ * @return the number of rows that match, the channel states are advanced
+ *         past them. The caller checks the row that failed.
+ *******************************************************************************/
+static uint32_t adc_check_ramp_neon(const uint16_t *data,
+		uint32_t no_of_rows,
+		uint32_t no_of_channels,
+		adc_check_state *state,
+		uint32_t step,
+		uint32_t mask)
+{
+	uint16_t lane[8];
+	uint16x8_t expected;
+	uint16x8_t increment;
+	uint16x8_t mask_vec;
+	uint16x8_t equal;
+	uint16x4_t all;
+	uint32_t rows = 8 / no_of_channels;
+	uint32_t row;
+	uint8_t index;
+
+	for (index = 0; index < 8; index++)
+		lane[index] = (state[index % no_of_channels].expected +
+				step * (index / no_of_channels)) & mask;
+	expected = vld1q_u16(lane);
+	increment = vdupq_n_u16(step * rows);
+	mask_vec = vdupq_n_u16(mask);
+
+	for (row = 0; (row + rows) <= no_of_rows; row += rows) {
+		equal = vceqq_u16(vandq_u16(vld1q_u16(data), mask_vec), expected);
+		all = vand_u16(vget_low_u16(equal), vget_high_u16(equal));
+		all = vpmin_u16(all, all);
+		all = vpmin_u16(all, all);
+		if (vget_lane_u16(all, 0) != 0xffff)
+			break;
+		expected = vandq_u16(vaddq_u16(expected, increment), mask_vec);
+		data += 8;
+	}
+
+	for (index = 0; index < no_of_channels; index++)
+		state[index].expected = (state[index].expected + step * row) & mask;
+
+	return row;
+}
+#endif
+
+/***************************************************************************//**
+ * @brief adc_check_record
+ *******************************************************************************/
+static void adc_check_record(adc_check_result *result,
+		uint32_t channel,
+		uint32_t sample,
+		uint32_t received,
+		uint32_t expected)
+{
+	adc_check_error *error;
+
+	if (result->errors && (result->no_of_errors < result->max_errors)) {
+		error = &result->errors[result->no_of_errors];
+		error->channel = channel;
+		error->sample = sample;
+		error->received = received;
+		error->expected = expected;
+	}
+	result->no_of_errors++;
+}
+
+/***************************************************************************//**
+ * @brief adc_check_buffer - check a capture against a ramp, PN or user
+ *        pattern.
+ *
+ * The buffer is read directly as cached memory, a row of ADC_CHECK_CHAN_GROUP
+ * channels at a time, after its cache lines are invalidated. On NEON targets
+ * 16-bit ramps are compared eight samples at a time and only the rows that
+ * fail are checked sample by sample.
+ *
+ * @return 0 if every sample matches, -1 on errors or a bad configuration.
+ *******************************************************************************/
+int32_t adc_check_buffer(const adc_check_config *config,
+		uint32_t start_address,
+		uint32_t no_of_samples,
+		adc_check_result *result)
+{
+	adc_check_state state[ADC_CHECK_CHAN_GROUP];
+	const uint8_t *data;
+	uint32_t stride;
+	uint32_t mask;
+	uint32_t group;
+	uint32_t group_size;
+	uint32_t sample;
+	uint32_t received;
+	uint32_t expected = 0;
+	uint32_t index;
+	uint8_t ret;
+#ifdef ADC_CHECK_NEON
+	uint32_t rows;
+	uint8_t fast;
+#endif
+
+	result->no_of_errors = 0;
+	result->no_of_checked = 0;
+
+	if ((config->no_of_channels == 0) ||
+	    ((config->sample_bytes != 1) && (config->sample_bytes != 2) &&
+	     (config->sample_bytes != 4)) ||
+	    (config->resolution == 0) ||
+	    (config->resolution > (config->sample_bytes * 8)) ||
+	    ((config->pattern == ADC_CHECK_USER) &&
+	     (!config->user_data || !config->user_length))) {
+		ad_printf("%s: unsupported configuration.\n", __func__);
+		return -1;
+	}
+
+	mask = (config->resolution == 32) ? 0xffffffff :
+			((1u << config->resolution) - 1);
+	stride = config->no_of_channels * config->sample_bytes;
+
+	ad_dcache_invalidate_range(start_address, no_of_samples * stride);
+
+#ifdef ADC_CHECK_NEON
+	fast = (config->pattern == ADC_CHECK_RAMP) &&
+		(config->sample_bytes == 2) &&
+		((8 % config->no_of_channels) == 0);
+#endif
+
+	for (group = 0; group < config->no_of_channels;
+			group += ADC_CHECK_CHAN_GROUP) {
+		group_size = config->no_of_channels - group;
+		if (group_size > ADC_CHECK_CHAN_GROUP)
+			group_size = ADC_CHECK_CHAN_GROUP;
+		for (index = 0; index < group_size; index++) {
+			state[index].expected = 0;
+			state[index].pn_state = 0;
+			state[index].phase = 0;
+			state[index].locked = 0;
+		}
+
+		sample = 0;
+		while (sample < no_of_samples) {
+#ifdef ADC_CHECK_NEON
+			if (fast && sample) {
+				rows = adc_check_ramp_neon((const uint16_t *)
+						(start_address + sample * stride),
+						no_of_samples - sample,
+						config->no_of_channels, state,
+						config->ramp_step, mask);
+				result->no_of_checked += rows * config->no_of_channels;
+				sample += rows;
+				if (sample == no_of_samples)
+					break;
+			}
+#endif
+			data = (const uint8_t *)(start_address + sample * stride +
+					group * config->sample_bytes);
+			for (index = 0; index < group_size; index++) {
+				received = adc_check_read(data, config->sample_bytes) & mask;
+				data += config->sample_bytes;
+				ret = adc_check_sample(config, &state[index],
+						received, mask, &expected);
+				if (ret == ADC_CHECK_SEED)
+					continue;
+				result->no_of_checked++;
+				if (ret == ADC_CHECK_MISMATCH)
+					adc_check_record(result, group + index, sample,
+							received, expected);
+			}
+			sample++;
+		}
+	}
+
+	return result->no_of_errors ? -1 : 0;
+}
@@ -0,0 +1,100 @@
+/***************************************************************************//**
+ * @file adc_check.h
+ * @brief Header file of the capture data integrity checker.
+ ********************************************************************************
+ * Copyright 2016(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in
+ * the documentation and/or other materials provided with the
+ * distribution.
+ * - Neither the name of Analog Devices, Inc. nor the names of its
+ * contributors may be used to endorse or promote products derived
+ * from this software without specific prior written permission.
+ * - The use of this software may or may not infringe the patent rights
+ * of one or more patent holders. This license does not release you
+ * from the requirement that you obtain separate licenses from these
+ * patent holders to use this software.
+ * - Use of the software either in source or binary form, must be run
+ * on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *******************************************************************************/
+#ifndef ADC_CHECK_H_
+#define ADC_CHECK_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include "platform_drivers.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Channels checked in one pass over the buffer, wider captures take several
+ * passes. */
+#define ADC_CHECK_CHAN_GROUP		16
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+typedef enum {
+	ADC_CHECK_RAMP,
+	ADC_CHECK_PN9,		// x^9 + x^5 + 1
+	ADC_CHECK_PN23,		// x^23 + x^18 + 1
+	ADC_CHECK_USER,
+} adc_check_pattern;
+
+/* The buffer holds no_of_channels interleaved channels, each sample is
+ * sample_bytes wide in memory with the data in its resolution LSBs. */
+typedef struct {
+	adc_check_pattern	pattern;
+	uint32_t		no_of_channels;
+	uint8_t			sample_bytes;	// 1, 2 or 4
+	uint8_t			resolution;	// 1 to 32 bits
+	uint32_t		ramp_step;	// per sample of a channel
+	uint8_t			pn_invert;	// PN data is inverted
+	const uint32_t		*user_data;	// repeated on every channel
+	uint32_t		user_length;
+} adc_check_config;
+
+typedef struct {
+	uint32_t	channel;
+	uint32_t	sample;		// sample index within the channel
+	uint32_t	received;
+	uint32_t	expected;
+} adc_check_error;
+
+typedef struct {
+	adc_check_error	*errors;	// the first max_errors, may be NULL
+	uint32_t	max_errors;
+	uint32_t	no_of_errors;
+	uint32_t	no_of_checked;	// samples compared, seeds excluded
+} adc_check_result;
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+int32_t adc_check_buffer(const adc_check_config *config,
+		uint32_t start_address,
+		uint32_t no_of_samples,
+		adc_check_result *result);
+#endif
@@ -41,6 +41,7 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include "adc_core.h"
+#include "adc_check.h"
 
 /***************************************************************************//**
  * @brief adc_read
@@ -156,90 +157,334 @@ uint32_t adc_set_delay(adc_core core, uint32_t no_of_lanes, uint32_t delay)
 }
 
 /***************************************************************************//**
- * @brief ADC delay.
+ * @brief adc_pn_start - enable the channels and select the PN sequence of
+ *        their monitors.
+ *******************************************************************************/
+static void adc_pn_start(adc_core core,
+		enum adc_pn_sel sel)
+{
+	uint8_t	index;
+	uint32_t reg_data;
+
+	for (index = 0; index < core.no_of_channels; index++) {
+		adc_read(core, ADC_REG_CHAN_CNTRL(index), &reg_data);
+		reg_data |= ADC_ENABLE;
+		adc_write(core, ADC_REG_CHAN_CNTRL(index), reg_data);
+		adc_set_pnsel(core, index, sel);
+	}
+	mdelay(1);
+}
+
+/***************************************************************************//**
+ * @brief adc_pn_errors - clear the PN monitors, let them run for window_us
+ *        and return the mask of the channels that saw errors.
+ *******************************************************************************/
+static uint32_t adc_pn_errors(adc_core core,
+		uint32_t window_us)
+{
+	uint8_t	index;
+	uint32_t reg_data;
+	uint32_t errors = 0;
+
+	udelay(ADC_DELAY_SETTLE_US);
+	for (index = 0; index < core.no_of_channels; index++)
+		adc_write(core, ADC_REG_CHAN_STATUS(index), 0xff);
+	udelay(window_us);
+
+	for (index = 0; index < core.no_of_channels; index++) {
+		adc_read(core, ADC_REG_CHAN_STATUS(index), &reg_data);
+		if (reg_data != 0)
+			errors |= (1 << index);
+	}
+
+	return errors;
+}
+
+/***************************************************************************//**
+ * @brief adc_delay_lane_err - did the PN monitor that sees this lane fail.
+ *******************************************************************************/
+static uint8_t adc_delay_lane_err(uint32_t errors,
+		const uint8_t *lane_chan,
+		uint32_t lane)
+{
+	if (!lane_chan)
+		return (errors != 0);
+
+	return (errors >> lane_chan[lane]) & 1;
+}
+
+/***************************************************************************//**
+ * @brief adc_delay_map_checksum
+ *******************************************************************************/
+static uint32_t adc_delay_map_checksum(adc_delay_map *map)
+{
+	const uint8_t *p = (const uint8_t *)map;
+	uint32_t i, a = 1, b = 0;
+
+	for (i = 0; i < sizeof(*map) - sizeof(map->checksum); i++) {
+		a = (a + p[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+
+	return (b << 16) | a;
+}
+
+/***************************************************************************//**
+ * @brief adc_delay_eye_scan - find the data eye of every lane and center each
+ *        lane in its own eye.
  *
+ * A coarse sweep with all the lanes moved together finds the widest passing
+ * run of every lane. Each lane is then moved alone and the two edges of its
+ * eye are found with a binary search between the last failing and the first
+ * passing coarse tap on each side, so a second eye in the tap range is never
+ * reached. With a coarse step of 1 the edges are already known. lane_chan gives the channel whose PN monitor sees each lane; lanes of
+ * different channels are searched in parallel. With lane_chan NULL any
+ * channel error counts against the lane and the lanes are searched one at a
+ * time. Every step only runs the PN monitors for ADC_DELAY_PN_WINDOW_US.
+ *
+ *	Note:
+ *		The device must be in PRBS test mode, when calling this function
+ *
+ * @return 0 if every lane has an eye, -1 otherwise.
 *******************************************************************************/
-uint32_t adc_delay_calibrate(adc_core core,
-			uint32_t no_of_lanes,
-			enum adc_pn_sel sel)
+int32_t adc_delay_eye_scan(adc_core core,
+		uint32_t no_of_lanes,
+		enum adc_pn_sel sel,
+		const uint8_t *lane_chan,
+		adc_delay_map *map)
 {
-	uint8_t err_field[32] = {0};
-	uint16_t valid_range[5] = {0};
-	uint16_t invalid_range[5] = {0};
-	uint16_t delay = 0;
-	uint16_t start_valid_delay = 32;
-	uint16_t start_invalid_delay = 32;
-	uint8_t interval = 0;
-	uint8_t max_interval = 0;
-	uint8_t max_valid_range = 0;
-	uint8_t cnt_valid[5] = {0};
-	uint8_t cnt_invalid = 0;
-	uint8_t val = 0;
-	uint8_t max_val = 32;
-
-	for (delay = 0; delay < 32; delay++) {
-		adc_set_delay(core, no_of_lanes, delay);
-		mdelay(20);
-		if (adc_pn_mon(core, sel) == 0) {
-			err_field[delay] = 0;
-			start_valid_delay = start_valid_delay == 32 ? delay : start_valid_delay;
-		} else {
-			err_field[delay] = 1;
+	uint32_t pass[ADC_DELAY_TAPS];
+	uint8_t rank[ADC_DELAY_MAX_LANES];
+	uint8_t base[ADC_DELAY_MAX_LANES];
+	uint8_t first[ADC_DELAY_MAX_LANES];
+	uint8_t last[ADC_DELAY_MAX_LANES];
+	uint8_t lo[ADC_DELAY_MAX_LANES];
+	uint8_t hi[ADC_DELAY_MAX_LANES];
+	uint8_t mid[ADC_DELAY_MAX_LANES];
+	uint8_t run_start, run_len, best_start, best_len;
+	uint8_t no_of_rounds = 0;
+	uint8_t round, edge, busy;
+	uint32_t errors;
+	uint32_t pcore_version;
+	uint32_t lane, l;
+	uint32_t step, tap;
+	int32_t ret = 0;
+
+	adc_read(core, 0x0, &pcore_version);
+	if (((pcore_version >> 16) < 9) || (no_of_lanes > ADC_DELAY_MAX_LANES)) {
+		ad_printf("%s unsupported configuration.\n", __func__);
+		return -1;
+	}
+
+	adc_pn_start(core, sel);
+
+	// lanes seen by the same monitor go in different rounds
+	for (lane = 0; lane < no_of_lanes; lane++) {
+		rank[lane] = 0;
+		for (l = 0; l < lane; l++)
+			if (!lane_chan || (lane_chan[l] == lane_chan[lane]))
+				rank[lane]++;
+		if (rank[lane] >= no_of_rounds)
+			no_of_rounds = rank[lane] + 1;
+	}
+
+	// coarse sweep, all lanes together
+	for (step = ADC_DELAY_COARSE_STEP; step > 0; step = (step > 1) ? 1 : 0) {
+		for (tap = 0; tap < ADC_DELAY_TAPS; tap += step) {
+			for (lane = 0; lane < no_of_lanes; lane++)
+				adc_write(core, ADC_REG_DELAY(lane), tap);
+			errors = adc_pn_errors(core, ADC_DELAY_PN_WINDOW_US);
+			pass[tap] = 0;
+			for (lane = 0; lane < no_of_lanes; lane++)
+				if (!adc_delay_lane_err(errors, lane_chan, lane))
+					pass[tap] |= (1 << lane);
+		}
+
+		busy = 0;
+		for (lane = 0; lane < no_of_lanes; lane++) {
+			run_len = best_len = 0;
+			run_start = best_start = 0;
+			for (tap = 0; tap < ADC_DELAY_TAPS; tap += step) {
+				if (pass[tap] & (1 << lane)) {
+					if (!run_len)
+						run_start = tap;
+					run_len++;
+					if (run_len > best_len) {
+						best_len = run_len;
+						best_start = run_start;
+					}
+				} else {
+					run_len = 0;
+				}
+			}
+			if (!best_len)
+				busy = 1;
+			first[lane] = best_start;
+			last[lane] = best_start + (best_len - 1) * step;
+			base[lane] = best_start + ((best_len - 1) * step) / 2;
 		}
+		// an eye narrower than the coarse step, sweep every tap
+		if (!busy)
+			break;
 	}
-	if (start_valid_delay > 31) {
+	if (busy) {
 		ad_printf("%s FAILED.\n", __func__);
-		adc_set_delay(core, no_of_lanes, 0);
-		return(1);
+		return -1;
 	}
 
-	start_valid_delay = 32;
-	start_invalid_delay = 32;
-	for (val = 0; val < max_val; val++) {
-		if (err_field[val] == 0) {
-			if (start_valid_delay == 32) {
-				start_valid_delay = val;
-			}
-			if (start_valid_delay != 32 && start_invalid_delay != 32 ) {
-				start_valid_delay = 32;
-				start_invalid_delay = 32;
-			}
-			cnt_valid[interval]++;
-		} else {
-			if (start_invalid_delay == 32) {
-				start_invalid_delay = val;
+	for (lane = 0; lane < no_of_lanes; lane++)
+		adc_write(core, ADC_REG_DELAY(lane), base[lane]);
+
+	// fine search of both edges of every lane
+	for (round = 0; round < no_of_rounds; round++) {
+		for (edge = 0; edge < 2; edge++) {
+			// between the coarse pass run and its neighbouring fails
+			for (lane = 0; lane < no_of_lanes; lane++) {
+				if (edge) {
+					lo[lane] = last[lane];
+					hi[lane] = min(last[lane] + step - 1,
+						       ADC_DELAY_TAPS - 1);
+				} else {
+					lo[lane] = (first[lane] >= step) ?
+						   (first[lane] - step + 1) : 0;
+					hi[lane] = first[lane];
+				}
 			}
-			if (start_valid_delay != 32 && start_invalid_delay != 32 ) {
-				valid_range[interval] = start_valid_delay;
-				invalid_range[interval] = start_invalid_delay;
-				start_valid_delay = 32;
-				start_invalid_delay = 32;
-				interval++;
+			do {
+				busy = 0;
+				for (lane = 0; lane < no_of_lanes; lane++) {
+					if (rank[lane] != round)
+						continue;
+					mid[lane] = base[lane];
+					if (lo[lane] < hi[lane]) {
+						mid[lane] = edge ? ((lo[lane] + hi[lane] + 1) / 2) :
+								 ((lo[lane] + hi[lane]) / 2);
+						busy = 1;
+					}
+					adc_write(core, ADC_REG_DELAY(lane), mid[lane]);
+				}
+				if (!busy)
+					break;
+
+				errors = adc_pn_errors(core, ADC_DELAY_PN_WINDOW_US);
+				for (lane = 0; lane < no_of_lanes; lane++) {
+					if ((rank[lane] != round) || (lo[lane] >= hi[lane]))
+						continue;
+					if (adc_delay_lane_err(errors, lane_chan, lane)) {
+						if (edge)
+							hi[lane] = mid[lane] - 1;
+						else
+							lo[lane] = mid[lane] + 1;
+					} else {
+						if (edge)
+							lo[lane] = mid[lane];
+						else
+							hi[lane] = mid[lane];
+					}
+				}
+			} while (busy);
+
+			for (lane = 0; lane < no_of_lanes; lane++) {
+				if (rank[lane] != round)
+					continue;
+				if (edge)
+					map->eye[lane].end = lo[lane];
+				else
+					map->eye[lane].start = hi[lane];
 			}
-			cnt_invalid++;
 		}
-	}
 
-	for (val = 0; val < 5; val++) {
-		if (cnt_valid[val] > max_valid_range) {
-			max_valid_range = cnt_valid[val];
-			max_interval = val;
+		for (lane = 0; lane < no_of_lanes; lane++) {
+			if (rank[lane] != round)
+				continue;
+			map->eye[lane].width = map->eye[lane].end -
+					map->eye[lane].start + 1;
+			map->eye[lane].delay = (map->eye[lane].start +
+					map->eye[lane].end) / 2;
+			adc_write(core, ADC_REG_DELAY(lane), map->eye[lane].delay);
+			ad_printf("adc_delay: lane %d eye %d-%d, setting delay (%d)\n\r",
+					lane, map->eye[lane].start, map->eye[lane].end,
+					map->eye[lane].delay);
 		}
 	}
 
-	delay = (valid_range[max_interval] + invalid_range[max_interval] -1)/2;
+	if (adc_pn_errors(core, ADC_DELAY_PN_WINDOW_US)) {
+		ad_printf("%s FAILED.\n", __func__);
+		ret = -1;
+	}
+
+	map->magic = ADC_DELAY_MAP_MAGIC;
+	map->no_of_lanes = no_of_lanes;
+	for (lane = no_of_lanes; lane < ADC_DELAY_MAX_LANES; lane++) {
+		map->eye[lane].start = 0;
+		map->eye[lane].end = 0;
+		map->eye[lane].width = 0;
+		map->eye[lane].delay = 0;
+	}
+	map->checksum = adc_delay_map_checksum(map);
+
+	return ret;
+}
 
-	ad_printf("adc_delay: setting zero error delay (%d)\n\r", delay);
-	adc_set_delay(core, no_of_lanes, delay);
+/***************************************************************************//**
+ * @brief adc_delay_map_restore - apply the lane delays of a previous
+ *        adc_delay_eye_scan() and check them with a single PN window.
+ *	Note:
+ *		The device must be in PRBS test mode, when calling this function
+ *
+ * @return 0 if the saved delays are still error free, -1 if a new scan is
+ *         needed.
+*******************************************************************************/
+int32_t adc_delay_map_restore(adc_core core,
+		uint32_t no_of_lanes,
+		enum adc_pn_sel sel,
+		adc_delay_map *map)
+{
+	uint32_t lane;
+
+	if ((map->magic != ADC_DELAY_MAP_MAGIC) ||
+	    (map->no_of_lanes != no_of_lanes) ||
+	    (map->checksum != adc_delay_map_checksum(map)))
+		return -1;
+
+	for (lane = 0; lane < no_of_lanes; lane++)
+		adc_write(core, ADC_REG_DELAY(lane), map->eye[lane].delay);
+
+	adc_pn_start(core, sel);
+	if (adc_pn_errors(core, ADC_DELAY_PN_WINDOW_US))
+		return -1;
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief ADC delay.
+ *
+ * If map holds the result of an earlier calibration and those delays are
+ * still error free, they are reapplied without a scan. Otherwise the eye scan
+ * runs and map is updated. map can be NULL.
+*******************************************************************************/
+uint32_t adc_delay_calibrate(adc_core core,
+			uint32_t no_of_lanes,
+			enum adc_pn_sel sel,
+			adc_delay_map *map)
+{
+	adc_delay_map scan;
+
+	if (!map) {
+		map = &scan;
+	} else if (!adc_delay_map_restore(core, no_of_lanes, sel, map)) {
+		ad_printf("adc_delay: saved lane delays restored\n\r");
+		return(0);
+	}
 
-#ifdef DEBUG
-	ad_printf("Error field (0=success, 1=fail):\n");
-	for (delay = 0; delay < 32; delay++) {
-		ad_printf("%d",err_field[delay]);
+	if (adc_delay_eye_scan(core, no_of_lanes, sel, NULL, map)) {
+		adc_set_delay(core, no_of_lanes, 0);
+		map->magic = 0;
+		return(1);
 	}
-#endif
 
-    return(0);
+	return(0);
 }
 
 /***************************************************************************//**
@@ -267,96 +512,45 @@ int32_t adc_set_pnsel(adc_core core,
 int32_t adc_pn_mon(adc_core core,
 		enum adc_pn_sel sel)
 {
-	uint8_t	index;
-	uint32_t reg_data;
-	int32_t pn_errors = 0;
-
-	for (index = 0; index < core.no_of_channels; index++) {
- 		adc_read(core, ADC_REG_CHAN_CNTRL(index), &reg_data);
- 		reg_data |= ADC_ENABLE;
- 		adc_write(core, ADC_REG_CHAN_CNTRL(index), reg_data);
-		adc_set_pnsel(core, index, sel);
-	}
-	mdelay(1);
+	adc_pn_start(core, sel);
 
-	for (index = 0; index < core.no_of_channels; index++) {
-		adc_write(core, ADC_REG_CHAN_STATUS(index), 0xff);
-	}
-	mdelay(100);
-
-	for (index = 0; index < core.no_of_channels; index++) {
-		adc_read(core, ADC_REG_CHAN_STATUS(index), &reg_data);
-		if (reg_data != 0) {
-			pn_errors = -1;
-		}
-	}
-
-	return pn_errors;
+	return adc_pn_errors(core, 100000) ? -1 : 0;
 }
 
 /***************************************************************************//**
  * @brief adc_ramp_test
- *	  This functions supports channel number multiple of 2 (e.g 1/2/4/6/8...)
  *******************************************************************************/
 int32_t adc_ramp_test(adc_core core,
 		uint8_t no_of_cores,
 		uint32_t no_of_samples,
 		uint32_t start_address)
 {
-	uint8_t	 err_cnt = 0;
-	uint16_t exp_data[32];
-	uint16_t rcv_data[32];
-	uint8_t index;
-	uint32_t mask = ad_pow2(core.resolution);
-	uint8_t no_of_channels = core.no_of_channels*no_of_cores;
-	uint32_t current_address = start_address;
-	uint32_t last_address = start_address + (no_of_channels*no_of_samples)*2;
-	uint32_t sample_count = 0;
-
-	while (current_address < last_address) {
-
-		// read data back from memory, one samples from each channel, min a word
-		for (index=0; index<no_of_channels; index+=2) {
-			rcv_data[index] = ad_reg_read(current_address + index) & mask;
-			rcv_data[index+1] = (ad_reg_read(current_address + index) >> 16) & mask;
-		}
-
-		// generate expected data
-		for (index=0; index<no_of_channels; index+=2) {
-			if (current_address == start_address) {
-				exp_data[index] = rcv_data[index];
-				exp_data[index+1] = rcv_data[index+1];
-			} else {
-				if(no_of_channels < 2) {
-					exp_data[index] = ((exp_data[index]+2) > mask) ? ((exp_data[index]+2) & mask) : (exp_data[index] + 2);
-					exp_data[index+1] = ((exp_data[index+1]+2) > mask) ? ((exp_data[index+1]+2) & mask) : (exp_data[index+1] + 2);
-				} else {
-					exp_data[index] = (exp_data[index] == mask) ? 0 : exp_data[index] + 1;
-					exp_data[index+1] = (exp_data[index+1] == mask) ? 0 : exp_data[index+1] + 1;
-				}
-			}
-		}
-
-		// compare received and expected
-		for (index=0; index<no_of_channels; index+=2) {
-			if ((rcv_data[index] != exp_data[index]) || (rcv_data[index+1] != exp_data[index+1])) {
-				ad_printf("%s Capture Error[%d]: rcv(%08x) exp(%08x).\n",
-						__func__, sample_count+index, rcv_data[index], exp_data[index]);
-				ad_printf("%s Capture Error[%d]: rcv(%08x) exp(%08x).\n",
-						__func__, sample_count+index+1, rcv_data[index+1], exp_data[index+1]);
-				err_cnt++;
-				if (err_cnt == 50) break;
-			}
-		}
-		sample_count+=index;
+	adc_check_error errors[50];
+	adc_check_result result;
+	adc_check_config config;
+	uint32_t index;
+
+	config.pattern = ADC_CHECK_RAMP;
+	config.no_of_channels = core.no_of_channels * no_of_cores;
+	config.sample_bytes = 2;
+	config.resolution = core.resolution;
+	config.ramp_step = 1;
+	config.pn_invert = 0;
+	config.user_data = NULL;
+	config.user_length = 0;
+
+	result.errors = errors;
+	result.max_errors = 50;
+
+	if (adc_check_buffer(&config, start_address, no_of_samples, &result) == 0)
+		return 0;
 
-		// increment address pointer
-		current_address = (no_of_channels == 1) ? (current_address+4) :
-							(current_address+(no_of_channels*2));
-	}
+	for (index = 0; (index < result.no_of_errors) && (index < 50); index++)
+		ad_printf("%s Capture Error[%d]: rcv(%08x) exp(%08x).\n",
+				__func__,
+				errors[index].sample * config.no_of_channels +
+				errors[index].channel,
+				errors[index].received, errors[index].expected);
 
-	if (err_cnt)
-		return -1;
-	else
-		return 0;
+	return -1;
 }
@@ -103,6 +103,15 @@
 #define ADC_ADC_DATA_SEL(x)		(((x) & 0xF) << 0)
 #define ADC_TO_ADC_DATA_SEL(x)		(((x) >> 0) & 0xF)
 
+#define ADC_REG_DELAY(l)		((0x200 + (l)) * 4)
+
+#define ADC_DELAY_TAPS			32
+#define ADC_DELAY_MAX_LANES		32
+#define ADC_DELAY_COARSE_STEP		4
+#define ADC_DELAY_SETTLE_US		10
+#define ADC_DELAY_PN_WINDOW_US		1000
+#define ADC_DELAY_MAP_MAGIC		0x41444C59
+
 enum adc_pn_sel {
 	ADC_PN9 = 0,
 	ADC_PN23A = 1,
@@ -121,6 +130,21 @@ typedef struct {
 	uint8_t	 resolution;
 } adc_core;
 
+typedef struct {
+	uint8_t	 start;		// first error free tap
+	uint8_t	 end;		// last error free tap
+	uint8_t	 width;		// 0 if the lane has no eye
+	uint8_t	 delay;		// applied tap, center of the eye
+} adc_delay_eye;
+
+// result of adc_delay_eye_scan(), can be kept over a warm boot
+typedef struct {
+	uint32_t magic;
+	uint32_t no_of_lanes;
+	adc_delay_eye eye[ADC_DELAY_MAX_LANES];
+	uint32_t checksum;
+} adc_delay_map;
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -132,10 +156,20 @@ int32_t adc_write(adc_core core,
 		uint32_t reg_data);
 uint32_t adc_delay_calibrate(adc_core core,
 		uint32_t no_of_lanes,
-		enum adc_pn_sel sel);
+		enum adc_pn_sel sel,
+		adc_delay_map *map);
 uint32_t adc_set_delay(adc_core core,
 		uint32_t no_of_lanes,
 		uint32_t delay);
+int32_t adc_delay_eye_scan(adc_core core,
+		uint32_t no_of_lanes,
+		enum adc_pn_sel sel,
+		const uint8_t *lane_chan,
+		adc_delay_map *map);
+int32_t adc_delay_map_restore(adc_core core,
+		uint32_t no_of_lanes,
+		enum adc_pn_sel sel,
+		adc_delay_map *map);
 int32_t adc_setup(adc_core core);
 int32_t adc_set_pnsel(adc_core core,
 		uint8_t channel,
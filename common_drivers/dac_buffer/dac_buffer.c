@@ -159,47 +159,422 @@ static const uint16_t sine_lut[1024] = {
 		0xF4D2,0xDF8F,0xCB77,0xB944,0xA99F,0x9D17,0x9421,0x8F0E,0x8E0F,
 		0x912C,0x9849,0xA323,0xB157,0xC261,0xD5A4,0xEA6F};
 
+/* First quadrant of a full scale sine, used by the waveform generators */
+static const uint16_t sine_quarter[257] = {
+		0x0000,0x00C9,0x0192,0x025B,0x0324,0x03ED,0x04B6,0x057F,0x0648,
+		0x0711,0x07D9,0x08A2,0x096A,0x0A33,0x0AFB,0x0BC4,0x0C8C,0x0D54,
+		0x0E1C,0x0EE3,0x0FAB,0x1072,0x113A,0x1201,0x12C8,0x138F,0x1455,
+		0x151C,0x15E2,0x16A8,0x176E,0x1833,0x18F9,0x19BE,0x1A82,0x1B47,
+		0x1C0B,0x1CCF,0x1D93,0x1E57,0x1F1A,0x1FDD,0x209F,0x2161,0x2223,
+		0x22E5,0x23A6,0x2467,0x2528,0x25E8,0x26A8,0x2767,0x2826,0x28E5,
+		0x29A3,0x2A61,0x2B1F,0x2BDC,0x2C99,0x2D55,0x2E11,0x2ECC,0x2F87,
+		0x3041,0x30FB,0x31B5,0x326E,0x3326,0x33DF,0x3496,0x354D,0x3604,
+		0x36BA,0x376F,0x3824,0x38D9,0x398C,0x3A40,0x3AF2,0x3BA5,0x3C56,
+		0x3D07,0x3DB8,0x3E68,0x3F17,0x3FC5,0x4073,0x4121,0x41CE,0x427A,
+		0x4325,0x43D0,0x447A,0x4524,0x45CD,0x4675,0x471C,0x47C3,0x4869,
+		0x490F,0x49B4,0x4A58,0x4AFB,0x4B9D,0x4C3F,0x4CE0,0x4D81,0x4E20,
+		0x4EBF,0x4F5D,0x4FFB,0x5097,0x5133,0x51CE,0x5268,0x5302,0x539B,
+		0x5432,0x54C9,0x5560,0x55F5,0x568A,0x571D,0x57B0,0x5842,0x58D3,
+		0x5964,0x59F3,0x5A82,0x5B0F,0x5B9C,0x5C28,0x5CB3,0x5D3E,0x5DC7,
+		0x5E4F,0x5ED7,0x5F5D,0x5FE3,0x6068,0x60EB,0x616E,0x61F0,0x6271,
+		0x62F1,0x6370,0x63EE,0x646C,0x64E8,0x6563,0x65DD,0x6656,0x66CF,
+		0x6746,0x67BC,0x6832,0x68A6,0x6919,0x698B,0x69FD,0x6A6D,0x6ADC,
+		0x6B4A,0x6BB7,0x6C23,0x6C8E,0x6CF8,0x6D61,0x6DC9,0x6E30,0x6E96,
+		0x6EFB,0x6F5E,0x6FC1,0x7022,0x7083,0x70E2,0x7140,0x719D,0x71F9,
+		0x7254,0x72AE,0x7307,0x735E,0x73B5,0x740A,0x745F,0x74B2,0x7504,
+		0x7555,0x75A5,0x75F3,0x7641,0x768D,0x76D8,0x7722,0x776B,0x77B3,
+		0x77FA,0x783F,0x7884,0x78C7,0x7909,0x794A,0x7989,0x79C8,0x7A05,
+		0x7A41,0x7A7C,0x7AB6,0x7AEE,0x7B26,0x7B5C,0x7B91,0x7BC5,0x7BF8,
+		0x7C29,0x7C59,0x7C88,0x7CB6,0x7CE3,0x7D0E,0x7D39,0x7D62,0x7D89,
+		0x7DB0,0x7DD5,0x7DFA,0x7E1D,0x7E3E,0x7E5F,0x7E7E,0x7E9C,0x7EB9,
+		0x7ED5,0x7EEF,0x7F09,0x7F21,0x7F37,0x7F4D,0x7F61,0x7F74,0x7F86,
+		0x7F97,0x7FA6,0x7FB4,0x7FC1,0x7FCD,0x7FD8,0x7FE1,0x7FE9,0x7FF0,
+		0x7FF5,0x7FF9,0x7FFD,0x7FFE,0x7FFF};
+
+/* Samples generated on the stack before they are stored to the buffer */
+#define DAC_BUFFER_CHUNK	64
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
-uint32_t dac_buffer_load(dac_core core, uint32_t start_address) {
+/***************************************************************************//**
+ * @brief dac_buffer_sin - sine of a 32-bit phase, 2^32 being a full turn.
+ *******************************************************************************/
+
+static int32_t dac_buffer_sin(uint32_t phase)
+{
+	uint32_t index = (phase >> 22) & 0xff;
+
+	switch (phase >> 30) {
+	case 0:
+		return sine_quarter[index];
+	case 1:
+		return sine_quarter[256 - index];
+	case 2:
+		return -(int32_t)sine_quarter[index];
+	default:
+		return -(int32_t)sine_quarter[256 - index];
+	}
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_sat
+ *******************************************************************************/
+
+static int16_t dac_buffer_sat(int32_t value)
+{
+	if (value > 32767)
+		return 32767;
+	if (value < -32768)
+		return -32768;
+
+	return value;
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_cycles_to_incr - phase increment of a tone that completes
+ *        'cycles' periods in no_of_samples samples.
+ *******************************************************************************/
+
+static uint32_t dac_buffer_cycles_to_incr(int32_t cycles,
+		uint32_t no_of_samples)
+{
+	return (uint32_t)(((int64_t)cycles * 0x100000000LL) / (int64_t)no_of_samples);
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_store - store count IQ pairs in the interleaved layout of
+ *        the core, two 16-bit channels per 32-bit write. Returns the number of
+ *        bytes written.
+ *******************************************************************************/
+
+static uint32_t dac_buffer_store(dac_core *core, uint32_t address,
+		const int16_t *iq, uint32_t count)
+{
+	uint32_t index;
+	uint32_t word;
+
+	switch (core->no_of_channels) {
+	case 1:
+		/* I only, two consecutive samples per word */
+		for (index = 0; index < count; index += 2)
+			ad_reg_write(address + index * 2,
+				     (uint16_t)iq[2 * index] |
+				     ((uint32_t)(uint16_t)iq[2 * index + 2] << 16));
+		return count * 2;
+	case 2:
+		for (index = 0; index < count; index++)
+			ad_reg_write(address + index * 4,
+				     (uint16_t)iq[2 * index] |
+				     ((uint32_t)(uint16_t)iq[2 * index + 1] << 16));
+		return count * 4;
+	case 4:
+		/* the same IQ pair on both converters */
+		for (index = 0; index < count; index++) {
+			word = (uint16_t)iq[2 * index] |
+			       ((uint32_t)(uint16_t)iq[2 * index + 1] << 16);
+			ad_reg_write(address + index * 8 + 0, word);
+			ad_reg_write(address + index * 8 + 4, word);
+		}
+		return count * 8;
+	default:
+		ad_printf("Unsupported mode.\n\r");
+		return 0;
+	}
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_check
+ *******************************************************************************/
+
+static int32_t dac_buffer_check(dac_core *core, uint32_t no_of_samples)
+{
+	if (!no_of_samples || (no_of_samples % DAC_BUFFER_CHUNK) ||
+	    ((core->no_of_channels != 1) && (core->no_of_channels != 2) &&
+	     (core->no_of_channels != 4))) {
+		ad_printf("%s : Unsupported buffer configuration.\n", __func__);
+		return -1;
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_load - load the default sine (I) / cosine (Q) waveform.
+ *******************************************************************************/
 
+uint32_t dac_buffer_load(dac_core core, uint32_t start_address)
+{
+	int16_t iq[2 * DAC_BUFFER_CHUNK];
 	uint32_t no_of_samples;
 	uint32_t index_i, index_q;
-	uint32_t index_mem = 0;
+	uint32_t address = start_address;
+	uint32_t n;
 
 	no_of_samples = sizeof(sine_lut) / sizeof(typeof(sine_lut[0]));
+	if (dac_buffer_check(&core, no_of_samples))
+		return 0;
 
-	for (index_i = 0; index_i < no_of_samples; index_i++) {
-		 /* Phase shifted by 90 degree */
-		index_q = (index_i + 256) % no_of_samples;
+	for (index_i = 0; index_i < no_of_samples; index_i += n) {
+		for (n = 0; n < DAC_BUFFER_CHUNK; n++) {
+			/* Phase shifted by 90 degree */
+			index_q = (index_i + n + 256) % no_of_samples;
+			iq[2 * n + 0] = sine_lut[index_i + n];
+			iq[2 * n + 1] = sine_lut[index_q];
+		}
+		address += dac_buffer_store(&core, address, iq, n);
+	}
 
-		switch (core.no_of_channels) {
-			case 1:
-				ad_reg_write_16(start_address + index_mem * 2, sine_lut[index_i]);
-				index_mem += 1;
-				break;
-			case 2:
-				ad_reg_write_16(start_address + (index_mem + 0) * 2, sine_lut[index_i]);
-				ad_reg_write_16(start_address + (index_mem + 1) * 2, sine_lut[index_q]);
-				index_mem += 2;
-				break;
-			case 4:
-				ad_reg_write_16(start_address + (index_mem + 0) * 2, sine_lut[index_i]);
-				ad_reg_write_16(start_address + (index_mem + 1) * 2, sine_lut[index_q]);
-				ad_reg_write_16(start_address + (index_mem + 2) * 2, sine_lut[index_i]);
-				ad_reg_write_16(start_address + (index_mem + 3) * 2, sine_lut[index_q]);
-				index_mem += 4;
-				break;
-			default:
-				ad_printf("Unsupported mode.\n\r");
-				return -1;
+	ad_dcache_flush_range(start_address, address - start_address);
+
+	return (core.no_of_channels * no_of_samples);
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_load_iq - load user samples, given as interleaved I/Q
+ *        pairs (e.g. the content of an IQ file).
+ *******************************************************************************/
+
+uint32_t dac_buffer_load_iq(dac_core core, uint32_t start_address,
+		const int16_t *iq, uint32_t no_of_samples)
+{
+	uint32_t size;
+
+	if (dac_buffer_check(&core, no_of_samples))
+		return 0;
+
+	size = dac_buffer_store(&core, start_address, iq, no_of_samples);
+	ad_dcache_flush_range(start_address, size);
+
+	return (core.no_of_channels * no_of_samples);
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_gen_tones - synthesize the sum of up to
+ *        DAC_BUFFER_MAX_TONES complex tones. The sum is saturated to full
+ *        scale, keep the total amplitude below 0x7FFF to avoid clipping.
+ *******************************************************************************/
+
+uint32_t dac_buffer_gen_tones(dac_core core, uint32_t start_address,
+		const dac_buffer_tone *tones, uint8_t no_of_tones,
+		uint32_t no_of_samples)
+{
+	int16_t iq[2 * DAC_BUFFER_CHUNK];
+	uint32_t phase[DAC_BUFFER_MAX_TONES];
+	uint32_t incr[DAC_BUFFER_MAX_TONES];
+	uint32_t address = start_address;
+	uint32_t index, n;
+	int32_t i, q;
+	uint8_t t;
+
+	if (dac_buffer_check(&core, no_of_samples) ||
+	    !no_of_tones || (no_of_tones > DAC_BUFFER_MAX_TONES))
+		return 0;
+
+	for (t = 0; t < no_of_tones; t++) {
+		phase[t] = tones[t].phase;
+		incr[t] = dac_buffer_cycles_to_incr(tones[t].cycles, no_of_samples);
+	}
+
+	for (index = 0; index < no_of_samples; index += DAC_BUFFER_CHUNK) {
+		for (n = 0; n < DAC_BUFFER_CHUNK; n++) {
+			i = 0;
+			q = 0;
+			for (t = 0; t < no_of_tones; t++) {
+				/* cos(x) = sin(x + pi/2) */
+				i += (dac_buffer_sin(phase[t] + 0x40000000) *
+				      tones[t].amplitude) >> 15;
+				q += (dac_buffer_sin(phase[t]) *
+				      tones[t].amplitude) >> 15;
+				phase[t] += incr[t];
+			}
+			iq[2 * n + 0] = dac_buffer_sat(i);
+			iq[2 * n + 1] = dac_buffer_sat(q);
+		}
+		address += dac_buffer_store(&core, address, iq, DAC_BUFFER_CHUNK);
+	}
+
+	ad_dcache_flush_range(start_address, address - start_address);
+
+	return (core.no_of_channels * no_of_samples);
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_gen_chirp - synthesize a complex linear chirp sweeping
+ *        from start_cycles to stop_cycles (periods per buffer) over the buffer.
+ *******************************************************************************/
+
+uint32_t dac_buffer_gen_chirp(dac_core core, uint32_t start_address,
+		int32_t start_cycles, int32_t stop_cycles, uint16_t amplitude,
+		uint32_t no_of_samples)
+{
+	int16_t iq[2 * DAC_BUFFER_CHUNK];
+	uint32_t address = start_address;
+	uint32_t phase = 0;
+	uint32_t index, n;
+	int64_t incr, step;
+
+	if (dac_buffer_check(&core, no_of_samples))
+		return 0;
+
+	incr = (int32_t)dac_buffer_cycles_to_incr(start_cycles, no_of_samples);
+	step = ((int64_t)(int32_t)dac_buffer_cycles_to_incr(stop_cycles,
+			no_of_samples) - incr) * 65536 / no_of_samples;
+	incr *= 65536;
+
+	for (index = 0; index < no_of_samples; index += DAC_BUFFER_CHUNK) {
+		for (n = 0; n < DAC_BUFFER_CHUNK; n++) {
+			iq[2 * n + 0] = (dac_buffer_sin(phase + 0x40000000) *
+					 amplitude) >> 15;
+			iq[2 * n + 1] = (dac_buffer_sin(phase) * amplitude) >> 15;
+			phase += (uint32_t)(incr >> 16);
+			incr += step;
 		}
+		address += dac_buffer_store(&core, address, iq, DAC_BUFFER_CHUNK);
 	}
 
-	ad_dcache_flush();
+	ad_dcache_flush_range(start_address, address - start_address);
 
 	return (core.no_of_channels * no_of_samples);
 }
 
+/***************************************************************************//**
+ * @brief dac_buffer_slot_submit - queue a slot of the chain for a buffer.
+ *******************************************************************************/
+
+static int32_t dac_buffer_slot_submit(dac_buffer_player *player, uint8_t slot,
+		uint8_t buffer)
+{
+	player->slot[slot].start_address = player->buffer[buffer].start_address;
+	player->slot[slot].no_of_samples = player->buffer[buffer].no_of_samples;
+	player->slot_buffer[slot] = buffer;
+
+	return dmac_submit(player->dma, &player->slot[slot]);
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_refill - a slot was played, queue it again behind the
+ *        others. After a swap the old buffer is free once no queued slot
+ *        plays it anymore.
+ *******************************************************************************/
+
+static void dac_buffer_refill(void *cb_data, dmac_xfer *xfer)
+{
+	dac_buffer_player *player = cb_data;
+	uint8_t slot = xfer - player->slot;
+	uint8_t i;
+
+	if (slot >= DAC_BUFFER_SLOTS)
+		return;
+
+	if (player->swap_pending) {
+		for (i = 0; i < DAC_BUFFER_SLOTS; i++)
+			if ((i != slot) && (player->slot_buffer[i] == player->active))
+				break;
+		if (i == DAC_BUFFER_SLOTS) {
+			player->active = player->next;
+			player->swap_pending = 0;
+		}
+	}
+
+	dac_buffer_slot_submit(player, slot, player->next);
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_play - start the continuous playback of one of the
+ *        buffers. no_of_samples of the buffer must already be set (it is the
+ *        value returned by the loaders).
+ *
+ * The core only ends a cyclic transfer when it is stopped, so the buffer is
+ * played as a chain of DAC_BUFFER_SLOTS plain transfers instead. The core
+ * runs queued transfers back to back, and a swap takes effect at the start
+ * of the next slot queued after it.
+ *******************************************************************************/
+
+int32_t dac_buffer_play(dac_buffer_player *player, uint8_t buffer)
+{
+	dmac_core *dma = player->dma;
+	uint8_t slot;
+
+	if ((buffer > 1) || !player->buffer[buffer].no_of_samples)
+		return -1;
+
+	player->active = buffer;
+	player->next = buffer;
+	player->swap_pending = 0;
+
+	dma->flags &= ~DMAC_FLAGS_CYCLIC;
+	dma->submit_cb = NULL;
+	dma->complete_cb = dac_buffer_refill;
+	dma->cb_data = player;
+	dmac_init(dma);
+
+	for (slot = 0; slot < DAC_BUFFER_SLOTS; slot++)
+		if (dac_buffer_slot_submit(player, slot, buffer))
+			return -1;
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_back_address - the buffer that is not being played, where
+ *        the next waveform should be built.
+ *******************************************************************************/
+
+uint32_t dac_buffer_back_address(dac_buffer_player *player)
+{
+	return player->buffer[player->active ^ 1].start_address;
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_swap - play the back buffer once the slots already queued
+ *        with the current one are done, the waveform changes at a buffer
+ *        boundary without a gap.
+ *******************************************************************************/
+
+int32_t dac_buffer_swap(dac_buffer_player *player, uint32_t no_of_samples)
+{
+	if (player->swap_pending || !no_of_samples)
+		return -1;
+
+	player->buffer[player->active ^ 1].no_of_samples = no_of_samples;
+	player->next = player->active ^ 1;
+	player->swap_pending = 1;
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_swap_wait - wait for the core to be done with the old
+ *        buffer, after which it can be rebuilt.
+ *******************************************************************************/
+
+int32_t dac_buffer_swap_wait(dac_buffer_player *player, uint32_t timeout_ms)
+{
+	uint32_t timer = 0;
+
+	while (player->swap_pending) {
+		dmac_irq_handler(player->dma);
+		if (!player->swap_pending)
+			break;
+		if (timer++ == (timeout_ms * (1000 / DMAC_POLL_US)))
+			return -1;
+		udelay(DMAC_POLL_US);
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief dac_buffer_stop
+ *******************************************************************************/
+
+int32_t dac_buffer_stop(dac_buffer_player *player)
+{
+	dmac_stop(player->dma);
+	player->dma->complete_cb = NULL;
+	player->swap_pending = 0;
+
+	return 0;
+}
@@ -41,12 +41,61 @@
 #define DAC_BUFFER_H_
 
 #include "dac_core.h"
+#include "dmac_core.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define DAC_BUFFER_MAX_TONES		8
+#define DAC_BUFFER_SLOTS		3
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/* A complex tone. The frequency is given in periods per buffer so that the
+ * waveform wraps without a discontinuity when it is played cyclically. */
+typedef struct {
+	int32_t		cycles;		// negative for the lower sideband
+	uint16_t	amplitude;	// fraction of full scale, 0x7FFF is 1.0
+	uint32_t	phase;		// start phase, 2^32 is a full turn
+} dac_buffer_tone;
+
+/* Two DMA buffers, one played continuously while the other one is rebuilt.
+ * The playing buffer is kept queued DAC_BUFFER_SLOTS times as plain
+ * (non-cyclic) transfers, each slot is queued again from the completion
+ * interrupt, so dmac_irq_handler() must be connected to the core. */
+typedef struct {
+	dmac_core	*dma;
+	dmac_xfer	buffer[2];	// start_address set by the user
+	volatile uint8_t active;
+	volatile uint8_t swap_pending;
+	/* transfer chain, see dac_buffer_play() */
+	dmac_xfer	slot[DAC_BUFFER_SLOTS];
+	uint8_t		slot_buffer[DAC_BUFFER_SLOTS];
+	uint8_t		next;
+} dac_buffer_player;
 
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
 
 uint32_t dac_buffer_load(dac_core core, uint32_t start_address);
+uint32_t dac_buffer_load_iq(dac_core core, uint32_t start_address,
+		const int16_t *iq, uint32_t no_of_samples);
+uint32_t dac_buffer_gen_tones(dac_core core, uint32_t start_address,
+		const dac_buffer_tone *tones, uint8_t no_of_tones,
+		uint32_t no_of_samples);
+uint32_t dac_buffer_gen_chirp(dac_core core, uint32_t start_address,
+		int32_t start_cycles, int32_t stop_cycles, uint16_t amplitude,
+		uint32_t no_of_samples);
+
+int32_t dac_buffer_play(dac_buffer_player *player, uint8_t buffer);
+uint32_t dac_buffer_back_address(dac_buffer_player *player);
+int32_t dac_buffer_swap(dac_buffer_player *player, uint32_t no_of_samples);
+int32_t dac_buffer_swap_wait(dac_buffer_player *player, uint32_t timeout_ms);
+int32_t dac_buffer_stop(dac_buffer_player *player);
 
 #endif
 
@@ -79,16 +79,12 @@ int32_t dac_write(dac_core *core,
 }
 
 /***************************************************************************//**
- * @brief dds_set_frequency
+ * @brief dac_dds_clk - the DDS clock in Hz, as measured by the core.
  *******************************************************************************/
 
-// freq is in Hz (i.e. set to 1*1000*1000 for 1 MHz)
-
-int32_t dds_set_frequency(dac_core *core, uint32_t chan, uint32_t freq)
+static uint64_t dac_dds_clk(dac_core *core)
 {
 	uint32_t val;
-	uint64_t val64;
-	uint32_t reg;
 	uint64_t dac_clk;
 
 	dac_read(core, DAC_REG_CLK_FREQ, &val);
@@ -96,11 +92,73 @@ int32_t dds_set_frequency(dac_core *core, uint32_t chan, uint32_t freq)
 	dac_read(core, DAC_REG_CLK_RATIO, &val);
 	dac_clk *= val;
 
-	dac_write(core, DAC_REG_SYNC_CONTROL, 0);
-	dac_read(core, DAC_REG_DDS_INIT_INCR(chan), &reg);
+	return dac_clk;
+}
+
+/***************************************************************************//**
+ * @brief dac_dds_incr - increment field of the DDS_INIT_INCR register.
+ *******************************************************************************/
+
+static uint32_t dac_dds_incr(uint64_t dac_clk, uint32_t freq)
+{
+	uint64_t val64;
+
 	val64 = (uint64_t) freq * 0xFFFFULL;
 	val64 = val64 / dac_clk;
-	reg = (reg & ~DAC_DDS_INCR(~0)) | DAC_DDS_INCR(val64) | 1;
+
+	return DAC_DDS_INCR(val64) | 1;
+}
+
+/***************************************************************************//**
+ * @brief dac_dds_init - phase field of the DDS_INIT_INCR register.
+ *******************************************************************************/
+
+static uint32_t dac_dds_init(uint32_t phase)
+{
+	uint64_t val64;
+
+	val64 = (uint64_t) phase * 0x10000ULL + (360000 / 2);
+	val64 = val64 / 360000;
+
+	return DAC_DDS_INIT(val64);
+}
+
+/***************************************************************************//**
+ * @brief dac_dds_scale - DDS_SCALE register value.
+ *******************************************************************************/
+
+static uint32_t dac_dds_scale(int32_t scale_micro_units)
+{
+	uint32_t scale_reg;
+
+	scale_reg = scale_micro_units;
+	if (scale_micro_units < 0)
+		scale_reg = scale_micro_units * -1;
+	if (scale_reg >= 1999000)
+		scale_reg = 1999000;
+	scale_reg = (uint32_t)(((uint64_t)scale_reg * 0x4000) / 1000000);
+	if (scale_micro_units < 0)
+		scale_reg = scale_reg | 0x8000;
+
+	return DAC_DDS_SCALE(scale_reg);
+}
+
+/***************************************************************************//**
+ * @brief dds_set_frequency
+ *******************************************************************************/
+
+// freq is in Hz (i.e. set to 1*1000*1000 for 1 MHz)
+
+int32_t dds_set_frequency(dac_core *core, uint32_t chan, uint32_t freq)
+{
+	uint32_t reg;
+	uint64_t dac_clk;
+
+	dac_clk = dac_dds_clk(core);
+
+	dac_write(core, DAC_REG_SYNC_CONTROL, 0);
+	dac_read(core, DAC_REG_DDS_INIT_INCR(chan), &reg);
+	reg = (reg & ~DAC_DDS_INCR(~0)) | dac_dds_incr(dac_clk, freq);
 	dac_write(core, DAC_REG_DDS_INIT_INCR(chan), reg);
 	dac_write(core, DAC_REG_SYNC_CONTROL, DAC_SYNC);
 
@@ -115,14 +173,11 @@ int32_t dds_set_frequency(dac_core *core, uint32_t chan, uint32_t freq)
 
 int32_t dds_set_phase(dac_core *core, uint32_t chan, uint32_t phase)
 {
-	uint64_t val64;
 	uint32_t reg;
 
 	dac_write(core, DAC_REG_SYNC_CONTROL, 0);
 	dac_read(core, DAC_REG_DDS_INIT_INCR(chan), &reg);
-	val64 = (uint64_t) phase * 0x10000ULL + (360000 / 2);
-	val64 = val64 / 360000;
-	reg = (reg & ~DAC_DDS_INIT(~0)) | DAC_DDS_INIT(val64);
+	reg = (reg & ~DAC_DDS_INIT(~0)) | dac_dds_init(phase);
 	dac_write(core, DAC_REG_DDS_INIT_INCR(chan), reg);
 	dac_write(core, DAC_REG_SYNC_CONTROL, DAC_SYNC);
 
@@ -141,7 +196,6 @@ int32_t dds_set_phase(dac_core *core, uint32_t chan, uint32_t phase)
 int32_t dds_set_scale(dac_core *core, uint32_t chan, int32_t scale_micro_units)
 {
 	uint32_t pcore_version;
-	uint32_t scale_reg;
 
 	dac_read(core, DAC_REG_VERSION, &pcore_version);
 
@@ -154,17 +208,8 @@ int32_t dds_set_scale(dac_core *core, uint32_t chan, int32_t scale_micro_units)
 		return(-1);
 	}
 
-	scale_reg = scale_micro_units;
-	if (scale_micro_units < 0)
-		scale_reg = scale_micro_units * -1;
-	if (scale_reg >= 1999000)
-		scale_reg = 1999000;
-	scale_reg = (uint32_t)(((uint64_t)scale_reg * 0x4000) / 1000000);
-	if (scale_micro_units < 0)
-		scale_reg = scale_reg | 0x8000;
-
 	dac_write(core, DAC_REG_SYNC_CONTROL, 0);
-	dac_write(core, DAC_REG_DDS_SCALE(chan), DAC_DDS_SCALE(scale_reg));
+	dac_write(core, DAC_REG_DDS_SCALE(chan), dac_dds_scale(scale_micro_units));
 	dac_write(core, DAC_REG_SYNC_CONTROL, DAC_SYNC);
 	return(0);
 }
@@ -203,6 +248,128 @@ int32_t dac_data_src_sel(dac_core *core, int32_t chan, dac_data_src src)
 	return(0);
 }
 
+/***************************************************************************//**
+ * @brief dac_dds_plan_init - start a tone plan from the channel configuration
+ *        of the core. The DDS clock and the core version are read here once,
+ *        so the plan can be edited with dac_dds_plan_set_tone() without any
+ *        access to the core. Fails if a channel that plays the DDS has no
+ *        valid tone.
+ *******************************************************************************/
+
+int32_t dac_dds_plan_init(dac_core *core, dac_dds_plan *plan)
+{
+	dac_dds_plan_channel *entry;
+	dac_channel *chan;
+	uint32_t i;
+	int32_t ret;
+
+	if (core->no_of_channels > DAC_DDS_PLAN_MAX_CHANNELS) {
+		ad_printf("%s ERROR: Too many channels (%d)!\n", __func__,
+				core->no_of_channels);
+		return -1;
+	}
+
+	plan->dac_clk = dac_dds_clk(core);
+	dac_read(core, DAC_REG_VERSION, &plan->pcore_version);
+	plan->no_of_channels = core->no_of_channels;
+
+	for (i = 0; i < core->no_of_channels; i++) {
+		chan = &core->channels[i];
+		entry = &plan->channel[i];
+		entry->pat_data = chan->pat_data;
+		entry->sel = chan->sel;
+		entry->init_incr[0] = 0;
+		entry->init_incr[1] = 0;
+		entry->scale[0] = 0;
+		entry->scale[1] = 0;
+		ret = dac_dds_plan_set_tone(plan, i, 0, chan->dds_frequency_0,
+				chan->dds_phase_0, chan->dds_scale_0);
+		if (chan->dds_dual_tone == 0)
+			ret |= dac_dds_plan_set_tone(plan, i, 1,
+					chan->dds_frequency_0,
+					chan->dds_phase_0, chan->dds_scale_0);
+		else
+			ret |= dac_dds_plan_set_tone(plan, i, 1,
+					chan->dds_frequency_1,
+					chan->dds_phase_1, chan->dds_scale_1);
+		// the tones only matter to the channels playing the DDS
+		if (ret && (chan->sel == DAC_SRC_DDS)) {
+			ad_printf("%s ERROR: No DDS clock for channel %d!\n",
+					__func__, i);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief dac_dds_plan_set_tone - compute the register words of one tone.
+ *        Same units as dds_set_frequency/phase/scale().
+ *******************************************************************************/
+
+int32_t dac_dds_plan_set_tone(dac_dds_plan *plan, uint32_t chan, uint32_t tone,
+		uint32_t freq, uint32_t phase, int32_t scale_micro_units)
+{
+	dac_dds_plan_channel *entry;
+
+	if ((chan >= plan->no_of_channels) || (tone > 1) || !plan->dac_clk)
+		return -1;
+
+	entry = &plan->channel[chan];
+	entry->init_incr[tone] = dac_dds_init(phase) |
+			dac_dds_incr(plan->dac_clk, freq);
+	entry->scale[tone] = dac_dds_scale(scale_micro_units);
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief dac_dds_plan_commit - write the whole plan and apply it with a single
+ *        sync, so that all the channels switch to their new tones together.
+ *******************************************************************************/
+
+int32_t dac_dds_plan_commit(dac_core *core, dac_dds_plan *plan)
+{
+	dac_dds_plan_channel *entry;
+	uint32_t reg;
+	uint32_t i, t;
+
+	dac_write(core, DAC_REG_SYNC_CONTROL, 0);
+
+	for (i = 0; i < plan->no_of_channels; i++) {
+		entry = &plan->channel[i];
+		if (entry->sel == DAC_SRC_DDS) {
+			// only ise projects support binary shift scaling
+			if (DAC_PCORE_VERSION_MAJOR(plan->pcore_version) < 6)
+				ad_printf("%s ERROR: Sorry, binary scale is NOT supported!\n", __func__);
+			for (t = 0; t < 2; t++) {
+				dac_write(core, DAC_REG_DDS_INIT_INCR((i*2)+t),
+						entry->init_incr[t]);
+				if (DAC_PCORE_VERSION_MAJOR(plan->pcore_version) >= 6)
+					dac_write(core, DAC_REG_DDS_SCALE((i*2)+t),
+							entry->scale[t]);
+			}
+		}
+		dac_write(core, DAC_REG_DATA_PATTERN(i), entry->pat_data);
+		if (DAC_PCORE_VERSION_MAJOR(plan->pcore_version) >= 7)
+			dac_write(core, DAC_REG_DATA_SELECT(i), entry->sel);
+	}
+
+	// single core control for all channels, the last channel wins
+	if ((DAC_PCORE_VERSION_MAJOR(plan->pcore_version) < 7) &&
+	    plan->no_of_channels) {
+		dac_read(core, DAC_REG_DATA_CONTROL, &reg);
+		reg = (reg & ~DAC_DATA_SEL(~0)) |
+		      DAC_DATA_SEL(plan->channel[plan->no_of_channels - 1].sel);
+		dac_write(core, DAC_REG_DATA_CONTROL, reg);
+	}
+
+	dac_write(core, DAC_REG_SYNC_CONTROL, DAC_SYNC);
+
+	return 0;
+}
+
 /***************************************************************************//**
  * @brief dac_setup
  *******************************************************************************/
@@ -238,32 +405,10 @@ int32_t dac_setup(dac_core *core)
 
 int32_t dac_data_setup(dac_core *core)
 {
-	dac_channel *chan;
-	uint32_t i;
+	dac_dds_plan plan;
 
-	for (i = 0; i < core->no_of_channels; i++) {
-		chan = &core->channels[i];
-		if (chan->sel == DAC_SRC_DDS)
-		{
-			dds_set_frequency(core, ((i*2)+0), chan->dds_frequency_0);
-			dds_set_phase(core, ((i*2)+0), chan->dds_phase_0);
-			dds_set_scale(core, ((i*2)+0), chan->dds_scale_0);
-			if (chan->dds_dual_tone == 0)
-			{
-				dds_set_frequency(core, ((i*2)+1), chan->dds_frequency_0);
-				dds_set_phase(core, ((i*2)+1), chan->dds_phase_0);
-				dds_set_scale(core, ((i*2)+1), chan->dds_scale_0);
-			}
-			else
-			{
-				dds_set_frequency(core, ((i*2)+1), chan->dds_frequency_1);
-				dds_set_phase(core, ((i*2)+1), chan->dds_phase_1);
-				dds_set_scale(core, ((i*2)+1), chan->dds_scale_1);
-			}
-		}
-		dac_write(core, DAC_REG_DATA_PATTERN(i), chan->pat_data);
-		dac_data_src_sel(core, i, chan->sel);
-	}
+	if (dac_dds_plan_init(core, &plan))
+		return -1;
 
-	return(0);
+	return dac_dds_plan_commit(core, &plan);
 }
@@ -110,6 +110,8 @@
 #define DAC_DATA_SELECT(x)			(((x) & 0xF) << 0)
 #define DAC_TO_DATA_SELECT(x)			(((x) >> 0) & 0xF)
 
+#define DAC_DDS_PLAN_MAX_CHANNELS		8
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -145,6 +147,21 @@ typedef struct {
 	dac_channel *channels;
 } dac_core;
 
+typedef struct {
+	uint32_t init_incr[2];          // DAC_REG_DDS_INIT_INCR words of the two tones
+	uint32_t scale[2];              // DAC_REG_DDS_SCALE words of the two tones
+	uint32_t pat_data;
+	dac_data_src sel;
+} dac_dds_plan_channel;
+
+// register image of the DDS of every channel, see dac_dds_plan_commit()
+typedef struct {
+	uint64_t dac_clk;
+	uint32_t pcore_version;
+	uint8_t	 no_of_channels;
+	dac_dds_plan_channel channel[DAC_DDS_PLAN_MAX_CHANNELS];
+} dac_dds_plan;
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -160,4 +177,9 @@ int32_t dds_set_phase(dac_core *core, uint32_t chan, uint32_t phase);
 int32_t dds_set_scale(dac_core *core, uint32_t chan, int32_t scale_micro_units);
 int32_t dac_data_src_sel(dac_core *core, int32_t chan, dac_data_src src);
 
+int32_t dac_dds_plan_init(dac_core *core, dac_dds_plan *plan);
+int32_t dac_dds_plan_set_tone(dac_dds_plan *plan, uint32_t chan, uint32_t tone,
+		uint32_t freq, uint32_t phase, int32_t scale_micro_units);
+int32_t dac_dds_plan_commit(dac_core *core, dac_dds_plan *plan);
+
 #endif
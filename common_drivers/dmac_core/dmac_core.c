@@ -69,72 +69,373 @@ int32_t dmac_write(dmac_core core,
 }
 
 /***************************************************************************//**
- * @brief dmac_start_transaction
+ * @brief dmac_cache_sync - make the buffer of a transfer coherent for the
+ *        direction of the core (flush before TX, invalidate after RX).
  *******************************************************************************/
 
-int32_t dmac_start_transaction(dmac_core dma)
+static void dmac_cache_sync(dmac_core *dma, dmac_xfer *xfer)
 {
+#ifdef XILINX
+	if(dma->type == DMAC_RX)
+		Xil_DCacheInvalidateRange(xfer->start_address, (2 * xfer->no_of_samples));
+	else
+		Xil_DCacheFlushRange(xfer->start_address, (2 * xfer->no_of_samples));
+#endif
+}
 
-	uint32_t reg_val = 0;
-	uint32_t timer = 0;
+/***************************************************************************//**
+ * @brief dmac_irq_mask - while the interrupts are masked the handler can not
+ *        run, so it is used to guard the transfer queues.
+ *******************************************************************************/
 
-	dmac_write(dma, DMAC_REG_CTRL, 0x0);
-	dmac_write(dma, DMAC_REG_CTRL, DMAC_CTRL_ENABLE);
-
-	dmac_write(dma, DMAC_REG_IRQ_MASK, 0x0);
-
-        if(dma.transfer) {
-	        dmac_read(dma, DMAC_REG_TRANSFER_ID, &(dma.transfer->id));
-        } else {
-                ad_printf("%s : Undefined DMA transfer.\n", __func__);
-                return -1;
-        }
-	dmac_read(dma, DMAC_REG_IRQ_PENDING, &reg_val);
-
-	dmac_write(dma, DMAC_REG_IRQ_PENDING, reg_val);
-
-	if(dma.type == DMAC_RX) {
-		dmac_write(dma, DMAC_REG_DEST_ADDRESS, dma.transfer->start_address);
-		dmac_write(dma, DMAC_REG_DEST_STRIDE, 0x0);
-	} else {    /* DMAC_TX */
-		dmac_write(dma, DMAC_REG_SRC_ADDRESS, dma.transfer->start_address);
-		dmac_write(dma, DMAC_REG_SRC_STRIDE, 0x0);
-		dmac_read(dma, DMAC_REG_FLAGS, &reg_val);
-		reg_val = (reg_val & dma.flags);
-		dmac_write(dma, DMAC_REG_FLAGS, reg_val);
+static void dmac_irq_mask(dmac_core *dma, uint8_t mask)
+{
+	dmac_write(*dma, DMAC_REG_IRQ_MASK,
+		   mask ? (DMAC_IRQ_SOT | DMAC_IRQ_EOT) : 0x0);
+}
+
+/***************************************************************************//**
+ * @brief dmac_irq_lock - nestable dmac_irq_mask(), the interrupts are only
+ *        unmasked again by the outermost dmac_irq_unlock().
+ *******************************************************************************/
+
+static void dmac_irq_lock(dmac_core *dma)
+{
+	if(!dma->irq_lock++)
+		dmac_irq_mask(dma, 1);
+}
+
+/***************************************************************************//**
+ * @brief dmac_irq_unlock
+ *******************************************************************************/
+
+static void dmac_irq_unlock(dmac_core *dma)
+{
+	if(!--dma->irq_lock)
+		dmac_irq_mask(dma, 0);
+}
+
+/***************************************************************************//**
+ * @brief dmac_hw_submit - move pending transfers into the hardware queue for
+ *        as long as the core accepts new descriptors.
+ *******************************************************************************/
+
+static void dmac_hw_submit(dmac_core *dma)
+{
+	dmac_xfer *xfer;
+	uint32_t reg_val;
+
+	while(dma->sw_count && (dma->hw_count < DMAC_HW_QUEUE_DEPTH)) {
+		dmac_read(*dma, DMAC_REG_START_TRANSFER, &reg_val);
+		if(reg_val)
+			break;
+
+		xfer = dma->sw_queue[dma->sw_head];
+		dma->sw_head = (dma->sw_head + 1) % DMAC_SW_QUEUE_DEPTH;
+		dma->sw_count--;
+
+		dmac_read(*dma, DMAC_REG_TRANSFER_ID, &xfer->id);
+		if(dma->type == DMAC_RX) {
+			dmac_write(*dma, DMAC_REG_DEST_ADDRESS, xfer->start_address);
+			dmac_write(*dma, DMAC_REG_DEST_STRIDE, 0x0);
+		} else {    /* DMAC_TX */
+			dmac_write(*dma, DMAC_REG_SRC_ADDRESS, xfer->start_address);
+			dmac_write(*dma, DMAC_REG_SRC_STRIDE, 0x0);
+			dmac_write(*dma, DMAC_REG_FLAGS, dma->flags);
+		}
+		dmac_write(*dma, DMAC_REG_X_LENGTH, (2 * xfer->no_of_samples) - 1);
+		dmac_write(*dma, DMAC_REG_Y_LENGTH, 0x0);
+		dmac_write(*dma, DMAC_REG_START_TRANSFER, 0x1);
+
+		xfer->status = DMAC_XFER_QUEUED;
+		dma->hw_queue[(dma->hw_head + dma->hw_count) % DMAC_HW_QUEUE_DEPTH] = xfer;
+		dma->hw_count++;
+
+		if(dma->submit_cb)
+			dma->submit_cb(dma->cb_data, xfer);
 	}
-	dmac_write(dma, DMAC_REG_X_LENGTH, (2 * dma.transfer->no_of_samples) - 1);
-	dmac_write(dma, DMAC_REG_Y_LENGTH, 0x0);
+}
+
+/***************************************************************************//**
+ * @brief dmac_hw_complete - retire the finished transfers into done_xfer and
+ *        return their number. The core completes the transfers in order, so
+ *        stop at the first one still running.
+ *******************************************************************************/
 
-	dmac_write(dma, DMAC_REG_START_TRANSFER, 0x1);
-	/* Wait until the new transfer is queued. */
-	do {
-		dmac_read(dma, DMAC_REG_START_TRANSFER, &reg_val);
+static uint8_t dmac_hw_complete(dmac_core *dma,
+		dmac_xfer **done_xfer)
+{
+	dmac_xfer *xfer;
+	uint32_t done;
+	uint8_t no_of_done = 0;
+
+	if(!dma->hw_count)
+		return 0;
+
+	dmac_read(*dma, DMAC_REG_TRANSFER_DONE, &done);
+	while(dma->hw_count) {
+		xfer = dma->hw_queue[dma->hw_head];
+		if(!(done & (1 << xfer->id)))
+			break;
+
+		dma->hw_head = (dma->hw_head + 1) % DMAC_HW_QUEUE_DEPTH;
+		dma->hw_count--;
+
+		if(dma->type == DMAC_RX)
+			dmac_cache_sync(dma, xfer);
+		xfer->status = DMAC_XFER_DONE;
+		done_xfer[no_of_done++] = xfer;
+	}
+
+	return no_of_done;
+}
+
+/***************************************************************************//**
+ * @brief dmac_init - reset the core and the transfer queues and enable the
+ *        SOT/EOT interrupts. dmac_irq_handler() should be connected to the
+ *        interrupt line irq_id of the core; without an interrupt controller
+ *        it can be called from a polling loop instead.
+ *******************************************************************************/
+
+int32_t dmac_init(dmac_core *dma)
+{
+	uint32_t reg_val;
+
+	dmac_write(*dma, DMAC_REG_CTRL, 0x0);
+	dmac_write(*dma, DMAC_REG_CTRL, DMAC_CTRL_ENABLE);
+
+	dma->sw_head = 0;
+	dma->sw_count = 0;
+	dma->hw_head = 0;
+	dma->hw_count = 0;
+	dma->irq_lock = 0;
+	dma->starved = 0;
+
+	dmac_read(*dma, DMAC_REG_IRQ_PENDING, &reg_val);
+	dmac_write(*dma, DMAC_REG_IRQ_PENDING, reg_val);
+	dmac_irq_mask(dma, 0);
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief dmac_stop - disable the core and abort all the queued transfers.
+ *******************************************************************************/
+
+int32_t dmac_stop(dmac_core *dma)
+{
+	dmac_irq_mask(dma, 1);
+	dmac_write(*dma, DMAC_REG_CTRL, 0x0);
+
+	while(dma->sw_count) {
+		dma->sw_queue[dma->sw_head]->status = DMAC_XFER_ABORTED;
+		dma->sw_head = (dma->sw_head + 1) % DMAC_SW_QUEUE_DEPTH;
+		dma->sw_count--;
 	}
-	while(reg_val == 1);
+	while(dma->hw_count) {
+		dma->hw_queue[dma->hw_head]->status = DMAC_XFER_ABORTED;
+		dma->hw_head = (dma->hw_head + 1) % DMAC_HW_QUEUE_DEPTH;
+		dma->hw_count--;
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief dmac_submit - queue a transfer and return without waiting for it.
+ *        complete_cb is called (from dmac_irq_handler()) once it is done.
+ *******************************************************************************/
 
-	/* Wait until the current transfer is completed. */
-	do {
-		dmac_read(dma, DMAC_REG_IRQ_PENDING, &reg_val);
+int32_t dmac_submit(dmac_core *dma,
+		dmac_xfer *xfer)
+{
+	int32_t ret = 0;
+
+	if(!xfer || !xfer->no_of_samples) {
+		ad_printf("%s : Undefined DMA transfer.\n", __func__);
+		return -1;
 	}
-	while(reg_val != (DMAC_IRQ_SOT | DMAC_IRQ_EOT));
-	dmac_write(dma, DMAC_REG_IRQ_PENDING, reg_val);
-
-	/* Wait until the transfer with the ID transfer_id is completed. */
-	do {
-		dmac_read(dma, DMAC_REG_TRANSFER_DONE, &reg_val);
-		timer++;
-		if(timer == TIMEOUT) {
+
+	if(dma->type == DMAC_TX)
+		dmac_cache_sync(dma, xfer);
+
+	dmac_irq_lock(dma);
+	if(dma->sw_count < DMAC_SW_QUEUE_DEPTH) {
+		xfer->status = DMAC_XFER_PENDING;
+		dma->sw_queue[(dma->sw_head + dma->sw_count) % DMAC_SW_QUEUE_DEPTH] = xfer;
+		dma->sw_count++;
+		dmac_hw_submit(dma);
+	} else {
+		ret = -1;
+	}
+	dmac_irq_unlock(dma);
+
+	return ret;
+}
+
+/***************************************************************************//**
+ * @brief dmac_irq_handler - acknowledge SOT/EOT, complete the finished
+ *        transfers and refill the hardware queue. complete_cb only runs once
+ *        all the finished transfers are retired, so a transfer it submits
+ *        again can not be taken for done by its recycled transfer ID.
+ *******************************************************************************/
+
+void dmac_irq_handler(void *dev)
+{
+	dmac_core *dma = dev;
+	dmac_xfer *done_xfer[DMAC_HW_QUEUE_DEPTH];
+	uint8_t no_of_done;
+	uint8_t i;
+	uint32_t reg_val;
+
+	dmac_irq_lock(dma);
+
+	dmac_read(*dma, DMAC_REG_IRQ_PENDING, &reg_val);
+	dmac_write(*dma, DMAC_REG_IRQ_PENDING, reg_val);
+
+	no_of_done = dmac_hw_complete(dma, done_xfer);
+	dma->starved = (no_of_done && !dma->hw_count);
+	dmac_hw_submit(dma);
+
+	for(i = 0; i < no_of_done; i++)
+		if(dma->complete_cb)
+			dma->complete_cb(dma->cb_data, done_xfer[i]);
+
+	dmac_irq_unlock(dma);
+}
+
+/***************************************************************************//**
+ * @brief dmac_wait_transfer - block until a submitted transfer is done.
+ *******************************************************************************/
+
+int32_t dmac_wait_transfer(dmac_core *dma,
+		dmac_xfer *xfer,
+		uint32_t timeout_ms)
+{
+	uint32_t timer = 0;
+
+	while((xfer->status == DMAC_XFER_PENDING) ||
+	      (xfer->status == DMAC_XFER_QUEUED)) {
+		dmac_irq_handler(dma);
+		if(xfer->status == DMAC_XFER_DONE)
+			break;
+		if(timer++ == (timeout_ms * (1000 / DMAC_POLL_US)))
 			return -1;
-		}
-		mdelay(1);
+		udelay(DMAC_POLL_US);
 	}
-	while((reg_val & (1 << dma.transfer->id)) != (1 << dma.transfer->id));
 
-#ifdef XILINX
-	Xil_DCacheInvalidateRange(dma.transfer->start_address, (2 * dma.transfer->no_of_samples));
-#endif
+	return (xfer->status == DMAC_XFER_DONE) ? 0 : -1;
+}
+
+/***************************************************************************//**
+ * @brief dmac_start_transaction
+ *******************************************************************************/
+
+int32_t dmac_start_transaction(dmac_core dma)
+{
+	if(!dma.transfer) {
+		ad_printf("%s : Undefined DMA transfer.\n", __func__);
+		return -1;
+	}
+
+	dma.submit_cb = NULL;
+	dma.complete_cb = NULL;
+	dmac_init(&dma);
+	if(dmac_submit(&dma, dma.transfer))
+		return -1;
+
+	/* A cyclic transfer never completes. */
+	if((dma.type == DMAC_TX) && (dma.flags & DMAC_FLAGS_CYCLIC))
+		return 0;
+
+	return dmac_wait_transfer(&dma, dma.transfer, TIMEOUT);
+}
+
+/***************************************************************************//**
+ * @brief dmac_stream_complete - a block of the ring was filled. If the handler
+ *        found the hardware queue drained, the core stopped writing before the
+ *        interrupt was serviced and samples were lost: one overrun.
+ *******************************************************************************/
+
+static void dmac_stream_complete(void *cb_data, dmac_xfer *xfer)
+{
+	dmac_stream *stream = cb_data;
+	uint8_t block = xfer - stream->block;
+
+	stream->blocks_done++;
+	if(stream->dma->starved) {
+		stream->overruns++;
+		stream->dma->starved = 0;
+	}
+
+	if(stream->consumer)
+		stream->consumer(stream->cb_data, block, xfer);
+	else
+		dmac_stream_release(stream, block);
+}
+
+/***************************************************************************//**
+ * @brief dmac_stream_start - start a continuous capture into a ring of
+ *        no_of_blocks contiguous buffers at start_address. Every filled block
+ *        is handed to the consumer and is owned by it until it is given back
+ *        with dmac_stream_release().
+ *******************************************************************************/
+
+int32_t dmac_stream_start(dmac_stream *stream)
+{
+	dmac_core *dma = stream->dma;
+	uint8_t i;
+
+	if((stream->no_of_blocks < 2) ||
+	   (stream->no_of_blocks > DMAC_STREAM_MAX_BLOCKS) ||
+	   !stream->no_of_samples) {
+		ad_printf("%s : Invalid stream configuration.\n", __func__);
+		return -1;
+	}
+
+	stream->blocks_done = 0;
+	stream->overruns = 0;
+
+	dma->flags = 0;
+	dma->submit_cb = NULL;
+	dma->complete_cb = dmac_stream_complete;
+	dma->cb_data = stream;
+	dmac_init(dma);
+
+	for(i = 0; i < stream->no_of_blocks; i++) {
+		stream->block[i].start_address = stream->start_address +
+				(i * 2 * stream->no_of_samples);
+		stream->block[i].no_of_samples = stream->no_of_samples;
+		stream->block[i].status = DMAC_XFER_IDLE;
+		if(dmac_submit(dma, &stream->block[i]))
+			return -1;
+	}
 
 	return 0;
 }
 
+/***************************************************************************//**
+ * @brief dmac_stream_release - give a consumed block back to the ring.
+ *******************************************************************************/
+
+int32_t dmac_stream_release(dmac_stream *stream,
+		uint8_t block)
+{
+	if((block >= stream->no_of_blocks) ||
+	   (stream->block[block].status != DMAC_XFER_DONE))
+		return -1;
+
+	return dmac_submit(stream->dma, &stream->block[block]);
+}
+
+/***************************************************************************//**
+ * @brief dmac_stream_stop
+ *******************************************************************************/
+
+int32_t dmac_stream_stop(dmac_stream *stream)
+{
+	dmac_stop(stream->dma);
+	stream->dma->complete_cb = NULL;
+
+	return 0;
+}
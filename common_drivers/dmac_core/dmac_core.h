@@ -84,20 +84,69 @@
 
 #define TIMEOUT				10000
 
-typedef struct {
+/* Transfers the core can hold in its internal queue (DMA_QUEUE_DEPTH) */
+#define DMAC_HW_QUEUE_DEPTH		4
+/* Transfers the driver can hold on top of the hardware queue */
+#define DMAC_SW_QUEUE_DEPTH		8
+
+#define DMAC_POLL_US			10
+
+enum dmac_xfer_status {
+	DMAC_XFER_IDLE,
+	DMAC_XFER_PENDING,
+	DMAC_XFER_QUEUED,
+	DMAC_XFER_DONE,
+	DMAC_XFER_ABORTED,
+};
+
+typedef struct dmac_xfer {
 	uint32_t	id;
 	uint32_t	start_address;
 	uint32_t	no_of_samples;
+	volatile uint8_t status;
 } dmac_xfer;
 
+typedef void (*dmac_callback)(void *cb_data, dmac_xfer *xfer);
+
 typedef struct {
 	uint32_t	base_address;
 	uint8_t		type;
 	uint8_t		flags;
 	uint32_t	irq_id;
 	dmac_xfer       *transfer;
+	/* transfer queue, see dmac_init() */
+	dmac_xfer	*sw_queue[DMAC_SW_QUEUE_DEPTH];
+	uint8_t		sw_head;
+	uint8_t		sw_count;
+	dmac_xfer	*hw_queue[DMAC_HW_QUEUE_DEPTH];
+	uint8_t		hw_head;
+	uint8_t		hw_count;
+	uint8_t		irq_lock;
+	/* the handler retired the last queued transfer, the core sat idle */
+	volatile uint8_t starved;
+	dmac_callback	submit_cb;
+	dmac_callback	complete_cb;
+	void		*cb_data;
 } dmac_core;
 
+#define DMAC_STREAM_MAX_BLOCKS		DMAC_SW_QUEUE_DEPTH
+
+typedef void (*dmac_stream_callback)(void *cb_data, uint8_t block,
+				     dmac_xfer *xfer);
+
+typedef struct {
+	dmac_core		*dma;
+	uint32_t		start_address;
+	uint32_t		no_of_samples;	/* per block */
+	uint8_t			no_of_blocks;
+	dmac_stream_callback	consumer;
+	void			*cb_data;
+	/* ring state, see dmac_stream_start() */
+	dmac_xfer		block[DMAC_STREAM_MAX_BLOCKS];
+	volatile uint32_t	blocks_done;
+	volatile uint32_t	overruns;
+} dmac_stream;
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -111,4 +160,18 @@ int32_t dmac_write(dmac_core core,
 
 int32_t dmac_start_transaction(dmac_core core);
 
+int32_t dmac_init(dmac_core *dma);
+int32_t dmac_stop(dmac_core *dma);
+int32_t dmac_submit(dmac_core *dma,
+		dmac_xfer *xfer);
+void dmac_irq_handler(void *dev);
+int32_t dmac_wait_transfer(dmac_core *dma,
+		dmac_xfer *xfer,
+		uint32_t timeout_ms);
+
+int32_t dmac_stream_start(dmac_stream *stream);
+int32_t dmac_stream_release(dmac_stream *stream,
+		uint8_t block);
+int32_t dmac_stream_stop(dmac_stream *stream);
+
 #endif
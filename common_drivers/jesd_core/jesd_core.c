@@ -146,6 +146,353 @@ int32_t jesd_status(jesd_core core)
 	return(ret);
 }
 
+/***************************************************************************//**
+* @brief jesd_link_init
+*******************************************************************************/
+int32_t jesd_link_init(jesd_link *link, const char *name,
+		xcvr_core *xcvr, jesd_core *jesd)
+{
+	link->name = name;
+	link->pll_owner = NULL;
+	link->xcvr = xcvr;
+	link->jesd = jesd;
+	link->converter = NULL;
+	link->converter_setup = NULL;
+	link->converter_status = NULL;
+	link->state = JESD_LINK_CONVERTER;
+	link->elapsed_us = 0;
+	link->total_us = 0;
+	link->retries = JESD_LINK_RETRIES;
+	link->link_status = 0;
+
+	return 0;
+}
+
+/***************************************************************************//**
+* @brief jesd_link_retry
+*******************************************************************************/
+static void jesd_link_retry(jesd_link *link, const char *reason)
+{
+	jesd_write(*link->jesd, JESD204_REG_LINK_DISABLE, 1);
+
+	if (link->retries == 0) {
+		ad_printf("%s: %s (%x), giving up\n", link->name, reason,
+			link->link_status);
+		link->state = JESD_LINK_FAILED;
+		return;
+	}
+
+	ad_printf("%s: %s (%x), retrying\n", link->name, reason,
+		link->link_status);
+	link->retries--;
+	link->state = JESD_LINK_XCVR;
+}
+
+/***************************************************************************//**
+* @brief jesd_link_step
+*
+* Advance the link state machine by at most one state. Status bits are read
+* once per call; the caller is responsible for pacing the calls and for
+* accounting link->elapsed_us.
+*******************************************************************************/
+int32_t jesd_link_step(jesd_link *link)
+{
+	jesd_core *jesd = link->jesd;
+
+	switch (link->state) {
+	case JESD_LINK_CONVERTER:
+		if (link->converter_setup &&
+				link->converter_setup(link->converter)) {
+			ad_printf("%s: converter setup failed\n", link->name);
+			link->state = JESD_LINK_FAILED;
+			return -1;
+		}
+		link->state = JESD_LINK_XCVR;
+		break;
+	case JESD_LINK_XCVR:
+		// hold until the shared PLL is programmed and locked
+		if (link->pll_owner) {
+			if (link->pll_owner->state == JESD_LINK_FAILED) {
+				ad_printf("%s: PLL owner %s failed\n", link->name,
+					link->pll_owner->name);
+				link->state = JESD_LINK_FAILED;
+				return -1;
+			}
+			if (link->pll_owner->state < JESD_LINK_SYNC_WAIT)
+				break;
+		}
+		jesd_write(*jesd, JESD204_REG_LINK_DISABLE, 1);
+		if (xcvr_config(link->xcvr)) {
+			link->state = JESD_LINK_FAILED;
+			return -1;
+		}
+		xcvr_write(link->xcvr, XCVR_REG_RESETN, XCVR_RESETN);
+		link->elapsed_us = 0;
+		link->state = JESD_LINK_XCVR_WAIT;
+		break;
+	case JESD_LINK_XCVR_WAIT:
+		if (xcvr_ready(link->xcvr)) {
+			jesd_write(*jesd, JESD204_REG_LINK_CONF0,
+				((jesd->octets_per_frame - 1) << 16) |
+				((jesd->frames_per_multiframe *
+				  jesd->octets_per_frame) - 1));
+			jesd_write(*jesd, JESD204_REG_LINK_DISABLE, 0);
+			if ((jesd->sysref_type == INTERN) &&
+					(jesd->subclass_mode >= 1))
+				ad_gpio_set(jesd->sysref_gpio_pin, 1);
+			link->elapsed_us = 0;
+			link->state = JESD_LINK_SYNC_WAIT;
+		} else if (link->elapsed_us >= JESD_LINK_XCVR_TIMEOUT_US) {
+			jesd_link_retry(link, "transceiver not ready");
+		}
+		break;
+	case JESD_LINK_SYNC_WAIT:
+		jesd_read(*jesd, JESD204_REG_LINK_STATUS, &link->link_status);
+		if ((link->link_status &
+				(JESD204_LINK_STATUS_SYNC | JESD204_LINK_STATUS_DATA)) ==
+				(JESD204_LINK_STATUS_SYNC | JESD204_LINK_STATUS_DATA)) {
+			if (link->converter_status &&
+					link->converter_status(link->converter)) {
+				jesd_link_retry(link, "converter status");
+				break;
+			}
+			ad_printf("%s: link up after %d us\n", link->name,
+				link->total_us);
+			link->state = JESD_LINK_DATA;
+		} else if (link->elapsed_us >= JESD_LINK_SYNC_TIMEOUT_US) {
+			jesd_link_retry(link, "out of sync");
+		}
+		break;
+	case JESD_LINK_DATA:
+	case JESD_LINK_FAILED:
+		break;
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+* @brief jesd_link_bringup
+*
+* Train all links together: every pending link is stepped once per poll
+* interval, so independent RX and TX links overlap their PLL lock and
+* CGS/ILAS time instead of waiting on each other. A link with a pll_owner is
+* held before its transceiver setup until the owner's transceiver is ready,
+* and fails if the owner fails.
+*******************************************************************************/
+int32_t jesd_link_bringup(jesd_link *links, uint8_t num_links)
+{
+	uint8_t pending;
+	uint8_t i;
+	int32_t ret = 0;
+
+	do {
+		pending = 0;
+		for (i = 0; i < num_links; i++) {
+			if (links[i].state >= JESD_LINK_DATA)
+				continue;
+			jesd_link_step(&links[i]);
+			if (links[i].state < JESD_LINK_DATA)
+				pending = 1;
+		}
+		if (!pending)
+			break;
+		udelay(JESD_LINK_POLL_US);
+		for (i = 0; i < num_links; i++) {
+			if (links[i].state >= JESD_LINK_DATA)
+				continue;
+			links[i].elapsed_us += JESD_LINK_POLL_US;
+			links[i].total_us += JESD_LINK_POLL_US;
+		}
+	} while (pending);
+
+	for (i = 0; i < num_links; i++)
+		if (links[i].state != JESD_LINK_DATA)
+			ret = -1;
+
+	return ret;
+}
+
+/***************************************************************************//**
+* @brief jesd_monitor_init
+*******************************************************************************/
+int32_t jesd_monitor_init(jesd_monitor *mon, jesd_link *link,
+		uint32_t interval_us)
+{
+	uint32_t num_lanes;
+	uint8_t i;
+	uint8_t j;
+
+	mon->link = link;
+	mon->num_lanes = 0;
+	mon->latency_valid = 0;
+	mon->interval_us = interval_us;
+	mon->elapsed_us = 0;
+	mon->samples = 0;
+	mon->link_status = 0;
+	mon->sysref_status = 0;
+	mon->link_drops = 0;
+	mon->sysref_errors = 0;
+	mon->relinks = 0;
+	mon->relink_failures = 0;
+
+	// lane status/latency registers only exist on the receive side
+	if (link->jesd->rx_tx_n) {
+		jesd_read(*link->jesd, JESD204_REG_SYNTH_NUM_LANES, &num_lanes);
+		if (num_lanes > JESD_MON_MAX_LANES)
+			num_lanes = JESD_MON_MAX_LANES;
+		mon->num_lanes = num_lanes;
+	}
+
+	for (i = 0; i < JESD_MON_MAX_LANES; i++) {
+		mon->lane[i].errors = 0;
+		mon->lane[i].drifts = 0;
+		mon->lane[i].latency = 0;
+		mon->lane[i].latency_ref = 0;
+		mon->lane[i].latency_min = 0xffffffff;
+		mon->lane[i].latency_max = 0;
+		for (j = 0; j < JESD_MON_LATENCY_BINS; j++)
+			mon->lane[i].histogram[j] = 0;
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+* @brief jesd_monitor_sample
+*
+* Take one snapshot of the link, SYSREF and lane registers and fold it into
+* the counters. Returns -1 if the link dropped out of DATA or a lane latency
+* drifted beyond JESD_MON_LATENCY_TOLERANCE octets, 0 otherwise.
+*******************************************************************************/
+int32_t jesd_monitor_sample(jesd_monitor *mon)
+{
+	jesd_core *jesd = mon->link->jesd;
+	jesd_lane_stats *lane;
+	uint32_t sysref_status;
+	uint32_t lane_status;
+	uint32_t latency;
+	uint32_t delta;
+	int32_t ret = 0;
+	uint8_t i;
+
+	mon->samples++;
+
+	jesd_read(*jesd, JESD204_REG_LINK_STATUS, &mon->link_status);
+	if ((mon->link_status &
+			(JESD204_LINK_STATUS_SYNC | JESD204_LINK_STATUS_DATA)) !=
+			(JESD204_LINK_STATUS_SYNC | JESD204_LINK_STATUS_DATA)) {
+		mon->link_drops++;
+		ret = -1;
+	}
+
+	// the status bits are sticky, clear them so each error is seen once
+	jesd_read(*jesd, JESD204_REG_SYSREF_STATUS, &sysref_status);
+	jesd_write(*jesd, JESD204_REG_SYSREF_STATUS, sysref_status);
+	if (sysref_status & JESD204_SYSREF_STATUS_ALIGN_ERR)
+		mon->sysref_errors++;
+	mon->sysref_status = sysref_status;
+
+	for (i = 0; i < mon->num_lanes; i++) {
+		lane = &mon->lane[i];
+
+		jesd_read(*jesd, JESD204_RX_REG_LANE_STATUS(i), &lane_status);
+		if ((JESD204_LANE_STATUS_CGS(lane_status) !=
+				JESD204_LANE_STATUS_CGS_DATA) ||
+				!(lane_status & JESD204_LANE_STATUS_IFS)) {
+			lane->errors++;
+			ret = -1;
+			continue;
+		}
+
+		jesd_read(*jesd, JESD204_RX_REG_LANE_LATENCY(i), &latency);
+		lane->latency = latency;
+		if (latency < lane->latency_min)
+			lane->latency_min = latency;
+		if (latency > lane->latency_max)
+			lane->latency_max = latency;
+		if (!mon->latency_valid)
+			lane->latency_ref = latency;
+
+		delta = (latency > lane->latency_ref) ?
+			(latency - lane->latency_ref) :
+			(lane->latency_ref - latency);
+		lane->histogram[(delta < JESD_MON_LATENCY_BINS) ?
+			delta : (JESD_MON_LATENCY_BINS - 1)]++;
+		if (delta > JESD_MON_LATENCY_TOLERANCE) {
+			lane->drifts++;
+			ret = -1;
+		}
+	}
+
+	// latch the reference latencies on the first clean sample
+	if ((ret == 0) && (mon->num_lanes > 0))
+		mon->latency_valid = 1;
+
+	return ret;
+}
+
+/***************************************************************************//**
+* @brief jesd_monitor_relink
+*
+* Retrain only the monitored link: the converter is left configured and
+* the other links keep running.
+*******************************************************************************/
+int32_t jesd_monitor_relink(jesd_monitor *mon)
+{
+	jesd_link *link = mon->link;
+
+	ad_printf("%s: link unhealthy (%x), relinking\n", link->name,
+		mon->link_status);
+
+	link->state = JESD_LINK_XCVR;
+	link->retries = JESD_LINK_RETRIES;
+	link->total_us = 0;
+	mon->relinks++;
+	mon->latency_valid = 0;
+	mon->elapsed_us = 0;
+
+	if (jesd_link_bringup(link, 1)) {
+		mon->relink_failures++;
+		return -1;
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+* @brief jesd_monitor_poll
+*
+* Scheduler hook, to be called from the application loop with the time
+* elapsed since the previous call. Each monitor is sampled once its
+* interval has expired and its link is relinked if the sample failed. A link
+* that could not be relinked is retried on every following interval.
+* Returns -1 if any relink failed.
+*******************************************************************************/
+int32_t jesd_monitor_poll(jesd_monitor *mon, uint8_t num_mons,
+		uint32_t elapsed_us)
+{
+	int32_t ret = 0;
+	uint8_t i;
+
+	for (i = 0; i < num_mons; i++) {
+		mon[i].elapsed_us += elapsed_us;
+		if (mon[i].elapsed_us < mon[i].interval_us)
+			continue;
+		mon[i].elapsed_us = 0;
+		if (mon[i].link->state == JESD_LINK_DATA) {
+			if (!jesd_monitor_sample(&mon[i]))
+				continue;
+		} else if (mon[i].link->state != JESD_LINK_FAILED) {
+			continue;
+		}
+		if (jesd_monitor_relink(&mon[i]))
+			ret = -1;
+	}
+
+	return ret;
+}
+
 /***************************************************************************//**
 * @brief axi_jesd204_rx_status_read
 *******************************************************************************/
@@ -40,6 +40,7 @@
 #define JESD_CORE_H_
 
 #include "platform_drivers.h"
+#include "xcvr_core.h"
 
 /******************************************************************************/
 /************************ JESD204 Core Definitions ****************************/
@@ -130,6 +131,31 @@
 
 #define JESD204_RX_MAGIC (('2' << 24) | ('0' << 16) | ('4' << 8) | ('R'))
 
+/* JESD204_REG_LINK_STATUS */
+#define JESD204_LINK_STATUS_SYNC			(1 << 4)
+#define JESD204_LINK_STATUS_DATA			(0x3 << 0)
+
+/* Link bring-up engine */
+#define JESD_LINK_POLL_US				100
+#define JESD_LINK_XCVR_TIMEOUT_US			100000
+#define JESD_LINK_SYNC_TIMEOUT_US			200000
+#define JESD_LINK_RETRIES				2
+
+/* JESD204_REG_SYSREF_STATUS */
+#define JESD204_SYSREF_STATUS_CAPTURED			(1 << 0)
+#define JESD204_SYSREF_STATUS_ALIGN_ERR			(1 << 1)
+
+/* JESD204_RX_REG_LANE_STATUS */
+#define JESD204_LANE_STATUS_CGS(x)			((x) & 0x3)
+#define JESD204_LANE_STATUS_CGS_DATA			2
+#define JESD204_LANE_STATUS_IFS				(1 << 4)
+#define JESD204_LANE_STATUS_ILAS			(1 << 5)
+
+/* Link-health monitor */
+#define JESD_MON_MAX_LANES				8
+#define JESD_MON_LATENCY_BINS				16
+#define JESD_MON_LATENCY_TOLERANCE			4
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -155,6 +181,56 @@ typedef struct {
   uint32_t		sysref_gpio_pin;
 } jesd_core;
 
+typedef enum {
+	JESD_LINK_CONVERTER,	// converter SPI setup
+	JESD_LINK_XCVR,		// program the lane PLLs, release reset
+	JESD_LINK_XCVR_WAIT,	// wait for the PLLs and lanes to come up
+	JESD_LINK_SYNC_WAIT,	// link enabled, wait for CGS/ILAS -> DATA
+	JESD_LINK_DATA,		// link is up
+	JESD_LINK_FAILED	// out of retries
+} jesd_link_state;
+
+typedef struct jesd_link {
+	const char		*name;
+	struct jesd_link	*pll_owner;	// link whose PLL this one shares
+	xcvr_core		*xcvr;
+	jesd_core		*jesd;
+	void			*converter;
+	int32_t			(*converter_setup)(void *converter);
+	int32_t			(*converter_status)(void *converter);
+	jesd_link_state		state;
+	uint32_t		elapsed_us;
+	uint32_t		total_us;
+	uint8_t			retries;
+	uint32_t		link_status;
+} jesd_link;
+
+typedef struct {
+	uint32_t		errors;		// samples with CGS/IFS lost
+	uint32_t		drifts;		// latency outside tolerance
+	uint32_t		latency;	// last latency, in octets
+	uint32_t		latency_ref;	// latency right after link up
+	uint32_t		latency_min;
+	uint32_t		latency_max;
+	uint32_t		histogram[JESD_MON_LATENCY_BINS];
+} jesd_lane_stats;
+
+typedef struct {
+	jesd_link		*link;
+	uint8_t			num_lanes;	// 0 for TX links
+	uint8_t			latency_valid;
+	uint32_t		interval_us;
+	uint32_t		elapsed_us;
+	uint32_t		samples;
+	uint32_t		link_status;
+	uint32_t		sysref_status;
+	uint32_t		link_drops;
+	uint32_t		sysref_errors;
+	uint32_t		relinks;
+	uint32_t		relink_failures;
+	jesd_lane_stats		lane[JESD_MON_MAX_LANES];
+} jesd_monitor;
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -169,4 +245,16 @@ int32_t axi_jesd204_tx_status_read(jesd_core jesd);
 int32_t axi_jesd204_rx_laneinfo_read(jesd_core jesd, uint32_t lane);
 int32_t jesd_sysref_control(jesd_core core, uint32_t enable);
 
+int32_t jesd_link_init(jesd_link *link, const char *name,
+		xcvr_core *xcvr, jesd_core *jesd);
+int32_t jesd_link_step(jesd_link *link);
+int32_t jesd_link_bringup(jesd_link *links, uint8_t num_links);
+
+int32_t jesd_monitor_init(jesd_monitor *mon, jesd_link *link,
+		uint32_t interval_us);
+int32_t jesd_monitor_sample(jesd_monitor *mon);
+int32_t jesd_monitor_relink(jesd_monitor *mon);
+int32_t jesd_monitor_poll(jesd_monitor *mon, uint8_t num_mons,
+		uint32_t elapsed_us);
+
 #endif
@@ -409,6 +409,343 @@ int32_t ad_gpio_get_range(uint8_t start_pin, uint8_t num_pins, uint32_t *data)
 	return(pstatus);
 }
 
+/***************************************************************************//**
+ * @brief spi_seq_read
+ *******************************************************************************/
+static int32_t spi_seq_read(spi_seq *seq, uint16_t addr, uint8_t *data)
+{
+	uint8_t buf[3];
+	int32_t ret;
+
+	buf[0] = 0x80 | (addr >> 8);
+	buf[1] = addr & 0xff;
+	buf[2] = 0x00;
+
+	ret = ad_spi_xfer(seq->dev, buf, 3);
+	seq->transfers++;
+	*data = buf[2];
+
+	return ret;
+}
+
+/***************************************************************************//**
+ * @brief spi_seq_write
+ *
+ * Write steps[0] and as many of the following write steps as target the next
+ * address in the streaming direction, in a single transfer of at most
+ * max_burst data bytes. Returns the number of steps consumed.
+ *******************************************************************************/
+static uint32_t spi_seq_write(spi_seq *seq, const spi_seq_step *steps,
+		uint8_t max_burst, int32_t *ret)
+{
+	uint8_t buf[2 + SPI_SEQ_MAX_BURST];
+	int32_t dir;
+	uint32_t n;
+	uint16_t instr;
+
+	dir = seq->addr_ascending ? 1 : -1;
+
+	buf[2] = steps[0].val;
+	for (n = 1; n < max_burst; n++) {
+		if ((steps[n].op != SPI_SEQ_WRITE_OP) ||
+				((int32_t)steps[n].addr !=
+				 (int32_t)steps[0].addr + (int32_t)n * dir))
+			break;
+		buf[2 + n] = steps[n].val;
+	}
+
+	instr = steps[0].addr | ((n > 1) ? seq->stream_flags : 0);
+	buf[0] = instr >> 8;
+	buf[1] = instr & 0xff;
+
+	*ret |= ad_spi_xfer(seq->dev, buf, n + 2);
+	seq->transfers++;
+	seq->writes += n;
+
+	return n;
+}
+
+/***************************************************************************//**
+ * @brief spi_seq_run
+ *
+ * Execute a register sequence. A poll that times out is reported and marks
+ * the sequence as failed, but the remaining steps are still executed, the
+ * same way the hand-written setup functions behave.
+ *******************************************************************************/
+int32_t spi_seq_run(spi_seq *seq, const spi_seq_step *steps)
+{
+	const spi_seq_step *s;
+	spi_seq_step update;
+	uint8_t max_burst;
+	uint32_t waited;
+	uint32_t n;
+	uint32_t i;
+	uint32_t j;
+	uint8_t data;
+	int32_t ret = 0;
+
+	seq->wait_us = 0;
+	seq->transfers = 0;
+	seq->writes = 0;
+	seq->failed_step = -1;
+	max_burst = clamp(seq->max_burst, 1, SPI_SEQ_MAX_BURST);
+
+	for (i = 0; steps[i].op != SPI_SEQ_END_OP; i += n) {
+		s = &steps[i];
+		waited = 0;
+		n = 1;
+
+		switch (s->op) {
+		case SPI_SEQ_WRITE_OP:
+			n = spi_seq_write(seq, s, max_burst, &ret);
+			break;
+		case SPI_SEQ_UPDATE_OP:
+			ret |= spi_seq_read(seq, s->addr, &data);
+			update = *s;
+			update.val = (data & ~s->mask) | (s->val & s->mask);
+			spi_seq_write(seq, &update, 1, &ret);
+			break;
+		case SPI_SEQ_POLL_OP:
+			while (1) {
+				ret |= spi_seq_read(seq, s->addr, &data);
+				if ((data & s->mask) == s->val)
+					break;
+				if (waited >= s->arg0) {
+					ad_printf("%s: step %d timeout (0x%x: 0x%x)\n",
+						seq->name, i, s->addr, data);
+					if (seq->failed_step < 0)
+						seq->failed_step = i;
+					ret = -1;
+					break;
+				}
+				udelay(SPI_SEQ_POLL_US);
+				waited += SPI_SEQ_POLL_US;
+			}
+			break;
+		case SPI_SEQ_DELAY_OP:
+			udelay(s->arg0);
+			waited = s->arg0;
+			break;
+		case SPI_SEQ_IF_RATE_OP:
+			if ((seq->lane_rate_kbps < s->arg0) ||
+					(seq->lane_rate_kbps >= s->arg1))
+				n += s->val;
+			break;
+		}
+
+		seq->wait_us += waited;
+		if (seq->step_us)
+			for (j = 0; j < n; j++)
+				seq->step_us[i + j] = (j == 0) ? waited : 0;
+	}
+
+	return ret;
+}
+
+/***************************************************************************//**
+ * @brief spi_img_init
+ *******************************************************************************/
+int32_t spi_img_init(spi_img *img, spi_device *dev,
+		const spi_img_block *blocks, uint8_t num_blocks,
+		uint8_t cnt_field)
+{
+	uint32_t size = 0;
+	uint32_t i;
+
+	for (i = 0; i < num_blocks; i++)
+		size += blocks[i].len;
+	if (size > SPI_IMG_MAX_BYTES)
+		return -1;
+
+	img->dev = dev;
+	img->blocks = blocks;
+	img->num_blocks = num_blocks;
+	img->cnt_field = cnt_field;
+	img->transfers = 0;
+	img->bytes = 0;
+	for (i = 0; i < SPI_IMG_MAX_BYTES; i++)
+		img->flags[i] = 0;
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief spi_img_invalidate
+ *
+ * Forget what was written, e.g. after a device reset; the next flush
+ * writes every byte that holds a value.
+ *******************************************************************************/
+void spi_img_invalidate(spi_img *img)
+{
+	uint32_t i;
+
+	for (i = 0; i < SPI_IMG_MAX_BYTES; i++)
+		img->flags[i] &= ~SPI_IMG_WRITTEN;
+}
+
+/***************************************************************************//**
+ * @brief spi_img_index - offset of a register byte in the image, -1 if none
+ *******************************************************************************/
+static int32_t spi_img_index(spi_img *img, uint16_t addr)
+{
+	uint32_t offset = 0;
+	uint8_t i;
+
+	for (i = 0; i < img->num_blocks; i++) {
+		if ((addr >= img->blocks[i].start) &&
+				(addr < img->blocks[i].start + img->blocks[i].len))
+			return offset + addr - img->blocks[i].start;
+		offset += img->blocks[i].len;
+	}
+
+	return -1;
+}
+
+/***************************************************************************//**
+ * @brief spi_img_set
+ *******************************************************************************/
+int32_t spi_img_set(spi_img *img, uint32_t reg, uint32_t val)
+{
+	uint16_t addr = reg & 0xffff;
+	uint8_t len = reg >> 16;
+	int32_t idx;
+	uint8_t i;
+
+	for (i = 0; i < len; i++) {
+		idx = spi_img_index(img, addr - i);
+		if (idx < 0)
+			return -1;
+		img->val[idx] = (val >> ((len - i - 1) * 8)) & 0xff;
+		img->flags[idx] |= SPI_IMG_SET;
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief spi_img_get
+ *******************************************************************************/
+int32_t spi_img_get(spi_img *img, uint32_t reg, uint32_t *val)
+{
+	uint16_t addr = reg & 0xffff;
+	uint8_t len = reg >> 16;
+	int32_t idx;
+	uint8_t i;
+
+	*val = 0;
+	for (i = 0; i < len; i++) {
+		idx = spi_img_index(img, addr - i);
+		if ((idx < 0) || !(img->flags[idx] & SPI_IMG_SET))
+			return -1;
+		*val = (*val << 8) | img->val[idx];
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief spi_img_load - seed the image with the current device value
+ *******************************************************************************/
+int32_t spi_img_load(spi_img *img, uint32_t reg)
+{
+	uint16_t addr = reg & 0xffff;
+	uint8_t len = reg >> 16;
+	uint8_t buf[3];
+	int32_t idx;
+	int32_t ret = 0;
+	uint8_t i;
+
+	for (i = 0; i < len; i++) {
+		idx = spi_img_index(img, addr - i);
+		if (idx < 0)
+			return -1;
+		buf[0] = 0x80 | ((addr - i) >> 8);
+		buf[1] = (addr - i) & 0xff;
+		buf[2] = 0x00;
+		ret |= ad_spi_xfer(img->dev, buf, 3);
+		img->transfers++;
+		img->val[idx] = buf[2];
+		img->last[idx] = buf[2];
+		img->flags[idx] |= SPI_IMG_SET | SPI_IMG_WRITTEN;
+	}
+
+	return ret;
+}
+
+/***************************************************************************//**
+ * @brief spi_img_dirty
+ *******************************************************************************/
+static uint8_t spi_img_dirty(spi_img *img, uint32_t idx)
+{
+	if (!(img->flags[idx] & SPI_IMG_SET))
+		return 0;
+	if (!(img->flags[idx] & SPI_IMG_WRITTEN))
+		return 1;
+
+	return (img->val[idx] != img->last[idx]);
+}
+
+/***************************************************************************//**
+ * @brief spi_img_flush
+ *
+ * Write the changed bytes of each block, highest address first. Runs of
+ * changed bytes are extended over up to SPI_IMG_MAX_GAP unchanged (but known)
+ * bytes, as rewriting those is cheaper than a new instruction.
+ *******************************************************************************/
+int32_t spi_img_flush(spi_img *img)
+{
+	uint8_t buf[2 + SPI_IMG_MAX_BURST];
+	uint32_t offset = 0;
+	uint32_t first;
+	uint32_t last;
+	uint32_t n;
+	uint32_t i;
+	int32_t top;
+	int32_t j;
+	uint16_t instr;
+	int32_t ret = 0;
+	uint8_t b;
+
+	for (b = 0; b < img->num_blocks; b++) {
+		top = img->blocks[b].len - 1;
+		while (top >= 0) {
+			// skip to the highest changed byte
+			if (!spi_img_dirty(img, offset + top)) {
+				top--;
+				continue;
+			}
+			first = top;
+			last = top;
+			for (j = top - 1; (j >= 0) &&
+					(first - j < SPI_IMG_MAX_BURST) &&
+					(img->flags[offset + j] & SPI_IMG_SET) &&
+					(last - j <= SPI_IMG_MAX_GAP + 1); j--)
+				if (spi_img_dirty(img, offset + j))
+					last = j;
+
+			n = first - last + 1;
+			instr = img->blocks[b].start + first;
+			if (img->cnt_field)
+				instr |= (min(n, 4) - 1) << 13;
+			buf[0] = instr >> 8;
+			buf[1] = instr & 0xff;
+			for (i = 0; i < n; i++) {
+				buf[2 + i] = img->val[offset + first - i];
+				img->last[offset + first - i] = buf[2 + i];
+				img->flags[offset + first - i] |= SPI_IMG_WRITTEN;
+			}
+			ret |= ad_spi_xfer(img->dev, buf, n + 2);
+			img->transfers++;
+			img->bytes += n;
+
+			top = last - 1;
+		}
+		offset += img->blocks[b].len;
+	}
+
+	return ret;
+}
+
 /***************************************************************************//**
  * @brief do_div
  *******************************************************************************/
@@ -66,6 +66,7 @@
 
 #ifdef ZYNQ
 #include <sleep.h>
+#include <xil_cache.h>
 #include <xspips.h>
 #include <xuartps.h>
 #endif
@@ -126,11 +127,15 @@ void usleep(uint32_t us_count);
 #ifdef ALTERA
 #define ad_icache_flush alt_icache_flush_all
 #define ad_dcache_flush alt_icache_flush_all
+#define ad_dcache_flush_range(x,y) alt_dcache_flush((void *)(x),y)
+#define ad_dcache_invalidate_range(x,y) alt_dcache_flush_no_writeback((void *)(x),y)
 #endif
 
 #ifdef XILINX
 #define ad_icache_flush Xil_ICacheFlush
 #define ad_dcache_flush Xil_DCacheFlush
+#define ad_dcache_flush_range(x,y) Xil_DCacheFlushRange(x,y)
+#define ad_dcache_invalidate_range(x,y) Xil_DCacheInvalidateRange(x,y)
 #endif
 
 #ifdef ZYNQ
@@ -204,6 +209,101 @@ int32_t ad_gpio_get(uint8_t pin, uint8_t *data);
 int32_t ad_gpio_set_range(uint8_t start_pin, uint8_t num_pins, uint8_t data);
 int32_t ad_gpio_get_range(uint8_t start_pin, uint8_t num_pins, uint32_t *data);
 
+/******************************************************************************/
+/**************** SPI register sequence structure and functions ***************/
+/******************************************************************************/
+
+// table-driven setup for the 16-bit instruction, 8-bit data SPI devices
+// (AD9144, AD9680, AD9625, ...). Consecutive writes to adjacent addresses, in
+// the device's streaming direction, are merged into one burst transfer.
+
+typedef enum {
+	SPI_SEQ_END_OP,
+	SPI_SEQ_WRITE_OP,	// reg = val
+	SPI_SEQ_UPDATE_OP,	// reg = (reg & ~mask) | val
+	SPI_SEQ_POLL_OP,	// wait until (reg & mask) == val, arg0 = timeout us
+	SPI_SEQ_DELAY_OP,	// wait arg0 us
+	SPI_SEQ_IF_RATE_OP,	// run the next val steps only if arg0 <= rate < arg1
+} spi_seq_op;
+
+typedef struct {
+	uint8_t		op;
+	uint8_t		mask;
+	uint8_t		val;
+	uint16_t	addr;
+	uint32_t	arg0;
+	uint32_t	arg1;
+} spi_seq_step;
+
+#define SPI_SEQ_WRITE(a, v)		{SPI_SEQ_WRITE_OP, 0xff, (v), (a), 0, 0}
+#define SPI_SEQ_UPDATE(a, m, v)		{SPI_SEQ_UPDATE_OP, (m), (v), (a), 0, 0}
+#define SPI_SEQ_POLL(a, m, v, us)	{SPI_SEQ_POLL_OP, (m), (v), (a), (us), 0}
+#define SPI_SEQ_DELAY(us)		{SPI_SEQ_DELAY_OP, 0, 0, 0, (us), 0}
+#define SPI_SEQ_IF_RATE(min, max, n)	{SPI_SEQ_IF_RATE_OP, 0, (n), 0, (min), (max)}
+#define SPI_SEQ_END			{SPI_SEQ_END_OP, 0, 0, 0, 0, 0}
+
+#define SPI_SEQ_RATE_MAX		0xffffffff
+#define SPI_SEQ_POLL_US			10
+#define SPI_SEQ_MAX_BURST		32
+
+typedef struct {
+	spi_device	*dev;
+	const char	*name;
+	uint8_t		addr_ascending;	// streaming direction set in the device
+	uint16_t	stream_flags;	// instruction bits for multi-byte transfers
+	uint8_t		max_burst;	// 1 disables streaming
+	uint32_t	lane_rate_kbps;
+	uint32_t	*step_us;	// optional, wait time of each step
+	uint32_t	wait_us;
+	uint32_t	transfers;
+	uint32_t	writes;
+	int32_t		failed_step;
+} spi_seq;
+
+int32_t spi_seq_run(spi_seq *seq, const spi_seq_step *steps);
+
+/******************************************************************************/
+/***************** SPI register image structure and functions *****************/
+/******************************************************************************/
+
+// RAM copy of a device register map, written with multi-byte streaming
+// (address descending) transfers. Only bytes that differ from what was last
+// written are sent. Register arguments use the (length << 16) | address
+// encoding of the AD9523/AD9528 drivers, address being the highest byte.
+
+#define SPI_IMG_MAX_BYTES		96
+#define SPI_IMG_MAX_BURST		64
+#define SPI_IMG_MAX_GAP			2
+
+#define SPI_IMG_SET			(1 << 0)	// byte holds a value
+#define SPI_IMG_WRITTEN			(1 << 1)	// last[] matches the device
+
+typedef struct {
+	uint16_t	start;
+	uint16_t	len;
+} spi_img_block;
+
+typedef struct {
+	spi_device		*dev;
+	const spi_img_block	*blocks;
+	uint8_t			num_blocks;
+	uint8_t			cnt_field;	// W1:W0 byte count in the instruction
+	uint8_t			val[SPI_IMG_MAX_BYTES];
+	uint8_t			last[SPI_IMG_MAX_BYTES];
+	uint8_t			flags[SPI_IMG_MAX_BYTES];
+	uint32_t		transfers;
+	uint32_t		bytes;
+} spi_img;
+
+int32_t spi_img_init(spi_img *img, spi_device *dev,
+		const spi_img_block *blocks, uint8_t num_blocks,
+		uint8_t cnt_field);
+void spi_img_invalidate(spi_img *img);
+int32_t spi_img_set(spi_img *img, uint32_t reg, uint32_t val);
+int32_t spi_img_get(spi_img *img, uint32_t reg, uint32_t *val);
+int32_t spi_img_load(spi_img *img, uint32_t reg);
+int32_t spi_img_flush(spi_img *img);
+
 /******************************************************************************/
 /********************* MISC structure and functions ***************************/
 /******************************************************************************/
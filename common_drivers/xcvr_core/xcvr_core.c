@@ -80,6 +80,36 @@ int32_t xcvr_write(xcvr_core *core,
 
 #ifdef XILINX
 
+/* Profile being resolved by xcvr_profile_config(), records the DRP writes */
+static xcvr_profile *xcvr_drp_rec = NULL;
+
+/***************************************************************************//**
+ * @brief xcvr_drp_record
+ *******************************************************************************/
+static void xcvr_drp_record(uint8_t drp_sel, uint32_t drp_addr,
+				uint32_t drp_data)
+{
+	xcvr_profile *p = xcvr_drp_rec;
+	uint8_t i;
+
+	for (i = 0; i < p->num_ops; i++) {
+		if ((p->ops[i].sel == drp_sel) && (p->ops[i].addr == drp_addr)) {
+			p->ops[i].val = drp_data;
+			return;
+		}
+	}
+
+	if (p->num_ops == XCVR_PROFILE_MAX_DRP_OPS) {
+		p->overflow = 1;
+		return;
+	}
+
+	p->ops[p->num_ops].sel = drp_sel;
+	p->ops[p->num_ops].addr = drp_addr;
+	p->ops[p->num_ops].val = drp_data;
+	p->num_ops++;
+}
+
 /***************************************************************************//**
  * @brief xcvr_drp_read Dynamic reconfiguration port read access for Xilinx devices
  *******************************************************************************/
@@ -120,6 +150,9 @@ int32_t xcvr_drp_write(xcvr_core *core, uint8_t drp_sel,
 	uint32_t timeout = 20;
 	uint32_t val = 0;
 
+	if (xcvr_drp_rec)
+		xcvr_drp_record(drp_sel, drp_addr, drp_data);
+
 	xcvr_write(core, drp_sel ? XCVR_REG_CH_SEL : XCVR_REG_CM_SEL, XCVR_BROADCAST);
 
 	xcvr_write(core, drp_sel ? XCVR_REG_CH_CONTROL : XCVR_REG_CM_CONTROL,
@@ -162,9 +195,13 @@ int32_t xcvr_drp_update(xcvr_core *core, uint8_t drp_sel,
 #endif
 
 /*******************************************************************************
- * @brief xcvr_setup
+ * @brief xcvr_config
+ *
+ * Reprogram the lane PLLs and leave the transceiver in reset. The caller
+ * releases the reset and polls xcvr_ready(), so several transceivers can
+ * train at the same time.
  *******************************************************************************/
-int32_t xcvr_setup(xcvr_core *core)
+int32_t xcvr_config(xcvr_core *core)
 {
 	int32_t ret = 0;
 
@@ -192,12 +229,8 @@ int32_t xcvr_setup(xcvr_core *core)
 		altera_a10_calib_tx_pll(core);
 	}
 
-	xcvr_filalize_lane_rate_change(core); // bring out of reset - print  status
-
 #endif
 #ifdef XILINX
-	uint32_t status;
-	uint32_t timeout;
 	uint16_t local_sys_clk_sel;
 	uint32_t out_div;
 	uint32_t rx_out_div;
@@ -272,6 +305,40 @@ int32_t xcvr_setup(xcvr_core *core)
 							XCVR_OUTCLK_SEL(core->dev.out_clk_sel));
 
 	}
+#endif
+
+	return(0);
+}
+
+/*******************************************************************************
+ * @brief xcvr_ready
+ *
+ * Single, non-blocking check of the transceiver status. Returns 1 once the
+ * PLLs are locked and the lanes are out of reset, 0 otherwise.
+ *******************************************************************************/
+int32_t xcvr_ready(xcvr_core *core)
+{
+	uint32_t status;
+
+	xcvr_read(core, XCVR_REG_STATUS, &status);
+
+	return (status == XCVR_STATUS) ? 1 : 0;
+}
+
+/*******************************************************************************
+ * @brief xcvr_setup
+ *******************************************************************************/
+int32_t xcvr_setup(xcvr_core *core)
+{
+	if (xcvr_config(core))
+		return(-1);
+
+#ifdef ALTERA
+	xcvr_filalize_lane_rate_change(core); // bring out of reset - print  status
+#endif
+#ifdef XILINX
+	uint32_t status;
+	uint32_t timeout;
 
 	xcvr_write(core, XCVR_REG_RESETN, XCVR_RESETN);
 
@@ -280,7 +347,7 @@ int32_t xcvr_setup(xcvr_core *core)
 	{
 		mdelay(1);
 		timeout = timeout - 1;
-		xcvr_read(core, XCVR_REG_STATUS, &status);
+		status = xcvr_ready(core);
 		if (status == 1)
 			break;
 	}
@@ -295,6 +362,204 @@ int32_t xcvr_setup(xcvr_core *core)
 	return(0);
 }
 
+/*******************************************************************************
+ * @brief xcvr_profile_cache_init
+ *******************************************************************************/
+void xcvr_profile_cache_init(xcvr_profile_cache *cache)
+{
+	uint8_t i;
+
+	for (i = 0; i < XCVR_PROFILE_CACHE_SIZE; i++)
+		cache->profile[i].valid = 0;
+	cache->active = NULL;
+	cache->next = 0;
+	cache->hits = 0;
+	cache->misses = 0;
+}
+
+/*******************************************************************************
+ * @brief xcvr_profile_find
+ *******************************************************************************/
+static xcvr_profile *xcvr_profile_find(xcvr_core *core,
+		xcvr_profile_cache *cache)
+{
+	xcvr_profile *p;
+	uint8_t i;
+
+	for (i = 0; i < XCVR_PROFILE_CACHE_SIZE; i++) {
+		p = &cache->profile[i];
+		if (!p->valid ||
+				(p->ref_clock_khz != core->ref_clock_khz) ||
+				(p->lane_rate_kbps != core->lane_rate_kbps) ||
+				(p->rx_tx_n != core->rx_tx_n))
+			continue;
+#ifdef XILINX
+		if ((p->qpll_enable != core->dev.qpll_enable) ||
+				(p->lpm_enable != core->dev.lpm_enable))
+			continue;
+#endif
+		return p;
+	}
+
+	return NULL;
+}
+
+#ifdef XILINX
+/*******************************************************************************
+ * @brief xcvr_profile_apply
+ *
+ * Replay a resolved profile. Registers the active profile already holds
+ * with the same value are skipped, everything else is a single DRP write
+ * of the recorded register image, so no read-modify-write is needed.
+ *******************************************************************************/
+static int32_t xcvr_profile_apply(xcvr_core *core, xcvr_profile_cache *cache,
+		xcvr_profile *p)
+{
+	xcvr_profile *active = cache->active;
+	uint8_t i;
+	uint8_t j;
+	int32_t ret = 0;
+
+	for (i = 0; (active != p) && (i < p->num_ops); i++) {
+		if (active) {
+			for (j = 0; j < active->num_ops; j++)
+				if ((active->ops[j].sel == p->ops[i].sel) &&
+						(active->ops[j].addr == p->ops[i].addr))
+					break;
+			if ((j < active->num_ops) &&
+					(active->ops[j].val == p->ops[i].val))
+				continue;
+		}
+		ret |= xcvr_drp_write(core, p->ops[i].sel, p->ops[i].addr,
+				p->ops[i].val);
+	}
+
+	core->dev.sys_clk_sel = p->sys_clk_sel;
+	core->dev.out_div = p->out_div;
+
+	xcvr_write(core, XCVR_REG_CONTROL, (core->dev.lpm_enable ? XCVR_LPM_DFE_N : 0) |
+						XCVR_SYSCLK_SEL(core->dev.sys_clk_sel) |
+						XCVR_OUTCLK_SEL(core->dev.out_clk_sel));
+
+	return ret;
+}
+#endif
+
+/*******************************************************************************
+ * @brief xcvr_profile_config
+ *
+ * Same as xcvr_config(), but the PLL, CDR and out-div settings are
+ * resolved only once per (ref clock, lane rate) and then replayed from the
+ * cache. The cache tracks what is programmed in the transceiver, so it
+ * must be used for every rate change of that core.
+ *******************************************************************************/
+int32_t xcvr_profile_config(xcvr_core *core, xcvr_profile_cache *cache)
+{
+	xcvr_profile *p;
+	int32_t ret = 0;
+
+	if (core->reconfig_bypass)
+		return xcvr_config(core);
+
+	p = xcvr_profile_find(core, cache);
+	if (p)
+		cache->hits++;
+	else
+		cache->misses++;
+
+#ifdef XILINX
+	if (p) {
+		xcvr_write(core, XCVR_REG_RESETN, 0);  // enter reset state
+		ret = xcvr_profile_apply(core, cache, p);
+		cache->active = p;
+		return ret;
+	}
+
+	p = &cache->profile[cache->next];
+	cache->next = (cache->next + 1) % XCVR_PROFILE_CACHE_SIZE;
+	p->valid = 0;
+	p->num_ops = 0;
+	p->overflow = 0;
+
+	xcvr_drp_rec = p;
+	ret = xcvr_config(core);
+	xcvr_drp_rec = NULL;
+	// whatever was active has been overwritten
+	cache->active = NULL;
+	if (ret || p->overflow)
+		return ret;
+
+	p->qpll_enable = core->dev.qpll_enable;
+	p->lpm_enable = core->dev.lpm_enable;
+	p->sys_clk_sel = core->dev.sys_clk_sel;
+	p->out_div = core->dev.out_div;
+#endif
+#ifdef ALTERA
+	if (!p) {
+		p = &cache->profile[cache->next];
+		cache->next = (cache->next + 1) % XCVR_PROFILE_CACHE_SIZE;
+		p->link_clk_khz = fpll_round_rate(core->lane_rate_kbps / 40,
+			core->ref_clock_khz);
+		if (core->rx_tx_n)
+			p->lane_rate_khz = altera_a10_cdr_pll_round_rate(
+				core->lane_rate_kbps, core->ref_clock_khz);
+		else
+			p->lane_rate_khz = atx_pll_round_rate(
+				core->lane_rate_kbps, core->ref_clock_khz);
+	}
+
+	xcvr_write(core, XCVR_REG_RESETN, 0); // enter reset state
+
+	ret |= fpll_set_rate(&(core->dev.link_pll), p->link_clk_khz,
+		core->ref_clock_khz);
+	core->link_clk_khz = p->link_clk_khz;
+
+	if (core->rx_tx_n) {
+		ret |= altera_a10_cdr_pll_set_rate(core, p->lane_rate_khz,
+			core->ref_clock_khz);
+	} else {
+		ret |= atx_pll_set_rate(core, p->lane_rate_khz,
+			core->ref_clock_khz);
+		altera_a10_calib_tx_pll(core);
+	}
+#endif
+
+	p->ref_clock_khz = core->ref_clock_khz;
+	p->lane_rate_kbps = core->lane_rate_kbps;
+	p->rx_tx_n = core->rx_tx_n;
+	p->valid = 1;
+	cache->active = p;
+
+	return ret;
+}
+
+/*******************************************************************************
+ * @brief xcvr_set_lane_rate
+ *******************************************************************************/
+int32_t xcvr_set_lane_rate(xcvr_core *core, xcvr_profile_cache *cache,
+		uint32_t lane_rate_kbps)
+{
+	uint32_t timeout;
+
+	core->lane_rate_kbps = lane_rate_kbps;
+
+	if (xcvr_profile_config(core, cache))
+		return(-1);
+
+	xcvr_write(core, XCVR_REG_RESETN, XCVR_RESETN);
+
+	timeout = 100;
+	while (!xcvr_ready(core)) {
+		if (timeout-- == 0) {
+			printf("%s ERROR: XCVR initialization failed!\n", __func__);
+			return(-1);
+		}
+		mdelay(1);
+	}
+
+	return(0);
+}
+
 /*******************************************************************************
  * @brief xcvr_getconfig
  *******************************************************************************/
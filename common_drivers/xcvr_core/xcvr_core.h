@@ -94,6 +94,45 @@ typedef struct {
 	fpga_dev		dev;
 } xcvr_core;
 
+#define XCVR_PROFILE_CACHE_SIZE			4
+#define XCVR_PROFILE_MAX_DRP_OPS		32
+
+#ifdef XILINX
+typedef struct {
+	uint8_t			sel;
+	uint16_t		addr;
+	uint16_t		val;		// full register image
+} xcvr_drp_op;
+#endif
+
+typedef struct {
+	uint8_t			valid;
+	uint32_t		ref_clock_khz;
+	uint32_t		lane_rate_kbps;
+	uint8_t			rx_tx_n;
+#ifdef XILINX
+	uint8_t			qpll_enable;
+	uint8_t			lpm_enable;
+	uint32_t		sys_clk_sel;
+	uint32_t		out_div;
+	uint8_t			num_ops;
+	uint8_t			overflow;
+	xcvr_drp_op		ops[XCVR_PROFILE_MAX_DRP_OPS];
+#endif
+#ifdef ALTERA
+	uint32_t		link_clk_khz;
+	uint32_t		lane_rate_khz;
+#endif
+} xcvr_profile;
+
+typedef struct {
+	xcvr_profile		profile[XCVR_PROFILE_CACHE_SIZE];
+	xcvr_profile		*active;
+	uint8_t			next;
+	uint32_t		hits;
+	uint32_t		misses;
+} xcvr_profile_cache;
+
 /******************************************************************************/
 /************************ XCVR Common Core Definitions ************************/
 /******************************************************************************/
@@ -185,7 +224,13 @@ int32_t xcvr_write(xcvr_core *core, uint32_t reg_addr, uint32_t reg_data);
 
 #endif
 
+int32_t xcvr_config(xcvr_core *core);
+int32_t xcvr_ready(xcvr_core *core);
 int32_t xcvr_setup(xcvr_core *core);
+void xcvr_profile_cache_init(xcvr_profile_cache *cache);
+int32_t xcvr_profile_config(xcvr_core *core, xcvr_profile_cache *cache);
+int32_t xcvr_set_lane_rate(xcvr_core *core, xcvr_profile_cache *cache,
+		uint32_t lane_rate_kbps);
 int32_t xcvr_status(xcvr_core *core);
 int32_t xcvr_getconfig(xcvr_core *core);
 int32_t xcvr_reset(xcvr_core *core);
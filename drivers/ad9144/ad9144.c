@@ -105,147 +105,151 @@ int32_t ad9144_spi_check_status(spi_device *dev,
 }
 
 /***************************************************************************//**
- * @brief ad9144_setup
+ * @brief ad9144_setup_seq
  *******************************************************************************/
-int32_t ad9144_setup(spi_device *dev,
-		ad9144_init_param init_param)
-{
-	uint8_t chip_id;
-	uint8_t scratchpad;
-	int32_t ret;
+static const spi_seq_step ad9144_setup_seq[] = {
 
-	ad9144_spi_read(dev, REG_SPI_PRODIDL, &chip_id);
-	if(chip_id != AD9144_CHIP_ID)
-	{
-		ad_printf("%s : Invalid CHIP ID (0x%x).\n", __func__, chip_id);
-		return -1;
-	}
+	// power-up and dac initialization, address ascending for streaming
 
-	ad9144_spi_write(dev, REG_SPI_SCRATCHPAD, 0xAD);
-	ad9144_spi_read(dev, REG_SPI_SCRATCHPAD, &scratchpad);
-	if(scratchpad != 0xAD)
-	{
-		ad_printf("%s : scratchpad read-write failed (0x%x)!\n", __func__, scratchpad);
-		return -1;
-	}
-
-	// power-up and dac initialization
+	SPI_SEQ_WRITE(REG_SPI_INTFCONFA, SOFTRESET_M | SOFTRESET),	// reset
+	SPI_SEQ_WRITE(REG_SPI_INTFCONFA, ADDRINC_M | ADDRINC),	// reset
+	SPI_SEQ_DELAY(1000),
 
-	ad9144_spi_write(dev, REG_SPI_INTFCONFA, SOFTRESET_M | SOFTRESET);	// reset
-	ad9144_spi_write(dev, REG_SPI_INTFCONFA, 0x00);	// reset
-	mdelay(1);
-
-	ad9144_spi_write(dev, REG_PWRCNTRL0, 0x00);	// dacs - power up everything
-	ad9144_spi_write(dev, REG_CLKCFG0, 0x00);	// clocks - power up everything
-	ad9144_spi_write(dev, REG_SYSREF_ACTRL0, 0x00);	// sysref - power up/falling edge
+	SPI_SEQ_WRITE(REG_PWRCNTRL0, 0x00),	// dacs - power up everything
+	SPI_SEQ_WRITE(REG_CLKCFG0, 0x00),	// clocks - power up everything
+	SPI_SEQ_WRITE(REG_SYSREF_ACTRL0, 0x00),	// sysref - power up/falling edge
 
 	// required device configurations
 
-	ad9144_spi_write(dev, REG_DATA_PATH_FLUSH_COUNT0, 0x8b);	// data-path
-	ad9144_spi_write(dev, REG_BLSM_CTRL, 0x01);			// data-path
-	ad9144_spi_write(dev, REG_DEV_CONFIG_8, 0xff);			// clock
-	ad9144_spi_write(dev, REG_DACPLLT17, 0x73);			// dac-pll
-	ad9144_spi_write(dev, REG_SERDES_PLL_CTRL, 0x49);		// serdes-pll
-	ad9144_spi_write(dev, REG_SERDES_PLL_CP3, 0x24);		// serde-pll
-	ad9144_spi_write(dev, REG_SERDES_PLL_VAR3, 0x73);		// serde-pll
-	ad9144_spi_write(dev, REG_CONFIG_REG3, 0xff);			// jesd
-	ad9144_spi_write(dev, REG_DEVICE_CONFIG_REG_13, 0x01);		// jesd
+	SPI_SEQ_WRITE(REG_DATA_PATH_FLUSH_COUNT0, 0x8b),	// data-path
+	SPI_SEQ_WRITE(REG_BLSM_CTRL, 0x01),			// data-path
+	SPI_SEQ_WRITE(REG_DEV_CONFIG_8, 0xff),			// clock
+	SPI_SEQ_WRITE(REG_DACPLLT17, 0x73),			// dac-pll
+	SPI_SEQ_WRITE(REG_SERDES_PLL_CTRL, 0x49),		// serdes-pll
+	SPI_SEQ_WRITE(REG_SERDES_PLL_CP3, 0x24),		// serde-pll
+	SPI_SEQ_WRITE(REG_SERDES_PLL_VAR3, 0x73),		// serde-pll
+	SPI_SEQ_WRITE(REG_CONFIG_REG3, 0xff),			// jesd
+	SPI_SEQ_WRITE(REG_DEVICE_CONFIG_REG_13, 0x01),		// jesd
 
 	// digital data path
 
-	ad9144_spi_write(dev, REG_INTERP_MODE, 0x00);	// interpolation (bypass)
-	ad9144_spi_write(dev, REG_DATA_FORMAT, 0x00);	// 2's complement
+	SPI_SEQ_WRITE(REG_INTERP_MODE, 0x00),	// interpolation (bypass)
+	SPI_SEQ_WRITE(REG_DATA_FORMAT, 0x00),	// 2's complement
 
 	// transport layer
 
-	ad9144_spi_write(dev, REG_MASTER_PD, 0x00);	// phy - power up
-	ad9144_spi_write(dev, REG_PHY_PD, 0x00);	// phy - power up
-	ad9144_spi_write(dev, REG_GENERAL_JRX_CTRL_0, 0x01);	// single link - link 0
-	ad9144_spi_write(dev, REG_ILS_DID, 0x00);	// device id (0x400)
-	ad9144_spi_write(dev, REG_ILS_BID, 0x00);	// bank id (0x401)
-	ad9144_spi_write(dev, REG_ILS_LID0, 0x04);	// lane-id (0x402)
-	ad9144_spi_write(dev, REG_ILS_SCR_L, 0x83);	// descrambling, 4 lanes
-	ad9144_spi_write(dev, REG_ILS_F, 0x00);		// octects per frame per lane (1)
-	ad9144_spi_write(dev, REG_ILS_K, 0x1f);		// mult-frame - framecount (32)
-	ad9144_spi_write(dev, REG_ILS_M, 0x01);		// no-of-converters (2)
-	ad9144_spi_write(dev, REG_ILS_CS_N, 0x0f);	// no CS bits, 16bit dac
-	ad9144_spi_write(dev, REG_ILS_NP, 0x2f);	// subclass 1, 16bits per sample
-	ad9144_spi_write(dev, REG_ILS_S, 0x20);		// jesd204b, 1 samples per converter per device
-	ad9144_spi_write(dev, REG_ILS_HD_CF, 0x80);	// HD mode, no CS bits
-	ad9144_spi_write(dev, REG_ILS_CHECKSUM, 0x49);	// check-sum of REG_ILS_DID to 0x45c
-	ad9144_spi_write(dev, REG_LANEDESKEW, 0x0f);	// enable deskew for all lanes
-	ad9144_spi_write(dev, REG_CTRLREG1, 0x01);	// frame - bytecount (1)
-	ad9144_spi_write(dev, REG_LANEENABLE, 0x0f);	// enable all lanes
+	SPI_SEQ_WRITE(REG_MASTER_PD, 0x00),	// phy - power up
+	SPI_SEQ_WRITE(REG_PHY_PD, 0x00),	// phy - power up
+	SPI_SEQ_WRITE(REG_GENERAL_JRX_CTRL_0, 0x01),	// single link - link 0
+	SPI_SEQ_WRITE(REG_ILS_DID, 0x00),	// device id (0x400)
+	SPI_SEQ_WRITE(REG_ILS_BID, 0x00),	// bank id (0x401)
+	SPI_SEQ_WRITE(REG_ILS_LID0, 0x04),	// lane-id (0x402)
+	SPI_SEQ_WRITE(REG_ILS_SCR_L, 0x83),	// descrambling, 4 lanes
+	SPI_SEQ_WRITE(REG_ILS_F, 0x00),		// octects per frame per lane (1)
+	SPI_SEQ_WRITE(REG_ILS_K, 0x1f),		// mult-frame - framecount (32)
+	SPI_SEQ_WRITE(REG_ILS_M, 0x01),		// no-of-converters (2)
+	SPI_SEQ_WRITE(REG_ILS_CS_N, 0x0f),	// no CS bits, 16bit dac
+	SPI_SEQ_WRITE(REG_ILS_NP, 0x2f),	// subclass 1, 16bits per sample
+	SPI_SEQ_WRITE(REG_ILS_S, 0x20),		// jesd204b, 1 samples per converter per device
+	SPI_SEQ_WRITE(REG_ILS_HD_CF, 0x80),	// HD mode, no CS bits
+	SPI_SEQ_WRITE(REG_ILS_CHECKSUM, 0x49),	// check-sum of REG_ILS_DID to 0x45c
+	SPI_SEQ_WRITE(REG_LANEDESKEW, 0x0f),	// enable deskew for all lanes
+	SPI_SEQ_WRITE(REG_CTRLREG1, 0x01),	// frame - bytecount (1)
+	SPI_SEQ_WRITE(REG_LANEENABLE, 0x0f),	// enable all lanes
 
 	// physical layer
 
-	ad9144_spi_write(dev, REG_DEV_CONFIG_9, 0xb7);		// jesd termination
-	ad9144_spi_write(dev, REG_DEV_CONFIG_10, 0x87);		// jesd termination
-	ad9144_spi_write(dev, REG_DEV_CONFIG_11, 0xb7);		// jesd termination
-	ad9144_spi_write(dev, REG_DEV_CONFIG_12, 0x87);		// jesd termination
-	ad9144_spi_write(dev, REG_TERM_BLK1_CTRLREG0, 0x01);	// input termination calibration
-	ad9144_spi_write(dev, REG_TERM_BLK2_CTRLREG0, 0x01);	// input termination calibration
-	ad9144_spi_write(dev, REG_SERDES_SPI_REG, 0x01);	// pclk == qbd master clock
-	if (init_param.lane_rate_kbps < 2880000)
-		ad9144_spi_write(dev, REG_CDR_OPERATING_MODE_REG_0, 0x0A);		// CDR_OVERSAMP
-	else
-		if (init_param.lane_rate_kbps > 5520000)
-			ad9144_spi_write(dev, REG_CDR_OPERATING_MODE_REG_0, 0x28);	// ENHALFRATE
-		else
-			ad9144_spi_write(dev, REG_CDR_OPERATING_MODE_REG_0, 0x08);
-	ad9144_spi_write(dev, REG_CDR_RESET, 0x00);	// cdr reset
-	ad9144_spi_write(dev, REG_CDR_RESET, 0x01);	// cdr reset
-	if (init_param.lane_rate_kbps < 2880000)
-		ad9144_spi_write(dev, REG_REF_CLK_DIVIDER_LDO, 0x06);		// data-rate < 2.88 Gbps
-	else
-		if (init_param.lane_rate_kbps > 5520000)
-			ad9144_spi_write(dev, REG_REF_CLK_DIVIDER_LDO, 0x04);	// data-rate > 5.52 Gbps
-		else
-			ad9144_spi_write(dev, REG_REF_CLK_DIVIDER_LDO, 0x05);
-	ad9144_spi_write(dev, REG_SYNTH_ENABLE_CNTRL, 0x01);	// enable serdes pll
-	ad9144_spi_write(dev, REG_SYNTH_ENABLE_CNTRL, 0x05);	// enable serdes calibration
-	mdelay(20);
-
-	ret = ad9144_spi_check_status(dev, REG_PLL_STATUS, 0x01, 0x01);
-	if (ret == -1)
-		ad_printf("%s : PLL NOT locked!.\n", __func__);
-
-	ad9144_spi_write(dev, REG_EQ_BIAS_REG, 0x62);	// equalizer
+	SPI_SEQ_WRITE(REG_DEV_CONFIG_9, 0xb7),		// jesd termination
+	SPI_SEQ_WRITE(REG_DEV_CONFIG_10, 0x87),		// jesd termination
+	SPI_SEQ_WRITE(REG_DEV_CONFIG_11, 0xb7),		// jesd termination
+	SPI_SEQ_WRITE(REG_DEV_CONFIG_12, 0x87),		// jesd termination
+	SPI_SEQ_WRITE(REG_TERM_BLK1_CTRLREG0, 0x01),	// input termination calibration
+	SPI_SEQ_WRITE(REG_TERM_BLK2_CTRLREG0, 0x01),	// input termination calibration
+	SPI_SEQ_WRITE(REG_SERDES_SPI_REG, 0x01),	// pclk == qbd master clock
+	SPI_SEQ_IF_RATE(0, 2880000, 1),
+	SPI_SEQ_WRITE(REG_CDR_OPERATING_MODE_REG_0, 0x0A),	// CDR_OVERSAMP
+	SPI_SEQ_IF_RATE(2880000, 5520001, 1),
+	SPI_SEQ_WRITE(REG_CDR_OPERATING_MODE_REG_0, 0x08),
+	SPI_SEQ_IF_RATE(5520001, SPI_SEQ_RATE_MAX, 1),
+	SPI_SEQ_WRITE(REG_CDR_OPERATING_MODE_REG_0, 0x28),	// ENHALFRATE
+	SPI_SEQ_WRITE(REG_CDR_RESET, 0x00),	// cdr reset
+	SPI_SEQ_WRITE(REG_CDR_RESET, 0x01),	// cdr reset
+	SPI_SEQ_IF_RATE(0, 2880000, 1),
+	SPI_SEQ_WRITE(REG_REF_CLK_DIVIDER_LDO, 0x06),	// data-rate < 2.88 Gbps
+	SPI_SEQ_IF_RATE(2880000, 5520001, 1),
+	SPI_SEQ_WRITE(REG_REF_CLK_DIVIDER_LDO, 0x05),
+	SPI_SEQ_IF_RATE(5520001, SPI_SEQ_RATE_MAX, 1),
+	SPI_SEQ_WRITE(REG_REF_CLK_DIVIDER_LDO, 0x04),	// data-rate > 5.52 Gbps
+	SPI_SEQ_WRITE(REG_SYNTH_ENABLE_CNTRL, 0x01),	// enable serdes pll
+	SPI_SEQ_WRITE(REG_SYNTH_ENABLE_CNTRL, 0x05),	// enable serdes calibration
+	SPI_SEQ_POLL(REG_PLL_STATUS, 0x01, 0x01, 120000),	// pll locked
+
+	SPI_SEQ_WRITE(REG_EQ_BIAS_REG, 0x62),	// equalizer
 
 	// data link layer
 
-	ad9144_spi_write(dev, REG_GENERAL_JRX_CTRL_1, 0x01);	// subclass-1
-	ad9144_spi_write(dev, REG_LMFC_DELAY_0, 0x00);	// lmfc delay
-	ad9144_spi_write(dev, REG_LMFC_DELAY_1, 0x00);	// lmfc delay
-	ad9144_spi_write(dev, REG_LMFC_VAR_0, 0x0a);	// receive buffer delay
-	ad9144_spi_write(dev, REG_LMFC_VAR_1, 0x0a);	// receive buffer delay
-	ad9144_spi_write(dev, REG_SYNC_CTRL, 0x01);	// sync-oneshot mode
-	ad9144_spi_write(dev, REG_SYNC_CTRL, 0x81);	// sync-enable
-	ad9144_spi_write(dev, REG_SYNC_CTRL, 0xc1);	// sysref-armed
-	ad9144_spi_write(dev, REG_GENERAL_JRX_CTRL_0, 0x01);	// enable link
+	SPI_SEQ_WRITE(REG_GENERAL_JRX_CTRL_1, 0x01),	// subclass-1
+	SPI_SEQ_WRITE(REG_LMFC_DELAY_0, 0x00),	// lmfc delay
+	SPI_SEQ_WRITE(REG_LMFC_DELAY_1, 0x00),	// lmfc delay
+	SPI_SEQ_WRITE(REG_LMFC_VAR_0, 0x0a),	// receive buffer delay
+	SPI_SEQ_WRITE(REG_LMFC_VAR_1, 0x0a),	// receive buffer delay
+	SPI_SEQ_WRITE(REG_SYNC_CTRL, 0x01),	// sync-oneshot mode
+	SPI_SEQ_WRITE(REG_SYNC_CTRL, 0x81),	// sync-enable
+	SPI_SEQ_WRITE(REG_SYNC_CTRL, 0xc1),	// sysref-armed
+	SPI_SEQ_WRITE(REG_GENERAL_JRX_CTRL_0, 0x01),	// enable link
 
 	// dac calibration
 
-	ad9144_spi_write(dev, REG_CAL_CLKDIV, 0x38);	// set calibration clock to 1m
-	ad9144_spi_write(dev, REG_CAL_INIT, 0xa6);	// use isb reference of 38 to set cal
-	ad9144_spi_write(dev, REG_CAL_INDX, 0x03);	// cal 2 dacs at once
-	ad9144_spi_write(dev, REG_CAL_CTRL, 0x01);	// single cal enable
-	ad9144_spi_write(dev, REG_CAL_CTRL, 0x03);	// single cal start
-	mdelay(10);
-
-	ad9144_spi_write(dev, REG_CAL_INDX, 0x01);	// read dac-0
+	SPI_SEQ_WRITE(REG_CAL_CLKDIV, 0x38),	// set calibration clock to 1m
+	SPI_SEQ_WRITE(REG_CAL_INIT, 0xa6),	// use isb reference of 38 to set cal
+	SPI_SEQ_WRITE(REG_CAL_INDX, 0x03),	// cal 2 dacs at once
+	SPI_SEQ_WRITE(REG_CAL_CTRL, 0x01),	// single cal enable
+	SPI_SEQ_WRITE(REG_CAL_CTRL, 0x03),	// single cal start
+	SPI_SEQ_WRITE(REG_CAL_INDX, 0x01),	// read dac-0
+	SPI_SEQ_POLL(REG_CAL_CTRL, 0xc0, 0x80, 110000),	// dac-0 calibration done
+	SPI_SEQ_WRITE(REG_CAL_INDX, 0x02),	// read dac-1
+	SPI_SEQ_POLL(REG_CAL_CTRL, 0xc0, 0x80, 110000),	// dac-1 calibration done
+	SPI_SEQ_WRITE(REG_CAL_CLKDIV, 0x30),	// turn off cal clock
+	SPI_SEQ_END
+};
 
-	ret = ad9144_spi_check_status(dev, REG_CAL_CTRL, 0xc0, 0x80);
-	if (ret == -1)
-		ad_printf("%s : dac-0 calibration failed!\n", __func__);
+/***************************************************************************//**
+ * @brief ad9144_setup
+ *******************************************************************************/
+int32_t ad9144_setup(spi_device *dev,
+		ad9144_init_param init_param)
+{
+	uint8_t chip_id;
+	uint8_t scratchpad;
+	spi_seq seq;
+	int32_t ret;
 
-	ad9144_spi_write(dev, REG_CAL_INDX, 0x02);	// read dac-1
+	ad9144_spi_read(dev, REG_SPI_PRODIDL, &chip_id);
+	if(chip_id != AD9144_CHIP_ID)
+	{
+		ad_printf("%s : Invalid CHIP ID (0x%x).\n", __func__, chip_id);
+		return -1;
+	}
 
-	ret = ad9144_spi_check_status(dev, REG_CAL_CTRL, 0xc0, 0x80);
-	if (ret == -1)
-		ad_printf("%s : dac-1 calibration failed!\n", __func__);
+	ad9144_spi_write(dev, REG_SPI_SCRATCHPAD, 0xAD);
+	ad9144_spi_read(dev, REG_SPI_SCRATCHPAD, &scratchpad);
+	if(scratchpad != 0xAD)
+	{
+		ad_printf("%s : scratchpad read-write failed (0x%x)!\n", __func__, scratchpad);
+		return -1;
+	}
 
-	ad9144_spi_write(dev, REG_CAL_CLKDIV, 0x30);	// turn off cal clock
+	seq.dev = dev;
+	seq.name = "AD9144";
+	seq.addr_ascending = 1;
+	seq.stream_flags = 0;
+	seq.max_burst = SPI_SEQ_MAX_BURST;
+	seq.lane_rate_kbps = init_param.lane_rate_kbps;
+	seq.step_us = NULL;
+
+	ret = spi_seq_run(&seq, ad9144_setup_seq);
+	if (ret)
+		ad_printf("%s : setup failed at step %d!\n", __func__, seq.failed_step);
 
 	return ret;
 }
@@ -53,8 +53,17 @@ struct ad9523_state
 	uint32_t vco_freq;
 	uint32_t vco_out_freq[3];
 	uint8_t vco_out_map[14];
+	spi_img img;
 }ad9523_st;
 
+/* Register blocks held in the register image */
+static const spi_img_block ad9523_img_blocks[] = {
+	{0x010, 14},	/* PLL1 */
+	{0x0F0, 8},	/* PLL2 */
+	{0x190, 44},	/* Channel distribution, PLL1 output control */
+	{0x230, 4},	/* Status signals, power down */
+};
+
 enum
 {
 	AD9523_VCO1,
@@ -136,67 +145,83 @@ int32_t ad9523_io_update(spi_device *dev)
 }
 
 /***************************************************************************//**
- * @brief Sets the clock provider for selected channel.
+ * @brief Sets the clock provider for selected channel in the register image.
  *
  * @param ch - Selected channel.
  * @param out - Selected clock provider.
  *
  * @return Returns 0 in case of success or negative error code.
  *******************************************************************************/
-int32_t ad9523_vco_out_map(spi_device *dev,
-		uint32_t ch,
+static int32_t ad9523_img_vco_out_map(uint32_t ch,
 		uint32_t out)
 {
 	struct ad9523_state *st = &ad9523_st;
-	int32_t ret;
+	uint32_t reg;
 	uint32_t mask;
 	uint32_t reg_data;
+	int32_t ret;
 
 	switch (ch) {
 		case 0 ... 3:
-			ret = ad9523_spi_read(dev, AD9523_PLL1_OUTPUT_CHANNEL_CTRL, &reg_data);
-			if (ret < 0)
-				break;
+			reg = AD9523_PLL1_OUTPUT_CHANNEL_CTRL;
 			mask = AD9523_PLL1_OUTP_CH_CTRL_VCXO_SRC_SEL_CH0 << ch;
-			if (out) {
-				reg_data |= mask;
-				out = AD9523_VCXO;
-			} else {
-				reg_data &= ~mask;
-			}
-			ret = ad9523_spi_write(dev,
-					AD9523_PLL1_OUTPUT_CHANNEL_CTRL, reg_data);
 			break;
 		case 4 ... 6:
-			ret = ad9523_spi_read(dev, AD9523_PLL1_OUTPUT_CTRL, &reg_data);
-			if (ret < 0)
-				break;
+			reg = AD9523_PLL1_OUTPUT_CTRL;
 			mask = AD9523_PLL1_OUTP_CTRL_VCO_DIV_SEL_CH4_M2 << (ch - 4);
-			if (out)
-				reg_data |= mask;
-			else
-				reg_data &= ~mask;
-			ret = ad9523_spi_write(dev, AD9523_PLL1_OUTPUT_CTRL, reg_data);
 			break;
 		case 7 ... 9:
-			ret = ad9523_spi_read(dev, AD9523_PLL1_OUTPUT_CHANNEL_CTRL, &reg_data);
-			if (ret < 0)
-				break;
+			reg = AD9523_PLL1_OUTPUT_CHANNEL_CTRL;
 			mask = AD9523_PLL1_OUTP_CH_CTRL_VCO_DIV_SEL_CH7_M2 << (ch - 7);
-			if (out)
-				reg_data |= mask;
-			else
-				reg_data &= ~mask;
-			ret = ad9523_spi_write(dev,
-					AD9523_PLL1_OUTPUT_CHANNEL_CTRL, reg_data);
 			break;
 		default:
 			return 0;
 	}
 
+	ret = spi_img_get(&st->img, reg, &reg_data);
+	if (ret < 0) {
+		ret = spi_img_load(&st->img, reg);
+		if (ret < 0)
+			return ret;
+		spi_img_get(&st->img, reg, &reg_data);
+	}
+
+	if (out) {
+		reg_data |= mask;
+		if (ch <= 3)
+			out = AD9523_VCXO;
+	} else {
+		reg_data &= ~mask;
+	}
+
 	st->vco_out_map[ch] = out;
 
-	return ret;
+	return spi_img_set(&st->img, reg, reg_data);
+}
+
+/***************************************************************************//**
+ * @brief Sets the clock provider for selected channel.
+ *
+ * @param ch - Selected channel.
+ * @param out - Selected clock provider.
+ *
+ * @return Returns 0 in case of success or negative error code.
+ *******************************************************************************/
+int32_t ad9523_vco_out_map(spi_device *dev,
+		uint32_t ch,
+		uint32_t out)
+{
+	struct ad9523_state *st = &ad9523_st;
+	int32_t ret;
+
+	if (st->img.dev != dev)
+		return -1;
+
+	ret = ad9523_img_vco_out_map(ch, out);
+	if (ret < 0)
+		return ret;
+
+	return spi_img_flush(&st->img);
 }
 
 /***************************************************************************//**
@@ -396,87 +421,38 @@ int32_t ad9523_init(ad9523_platform_data *pdata) {
 
 
 /***************************************************************************//**
- * @brief Setup the AD9523 device.
+ * @brief Builds the AD9523 register image from the platform data.
  *
  * @return Returns 0 in case of success or negative error code.
  *******************************************************************************/
-int32_t ad9523_setup(spi_device *dev,
-		ad9523_platform_data *pdata)
-
+static int32_t ad9523_build_image(ad9523_platform_data *pdata)
 {
 	struct ad9523_state *st = &ad9523_st;
 	ad9523_channel_spec *chan;
 	uint32_t active_mask = 0;
-	int32_t ret, i;
-	uint32_t reg_data;
-	uint32_t version_id;
-
-	ret = ad9523_spi_write(dev, AD9523_SERIAL_PORT_CONFIG,
-			AD9523_SER_CONF_SOFT_RESET |
-			(pdata->spi3wire ? 0 :
-			 AD9523_SER_CONF_SDO_ACTIVE));
-	if (ret < 0)
-		return ret;
-	mdelay(1);
-
-	ret = ad9523_spi_write(dev, AD9523_READBACK_CTRL,
-			AD9523_READBACK_CTRL_READ_BUFFERED);
-	if (ret < 0)
-		return ret;
-
-	ret = ad9523_io_update(dev);
-	if (ret < 0)
-		return ret;
-
-	ret = ad9523_spi_read(dev, AD9523_EEPROM_CUSTOMER_VERSION_ID, &version_id);
-	if (ret < 0)
-		return ret;
-
-	ret = ad9523_spi_write(dev, AD9523_EEPROM_CUSTOMER_VERSION_ID, 0xAD95);
-	if (ret < 0)
-		return ret;
-
-	ret = ad9523_spi_read(dev, AD9523_EEPROM_CUSTOMER_VERSION_ID, &reg_data);
-	if (ret < 0)
-		return ret;
-
-	if (reg_data != 0xAD95) {
-		ad_printf("AD9523: SPI write-verify failed (0x%X)!\n\r", reg_data);
-		return -1;
-	}
-
-	ret = ad9523_spi_write(dev, AD9523_EEPROM_CUSTOMER_VERSION_ID, version_id);
-	if (ret < 0)
-		return ret;
+	int32_t ret = 0;
+	int32_t i;
 
 	/*
 	 * PLL1 Setup
 	 */
-	ret = ad9523_spi_write(dev, AD9523_PLL1_REF_A_DIVIDER,
+	ret |= spi_img_set(&st->img, AD9523_PLL1_REF_A_DIVIDER,
 			pdata->refa_r_div);
-	if (ret < 0)
-		return ret;
 
-	ret = ad9523_spi_write(dev, AD9523_PLL1_REF_B_DIVIDER,
+	ret |= spi_img_set(&st->img, AD9523_PLL1_REF_B_DIVIDER,
 			pdata->refb_r_div);
-	if (ret < 0)
-		return ret;
 
-	ret = ad9523_spi_write(dev, AD9523_PLL1_FEEDBACK_DIVIDER,
+	ret |= spi_img_set(&st->img, AD9523_PLL1_FEEDBACK_DIVIDER,
 			pdata->pll1_feedback_div);
-	if (ret < 0)
-		return ret;
 
-	ret = ad9523_spi_write(dev, AD9523_PLL1_CHARGE_PUMP_CTRL,
+	ret |= spi_img_set(&st->img, AD9523_PLL1_CHARGE_PUMP_CTRL,
 			AD_IFE(pll1_bypass_en, AD9523_PLL1_CHARGE_PUMP_TRISTATE,
 				AD9523_PLL1_CHARGE_PUMP_CURRENT_nA(pdata->
 					pll1_charge_pump_current_nA) |
 				AD9523_PLL1_CHARGE_PUMP_MODE_NORMAL |
 				AD9523_PLL1_BACKLASH_PW_MIN));
-	if (ret < 0)
-		return ret;
 
-	ret = ad9523_spi_write(dev, AD9523_PLL1_INPUT_RECEIVERS_CTRL,
+	ret |= spi_img_set(&st->img, AD9523_PLL1_INPUT_RECEIVERS_CTRL,
 			AD_IFE(pll1_bypass_en, AD9523_PLL1_REFA_REFB_PWR_CTRL_EN |
 				AD_IF(osc_in_diff_en, AD9523_PLL1_OSC_IN_DIFF_EN) |
 				AD_IF(osc_in_cmos_neg_inp_en, AD9523_PLL1_OSC_IN_CMOS_NEG_INP_EN),
@@ -487,10 +463,8 @@ int32_t ad9523_setup(spi_device *dev,
 					AD9523_PLL1_OSC_IN_CMOS_NEG_INP_EN) |
 				AD_IF(refa_diff_rcv_en, AD9523_PLL1_REFA_DIFF_RCV_EN) |
 				AD_IF(refb_diff_rcv_en, AD9523_PLL1_REFB_DIFF_RCV_EN)));
-	if (ret < 0)
-		return ret;
 
-	ret = ad9523_spi_write(dev, AD9523_PLL1_REF_CTRL,
+	ret |= spi_img_set(&st->img, AD9523_PLL1_REF_CTRL,
 			AD_IFE(pll1_bypass_en, AD9523_PLL1_BYPASS_FEEDBACK_DIV_EN |
 				AD9523_PLL1_ZERO_DELAY_MODE_INT,
 				AD_IF(zd_in_diff_en, AD9523_PLL1_ZD_IN_DIFF_EN) |
@@ -501,61 +475,45 @@ int32_t ad9523_setup(spi_device *dev,
 				AD_IF(osc_in_feedback_en, AD9523_PLL1_OSC_IN_PLL_FEEDBACK_EN) |
 				AD_IF(refa_cmos_neg_inp_en, AD9523_PLL1_REFA_CMOS_NEG_INP_EN) |
 				AD_IF(refb_cmos_neg_inp_en, AD9523_PLL1_REFB_CMOS_NEG_INP_EN)));
-	if (ret < 0)
-		return ret;
 
-	ret = ad9523_spi_write(dev, AD9523_PLL1_MISC_CTRL,
+	ret |= spi_img_set(&st->img, AD9523_PLL1_MISC_CTRL,
 			AD9523_PLL1_REFB_INDEP_DIV_CTRL_EN |
 			AD9523_PLL1_REF_MODE(pdata->ref_mode));
-	if (ret < 0)
-		return ret;
 
-	ret = ad9523_spi_write(dev, AD9523_PLL1_LOOP_FILTER_CTRL,
+	ret |= spi_img_set(&st->img, AD9523_PLL1_LOOP_FILTER_CTRL,
 			AD9523_PLL1_LOOP_FILTER_RZERO(pdata->pll1_loop_filter_rzero));
-	if (ret < 0)
-		return ret;
 
 	/*
 	 * PLL2 Setup
 	 */
 
-	ret = ad9523_spi_write(dev, AD9523_PLL2_CHARGE_PUMP,
+	ret |= spi_img_set(&st->img, AD9523_PLL2_CHARGE_PUMP,
 			AD9523_PLL2_CHARGE_PUMP_CURRENT_nA(pdata->
 				pll2_charge_pump_current_nA));
-	if (ret < 0)
-		return ret;
 
-	ret = ad9523_spi_write(dev, AD9523_PLL2_FEEDBACK_DIVIDER_AB,
+	ret |= spi_img_set(&st->img, AD9523_PLL2_FEEDBACK_DIVIDER_AB,
 			AD9523_PLL2_FB_NDIV_A_CNT(pdata->pll2_ndiv_a_cnt) |
 			AD9523_PLL2_FB_NDIV_B_CNT(pdata->pll2_ndiv_b_cnt));
-	if (ret < 0)
-		return ret;
 
-	ret = ad9523_spi_write(dev, AD9523_PLL2_CTRL,
+	ret |= spi_img_set(&st->img, AD9523_PLL2_CTRL,
 			AD9523_PLL2_CHARGE_PUMP_MODE_NORMAL |
 			AD9523_PLL2_BACKLASH_CTRL_EN |
 			AD_IF(pll2_freq_doubler_en, AD9523_PLL2_FREQ_DOUBLER_EN));
-	if (ret < 0)
-		return ret;
 
 	st->vco_freq = (pdata->vcxo_freq * (pdata->pll2_freq_doubler_en ? 2 : 1)
 			/ pdata->pll2_r2_div) * AD9523_PLL2_FB_NDIV(pdata->
 				pll2_ndiv_a_cnt, pdata->pll2_ndiv_b_cnt);
 
-	ret = ad9523_spi_write(dev, AD9523_PLL2_VCO_CTRL,
+	ret |= spi_img_set(&st->img, AD9523_PLL2_VCO_CTRL,
 			AD9523_PLL2_VCO_CALIBRATE);
-	if (ret < 0)
-		return ret;
 
-	ret = ad9523_spi_write(dev, AD9523_PLL2_VCO_DIVIDER,
+	ret |= spi_img_set(&st->img, AD9523_PLL2_VCO_DIVIDER,
 			AD9523_PLL2_VCO_DIV_M1(pdata->pll2_vco_diff_m1) |
 			AD9523_PLL2_VCO_DIV_M2(pdata->pll2_vco_diff_m2) |
 			AD_IFE(pll2_vco_diff_m1, 0,
 				AD9523_PLL2_VCO_DIV_M1_PWR_DOWN_EN) |
 			AD_IFE(pll2_vco_diff_m2, 0,
 				AD9523_PLL2_VCO_DIV_M2_PWR_DOWN_EN));
-	if (ret < 0)
-		return ret;
 
 	if (pdata->pll2_vco_diff_m1)
 		st->vco_out_freq[AD9523_VCO1] =
@@ -567,25 +525,21 @@ int32_t ad9523_setup(spi_device *dev,
 
 	st->vco_out_freq[AD9523_VCXO] = pdata->vcxo_freq;
 
-	ret = ad9523_spi_write(dev, AD9523_PLL2_R2_DIVIDER,
+	ret |= spi_img_set(&st->img, AD9523_PLL2_R2_DIVIDER,
 			AD9523_PLL2_R2_DIVIDER_VAL(pdata->pll2_r2_div));
-	if (ret < 0)
-		return ret;
 
-	ret = ad9523_spi_write(dev, AD9523_PLL2_LOOP_FILTER_CTRL,
+	ret |= spi_img_set(&st->img, AD9523_PLL2_LOOP_FILTER_CTRL,
 			AD9523_PLL2_LOOP_FILTER_CPOLE1(pdata->cpole1) |
 			AD9523_PLL2_LOOP_FILTER_RZERO(pdata->rzero) |
 			AD9523_PLL2_LOOP_FILTER_RPOLE2(pdata->rpole2) |
 			AD_IF(rzero_bypass_en,
 				AD9523_PLL2_LOOP_FILTER_RZERO_BYPASS_EN));
-	if (ret < 0)
-		return ret;
 
 	for (i = 0; i < pdata->num_channels; i++) {
 		chan = &pdata->channels[i];
 		if (chan->channel_num < AD9523_NUM_CHAN) {
 			active_mask |= (1 << chan->channel_num);
-			ret = ad9523_spi_write(dev,
+			ret |= spi_img_set(&st->img,
 					AD9523_CHANNEL_CLOCK_DIST(chan->channel_num),
 					AD9523_CLK_DIST_DRIVER_MODE(chan->driver_mode) |
 					AD9523_CLK_DIST_DIV(chan->channel_divider) |
@@ -598,13 +552,9 @@ int32_t ad9523_setup(spi_device *dev,
 					 AD9523_CLK_DIST_LOW_PWR_MODE_EN : 0) |
 					(chan->output_dis ?
 					 AD9523_CLK_DIST_PWR_DOWN_EN : 0));
-			if (ret < 0)
-				return ret;
 
-			ret = ad9523_vco_out_map(dev, chan->channel_num,
+			ret |= ad9523_img_vco_out_map(chan->channel_num,
 					chan->use_alt_clock_src);
-			if (ret < 0)
-				return ret;
 		}
 	}
 
@@ -612,19 +562,86 @@ int32_t ad9523_setup(spi_device *dev,
 	{
 		if(!(active_mask & (1 << i)))
 		{
-			ad9523_spi_write(dev,
+			ret |= spi_img_set(&st->img,
 					AD9523_CHANNEL_CLOCK_DIST(i),
 					AD9523_CLK_DIST_DRIVER_MODE(TRISTATE) |
 					AD9523_CLK_DIST_PWR_DOWN_EN);
 		}
 	}
 
-	ret = ad9523_spi_write(dev, AD9523_POWER_DOWN_CTRL, 0);
+	ret |= spi_img_set(&st->img, AD9523_POWER_DOWN_CTRL, 0);
+
+	ret |= spi_img_set(&st->img, AD9523_STATUS_SIGNALS,
+			AD9523_STATUS_MONITOR_01_PLL12_LOCKED);
+
+	return ret;
+}
+
+/***************************************************************************//**
+ * @brief Setup the AD9523 device.
+ *
+ * @return Returns 0 in case of success or negative error code.
+ *******************************************************************************/
+int32_t ad9523_setup(spi_device *dev,
+		ad9523_platform_data *pdata)
+
+{
+	struct ad9523_state *st = &ad9523_st;
+	int32_t ret;
+	uint32_t reg_data;
+	uint32_t version_id;
+
+	ret = ad9523_spi_write(dev, AD9523_SERIAL_PORT_CONFIG,
+			AD9523_SER_CONF_SOFT_RESET |
+			(pdata->spi3wire ? 0 :
+			 AD9523_SER_CONF_SDO_ACTIVE));
 	if (ret < 0)
 		return ret;
+	mdelay(1);
 
-	ret = ad9523_spi_write(dev, AD9523_STATUS_SIGNALS,
-			AD9523_STATUS_MONITOR_01_PLL12_LOCKED);
+	ret = ad9523_spi_write(dev, AD9523_READBACK_CTRL,
+			AD9523_READBACK_CTRL_READ_BUFFERED);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9523_io_update(dev);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9523_spi_read(dev, AD9523_EEPROM_CUSTOMER_VERSION_ID, &version_id);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9523_spi_write(dev, AD9523_EEPROM_CUSTOMER_VERSION_ID, 0xAD95);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9523_spi_read(dev, AD9523_EEPROM_CUSTOMER_VERSION_ID, &reg_data);
+	if (ret < 0)
+		return ret;
+
+	if (reg_data != 0xAD95) {
+		ad_printf("AD9523: SPI write-verify failed (0x%X)!\n\r", reg_data);
+		return -1;
+	}
+
+	ret = ad9523_spi_write(dev, AD9523_EEPROM_CUSTOMER_VERSION_ID, version_id);
+	if (ret < 0)
+		return ret;
+
+	spi_img_init(&st->img, dev, ad9523_img_blocks,
+			ARRAY_SIZE(ad9523_img_blocks), 1);
+
+	ret = spi_img_load(&st->img, AD9523_PLL1_OUTPUT_CTRL);
+	ret |= spi_img_load(&st->img, AD9523_PLL1_OUTPUT_CHANNEL_CTRL);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9523_build_image(pdata);
+	if (ret < 0)
+		return ret;
+
+	ret = spi_img_flush(&st->img);
 	if (ret < 0)
 		return ret;
 
@@ -643,3 +660,36 @@ int32_t ad9523_setup(spi_device *dev,
 
 	return(ad9523_status(dev, pdata));
 }
+
+/***************************************************************************//**
+ * @brief Re-clocks an AD9523 set up by ad9523_setup. Only the registers that
+ *        differ from the last written configuration are transferred.
+ *
+ * @return Returns 0 in case of success or negative error code.
+ *******************************************************************************/
+int32_t ad9523_reclock(spi_device *dev,
+		ad9523_platform_data *pdata)
+{
+	struct ad9523_state *st = &ad9523_st;
+	int32_t ret;
+
+	if (st->img.dev != dev)
+		return -1;
+
+	ret = ad9523_build_image(pdata);
+	if (ret < 0)
+		return ret;
+
+	ret = spi_img_flush(&st->img);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9523_io_update(dev);
+	if (ret < 0)
+		return ret;
+
+	ad9523_calibrate(dev);
+	ad9523_sync(dev);
+
+	return(ad9523_status(dev, pdata));
+}
@@ -486,4 +486,7 @@ int32_t ad9523_init(ad9523_platform_data *pdata);
 /* Configure the AD9523. */
 int32_t ad9523_setup(spi_device *dev,
 		ad9523_platform_data *pdata);
+/* Re-clock the AD9523, writing only the changed registers. */
+int32_t ad9523_reclock(spi_device *dev,
+		ad9523_platform_data *pdata);
 #endif // __AD9523_H__
@@ -67,8 +67,20 @@ enum {
 struct ad9528_state
 {
   uint32_t vco_out_freq[AD9528_NUM_CLK_SRC];
+  uint32_t vco_ctrl;
+  uint32_t sysref_ctrl;
+  spi_img img;
 }ad9528_st;
 
+/* Register blocks held in the register image */
+static const spi_img_block ad9528_img_blocks[] = {
+  {0x100, 11},  /* PLL1 */
+  {0x200, 9},   /* PLL2 */
+  {0x300, 45},  /* Channel outputs, sync */
+  {0x400, 4},   /* SYSREF */
+  {0x500, 3},   /* Power down */
+};
+
 /* Helpers to avoid excess line breaks */
 #define AD_IFE(_pde, _a, _b) ((pdata->_pde) ? _a : _b)
 #define AD_IF(_pde, _a) AD_IFE(_pde, _a, 0)
@@ -324,75 +336,40 @@ int32_t ad9528_init(ad9528_platform_data *pdata)
 
 
 /***************************************************************************//**
- * @brief Initializes the AD9528.
+ * @brief Builds the AD9528 register image from the platform data.
  *
  * @return Returns 0 in case of success or negative error code.
 *******************************************************************************/
-int32_t ad9528_setup(spi_device *dev, ad9528_platform_data *pdata)
+static int32_t ad9528_build_image(ad9528_platform_data *pdata)
 {
   struct ad9528_state *st = &ad9528_st;
   ad9528_channel_spec *chan;
   uint32_t active_mask = 0;
   uint32_t ignoresync_mask = 0;
   uint32_t vco_freq;
-  uint32_t vco_ctrl;
-  uint32_t sysref_ctrl;
-  uint32_t reg_data;
-  int32_t ret, i;
-
-  ret = ad9528_spi_write_n(dev, AD9528_SERIAL_PORT_CONFIG,
-      AD9528_SER_CONF_SOFT_RESET |
-      (pdata->spi3wire ? 0 :
-      AD9528_SER_CONF_SDO_ACTIVE));
-  if (ret < 0)
-    return ret;
-
-  ret = ad9528_spi_write_n(dev, AD9528_SERIAL_PORT_CONFIG_B,
-      AD9528_SER_CONF_READ_BUFFERED);
-  if (ret < 0)
-    return ret;
-
-  ret = ad9528_io_update(dev);
-  if (ret < 0)
-    return ret;
-
-  ret = ad9528_spi_read_n(dev, AD9528_CHIP_ID, &reg_data);
-  if (ret < 0)
-    return ret;
-
-  if ((reg_data & 0xFFFFFF) != AD9528_SPI_MAGIC) {
-    ad_printf("AD9528 SPI Read Verify failed (0x%X).\n", reg_data);
-    return -1;
-  }
+  int32_t ret = 0;
+  int32_t i;
 
   /*
    * PLL1 Setup
    */
-  ret = ad9528_spi_write_n(dev, AD9528_PLL1_REF_A_DIVIDER,
+  ret |= spi_img_set(&st->img, AD9528_PLL1_REF_A_DIVIDER,
     pdata->refa_r_div);
-  if (ret < 0)
-    return ret;
 
-  ret = ad9528_spi_write_n(dev, AD9528_PLL1_REF_B_DIVIDER,
+  ret |= spi_img_set(&st->img, AD9528_PLL1_REF_B_DIVIDER,
     pdata->refb_r_div);
-  if (ret < 0)
-    return ret;
 
-  ret = ad9528_spi_write_n(dev, AD9528_PLL1_FEEDBACK_DIVIDER,
+  ret |= spi_img_set(&st->img, AD9528_PLL1_FEEDBACK_DIVIDER,
     pdata->pll1_feedback_div);
-  if (ret < 0)
-    return ret;
 
-  ret = ad9528_spi_write_n(dev, AD9528_PLL1_CHARGE_PUMP_CTRL,
+  ret |= spi_img_set(&st->img, AD9528_PLL1_CHARGE_PUMP_CTRL,
     AD_IFE(pll1_bypass_en, AD9528_PLL1_CHARGE_PUMP_TRISTATE,
     AD9528_PLL1_CHARGE_PUMP_CURRENT_nA(pdata->
       pll1_charge_pump_current_nA) |
     AD9528_PLL1_CHARGE_PUMP_MODE_NORMAL |
     AD9528_PLL1_CHARGE_PUMP_AUTO_TRISTATE_DIS));
-  if (ret < 0)
-    return ret;
 
-  ret = ad9528_spi_write_n(dev, AD9528_PLL1_CTRL,
+  ret |= spi_img_set(&st->img, AD9528_PLL1_CTRL,
     AD_IFE(pll1_bypass_en,
     AD_IF(osc_in_diff_en, AD9528_PLL1_OSC_IN_DIFF_EN) |
     AD_IF(osc_in_cmos_neg_inp_en,
@@ -410,47 +387,35 @@ int32_t ad9528_setup(spi_device *dev, ad9528_platform_data *pdata)
     AD_IF(refb_cmos_neg_inp_en, AD9528_PLL1_REFB_CMOS_NEG_INP_EN) |
     AD_IF(pll1_feedback_src_vcxo, AD9528_PLL1_SOURCE_VCXO) |
     AD9528_PLL1_REF_MODE(pdata->ref_mode));
-  if (ret < 0)
-    return ret;
 
   /*
    * PLL2 Setup
    */
 
-  ret = ad9528_spi_write_n(dev, AD9528_PLL2_CHARGE_PUMP,
+  ret |= spi_img_set(&st->img, AD9528_PLL2_CHARGE_PUMP,
     AD9528_PLL2_CHARGE_PUMP_CURRENT_nA(pdata->
       pll2_charge_pump_current_nA));
-  if (ret < 0)
-    return ret;
 
-  ret = ad9528_spi_write_n(dev, AD9528_PLL2_FEEDBACK_DIVIDER_AB,
+  ret |= spi_img_set(&st->img, AD9528_PLL2_FEEDBACK_DIVIDER_AB,
     AD9528_PLL2_FB_NDIV_A_CNT(pdata->pll2_ndiv_a_cnt) |
     AD9528_PLL2_FB_NDIV_B_CNT(pdata->pll2_ndiv_b_cnt));
-  if (ret < 0)
-    return ret;
 
-  ret = ad9528_spi_write_n(dev, AD9528_PLL2_CTRL,
+  ret |= spi_img_set(&st->img, AD9528_PLL2_CTRL,
     AD9528_PLL2_CHARGE_PUMP_MODE_NORMAL |
     AD_IF(pll2_freq_doubler_en, AD9528_PLL2_FREQ_DOUBLER_EN));
-  if (ret < 0)
-    return ret;
 
   vco_freq = (pdata->vcxo_freq * (pdata->pll2_freq_doubler_en ? 2 : 1)
       / pdata->pll2_r1_div) * AD9528_PLL2_FB_NDIV(pdata->
       pll2_ndiv_a_cnt, pdata->pll2_ndiv_b_cnt);
 
-  vco_ctrl = AD_IF(pll2_freq_doubler_en || pdata->pll2_r1_div != 1,
+  st->vco_ctrl = AD_IF(pll2_freq_doubler_en || pdata->pll2_r1_div != 1,
         AD9528_PLL2_DOUBLER_R1_EN);
-  ret = ad9528_spi_write_n(dev, AD9528_PLL2_VCO_CTRL, vco_ctrl);
-  if (ret < 0)
-    return ret;
+  ret |= spi_img_set(&st->img, AD9528_PLL2_VCO_CTRL, st->vco_ctrl);
 
-  ret = ad9528_spi_write_n(dev, AD9528_PLL2_VCO_DIVIDER,
+  ret |= spi_img_set(&st->img, AD9528_PLL2_VCO_DIVIDER,
     AD9528_PLL2_VCO_DIV_M1(pdata->pll2_vco_diff_m1) |
     AD_IFE(pll2_vco_diff_m1, 0,
            AD9528_PLL2_VCO_DIV_M1_PWR_DOWN_EN));
-  if (ret < 0)
-    return ret;
 
   if (pdata->pll2_vco_diff_m1)
     st->vco_out_freq[AD9528_VCO] =
@@ -460,24 +425,18 @@ int32_t ad9528_setup(spi_device *dev, ad9528_platform_data *pdata)
 
   st->vco_out_freq[AD9528_VCXO] = pdata->vcxo_freq;
 
-  ret = ad9528_spi_write_n(dev, AD9528_PLL2_R1_DIVIDER,
+  ret |= spi_img_set(&st->img, AD9528_PLL2_R1_DIVIDER,
     AD9528_PLL2_R1_DIV(pdata->pll2_r1_div));
-  if (ret < 0)
-    return ret;
 
-  ret = ad9528_spi_write_n(dev, AD9528_PLL2_N2_DIVIDER,
+  ret |= spi_img_set(&st->img, AD9528_PLL2_N2_DIVIDER,
     AD9528_PLL2_N2_DIV(pdata->pll2_n2_div));
-  if (ret < 0)
-    return ret;
 
-  ret = ad9528_spi_write_n(dev, AD9528_PLL2_LOOP_FILTER_CTRL,
+  ret |= spi_img_set(&st->img, AD9528_PLL2_LOOP_FILTER_CTRL,
     AD9528_PLL2_LOOP_FILTER_CPOLE1(pdata->cpole1) |
     AD9528_PLL2_LOOP_FILTER_RZERO(pdata->rzero) |
     AD9528_PLL2_LOOP_FILTER_RPOLE2(pdata->rpole2) |
     AD_IF(rzero_bypass_en,
           AD9528_PLL2_LOOP_FILTER_RZERO_BYPASS_EN));
-  if (ret < 0)
-    return ret;
 
 
   for (i = 0; i < pdata->num_channels; i++) {
@@ -491,39 +450,56 @@ int32_t ad9528_setup(spi_device *dev, ad9528_platform_data *pdata)
       if (chan->sync_ignore_en)
         ignoresync_mask |= (1 << chan->channel_num);
 
-      ret = ad9528_spi_write_n(dev,
+      ret |= spi_img_set(&st->img,
         AD9528_CHANNEL_OUTPUT(chan->channel_num),
         AD9528_CLK_DIST_DRIVER_MODE(chan->driver_mode) |
         AD9528_CLK_DIST_DIV(chan->channel_divider) |
         AD9528_CLK_DIST_DIV_PHASE(chan->divider_phase) |
         AD9528_CLK_DIST_CTRL(chan->signal_source));
-      if (ret < 0)
-        return ret;
     }
   }
 
-  ret = ad9528_spi_write_n(dev, AD9528_CHANNEL_PD_EN,
+  ret |= spi_img_set(&st->img, AD9528_CHANNEL_PD_EN,
       AD9528_CHANNEL_PD_MASK(~active_mask));
-  if (ret < 0)
-    return ret;
 
-  ret = ad9528_spi_write_n(dev, AD9528_CHANNEL_SYNC_IGNORE,
+  ret |= spi_img_set(&st->img, AD9528_CHANNEL_SYNC, 0);
+
+  ret |= spi_img_set(&st->img, AD9528_CHANNEL_SYNC_IGNORE,
       AD9528_CHANNEL_IGNORE_MASK(ignoresync_mask));
-  if (ret < 0)
-    return ret;
 
-  ret = ad9528_spi_write_n(dev, AD9528_SYSREF_K_DIVIDER,
+  ret |= spi_img_set(&st->img, AD9528_SYSREF_K_DIVIDER,
       AD9528_SYSREF_K_DIV(pdata->sysref_k_div));
+
+  st->sysref_ctrl = AD9528_SYSREF_PATTERN_MODE(SYSREF_PATTERN_CONTINUOUS) |
+      AD9528_SYSREF_SOURCE(pdata->sysref_src);
+  ret |= spi_img_set(&st->img, AD9528_SYSREF_CTRL, st->sysref_ctrl);
+
+  ret |= spi_img_set(&st->img, AD9528_PD_EN, AD9528_PD_BIAS);
+
+  return ret;
+}
+
+/***************************************************************************//**
+ * @brief Streams the register image, calibrates the VCO and syncs the outputs.
+ *
+ * @return Returns 0 in case of success or negative error code.
+*******************************************************************************/
+static int32_t ad9528_program(spi_device *dev)
+{
+  struct ad9528_state *st = &ad9528_st;
+  int32_t ret;
+
+  ret = spi_img_flush(&st->img);
   if (ret < 0)
     return ret;
 
-  sysref_ctrl = AD9528_SYSREF_PATTERN_MODE(SYSREF_PATTERN_CONTINUOUS) |
-      AD9528_SYSREF_SOURCE(pdata->sysref_src);
-  ret = ad9528_spi_write_n(dev, AD9528_SYSREF_CTRL, sysref_ctrl);
+  ret = ad9528_io_update(dev);
   if (ret < 0)
     return ret;
 
-  ret = ad9528_spi_write_n(dev, AD9528_PD_EN, AD9528_PD_BIAS);
+  spi_img_set(&st->img, AD9528_PLL2_VCO_CTRL,
+      st->vco_ctrl | AD9528_PLL2_VCO_CALIBRATE);
+  ret = spi_img_flush(&st->img);
   if (ret < 0)
     return ret;
 
@@ -531,8 +507,14 @@ int32_t ad9528_setup(spi_device *dev, ad9528_platform_data *pdata)
   if (ret < 0)
     return ret;
 
-  ret = ad9528_spi_write_n(dev, AD9528_PLL2_VCO_CTRL,
-      vco_ctrl | AD9528_PLL2_VCO_CALIBRATE);
+  ret = ad9528_poll(dev, AD9528_READBACK,
+      AD9528_IS_CALIBRATING, 0);
+  if (ret < 0)
+    return ret;
+
+  spi_img_set(&st->img, AD9528_SYSREF_CTRL,
+      st->sysref_ctrl | AD9528_SYSREF_PATTERN_REQ);
+  ret = spi_img_flush(&st->img);
   if (ret < 0)
     return ret;
 
@@ -540,13 +522,29 @@ int32_t ad9528_setup(spi_device *dev, ad9528_platform_data *pdata)
   if (ret < 0)
     return ret;
 
-  ret = ad9528_poll(dev, AD9528_READBACK,
-      AD9528_IS_CALIBRATING, 0);
+  return ad9528_sync(dev);
+}
+
+/***************************************************************************//**
+ * @brief Initializes the AD9528.
+ *
+ * @return Returns 0 in case of success or negative error code.
+*******************************************************************************/
+int32_t ad9528_setup(spi_device *dev, ad9528_platform_data *pdata)
+{
+  struct ad9528_state *st = &ad9528_st;
+  uint32_t reg_data;
+  int32_t ret;
+
+  ret = ad9528_spi_write_n(dev, AD9528_SERIAL_PORT_CONFIG,
+      AD9528_SER_CONF_SOFT_RESET |
+      (pdata->spi3wire ? 0 :
+      AD9528_SER_CONF_SDO_ACTIVE));
   if (ret < 0)
     return ret;
 
-  sysref_ctrl |= AD9528_SYSREF_PATTERN_REQ;
-  ret = ad9528_spi_write_n(dev, AD9528_SYSREF_CTRL, sysref_ctrl);
+  ret = ad9528_spi_write_n(dev, AD9528_SERIAL_PORT_CONFIG_B,
+      AD9528_SER_CONF_READ_BUFFERED);
   if (ret < 0)
     return ret;
 
@@ -554,9 +552,42 @@ int32_t ad9528_setup(spi_device *dev, ad9528_platform_data *pdata)
   if (ret < 0)
     return ret;
 
-  ret = ad9528_sync(dev);
+  ret = ad9528_spi_read_n(dev, AD9528_CHIP_ID, &reg_data);
   if (ret < 0)
     return ret;
 
-  return 0;
+  if ((reg_data & 0xFFFFFF) != AD9528_SPI_MAGIC) {
+    ad_printf("AD9528 SPI Read Verify failed (0x%X).\n", reg_data);
+    return -1;
+  }
+
+  spi_img_init(&st->img, dev, ad9528_img_blocks,
+      ARRAY_SIZE(ad9528_img_blocks), 0);
+
+  ret = ad9528_build_image(pdata);
+  if (ret < 0)
+    return ret;
+
+  return ad9528_program(dev);
+}
+
+/***************************************************************************//**
+ * @brief Re-clocks an AD9528 set up by ad9528_setup. Only the registers that
+ *        differ from the last written configuration are transferred.
+ *
+ * @return Returns 0 in case of success or negative error code.
+*******************************************************************************/
+int32_t ad9528_reclock(spi_device *dev, ad9528_platform_data *pdata)
+{
+  struct ad9528_state *st = &ad9528_st;
+  int32_t ret;
+
+  if (st->img.dev != dev)
+    return -1;
+
+  ret = ad9528_build_image(pdata);
+  if (ret < 0)
+    return ret;
+
+  return ad9528_program(dev);
 }
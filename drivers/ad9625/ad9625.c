@@ -90,30 +90,47 @@ int32_t ad9625_spi_write(spi_device *dev,
 	return ret;
 }
 
+/***************************************************************************//**
+ * @brief ad9625_setup_seq
+ *******************************************************************************/
+static const spi_seq_step ad9625_setup_seq[] = {
+	SPI_SEQ_WRITE(AD9625_REG_CHIP_PORT_CONF, 0x18),
+	SPI_SEQ_WRITE(AD9625_REG_TRANSFER, 0x01),
+	SPI_SEQ_POLL(AD9625_REG_TRANSFER, 0x01, 0x00, 10000),
+
+	SPI_SEQ_WRITE(AD9625_REG_POWER_MODE, 0x00),
+	SPI_SEQ_WRITE(AD9625_REG_TRANSFER, 0x01),
+	SPI_SEQ_WRITE(AD9625_REG_JESD204B_LINK_CNTRL_1, 0x15),
+	SPI_SEQ_WRITE(AD9625_REG_JESD204B_LANE_POWER_MODE, 0x00),
+	SPI_SEQ_WRITE(AD9625_REG_DIVCLK_OUT_CNTRL, 0x11),
+	SPI_SEQ_WRITE(AD9625_REG_TEST_CNTRL, 0x00),
+	SPI_SEQ_WRITE(AD9625_REG_OUTPUT_MODE, 0x00),
+	SPI_SEQ_WRITE(AD9625_REG_OUTPUT_ADJUST, 0x10),
+	SPI_SEQ_WRITE(AD9625_REG_JESD204B_LINK_CNTRL_1, 0x14),
+	SPI_SEQ_WRITE(AD9625_REG_TRANSFER, 0x01),
+	SPI_SEQ_POLL(AD9625_REG_TRANSFER, 0x01, 0x00, 10000),
+	SPI_SEQ_POLL(AD9625_REG_PLL_STATUS, 0x80, 0x80, 10000),
+	SPI_SEQ_END
+};
+
 /***************************************************************************//**
  * @brief ad9625_setup
  *******************************************************************************/
 int32_t ad9625_setup(spi_device *dev)
 {
 	uint8_t chip_id;
-	uint8_t pll_stat;
+	spi_seq seq;
 	int32_t ret;
 
-	ad9625_spi_write(dev, AD9625_REG_CHIP_PORT_CONF, 0x18);
-	ad9625_spi_write(dev, AD9625_REG_TRANSFER, 0x01);
-	mdelay(10);
-
-	ad9625_spi_write(dev, AD9625_REG_POWER_MODE, 0x00);
-	ad9625_spi_write(dev, AD9625_REG_TRANSFER, 0x01);
-	ad9625_spi_write(dev, AD9625_REG_JESD204B_LINK_CNTRL_1, 0x15);
-	ad9625_spi_write(dev, AD9625_REG_JESD204B_LANE_POWER_MODE, 0x00);
-	ad9625_spi_write(dev, AD9625_REG_DIVCLK_OUT_CNTRL, 0x11);
-	ad9625_spi_write(dev, AD9625_REG_TEST_CNTRL, 0x00);
-	ad9625_spi_write(dev, AD9625_REG_OUTPUT_MODE, 0x00);
-	ad9625_spi_write(dev, AD9625_REG_OUTPUT_ADJUST, 0x10);
-	ad9625_spi_write(dev, AD9625_REG_JESD204B_LINK_CNTRL_1, 0x14);
-	ad9625_spi_write(dev, AD9625_REG_TRANSFER, 0x01);
-	mdelay(10);
+	seq.dev = dev;
+	seq.name = "AD9625";
+	seq.addr_ascending = 0;
+	seq.stream_flags = 0;
+	seq.max_burst = SPI_SEQ_MAX_BURST;
+	seq.lane_rate_kbps = 0;
+	seq.step_us = NULL;
+
+	ret = spi_seq_run(&seq, ad9625_setup_seq);
 
 	ad9625_spi_read(dev, AD9625_REG_CHIP_ID, &chip_id);
 	if(chip_id != AD9625_CHIP_ID)
@@ -122,10 +139,10 @@ int32_t ad9625_setup(spi_device *dev)
 		return -1;
 	}
 
-	ad9625_spi_read(dev, AD9625_REG_PLL_STATUS, &pll_stat);
-	if((pll_stat & 0x80) != 0x80)
+	if(ret)
 	{
-		ad_printf("%s Error: AD9625 PLL is NOT locked (0x%x).\n", __func__, chip_id);
+		ad_printf("%s Error: AD9625 PLL is NOT locked (step %d).\n", __func__,
+			seq.failed_step);
 		return -1;
 	}
 
@@ -96,6 +96,27 @@ int32_t ad9680_test(spi_device *dev,
 	return(0);
 }
 
+/***************************************************************************//**
+ * @brief ad9680_setup_seq
+ *******************************************************************************/
+static const spi_seq_step ad9680_setup_seq[] = {
+	SPI_SEQ_WRITE(AD9680_REG_INTERFACE_CONF_A, 0x81),	// RESET
+	SPI_SEQ_POLL(AD9680_REG_INTERFACE_CONF_A, 0x81, 0x00, 250000),	// reset done
+	SPI_SEQ_POLL(AD9680_REG_CHIP_ID_LOW, 0xff, AD9680_CHIP_ID, 250000),	// spi back up
+	SPI_SEQ_WRITE(AD9680_REG_LINK_CONTROL, 0x15),	// disable link, ilas enable
+	SPI_SEQ_WRITE(AD9680_REG_JESD204B_MF_CTRL, 0x1f),	// mf-frame-count
+	SPI_SEQ_WRITE(AD9680_REG_JESD204B_CSN_CONFIG, 0x2d),	// 14-bit
+	SPI_SEQ_WRITE(AD9680_REG_JESD204B_SUBCLASS_CONFIG, 0x2f),	// subclass-1, N'=16
+	SPI_SEQ_WRITE(AD9680_REG_JESD204B_QUICK_CONFIG, 0x88),	// m=2, l=4, f= 1
+	SPI_SEQ_IF_RATE(0, 6250000, 1),
+	SPI_SEQ_WRITE(AD9680_REG_JESD204B_LANE_RATE_CTRL, 0x10),	// low line rate mode must be enabled
+	SPI_SEQ_IF_RATE(6250000, SPI_SEQ_RATE_MAX, 1),
+	SPI_SEQ_WRITE(AD9680_REG_JESD204B_LANE_RATE_CTRL, 0x00),	// low line rate mode must be disabled
+	SPI_SEQ_WRITE(AD9680_REG_LINK_CONTROL, 0x14),	// link enable
+	SPI_SEQ_POLL(AD9680_REG_JESD204B_PLL_LOCK_STATUS, 0x80, 0x80, 250000),	// pll locked
+	SPI_SEQ_END
+};
+
 /***************************************************************************//**
  * @brief ad9680_setup
  *******************************************************************************/
@@ -103,11 +124,9 @@ int32_t ad9680_setup(spi_device *dev,
 		ad9680_init_param init_param)
 {
 	uint8_t chip_id;
-	uint8_t pll_stat;
+	spi_seq seq;
 	int32_t ret;
 
-	ret = 0;
-
 	ad9680_spi_read(dev, AD9680_REG_CHIP_ID_LOW, &chip_id);
 	if(chip_id != AD9680_CHIP_ID)
 	{
@@ -115,27 +134,17 @@ int32_t ad9680_setup(spi_device *dev,
 		return -1;
 	}
 
-	ad9680_spi_write(dev, AD9680_REG_INTERFACE_CONF_A, 0x81);	// RESET
-	mdelay(250);
-
-	ad9680_spi_write(dev, AD9680_REG_LINK_CONTROL, 0x15);	// disable link, ilas enable
-	ad9680_spi_write(dev, AD9680_REG_JESD204B_MF_CTRL, 0x1f);	// mf-frame-count
-	ad9680_spi_write(dev, AD9680_REG_JESD204B_CSN_CONFIG, 0x2d);	// 14-bit
-	ad9680_spi_write(dev, AD9680_REG_JESD204B_SUBCLASS_CONFIG, 0x2f);	// subclass-1, N'=16
-	ad9680_spi_write(dev, AD9680_REG_JESD204B_QUICK_CONFIG, 0x88);	// m=2, l=4, f= 1
-	if (init_param.lane_rate_kbps < 6250000)
-		ad9680_spi_write(dev, AD9680_REG_JESD204B_LANE_RATE_CTRL, 0x10);	// low line rate mode must be enabled
-	else
-		ad9680_spi_write(dev, AD9680_REG_JESD204B_LANE_RATE_CTRL, 0x00);	// low line rate mode must be disabled
-	ad9680_spi_write(dev, AD9680_REG_LINK_CONTROL, 0x14);	// link enable
-	mdelay(250);
-
-	ad9680_spi_read(dev, AD9680_REG_JESD204B_PLL_LOCK_STATUS, &pll_stat);
-	if ((pll_stat & 0x80) != 0x80)
-	{
-		ad_printf("AD9680: PLL is NOT locked!\n");
-		ret = -1;
-	}
+	seq.dev = dev;
+	seq.name = "AD9680";
+	seq.addr_ascending = 0;
+	seq.stream_flags = 0;
+	seq.max_burst = SPI_SEQ_MAX_BURST;
+	seq.lane_rate_kbps = init_param.lane_rate_kbps;
+	seq.step_us = NULL;
+
+	ret = spi_seq_run(&seq, ad9680_setup_seq);
+	if (ret)
+		ad_printf("AD9680: setup failed at step %d!\n", seq.failed_step);
 
 	return ret;
 }
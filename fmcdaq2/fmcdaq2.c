@@ -80,6 +80,14 @@ enum ad9523_channels {
 	ADC_FPGA_SYSREF,
 };
 
+/***************************************************************************//**
+ * @brief fmcdaq2_ad9144_status
+ *******************************************************************************/
+static int32_t fmcdaq2_ad9144_status(void *dev)
+{
+	return ad9144_status((spi_device *)dev);
+}
+
 /***************************************************************************//**
  * @brief main
  *******************************************************************************/
@@ -219,6 +227,8 @@ int main(void)
 	adc_core		ad9680_core;
 	jesd_core		ad9680_jesd;
 	xcvr_core		ad9680_xcvr;
+	jesd_link		daq2_links[2];
+	uint8_t			tx_link;
 	dmac_core               ad9680_dma;
 	dmac_xfer               rx_xfer;
 	dmac_xfer               tx_xfer;
@@ -349,6 +359,7 @@ int main(void)
 	ad9144_jesd.octets_per_frame = 1;
 	ad9144_jesd.frames_per_multiframe = 32;
 	ad9144_jesd.subclass_mode = 1;
+	ad9144_jesd.sysref_type = EXTERN;
 
 	ad9144_channels[0].dds_dual_tone = 0;
 	ad9144_channels[0].dds_frequency_0 = 33*1000*1000;
@@ -394,10 +405,12 @@ int main(void)
 	ad9680_xcvr.rx_tx_n = 1;
 	ad9680_xcvr.lane_rate_kbps = ad9680_param.lane_rate_kbps;
 
+	ad9680_jesd.rx_tx_n = 1;
 	ad9680_jesd.scramble_enable = 1;
 	ad9680_jesd.octets_per_frame = 1;
 	ad9680_jesd.frames_per_multiframe = 32;
 	ad9680_jesd.subclass_mode = 1;
+	ad9680_jesd.sysref_type = EXTERN;
 
 	ad9680_core.no_of_channels = 2;
 	ad9680_core.resolution = 14;
@@ -446,36 +459,32 @@ int main(void)
 	ad9680_setup(&ad9680_spi_device, ad9680_param);
 	ad9144_setup(&ad9144_spi_device, ad9144_param);
 
-	// set up the JESD core
-	jesd_setup(ad9680_jesd);
-	jesd_setup(ad9144_jesd);
-
-	// set up the XCVRs
+	// bring up the JESD links - RX and TX train together; the link owning
+	// the shared PLL reset is set up first, the other one waits for its lock
 #ifdef ALTERA
-	xcvr_setup(&ad9144_xcvr);
-	xcvr_setup(&ad9680_xcvr);
+	tx_link = 0;
 #endif
 #ifdef XILINX
-	// set up the XCVRs
-	if (ad9144_xcvr.dev.qpll_enable) {	// DAC_XCVR controls the QPLL reset
-		xcvr_setup(&ad9144_xcvr);
-		xcvr_setup(&ad9680_xcvr);
-	} else {				// ADC_XCVR controls the CPLL reset
-		xcvr_setup(&ad9680_xcvr);
-		xcvr_setup(&ad9144_xcvr);
-	}
+	// DAC_XCVR controls the QPLL reset, ADC_XCVR controls the CPLL reset
+	tx_link = ad9144_xcvr.dev.qpll_enable ? 0 : 1;
 #endif
+	jesd_link_init(&daq2_links[tx_link], "ad9144", &ad9144_xcvr, &ad9144_jesd);
+	jesd_link_init(&daq2_links[1 - tx_link], "ad9680", &ad9680_xcvr, &ad9680_jesd);
+	daq2_links[tx_link].converter = &ad9144_spi_device;
+	daq2_links[tx_link].converter_status = fmcdaq2_ad9144_status;
+	daq2_links[1].pll_owner = &daq2_links[0];
+
+	if (jesd_link_bringup(daq2_links, 2))
+		printf("daq2: JESD link bring-up failed!\n");
 
 	// JESD core status
 	axi_jesd204_tx_status_read(ad9144_jesd);
-	axi_jesd204_rx_status_read(ad9144_jesd);
+	axi_jesd204_rx_status_read(ad9680_jesd);
 
 	// interface core set up
 	adc_setup(ad9680_core);
 	dac_setup(&ad9144_core);
 
-	ad9144_status(&ad9144_spi_device);
-
 	//********************************************************************************
 	// transport path testing
 	//********************************************************************************